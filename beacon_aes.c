@@ -0,0 +1,210 @@
+/******************************************************************************
+* File Name: beacon_aes.c
+*
+* Description: This is the source code for a compact AES-128 encryption. Only
+* the forward cipher is needed: the BLE ah function, CMAC and CCM all use
+* the block cipher in the encrypt direction.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "beacon_aes.h"
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static const uint8_t aes_sbox[256] =
+{
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+static const uint8_t aes_rcon[BEACON_AES_ROUNDS] =
+{
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36
+};
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Multiplication by x in GF(2^8) */
+static uint8_t aes_xtime(uint8_t value)
+{
+    return (uint8_t)((value << 1) ^ ((value & 0x80) ? 0x1b : 0x00));
+}
+
+/********************************************************************************
+* Function Name: beacon_aes_init
+*********************************************************************************
+* Summary:
+*   Expands an AES-128 key
+*
+* Parameters:
+*   ctx:                    Expanded key
+*   key:                    128-bit key, most significant octet first
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_aes_init(beacon_aes_ctx_t *ctx, const uint8_t key[BEACON_AES_KEY_LEN])
+{
+    uint8_t *rk = ctx->round_key;
+    uint8_t temp[4];
+
+    memcpy(rk, key, BEACON_AES_KEY_LEN);
+
+    for (uint8_t i = 4; i < (4 * (BEACON_AES_ROUNDS + 1)); i++)
+    {
+        memcpy(temp, &rk[(i - 1) * 4], sizeof(temp));
+
+        if (0 == (i % 4))
+        {
+            /* RotWord, SubWord and round constant */
+            uint8_t first = temp[0];
+            temp[0] = aes_sbox[temp[1]] ^ aes_rcon[(i / 4) - 1];
+            temp[1] = aes_sbox[temp[2]];
+            temp[2] = aes_sbox[temp[3]];
+            temp[3] = aes_sbox[first];
+        }
+
+        for (uint8_t j = 0; j < 4; j++)
+        {
+            rk[(i * 4) + j] = rk[((i - 4) * 4) + j] ^ temp[j];
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_aes_encrypt
+*********************************************************************************
+* Summary:
+*   Encrypts one block. in and out may be the same buffer.
+*
+* Parameters:
+*   ctx:                    Expanded key
+*   in:                     Plaintext block
+*   out:                    Ciphertext block
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_aes_encrypt(const beacon_aes_ctx_t *ctx, const uint8_t in[BEACON_AES_BLOCK_LEN],
+                        uint8_t out[BEACON_AES_BLOCK_LEN])
+{
+    const uint8_t *rk = ctx->round_key;
+    uint8_t state[BEACON_AES_BLOCK_LEN];
+    uint8_t temp;
+
+    for (uint8_t i = 0; i < BEACON_AES_BLOCK_LEN; i++)
+    {
+        state[i] = in[i] ^ rk[i];
+    }
+
+    for (uint8_t round = 1; round <= BEACON_AES_ROUNDS; round++)
+    {
+        /* SubBytes */
+        for (uint8_t i = 0; i < BEACON_AES_BLOCK_LEN; i++)
+        {
+            state[i] = aes_sbox[state[i]];
+        }
+
+        /* ShiftRows, the state is stored column by column */
+        temp = state[1];
+        state[1] = state[5];
+        state[5] = state[9];
+        state[9] = state[13];
+        state[13] = temp;
+
+        temp = state[2];
+        state[2] = state[10];
+        state[10] = temp;
+        temp = state[6];
+        state[6] = state[14];
+        state[14] = temp;
+
+        temp = state[15];
+        state[15] = state[11];
+        state[11] = state[7];
+        state[7] = state[3];
+        state[3] = temp;
+
+        /* MixColumns, skipped in the last round */
+        if (round != BEACON_AES_ROUNDS)
+        {
+            for (uint8_t c = 0; c < BEACON_AES_BLOCK_LEN; c += 4)
+            {
+                uint8_t a0 = state[c];
+                uint8_t a1 = state[c + 1];
+                uint8_t a2 = state[c + 2];
+                uint8_t a3 = state[c + 3];
+                uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+
+                state[c]     ^= all ^ aes_xtime(a0 ^ a1);
+                state[c + 1] ^= all ^ aes_xtime(a1 ^ a2);
+                state[c + 2] ^= all ^ aes_xtime(a2 ^ a3);
+                state[c + 3] ^= all ^ aes_xtime(a3 ^ a0);
+            }
+        }
+
+        /* AddRoundKey */
+        for (uint8_t i = 0; i < BEACON_AES_BLOCK_LEN; i++)
+        {
+            state[i] ^= rk[(round * BEACON_AES_BLOCK_LEN) + i];
+        }
+    }
+
+    memcpy(out, state, BEACON_AES_BLOCK_LEN);
+}
+
+/* [] END OF FILE */
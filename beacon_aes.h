@@ -0,0 +1,77 @@
+/******************************************************************************
+* File Name: beacon_aes.h
+*
+* Description: This file contains the definitions for the AES-128 block
+* cipher used by the beacon privacy and security features.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_AES_H__
+#define __BEACON_AES_H__
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+#define BEACON_AES_BLOCK_LEN             (16)
+#define BEACON_AES_KEY_LEN               (16)
+#define BEACON_AES_ROUNDS                (10)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Expanded AES-128 key */
+typedef struct
+{
+    uint8_t round_key[(BEACON_AES_ROUNDS + 1) * BEACON_AES_BLOCK_LEN];
+}beacon_aes_ctx_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void beacon_aes_init    (beacon_aes_ctx_t *ctx, const uint8_t key[BEACON_AES_KEY_LEN]);
+
+void beacon_aes_encrypt (const beacon_aes_ctx_t *ctx,
+                         const uint8_t in[BEACON_AES_BLOCK_LEN],
+                         uint8_t out[BEACON_AES_BLOCK_LEN]);
+
+#endif      /* __BEACON_AES_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,402 @@
+/******************************************************************************
+* File Name: beacon_bench.c
+*
+* Description: This is the source code for the beacon lifecycle benchmark.
+* The runner waits in the calling task while each scenario step runs in the
+* beacon manager task, as the application's own commands do. The cost of a
+* scenario is read from the counters of the simulated controller.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "wiced_bt_stack.h"
+#include "beacon_bench.h"
+#include "beacon_slot.h"
+#include "beacon_stats.h"
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Benchmark scenario, returns WICED_FALSE if it could not complete */
+typedef struct
+{
+    const char *name;                           /* Scenario name */
+    wiced_bool_t (*p_run)(void);                /* Runs in the calling task */
+    beacon_bench_cost_t budget;                 /* Largest accepted cost */
+}bench_scenario_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static wiced_bool_t beacon_bench_cold_start   (void);
+static wiced_bool_t beacon_bench_field_update (void);
+static wiced_bool_t beacon_bench_reconfigure  (void);
+static wiced_bool_t beacon_bench_recovery     (void);
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Budgets for the two instances configured by main.c. An HCI set data
+ * command is 38 bytes, set params 28 bytes and enable 7 bytes. Commands and
+ * bytes are exact. The times were measured on the host build (make test) at
+ * the default 2 ms controller latency, median 13, 2, 17 and 5 ms over 25
+ * runs with the worst at 18, 3, 20 and 17 ms. They leave room for that
+ * scheduling jitter, added traffic is caught by the exact counts. */
+static const bench_scenario_t bench_scenarios[] =
+{
+    { "cold start",           beacon_bench_cold_start,   { 6, 146, 24 } },
+    { "single field update",  beacon_bench_field_update, { 1,  38,  5 } },
+    { "full reconfiguration", beacon_bench_reconfigure,  { 8, 160, 28 } },
+    { "failure recovery",     beacon_bench_recovery,     { 2,  76, 20 } },
+};
+
+static beacon_manager_fn_t          *bench_cold_start_fn;
+static uint8_t                       bench_instances[BEACON_SLOT_MAX_INSTANCES];
+static uint8_t                       bench_num_instances;
+
+static beacon_manager_fn_t          *bench_step_fn;
+static volatile wiced_bool_t         bench_step_done;
+static uint8_t                       bench_saved_byte;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_bench_step
+*********************************************************************************
+* Summary:
+*   Runs the current scenario step, deferred to the beacon manager task
+*
+*********************************************************************************/
+static void beacon_bench_step(void)
+{
+    bench_step_fn();
+    bench_step_done = WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_do
+*********************************************************************************
+* Summary:
+*   Runs a step in the beacon manager and waits until every command it
+*   issued has been answered and its response handled
+*
+*********************************************************************************/
+static wiced_bool_t beacon_bench_do(beacon_manager_fn_t *p_fn)
+{
+    uint32_t start_ms = beacon_stats_now_ms();
+    uint32_t pending;
+
+    bench_step_fn   = p_fn;
+    bench_step_done = WICED_FALSE;
+    beacon_manager_defer(beacon_bench_step);
+
+    for (;;)
+    {
+        pending = 0;
+        for (uint8_t instance = 1; instance <= BEACON_SLOT_MAX_INSTANCES; instance++)
+        {
+            pending += beacon_slot_get(instance)->cmds_pending;
+        }
+
+        if (bench_step_done && (0 == pending) && beacon_sim_idle())
+        {
+            return WICED_TRUE;
+        }
+
+        if ((uint32_t)(beacon_stats_now_ms() - start_ms) > BEACON_BENCH_STEP_TIMEOUT_MS)
+        {
+            return WICED_FALSE;
+        }
+        vTaskDelay(1);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_stop_all
+*********************************************************************************
+* Summary:
+*   Step stopping every benchmarked instance
+*
+*********************************************************************************/
+static void beacon_bench_stop_all(void)
+{
+    for (uint8_t i = 0; i < bench_num_instances; i++)
+    {
+        beacon_slot_start(beacon_slot_get(bench_instances[i]), WICED_FALSE);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_reissue_all
+*********************************************************************************
+* Summary:
+*   Step stopping, configuring and restarting every benchmarked instance
+*   with its current parameters and data
+*
+*********************************************************************************/
+static void beacon_bench_reissue_all(void)
+{
+    beacon_slot_t *p_slot;
+
+    for (uint8_t i = 0; i < bench_num_instances; i++)
+    {
+        p_slot = beacon_slot_get(bench_instances[i]);
+        beacon_slot_start(p_slot, WICED_FALSE);
+        beacon_slot_set_params(p_slot, &p_slot->params);
+        beacon_slot_set_data(p_slot, p_slot->adv_data, p_slot->adv_len);
+        beacon_slot_start(p_slot, WICED_TRUE);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_flip_field
+*********************************************************************************
+* Summary:
+*   Step changing the last data byte of the first benchmarked instance, the
+*   second call restores it
+*
+*********************************************************************************/
+static void beacon_bench_flip_field(void)
+{
+    beacon_slot_t *p_slot = beacon_slot_get(bench_instances[0]);
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+
+    memcpy(adv_data, p_slot->adv_data, p_slot->adv_len);
+    adv_data[p_slot->adv_len - 1] ^= 0x01;
+    beacon_slot_set_data(p_slot, adv_data, p_slot->adv_len);
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_resend_data
+*********************************************************************************
+* Summary:
+*   Step reissuing the data of the first benchmarked instance
+*
+*********************************************************************************/
+static void beacon_bench_resend_data(void)
+{
+    beacon_slot_t *p_slot = beacon_slot_get(bench_instances[0]);
+
+    beacon_slot_set_data(p_slot, p_slot->adv_data, p_slot->adv_len);
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_cold_start
+*********************************************************************************
+* Summary:
+*   Cold start scenario, the application configures and starts its
+*   instances from the stopped state
+*
+*********************************************************************************/
+static wiced_bool_t beacon_bench_cold_start(void)
+{
+    if (!beacon_bench_do(beacon_bench_stop_all))
+    {
+        return WICED_FALSE;
+    }
+    beacon_sim_reset_stats();
+    return beacon_bench_do(bench_cold_start_fn);
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_field_update
+*********************************************************************************
+* Summary:
+*   Single field update scenario, one data byte changes
+*
+*********************************************************************************/
+static wiced_bool_t beacon_bench_field_update(void)
+{
+    beacon_slot_t *p_slot = beacon_slot_get(bench_instances[0]);
+
+    if (0 == p_slot->adv_len)
+    {
+        return WICED_FALSE;
+    }
+    bench_saved_byte = p_slot->adv_data[p_slot->adv_len - 1];
+
+    beacon_sim_reset_stats();
+    return beacon_bench_do(beacon_bench_flip_field);
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_reconfigure
+*********************************************************************************
+* Summary:
+*   Full reconfiguration scenario. Also restores the data changed by the
+*   single field update.
+*
+*********************************************************************************/
+static wiced_bool_t beacon_bench_reconfigure(void)
+{
+    beacon_slot_t *p_slot = beacon_slot_get(bench_instances[0]);
+
+    if (0 != p_slot->adv_len)
+    {
+        p_slot->adv_data[p_slot->adv_len - 1] = bench_saved_byte;
+    }
+
+    beacon_sim_reset_stats();
+    return beacon_bench_do(beacon_bench_reissue_all);
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_recovery
+*********************************************************************************
+* Summary:
+*   Recovery scenario, the controller fails a set data command and the
+*   command is issued again
+*
+*********************************************************************************/
+static wiced_bool_t beacon_bench_recovery(void)
+{
+    beacon_slot_t *p_slot = beacon_slot_get(bench_instances[0]);
+    beacon_sim_config_t saved = *beacon_sim_get_config();
+    beacon_sim_config_t failing = saved;
+    uint32_t failed = p_slot->stats.cmd_failed;
+    wiced_bool_t result;
+
+    failing.fail_period  = 1;
+    failing.fail_opcodes = 1U << SET_ADVT_DATA_MULTI;
+
+    beacon_sim_reset_stats();
+    beacon_sim_configure(&failing);
+    result = beacon_bench_do(beacon_bench_resend_data);
+    beacon_sim_configure(&saved);
+
+    if (!result || (p_slot->stats.cmd_failed == failed))
+    {
+        return WICED_FALSE;
+    }
+    return beacon_bench_do(beacon_bench_resend_data);
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_init
+*********************************************************************************
+* Summary:
+*   Sets the application start up function and the instances it uses
+*
+* Parameters:
+*   p_cold_start:           Configures and starts the instances, run in the
+*                           beacon manager task
+*   instances:              Instances configured by p_cold_start
+*   num_instances:          Number of instances
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_bench_init(beacon_manager_fn_t *p_cold_start, const uint8_t *instances,
+                       uint8_t num_instances)
+{
+    bench_cold_start_fn = p_cold_start;
+    bench_num_instances = 0;
+
+    for (uint8_t i = 0; (i < num_instances) && (i < BEACON_SLOT_MAX_INSTANCES); i++)
+    {
+        if (NULL != beacon_slot_get(instances[i]))
+        {
+            bench_instances[bench_num_instances++] = instances[i];
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_bench_run
+*********************************************************************************
+* Summary:
+*   Runs every scenario and prints its cost against its budget. Call from a
+*   task below the beacon manager, after the stack is enabled.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Number of scenarios that failed or exceeded their budget
+*
+*********************************************************************************/
+uint32_t beacon_bench_run(void)
+{
+    const bench_scenario_t *p_scenario;
+    const beacon_sim_stats_t *p_stats = beacon_sim_get_stats();
+    const beacon_sim_trace_t *p_first;
+    beacon_bench_cost_t cost;
+    wiced_bool_t completed;
+    uint32_t failures = 0;
+
+    if ((NULL == bench_cold_start_fn) || (0 == bench_num_instances))
+    {
+        printf("Benchmark not initialized\n");
+        return 1;
+    }
+
+    for (uint8_t i = 0; i < sizeof(bench_scenarios) / sizeof(bench_scenarios[0]); i++)
+    {
+        p_scenario = &bench_scenarios[i];
+        completed  = p_scenario->p_run();
+
+        p_first        = beacon_sim_get_trace(0);
+        cost.commands  = p_stats->commands;
+        cost.hci_bytes = p_stats->hci_bytes;
+        cost.time_ms   = (NULL != p_first) ? (p_stats->last_resp_ms - p_first->issue_ms) : 0;
+
+        if (!completed || (cost.commands > p_scenario->budget.commands) ||
+            (cost.hci_bytes > p_scenario->budget.hci_bytes) ||
+            (cost.time_ms > p_scenario->budget.time_ms))
+        {
+            failures++;
+            completed = WICED_FALSE;
+        }
+
+        printf("%-22s %s: %lu/%lu commands, %lu/%lu bytes, %lu/%lu ms\n",
+               p_scenario->name, completed ? "PASS" : "FAIL",
+               (unsigned long)cost.commands, (unsigned long)p_scenario->budget.commands,
+               (unsigned long)cost.hci_bytes, (unsigned long)p_scenario->budget.hci_bytes,
+               (unsigned long)cost.time_ms, (unsigned long)p_scenario->budget.time_ms);
+    }
+
+    printf("Benchmark %s\n", (0 == failures) ? "passed" : "FAILED");
+    return failures;
+}
+
+/* [] END OF FILE */
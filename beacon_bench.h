@@ -0,0 +1,89 @@
+/******************************************************************************
+* File Name: beacon_bench.h
+*
+* Description: This file contains the definitions for the beacon lifecycle
+* benchmark. Scenarios run against the simulated controller and fail when
+* their HCI traffic or time exceeds the stored budget.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_BENCH_H__
+#define __BEACON_BENCH_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_manager.h"
+#include "beacon_sim.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to add the bench console command, requires BEACON_SIM_CONTROLLER */
+#ifndef BEACON_BENCH_ENABLE
+#define BEACON_BENCH_ENABLE              (0)
+#endif
+
+#if BEACON_BENCH_ENABLE && !BEACON_SIM_CONTROLLER
+#error "BEACON_BENCH_ENABLE requires BEACON_SIM_CONTROLLER"
+#endif
+
+/* Longest a scenario step may take before the run is aborted */
+#define BEACON_BENCH_STEP_TIMEOUT_MS     (2000)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Measured cost of one scenario */
+typedef struct
+{
+    uint32_t commands;                          /* HCI commands issued */
+    uint32_t hci_bytes;                         /* HCI command bytes */
+    uint32_t time_ms;                           /* First issue to last response */
+}beacon_bench_cost_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void     beacon_bench_init (beacon_manager_fn_t *p_cold_start, const uint8_t *instances,
+                            uint8_t num_instances);
+
+uint32_t beacon_bench_run  (void);
+
+#endif      /* __BEACON_BENCH_H__ */
+
+
+/* [] END OF FILE */
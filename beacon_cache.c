@@ -0,0 +1,420 @@
+/******************************************************************************
+* File Name: beacon_cache.c
+*
+* Description: This is the source code for the observed beacon cache. It is a
+* fixed size open addressing hash table keyed by device address and frame
+* identity, so no heap memory is used regardless of the number of beacons.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "beacon_cache.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define BEACON_CACHE_INDEX_MASK          (BEACON_CACHE_SIZE - 1)
+
+/* 32-bit FNV-1a parameters */
+#define FNV1A_OFFSET_BASIS               (0x811C9DC5UL)
+#define FNV1A_PRIME                      (0x01000193UL)
+
+#if (BEACON_CACHE_SIZE & BEACON_CACHE_INDEX_MASK)
+#error "BEACON_CACHE_SIZE must be a power of two"
+#endif
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: fnv1a
+*********************************************************************************
+* Summary:
+*   Continues a 32-bit FNV-1a hash over a byte buffer
+*
+*********************************************************************************/
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, uint8_t len)
+{
+    while (len--)
+    {
+        hash ^= *data++;
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
+/********************************************************************************
+* Function Name: beacon_cache_home
+*********************************************************************************
+* Summary:
+*   Returns the home index of a key
+*
+*********************************************************************************/
+static uint32_t beacon_cache_home(const wiced_bt_device_address_t bd_addr, uint32_t frame_id)
+{
+    uint8_t id[sizeof(frame_id)];
+    uint32_t hash;
+
+    id[0] = (uint8_t)frame_id;
+    id[1] = (uint8_t)(frame_id >> 8);
+    id[2] = (uint8_t)(frame_id >> 16);
+    id[3] = (uint8_t)(frame_id >> 24);
+
+    hash = fnv1a(FNV1A_OFFSET_BASIS, bd_addr, BD_ADDR_LEN);
+    hash = fnv1a(hash, id, sizeof(id));
+
+    return hash & BEACON_CACHE_INDEX_MASK;
+}
+
+/********************************************************************************
+* Function Name: beacon_cache_delete
+*********************************************************************************
+* Summary:
+*   Removes the entry at index and shifts the following entries of the probe
+*   sequence back, so the table never needs tombstones.
+*
+*********************************************************************************/
+static void beacon_cache_delete(beacon_cache_t *cache, uint32_t index)
+{
+    uint32_t hole = index;
+    uint32_t next = index;
+    uint32_t home;
+
+    for (;;)
+    {
+        next = (next + 1) & BEACON_CACHE_INDEX_MASK;
+        if (!cache->entry[next].in_use)
+        {
+            break;
+        }
+
+        home = beacon_cache_home(cache->entry[next].bd_addr, cache->entry[next].frame_id);
+
+        /* Move the entry if its home is not between the hole and its slot */
+        if (((next - home) & BEACON_CACHE_INDEX_MASK) >=
+            ((next - hole) & BEACON_CACHE_INDEX_MASK))
+        {
+            cache->entry[hole] = cache->entry[next];
+            hole = next;
+        }
+    }
+
+    cache->entry[hole].in_use = 0;
+    cache->used--;
+}
+
+/********************************************************************************
+* Function Name: beacon_cache_init
+*********************************************************************************
+* Summary:
+*   Clears all entries and statistics of the cache
+*
+* Parameters:
+*   cache:                  Cache instance
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_cache_init(beacon_cache_t *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+}
+
+/********************************************************************************
+* Function Name: beacon_cache_frame_id
+*********************************************************************************
+* Summary:
+*   Computes the identity of a parsed frame. Frames of the same format with the
+*   same identifying bytes map to the same value.
+*
+* Parameters:
+*   info:                   Parsed frame information
+*
+* Return:
+*   32-bit frame identity
+*
+*********************************************************************************/
+uint32_t beacon_cache_frame_id(const beacon_frame_info_t *info)
+{
+    uint8_t format = (uint8_t)info->format;
+    uint32_t hash = fnv1a(FNV1A_OFFSET_BASIS, &format, sizeof(format));
+
+    if (NULL != info->id)
+    {
+        hash = fnv1a(hash, info->id, info->id_len);
+    }
+    return hash;
+}
+
+/********************************************************************************
+* Function Name: beacon_cache_lookup
+*********************************************************************************
+* Summary:
+*   Finds the entry of a beacon
+*
+* Parameters:
+*   cache:                  Cache instance
+*   bd_addr:                Advertiser address
+*   frame_id:               Frame identity, see beacon_cache_frame_id
+*
+* Return:
+*   Pointer to the entry or NULL if the beacon is not cached
+*
+*********************************************************************************/
+beacon_cache_entry_t *beacon_cache_lookup(beacon_cache_t *cache,
+                                          const wiced_bt_device_address_t bd_addr,
+                                          uint32_t frame_id)
+{
+    uint32_t index = beacon_cache_home(bd_addr, frame_id);
+    beacon_cache_entry_t *entry;
+
+    for (uint8_t probe = 0; probe < BEACON_CACHE_MAX_PROBE; probe++)
+    {
+        entry = &cache->entry[(index + probe) & BEACON_CACHE_INDEX_MASK];
+        if (!entry->in_use)
+        {
+            break;
+        }
+        if ((entry->frame_id == frame_id) &&
+            (0 == memcmp(entry->bd_addr, bd_addr, BD_ADDR_LEN)))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/********************************************************************************
+* Function Name: beacon_cache_update
+*********************************************************************************
+* Summary:
+*   Accounts one advertising report. A new beacon takes a free slot of its
+*   probe sequence; when the table is at its load limit the least recently seen
+*   beacon of the BEACON_CACHE_MAX_PROBE slots from its home is replaced
+*   instead. A beacon past the free slot is removed with a backward shift and
+*   the new one takes the free slot. The report is dropped only when those
+*   slots hold no beacon at all.
+*
+* Parameters:
+*   cache:                  Cache instance
+*   bd_addr:                Advertiser address
+*   info:                   Parsed frame information
+*   rssi:                   Received signal strength in dBm
+*   now_ms:                 Current time in milliseconds
+*
+* Return:
+*   Pointer to the updated entry or NULL if the report was dropped
+*
+*********************************************************************************/
+beacon_cache_entry_t *beacon_cache_update(beacon_cache_t *cache,
+                                          const wiced_bt_device_address_t bd_addr,
+                                          const beacon_frame_info_t *info,
+                                          int8_t rssi, uint32_t now_ms)
+{
+    uint32_t frame_id = beacon_cache_frame_id(info);
+    uint32_t index = beacon_cache_home(bd_addr, frame_id);
+    int32_t sample = (int32_t)rssi * (1 << BEACON_CACHE_RSSI_FRAC_BITS);
+    beacon_cache_entry_t *entry;
+    beacon_cache_entry_t *victim = NULL;
+    beacon_cache_entry_t *free_entry = NULL;
+    uint8_t victim_probe = 0;
+    uint8_t free_probe = 0;
+
+    cache->reports++;
+
+    for (uint8_t probe = 0; probe < BEACON_CACHE_MAX_PROBE; probe++)
+    {
+        entry = &cache->entry[(index + probe) & BEACON_CACHE_INDEX_MASK];
+        if (!entry->in_use)
+        {
+            if (NULL == free_entry)
+            {
+                free_entry = entry;
+                free_probe = probe;
+            }
+
+            /* At the load limit look on for the beacon to replace */
+            if (cache->used < BEACON_CACHE_MAX_LOAD)
+            {
+                break;
+            }
+            continue;
+        }
+
+        /* The beacon is not stored past a free slot */
+        if ((NULL == free_entry) && (entry->frame_id == frame_id) &&
+            (0 == memcmp(entry->bd_addr, bd_addr, BD_ADDR_LEN)))
+        {
+            entry->last_seen_ms = now_ms;
+            entry->count++;
+            entry->rssi_q8 += (int16_t)((sample - entry->rssi_q8) / (1 << BEACON_CACHE_RSSI_SHIFT));
+            entry->measured_power = info->measured_power;
+#if BEACON_PROXIMITY_ENABLE
+            beacon_proximity_update(&entry->proximity, info, rssi, now_ms);
+#endif
+            return entry;
+        }
+
+        if ((NULL == victim) || ((int32_t)(victim->last_seen_ms - entry->last_seen_ms) > 0))
+        {
+            victim       = entry;
+            victim_probe = probe;
+        }
+    }
+
+    if ((NULL != free_entry) && (cache->used < BEACON_CACHE_MAX_LOAD))
+    {
+        entry = free_entry;
+        cache->used++;
+    }
+    else if ((NULL != victim) && (NULL != free_entry) && (victim_probe > free_probe))
+    {
+        /* The shift only moves beacons after the victim, the free slot
+         * before it stays free */
+        beacon_cache_delete(cache, (index + victim_probe) & BEACON_CACHE_INDEX_MASK);
+        entry = free_entry;
+        cache->used++;
+        cache->evict_full++;
+    }
+    else if (NULL != victim)
+    {
+        entry = victim;
+        cache->evict_full++;
+    }
+    else
+    {
+        cache->dropped++;
+        return NULL;
+    }
+
+    memcpy(entry->bd_addr, bd_addr, BD_ADDR_LEN);
+    entry->in_use         = 1;
+    entry->format         = (uint8_t)info->format;
+    entry->frame_id       = frame_id;
+    entry->first_seen_ms  = now_ms;
+    entry->last_seen_ms   = now_ms;
+    entry->count          = 1;
+    entry->rssi_q8        = (int16_t)sample;
+    entry->measured_power = info->measured_power;
+#if BEACON_PROXIMITY_ENABLE
+    beacon_proximity_reset(&entry->proximity);
+    beacon_proximity_update(&entry->proximity, info, rssi, now_ms);
+#endif
+    cache->inserts++;
+
+    return entry;
+}
+
+/********************************************************************************
+* Function Name: beacon_cache_flush
+*********************************************************************************
+* Summary:
+*   Emits one aggregated record for every beacon reported since the previous
+*   flush, restarts the per period counters and evicts beacons that have not
+*   been seen for BEACON_CACHE_AGE_MS. Beacons that do not fit into records
+*   keep their counters and are emitted by the next flush.
+*
+* Parameters:
+*   cache:                  Cache instance
+*   now_ms:                 Current time in milliseconds
+*   records:                Output array of aggregated records
+*   max_records:            Capacity of records
+*
+* Return:
+*   Number of records written
+*
+*********************************************************************************/
+uint16_t beacon_cache_flush(beacon_cache_t *cache, uint32_t now_ms,
+                            beacon_cache_record_t *records, uint16_t max_records)
+{
+    uint16_t num_records = 0;
+    uint32_t start = 0;
+    uint32_t index;
+    beacon_cache_entry_t *entry;
+    beacon_cache_record_t *record;
+
+    /* Start right after a free slot so that shifted entries never wrap into
+     * the part of the table that has already been visited. The load limit
+     * guarantees that a free slot exists. */
+    while (cache->entry[start].in_use)
+    {
+        start++;
+    }
+
+    for (uint32_t step = 1; step <= BEACON_CACHE_SIZE; step++)
+    {
+        index = (start + step) & BEACON_CACHE_INDEX_MASK;
+        entry = &cache->entry[index];
+
+        while (entry->in_use)
+        {
+            if ((entry->count > 0) && (num_records < max_records))
+            {
+                record = &records[num_records++];
+                memcpy(record->bd_addr, entry->bd_addr, BD_ADDR_LEN);
+                record->format         = entry->format;
+                record->rssi           = (int8_t)((entry->rssi_q8 +
+                                         (1 << (BEACON_CACHE_RSSI_FRAC_BITS - 1))) >>
+                                         BEACON_CACHE_RSSI_FRAC_BITS);
+                record->measured_power = entry->measured_power;
+                record->frame_id       = entry->frame_id;
+                record->first_seen_ms  = entry->first_seen_ms;
+                record->last_seen_ms   = entry->last_seen_ms;
+                record->count          = entry->count;
+#if BEACON_PROXIMITY_ENABLE
+                record->proximity      = entry->proximity;
+#endif
+                entry->count = 0;
+            }
+
+            if ((uint32_t)(now_ms - entry->last_seen_ms) < BEACON_CACHE_AGE_MS)
+            {
+                break;
+            }
+
+            /* The slot is refilled by the backward shift, so check it again */
+            beacon_cache_delete(cache, index);
+            cache->evict_age++;
+        }
+    }
+
+    return num_records;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,150 @@
+/******************************************************************************
+* File Name: beacon_cache.h
+*
+* Description: This file contains the definitions for the observed beacon
+* cache. The cache de-duplicates advertising reports and aggregates them into
+* one record per beacon and reporting period.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_CACHE_H__
+#define __BEACON_CACHE_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_proximity.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Number of cache entries, must be a power of two */
+#ifndef BEACON_CACHE_SIZE
+#define BEACON_CACHE_SIZE                (64)
+#endif
+
+/* Maximum number of occupied entries. Keeping one quarter of the table free
+ * bounds the probe length and guarantees an empty slot for deletion. */
+#define BEACON_CACHE_MAX_LOAD            ((BEACON_CACHE_SIZE * 3) / 4)
+
+/* Maximum number of slots examined before an entry is replaced */
+#define BEACON_CACHE_MAX_PROBE           (8)
+
+/* Entries not seen for this long are evicted on the next flush */
+#ifndef BEACON_CACHE_AGE_MS
+#define BEACON_CACHE_AGE_MS              (30000)
+#endif
+
+/* EWMA weight of a new RSSI sample is 1 / (1 << BEACON_CACHE_RSSI_SHIFT) */
+#define BEACON_CACHE_RSSI_SHIFT          (3)
+
+/* RSSI values are kept in Q8 fixed point */
+#define BEACON_CACHE_RSSI_FRAC_BITS      (8)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* One observed beacon */
+typedef struct
+{
+    wiced_bt_device_address_t bd_addr;          /* Advertiser address */
+    uint8_t  in_use;                            /* Entry holds a beacon */
+    uint8_t  format;                            /* beacon_format_t of the frame */
+    uint32_t frame_id;                          /* Hash of the frame identity */
+    uint32_t first_seen_ms;                     /* Time of the first report */
+    uint32_t last_seen_ms;                      /* Time of the latest report */
+    uint32_t count;                             /* Reports in the current period */
+    int16_t  rssi_q8;                           /* EWMA smoothed RSSI */
+    int8_t   measured_power;                    /* Calibrated power in the frame */
+#if BEACON_PROXIMITY_ENABLE
+    beacon_proximity_t proximity;               /* Filtered path loss and zone */
+#endif
+}beacon_cache_entry_t;
+
+/* Aggregated record handed to the application once per period */
+typedef struct
+{
+    wiced_bt_device_address_t bd_addr;          /* Advertiser address */
+    uint8_t  format;                            /* beacon_format_t of the frame */
+    int8_t   rssi;                              /* Smoothed RSSI in dBm */
+    int8_t   measured_power;                    /* Calibrated power in the frame */
+    uint32_t frame_id;                          /* Hash of the frame identity */
+    uint32_t first_seen_ms;                     /* Time of the first report */
+    uint32_t last_seen_ms;                      /* Time of the latest report */
+    uint32_t count;                             /* Reports in the period */
+#if BEACON_PROXIMITY_ENABLE
+    beacon_proximity_t proximity;               /* Filtered path loss and zone, see
+                                                   beacon_proximity_distance_cm */
+#endif
+}beacon_cache_record_t;
+
+/* Cache instance, all storage is part of the structure */
+typedef struct
+{
+    beacon_cache_entry_t entry[BEACON_CACHE_SIZE];
+    uint16_t used;                              /* Occupied entries */
+    uint32_t reports;                           /* Reports processed */
+    uint32_t inserts;                           /* New beacons added */
+    uint32_t evict_full;                        /* Entries replaced when full */
+    uint32_t evict_age;                         /* Entries removed by age */
+    uint32_t dropped;                           /* Reports not admitted, nothing to replace */
+}beacon_cache_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                  beacon_cache_init     (beacon_cache_t *cache);
+
+uint32_t              beacon_cache_frame_id (const beacon_frame_info_t *info);
+
+beacon_cache_entry_t *beacon_cache_update   (beacon_cache_t *cache,
+                                             const wiced_bt_device_address_t bd_addr,
+                                             const beacon_frame_info_t *info,
+                                             int8_t rssi, uint32_t now_ms);
+
+beacon_cache_entry_t *beacon_cache_lookup   (beacon_cache_t *cache,
+                                             const wiced_bt_device_address_t bd_addr,
+                                             uint32_t frame_id);
+
+uint16_t              beacon_cache_flush    (beacon_cache_t *cache, uint32_t now_ms,
+                                             beacon_cache_record_t *records,
+                                             uint16_t max_records);
+
+#endif      /* __BEACON_CACHE_H__ */
+
+
+/* [] END OF FILE */
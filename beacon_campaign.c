@@ -0,0 +1,373 @@
+/******************************************************************************
+* File Name: beacon_campaign.c
+*
+* Description: This is the source code for payload campaigns. The next
+* transition is found by binary search in the sorted table and armed as a
+* single timer deadline. When it is due, the pre-encoded payload is issued
+* as a data only update, nothing is encoded at runtime and the RAM used
+* does not depend on the size of the table.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "wiced_bt_stack.h"
+#include "beacon_campaign.h"
+#include "beacon_format.h"
+#include "beacon_power.h"
+#include "beacon_stats.h"
+#include "beacon_timer.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Retry delay when the stack did not accept a transition */
+#define CAMPAIGN_RETRY_MS                (1000)
+
+/* Longest deadline armed. The campaign clock is carried forward at least
+ * this often, well before the millisecond counter wraps. */
+#define CAMPAIGN_MAX_WAIT_MS             (24UL * 60UL * 60UL * 1000UL)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static const beacon_campaign_table_t *campaign_table;
+static uint32_t                       campaign_base_s;      /* Campaign time at base_ms */
+static uint32_t                       campaign_base_ms;
+static beacon_timer_t                 campaign_timer;
+static beacon_campaign_stats_t        campaign_stats;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_campaign_find
+*********************************************************************************
+* Summary:
+*   Binary search for the first transition after a time
+*
+* Parameters:
+*   p_table:                Campaign table
+*   time_s:                 Campaign time
+*
+* Return:
+*   Index of the first entry with start_s after time_s, num_entries if none
+*
+*********************************************************************************/
+uint32_t beacon_campaign_find(const beacon_campaign_table_t *p_table, uint32_t time_s)
+{
+    uint32_t low = 0;
+    uint32_t high = p_table->num_entries;
+    uint32_t mid;
+
+    while (low < high)
+    {
+        mid = low + ((high - low) / 2);
+        if (p_table->p_entries[mid].start_s <= time_s)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/********************************************************************************
+* Function Name: beacon_campaign_now
+*********************************************************************************
+* Summary:
+*   Returns the campaign time, and the milliseconds into the current second.
+*   Whole seconds are moved into the base so the difference of the
+*   millisecond counter stays small.
+*
+*********************************************************************************/
+static uint32_t beacon_campaign_now(uint32_t *p_frac_ms)
+{
+    uint32_t elapsed_s = (beacon_stats_now_ms() - campaign_base_ms) / 1000;
+
+    campaign_base_s  += elapsed_s;
+    campaign_base_ms += elapsed_s * 1000;
+
+    if (NULL != p_frac_ms)
+    {
+        *p_frac_ms = beacon_stats_now_ms() - campaign_base_ms;
+    }
+    return campaign_base_s;
+}
+
+/********************************************************************************
+* Function Name: beacon_campaign_apply
+*********************************************************************************
+* Summary:
+*   Issues the payload of a transition as a data only update
+*
+*********************************************************************************/
+static wiced_result_t beacon_campaign_apply(const beacon_campaign_entry_t *p_entry)
+{
+    const beacon_campaign_payload_t *p_payload = &campaign_table->p_payloads[p_entry->payload];
+    beacon_slot_t *p_slot = beacon_slot_get(p_entry->instance);
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+
+    memcpy(adv_data, p_payload->data, p_payload->len);
+    beacon_power_fix_data(p_slot, adv_data, p_payload->len);
+
+    return beacon_slot_set_data(p_slot, adv_data, p_payload->len);
+}
+
+/********************************************************************************
+* Function Name: beacon_campaign_arm
+*********************************************************************************
+* Summary:
+*   Arms the timer for the next transition
+*
+*********************************************************************************/
+static void beacon_campaign_arm(uint32_t now_s, uint32_t frac_ms)
+{
+    uint32_t wait_s;
+    uint32_t wait_ms;
+
+    if (campaign_stats.next >= campaign_table->num_entries)
+    {
+        return;
+    }
+
+    wait_s  = campaign_table->p_entries[campaign_stats.next].start_s - now_s;
+    wait_ms = CAMPAIGN_MAX_WAIT_MS;
+    if (wait_s < (CAMPAIGN_MAX_WAIT_MS / 1000))
+    {
+        wait_ms = (wait_s * 1000) - frac_ms;
+    }
+    beacon_timer_start(&campaign_timer, wait_ms);
+}
+
+/********************************************************************************
+* Function Name: beacon_campaign_due
+*********************************************************************************
+* Summary:
+*   Timer callback, runs in the beacon manager task. Issues every transition
+*   that is due; of several due for the same instance only the last one.
+*
+*********************************************************************************/
+static void beacon_campaign_due(beacon_timer_t *p_timer)
+{
+    const beacon_campaign_entry_t *p_entries = campaign_table->p_entries;
+    uint32_t num_entries = campaign_table->num_entries;
+    uint32_t frac_ms;
+    uint32_t now_s = beacon_campaign_now(&frac_ms);
+    wiced_bool_t superseded;
+
+    (void)p_timer;
+
+    while ((campaign_stats.next < num_entries) &&
+           (p_entries[campaign_stats.next].start_s <= now_s))
+    {
+        superseded = WICED_FALSE;
+        for (uint32_t later = campaign_stats.next + 1;
+             !superseded && (later < num_entries) && (p_entries[later].start_s <= now_s); later++)
+        {
+            superseded = (p_entries[later].instance == p_entries[campaign_stats.next].instance);
+        }
+
+        if (superseded)
+        {
+            campaign_stats.superseded++;
+        }
+        else if (WICED_BT_PENDING == beacon_campaign_apply(&p_entries[campaign_stats.next]))
+        {
+            campaign_stats.transitions++;
+        }
+        else
+        {
+            campaign_stats.rejected++;
+            beacon_timer_start(&campaign_timer, CAMPAIGN_RETRY_MS);
+            return;
+        }
+        campaign_stats.next++;
+    }
+
+    beacon_campaign_arm(now_s, frac_ms);
+}
+
+/********************************************************************************
+* Function Name: beacon_campaign_check
+*********************************************************************************
+* Summary:
+*   Checks that a table is sorted and refers to managed instances and to
+*   payloads of the pool
+*
+*********************************************************************************/
+static wiced_bool_t beacon_campaign_check(const beacon_campaign_table_t *p_table)
+{
+    const beacon_campaign_entry_t *p_entry;
+
+    for (uint32_t i = 0; i < p_table->num_entries; i++)
+    {
+        p_entry = &p_table->p_entries[i];
+        if (((i > 0) && (p_entry->start_s < p_table->p_entries[i - 1].start_s)) ||
+            (NULL == beacon_slot_get(p_entry->instance)) ||
+            (p_entry->payload >= p_table->num_payloads) ||
+            (p_table->p_payloads[p_entry->payload].len > BEACON_ADV_DATA_MAX))
+        {
+            return WICED_FALSE;
+        }
+    }
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_campaign_set_time
+*********************************************************************************
+* Summary:
+*   Sets the campaign time and runs a table from there. Every instance of
+*   the table is put on its payload at that time, found by walking back from
+*   the next transition, and a format bound to it is unbound. Call from the
+*   beacon manager task; calling again moves the time.
+*
+* Parameters:
+*   p_table:                Campaign table, must stay valid
+*   time_s:                 Current time, seconds since 1970 UTC
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when payloads were issued,
+*   WICED_BT_SUCCESS if no transition is past yet
+*
+*********************************************************************************/
+wiced_result_t beacon_campaign_set_time(const beacon_campaign_table_t *p_table, uint32_t time_s)
+{
+    const beacon_campaign_entry_t *p_entry;
+    uint32_t pending = 0;
+    uint32_t done = 0;
+    wiced_result_t result = WICED_BT_SUCCESS;
+    uint32_t next;
+
+    if ((BEACON_CAMPAIGN_NO_TIME == time_s) || !beacon_campaign_check(p_table))
+    {
+        return WICED_BT_BADARG;
+    }
+
+    if (NULL != campaign_table)
+    {
+        beacon_timer_stop(&campaign_timer);
+    }
+    campaign_table   = p_table;
+    campaign_base_s  = time_s;
+    campaign_base_ms = beacon_stats_now_ms();
+    beacon_timer_setup(&campaign_timer, beacon_campaign_due, NULL);
+
+    next = beacon_campaign_find(p_table, time_s);
+    campaign_stats.next = next;
+
+    /* Instances of the table, then the ones already put on their payload */
+    for (uint32_t i = 0; i < p_table->num_entries; i++)
+    {
+        pending |= 1UL << (p_table->p_entries[i].instance - 1);
+    }
+
+    for (uint32_t i = next; (i > 0) && (done != pending); i--)
+    {
+        p_entry = &p_table->p_entries[i - 1];
+        if (0 != (done & (1UL << (p_entry->instance - 1))))
+        {
+            continue;
+        }
+        done |= 1UL << (p_entry->instance - 1);
+
+        beacon_format_bind(beacon_slot_get(p_entry->instance), NULL, NULL);
+        if (WICED_BT_PENDING != beacon_campaign_apply(p_entry))
+        {
+            campaign_stats.rejected++;
+            result = WICED_BT_ERROR;
+        }
+        else if (WICED_BT_SUCCESS == result)
+        {
+            campaign_stats.transitions++;
+            result = WICED_BT_PENDING;
+        }
+    }
+
+    beacon_campaign_arm(time_s, 0);
+
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_campaign_time
+*********************************************************************************
+* Summary:
+*   Returns the campaign time
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Seconds since 1970 UTC, BEACON_CAMPAIGN_NO_TIME before the time is set
+*
+*********************************************************************************/
+uint32_t beacon_campaign_time(void)
+{
+    uint32_t elapsed_ms;
+
+    if (NULL == campaign_table)
+    {
+        return BEACON_CAMPAIGN_NO_TIME;
+    }
+    elapsed_ms = beacon_stats_now_ms() - campaign_base_ms;
+    return campaign_base_s + (elapsed_ms / 1000);
+}
+
+/********************************************************************************
+* Function Name: beacon_campaign_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the transition counters
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Pointer to the counters
+*
+*********************************************************************************/
+const beacon_campaign_stats_t *beacon_campaign_get_stats(void)
+{
+    return &campaign_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,127 @@
+/******************************************************************************
+* File Name: beacon_campaign.h
+*
+* Description: This file contains the definitions for payload campaigns. A
+* campaign table lists, sorted by time, when an instance switches to another
+* pre-encoded advertisement. It is compiled from a calendar on the host by
+* scripts/beacon_campaign.py and kept in flash.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_CAMPAIGN_H__
+#define __BEACON_CAMPAIGN_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to advertise the campaigns of beacon_campaign_table.c */
+#ifndef BEACON_CAMPAIGN_ENABLE
+#define BEACON_CAMPAIGN_ENABLE           (0)
+#endif
+
+/* Campaign time at start-up, in seconds since 1970 UTC. With 0 the
+ * campaigns wait until the campaign console command sets the time. */
+#ifndef BEACON_CAMPAIGN_START_S
+#define BEACON_CAMPAIGN_START_S          (0)
+#endif
+
+/* Returned by beacon_campaign_time before the time is set */
+#define BEACON_CAMPAIGN_NO_TIME          (0)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Transition: from start_s on, the instance advertises the payload */
+typedef struct
+{
+    uint32_t start_s;                           /* Seconds since 1970 UTC */
+    uint16_t payload;                           /* Index in the payload pool */
+    uint8_t instance;                           /* Multi-adv instance */
+    uint8_t reserved;
+}beacon_campaign_entry_t;
+
+/* Pre-encoded advertisement, shared by every transition to it */
+typedef struct
+{
+    uint8_t len;                                /* Length of data */
+    uint8_t data[BEACON_ADV_DATA_MAX];          /* Advertisement data */
+}beacon_campaign_payload_t;
+
+/* Compiled campaign table */
+typedef struct
+{
+    const beacon_campaign_entry_t *p_entries;   /* Sorted by start_s */
+    uint32_t num_entries;
+    const beacon_campaign_payload_t *p_payloads;
+    uint16_t num_payloads;
+}beacon_campaign_table_t;
+
+/* Transition counters */
+typedef struct
+{
+    uint32_t transitions;                       /* Payloads put on air */
+    uint32_t superseded;                        /* Transitions due together with a
+                                                   later one of the same instance */
+    uint32_t rejected;                          /* Updates not accepted by the stack */
+    uint32_t next;                              /* Index of the next transition */
+}beacon_campaign_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+/* Generated by scripts/beacon_campaign.py */
+extern const beacon_campaign_table_t beacon_campaign_table;
+
+uint32_t                       beacon_campaign_find      (const beacon_campaign_table_t *p_table,
+                                                          uint32_t time_s);
+
+wiced_result_t                 beacon_campaign_set_time  (const beacon_campaign_table_t *p_table,
+                                                          uint32_t time_s);
+
+uint32_t                       beacon_campaign_time      (void);
+
+const beacon_campaign_stats_t *beacon_campaign_get_stats (void);
+
+#endif      /* __BEACON_CAMPAIGN_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,182 @@
+/******************************************************************************
+* File Name: beacon_campaign_table.c
+*
+* Description: Campaign table generated from campaign.json by
+* scripts/beacon_campaign.py, do not edit. 112 transitions, 4 payloads.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "beacon_campaign.h"
+
+#if BEACON_CAMPAIGN_ENABLE
+
+static const beacon_campaign_payload_t campaign_payloads[] =
+{
+    /* site */
+    { 23, { 0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x0F, 0x16, 0xAA, 0xFE, 0x10, 0xD7, 0x00, 0x69, 0x6E, 0x66, 0x69, 0x6E, 0x65, 0x6F, 0x6E, 0x07 } },
+    /* store */
+    { 30, { 0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x00, 0x01, 0x00, 0x02, 0xC5 } },
+    /* promo */
+    { 30, { 0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x00, 0x64, 0x00, 0x02, 0xC5 } },
+    /* sale */
+    { 27, { 0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x13, 0x16, 0xAA, 0xFE, 0x10, 0xD7, 0x00, 0x69, 0x6E, 0x66, 0x69, 0x6E, 0x65, 0x6F, 0x6E, 0x00, 0x73, 0x61, 0x6C, 0x65 } },
+};
+
+static const beacon_campaign_entry_t campaign_entries[] =
+{
+    { 1793487600u,   0, 1, 0 },    /* 2026-10-31 23:00 UTC */
+    { 1793487600u,   1, 2, 0 },    /* 2026-10-31 23:00 UTC */
+    { 1793635200u,   2, 2, 0 },    /* 2026-11-02 16:00 UTC */
+    { 1793642400u,   1, 2, 0 },    /* 2026-11-02 18:00 UTC */
+    { 1793721600u,   2, 2, 0 },    /* 2026-11-03 16:00 UTC */
+    { 1793728800u,   1, 2, 0 },    /* 2026-11-03 18:00 UTC */
+    { 1793808000u,   2, 2, 0 },    /* 2026-11-04 16:00 UTC */
+    { 1793815200u,   1, 2, 0 },    /* 2026-11-04 18:00 UTC */
+    { 1793894400u,   2, 2, 0 },    /* 2026-11-05 16:00 UTC */
+    { 1793901600u,   1, 2, 0 },    /* 2026-11-05 18:00 UTC */
+    { 1793980800u,   2, 2, 0 },    /* 2026-11-06 16:00 UTC */
+    { 1793988000u,   1, 2, 0 },    /* 2026-11-06 18:00 UTC */
+    { 1794038400u,   2, 2, 0 },    /* 2026-11-07 08:00 UTC */
+    { 1794070800u,   1, 2, 0 },    /* 2026-11-07 17:00 UTC */
+    { 1794240000u,   2, 2, 0 },    /* 2026-11-09 16:00 UTC */
+    { 1794247200u,   1, 2, 0 },    /* 2026-11-09 18:00 UTC */
+    { 1794326400u,   2, 2, 0 },    /* 2026-11-10 16:00 UTC */
+    { 1794333600u,   1, 2, 0 },    /* 2026-11-10 18:00 UTC */
+    { 1794412800u,   2, 2, 0 },    /* 2026-11-11 16:00 UTC */
+    { 1794420000u,   1, 2, 0 },    /* 2026-11-11 18:00 UTC */
+    { 1794499200u,   2, 2, 0 },    /* 2026-11-12 16:00 UTC */
+    { 1794506400u,   1, 2, 0 },    /* 2026-11-12 18:00 UTC */
+    { 1794585600u,   2, 2, 0 },    /* 2026-11-13 16:00 UTC */
+    { 1794592800u,   1, 2, 0 },    /* 2026-11-13 18:00 UTC */
+    { 1794643200u,   2, 2, 0 },    /* 2026-11-14 08:00 UTC */
+    { 1794675600u,   1, 2, 0 },    /* 2026-11-14 17:00 UTC */
+    { 1794844800u,   2, 2, 0 },    /* 2026-11-16 16:00 UTC */
+    { 1794852000u,   1, 2, 0 },    /* 2026-11-16 18:00 UTC */
+    { 1794931200u,   2, 2, 0 },    /* 2026-11-17 16:00 UTC */
+    { 1794938400u,   1, 2, 0 },    /* 2026-11-17 18:00 UTC */
+    { 1795017600u,   2, 2, 0 },    /* 2026-11-18 16:00 UTC */
+    { 1795024800u,   1, 2, 0 },    /* 2026-11-18 18:00 UTC */
+    { 1795104000u,   2, 2, 0 },    /* 2026-11-19 16:00 UTC */
+    { 1795111200u,   1, 2, 0 },    /* 2026-11-19 18:00 UTC */
+    { 1795190400u,   2, 2, 0 },    /* 2026-11-20 16:00 UTC */
+    { 1795197600u,   1, 2, 0 },    /* 2026-11-20 18:00 UTC */
+    { 1795248000u,   2, 2, 0 },    /* 2026-11-21 08:00 UTC */
+    { 1795280400u,   1, 2, 0 },    /* 2026-11-21 17:00 UTC */
+    { 1795449600u,   2, 2, 0 },    /* 2026-11-23 16:00 UTC */
+    { 1795456800u,   1, 2, 0 },    /* 2026-11-23 18:00 UTC */
+    { 1795536000u,   2, 2, 0 },    /* 2026-11-24 16:00 UTC */
+    { 1795543200u,   1, 2, 0 },    /* 2026-11-24 18:00 UTC */
+    { 1795622400u,   2, 2, 0 },    /* 2026-11-25 16:00 UTC */
+    { 1795629600u,   1, 2, 0 },    /* 2026-11-25 18:00 UTC */
+    { 1795708800u,   2, 2, 0 },    /* 2026-11-26 16:00 UTC */
+    { 1795716000u,   1, 2, 0 },    /* 2026-11-26 18:00 UTC */
+    { 1795734000u,   3, 1, 0 },    /* 2026-11-26 23:00 UTC */
+    { 1795795200u,   2, 2, 0 },    /* 2026-11-27 16:00 UTC */
+    { 1795802400u,   1, 2, 0 },    /* 2026-11-27 18:00 UTC */
+    { 1795820400u,   0, 1, 0 },    /* 2026-11-27 23:00 UTC */
+    { 1795852800u,   2, 2, 0 },    /* 2026-11-28 08:00 UTC */
+    { 1795885200u,   1, 2, 0 },    /* 2026-11-28 17:00 UTC */
+    { 1795993200u,   3, 1, 0 },    /* 2026-11-29 23:00 UTC */
+    { 1796054400u,   2, 2, 0 },    /* 2026-11-30 16:00 UTC */
+    { 1796061600u,   1, 2, 0 },    /* 2026-11-30 18:00 UTC */
+    { 1796079600u,   0, 1, 0 },    /* 2026-11-30 23:00 UTC */
+    { 1796140800u,   2, 2, 0 },    /* 2026-12-01 16:00 UTC */
+    { 1796148000u,   1, 2, 0 },    /* 2026-12-01 18:00 UTC */
+    { 1796227200u,   2, 2, 0 },    /* 2026-12-02 16:00 UTC */
+    { 1796234400u,   1, 2, 0 },    /* 2026-12-02 18:00 UTC */
+    { 1796313600u,   2, 2, 0 },    /* 2026-12-03 16:00 UTC */
+    { 1796320800u,   1, 2, 0 },    /* 2026-12-03 18:00 UTC */
+    { 1796400000u,   2, 2, 0 },    /* 2026-12-04 16:00 UTC */
+    { 1796407200u,   1, 2, 0 },    /* 2026-12-04 18:00 UTC */
+    { 1796457600u,   2, 2, 0 },    /* 2026-12-05 08:00 UTC */
+    { 1796490000u,   1, 2, 0 },    /* 2026-12-05 17:00 UTC */
+    { 1796659200u,   2, 2, 0 },    /* 2026-12-07 16:00 UTC */
+    { 1796666400u,   1, 2, 0 },    /* 2026-12-07 18:00 UTC */
+    { 1796745600u,   2, 2, 0 },    /* 2026-12-08 16:00 UTC */
+    { 1796752800u,   1, 2, 0 },    /* 2026-12-08 18:00 UTC */
+    { 1796832000u,   2, 2, 0 },    /* 2026-12-09 16:00 UTC */
+    { 1796839200u,   1, 2, 0 },    /* 2026-12-09 18:00 UTC */
+    { 1796918400u,   2, 2, 0 },    /* 2026-12-10 16:00 UTC */
+    { 1796925600u,   1, 2, 0 },    /* 2026-12-10 18:00 UTC */
+    { 1797004800u,   2, 2, 0 },    /* 2026-12-11 16:00 UTC */
+    { 1797012000u,   1, 2, 0 },    /* 2026-12-11 18:00 UTC */
+    { 1797062400u,   2, 2, 0 },    /* 2026-12-12 08:00 UTC */
+    { 1797094800u,   1, 2, 0 },    /* 2026-12-12 17:00 UTC */
+    { 1797264000u,   2, 2, 0 },    /* 2026-12-14 16:00 UTC */
+    { 1797271200u,   1, 2, 0 },    /* 2026-12-14 18:00 UTC */
+    { 1797350400u,   2, 2, 0 },    /* 2026-12-15 16:00 UTC */
+    { 1797357600u,   1, 2, 0 },    /* 2026-12-15 18:00 UTC */
+    { 1797436800u,   2, 2, 0 },    /* 2026-12-16 16:00 UTC */
+    { 1797444000u,   1, 2, 0 },    /* 2026-12-16 18:00 UTC */
+    { 1797523200u,   2, 2, 0 },    /* 2026-12-17 16:00 UTC */
+    { 1797530400u,   1, 2, 0 },    /* 2026-12-17 18:00 UTC */
+    { 1797609600u,   2, 2, 0 },    /* 2026-12-18 16:00 UTC */
+    { 1797616800u,   1, 2, 0 },    /* 2026-12-18 18:00 UTC */
+    { 1797667200u,   2, 2, 0 },    /* 2026-12-19 08:00 UTC */
+    { 1797699600u,   1, 2, 0 },    /* 2026-12-19 17:00 UTC */
+    { 1797868800u,   2, 2, 0 },    /* 2026-12-21 16:00 UTC */
+    { 1797876000u,   1, 2, 0 },    /* 2026-12-21 18:00 UTC */
+    { 1797955200u,   2, 2, 0 },    /* 2026-12-22 16:00 UTC */
+    { 1797962400u,   1, 2, 0 },    /* 2026-12-22 18:00 UTC */
+    { 1798041600u,   2, 2, 0 },    /* 2026-12-23 16:00 UTC */
+    { 1798048800u,   1, 2, 0 },    /* 2026-12-23 18:00 UTC */
+    { 1798095600u,   3, 1, 0 },    /* 2026-12-24 07:00 UTC */
+    { 1798117200u,   0, 1, 0 },    /* 2026-12-24 13:00 UTC */
+    { 1798128000u,   2, 2, 0 },    /* 2026-12-24 16:00 UTC */
+    { 1798135200u,   1, 2, 0 },    /* 2026-12-24 18:00 UTC */
+    { 1798214400u,   2, 2, 0 },    /* 2026-12-25 16:00 UTC */
+    { 1798221600u,   1, 2, 0 },    /* 2026-12-25 18:00 UTC */
+    { 1798272000u,   2, 2, 0 },    /* 2026-12-26 08:00 UTC */
+    { 1798304400u,   1, 2, 0 },    /* 2026-12-26 17:00 UTC */
+    { 1798473600u,   2, 2, 0 },    /* 2026-12-28 16:00 UTC */
+    { 1798480800u,   1, 2, 0 },    /* 2026-12-28 18:00 UTC */
+    { 1798560000u,   2, 2, 0 },    /* 2026-12-29 16:00 UTC */
+    { 1798567200u,   1, 2, 0 },    /* 2026-12-29 18:00 UTC */
+    { 1798646400u,   2, 2, 0 },    /* 2026-12-30 16:00 UTC */
+    { 1798653600u,   1, 2, 0 },    /* 2026-12-30 18:00 UTC */
+    { 1798732800u,   2, 2, 0 },    /* 2026-12-31 16:00 UTC */
+    { 1798740000u,   1, 2, 0 },    /* 2026-12-31 18:00 UTC */
+};
+
+const beacon_campaign_table_t beacon_campaign_table =
+{
+    .p_entries    = campaign_entries,
+    .num_entries  = sizeof(campaign_entries) / sizeof(campaign_entries[0]),
+    .p_payloads   = campaign_payloads,
+    .num_payloads = sizeof(campaign_payloads) / sizeof(campaign_payloads[0]),
+};
+
+#endif
+
+/* [] END OF FILE */
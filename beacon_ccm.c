@@ -0,0 +1,924 @@
+/******************************************************************************
+* File Name: beacon_ccm.c
+*
+* Description: This is the source code for encrypted beacon frames. AES-CCM
+* (RFC 3610) seals sensor values in manufacturer-specific data. The nonce of
+* a frame only depends on its counter, so the keystream and the start of the
+* MAC of the next frames are computed ahead by the worker and sealing a frame
+* takes a single AES block.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "wiced_bt_stack.h"
+#include "beacon_ccm.h"
+#include "beacon_manager.h"
+#include "beacon_payload.h"
+#include "beacon_stats.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* First octet of the salt derivation input, separates it from other uses
+ * of the key */
+#define CCM_DOMAIN                       (0x43)
+
+/* B0 flags: associated data present, tag length, counter length */
+#define CCM_FLAG_ADATA                   (0x40)
+#define CCM_FLAG_TAG_SHIFT               (3)
+
+/* Keystream blocks of the largest plaintext */
+#define CCM_PLAIN_BLOCKS                 ((BEACON_CCM_PLAIN_MAX + BEACON_AES_BLOCK_LEN - 1) / \
+                                          BEACON_AES_BLOCK_LEN)
+
+/* Offsets in the frame header */
+#define CCM_COMPANY_ID_LEN               (2)
+#define CCM_KEY_ID_OFFSET                (2)
+#define CCM_COUNTER_OFFSET               (3)
+
+#define CCM_NUM_ELEM                     (2)
+
+/* Counter that is never used, it would wrap */
+#define CCM_COUNTER_END                  (0xFFFFFFFFUL)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Frame sealed ahead, all but the plaintext dependent part */
+typedef struct
+{
+    wiced_bool_t valid;                                 /* Computed and not used */
+    uint32_t counter;                                   /* Counter of the frame */
+    uint8_t mac[BEACON_AES_BLOCK_LEN];                  /* CBC-MAC after B0 and the header */
+    uint8_t tag_stream[BEACON_CCM_TAG_LEN];             /* Keystream block 0, masks the tag */
+    uint8_t stream[CCM_PLAIN_BLOCKS * BEACON_AES_BLOCK_LEN]; /* Keystream blocks 1 and up */
+}ccm_ahead_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_ccm_key_t                ccm_key;
+static beacon_slot_t                  *ccm_slot;
+static wiced_bt_ble_multi_adv_params_t ccm_params;
+static beacon_ccm_read_t              *ccm_read;
+static beacon_ccm_reserve_t           *ccm_reserve;
+static uint8_t                         ccm_plain_len;
+static uint32_t                        ccm_counter;         /* Counter of the next frame */
+static uint32_t                        ccm_limit;           /* First counter not reserved */
+static uint32_t                        ccm_next_ms;
+static wiced_bool_t                    ccm_registered;
+static wiced_bool_t                    ccm_advertising;
+static ccm_ahead_t                     ccm_ahead[BEACON_CCM_LOOKAHEAD];
+static beacon_payload_t                ccm_payload;
+static beacon_ccm_stats_t              ccm_stats;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_ccm_block
+*********************************************************************************
+* Summary:
+*   Builds a B0 or counter block: flags, nonce, then value in the remaining
+*   octets, most significant first
+*
+*********************************************************************************/
+static void beacon_ccm_block(uint8_t flags, const uint8_t *nonce, uint8_t nonce_len,
+                             uint32_t value, uint8_t block[BEACON_AES_BLOCK_LEN])
+{
+    block[0] = flags;
+    memcpy(&block[1], nonce, nonce_len);
+    for (uint8_t i = BEACON_AES_BLOCK_LEN - 1; i > nonce_len; i--)
+    {
+        block[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_mac_update
+*********************************************************************************
+* Summary:
+*   Runs CBC-MAC over data, the last block padded with zeros
+*
+*********************************************************************************/
+static void beacon_ccm_mac_update(const beacon_aes_ctx_t *p_aes, uint8_t mac[BEACON_AES_BLOCK_LEN],
+                                  const uint8_t *data, uint16_t len)
+{
+    uint16_t chunk;
+
+    while (0 != len)
+    {
+        chunk = (len > BEACON_AES_BLOCK_LEN) ? BEACON_AES_BLOCK_LEN : len;
+        for (uint8_t i = 0; i < chunk; i++)
+        {
+            mac[i] ^= data[i];
+        }
+        beacon_aes_encrypt(p_aes, mac, mac);
+        data += chunk;
+        len  -= chunk;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_mac_start
+*********************************************************************************
+* Summary:
+*   Runs CBC-MAC over B0 and the associated data, with its two octet length
+*   prefix. The result only depends on the nonce, the associated data and the
+*   lengths, not on the plaintext.
+*
+*********************************************************************************/
+static void beacon_ccm_mac_start(const beacon_aes_ctx_t *p_aes, const uint8_t *nonce,
+                                 uint8_t nonce_len, const uint8_t *aad, uint16_t aad_len,
+                                 uint16_t len, uint8_t tag_len, uint8_t mac[BEACON_AES_BLOCK_LEN])
+{
+    uint8_t flags = (uint8_t)((((tag_len - 2) / 2) << CCM_FLAG_TAG_SHIFT) |
+                              (BEACON_AES_BLOCK_LEN - 2 - nonce_len));
+    uint8_t chunk;
+
+    if (0 != aad_len)
+    {
+        flags |= CCM_FLAG_ADATA;
+    }
+    beacon_ccm_block(flags, nonce, nonce_len, len, mac);
+    beacon_aes_encrypt(p_aes, mac, mac);
+
+    if (0 == aad_len)
+    {
+        return;
+    }
+
+    /* The length prefix and the first octets share the first block */
+    mac[0] ^= (uint8_t)(aad_len >> 8);
+    mac[1] ^= (uint8_t)aad_len;
+    chunk = (aad_len > (BEACON_AES_BLOCK_LEN - 2)) ? (BEACON_AES_BLOCK_LEN - 2) : (uint8_t)aad_len;
+    for (uint8_t i = 0; i < chunk; i++)
+    {
+        mac[2 + i] ^= aad[i];
+    }
+    beacon_aes_encrypt(p_aes, mac, mac);
+
+    beacon_ccm_mac_update(p_aes, mac, &aad[chunk], aad_len - chunk);
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_stream
+*********************************************************************************
+* Summary:
+*   Computes keystream block i, the encrypted counter block
+*
+*********************************************************************************/
+static void beacon_ccm_stream(const beacon_aes_ctx_t *p_aes, const uint8_t *nonce,
+                              uint8_t nonce_len, uint32_t i, uint8_t block[BEACON_AES_BLOCK_LEN])
+{
+    beacon_ccm_block(BEACON_AES_BLOCK_LEN - 2 - nonce_len, nonce, nonce_len, i, block);
+    beacon_aes_encrypt(p_aes, block, block);
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_crypt
+*********************************************************************************
+* Summary:
+*   XORs data with the keystream from block 1
+*
+*********************************************************************************/
+static void beacon_ccm_crypt(const beacon_aes_ctx_t *p_aes, const uint8_t *nonce,
+                             uint8_t nonce_len, const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint8_t block[BEACON_AES_BLOCK_LEN];
+    uint16_t chunk;
+
+    for (uint32_t i = 1; 0 != len; i++)
+    {
+        beacon_ccm_stream(p_aes, nonce, nonce_len, i, block);
+        chunk = (len > BEACON_AES_BLOCK_LEN) ? BEACON_AES_BLOCK_LEN : len;
+        for (uint8_t k = 0; k < chunk; k++)
+        {
+            out[k] = in[k] ^ block[k];
+        }
+        in  += chunk;
+        out += chunk;
+        len -= chunk;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_encrypt
+*********************************************************************************
+* Summary:
+*   Encrypts and authenticates with AES-CCM as in RFC 3610 and NIST SP
+*   800-38C
+*
+* Parameters:
+*   p_aes:                  Expanded key
+*   nonce:                  Nonce, unique per message under the key
+*   nonce_len:              Nonce length, 7 to 13
+*   aad:                    Associated data, authenticated only
+*   aad_len:                Length of the associated data, below 0xFF00
+*   in:                     Plaintext
+*   len:                    Length of the plaintext
+*   out:                    Ciphertext, may be the plaintext buffer
+*   tag:                    Authentication tag
+*   tag_len:                Tag length, 4 to 16 and even
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_ccm_encrypt(const beacon_aes_ctx_t *p_aes, const uint8_t *nonce, uint8_t nonce_len,
+                        const uint8_t *aad, uint16_t aad_len, const uint8_t *in, uint16_t len,
+                        uint8_t *out, uint8_t *tag, uint8_t tag_len)
+{
+    uint8_t mac[BEACON_AES_BLOCK_LEN];
+    uint8_t block[BEACON_AES_BLOCK_LEN];
+
+    beacon_ccm_mac_start(p_aes, nonce, nonce_len, aad, aad_len, len, tag_len, mac);
+    beacon_ccm_mac_update(p_aes, mac, in, len);
+
+    beacon_ccm_stream(p_aes, nonce, nonce_len, 0, block);
+    for (uint8_t i = 0; i < tag_len; i++)
+    {
+        tag[i] = mac[i] ^ block[i];
+    }
+
+    beacon_ccm_crypt(p_aes, nonce, nonce_len, in, len, out);
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_decrypt
+*********************************************************************************
+* Summary:
+*   Decrypts and verifies AES-CCM. The output is cleared when the tag does
+*   not match.
+*
+* Parameters:
+*   p_aes:                  Expanded key
+*   nonce:                  Nonce of the message
+*   nonce_len:              Nonce length, 7 to 13
+*   aad:                    Associated data
+*   aad_len:                Length of the associated data, below 0xFF00
+*   in:                     Ciphertext
+*   len:                    Length of the ciphertext
+*   out:                    Plaintext, may be the ciphertext buffer
+*   tag:                    Received tag
+*   tag_len:                Tag length, 4 to 16 and even
+*
+* Return:
+*   wiced_bool_t: WICED_TRUE if the tag matches
+*
+*********************************************************************************/
+wiced_bool_t beacon_ccm_decrypt(const beacon_aes_ctx_t *p_aes, const uint8_t *nonce,
+                                uint8_t nonce_len, const uint8_t *aad, uint16_t aad_len,
+                                const uint8_t *in, uint16_t len, uint8_t *out,
+                                const uint8_t *tag, uint8_t tag_len)
+{
+    uint8_t mac[BEACON_AES_BLOCK_LEN];
+    uint8_t block[BEACON_AES_BLOCK_LEN];
+    uint8_t diff = 0;
+
+    beacon_ccm_crypt(p_aes, nonce, nonce_len, in, len, out);
+
+    beacon_ccm_mac_start(p_aes, nonce, nonce_len, aad, aad_len, len, tag_len, mac);
+    beacon_ccm_mac_update(p_aes, mac, out, len);
+
+    /* Compare every octet, the time does not depend on the match */
+    beacon_ccm_stream(p_aes, nonce, nonce_len, 0, block);
+    for (uint8_t i = 0; i < tag_len; i++)
+    {
+        diff |= mac[i] ^ block[i] ^ tag[i];
+    }
+
+    if (0 != diff)
+    {
+        memset(out, 0, len);
+        return WICED_FALSE;
+    }
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_key_init
+*********************************************************************************
+* Summary:
+*   Expands a frame key and derives its nonce salt. Keys must differ per
+*   sender, the counters of two senders sharing a key would share nonces.
+*
+* Parameters:
+*   p_key:                  Expanded key
+*   key_id:                 Identifier sent in the frames
+*   key:                    AES-128 key
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_ccm_key_init(beacon_ccm_key_t *p_key, uint8_t key_id,
+                         const uint8_t key[BEACON_CCM_KEY_LEN])
+{
+    uint8_t block[BEACON_AES_BLOCK_LEN] = { CCM_DOMAIN };
+
+    beacon_aes_init(&p_key->aes, key);
+    beacon_aes_encrypt(&p_key->aes, block, block);
+    memcpy(p_key->salt, block, BEACON_CCM_SALT_LEN);
+    p_key->key_id = key_id;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_header
+*********************************************************************************
+* Summary:
+*   Builds the frame header, the associated data, and the nonce of a counter
+*
+*********************************************************************************/
+static void beacon_ccm_header(const beacon_ccm_key_t *p_key, uint32_t counter,
+                              uint8_t header[BEACON_CCM_HEADER_LEN],
+                              uint8_t nonce[BEACON_CCM_NONCE_LEN])
+{
+    header[0]                  = BEACON_CCM_COMPANY_ID & 0xff;
+    header[1]                  = (BEACON_CCM_COMPANY_ID >> 8) & 0xff;
+    header[CCM_KEY_ID_OFFSET]  = p_key->key_id;
+    for (uint8_t i = 0; i < BEACON_CCM_COUNTER_LEN; i++)
+    {
+        header[CCM_COUNTER_OFFSET + i] = (uint8_t)(counter >> (8 * i));
+        nonce[BEACON_CCM_NONCE_LEN - 1 - i] = (uint8_t)(counter >> (8 * i));
+    }
+    memcpy(nonce, p_key->salt, BEACON_CCM_SALT_LEN);
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_prepare
+*********************************************************************************
+* Summary:
+*   Computes the plaintext independent part of a frame: the MAC over B0 and
+*   the header, and the keystream
+*
+*********************************************************************************/
+static void beacon_ccm_prepare(const beacon_ccm_key_t *p_key, uint32_t counter,
+                               uint8_t plain_len, ccm_ahead_t *p_ahead)
+{
+    uint8_t header[BEACON_CCM_HEADER_LEN];
+    uint8_t nonce[BEACON_CCM_NONCE_LEN];
+    uint8_t block[BEACON_AES_BLOCK_LEN];
+    uint8_t blocks = (plain_len + BEACON_AES_BLOCK_LEN - 1) / BEACON_AES_BLOCK_LEN;
+
+    beacon_ccm_header(p_key, counter, header, nonce);
+    beacon_ccm_mac_start(&p_key->aes, nonce, BEACON_CCM_NONCE_LEN, header, BEACON_CCM_HEADER_LEN,
+                         plain_len, BEACON_CCM_TAG_LEN, p_ahead->mac);
+
+    beacon_ccm_stream(&p_key->aes, nonce, BEACON_CCM_NONCE_LEN, 0, block);
+    memcpy(p_ahead->tag_stream, block, BEACON_CCM_TAG_LEN);
+    for (uint8_t i = 0; i < blocks; i++)
+    {
+        beacon_ccm_stream(&p_key->aes, nonce, BEACON_CCM_NONCE_LEN, i + 1,
+                          &p_ahead->stream[i * BEACON_AES_BLOCK_LEN]);
+    }
+
+    p_ahead->counter = counter;
+    p_ahead->valid   = WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_finish
+*********************************************************************************
+* Summary:
+*   Seals a frame prepared ahead: the MAC over the plaintext, then the
+*   keystream XOR. One AES block per 16 octets of plaintext.
+*
+*********************************************************************************/
+static void beacon_ccm_finish(const beacon_ccm_key_t *p_key, const ccm_ahead_t *p_ahead,
+                              const uint8_t *plain, uint8_t plain_len,
+                              uint8_t adv_data[BEACON_ADV_DATA_MAX], uint8_t *adv_len)
+{
+    beacon_ble_advert_elem_t adv_elem[CCM_NUM_ELEM];
+    uint8_t *p_frame = adv_elem[1].data;
+    uint8_t *p_cipher = &p_frame[BEACON_CCM_HEADER_LEN];
+    uint8_t *p_tag = &p_cipher[plain_len];
+    uint8_t mac[BEACON_AES_BLOCK_LEN];
+
+    memcpy(mac, p_ahead->mac, BEACON_AES_BLOCK_LEN);
+    beacon_ccm_mac_update(&p_key->aes, mac, plain, plain_len);
+
+    p_frame[0]                 = BEACON_CCM_COMPANY_ID & 0xff;
+    p_frame[1]                 = (BEACON_CCM_COMPANY_ID >> 8) & 0xff;
+    p_frame[CCM_KEY_ID_OFFSET] = p_key->key_id;
+    for (uint8_t i = 0; i < BEACON_CCM_COUNTER_LEN; i++)
+    {
+        p_frame[CCM_COUNTER_OFFSET + i] = (uint8_t)(p_ahead->counter >> (8 * i));
+    }
+    for (uint8_t i = 0; i < plain_len; i++)
+    {
+        p_cipher[i] = plain[i] ^ p_ahead->stream[i];
+    }
+    for (uint8_t i = 0; i < BEACON_CCM_TAG_LEN; i++)
+    {
+        p_tag[i] = mac[i] ^ p_ahead->tag_stream[i];
+    }
+
+    /* first adv element Byte 0: Length :  0x02 */
+    adv_elem[0].len         = ADV_PKT_FLAG_LENGTH;
+    adv_elem[0].advert_type = BTM_BLE_ADVERT_TYPE_FLAG;
+    adv_elem[0].data[0]     = BTM_BLE_GENERAL_DISCOVERABLE_FLAG | BTM_BLE_BREDR_NOT_SUPPORTED;
+
+    /* Second adv element, header, ciphertext and tag */
+    adv_elem[1].len         = 1 + BEACON_CCM_HEADER_LEN + plain_len + BEACON_CCM_TAG_LEN;
+    adv_elem[1].advert_type = BTM_BLE_ADVERT_TYPE_MANUFACTURER;
+
+    beacon_set_adv_data(adv_elem, CCM_NUM_ELEM, adv_data, adv_len);
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_seal
+*********************************************************************************
+* Summary:
+*   Builds the encrypted frame of a counter without precomputation
+*
+* Parameters:
+*   p_key:                  Frame key
+*   counter:                Packet counter, never repeated under the key
+*   plain:                  Plaintext
+*   plain_len:              Length of the plaintext, at most BEACON_CCM_PLAIN_MAX
+*   adv_data:               Output data buffer
+*   adv_len:                Length of output data
+*
+* Return:
+*   wiced_bool_t: WICED_FALSE if the plaintext is too long
+*
+*********************************************************************************/
+wiced_bool_t beacon_ccm_seal(const beacon_ccm_key_t *p_key, uint32_t counter,
+                             const uint8_t *plain, uint8_t plain_len,
+                             uint8_t adv_data[BEACON_ADV_DATA_MAX], uint8_t *adv_len)
+{
+    ccm_ahead_t ahead;
+
+    if (plain_len > BEACON_CCM_PLAIN_MAX)
+    {
+        return WICED_FALSE;
+    }
+
+    beacon_ccm_prepare(p_key, counter, plain_len, &ahead);
+    beacon_ccm_finish(p_key, &ahead, plain, plain_len, adv_data, adv_len);
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_rx_init
+*********************************************************************************
+* Summary:
+*   Initializes the receiver of one sender. Scanner side.
+*
+* Parameters:
+*   p_rx:                   Receiver
+*   key_id:                 Identifier of the key in the frames
+*   key:                    AES-128 key of the sender
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_ccm_rx_init(beacon_ccm_rx_t *p_rx, uint8_t key_id,
+                        const uint8_t key[BEACON_CCM_KEY_LEN])
+{
+    memset(p_rx, 0, sizeof(*p_rx));
+    beacon_ccm_key_init(&p_rx->key, key_id, key);
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_open
+*********************************************************************************
+* Summary:
+*   Decrypts a received frame. Frames with a counter below the last accepted
+*   one are replays; the same frame received again on later advertising
+*   events is ignored without being counted.
+*
+* Parameters:
+*   p_rx:                   Receiver of the sender
+*   adv_data:               Received advertisement data
+*   adv_len:                Length of the advertisement data
+*   plain:                  Plaintext, BEACON_CCM_PLAIN_MAX octets
+*   p_plain_len:            Length of the plaintext
+*   p_counter:              Counter of the frame, may be NULL
+*
+* Return:
+*   wiced_bool_t: WICED_TRUE for a new authentic frame
+*
+*********************************************************************************/
+wiced_bool_t beacon_ccm_open(beacon_ccm_rx_t *p_rx, const uint8_t *adv_data, uint8_t adv_len,
+                             uint8_t *plain, uint8_t *p_plain_len, uint32_t *p_counter)
+{
+    const uint8_t *p_frame = NULL;
+    uint8_t frame_len = 0;
+    uint8_t index = 0;
+    uint8_t nonce[BEACON_CCM_NONCE_LEN];
+    uint8_t header[BEACON_CCM_HEADER_LEN];
+    uint8_t plain_len;
+    uint32_t counter = 0;
+
+    /* Find the manufacturer element carrying our company identifier and key */
+    while ((index + 1) < adv_len)
+    {
+        uint8_t elem_len = adv_data[index];
+
+        if ((0 == elem_len) || ((index + 1 + elem_len) > adv_len))
+        {
+            break;
+        }
+        if ((BTM_BLE_ADVERT_TYPE_MANUFACTURER == adv_data[index + 1]) &&
+            (elem_len >= (1 + BEACON_CCM_HEADER_LEN + BEACON_CCM_TAG_LEN)) &&
+            ((BEACON_CCM_COMPANY_ID & 0xff) == adv_data[index + 2]) &&
+            (((BEACON_CCM_COMPANY_ID >> 8) & 0xff) == adv_data[index + 3]) &&
+            (p_rx->key.key_id == adv_data[index + 2 + CCM_KEY_ID_OFFSET]))
+        {
+            p_frame   = &adv_data[index + 2];
+            frame_len = elem_len - 1;
+            break;
+        }
+        index += elem_len + 1;
+    }
+
+    if (NULL == p_frame)
+    {
+        return WICED_FALSE;
+    }
+
+    for (uint8_t i = 0; i < BEACON_CCM_COUNTER_LEN; i++)
+    {
+        counter |= (uint32_t)p_frame[CCM_COUNTER_OFFSET + i] << (8 * i);
+    }
+
+    if (p_rx->seen && (counter <= p_rx->last_counter))
+    {
+        if (counter != p_rx->last_counter)
+        {
+            p_rx->replayed++;
+        }
+        return WICED_FALSE;
+    }
+
+    plain_len = frame_len - BEACON_CCM_HEADER_LEN - BEACON_CCM_TAG_LEN;
+    if (plain_len > BEACON_CCM_PLAIN_MAX)
+    {
+        return WICED_FALSE;
+    }
+
+    beacon_ccm_header(&p_rx->key, counter, header, nonce);
+    if (!beacon_ccm_decrypt(&p_rx->key.aes, nonce, BEACON_CCM_NONCE_LEN,
+                            p_frame, BEACON_CCM_HEADER_LEN,
+                            &p_frame[BEACON_CCM_HEADER_LEN], plain_len, plain,
+                            &p_frame[BEACON_CCM_HEADER_LEN + plain_len], BEACON_CCM_TAG_LEN))
+    {
+        p_rx->forged++;
+        return WICED_FALSE;
+    }
+
+    p_rx->seen         = WICED_TRUE;
+    p_rx->last_counter = counter;
+    p_rx->accepted++;
+
+    *p_plain_len = plain_len;
+    if (NULL != p_counter)
+    {
+        *p_counter = counter;
+    }
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_submit
+*********************************************************************************
+* Summary:
+*   Issues the last sealed frame, deferred to the beacon manager task. The
+*   instance is configured and started with the first frame.
+*
+*********************************************************************************/
+static void beacon_ccm_submit(void)
+{
+    const beacon_payload_buf_t *p_frame = beacon_payload_take(&ccm_payload);
+
+    if (NULL == p_frame)
+    {
+        return;
+    }
+    if (WICED_BT_PENDING != beacon_slot_set_data(ccm_slot, p_frame->data, p_frame->len))
+    {
+        ccm_stats.rejected++;
+        return;
+    }
+
+    if (!ccm_advertising)
+    {
+        if ((WICED_BT_PENDING == beacon_slot_set_params(ccm_slot, &ccm_params)) &&
+            (WICED_BT_PENDING == beacon_slot_start(ccm_slot, WICED_TRUE)))
+        {
+            ccm_advertising = WICED_TRUE;
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_fill
+*********************************************************************************
+* Summary:
+*   Prepares the frames of the next reserved counters that are not ready
+*
+*********************************************************************************/
+static void beacon_ccm_fill(void)
+{
+    ccm_ahead_t *p_ahead;
+    uint32_t counter;
+
+    for (uint32_t k = 0; k < BEACON_CCM_LOOKAHEAD; k++)
+    {
+        counter = ccm_counter + k;
+        if (counter >= ccm_limit)
+        {
+            break;
+        }
+
+        p_ahead = &ccm_ahead[counter % BEACON_CCM_LOOKAHEAD];
+        if (!p_ahead->valid || (p_ahead->counter != counter))
+        {
+            beacon_ccm_prepare(&ccm_key, counter, ccm_plain_len, p_ahead);
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_block_end
+*********************************************************************************
+* Summary:
+*   Returns the limit after the block of counters that starts at a counter
+*
+*********************************************************************************/
+static uint32_t beacon_ccm_block_end(uint32_t counter)
+{
+    return ((CCM_COUNTER_END - counter) > BEACON_CCM_COUNTER_BLOCK) ?
+           (counter + BEACON_CCM_COUNTER_BLOCK) : CCM_COUNTER_END;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_job
+*********************************************************************************
+* Summary:
+*   Worker job sealing one frame per period. The frame is published first,
+*   then the time until the next period is used to prepare the next frames,
+*   so sealing a frame costs one AES block and a few XORs.
+*
+*********************************************************************************/
+static uint32_t beacon_ccm_job(uint32_t now_ms)
+{
+    uint8_t plain[BEACON_CCM_PLAIN_MAX];
+    beacon_payload_buf_t *p_frame;
+    ccm_ahead_t *p_ahead;
+    uint32_t limit;
+    int32_t wait_ms = (int32_t)(ccm_next_ms - now_ms);
+
+    if (wait_ms > 0)
+    {
+        return (uint32_t)wait_ms;
+    }
+    ccm_next_ms += BEACON_CCM_PERIOD_MS;
+
+    /* Reserve the next block before the frames prepared ahead reach it. A
+     * block that was not stored is asked for again next period. */
+    if ((NULL != ccm_reserve) && (CCM_COUNTER_END != ccm_limit) &&
+        ((ccm_limit - ccm_counter) <= BEACON_CCM_LOOKAHEAD))
+    {
+        limit = beacon_ccm_block_end(ccm_limit);
+        if (ccm_reserve(limit))
+        {
+            ccm_limit = limit;
+        }
+    }
+
+    if (ccm_counter < ccm_limit)
+    {
+        ccm_read(plain, ccm_plain_len);
+
+        p_ahead = &ccm_ahead[ccm_counter % BEACON_CCM_LOOKAHEAD];
+        if (!p_ahead->valid || (p_ahead->counter != ccm_counter))
+        {
+            ccm_stats.late++;
+            beacon_ccm_prepare(&ccm_key, ccm_counter, ccm_plain_len, p_ahead);
+        }
+
+        p_frame = beacon_payload_buffer(&ccm_payload);
+        beacon_ccm_finish(&ccm_key, p_ahead, plain, ccm_plain_len, p_frame->data, &p_frame->len);
+
+        /* The keystream of a counter is used once */
+        p_ahead->valid = WICED_FALSE;
+        ccm_counter++;
+        ccm_stats.frames++;
+
+        beacon_payload_publish(&ccm_payload, p_frame->len);
+        beacon_manager_defer(beacon_ccm_submit);
+
+        beacon_ccm_fill();
+    }
+    else
+    {
+        ccm_stats.exhausted++;
+    }
+
+    wait_ms = (int32_t)(ccm_next_ms - now_ms);
+    return (wait_ms > 0) ? (uint32_t)wait_ms : 0;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_start
+*********************************************************************************
+* Summary:
+*   Starts advertising encrypted frames on a spare instance, one per
+*   BEACON_CCM_PERIOD_MS. The first block of counters is reserved before
+*   returning, the read and later reserve callbacks run in the worker task.
+*   Call from the beacon manager task.
+*
+* Parameters:
+*   p_slot:                 Spare instance
+*   key_id:                 Identifier of the key sent in the frames
+*   key:                    AES-128 key, shared with the receivers
+*   counter:                Counter of the first frame, above every counter
+*                           used before under the key
+*   plain_len:              Plaintext per frame, 1 to BEACON_CCM_PLAIN_MAX
+*   p_read:                 Fills the plaintext of a frame
+*   p_reserve:              Stores the counter limit, NULL only if the key is
+*                           new at every start
+*   p_params:               Advertising parameters of the instance
+*
+* Return:
+*   WICED_BT_SUCCESS, WICED_BT_BADARG, or WICED_BT_ERROR if the first block
+*   of counters was not stored
+*
+*********************************************************************************/
+wiced_result_t beacon_ccm_start(beacon_slot_t *p_slot, uint8_t key_id,
+                                const uint8_t key[BEACON_CCM_KEY_LEN], uint32_t counter,
+                                uint8_t plain_len, beacon_ccm_read_t *p_read,
+                                beacon_ccm_reserve_t *p_reserve,
+                                const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    if ((NULL == p_slot) || (0 == plain_len) || (plain_len > BEACON_CCM_PLAIN_MAX) ||
+        (NULL == p_read) || (CCM_COUNTER_END == counter))
+    {
+        return WICED_BT_BADARG;
+    }
+
+    if ((NULL != p_reserve) && !p_reserve(beacon_ccm_block_end(counter)))
+    {
+        return WICED_BT_ERROR;
+    }
+
+    beacon_ccm_key_init(&ccm_key, key_id, key);
+    memset(ccm_ahead, 0, sizeof(ccm_ahead));
+    ccm_slot        = p_slot;
+    ccm_params      = *p_params;
+    ccm_read        = p_read;
+    ccm_reserve     = p_reserve;
+    ccm_plain_len   = plain_len;
+    ccm_counter     = counter;
+    ccm_limit       = (NULL != p_reserve) ? beacon_ccm_block_end(counter) : CCM_COUNTER_END;
+    ccm_advertising = WICED_FALSE;
+    ccm_next_ms     = beacon_stats_now_ms();
+
+    if (!ccm_registered)
+    {
+        ccm_registered = WICED_TRUE;
+        beacon_payload_init(&ccm_payload);
+        beacon_worker_register(beacon_ccm_job, BEACON_CCM_SLACK_MS);
+    }
+    return WICED_BT_SUCCESS;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the sender counters
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Pointer to the counters
+*
+*********************************************************************************/
+const beacon_ccm_stats_t *beacon_ccm_get_stats(void)
+{
+    return &ccm_stats;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_rate
+*********************************************************************************
+* Summary:
+*   Converts the cycles spent on BEACON_CCM_MEASURE_FRAMES frames to frames
+*   per second
+*
+*********************************************************************************/
+static uint32_t beacon_ccm_rate(uint32_t cycles)
+{
+    uint32_t time_us = beacon_stats_cycles_to_us(cycles);
+
+    return (0 != time_us) ? (BEACON_CCM_MEASURE_FRAMES * 1000000UL) / time_us : 0;
+}
+
+/********************************************************************************
+* Function Name: beacon_ccm_measure
+*********************************************************************************
+* Summary:
+*   Times every path with a test key, for the console. The sender and the
+*   receivers are not touched.
+*
+* Parameters:
+*   plain_len:              Plaintext per frame, 1 to BEACON_CCM_PLAIN_MAX
+*   p_rate:                 Frames per second of each path
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_ccm_measure(uint8_t plain_len, beacon_ccm_rate_t *p_rate)
+{
+    static const uint8_t key[BEACON_CCM_KEY_LEN] = { 0 };
+    beacon_ccm_rx_t rx;
+    ccm_ahead_t ahead;
+    uint8_t plain[BEACON_CCM_PLAIN_MAX] = { 0 };
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint8_t adv_len;
+    uint8_t open_len;
+    uint32_t start;
+
+    memset(p_rate, 0, sizeof(*p_rate));
+    if ((0 == plain_len) || (plain_len > BEACON_CCM_PLAIN_MAX))
+    {
+        return;
+    }
+    beacon_ccm_rx_init(&rx, 0, key);
+
+    start = beacon_stats_cycles();
+    for (uint32_t i = 0; i < BEACON_CCM_MEASURE_FRAMES; i++)
+    {
+        beacon_ccm_seal(&rx.key, i, plain, plain_len, adv_data, &adv_len);
+    }
+    p_rate->seal = beacon_ccm_rate(beacon_stats_cycles() - start);
+
+    start = beacon_stats_cycles();
+    for (uint32_t i = 0; i < BEACON_CCM_MEASURE_FRAMES; i++)
+    {
+        beacon_ccm_prepare(&rx.key, i, plain_len, &ahead);
+    }
+    p_rate->prepare = beacon_ccm_rate(beacon_stats_cycles() - start);
+
+    start = beacon_stats_cycles();
+    for (uint32_t i = 0; i < BEACON_CCM_MEASURE_FRAMES; i++)
+    {
+        beacon_ccm_finish(&rx.key, &ahead, plain, plain_len, adv_data, &adv_len);
+    }
+    p_rate->finish = beacon_ccm_rate(beacon_stats_cycles() - start);
+
+    /* The same frame each time, accepted again once forgotten */
+    start = beacon_stats_cycles();
+    for (uint32_t i = 0; i < BEACON_CCM_MEASURE_FRAMES; i++)
+    {
+        rx.seen = WICED_FALSE;
+        beacon_ccm_open(&rx, adv_data, adv_len, plain, &open_len, NULL);
+    }
+    p_rate->open = beacon_ccm_rate(beacon_stats_cycles() - start);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,207 @@
+/******************************************************************************
+* File Name: beacon_ccm.h
+*
+* Description: This file contains the definitions for encrypted beacon
+* frames. Sensor values are sealed with AES-CCM in manufacturer-specific data,
+* the nonce is derived from a packet counter sent in clear.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_CCM_H__
+#define __BEACON_CCM_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_aes.h"
+#include "beacon_slot.h"
+#include "beacon_utils.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to advertise encrypted sensor frames on the telemetry instance */
+#ifndef BEACON_CCM_ENABLE
+#define BEACON_CCM_ENABLE                (0)
+#endif
+
+/* Company identifier placed in front of the encrypted frame */
+#ifndef BEACON_CCM_COMPANY_ID
+#define BEACON_CCM_COMPANY_ID            (0x0131)
+#endif
+
+/* Length of the authentication tag, 4 to 16 and even. Forging a frame
+ * succeeds with a chance of 2^-32 per attempt with the default. */
+#ifndef BEACON_CCM_TAG_LEN
+#define BEACON_CCM_TAG_LEN               (4)
+#endif
+
+/* Frames sealed ahead of the one on air, during idle time */
+#ifndef BEACON_CCM_LOOKAHEAD
+#define BEACON_CCM_LOOKAHEAD             (8)
+#endif
+
+/* Period of the encrypted frames */
+#ifndef BEACON_CCM_PERIOD_MS
+#define BEACON_CCM_PERIOD_MS             (1000)
+#endif
+
+/* Longest a frame may wait to share a wakeup with other jobs */
+#ifndef BEACON_CCM_SLACK_MS
+#define BEACON_CCM_SLACK_MS              (100)
+#endif
+
+/* Counters reserved at a time through the reserve callback */
+#ifndef BEACON_CCM_COUNTER_BLOCK
+#define BEACON_CCM_COUNTER_BLOCK         (1024)
+#endif
+
+/* Frames per path timed by beacon_ccm_measure */
+#define BEACON_CCM_MEASURE_FRAMES        (64)
+
+#define BEACON_CCM_KEY_LEN               (BEACON_AES_KEY_LEN)
+
+/* Nonce: a salt derived from the key, then the packet counter */
+#define BEACON_CCM_NONCE_LEN             (13)
+#define BEACON_CCM_COUNTER_LEN           (4)
+#define BEACON_CCM_SALT_LEN              (BEACON_CCM_NONCE_LEN - BEACON_CCM_COUNTER_LEN)
+
+/* Frame header after the AD header, authenticated but not encrypted:
+ * company identifier, key identifier and packet counter */
+#define BEACON_CCM_HEADER_LEN            (2 + 1 + BEACON_CCM_COUNTER_LEN)
+
+/* Largest plaintext of a frame */
+#define BEACON_CCM_PLAIN_MAX             (BEACON_ADV_DATA_MAX - (ADV_PKT_FLAG_LENGTH + 1) - 2 - \
+                                          BEACON_CCM_HEADER_LEN - BEACON_CCM_TAG_LEN)
+
+#if (BEACON_CCM_TAG_LEN < 4) || (BEACON_CCM_TAG_LEN > 16) || (BEACON_CCM_TAG_LEN & 1)
+#error "BEACON_CCM_TAG_LEN must be even, from 4 to 16"
+#endif
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Expanded frame key */
+typedef struct
+{
+    beacon_aes_ctx_t aes;                       /* Expanded AES-128 key */
+    uint8_t salt[BEACON_CCM_SALT_LEN];          /* Nonce prefix derived from the key */
+    uint8_t key_id;                             /* Identifier sent in the frame */
+}beacon_ccm_key_t;
+
+/* Receiver of the frames of one sender, scanner side */
+typedef struct
+{
+    beacon_ccm_key_t key;                       /* Key of the sender */
+    wiced_bool_t seen;                          /* A frame was accepted */
+    uint32_t last_counter;                      /* Counter of the last accepted frame */
+    uint32_t accepted;                          /* Frames decrypted */
+    uint32_t replayed;                          /* Frames with an old counter */
+    uint32_t forged;                            /* Frames with a wrong tag */
+}beacon_ccm_rx_t;
+
+/* Sender counters */
+typedef struct
+{
+    uint32_t frames;                            /* Frames published */
+    uint32_t late;                              /* Frames not sealed ahead in time */
+    uint32_t rejected;                          /* Frames not accepted by the stack */
+    uint32_t exhausted;                         /* Frames not sent, no counter reserved */
+}beacon_ccm_stats_t;
+
+/* Frames per second of each path, measured on the device */
+typedef struct
+{
+    uint32_t seal;                              /* Sealed without precomputation */
+    uint32_t prepare;                           /* Prepared ahead by the worker */
+    uint32_t finish;                            /* Sealed from a prepared frame */
+    uint32_t open;                              /* Received and decrypted */
+}beacon_ccm_rate_t;
+
+/* Fills the plaintext of the next frame */
+typedef void (beacon_ccm_read_t)(uint8_t *plain, uint8_t plain_len);
+
+/* Called before counters below limit are used. The counter must never
+ * repeat under a key, so store limit in non-volatile memory before
+ * returning WICED_TRUE and start from the stored limit after a reset.
+ * Counters are not used beyond a limit that was not stored. */
+typedef wiced_bool_t (beacon_ccm_reserve_t)(uint32_t limit);
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                      beacon_ccm_encrypt   (const beacon_aes_ctx_t *p_aes,
+                                                const uint8_t *nonce, uint8_t nonce_len,
+                                                const uint8_t *aad, uint16_t aad_len,
+                                                const uint8_t *in, uint16_t len, uint8_t *out,
+                                                uint8_t *tag, uint8_t tag_len);
+
+wiced_bool_t              beacon_ccm_decrypt   (const beacon_aes_ctx_t *p_aes,
+                                                const uint8_t *nonce, uint8_t nonce_len,
+                                                const uint8_t *aad, uint16_t aad_len,
+                                                const uint8_t *in, uint16_t len, uint8_t *out,
+                                                const uint8_t *tag, uint8_t tag_len);
+
+void                      beacon_ccm_key_init  (beacon_ccm_key_t *p_key, uint8_t key_id,
+                                                const uint8_t key[BEACON_CCM_KEY_LEN]);
+
+wiced_bool_t              beacon_ccm_seal      (const beacon_ccm_key_t *p_key, uint32_t counter,
+                                                const uint8_t *plain, uint8_t plain_len,
+                                                uint8_t adv_data[BEACON_ADV_DATA_MAX],
+                                                uint8_t *adv_len);
+
+void                      beacon_ccm_rx_init   (beacon_ccm_rx_t *p_rx, uint8_t key_id,
+                                                const uint8_t key[BEACON_CCM_KEY_LEN]);
+
+wiced_bool_t              beacon_ccm_open      (beacon_ccm_rx_t *p_rx, const uint8_t *adv_data,
+                                                uint8_t adv_len, uint8_t *plain,
+                                                uint8_t *p_plain_len, uint32_t *p_counter);
+
+wiced_result_t            beacon_ccm_start     (beacon_slot_t *p_slot, uint8_t key_id,
+                                                const uint8_t key[BEACON_CCM_KEY_LEN],
+                                                uint32_t counter, uint8_t plain_len,
+                                                beacon_ccm_read_t *p_read,
+                                                beacon_ccm_reserve_t *p_reserve,
+                                                const wiced_bt_ble_multi_adv_params_t *p_params);
+
+const beacon_ccm_stats_t *beacon_ccm_get_stats (void);
+
+void                      beacon_ccm_measure   (uint8_t plain_len, beacon_ccm_rate_t *p_rate);
+
+#endif      /* __BEACON_CCM_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,387 @@
+/******************************************************************************
+* File Name: beacon_chmap.c
+*
+* Description: This is the source code for the channel map selection of the
+* advertising instances. The load of every primary channel is estimated from
+* the reports of other advertisers and the lost packets heard on it, and
+* congested channels are dropped from the maps of the managed instances by
+* params only updates, keeping a minimum number of channels per instance.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <FreeRTOS.h>
+#include <task.h>
+#include "beacon_chmap.h"
+#include "beacon_timer.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#if (BEACON_CHMAP_MIN_CHANNELS < 1) || (BEACON_CHMAP_MIN_CHANNELS > BEACON_CHMAP_CHANNELS)
+#error "BEACON_CHMAP_MIN_CHANNELS must be 1 to 3"
+#endif
+
+/* Loads are smoothed in Q4 */
+#define CHMAP_LOAD_FRAC_BITS             (4)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Counts of the current period, written from the reporting context */
+static uint32_t              chmap_reports[BEACON_CHMAP_CHANNELS];
+static uint32_t              chmap_failures[BEACON_CHMAP_CHANNELS];
+
+static uint32_t              chmap_reports_q4[BEACON_CHMAP_CHANNELS];
+static uint32_t              chmap_failures_q4[BEACON_CHMAP_CHANNELS];
+static uint8_t               chmap_hold[BEACON_SLOT_MAX_INSTANCES];
+static beacon_chmap_stats_t  chmap_stats;
+static beacon_timer_t        chmap_timer;
+static wiced_bool_t          chmap_started;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_chmap_apply
+*********************************************************************************
+* Summary:
+*   Issues a params update when the decided map of a managed instance
+*   differs from its current one. Instances not configured yet are skipped.
+*
+*********************************************************************************/
+static wiced_result_t beacon_chmap_apply(beacon_slot_t *p_slot, uint8_t map)
+{
+    wiced_bt_ble_multi_adv_params_t params;
+    wiced_result_t result;
+
+    if ((0 == p_slot->params.adv_int_min) || (map == p_slot->params.channel_map))
+    {
+        return WICED_BT_SUCCESS;
+    }
+
+    params             = p_slot->params;
+    params.channel_map = map;
+    result = beacon_slot_set_params(p_slot, &params);
+    if (WICED_BT_PENDING == result)
+    {
+        chmap_stats.changes++;
+        chmap_hold[p_slot->instance - 1] = BEACON_CHMAP_HOLD_PERIODS;
+    }
+    else
+    {
+        chmap_stats.rejected++;
+    }
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_chmap_current
+*********************************************************************************
+* Summary:
+*   Returns the primary channels of a slot, all of them for an empty map
+*
+*********************************************************************************/
+static uint8_t beacon_chmap_current(const beacon_slot_t *p_slot)
+{
+    uint8_t map = p_slot->params.channel_map & BEACON_CHMAP_ALL;
+
+    return (0 != map) ? map : BEACON_CHMAP_ALL;
+}
+
+/********************************************************************************
+* Function Name: beacon_chmap_smooth
+*********************************************************************************
+* Summary:
+*   Folds the count of a period into a smoothed Q4 count
+*
+*********************************************************************************/
+static uint32_t beacon_chmap_smooth(uint32_t smoothed_q4, uint32_t count)
+{
+    int32_t sample = (int32_t)(count << CHMAP_LOAD_FRAC_BITS);
+
+    return (uint32_t)((int32_t)smoothed_q4 +
+                      ((sample - (int32_t)smoothed_q4) / (1 << BEACON_CHMAP_LOAD_SHIFT)));
+}
+
+/********************************************************************************
+* Function Name: beacon_chmap_period
+*********************************************************************************
+* Summary:
+*   Timer callback, runs in the beacon manager task. Folds the counts of the
+*   period into the loads and decides the map of every managed instance whose
+*   hold time is over. The load of a channel is its reports plus its losses
+*   weighted by BEACON_CHMAP_FAILURE_WEIGHT.
+*
+*********************************************************************************/
+static void beacon_chmap_period(beacon_timer_t *p_timer)
+{
+    uint32_t reports[BEACON_CHMAP_CHANNELS];
+    uint32_t failures[BEACON_CHMAP_CHANNELS];
+    beacon_slot_t *p_slot;
+    uint8_t in_use = 0;
+    uint8_t map;
+
+    for (uint8_t i = 1; i <= BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        p_slot = beacon_slot_get(i);
+        if ((NULL != p_slot) && p_slot->advertising)
+        {
+            in_use |= beacon_chmap_current(p_slot);
+        }
+    }
+
+    taskENTER_CRITICAL();
+    for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+    {
+        reports[ch]         = chmap_reports[ch];
+        failures[ch]        = chmap_failures[ch];
+        chmap_reports[ch]   = 0;
+        chmap_failures[ch]  = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+    {
+        chmap_reports_q4[ch] = beacon_chmap_smooth(chmap_reports_q4[ch], reports[ch]);
+        if (0 != (in_use & (1U << ch)))
+        {
+            chmap_failures_q4[ch] = beacon_chmap_smooth(chmap_failures_q4[ch], failures[ch]);
+        }
+        else
+        {
+            chmap_failures_q4[ch] -= chmap_failures_q4[ch] >> BEACON_CHMAP_RETRY_SHIFT;
+        }
+
+        chmap_stats.load[ch]     = (chmap_reports_q4[ch] +
+                                    (chmap_failures_q4[ch] * BEACON_CHMAP_FAILURE_WEIGHT)) >>
+                                   CHMAP_LOAD_FRAC_BITS;
+        chmap_stats.reports[ch]  = reports[ch];
+        chmap_stats.failures[ch] = failures[ch];
+    }
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        p_slot = beacon_slot_get(i + 1);
+        if ((NULL == p_slot) || (0 == chmap_stats.min_channels[i]))
+        {
+            continue;
+        }
+        if (0 != chmap_hold[i])
+        {
+            chmap_hold[i]--;
+            continue;
+        }
+
+        map = beacon_chmap_decide(chmap_stats.load, beacon_chmap_current(p_slot),
+                                  chmap_stats.min_channels[i]);
+        beacon_chmap_apply(p_slot, map);
+    }
+
+    beacon_timer_start(p_timer, BEACON_CHMAP_PERIOD_MS);
+}
+
+/********************************************************************************
+* Function Name: beacon_chmap_decide
+*********************************************************************************
+* Summary:
+*   Decides a channel map from the channel loads. The least loaded channels
+*   are kept up to the minimum; every other channel is used while its load is
+*   within BEACON_CHMAP_MARGIN_PERCENT of the least loaded one, or twice that
+*   if it is in the current map, so that loads close to the limit do not
+*   toggle the map. Loads under BEACON_CHMAP_LOAD_FLOOR are always accepted.
+*   Has no side effects, for testing with recorded or simulated loads.
+*
+* Parameters:
+*   load:                   Load per channel, 37 first, in any unit
+*                           consistent with BEACON_CHMAP_LOAD_FLOOR
+*   current_map:            Current map, BTM_BLE_ADVERT_CHNL_* bits
+*   min_channels:           Channels kept at least, 1 to 3
+*
+* Return:
+*   Channel map, BTM_BLE_ADVERT_CHNL_* bits
+*
+*********************************************************************************/
+uint8_t beacon_chmap_decide(const uint32_t load[BEACON_CHMAP_CHANNELS],
+                            uint8_t current_map, uint8_t min_channels)
+{
+    uint8_t order[BEACON_CHMAP_CHANNELS] = { 0, 1, 2 };
+    uint8_t map = 0;
+    uint8_t bit;
+    uint8_t tmp;
+    uint64_t limit;
+
+    /* Least loaded first; of equal loads the lower channel */
+    for (uint8_t i = 1; i < BEACON_CHMAP_CHANNELS; i++)
+    {
+        for (uint8_t j = i; (j > 0) && (load[order[j]] < load[order[j - 1]]); j--)
+        {
+            tmp          = order[j];
+            order[j]     = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    }
+
+    for (uint8_t i = 0; i < BEACON_CHMAP_CHANNELS; i++)
+    {
+        bit   = (uint8_t)(1U << order[i]);
+        limit = (uint64_t)load[order[0]] *
+                (100 + (((current_map & bit) ? 2 : 1) * BEACON_CHMAP_MARGIN_PERCENT)) / 100;
+        if ((i < min_channels) || (load[order[i]] < BEACON_CHMAP_LOAD_FLOOR) ||
+            (load[order[i]] <= limit))
+        {
+            map |= bit;
+        }
+    }
+    return map;
+}
+
+/********************************************************************************
+* Function Name: beacon_chmap_start
+*********************************************************************************
+* Summary:
+*   Starts managing the channel maps of all instances with
+*   BEACON_CHMAP_MIN_CHANNELS. Call in the beacon manager task.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_chmap_start(void)
+{
+    if (chmap_started)
+    {
+        return;
+    }
+    chmap_started = WICED_TRUE;
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        chmap_stats.min_channels[i] = BEACON_CHMAP_MIN_CHANNELS;
+    }
+    beacon_timer_setup(&chmap_timer, beacon_chmap_period, NULL);
+    beacon_timer_start(&chmap_timer, BEACON_CHMAP_PERIOD_MS);
+}
+
+/********************************************************************************
+* Function Name: beacon_chmap_observe
+*********************************************************************************
+* Summary:
+*   Accounts activity on a primary channel: reports of other advertisers
+*   received on it and packets of our own lost on it. May be called from any
+*   task.
+*
+* Parameters:
+*   channel:                Channel number, 37 to 39
+*   reports:                Reports received
+*   failures:               Packets lost
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_chmap_observe(uint8_t channel, uint32_t reports, uint32_t failures)
+{
+    uint8_t ch = channel - BEACON_CHMAP_FIRST_CHANNEL;
+
+    if (ch >= BEACON_CHMAP_CHANNELS)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    chmap_reports[ch]  += reports;
+    chmap_failures[ch] += failures;
+    taskEXIT_CRITICAL();
+}
+
+/********************************************************************************
+* Function Name: beacon_chmap_set_min
+*********************************************************************************
+* Summary:
+*   Sets the minimum number of channels of an instance and decides its map
+*   right away. With 0 the instance goes back to all three channels and is
+*   no longer managed. Call in the beacon manager task.
+*
+* Parameters:
+*   p_slot:                 Slot
+*   min_channels:           Channels kept at least, 1 to 3, 0 to stop
+*
+* Return:
+*   WICED_BT_PENDING if a params update was issued, WICED_BT_SUCCESS if the
+*   map did not change, otherwise the error of the slot call
+*
+*********************************************************************************/
+wiced_result_t beacon_chmap_set_min(beacon_slot_t *p_slot, uint8_t min_channels)
+{
+    uint8_t map = BEACON_CHMAP_ALL;
+
+    if (min_channels > BEACON_CHMAP_CHANNELS)
+    {
+        return WICED_BT_BADARG;
+    }
+
+    chmap_stats.min_channels[p_slot->instance - 1] = min_channels;
+    if (0 != min_channels)
+    {
+        map = beacon_chmap_decide(chmap_stats.load, beacon_chmap_current(p_slot), min_channels);
+    }
+    return beacon_chmap_apply(p_slot, map);
+}
+
+/********************************************************************************
+* Function Name: beacon_chmap_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the channel loads and the decision counters
+*
+* Parameters:
+*   p_stats:                Output
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_chmap_get_stats(beacon_chmap_stats_t *p_stats)
+{
+    *p_stats = chmap_stats;
+}
+
+/* [] END OF FILE */
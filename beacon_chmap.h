@@ -0,0 +1,136 @@
+/******************************************************************************
+* File Name: beacon_chmap.h
+*
+* Description: This is the header file for the channel map selection of the
+* advertising instances.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_CHMAP_H__
+#define __BEACON_CHMAP_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to drop congested primary channels from the channel maps */
+#ifndef BEACON_CHMAP_ENABLE
+#define BEACON_CHMAP_ENABLE              (0)
+#endif
+
+/* Primary advertising channels 37, 38 and 39 */
+#define BEACON_CHMAP_CHANNELS            (3)
+#define BEACON_CHMAP_FIRST_CHANNEL       (37)
+#define BEACON_CHMAP_ALL                 (BTM_BLE_ADVERT_CHNL_37 | BTM_BLE_ADVERT_CHNL_38 | \
+                                          BTM_BLE_ADVERT_CHNL_39)
+
+/* Period at which the channel loads are updated and the maps decided */
+#ifndef BEACON_CHMAP_PERIOD_MS
+#define BEACON_CHMAP_PERIOD_MS           (10000)
+#endif
+
+/* Channels every managed instance keeps by default */
+#ifndef BEACON_CHMAP_MIN_CHANNELS
+#define BEACON_CHMAP_MIN_CHANNELS        (2)
+#endif
+
+/* A lost packet of our own counts as this many reports of other advertisers */
+#ifndef BEACON_CHMAP_FAILURE_WEIGHT
+#define BEACON_CHMAP_FAILURE_WEIGHT      (8)
+#endif
+
+/* A channel is dropped when its load exceeds the least loaded channel by
+ * twice this percentage, and taken back when it is within it again */
+#ifndef BEACON_CHMAP_MARGIN_PERCENT
+#define BEACON_CHMAP_MARGIN_PERCENT      (50)
+#endif
+
+/* Loads below this many reports per period are treated as idle, so that a
+ * few reports never move a channel map */
+#ifndef BEACON_CHMAP_LOAD_FLOOR
+#define BEACON_CHMAP_LOAD_FLOOR          (20)
+#endif
+
+/* Periods a map is kept before it may change again */
+#ifndef BEACON_CHMAP_HOLD_PERIODS
+#define BEACON_CHMAP_HOLD_PERIODS        (3)
+#endif
+
+/* EWMA weight of a new period is 1 / (1 << BEACON_CHMAP_LOAD_SHIFT) */
+#define BEACON_CHMAP_LOAD_SHIFT          (2)
+
+/* Losses are only measured on channels in use. On a dropped channel they
+ * decay by 1 / (1 << BEACON_CHMAP_RETRY_SHIFT) per period instead, so that
+ * the channel is tried again once interference without reports, such as
+ * Wi-Fi, may have gone. */
+#define BEACON_CHMAP_RETRY_SHIFT         (5)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Channel loads and decisions */
+typedef struct
+{
+    uint32_t load[BEACON_CHMAP_CHANNELS];       /* Smoothed load per period */
+    uint32_t reports[BEACON_CHMAP_CHANNELS];    /* Reports of the last period */
+    uint32_t failures[BEACON_CHMAP_CHANNELS];   /* Lost packets of the last period */
+    uint8_t  min_channels[BEACON_SLOT_MAX_INSTANCES]; /* 0 if the map is not managed */
+    uint32_t changes;                           /* Params updates issued */
+    uint32_t rejected;                          /* Params updates not accepted */
+}beacon_chmap_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void           beacon_chmap_start    (void);
+
+void           beacon_chmap_observe  (uint8_t channel, uint32_t reports, uint32_t failures);
+
+uint8_t        beacon_chmap_decide   (const uint32_t load[BEACON_CHMAP_CHANNELS],
+                                      uint8_t current_map, uint8_t min_channels);
+
+wiced_result_t beacon_chmap_set_min  (beacon_slot_t *p_slot, uint8_t min_channels);
+
+void           beacon_chmap_get_stats(beacon_chmap_stats_t *p_stats);
+
+#endif      /* __BEACON_CHMAP_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1432 @@
+/******************************************************************************
+* File Name: beacon_console.c
+*
+* Description: This is the source code for the command console. Characters are
+* received in the UART interrupt into a small ring and the line is edited and
+* parsed in a low priority task, without any dynamic memory. Commands that
+* change a slot are handed to the beacon manager task, so the console never
+* calls the Bluetooth stack itself.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cyhal.h"
+#include "cy_retarget_io.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "beacon_bench.h"
+#include "beacon_campaign.h"
+#include "beacon_ccm.h"
+#include "beacon_chmap.h"
+#include "beacon_console.h"
+#include "beacon_energy.h"
+#include "beacon_format.h"
+#include "beacon_health.h"
+#include "beacon_ipc.h"
+#include "beacon_manager.h"
+#include "beacon_power.h"
+#include "beacon_prov.h"
+#include "beacon_relay.h"
+#include "beacon_rolling.h"
+#include "beacon_rpa.h"
+#include "beacon_scanreq.h"
+#include "beacon_sim.h"
+#include "beacon_slot.h"
+#include "beacon_stats.h"
+#include "beacon_trace.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define CONSOLE_RX_MASK                  (BEACON_CONSOLE_RX_SIZE - 1)
+
+#if (BEACON_CONSOLE_RX_SIZE & CONSOLE_RX_MASK)
+#error "BEACON_CONSOLE_RX_SIZE must be a power of two"
+#endif
+
+#if BEACON_PROV_ENABLE && (BEACON_CONSOLE_RX_SIZE < (BEACON_PROV_WINDOW * BEACON_PROV_FRAME_MAX))
+#error "BEACON_CONSOLE_RX_SIZE must hold a provisioning window"
+#endif
+
+/* Advertising interval bounds, in 0.625 ms units */
+#define CONSOLE_ADV_INTERVAL_MIN         (0x0020)
+#define CONSOLE_ADV_INTERVAL_MAX         (0x4000)
+
+/* Largest target range of the range command */
+#define CONSOLE_RANGE_MAX_M              (1000)
+
+#define CONSOLE_PROMPT                   "> "
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Slot change handed to the beacon manager */
+typedef enum
+{
+    CONSOLE_OP_DATA,
+    CONSOLE_OP_PARAMS,
+    CONSOLE_OP_START,
+    CONSOLE_OP_FORMAT,
+    CONSOLE_OP_RANGE,
+    CONSOLE_OP_CAMPAIGN,
+    CONSOLE_OP_SCANNABLE,
+    CONSOLE_OP_CHMAP
+}console_op_t;
+
+typedef struct
+{
+    console_op_t op;                            /* Change to apply */
+    beacon_slot_t *p_slot;                      /* Slot to change */
+    uint8_t adv_len;                            /* CONSOLE_OP_DATA */
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];      /* CONSOLE_OP_DATA */
+    wiced_bt_ble_multi_adv_params_t params;     /* CONSOLE_OP_PARAMS */
+    wiced_bool_t start;                         /* CONSOLE_OP_START, CONSOLE_OP_SCANNABLE */
+    const beacon_format_desc_t *p_desc;         /* CONSOLE_OP_FORMAT */
+    uint32_t range_cm;                          /* CONSOLE_OP_RANGE */
+    uint32_t time_s;                            /* CONSOLE_OP_CAMPAIGN */
+    uint8_t min_channels;                       /* CONSOLE_OP_CHMAP */
+    wiced_result_t result;                      /* Result of the slot call */
+}console_request_t;
+
+/* Command table entry */
+typedef struct
+{
+    const char *name;                           /* Command word */
+    const char *args;                           /* Arguments */
+    const char *help;                           /* Description */
+    uint8_t min_args;                           /* Words including the command */
+    void (*p_handler)(uint8_t argc, char *argv[]);
+}console_cmd_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+static void beacon_console_help   (uint8_t argc, char *argv[]);
+static void beacon_console_slots  (uint8_t argc, char *argv[]);
+static void beacon_console_stats  (uint8_t argc, char *argv[]);
+static void beacon_console_data   (uint8_t argc, char *argv[]);
+static void beacon_console_params (uint8_t argc, char *argv[]);
+static void beacon_console_start  (uint8_t argc, char *argv[]);
+static void beacon_console_stop   (uint8_t argc, char *argv[]);
+static void beacon_console_format (uint8_t argc, char *argv[]);
+static void beacon_console_range  (uint8_t argc, char *argv[]);
+#if BEACON_SIM_CONTROLLER
+static void beacon_console_sim    (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_BENCH_ENABLE
+static void beacon_console_bench  (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_PROV_ENABLE
+static void beacon_console_prov   (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_TRACE_ENABLE
+static void beacon_console_trace  (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_ENERGY_ENABLE
+static void beacon_console_energy (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_CAMPAIGN_ENABLE
+static void beacon_console_campaign (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_SCANREQ_ENABLE
+static void beacon_console_scan   (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_CHMAP_ENABLE
+static void beacon_console_chmap  (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_HEALTH_ENABLE
+static void beacon_console_health (uint8_t argc, char *argv[]);
+#endif
+#if BEACON_CCM_ENABLE
+static void beacon_console_ccm    (uint8_t argc, char *argv[]);
+#endif
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static const console_cmd_t console_cmds[] =
+{
+    { "help",   "",                            "List the commands",                     1, beacon_console_help   },
+    { "slots",  "",                            "List the advertising slots",            1, beacon_console_slots  },
+    { "stats",  "[instance]",                  "Counters and latency statistics",       1, beacon_console_stats  },
+    { "data",   "<instance> <hex>",            "Set the advertising data",              3, beacon_console_data   },
+    { "params", "<instance> <min> <max> [tx]", "Set the interval (0.625 ms) and power", 4, beacon_console_params },
+    { "start",  "<instance>",                  "Start advertising",                     2, beacon_console_start  },
+    { "stop",   "<instance>",                  "Stop advertising",                      2, beacon_console_stop   },
+    { "format", "<instance> <name>",           "Advertise a registered format",         3, beacon_console_format },
+    { "range",  "<instance> <meters>",         "Lowest power reaching a range, 0 off",  3, beacon_console_range  },
+#if BEACON_SIM_CONTROLLER
+    { "sim",    "[reset|restart]",             "Simulated controller trace",            1, beacon_console_sim    },
+#endif
+#if BEACON_BENCH_ENABLE
+    { "bench",  "",                            "Run the lifecycle benchmark",           1, beacon_console_bench  },
+#endif
+#if BEACON_PROV_ENABLE
+    { "prov",   "",                            "Receive a provisioning session",        1, beacon_console_prov   },
+#endif
+#if BEACON_TRACE_ENABLE
+    { "trace",  "[clear]",                     "Dump the trace for beacon_trace.py",    1, beacon_console_trace  },
+#endif
+#if BEACON_ENERGY_ENABLE
+    { "energy", "[reset]",                     "Estimated charge and battery life",     1, beacon_console_energy },
+#endif
+#if BEACON_CAMPAIGN_ENABLE
+    { "campaign", "[unix time]",               "Set or show the campaign clock",        1, beacon_console_campaign },
+#endif
+#if BEACON_SCANREQ_ENABLE
+    { "scan",   "<instance> <on|off|reset>",   "Scannable mode and scan requests",      3, beacon_console_scan   },
+#endif
+#if BEACON_CHMAP_ENABLE
+    { "chmap",  "[instance] [channels|off]",   "Channel loads, or minimum channels",    1, beacon_console_chmap  },
+#endif
+#if BEACON_HEALTH_ENABLE
+    { "health", "[reset]",                     "Instance faults and recovery times",    1, beacon_console_health },
+#endif
+#if BEACON_CCM_ENABLE
+    { "ccm",    "[plaintext octets]",          "Encrypted frames sealed and opened /s", 1, beacon_console_ccm    },
+#endif
+};
+
+static char                      console_line[BEACON_CONSOLE_LINE_MAX];
+static uint8_t                   console_line_len;
+static wiced_bool_t              console_line_overflow;
+
+static uint8_t                   console_rx[BEACON_CONSOLE_RX_SIZE];
+static volatile uint32_t         console_rx_head;
+static volatile uint32_t         console_rx_tail;
+static volatile uint32_t         console_rx_dropped;
+
+/* Received characters go to the provisioning receiver */
+static wiced_bool_t              console_prov;
+
+static console_request_t         console_request;
+static SemaphoreHandle_t         console_done;
+static StaticSemaphore_t         console_done_buffer;
+
+static TaskHandle_t              console_task_handle;
+static StaticTask_t              console_task_tcb;
+static StackType_t               console_task_stack[BEACON_CONSOLE_TASK_STACK_SIZE];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_console_apply
+*********************************************************************************
+* Summary:
+*   Applies the pending slot change, deferred to the beacon manager task
+*
+*********************************************************************************/
+static void beacon_console_apply(void)
+{
+    console_request_t *p_req = &console_request;
+
+    switch (p_req->op)
+    {
+    case CONSOLE_OP_DATA:
+        /* Raw data replaces a bound format, so its updater stops */
+        beacon_format_bind(p_req->p_slot, NULL, NULL);
+        p_req->result = beacon_slot_set_data(p_req->p_slot, p_req->adv_data, p_req->adv_len);
+        break;
+
+    case CONSOLE_OP_PARAMS:
+        p_req->result = beacon_slot_set_params(p_req->p_slot, &p_req->params);
+        break;
+
+    case CONSOLE_OP_START:
+        p_req->result = beacon_slot_start(p_req->p_slot, p_req->start);
+        break;
+
+    case CONSOLE_OP_FORMAT:
+        p_req->result = beacon_format_bind(p_req->p_slot, p_req->p_desc, p_req->p_desc->p_defaults);
+        break;
+
+    case CONSOLE_OP_RANGE:
+        p_req->result = beacon_power_set_range(p_req->p_slot, p_req->range_cm);
+        break;
+
+#if BEACON_CAMPAIGN_ENABLE
+    case CONSOLE_OP_CAMPAIGN:
+        p_req->result = beacon_campaign_set_time(&beacon_campaign_table, p_req->time_s);
+        break;
+#endif
+
+#if BEACON_SCANREQ_ENABLE
+    case CONSOLE_OP_SCANNABLE:
+        p_req->result = beacon_scanreq_set_scannable(p_req->p_slot, p_req->start);
+        break;
+#endif
+
+#if BEACON_CHMAP_ENABLE
+    case CONSOLE_OP_CHMAP:
+        p_req->result = beacon_chmap_set_min(p_req->p_slot, p_req->min_channels);
+        break;
+#endif
+
+    default:
+        p_req->result = WICED_BT_BADARG;
+        break;
+    }
+
+    xSemaphoreGive(console_done);
+}
+
+/********************************************************************************
+* Function Name: beacon_console_submit
+*********************************************************************************
+* Summary:
+*   Hands the request to the beacon manager and waits for its result. Only the
+*   console task waits, the manager and the stack are never blocked.
+*
+*********************************************************************************/
+static void beacon_console_submit(void)
+{
+    beacon_manager_defer(beacon_console_apply);
+    xSemaphoreTake(console_done, portMAX_DELAY);
+
+    if (WICED_BT_PENDING == console_request.result)
+    {
+        printf("Issued, see the multi ADV response\n");
+    }
+    else if (WICED_BT_SUCCESS == console_request.result)
+    {
+        printf("Nothing to change\n");
+    }
+    else
+    {
+        printf("Not accepted, result 0x%X\n", (unsigned int)console_request.result);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_console_number
+*********************************************************************************
+* Summary:
+*   Parses a decimal or 0x prefixed hexadecimal number
+*
+*********************************************************************************/
+static wiced_bool_t beacon_console_number(const char *arg, uint32_t max, uint32_t *p_value)
+{
+    char *end;
+    unsigned long value = strtoul(arg, &end, 0);
+
+    if ((end == arg) || ('\0' != *end) || (value > max))
+    {
+        printf("Invalid number: %s\n", arg);
+        return WICED_FALSE;
+    }
+    *p_value = (uint32_t)value;
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_console_slot
+*********************************************************************************
+* Summary:
+*   Parses an instance number and returns its slot
+*
+*********************************************************************************/
+static beacon_slot_t *beacon_console_slot(const char *arg)
+{
+    uint32_t instance;
+    beacon_slot_t *p_slot = NULL;
+
+    if (beacon_console_number(arg, BEACON_SLOT_MAX_INSTANCES, &instance))
+    {
+        p_slot = beacon_slot_get((uint8_t)instance);
+        if (NULL == p_slot)
+        {
+            printf("No instance %s\n", arg);
+        }
+    }
+    return p_slot;
+}
+
+/********************************************************************************
+* Function Name: beacon_console_hex
+*********************************************************************************
+* Summary:
+*   Parses a string of hexadecimal digit pairs
+*
+*********************************************************************************/
+static wiced_bool_t beacon_console_hex(const char *arg, uint8_t *p_data, uint8_t max,
+                                       uint8_t *p_len)
+{
+    uint8_t len = 0;
+    uint8_t nibble;
+    char c;
+
+    for (uint8_t i = 0; '\0' != (c = arg[i]); i++)
+    {
+        if ((c >= '0') && (c <= '9'))
+        {
+            nibble = (uint8_t)(c - '0');
+        }
+        else if (((c | 0x20) >= 'a') && ((c | 0x20) <= 'f'))
+        {
+            nibble = (uint8_t)((c | 0x20) - 'a' + 10);
+        }
+        else
+        {
+            printf("Invalid hex digit '%c'\n", c);
+            return WICED_FALSE;
+        }
+
+        if (0 == (i & 1))
+        {
+            if (len == max)
+            {
+                printf("At most %u bytes\n", max);
+                return WICED_FALSE;
+            }
+            p_data[len] = (uint8_t)(nibble << 4);
+        }
+        else
+        {
+            p_data[len++] |= nibble;
+        }
+
+        if (('\0' == arg[i + 1]) && (0 == (i & 1)))
+        {
+            printf("Odd number of hex digits\n");
+            return WICED_FALSE;
+        }
+    }
+
+    *p_len = len;
+    return WICED_TRUE;
+}
+
+#if BEACON_RELAY_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_latency
+*********************************************************************************
+* Summary:
+*   Prints latency statistics in microseconds
+*
+*********************************************************************************/
+static void beacon_console_latency(const char *name, const beacon_latency_t *p_latency)
+{
+    if (0 == p_latency->count)
+    {
+        printf("  %s: no samples\n", name);
+        return;
+    }
+    printf("  %s: %lu samples, min %lu, mean %lu, max %lu us\n", name,
+           (unsigned long)p_latency->count, (unsigned long)p_latency->min,
+           (unsigned long)beacon_latency_mean(p_latency), (unsigned long)p_latency->max);
+}
+#endif
+
+/********************************************************************************
+* Function Name: beacon_console_slot_stats
+*********************************************************************************
+* Summary:
+*   Prints the counters of a slot
+*
+*********************************************************************************/
+static void beacon_console_slot_stats(const beacon_slot_t *p_slot)
+{
+    const beacon_slot_stats_t *p_stats = &p_slot->stats;
+#if BEACON_RPA_ENABLE
+    const beacon_rpa_stats_t *p_rpa = beacon_rpa_get_stats(p_slot);
+#endif
+
+    printf("Instance %u: issued %lu, rejected %lu, failed %lu, data %lu, params %lu\n",
+           p_slot->instance, (unsigned long)p_stats->cmd_issued,
+           (unsigned long)p_stats->cmd_rejected, (unsigned long)p_stats->cmd_failed,
+           (unsigned long)p_stats->data_updates, (unsigned long)p_stats->params_updates);
+
+#if BEACON_RPA_ENABLE
+    if (NULL != p_rpa)
+    {
+        printf("  RPA: rotations %lu, late %lu, rejected %lu\n", (unsigned long)p_rpa->rotations,
+               (unsigned long)p_rpa->late, (unsigned long)p_rpa->rejected);
+    }
+#endif
+
+#if BEACON_SCANREQ_ENABLE
+    if (MULTI_ADVERT_NONCONNECTABLE_EVENT != p_slot->params.adv_type)
+    {
+        beacon_scanreq_snapshot_t snapshot;
+
+        beacon_scanreq_get(p_slot->instance, &snapshot);
+        printf("  Scan requests: %lu from about %lu scanners, per %lu min, oldest first:",
+               (unsigned long)snapshot.total, (unsigned long)snapshot.distinct,
+               (unsigned long)(snapshot.bucket_ms / 60000));
+        for (uint8_t i = 0; i < BEACON_SCANREQ_BUCKETS; i++)
+        {
+            printf(" %lu", (unsigned long)snapshot.buckets[i]);
+        }
+        printf("\n");
+    }
+#endif
+}
+
+/********************************************************************************
+* Function Name: beacon_console_help
+*********************************************************************************
+* Summary:
+*   help command
+*
+*********************************************************************************/
+static void beacon_console_help(uint8_t argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    for (uint8_t i = 0; i < (sizeof(console_cmds) / sizeof(console_cmds[0])); i++)
+    {
+        printf("%-8s %-28s %s\n", console_cmds[i].name, console_cmds[i].args,
+               console_cmds[i].help);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_console_slots
+*********************************************************************************
+* Summary:
+*   slots command
+*
+*********************************************************************************/
+static void beacon_console_slots(uint8_t argc, char *argv[])
+{
+    const beacon_slot_t *p_slot;
+
+    (void)argc;
+    (void)argv;
+
+    for (uint8_t instance = 1; instance <= BEACON_SLOT_MAX_INSTANCES; instance++)
+    {
+        p_slot = beacon_slot_get(instance);
+        if (NULL == p_slot)
+        {
+            continue;
+        }
+
+        printf("Instance %u: %s, interval %u-%u, tx power %u, range %lu cm, %u pending, %u bytes:",
+               instance, p_slot->advertising ? "advertising" : "stopped",
+               p_slot->params.adv_int_min, p_slot->params.adv_int_max,
+               (unsigned int)p_slot->params.adv_tx_power,
+               (unsigned long)beacon_power_get_range(p_slot), p_slot->cmds_pending, p_slot->adv_len);
+        for (uint8_t i = 0; i < p_slot->adv_len; i++)
+        {
+            printf(" %02X", p_slot->adv_data[i]);
+        }
+        printf("\n");
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_console_stats
+*********************************************************************************
+* Summary:
+*   stats command
+*
+*********************************************************************************/
+static void beacon_console_stats(uint8_t argc, char *argv[])
+{
+    const beacon_slot_t *p_slot;
+    const beacon_manager_stats_t *p_manager = beacon_manager_get_stats();
+    const beacon_worker_stats_t *p_worker = beacon_worker_get_stats();
+    uint32_t now_ms = beacon_stats_now_ms();
+
+    if (argc > 1)
+    {
+        p_slot = beacon_console_slot(argv[1]);
+        if (NULL != p_slot)
+        {
+            beacon_console_slot_stats(p_slot);
+        }
+        return;
+    }
+
+    for (uint8_t instance = 1; instance <= BEACON_SLOT_MAX_INSTANCES; instance++)
+    {
+        p_slot = beacon_slot_get(instance);
+        if (NULL != p_slot)
+        {
+            beacon_console_slot_stats(p_slot);
+        }
+    }
+
+    printf("Manager: posted %lu, dropped %lu, handled %lu, deferred %lu, control lost %lu\n",
+           (unsigned long)p_manager->posted, (unsigned long)p_manager->dropped,
+           (unsigned long)p_manager->handled, (unsigned long)p_manager->deferred,
+           (unsigned long)p_manager->control_lost);
+
+    printf("  Stack callbacks: %lu, mean %lu us, worst %lu us\n",
+           (unsigned long)p_manager->cback_cycles.count,
+           (unsigned long)beacon_stats_cycles_to_us(beacon_latency_mean(&p_manager->cback_cycles)),
+           (unsigned long)beacon_stats_cycles_to_us(p_manager->cback_cycles.max));
+
+    printf("Worker: %lu wakeups/h, %lu with independent timers, %lu kicks\n",
+           (unsigned long)beacon_worker_per_hour(p_worker->wakeups, now_ms),
+           (unsigned long)beacon_worker_per_hour(p_worker->job_deadlines, now_ms),
+           (unsigned long)p_worker->kicks);
+
+#if BEACON_RELAY_ENABLE
+    for (uint8_t rule = 0; rule < BEACON_RELAY_MAX_RULES; rule++)
+    {
+        const beacon_relay_stats_t *p_relay = beacon_relay_get_stats(rule);
+
+        if (NULL == p_relay)
+        {
+            break;
+        }
+        printf("Relay rule %u: matched %lu, relayed %lu, rate %lu, superseded %lu, failed %lu, "
+               "expired %lu\n", rule, (unsigned long)p_relay->matched,
+               (unsigned long)p_relay->relayed, (unsigned long)p_relay->drop_rate,
+               (unsigned long)p_relay->drop_superseded, (unsigned long)p_relay->drop_failed,
+               (unsigned long)p_relay->expired);
+        beacon_console_latency("Scan to air", &p_relay->latency_us);
+    }
+#endif
+
+#if BEACON_IPC_ENABLE
+    {
+        const beacon_ipc_stats_t *p_ipc = beacon_ipc_get_stats();
+
+        printf("IPC payloads: received %lu, superseded %lu, submitted %lu, rejected %lu\n",
+               (unsigned long)p_ipc->received, (unsigned long)p_ipc->superseded,
+               (unsigned long)p_ipc->submitted, (unsigned long)p_ipc->rejected);
+    }
+#endif
+
+#if BEACON_ROLLING_ENABLE
+    {
+        const beacon_rolling_stats_t *p_rolling = beacon_rolling_get_stats();
+
+        printf("Rolling identity: rotations %lu, late %lu, rejected %lu, unreserved %lu\n",
+               (unsigned long)p_rolling->rotations, (unsigned long)p_rolling->late,
+               (unsigned long)p_rolling->rejected, (unsigned long)p_rolling->unreserved);
+    }
+#endif
+
+#if BEACON_CCM_ENABLE
+    {
+        const beacon_ccm_stats_t *p_ccm = beacon_ccm_get_stats();
+
+        printf("Encrypted frames: sealed %lu, late %lu, rejected %lu, exhausted %lu\n",
+               (unsigned long)p_ccm->frames, (unsigned long)p_ccm->late,
+               (unsigned long)p_ccm->rejected, (unsigned long)p_ccm->exhausted);
+    }
+#endif
+
+#if BEACON_PROV_ENABLE
+    {
+        const beacon_prov_stats_t *p_prov = beacon_prov_get_stats();
+
+        printf("Provisioning: sessions %lu, commits %lu, discarded %lu, records %lu\n",
+               (unsigned long)p_prov->sessions, (unsigned long)p_prov->commits,
+               (unsigned long)p_prov->discarded, (unsigned long)p_prov->records);
+        printf("  CRC errors %lu, out of order %lu, duplicates %lu, RX dropped %lu\n",
+               (unsigned long)p_prov->crc_errors, (unsigned long)p_prov->out_of_order,
+               (unsigned long)p_prov->duplicates, (unsigned long)console_rx_dropped);
+    }
+#endif
+}
+
+/********************************************************************************
+* Function Name: beacon_console_data
+*********************************************************************************
+* Summary:
+*   data command
+*
+*********************************************************************************/
+static void beacon_console_data(uint8_t argc, char *argv[])
+{
+    (void)argc;
+
+    console_request.p_slot = beacon_console_slot(argv[1]);
+    if ((NULL != console_request.p_slot) &&
+        beacon_console_hex(argv[2], console_request.adv_data, BEACON_ADV_DATA_MAX,
+                           &console_request.adv_len))
+    {
+        console_request.op = CONSOLE_OP_DATA;
+        beacon_console_submit();
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_console_params
+*********************************************************************************
+* Summary:
+*   params command. The other parameters of the slot are kept.
+*
+*********************************************************************************/
+static void beacon_console_params(uint8_t argc, char *argv[])
+{
+    uint32_t int_min;
+    uint32_t int_max;
+    uint32_t tx_power;
+
+    console_request.p_slot = beacon_console_slot(argv[1]);
+    if ((NULL == console_request.p_slot) ||
+        !beacon_console_number(argv[2], CONSOLE_ADV_INTERVAL_MAX, &int_min) ||
+        !beacon_console_number(argv[3], CONSOLE_ADV_INTERVAL_MAX, &int_max))
+    {
+        return;
+    }
+
+    if ((int_min < CONSOLE_ADV_INTERVAL_MIN) || (int_min > int_max))
+    {
+        printf("Interval must be %u-%u with min <= max\n",
+               CONSOLE_ADV_INTERVAL_MIN, CONSOLE_ADV_INTERVAL_MAX);
+        return;
+    }
+
+    console_request.params             = console_request.p_slot->params;
+    console_request.params.adv_int_min = (uint16_t)int_min;
+    console_request.params.adv_int_max = (uint16_t)int_max;
+
+    if (argc > 4)
+    {
+        if (!beacon_console_number(argv[4], MULTI_ADV_TX_POWER_MAX_INDEX, &tx_power))
+        {
+            return;
+        }
+        console_request.params.adv_tx_power = (wiced_bt_ble_adv_tx_power_t)tx_power;
+    }
+
+    console_request.op = CONSOLE_OP_PARAMS;
+    beacon_console_submit();
+}
+
+/********************************************************************************
+* Function Name: beacon_console_start
+*********************************************************************************
+* Summary:
+*   start command
+*
+*********************************************************************************/
+static void beacon_console_start(uint8_t argc, char *argv[])
+{
+    (void)argc;
+
+    console_request.p_slot = beacon_console_slot(argv[1]);
+    if (NULL != console_request.p_slot)
+    {
+        console_request.op    = CONSOLE_OP_START;
+        console_request.start = WICED_TRUE;
+        beacon_console_submit();
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_console_stop
+*********************************************************************************
+* Summary:
+*   stop command
+*
+*********************************************************************************/
+static void beacon_console_stop(uint8_t argc, char *argv[])
+{
+    (void)argc;
+
+    console_request.p_slot = beacon_console_slot(argv[1]);
+    if (NULL != console_request.p_slot)
+    {
+        console_request.op    = CONSOLE_OP_START;
+        console_request.start = WICED_FALSE;
+        beacon_console_submit();
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_console_format
+*********************************************************************************
+* Summary:
+*   format command, the sample values of the format are advertised
+*
+*********************************************************************************/
+static void beacon_console_format(uint8_t argc, char *argv[])
+{
+    (void)argc;
+
+    console_request.p_slot = beacon_console_slot(argv[1]);
+    if (NULL == console_request.p_slot)
+    {
+        return;
+    }
+
+    console_request.p_desc = beacon_format_find(argv[2]);
+    if (NULL == console_request.p_desc)
+    {
+        printf("Unknown format %s, use one of:", argv[2]);
+        for (uint8_t i = 0; i < beacon_format_count(); i++)
+        {
+            printf(" %s", beacon_format_get(i)->name);
+        }
+        printf("\n");
+        return;
+    }
+
+    console_request.op = CONSOLE_OP_FORMAT;
+    beacon_console_submit();
+}
+
+/********************************************************************************
+* Function Name: beacon_console_range
+*********************************************************************************
+* Summary:
+*   range command
+*
+*********************************************************************************/
+static void beacon_console_range(uint8_t argc, char *argv[])
+{
+    uint32_t range_m;
+
+    (void)argc;
+
+    console_request.p_slot = beacon_console_slot(argv[1]);
+    if ((NULL == console_request.p_slot) ||
+        !beacon_console_number(argv[2], CONSOLE_RANGE_MAX_M, &range_m))
+    {
+        return;
+    }
+
+    console_request.range_cm = range_m * 100;
+    console_request.op       = CONSOLE_OP_RANGE;
+    beacon_console_submit();
+}
+
+#if BEACON_SIM_CONTROLLER
+/********************************************************************************
+* Function Name: beacon_console_sim
+*********************************************************************************
+* Summary:
+*   sim command
+*
+*********************************************************************************/
+static void beacon_console_sim(uint8_t argc, char *argv[])
+{
+    const beacon_sim_stats_t *p_stats = beacon_sim_get_stats();
+    const beacon_sim_trace_t *p_trace;
+    uint32_t count = beacon_sim_trace_count();
+
+    if ((argc > 1) && (0 == strcmp(argv[1], "reset")))
+    {
+        beacon_sim_reset_stats();
+        return;
+    }
+    if ((argc > 1) && (0 == strcmp(argv[1], "restart")))
+    {
+        beacon_sim_restart();
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        p_trace = beacon_sim_get_trace(i);
+        if (NULL != p_trace)
+        {
+            printf("%5lu: %lu-%lu ms HCI %04X sub %u instance %u, %u bytes, status %02X\n",
+                   (unsigned long)i, (unsigned long)p_trace->issue_ms,
+                   (unsigned long)p_trace->resp_ms, p_trace->hci_opcode, p_trace->sub_opcode,
+                   p_trace->instance, p_trace->hci_len, p_trace->status);
+        }
+    }
+
+    printf("Commands %lu, rejected %lu, failed %lu, HCI bytes %lu\n",
+           (unsigned long)p_stats->commands, (unsigned long)p_stats->rejected,
+           (unsigned long)p_stats->failed, (unsigned long)p_stats->hci_bytes);
+    if (0 != p_stats->first_adv_ms)
+    {
+        printf("Boot to advertising %lu ms\n",
+               (unsigned long)(p_stats->first_adv_ms - p_stats->init_ms));
+    }
+}
+#endif
+
+#if BEACON_BENCH_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_bench
+*********************************************************************************
+* Summary:
+*   bench command
+*
+*********************************************************************************/
+static void beacon_console_bench(uint8_t argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    beacon_bench_run();
+}
+#endif
+
+#if BEACON_PROV_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_prov_send
+*********************************************************************************
+* Summary:
+*   Writes a provisioning reply. Other tasks may still print, the sender
+*   skips everything that is not a valid frame.
+*
+*********************************************************************************/
+static void beacon_console_prov_send(const uint8_t *data, uint32_t len)
+{
+    size_t tx_len = len;
+
+    fflush(stdout);
+    cyhal_uart_write(&cy_retarget_io_uart_obj, (void *)data, &tx_len);
+}
+
+/********************************************************************************
+* Function Name: beacon_console_prov
+*********************************************************************************
+* Summary:
+*   prov command. The console takes no commands until the session ends.
+*
+*********************************************************************************/
+static void beacon_console_prov(uint8_t argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    printf("Provisioning, waiting for BEGIN\n");
+    beacon_prov_begin(beacon_console_prov_send);
+    console_prov = WICED_TRUE;
+}
+#endif
+
+#if BEACON_TRACE_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_trace
+*********************************************************************************
+* Summary:
+*   trace command
+*
+*********************************************************************************/
+static void beacon_console_trace(uint8_t argc, char *argv[])
+{
+    if ((argc > 1) && (0 == strcmp(argv[1], "clear")))
+    {
+        beacon_trace_clear();
+        return;
+    }
+
+    beacon_trace_dump();
+}
+#endif
+
+#if BEACON_ENERGY_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_energy
+*********************************************************************************
+* Summary:
+*   energy command. With the simulated controller, the events it sent are
+*   listed next to the estimate.
+*
+*********************************************************************************/
+static void beacon_console_energy(uint8_t argc, char *argv[])
+{
+    beacon_energy_report_t report;
+
+    if ((argc > 1) && (0 == strcmp(argv[1], "reset")))
+    {
+#if BEACON_SIM_CONTROLLER
+        beacon_sim_reset_stats();
+#endif
+        beacon_energy_start();
+        return;
+    }
+
+    beacon_energy_get(&report);
+
+    printf("Elapsed %lu ms, %lu worker wakeups\n",
+           (unsigned long)report.elapsed_ms, (unsigned long)report.wakeups);
+    for (uint8_t instance = 1; instance <= BEACON_SLOT_MAX_INSTANCES; instance++)
+    {
+#if BEACON_SIM_CONTROLLER
+        printf("Instance %u: %lu events, simulated %lu\n", instance,
+               (unsigned long)report.adv_events[instance - 1],
+               (unsigned long)beacon_sim_adv_events(instance));
+#else
+        printf("Instance %u: %lu events\n", instance,
+               (unsigned long)report.adv_events[instance - 1]);
+#endif
+    }
+    printf("Charge: advertising %lu uC, total %lu uC\n",
+           (unsigned long)(report.adv_nc / 1000), (unsigned long)(report.total_nc / 1000));
+    printf("Average %lu.%03lu uA, %lu days on %u mAh\n",
+           (unsigned long)(report.average_na / 1000), (unsigned long)(report.average_na % 1000),
+           (unsigned long)(report.life_hours / 24), BEACON_ENERGY_BATTERY_MAH);
+}
+#endif
+
+#if BEACON_CAMPAIGN_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_campaign
+*********************************************************************************
+* Summary:
+*   campaign command
+*
+*********************************************************************************/
+static void beacon_console_campaign(uint8_t argc, char *argv[])
+{
+    const beacon_campaign_stats_t *p_stats = beacon_campaign_get_stats();
+    const beacon_campaign_entry_t *p_next;
+
+    if (argc > 1)
+    {
+        if (beacon_console_number(argv[1], 0xFFFFFFFFUL, &console_request.time_s))
+        {
+            console_request.op = CONSOLE_OP_CAMPAIGN;
+            beacon_console_submit();
+        }
+        return;
+    }
+
+    if (BEACON_CAMPAIGN_NO_TIME == beacon_campaign_time())
+    {
+        printf("Time not set, %lu transitions\n",
+               (unsigned long)beacon_campaign_table.num_entries);
+        return;
+    }
+
+    printf("Time %lu, transition %lu of %lu\n", (unsigned long)beacon_campaign_time(),
+           (unsigned long)p_stats->next, (unsigned long)beacon_campaign_table.num_entries);
+    if (p_stats->next < beacon_campaign_table.num_entries)
+    {
+        p_next = &beacon_campaign_table.p_entries[p_stats->next];
+        printf("Next at %lu: instance %u, payload %u\n", (unsigned long)p_next->start_s,
+               p_next->instance, p_next->payload);
+    }
+    printf("Transitions %lu, superseded %lu, rejected %lu\n",
+           (unsigned long)p_stats->transitions, (unsigned long)p_stats->superseded,
+           (unsigned long)p_stats->rejected);
+}
+#endif
+
+#if BEACON_SCANREQ_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_scan
+*********************************************************************************
+* Summary:
+*   scan command. The counters are listed by the stats command.
+*
+*********************************************************************************/
+static void beacon_console_scan(uint8_t argc, char *argv[])
+{
+    (void)argc;
+
+    console_request.p_slot = beacon_console_slot(argv[1]);
+    if (NULL == console_request.p_slot)
+    {
+        return;
+    }
+
+    if (0 == strcmp(argv[2], "reset"))
+    {
+        beacon_scanreq_reset(console_request.p_slot->instance);
+        return;
+    }
+    if ((0 != strcmp(argv[2], "on")) && (0 != strcmp(argv[2], "off")))
+    {
+        printf("Expected on, off or reset\n");
+        return;
+    }
+
+    console_request.start = (0 == strcmp(argv[2], "on")) ? WICED_TRUE : WICED_FALSE;
+    console_request.op    = CONSOLE_OP_SCANNABLE;
+    beacon_console_submit();
+}
+#endif
+
+#if BEACON_CHMAP_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_chmap
+*********************************************************************************
+* Summary:
+*   chmap command
+*
+*********************************************************************************/
+static void beacon_console_chmap(uint8_t argc, char *argv[])
+{
+    beacon_chmap_stats_t stats;
+    beacon_slot_t *p_slot;
+    uint32_t min_channels = 0;
+
+    if (argc < 3)
+    {
+        beacon_chmap_get_stats(&stats);
+        for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+        {
+            printf("Channel %u: load %lu, last period %lu reports %lu lost\n",
+                   BEACON_CHMAP_FIRST_CHANNEL + ch, (unsigned long)stats.load[ch],
+                   (unsigned long)stats.reports[ch], (unsigned long)stats.failures[ch]);
+        }
+        for (uint8_t instance = 1; instance <= BEACON_SLOT_MAX_INSTANCES; instance++)
+        {
+            p_slot = beacon_slot_get(instance);
+            printf("Instance %u: map 0x%X, min %u\n", instance,
+                   (NULL != p_slot) ? p_slot->params.channel_map : 0,
+                   stats.min_channels[instance - 1]);
+        }
+        printf("%lu map changes, %lu rejected\n",
+               (unsigned long)stats.changes, (unsigned long)stats.rejected);
+        return;
+    }
+
+    console_request.p_slot = beacon_console_slot(argv[1]);
+    if ((NULL == console_request.p_slot) ||
+        ((0 != strcmp(argv[2], "off")) &&
+         !beacon_console_number(argv[2], BEACON_CHMAP_CHANNELS, &min_channels)))
+    {
+        return;
+    }
+
+    console_request.min_channels = (uint8_t)min_channels;
+    console_request.op           = CONSOLE_OP_CHMAP;
+    beacon_console_submit();
+}
+#endif
+
+#if BEACON_HEALTH_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_health
+*********************************************************************************
+* Summary:
+*   health command
+*
+*********************************************************************************/
+static void beacon_console_health(uint8_t argc, char *argv[])
+{
+    static const char *const state_names[] = { "ok", "recovering", "escalated" };
+    beacon_health_stats_t stats;
+
+    if ((argc > 1) && (0 == strcmp(argv[1], "reset")))
+    {
+        beacon_health_reset();
+        return;
+    }
+
+    for (uint8_t instance = 1; instance <= BEACON_SLOT_MAX_INSTANCES; instance++)
+    {
+        beacon_health_get(instance, &stats);
+        printf("Instance %u: %s, %lu faults, %lu recovered in %lu ms mean %lu ms max\n",
+               instance, state_names[stats.state], (unsigned long)stats.faults,
+               (unsigned long)stats.recoveries,
+               (unsigned long)((0 != stats.recoveries) ?
+                               stats.recover_total_ms / stats.recoveries : 0),
+               (unsigned long)stats.recover_max_ms);
+        printf("  %lu retries, %lu fallbacks, %lu escalations\n",
+               (unsigned long)stats.retries, (unsigned long)stats.fallbacks,
+               (unsigned long)stats.escalations);
+    }
+}
+#endif
+
+#if BEACON_CCM_ENABLE
+/********************************************************************************
+* Function Name: beacon_console_ccm
+*********************************************************************************
+* Summary:
+*   ccm command
+*
+*********************************************************************************/
+static void beacon_console_ccm(uint8_t argc, char *argv[])
+{
+    beacon_ccm_rate_t rate;
+    uint32_t plain_len = 4;
+
+    if ((argc > 1) && !beacon_console_number(argv[1], BEACON_CCM_PLAIN_MAX, &plain_len))
+    {
+        return;
+    }
+
+    beacon_ccm_measure((uint8_t)plain_len, &rate);
+    printf("Frames of %lu octets per second: seal %lu, prepare %lu, sealed ahead %lu, open %lu\n",
+           (unsigned long)plain_len, (unsigned long)rate.seal, (unsigned long)rate.prepare,
+           (unsigned long)rate.finish, (unsigned long)rate.open);
+}
+#endif
+
+/********************************************************************************
+* Function Name: beacon_console_execute
+*********************************************************************************
+* Summary:
+*   Splits a command line into words in place and runs the command. Runs in
+*   the console task.
+*
+* Parameters:
+*   line:                   NUL terminated command line, modified
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_console_execute(char *line)
+{
+    char *argv[BEACON_CONSOLE_MAX_ARGS];
+    uint8_t argc = 0;
+    char *p = line;
+
+    while ('\0' != *p)
+    {
+        while (' ' == *p)
+        {
+            *p++ = '\0';
+        }
+        if ('\0' == *p)
+        {
+            break;
+        }
+        if (BEACON_CONSOLE_MAX_ARGS == argc)
+        {
+            printf("Too many arguments\n");
+            return;
+        }
+        argv[argc++] = p;
+        while (('\0' != *p) && (' ' != *p))
+        {
+            p++;
+        }
+    }
+
+    if (0 == argc)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < (sizeof(console_cmds) / sizeof(console_cmds[0])); i++)
+    {
+        if (0 == strcmp(argv[0], console_cmds[i].name))
+        {
+            if (argc < console_cmds[i].min_args)
+            {
+                printf("Usage: %s %s\n", console_cmds[i].name, console_cmds[i].args);
+            }
+            else
+            {
+                console_cmds[i].p_handler(argc, argv);
+            }
+            return;
+        }
+    }
+    printf("Unknown command %s, try help\n", argv[0]);
+}
+
+/********************************************************************************
+* Function Name: beacon_console_input
+*********************************************************************************
+* Summary:
+*   Line editing. Characters are echoed, backspace removes the last one, and
+*   the line is executed on carriage return or line feed.
+*
+* Parameters:
+*   c:                      Received character
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_console_input(char c)
+{
+    if (('\r' == c) || ('\n' == c))
+    {
+        printf("\n");
+        if (console_line_overflow)
+        {
+            printf("Line too long\n");
+        }
+        else if (0 != console_line_len)
+        {
+            console_line[console_line_len] = '\0';
+            beacon_console_execute(console_line);
+        }
+        console_line_len      = 0;
+        console_line_overflow = WICED_FALSE;
+        if (!console_prov)
+        {
+            printf(CONSOLE_PROMPT);
+        }
+    }
+    else if (('\b' == c) || (0x7F == c))
+    {
+        if (0 != console_line_len)
+        {
+            console_line_len--;
+            printf("\b \b");
+        }
+    }
+    else if ((c >= ' ') && (c <= '~'))
+    {
+        if (console_line_len < (BEACON_CONSOLE_LINE_MAX - 1))
+        {
+            console_line[console_line_len++] = c;
+            printf("%c", c);
+        }
+        else
+        {
+            console_line_overflow = WICED_TRUE;
+        }
+    }
+    fflush(stdout);
+}
+
+/********************************************************************************
+* Function Name: beacon_console_uart_isr
+*********************************************************************************
+* Summary:
+*   UART event callback, runs in the interrupt. Received characters are moved
+*   to the ring and the console task is notified.
+*
+*********************************************************************************/
+static void beacon_console_uart_isr(void *callback_arg, cyhal_uart_event_t event)
+{
+    BaseType_t woken = pdFALSE;
+    uint8_t c;
+
+    (void)callback_arg;
+
+    if (0 == (event & CYHAL_UART_IRQ_RX_NOT_EMPTY))
+    {
+        return;
+    }
+
+    while ((0 != cyhal_uart_readable(&cy_retarget_io_uart_obj)) &&
+           (CY_RSLT_SUCCESS == cyhal_uart_getc(&cy_retarget_io_uart_obj, &c, 0)))
+    {
+        if ((console_rx_head - console_rx_tail) < BEACON_CONSOLE_RX_SIZE)
+        {
+            console_rx[console_rx_head & CONSOLE_RX_MASK] = c;
+            console_rx_head++;
+        }
+        else
+        {
+            console_rx_dropped++;
+        }
+    }
+
+    vTaskNotifyGiveFromISR(console_task_handle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/********************************************************************************
+* Function Name: beacon_console_task
+*********************************************************************************
+* Summary:
+*   Feeds the received characters to the line editor, or to the provisioning
+*   receiver during a session
+*
+*********************************************************************************/
+static void beacon_console_task(void *arg)
+{
+    TickType_t wait = portMAX_DELAY;
+    uint8_t c;
+
+    (void)arg;
+
+    printf(CONSOLE_PROMPT);
+    fflush(stdout);
+
+    for (;;)
+    {
+        if ((0 == ulTaskNotifyTake(pdTRUE, wait)) && console_prov)
+        {
+            /* The sender went silent */
+            beacon_prov_end();
+            console_prov = WICED_FALSE;
+            wait         = portMAX_DELAY;
+            printf("\nProvisioning ended\n" CONSOLE_PROMPT);
+            fflush(stdout);
+            continue;
+        }
+
+        while (console_rx_tail != console_rx_head)
+        {
+            c = console_rx[console_rx_tail & CONSOLE_RX_MASK];
+            console_rx_tail++;
+
+            if (console_prov)
+            {
+                beacon_prov_input(c);
+            }
+            else
+            {
+                beacon_console_input((char)c);
+            }
+        }
+
+        if (console_prov)
+        {
+            wait = pdMS_TO_TICKS(beacon_prov_idle());
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_console_init
+*********************************************************************************
+* Summary:
+*   Creates the console task and enables the UART receive interrupt. Call
+*   after cy_retarget_io_init and beacon_manager_init.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_console_init(void)
+{
+    if (NULL != console_task_handle)
+    {
+        return;
+    }
+
+    console_done = xSemaphoreCreateBinaryStatic(&console_done_buffer);
+    console_task_handle = xTaskCreateStatic(beacon_console_task, "Console",
+                                            BEACON_CONSOLE_TASK_STACK_SIZE, NULL,
+                                            BEACON_CONSOLE_TASK_PRIORITY,
+                                            console_task_stack, &console_task_tcb);
+
+    cyhal_uart_register_callback(&cy_retarget_io_uart_obj, beacon_console_uart_isr, NULL);
+    cyhal_uart_enable_event(&cy_retarget_io_uart_obj, CYHAL_UART_IRQ_RX_NOT_EMPTY,
+                            CYHAL_ISR_PRIORITY_DEFAULT, true);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,93 @@
+/******************************************************************************
+* File Name: beacon_console.h
+*
+* Description: This file contains the definitions for the command console on
+* the debug UART. The console inspects and reconfigures the advertising
+* slots at runtime.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_CONSOLE_H__
+#define __BEACON_CONSOLE_H__
+
+#include <stdint.h>
+#include "beacon_prov.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 0 to leave the UART receive side unused */
+#ifndef BEACON_CONSOLE_ENABLE
+#define BEACON_CONSOLE_ENABLE            (1)
+#endif
+
+/* Longest command line, longer lines are discarded */
+#define BEACON_CONSOLE_LINE_MAX          (96)
+
+/* Maximum number of words in a command line */
+#define BEACON_CONSOLE_MAX_ARGS          (6)
+
+#if BEACON_PROV_ENABLE && !BEACON_CONSOLE_ENABLE
+#error "BEACON_PROV_ENABLE requires BEACON_CONSOLE_ENABLE"
+#endif
+
+/* Received characters buffered between the UART interrupt and the task,
+ * must be a power of two. Provisioning needs room for a full window. */
+#if BEACON_PROV_ENABLE
+#define BEACON_CONSOLE_RX_SIZE           (512)
+#else
+#define BEACON_CONSOLE_RX_SIZE           (64)
+#endif
+
+/* Console task configuration, the lowest application priority */
+#define BEACON_CONSOLE_TASK_STACK_SIZE   (768)
+#define BEACON_CONSOLE_TASK_PRIORITY     (1)
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void beacon_console_init    (void);
+
+void beacon_console_input   (char c);
+
+void beacon_console_execute (char *line);
+
+#endif      /* __BEACON_CONSOLE_H__ */
+
+
+/* [] END OF FILE */
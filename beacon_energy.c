@@ -0,0 +1,341 @@
+/******************************************************************************
+* File Name: beacon_energy.c
+*
+* Description: This is the source code for the energy model. The controller
+* does not report advertising events to the host, so the estimator counts
+* them from the time each instance advertised with its parameters, which
+* are sampled at every multi-advertising response.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "beacon_energy.h"
+#include "beacon_power.h"
+#include "beacon_stats.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Advertising interval unit */
+#define ENERGY_US_PER_INTERVAL           (625)
+
+/* Channels used when the channel map is empty */
+#define ENERGY_DEFAULT_CHANNELS          (3)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Estimator state of an instance */
+typedef struct
+{
+    wiced_bool_t advertising;                   /* Advertising since last_ms */
+    uint32_t event_nc;                          /* Charge per event meanwhile */
+    uint32_t period_us;                         /* Mean event period meanwhile */
+    uint32_t last_ms;                           /* Time integrated up to */
+    uint64_t events_milli;                      /* Events counted, in thousandths */
+    uint64_t adv_nc;                            /* Charge of the events counted */
+}energy_slot_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Transmit current of every Tx power index, in uA, sample values to be
+ * measured together with power_cal in beacon_power.c */
+static const uint16_t energy_tx_ua[BEACON_POWER_LEVELS] =
+{
+    4100, 4700, 5400, 6600, 8200
+};
+
+static energy_slot_t energy_slots[BEACON_SLOT_MAX_INSTANCES];
+static uint32_t      energy_start_ms;
+static uint32_t      energy_start_wakeups;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_energy_integrate
+*********************************************************************************
+* Summary:
+*   Counts the events of an instance up to now_ms. Call with interrupts
+*   disabled.
+*
+*********************************************************************************/
+static void beacon_energy_integrate(energy_slot_t *p_state, uint32_t now_ms)
+{
+    uint64_t events_milli;
+
+    if (p_state->advertising && (0 != p_state->period_us))
+    {
+        events_milli = ((uint64_t)(now_ms - p_state->last_ms) * 1000000ULL) / p_state->period_us;
+        p_state->events_milli += events_milli;
+        p_state->adv_nc       += (events_milli * p_state->event_nc) / 1000;
+    }
+    p_state->last_ms = now_ms;
+}
+
+/********************************************************************************
+* Function Name: beacon_energy_wakeups
+*********************************************************************************
+* Summary:
+*   Returns the worker wakeups since the counters started
+*
+*********************************************************************************/
+static uint32_t beacon_energy_wakeups(void)
+{
+    const beacon_worker_stats_t *p_stats = beacon_worker_get_stats();
+
+    return p_stats->wakeups + p_stats->kicks;
+}
+
+/********************************************************************************
+* Function Name: beacon_energy_event_nc
+*********************************************************************************
+* Summary:
+*   Returns the charge of one advertising event: the wakeup, one packet on
+*   every channel of the map, the hops between the channels and, unless the
+*   instance is non-connectable, a scan request window after each packet
+*
+* Parameters:
+*   p_params:               Advertising parameters of the instance
+*   adv_len:                Length of the advertisement data
+*
+* Return:
+*   Charge in nC
+*
+*********************************************************************************/
+uint32_t beacon_energy_event_nc(const wiced_bt_ble_multi_adv_params_t *p_params, uint8_t adv_len)
+{
+    uint32_t channels = 0;
+    uint32_t air_us = (BEACON_ENERGY_AIR_OVERHEAD + adv_len) * BEACON_ENERGY_US_PER_BYTE;
+    uint32_t tx_ua = energy_tx_ua[BEACON_POWER_LEVELS - 1];
+    uint64_t pc;
+
+    for (uint8_t map = p_params->channel_map & 0x07; 0 != map; map >>= 1)
+    {
+        channels += map & 1;
+    }
+    if (0 == channels)
+    {
+        channels = ENERGY_DEFAULT_CHANNELS;
+    }
+
+    if ((p_params->adv_tx_power >= MULTI_ADV_TX_POWER_MIN_INDEX) &&
+        (p_params->adv_tx_power <= MULTI_ADV_TX_POWER_MAX_INDEX))
+    {
+        tx_ua = energy_tx_ua[p_params->adv_tx_power - MULTI_ADV_TX_POWER_MIN_INDEX];
+    }
+
+    pc = (uint64_t)BEACON_ENERGY_EVENT_US * BEACON_ENERGY_EVENT_UA +
+         (uint64_t)channels * air_us * tx_ua +
+         (uint64_t)(channels - 1) * BEACON_ENERGY_CHANNEL_GAP_US * BEACON_ENERGY_EVENT_UA;
+
+    if (MULTI_ADVERT_NONCONNECTABLE_EVENT != p_params->adv_type)
+    {
+        pc += (uint64_t)channels * BEACON_ENERGY_LISTEN_US * BEACON_ENERGY_RX_UA;
+    }
+
+    return (uint32_t)(pc / 1000);
+}
+
+/********************************************************************************
+* Function Name: beacon_energy_period_us
+*********************************************************************************
+* Summary:
+*   Returns the mean time between advertising events. The controller
+*   advertises at the minimum interval of the range, plus the random
+*   advDelay of every event.
+*
+* Parameters:
+*   p_params:               Advertising parameters of the instance
+*
+* Return:
+*   Mean event period in microseconds
+*
+*********************************************************************************/
+uint32_t beacon_energy_period_us(const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    return ((uint32_t)p_params->adv_int_min * ENERGY_US_PER_INTERVAL) + BEACON_ENERGY_ADV_DELAY_US;
+}
+
+/********************************************************************************
+* Function Name: beacon_energy_adv_na
+*********************************************************************************
+* Summary:
+*   Returns the average current of an advertising instance
+*
+* Parameters:
+*   p_params:               Advertising parameters of the instance
+*   adv_len:                Length of the advertisement data
+*
+* Return:
+*   Average current in nA, without the sleep current
+*
+*********************************************************************************/
+uint32_t beacon_energy_adv_na(const wiced_bt_ble_multi_adv_params_t *p_params, uint8_t adv_len)
+{
+    return (uint32_t)(((uint64_t)beacon_energy_event_nc(p_params, adv_len) * 1000000ULL) /
+                      beacon_energy_period_us(p_params));
+}
+
+/********************************************************************************
+* Function Name: beacon_energy_life_hours
+*********************************************************************************
+* Summary:
+*   Returns the battery life at an average current
+*
+* Parameters:
+*   average_na:             Average current in nA
+*
+* Return:
+*   Lifetime in hours with a BEACON_ENERGY_BATTERY_MAH battery
+*
+*********************************************************************************/
+uint32_t beacon_energy_life_hours(uint32_t average_na)
+{
+    if (0 == average_na)
+    {
+        return 0xFFFFFFFFUL;
+    }
+    return (uint32_t)(((uint64_t)BEACON_ENERGY_BATTERY_MAH * 1000000ULL) / average_na);
+}
+
+/********************************************************************************
+* Function Name: beacon_energy_start
+*********************************************************************************
+* Summary:
+*   Restarts the estimate with the current state of every instance
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_energy_start(void)
+{
+    uint32_t now_ms = beacon_stats_now_ms();
+
+    taskENTER_CRITICAL();
+    memset(energy_slots, 0, sizeof(energy_slots));
+    energy_start_ms      = now_ms;
+    energy_start_wakeups = beacon_energy_wakeups();
+    taskEXIT_CRITICAL();
+
+    for (uint8_t instance = 1; instance <= BEACON_SLOT_MAX_INSTANCES; instance++)
+    {
+        beacon_energy_on_slot(beacon_slot_get(instance));
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_energy_on_slot
+*********************************************************************************
+* Summary:
+*   Counts the events of an instance with its previous state, then samples
+*   the new state. Called by the slot layer after every response.
+*
+* Parameters:
+*   p_slot:                 Slot that changed
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_energy_on_slot(const beacon_slot_t *p_slot)
+{
+    energy_slot_t *p_state = &energy_slots[p_slot->instance - 1];
+    uint32_t now_ms = beacon_stats_now_ms();
+
+    taskENTER_CRITICAL();
+    beacon_energy_integrate(p_state, now_ms);
+    p_state->advertising = p_slot->advertising;
+    p_state->event_nc    = beacon_energy_event_nc(&p_slot->params, p_slot->adv_len);
+    p_state->period_us   = beacon_energy_period_us(&p_slot->params);
+    taskEXIT_CRITICAL();
+}
+
+/********************************************************************************
+* Function Name: beacon_energy_get
+*********************************************************************************
+* Summary:
+*   Returns the estimate since beacon_energy_start. The sleep current is
+*   counted for the whole time.
+*
+* Parameters:
+*   p_report:               Estimate
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_energy_get(beacon_energy_report_t *p_report)
+{
+    uint32_t now_ms = beacon_stats_now_ms();
+    uint32_t wakeups = beacon_energy_wakeups();
+
+    memset(p_report, 0, sizeof(*p_report));
+
+    taskENTER_CRITICAL();
+    p_report->elapsed_ms = now_ms - energy_start_ms;
+    p_report->wakeups    = wakeups - energy_start_wakeups;
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        beacon_energy_integrate(&energy_slots[i], now_ms);
+        p_report->adv_events[i] = (uint32_t)(energy_slots[i].events_milli / 1000);
+        p_report->adv_nc       += energy_slots[i].adv_nc;
+    }
+    taskEXIT_CRITICAL();
+
+    p_report->total_nc = p_report->adv_nc +
+                         ((uint64_t)BEACON_ENERGY_SLEEP_NA * p_report->elapsed_ms) / 1000 +
+                         ((uint64_t)p_report->wakeups * BEACON_ENERGY_WAKEUP_US *
+                          BEACON_ENERGY_CPU_UA) / 1000;
+
+    if (0 != p_report->elapsed_ms)
+    {
+        p_report->average_na = (uint32_t)((p_report->total_nc * 1000) / p_report->elapsed_ms);
+    }
+    p_report->life_hours = beacon_energy_life_hours(p_report->average_na);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,118 @@
+/******************************************************************************
+* File Name: beacon_energy.h
+*
+* Description: This file contains the definitions for the energy model. The
+* model gives the charge of an advertising event from the parameters and
+* payload length of an instance, and an estimator integrates it over the
+* time each instance advertised to project the battery life.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_ENERGY_H__
+#define __BEACON_ENERGY_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to estimate the charge drawn at runtime, see the energy command */
+#ifndef BEACON_ENERGY_ENABLE
+#define BEACON_ENERGY_ENABLE             (0)
+#endif
+
+/* Battery capacity for the projected lifetime, 230 mAh for a CR2032 */
+#ifndef BEACON_ENERGY_BATTERY_MAH
+#define BEACON_ENERGY_BATTERY_MAH        (230)
+#endif
+
+/* Model parameters. These are sample values: measure the board with a power
+ * analyzer and replace them, scripts/beacon_energy.py reads them from here. */
+#define BEACON_ENERGY_SLEEP_NA           (8000)     /* Deep sleep, radio idle */
+#define BEACON_ENERGY_EVENT_US           (350)      /* Wakeup and radio ramp per event */
+#define BEACON_ENERGY_EVENT_UA           (2500)     /* Current meanwhile and between channels */
+#define BEACON_ENERGY_CHANNEL_GAP_US     (150)      /* Hop to the next channel */
+#define BEACON_ENERGY_RX_UA              (5700)     /* Receive current */
+#define BEACON_ENERGY_LISTEN_US          (330)      /* Scan request window per channel */
+#define BEACON_ENERGY_AIR_OVERHEAD       (16)       /* Preamble, access address, header,
+                                                       AdvA and CRC bytes */
+#define BEACON_ENERGY_US_PER_BYTE        (8)        /* LE 1M PHY */
+#define BEACON_ENERGY_ADV_DELAY_US       (5000)     /* Mean of the 0-10 ms advDelay */
+#define BEACON_ENERGY_WAKEUP_US          (1000)     /* CPU wakeup of a worker job */
+#define BEACON_ENERGY_CPU_UA             (2800)     /* CPU active current */
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Runtime estimate since beacon_energy_start */
+typedef struct
+{
+    uint32_t elapsed_ms;                        /* Time covered */
+    uint32_t adv_events[BEACON_SLOT_MAX_INSTANCES]; /* Advertising events per instance */
+    uint32_t wakeups;                           /* Worker wakeups */
+    uint64_t adv_nc;                            /* Charge of the advertising events */
+    uint64_t total_nc;                          /* Charge including sleep and wakeups */
+    uint32_t average_na;                        /* Average current */
+    uint32_t life_hours;                        /* Projected battery life from start */
+}beacon_energy_report_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+uint32_t beacon_energy_event_nc   (const wiced_bt_ble_multi_adv_params_t *p_params,
+                                   uint8_t adv_len);
+
+uint32_t beacon_energy_period_us  (const wiced_bt_ble_multi_adv_params_t *p_params);
+
+uint32_t beacon_energy_adv_na     (const wiced_bt_ble_multi_adv_params_t *p_params,
+                                   uint8_t adv_len);
+
+uint32_t beacon_energy_life_hours (uint32_t average_na);
+
+void     beacon_energy_start      (void);
+
+void     beacon_energy_on_slot    (const beacon_slot_t *p_slot);
+
+void     beacon_energy_get        (beacon_energy_report_t *p_report);
+
+#endif      /* __BEACON_ENERGY_H__ */
+
+
+/* [] END OF FILE */
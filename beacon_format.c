@@ -0,0 +1,610 @@
+/******************************************************************************
+* File Name: beacon_format.c
+*
+* Description: This is the source code for the beacon format registry. Every
+* format is encoded by the same path: the template is copied and each field
+* is patched in at its offset. Adding a format only takes a descriptor.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "wiced_bt_stack.h"
+#include "beacon_format.h"
+#include "beacon_manager.h"
+#include "beacon_payload.h"
+#include "beacon_power.h"
+#include "beacon_stats.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Flags element common to all formats */
+#define FORMAT_FLAGS                     ADV_PKT_FLAG_LENGTH, BTM_BLE_ADVERT_TYPE_FLAG, \
+                                         (BTM_BLE_GENERAL_DISCOVERABLE_FLAG | \
+                                          BTM_BLE_BREDR_NOT_SUPPORTED)
+
+/* AltBeacon, https://github.com/AltBeacon/spec */
+#define ALTBEACON_AD_LENGTH              (0x1B)
+#define ALTBEACON_CODE                   (0xBE), (0xAC)
+#define ALTBEACON_ID_LEN                 (20)
+
+/* Device status frame, our manufacturer specific format */
+#define STATUS_AD_LENGTH                 (0x0F)
+#define STATUS_COMPANY_ID                (0x31), (0x01)
+#define STATUS_FRAME_ID                  (0x5A)
+#define STATUS_FIELD_UPTIME              (3)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Format bound to an advertising slot */
+typedef struct
+{
+    const beacon_format_desc_t *p_desc;         /* Bound format, NULL if none */
+    beacon_format_value_t values[BEACON_FORMAT_MAX_FIELDS];
+    uint32_t generation;                        /* Changed by every bind, 0 if never bound */
+    beacon_payload_t payload;                   /* Tagged with the generation */
+}format_binding_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+#if BEACON_STATUS_FRAME_ENABLE
+static wiced_bool_t beacon_format_status_tick (beacon_format_value_t *values, uint32_t now_ms);
+#endif
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+#if BEACON_IBEACON_ENABLE
+/* iBeacon, the same advertisement as ibeacon_set_adv_data */
+static const uint8_t format_ibeacon_template[] =
+{
+    FORMAT_FLAGS,
+    IBEACON_ADV_PKT_LENGTH, BTM_BLE_ADVERT_TYPE_MANUFACTURER,
+    IBEACON_COMPANY_ID_APPLE, IBEACON_PROXIMITY,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,     /* UUID */
+    0, 0,                                               /* Major */
+    0, 0,                                               /* Minor */
+    0                                                   /* Measured power */
+};
+
+static const beacon_format_field_t format_ibeacon_fields[] =
+{
+    { "uuid",  9,  LEN_UUID_128, BEACON_FIELD_BYTES, 0,    0      },
+    { "major", 25, 2,            BEACON_FIELD_LE,    0,    0xFFFF },
+    { "minor", 27, 2,            BEACON_FIELD_LE,    0,    0xFFFF },
+    { "power", 29, 1,            BEACON_FIELD_LE,    -127, 20     },
+};
+
+static const uint8_t format_ibeacon_uuid[LEN_UUID_128] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static const beacon_format_value_t format_ibeacon_defaults[] =
+{
+    { .p_bytes = format_ibeacon_uuid },
+    { .num = IBEACON_MAJOR_NUMER },
+    { .num = IBEACON_MINOR_NUMER },
+    { .num = (int8_t)TX_POWER_LEVEL },
+};
+
+static const beacon_format_desc_t format_ibeacon =
+{
+    .name         = "ibeacon",
+    .p_template   = format_ibeacon_template,
+    .template_len = sizeof(format_ibeacon_template),
+    .num_fields   = sizeof(format_ibeacon_fields) / sizeof(format_ibeacon_fields[0]),
+    .p_fields     = format_ibeacon_fields,
+    .p_defaults   = format_ibeacon_defaults,
+    .p_tick       = NULL
+};
+#endif
+
+#if BEACON_ALTBEACON_ENABLE
+/* AltBeacon */
+static const uint8_t format_altbeacon_template[] =
+{
+    FORMAT_FLAGS,
+    ALTBEACON_AD_LENGTH, BTM_BLE_ADVERT_TYPE_MANUFACTURER,
+    0, 0,                                               /* Manufacturer ID */
+    ALTBEACON_CODE,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,     /* Beacon ID */
+    0,                                                  /* Reference RSSI */
+    0                                                   /* Manufacturer reserved */
+};
+
+static const beacon_format_field_t format_altbeacon_fields[] =
+{
+    { "mfg",      5,  2,                BEACON_FIELD_LE,    0,    0xFFFF },
+    { "id",       9,  ALTBEACON_ID_LEN, BEACON_FIELD_BYTES, 0,    0      },
+    { "rssi",     29, 1,                BEACON_FIELD_LE,    -127, 0      },
+    { "reserved", 30, 1,                BEACON_FIELD_LE,    0,    0xFF   },
+};
+
+static const uint8_t format_altbeacon_id[ALTBEACON_ID_LEN] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+    0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x00, 0x01, 0x00, 0x02
+};
+
+static const beacon_format_value_t format_altbeacon_defaults[] =
+{
+    { .num = 0x0131 },
+    { .p_bytes = format_altbeacon_id },
+    { .num = -59 },
+    { .num = 0 },
+};
+
+static const beacon_format_desc_t format_altbeacon =
+{
+    .name         = "altbeacon",
+    .p_template   = format_altbeacon_template,
+    .template_len = sizeof(format_altbeacon_template),
+    .num_fields   = sizeof(format_altbeacon_fields) / sizeof(format_altbeacon_fields[0]),
+    .p_fields     = format_altbeacon_fields,
+    .p_defaults   = format_altbeacon_defaults,
+    .p_tick       = NULL
+};
+#endif
+
+#if BEACON_STATUS_FRAME_ENABLE
+/* Device status: device ID, battery, temperature and uptime */
+static const uint8_t format_status_template[] =
+{
+    FORMAT_FLAGS,
+    STATUS_AD_LENGTH, BTM_BLE_ADVERT_TYPE_MANUFACTURER,
+    STATUS_COMPANY_ID,
+    STATUS_FRAME_ID,
+    0, 0, 0, 0,                                         /* Device ID */
+    0,                                                  /* Battery, percent */
+    0, 0,                                               /* Temperature, 0.01 degree C */
+    0, 0, 0, 0                                          /* Uptime, seconds */
+};
+
+static const beacon_format_field_t format_status_fields[] =
+{
+    { "device",  8,  4, BEACON_FIELD_BE, 0,     INT32_MAX },
+    { "battery", 12, 1, BEACON_FIELD_LE, 0,     100       },
+    { "temp",    13, 2, BEACON_FIELD_LE, -4000, 12500     },
+    { "uptime",  15, 4, BEACON_FIELD_LE, 0,     INT32_MAX },
+};
+
+static const beacon_format_value_t format_status_defaults[] =
+{
+    { .num = 1 },
+    { .num = 100 },
+    { .num = 2150 },
+    { .num = 0 },
+};
+
+static const beacon_format_desc_t format_status =
+{
+    .name         = "status",
+    .p_template   = format_status_template,
+    .template_len = sizeof(format_status_template),
+    .num_fields   = sizeof(format_status_fields) / sizeof(format_status_fields[0]),
+    .p_fields     = format_status_fields,
+    .p_defaults   = format_status_defaults,
+    .p_tick       = beacon_format_status_tick
+};
+#endif
+
+/* Registered formats, a format switched off is not linked. The NULL entry
+ * keeps the table valid with every format switched off. */
+static const beacon_format_desc_t *const format_registry[] =
+{
+#if BEACON_IBEACON_ENABLE
+    &format_ibeacon,
+#endif
+#if BEACON_ALTBEACON_ENABLE
+    &format_altbeacon,
+#endif
+#if BEACON_STATUS_FRAME_ENABLE
+    &format_status,
+#endif
+    NULL
+};
+
+static format_binding_t             format_bindings[BEACON_SLOT_MAX_INSTANCES];
+static wiced_bool_t                 format_tick_registered;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+#if BEACON_STATUS_FRAME_ENABLE
+/********************************************************************************
+* Function Name: beacon_format_status_tick
+*********************************************************************************
+* Summary:
+*   Updater of the device status frame, refreshes the uptime
+*
+*********************************************************************************/
+static wiced_bool_t beacon_format_status_tick(beacon_format_value_t *values, uint32_t now_ms)
+{
+    int32_t uptime = (int32_t)(now_ms / 1000);
+
+    if (values[STATUS_FIELD_UPTIME].num == uptime)
+    {
+        return WICED_FALSE;
+    }
+    values[STATUS_FIELD_UPTIME].num = uptime;
+    return WICED_TRUE;
+}
+#endif
+
+/********************************************************************************
+* Function Name: beacon_format_count
+*********************************************************************************
+* Summary:
+*   Returns the number of registered formats
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Number of formats
+*
+*********************************************************************************/
+uint8_t beacon_format_count(void)
+{
+    return (sizeof(format_registry) / sizeof(format_registry[0])) - 1;
+}
+
+/********************************************************************************
+* Function Name: beacon_format_get
+*********************************************************************************
+* Summary:
+*   Returns a registered format
+*
+* Parameters:
+*   index:                  Index of the format
+*
+* Return:
+*   Pointer to the descriptor or NULL if the index is out of range
+*
+*********************************************************************************/
+const beacon_format_desc_t *beacon_format_get(uint8_t index)
+{
+    return (index < beacon_format_count()) ? format_registry[index] : NULL;
+}
+
+/********************************************************************************
+* Function Name: beacon_format_find
+*********************************************************************************
+* Summary:
+*   Looks up a registered format by name
+*
+* Parameters:
+*   name:                   Format name
+*
+* Return:
+*   Pointer to the descriptor or NULL if there is no such format
+*
+*********************************************************************************/
+const beacon_format_desc_t *beacon_format_find(const char *name)
+{
+    for (uint8_t i = 0; i < beacon_format_count(); i++)
+    {
+        if (0 == strcmp(format_registry[i]->name, name))
+        {
+            return format_registry[i];
+        }
+    }
+    return NULL;
+}
+
+/********************************************************************************
+* Function Name: beacon_format_validate
+*********************************************************************************
+* Summary:
+*   Checks the values against the bounds of their fields
+*
+* Parameters:
+*   p_desc:                 Format
+*   values:                 One value per field
+*
+* Return:
+*   WICED_TRUE if every value is valid
+*
+*********************************************************************************/
+wiced_bool_t beacon_format_validate(const beacon_format_desc_t *p_desc,
+                                    const beacon_format_value_t *values)
+{
+    const beacon_format_field_t *p_field;
+
+    for (uint8_t i = 0; i < p_desc->num_fields; i++)
+    {
+        p_field = &p_desc->p_fields[i];
+
+        if (BEACON_FIELD_BYTES == p_field->type)
+        {
+            if (NULL == values[i].p_bytes)
+            {
+                return WICED_FALSE;
+            }
+        }
+        else if ((values[i].num < p_field->min) || (values[i].num > p_field->max))
+        {
+            return WICED_FALSE;
+        }
+    }
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_format_encode
+*********************************************************************************
+* Summary:
+*   Encodes an advertisement of any registered format. The template is
+*   copied and each field is written at its offset; numbers are stored
+*   byte by byte, walking backwards for big endian fields.
+*
+* Parameters:
+*   p_desc:                 Format
+*   values:                 One value per field
+*   adv_data:               Output data buffer
+*   adv_len:                Length of output data
+*
+* Return:
+*   wiced_result_t: WICED_BT_BADARG if a value is out of bounds
+*
+*********************************************************************************/
+wiced_result_t beacon_format_encode(const beacon_format_desc_t *p_desc,
+                                    const beacon_format_value_t *values,
+                                    uint8_t adv_data[BEACON_ADV_DATA_MAX], uint8_t *adv_len)
+{
+    const beacon_format_field_t *p_field;
+    uint8_t *p_out;
+    uint32_t value;
+    int8_t step;
+
+    if (!beacon_format_validate(p_desc, values))
+    {
+        return WICED_BT_BADARG;
+    }
+
+    memcpy(adv_data, p_desc->p_template, p_desc->template_len);
+
+    for (uint8_t i = 0; i < p_desc->num_fields; i++)
+    {
+        p_field = &p_desc->p_fields[i];
+        p_out   = &adv_data[p_field->offset];
+
+        if (BEACON_FIELD_BYTES == p_field->type)
+        {
+            memcpy(p_out, values[i].p_bytes, p_field->size);
+            continue;
+        }
+
+        value = (uint32_t)values[i].num;
+        step  = 1;
+        if (BEACON_FIELD_BE == p_field->type)
+        {
+            p_out += p_field->size - 1;
+            step   = -1;
+        }
+        for (uint8_t b = 0; b < p_field->size; b++)
+        {
+            *p_out = (uint8_t)value;
+            value >>= 8;
+            p_out  += step;
+        }
+    }
+
+    *adv_len = p_desc->template_len;
+    return WICED_BT_SUCCESS;
+}
+
+/********************************************************************************
+* Function Name: beacon_format_submit
+*********************************************************************************
+* Summary:
+*   Issues the updated advertisements of the bound formats, deferred to the
+*   beacon manager task
+*
+*********************************************************************************/
+static void beacon_format_submit(void)
+{
+    format_binding_t *p_binding;
+    const beacon_payload_buf_t *p_adv;
+    beacon_slot_t *p_slot;
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        p_binding = &format_bindings[i];
+
+        if (0 == p_binding->generation)
+        {
+            continue;
+        }
+
+        /* Advertisements encoded before the last bind are dropped */
+        p_adv = beacon_payload_take(&p_binding->payload);
+        if ((NULL != p_adv) && (p_adv->tag == p_binding->generation))
+        {
+            /* The measured power follows the Tx power of a managed slot */
+            p_slot = beacon_slot_get(i + 1);
+            memcpy(adv_data, p_adv->data, p_adv->len);
+            beacon_power_fix_data(p_slot, adv_data, p_adv->len);
+            beacon_slot_set_data(p_slot, adv_data, p_adv->len);
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_format_tick_job
+*********************************************************************************
+* Summary:
+*   Worker job running the updaters of the bound formats. Only the updater
+*   runs in the critical section, the encoding goes to the payload buffer
+*   owned by the worker.
+*
+*********************************************************************************/
+static uint32_t beacon_format_tick_job(uint32_t now_ms)
+{
+    format_binding_t *p_binding;
+    const beacon_format_desc_t *p_desc;
+    beacon_format_value_t values[BEACON_FORMAT_MAX_FIELDS];
+    beacon_payload_buf_t *p_adv;
+    uint32_t generation = 0;
+    wiced_bool_t changed;
+    wiced_bool_t submit = WICED_FALSE;
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        p_binding = &format_bindings[i];
+
+        taskENTER_CRITICAL();
+        p_desc  = p_binding->p_desc;
+        changed = ((NULL != p_desc) && (NULL != p_desc->p_tick) &&
+                   p_desc->p_tick(p_binding->values, now_ms)) ? WICED_TRUE : WICED_FALSE;
+        if (changed)
+        {
+            memcpy(values, p_binding->values, p_desc->num_fields * sizeof(values[0]));
+            generation = p_binding->generation;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!changed)
+        {
+            continue;
+        }
+
+        p_adv = beacon_payload_buffer(&p_binding->payload);
+        if (WICED_BT_SUCCESS == beacon_format_encode(p_desc, values, p_adv->data, &p_adv->len))
+        {
+            p_adv->tag = generation;
+            beacon_payload_publish(&p_binding->payload, p_adv->len);
+            submit = WICED_TRUE;
+        }
+    }
+
+    if (submit)
+    {
+        beacon_manager_defer(beacon_format_submit);
+    }
+    return BEACON_FORMAT_TICK_MS;
+}
+
+/********************************************************************************
+* Function Name: beacon_format_bind
+*********************************************************************************
+* Summary:
+*   Advertises a format on a slot. Formats with an updater are re-encoded
+*   every BEACON_FORMAT_TICK_MS and issued when a value changed. Call from
+*   the beacon manager task.
+*
+* Parameters:
+*   p_slot:                 Slot
+*   p_desc:                 Format, NULL to only unbind the slot
+*   values:                 One value per field, copied
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the data was issued
+*
+*********************************************************************************/
+wiced_result_t beacon_format_bind(beacon_slot_t *p_slot, const beacon_format_desc_t *p_desc,
+                                  const beacon_format_value_t *values)
+{
+    format_binding_t *p_binding = &format_bindings[p_slot->instance - 1];
+    beacon_format_value_t bound_values[BEACON_FORMAT_MAX_FIELDS];
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint8_t adv_len;
+    wiced_result_t result;
+
+    /* The worker never used the payload of a slot that was never bound */
+    if (0 == p_binding->generation)
+    {
+        beacon_payload_init(&p_binding->payload);
+    }
+
+    taskENTER_CRITICAL();
+    p_binding->p_desc = NULL;
+    p_binding->generation++;
+    taskEXIT_CRITICAL();
+
+    if (NULL == p_desc)
+    {
+        return WICED_BT_SUCCESS;
+    }
+
+    if (p_desc->num_fields > BEACON_FORMAT_MAX_FIELDS)
+    {
+        return WICED_BT_BADARG;
+    }
+
+    memcpy(bound_values, values, p_desc->num_fields * sizeof(beacon_format_value_t));
+    if (NULL != p_desc->p_tick)
+    {
+        p_desc->p_tick(bound_values, beacon_stats_now_ms());
+    }
+
+    result = beacon_format_encode(p_desc, bound_values, adv_data, &adv_len);
+    if (WICED_BT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    beacon_power_fix_data(p_slot, adv_data, adv_len);
+    result = beacon_slot_set_data(p_slot, adv_data, adv_len);
+    if (WICED_BT_PENDING != result)
+    {
+        return result;
+    }
+
+    taskENTER_CRITICAL();
+    memcpy(p_binding->values, bound_values, p_desc->num_fields * sizeof(beacon_format_value_t));
+    p_binding->p_desc = p_desc;
+    taskEXIT_CRITICAL();
+
+    if ((NULL != p_desc->p_tick) && !format_tick_registered)
+    {
+        format_tick_registered = WICED_TRUE;
+        beacon_worker_register(beacon_format_tick_job, BEACON_FORMAT_TICK_SLACK_MS);
+    }
+    return result;
+}
+
+/* [] END OF FILE */
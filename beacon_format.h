@@ -0,0 +1,127 @@
+/******************************************************************************
+* File Name: beacon_format.h
+*
+* Description: This file contains the definitions for the beacon format
+* registry. A format is a const descriptor: a template of the advertisement,
+* the fields patched into it with their bounds, and an optional updater.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_FORMAT_H__
+#define __BEACON_FORMAT_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Maximum number of fields of a format */
+#define BEACON_FORMAT_MAX_FIELDS         (8)
+
+/* Period of the updaters of bound formats */
+#define BEACON_FORMAT_TICK_MS            (1000)
+#define BEACON_FORMAT_TICK_SLACK_MS      (500)
+
+/* Field types */
+#define BEACON_FIELD_BYTES               (0)    /* Copied from p_bytes */
+#define BEACON_FIELD_LE                  (1)    /* Number, little endian */
+#define BEACON_FIELD_BE                  (2)    /* Number, big endian */
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Value of a field */
+typedef union
+{
+    int32_t num;                                /* BEACON_FIELD_LE and _BE */
+    const uint8_t *p_bytes;                     /* BEACON_FIELD_BYTES, size bytes */
+}beacon_format_value_t;
+
+/* Field patched into the template */
+typedef struct
+{
+    const char *name;                           /* Field name */
+    uint8_t offset;                             /* Offset in the advertisement data */
+    uint8_t size;                               /* Size in bytes, 1 to 4 for numbers */
+    uint8_t type;                               /* BEACON_FIELD_* */
+    int32_t min;                                /* Bounds of numbers */
+    int32_t max;
+}beacon_format_field_t;
+
+/* Updates the values of a bound format, returns WICED_TRUE on a change */
+typedef wiced_bool_t (beacon_format_tick_t)(beacon_format_value_t *values, uint32_t now_ms);
+
+/* Format descriptor */
+typedef struct
+{
+    const char *name;                           /* Format name */
+    const uint8_t *p_template;                  /* Advertisement with fixed content */
+    uint8_t template_len;                       /* Length of the advertisement */
+    uint8_t num_fields;                         /* Entries of p_fields */
+    const beacon_format_field_t *p_fields;      /* Fields patched into the template */
+    const beacon_format_value_t *p_defaults;    /* Sample values, one per field */
+    beacon_format_tick_t *p_tick;               /* Updater, NULL if none */
+}beacon_format_desc_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+uint8_t                     beacon_format_count    (void);
+
+const beacon_format_desc_t *beacon_format_get      (uint8_t index);
+
+const beacon_format_desc_t *beacon_format_find     (const char *name);
+
+wiced_bool_t                beacon_format_validate (const beacon_format_desc_t *p_desc,
+                                                    const beacon_format_value_t *values);
+
+wiced_result_t              beacon_format_encode   (const beacon_format_desc_t *p_desc,
+                                                    const beacon_format_value_t *values,
+                                                    uint8_t adv_data[BEACON_ADV_DATA_MAX],
+                                                    uint8_t *adv_len);
+
+wiced_result_t              beacon_format_bind     (beacon_slot_t *p_slot,
+                                                    const beacon_format_desc_t *p_desc,
+                                                    const beacon_format_value_t *values);
+
+#endif      /* __BEACON_FORMAT_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,577 @@
+/******************************************************************************
+* File Name: beacon_health.c
+*
+* Description: This is the source code for the health monitor of the
+* advertising instances. The configuration requested for every instance is
+* kept, and when a command is refused or fails, or the stack restarts, it is
+* applied again with exponential backoff until the controller acknowledges
+* it, falling back to the last configuration that worked.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "beacon_health.h"
+#include "beacon_stats.h"
+#include "beacon_timer.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Parts of a configuration */
+#define HEALTH_DATA                      (0x01)
+#define HEALTH_PARAMS                    (0x02)
+#define HEALTH_ENABLE                    (0x04)
+#define HEALTH_ALL                       (HEALTH_DATA | HEALTH_PARAMS | HEALTH_ENABLE)
+#define HEALTH_PARTS                     (3)
+
+/* Backoff doublings, beyond which BEACON_HEALTH_BACKOFF_MAX_MS applies */
+#define HEALTH_BACKOFF_SHIFT_MAX         (16)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Configuration of an instance */
+typedef struct
+{
+    uint8_t parts;                              /* HEALTH_* parts ever set */
+    uint8_t adv_len;                            /* Length of adv_data */
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];      /* Advertisement data */
+    wiced_bool_t advertising;                   /* Started or stopped */
+    wiced_bt_ble_multi_adv_params_t params;     /* Advertising parameters */
+}health_config_t;
+
+/* Monitor state of an instance */
+typedef struct
+{
+    health_config_t requested;                  /* Latest configuration requested */
+    health_config_t last_good;                  /* Latest configuration acknowledged */
+    uint8_t failed;                             /* HEALTH_* parts not acknowledged */
+    uint8_t fallback;                           /* HEALTH_* parts set from last_good */
+    uint8_t pending[HEALTH_PARTS];              /* Commands issued per part */
+    wiced_bool_t retry_armed;                   /* Retry timer pending */
+    uint32_t fault_ms;                          /* Start of the current fault */
+    beacon_timer_t timer;                       /* Retry timer */
+    beacon_health_stats_t stats;                /* Counters */
+}health_instance_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static health_instance_t      health_instances[BEACON_SLOT_MAX_INSTANCES];
+static beacon_health_cback_t *health_cback;
+
+/* Set while a retry applies the last good configuration, which must not
+ * replace the requested one */
+static wiced_bool_t           health_falling_back;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_health_part
+*********************************************************************************
+* Summary:
+*   Returns the configuration part set by a multi-advertising command
+*
+*********************************************************************************/
+static uint8_t beacon_health_part(wiced_bt_multi_adv_opcodes_t opcode)
+{
+    switch (opcode)
+    {
+    case SET_ADVT_DATA_MULTI:
+        return HEALTH_DATA;
+    case SET_ADVT_PARAM_MULTI:
+        return HEALTH_PARAMS;
+    case SET_ADVT_ENABLE_MULTI:
+        return HEALTH_ENABLE;
+    default:
+        return 0;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_health_index
+*********************************************************************************
+* Summary:
+*   Returns the index of a configuration part in the pending counters
+*
+*********************************************************************************/
+static uint8_t beacon_health_index(uint8_t part)
+{
+    return (HEALTH_DATA == part) ? 0 : (HEALTH_PARAMS == part) ? 1 : 2;
+}
+
+/********************************************************************************
+* Function Name: beacon_health_record
+*********************************************************************************
+* Summary:
+*   Records a configuration part from the arguments of its command
+*
+*********************************************************************************/
+static void beacon_health_record(health_config_t *p_config, uint8_t part, const void *p_arg,
+                                 uint8_t arg)
+{
+    switch (part)
+    {
+    case HEALTH_DATA:
+        if (p_arg != p_config->adv_data)
+        {
+            memcpy(p_config->adv_data, p_arg, arg);
+        }
+        memset(&p_config->adv_data[arg], 0, BEACON_ADV_DATA_MAX - arg);
+        p_config->adv_len = arg;
+        break;
+
+    case HEALTH_PARAMS:
+        p_config->params = *(const wiced_bt_ble_multi_adv_params_t *)p_arg;
+        break;
+
+    default:
+        p_config->advertising = (MULTI_ADVERT_START == arg) ? WICED_TRUE : WICED_FALSE;
+        break;
+    }
+    p_config->parts |= part;
+}
+
+/********************************************************************************
+* Function Name: beacon_health_arm
+*********************************************************************************
+* Summary:
+*   Arms the retry of an instance after the backoff of its attempt count
+*
+*********************************************************************************/
+static void beacon_health_arm(health_instance_t *p_inst, wiced_bool_t now)
+{
+    uint8_t shift = p_inst->stats.attempts;
+    uint32_t delay_ms = BEACON_HEALTH_BACKOFF_MAX_MS;
+
+    if (shift < HEALTH_BACKOFF_SHIFT_MAX)
+    {
+        delay_ms = (uint32_t)BEACON_HEALTH_BACKOFF_MS << shift;
+        if (delay_ms > BEACON_HEALTH_BACKOFF_MAX_MS)
+        {
+            delay_ms = BEACON_HEALTH_BACKOFF_MAX_MS;
+        }
+    }
+
+    p_inst->retry_armed = WICED_TRUE;
+    beacon_timer_start(&p_inst->timer, now ? 0 : delay_ms);
+}
+
+/********************************************************************************
+* Function Name: beacon_health_fault
+*********************************************************************************
+* Summary:
+*   Marks parts of the configuration of an instance as not acknowledged and
+*   schedules a retry. The first fault of a healthy instance starts the
+*   recovery time.
+*
+*********************************************************************************/
+static void beacon_health_fault(health_instance_t *p_inst, uint8_t parts)
+{
+    p_inst->failed |= parts;
+
+    if (BEACON_HEALTH_OK == p_inst->stats.state)
+    {
+        p_inst->stats.state    = BEACON_HEALTH_RECOVERING;
+        p_inst->stats.attempts = 0;
+        p_inst->stats.faults++;
+        p_inst->fault_ms = beacon_stats_now_ms();
+    }
+
+    if (!p_inst->retry_armed)
+    {
+        beacon_health_arm(p_inst, WICED_FALSE);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_health_settle
+*********************************************************************************
+* Summary:
+*   Once every command of an instance is acknowledged and no part is failed,
+*   its configuration becomes the last good one and a fault in progress is
+*   recovered
+*
+*********************************************************************************/
+static void beacon_health_settle(health_instance_t *p_inst, const beacon_slot_t *p_slot)
+{
+    beacon_health_stats_t *p_stats = &p_inst->stats;
+    uint32_t recover_ms;
+    wiced_bool_t escalated;
+
+    if ((0 != p_slot->cmds_pending) || (0 != p_inst->failed))
+    {
+        return;
+    }
+
+    /* The controller took the last good configuration, the requested one is
+     * still owed and tried again at once */
+    if (0 != p_inst->fallback)
+    {
+        p_inst->failed   = p_inst->fallback;
+        p_inst->fallback = 0;
+        beacon_health_arm(p_inst, WICED_TRUE);
+        return;
+    }
+
+    /* Repaired before its retry */
+    if (p_inst->retry_armed)
+    {
+        beacon_timer_stop(&p_inst->timer);
+        p_inst->retry_armed = WICED_FALSE;
+    }
+
+    p_inst->last_good = p_inst->requested;
+
+    if (BEACON_HEALTH_OK != p_stats->state)
+    {
+        escalated  = (BEACON_HEALTH_ESCALATED == p_stats->state) ? WICED_TRUE : WICED_FALSE;
+        recover_ms = beacon_stats_now_ms() - p_inst->fault_ms;
+
+        p_stats->state = BEACON_HEALTH_OK;
+        p_stats->recoveries++;
+        p_stats->recover_total_ms += recover_ms;
+        if (recover_ms > p_stats->recover_max_ms)
+        {
+            p_stats->recover_max_ms = recover_ms;
+        }
+
+        if (escalated && (NULL != health_cback))
+        {
+            health_cback(p_slot->instance, p_stats);
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_health_retry
+*********************************************************************************
+* Summary:
+*   Timer callback, runs in the beacon manager task. Applies the failed parts
+*   of the configuration again, data and parameters before the advertising
+*   state. After BEACON_HEALTH_FALLBACK_ATTEMPTS they are taken once from the
+*   last configuration that worked, so the instance advertises something
+*   valid, and the requested configuration is retried after that.
+*
+*********************************************************************************/
+static void beacon_health_retry(beacon_timer_t *p_timer)
+{
+    health_instance_t *p_inst = (health_instance_t *)p_timer->p_arg;
+    beacon_slot_t *p_slot = beacon_slot_get((uint8_t)(p_inst - health_instances) + 1);
+    health_config_t config = p_inst->requested;
+    uint8_t parts;
+
+    p_inst->retry_armed = WICED_FALSE;
+
+    /* Responses still due tell whether the previous attempt worked */
+    if (0 != p_slot->cmds_pending)
+    {
+        beacon_health_arm(p_inst, WICED_FALSE);
+        return;
+    }
+
+    parts = p_inst->failed & config.parts;
+    if (0 == parts)
+    {
+        p_inst->failed = 0;
+        beacon_health_settle(p_inst, p_slot);
+        return;
+    }
+
+    if (p_inst->stats.attempts < 0xFF)
+    {
+        p_inst->stats.attempts++;
+    }
+    p_inst->stats.retries++;
+
+    if ((BEACON_HEALTH_FALLBACK_ATTEMPTS + 1 == p_inst->stats.attempts) &&
+        (0 != (p_inst->last_good.parts & parts)) &&
+        (0 != memcmp(&p_inst->last_good, &p_inst->requested, sizeof(health_config_t))))
+    {
+        config = p_inst->last_good;
+        parts &= config.parts;
+        p_inst->fallback |= parts;
+        p_inst->stats.fallbacks++;
+        health_falling_back = WICED_TRUE;
+    }
+    else
+    {
+        p_inst->fallback &= (uint8_t)~parts;
+    }
+
+    if ((BEACON_HEALTH_ESCALATE_ATTEMPTS == p_inst->stats.attempts) &&
+        (BEACON_HEALTH_ESCALATED != p_inst->stats.state))
+    {
+        p_inst->stats.state = BEACON_HEALTH_ESCALATED;
+        p_inst->stats.escalations++;
+        if (NULL != health_cback)
+        {
+            health_cback(p_slot->instance, &p_inst->stats);
+        }
+    }
+
+    /* Commands refused here report a new fault through the issue hook */
+    p_inst->failed = 0;
+    if (0 != (parts & HEALTH_DATA))
+    {
+        beacon_slot_set_data(p_slot, config.adv_data, config.adv_len);
+    }
+    if (0 != (parts & HEALTH_PARAMS))
+    {
+        beacon_slot_set_params(p_slot, &config.params);
+    }
+    if (0 != (parts & HEALTH_ENABLE))
+    {
+        beacon_slot_start(p_slot, config.advertising);
+    }
+    health_falling_back = WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_health_init
+*********************************************************************************
+* Summary:
+*   Initializes the monitor. Must be called before the first slot command.
+*
+* Parameters:
+*   p_cback:                Callback for escalations, may be NULL
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_health_init(beacon_health_cback_t *p_cback)
+{
+    memset(health_instances, 0, sizeof(health_instances));
+    health_cback        = p_cback;
+    health_falling_back = WICED_FALSE;
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        beacon_timer_setup(&health_instances[i].timer, beacon_health_retry, &health_instances[i]);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_health_on_issue
+*********************************************************************************
+* Summary:
+*   Slot hook for every command, issued or refused. Records the requested
+*   configuration, except for the last good one applied by a retry; a
+*   refused command is a fault.
+*
+* Parameters:
+*   p_slot:                 Slot
+*   opcode:                 Command
+*   p_arg:                  Data or parameters of the command
+*   arg:                    Data length or start/stop of the command
+*   result:                 Result of the stack call
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_health_on_issue(beacon_slot_t *p_slot, wiced_bt_multi_adv_opcodes_t opcode,
+                            const void *p_arg, uint8_t arg, wiced_result_t result)
+{
+    health_instance_t *p_inst = &health_instances[p_slot->instance - 1];
+    uint8_t part = beacon_health_part(opcode);
+
+    if (0 == part)
+    {
+        return;
+    }
+
+    /* The last good configuration applied by a retry is not a request */
+    if (!health_falling_back)
+    {
+        /* A new request of the owner replaces the last good part */
+        p_inst->fallback &= (uint8_t)~part;
+        beacon_health_record(&p_inst->requested, part, p_arg, arg);
+    }
+
+    if (WICED_BT_PENDING == result)
+    {
+        p_inst->pending[beacon_health_index(part)]++;
+    }
+    else
+    {
+        beacon_health_fault(p_inst, part);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_health_on_response
+*********************************************************************************
+* Summary:
+*   Slot hook for every response. A failed response is a fault, a successful
+*   response to the latest command of a part repairs that part, whether it
+*   was issued by a retry or by the owner of the slot.
+*
+* Parameters:
+*   p_slot:                 Slot
+*   opcode:                 Command of the response
+*   status:                 Status of the response
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_health_on_response(beacon_slot_t *p_slot, wiced_bt_multi_adv_opcodes_t opcode,
+                               uint8_t status)
+{
+    health_instance_t *p_inst = &health_instances[p_slot->instance - 1];
+    uint8_t part = beacon_health_part(opcode);
+    uint8_t *p_pending;
+
+    if (0 == part)
+    {
+        return;
+    }
+
+    p_pending = &p_inst->pending[beacon_health_index(part)];
+    if (0 != *p_pending)
+    {
+        (*p_pending)--;
+    }
+
+    if (WICED_SUCCESS != status)
+    {
+        beacon_health_fault(p_inst, part);
+        return;
+    }
+
+    if (0 == *p_pending)
+    {
+        p_inst->failed &= (uint8_t)~part;
+    }
+    beacon_health_settle(p_inst, p_slot);
+}
+
+/********************************************************************************
+* Function Name: beacon_health_restart
+*********************************************************************************
+* Summary:
+*   Call when the stack was restarted and the controller lost its instances.
+*   Commands still awaiting a response are dropped and every configured
+*   instance is applied again right away. Call in the beacon manager task.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_health_restart(void)
+{
+    health_instance_t *p_inst;
+
+    beacon_slot_flush();
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        p_inst = &health_instances[i];
+        if (0 == p_inst->requested.parts)
+        {
+            continue;
+        }
+
+        memset(p_inst->pending, 0, sizeof(p_inst->pending));
+        beacon_health_fault(p_inst, HEALTH_ALL);
+        beacon_health_arm(p_inst, WICED_TRUE);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_health_get
+*********************************************************************************
+* Summary:
+*   Returns the counters of an instance. The mean recovery time is
+*   recover_total_ms / recoveries.
+*
+* Parameters:
+*   instance:               Multi-adv instance
+*   p_stats:                Output
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_health_get(uint8_t instance, beacon_health_stats_t *p_stats)
+{
+    if ((0 == instance) || (instance > BEACON_SLOT_MAX_INSTANCES))
+    {
+        memset(p_stats, 0, sizeof(*p_stats));
+        return;
+    }
+    *p_stats = health_instances[instance - 1].stats;
+}
+
+/********************************************************************************
+* Function Name: beacon_health_reset
+*********************************************************************************
+* Summary:
+*   Clears the counters of all instances. Faults in progress keep going.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_health_reset(void)
+{
+    beacon_health_stats_t *p_stats;
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        p_stats = &health_instances[i].stats;
+        p_stats->faults           = (BEACON_HEALTH_OK != p_stats->state) ? 1 : 0;
+        p_stats->recoveries       = 0;
+        p_stats->retries          = 0;
+        p_stats->fallbacks        = 0;
+        p_stats->escalations      = 0;
+        p_stats->recover_total_ms = 0;
+        p_stats->recover_max_ms   = 0;
+    }
+}
+
+/* [] END OF FILE */
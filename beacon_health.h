@@ -0,0 +1,127 @@
+/******************************************************************************
+* File Name: beacon_health.h
+*
+* Description: This is the header file for the health monitor of the
+* advertising instances.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_HEALTH_H__
+#define __BEACON_HEALTH_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to re-apply the configuration of instances whose commands fail */
+#ifndef BEACON_HEALTH_ENABLE
+#define BEACON_HEALTH_ENABLE             (0)
+#endif
+
+/* Delay of the first retry, doubled with every further attempt */
+#ifndef BEACON_HEALTH_BACKOFF_MS
+#define BEACON_HEALTH_BACKOFF_MS         (100)
+#endif
+
+#ifndef BEACON_HEALTH_BACKOFF_MAX_MS
+#define BEACON_HEALTH_BACKOFF_MAX_MS     (10000)
+#endif
+
+/* Attempts with the requested configuration before the last one that
+ * worked is restored, once, ahead of the next attempt */
+#ifndef BEACON_HEALTH_FALLBACK_ATTEMPTS
+#define BEACON_HEALTH_FALLBACK_ATTEMPTS  (3)
+#endif
+
+/* Attempts after which the application is told; retries go on */
+#ifndef BEACON_HEALTH_ESCALATE_ATTEMPTS
+#define BEACON_HEALTH_ESCALATE_ATTEMPTS  (8)
+#endif
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Health of an instance */
+typedef enum
+{
+    BEACON_HEALTH_OK = 0,                       /* Controller state as requested */
+    BEACON_HEALTH_RECOVERING,                   /* A command failed, retrying */
+    BEACON_HEALTH_ESCALATED,                    /* Still failing after
+                                                   BEACON_HEALTH_ESCALATE_ATTEMPTS */
+}beacon_health_state_t;
+
+/* Counters of an instance */
+typedef struct
+{
+    uint8_t  state;                             /* beacon_health_state_t */
+    uint8_t  attempts;                          /* Retries of the current fault */
+    uint32_t faults;                            /* Faults, a fault ends with a recovery */
+    uint32_t recoveries;                        /* Faults recovered */
+    uint32_t retries;                           /* Configurations re-applied */
+    uint32_t fallbacks;                         /* Last good configurations restored */
+    uint32_t escalations;                       /* Faults escalated */
+    uint32_t recover_total_ms;                  /* Sum of the recovery times */
+    uint32_t recover_max_ms;                    /* Longest recovery */
+}beacon_health_stats_t;
+
+/* Called when an instance is escalated and when it recovers after that */
+typedef void (beacon_health_cback_t)(uint8_t instance, const beacon_health_stats_t *p_stats);
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void beacon_health_init        (beacon_health_cback_t *p_cback);
+
+void beacon_health_on_issue    (beacon_slot_t *p_slot, wiced_bt_multi_adv_opcodes_t opcode,
+                                const void *p_arg, uint8_t arg, wiced_result_t result);
+
+void beacon_health_on_response (beacon_slot_t *p_slot, wiced_bt_multi_adv_opcodes_t opcode,
+                                uint8_t status);
+
+void beacon_health_restart     (void);
+
+void beacon_health_get         (uint8_t instance, beacon_health_stats_t *p_stats);
+
+void beacon_health_reset       (void);
+
+#endif      /* __BEACON_HEALTH_H__ */
+
+
+/* [] END OF FILE */
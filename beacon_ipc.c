@@ -0,0 +1,408 @@
+/******************************************************************************
+* File Name: beacon_ipc.c
+*
+* Description: This is the source code for the inter-core payload channel.
+* The producer only writes head and the consumer only writes tail, so no lock
+* or read-modify-write operation is needed, which also makes the ring usable
+* between cores that do not share an exclusive monitor.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "wiced_bt_stack.h"
+#include "beacon_ipc.h"
+#include "beacon_manager.h"
+#include "beacon_slot.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define BEACON_IPC_RING_MASK             (BEACON_IPC_RING_SIZE - 1)
+
+#if (BEACON_IPC_RING_SIZE & BEACON_IPC_RING_MASK)
+#error "BEACON_IPC_RING_SIZE must be a power of two"
+#endif
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Ring from the payload producing core to the Bluetooth core */
+CY_SECTION_SHAREDMEM beacon_ipc_ring_t beacon_ipc_payload_ring;
+
+/* Newest payload of every instance not yet accepted by its slot */
+static beacon_ipc_msg_t   ipc_pending[BEACON_SLOT_MAX_INSTANCES];
+static wiced_bool_t       ipc_pending_valid[BEACON_SLOT_MAX_INSTANCES];
+static beacon_ipc_stats_t ipc_stats;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_ipc_ring_init
+*********************************************************************************
+* Summary:
+*   Empties the ring. The shared memory section is not initialized at start
+*   up, so the consumer calls this before the producer core is released.
+*
+* Parameters:
+*   p_ring:                 Ring
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_ipc_ring_init(beacon_ipc_ring_t *p_ring)
+{
+    p_ring->head = 0;
+    p_ring->tail = 0;
+    __DMB();
+    BEACON_IPC_CACHE_CLEAN(p_ring, sizeof(*p_ring));
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_push
+*********************************************************************************
+* Summary:
+*   Producer side. Copies a message into the ring and publishes it.
+*
+* Parameters:
+*   p_ring:                 Ring
+*   p_msg:                  Message to send
+*
+* Return:
+*   WICED_FALSE if the ring is full
+*
+*********************************************************************************/
+wiced_bool_t beacon_ipc_push(beacon_ipc_ring_t *p_ring, const beacon_ipc_msg_t *p_msg)
+{
+    uint32_t head = p_ring->head;
+    uint32_t tail;
+    beacon_ipc_msg_t *p_slot;
+
+    BEACON_IPC_CACHE_INVALIDATE(&p_ring->tail, BEACON_IPC_CACHE_LINE);
+    tail = p_ring->tail;
+
+    if ((head - tail) >= BEACON_IPC_RING_SIZE)
+    {
+        return WICED_FALSE;
+    }
+
+    p_slot = &p_ring->msg[head & BEACON_IPC_RING_MASK];
+    memcpy(p_slot, p_msg, sizeof(*p_slot));
+    BEACON_IPC_CACHE_CLEAN(p_slot, sizeof(*p_slot));
+
+    /* The message must be visible before the new head */
+    __DMB();
+    p_ring->head = head + 1;
+    BEACON_IPC_CACHE_CLEAN(&p_ring->head, BEACON_IPC_CACHE_LINE);
+
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_pop
+*********************************************************************************
+* Summary:
+*   Consumer side. Copies the oldest message out of the ring and releases
+*   its slot.
+*
+* Parameters:
+*   p_ring:                 Ring
+*   p_msg:                  Received message
+*
+* Return:
+*   WICED_FALSE if the ring is empty
+*
+*********************************************************************************/
+wiced_bool_t beacon_ipc_pop(beacon_ipc_ring_t *p_ring, beacon_ipc_msg_t *p_msg)
+{
+    uint32_t tail = p_ring->tail;
+    uint32_t head;
+    beacon_ipc_msg_t *p_slot;
+
+    BEACON_IPC_CACHE_INVALIDATE(&p_ring->head, BEACON_IPC_CACHE_LINE);
+    head = p_ring->head;
+
+    if (head == tail)
+    {
+        return WICED_FALSE;
+    }
+
+    /* Read the message only after observing the head that published it */
+    __DMB();
+    p_slot = &p_ring->msg[tail & BEACON_IPC_RING_MASK];
+    BEACON_IPC_CACHE_INVALIDATE(p_slot, sizeof(*p_slot));
+    memcpy(p_msg, p_slot, sizeof(*p_msg));
+
+    /* The copy must complete before the slot is handed back */
+    __DMB();
+    p_ring->tail = tail + 1;
+    BEACON_IPC_CACHE_CLEAN(&p_ring->tail, BEACON_IPC_CACHE_LINE);
+
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_drain
+*********************************************************************************
+* Summary:
+*   Hands every message waiting in the ring to a handler
+*
+* Parameters:
+*   p_ring:                 Ring
+*   p_handler:              Message handler
+*
+* Return:
+*   Number of messages handled
+*
+*********************************************************************************/
+uint32_t beacon_ipc_drain(beacon_ipc_ring_t *p_ring, beacon_ipc_handler_t *p_handler)
+{
+    beacon_ipc_msg_t msg;
+    uint32_t count = 0;
+
+    while (beacon_ipc_pop(p_ring, &msg))
+    {
+        p_handler(&msg);
+        count++;
+    }
+    return count;
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_collect
+*********************************************************************************
+* Summary:
+*   Keeps the newest payload of every instance. A payload that has not been
+*   submitted yet is replaced by a later one for the same instance.
+*
+*********************************************************************************/
+static void beacon_ipc_collect(const beacon_ipc_msg_t *p_msg)
+{
+    uint8_t index;
+
+    ipc_stats.received++;
+
+    if ((p_msg->instance < 1) || (p_msg->instance > BEACON_SLOT_MAX_INSTANCES) ||
+        (p_msg->adv_len > BEACON_ADV_DATA_MAX))
+    {
+        return;
+    }
+
+    index = p_msg->instance - 1;
+    if (ipc_pending_valid[index])
+    {
+        ipc_stats.superseded++;
+    }
+    memcpy(&ipc_pending[index], p_msg, sizeof(*p_msg));
+    ipc_pending_valid[index] = WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_submit_all
+*********************************************************************************
+* Summary:
+*   Drains the payload ring and submits one payload per instance, deferred to
+*   the beacon manager task. Payloads the slot refuses, for example while its
+*   command queue is full, stay pending for the next retry.
+*
+*********************************************************************************/
+static void beacon_ipc_submit_all(void)
+{
+    beacon_ipc_drain(&beacon_ipc_payload_ring, beacon_ipc_collect);
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        beacon_slot_t *p_slot = beacon_slot_get(i + 1);
+
+        if (!ipc_pending_valid[i])
+        {
+            continue;
+        }
+
+        if ((NULL == p_slot) ||
+            (WICED_BT_PENDING == beacon_slot_set_data(p_slot, ipc_pending[i].adv_data,
+                                                      ipc_pending[i].adv_len)))
+        {
+            ipc_pending_valid[i] = WICED_FALSE;
+            ipc_stats.submitted += (NULL != p_slot) ? 1 : 0;
+        }
+        else
+        {
+            ipc_stats.rejected++;
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_job
+*********************************************************************************
+* Summary:
+*   Worker job checking the payload ring after a doorbell. The payloads are
+*   submitted by the beacon manager, the job only wakes it when the ring is
+*   not empty or a refused payload is waiting, and runs again after
+*   BEACON_IPC_RETRY_MS until the slots have accepted everything. Otherwise
+*   it sleeps until the next doorbell, or the opt-in poll.
+*
+*********************************************************************************/
+static uint32_t beacon_ipc_job(uint32_t now_ms)
+{
+    beacon_ipc_ring_t *p_ring = &beacon_ipc_payload_ring;
+    wiced_bool_t pending = WICED_FALSE;
+
+    (void)now_ms;
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        pending |= ipc_pending_valid[i];
+    }
+
+    BEACON_IPC_CACHE_INVALIDATE(&p_ring->head, BEACON_IPC_CACHE_LINE);
+    if (pending || (p_ring->head != p_ring->tail))
+    {
+        beacon_manager_defer(beacon_ipc_submit_all);
+        return BEACON_IPC_RETRY_MS;
+    }
+    return (0 != BEACON_IPC_POLL_MS) ? BEACON_IPC_POLL_MS : BEACON_WORKER_IDLE;
+}
+
+#if defined(BEACON_IPC_NOTIFY_CHANNEL)
+/********************************************************************************
+* Function Name: beacon_ipc_doorbell_init
+*********************************************************************************
+* Summary:
+*   Routes the notify events of the doorbell IPC structure to an interrupt
+*   of this core
+*
+*********************************************************************************/
+static void beacon_ipc_doorbell_init(cy_israddress isr)
+{
+    const cy_stc_sysint_t cfg =
+    {
+        .intrSrc      = BEACON_IPC_NOTIFY_IRQ,
+        .intrPriority = BEACON_IPC_NOTIFY_PRIORITY,
+    };
+
+    Cy_IPC_Drv_SetInterruptMask(Cy_IPC_Drv_GetIntrBaseAddr(BEACON_IPC_NOTIFY_INTR), 0UL,
+                                (1UL << BEACON_IPC_NOTIFY_CHANNEL));
+    (void)Cy_SysInt_Init(&cfg, isr);
+    NVIC_EnableIRQ(cfg.intrSrc);
+}
+#endif
+
+/********************************************************************************
+* Function Name: beacon_ipc_start
+*********************************************************************************
+* Summary:
+*   Empties the payload ring and starts submitting the payloads produced by
+*   the other core. Call before the producer core is started.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_ipc_start(void)
+{
+    beacon_ipc_ring_init(&beacon_ipc_payload_ring);
+    BEACON_IPC_DOORBELL_INIT(beacon_ipc_isr);
+    beacon_worker_register(beacon_ipc_job, BEACON_IPC_POLL_SLACK_MS);
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_notify
+*********************************************************************************
+* Summary:
+*   Producer side. Rings the doorbell of the Bluetooth core after one or more
+*   calls to beacon_ipc_push on the payload ring. The consumer drains the
+*   whole ring on every doorbell, so a batch of messages needs only one.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_ipc_notify(void)
+{
+    BEACON_IPC_DOORBELL_RING();
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_isr
+*********************************************************************************
+* Summary:
+*   Doorbell interrupt of the Bluetooth core. Wakes the worker, which runs
+*   beacon_ipc_job.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_ipc_isr(void)
+{
+    BEACON_IPC_DOORBELL_CLEAR();
+    beacon_worker_kick_from_isr();
+}
+
+/********************************************************************************
+* Function Name: beacon_ipc_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the payload submission counters
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Pointer to the counters
+*
+*********************************************************************************/
+const beacon_ipc_stats_t *beacon_ipc_get_stats(void)
+{
+    return &ipc_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,190 @@
+/******************************************************************************
+* File Name: beacon_ipc.h
+*
+* Description: This file contains the definitions for the inter-core payload
+* channel. It is a single producer, single consumer lock-free ring of fixed
+* size payload messages placed in shared memory.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_IPC_H__
+#define __BEACON_IPC_H__
+
+#include "cy_pdl.h"
+#include "beacon_utils.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to accept ready payloads from the other core */
+#ifndef BEACON_IPC_ENABLE
+#define BEACON_IPC_ENABLE                (0)
+#endif
+
+/* Number of messages in the ring, must be a power of two */
+#define BEACON_IPC_RING_SIZE             (8)
+
+/* The producer rings a doorbell with beacon_ipc_notify() after pushing, and
+ * the Bluetooth core only wakes up for it. A producer that cannot ring it
+ * sets a poll interval instead: a 100 ms poll adds about 25,000 worker
+ * wakeups per hour, roughly 20 uA average current with the wakeup cost of
+ * beacon_energy.h. 0 disables the poll. */
+#ifndef BEACON_IPC_POLL_MS
+#define BEACON_IPC_POLL_MS               (0)
+#endif
+
+/* Delay before a payload refused by its slot is submitted again, and the
+ * delay a poll or a retry may take to share a wakeup with other work */
+#define BEACON_IPC_RETRY_MS              (100)
+#define BEACON_IPC_POLL_SLACK_MS         (50)
+
+/* Messages and indices are kept on separate cache lines */
+#define BEACON_IPC_CACHE_LINE            (32)
+
+/* Cache maintenance for the shared memory. On the CM7 the data cache has to
+ * be cleaned after writing and invalidated before reading; the CM4 and CM0+
+ * have no data cache. */
+#if !defined(BEACON_IPC_CACHE_CLEAN)
+#if defined(COMPONENT_CM7) && defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+#define BEACON_IPC_CACHE_CLEAN(addr, size) \
+    SCB_CleanDCache_by_Addr((void *)(addr), (int32_t)(size))
+#define BEACON_IPC_CACHE_INVALIDATE(addr, size) \
+    SCB_InvalidateDCache_by_Addr((void *)(addr), (int32_t)(size))
+#else
+#define BEACON_IPC_CACHE_CLEAN(addr, size)      ((void)(addr), (void)(size))
+#define BEACON_IPC_CACHE_INVALIDATE(addr, size) ((void)(addr), (void)(size))
+#endif
+#endif
+
+/* Doorbell from the producer to the Bluetooth core: a notify event of the
+ * IPC structure BEACON_IPC_NOTIFY_CHANNEL on the IPC interrupt structure
+ * BEACON_IPC_NOTIFY_INTR, which the Bluetooth core takes on
+ * BEACON_IPC_NOTIFY_IRQ. Both have to be free in the application. */
+#if defined(CY_IPC_CHAN_USER) && defined(CY_IPC_INTR_USER)
+#ifndef BEACON_IPC_NOTIFY_CHANNEL
+#define BEACON_IPC_NOTIFY_CHANNEL        (CY_IPC_CHAN_USER)
+#endif
+#ifndef BEACON_IPC_NOTIFY_INTR
+#define BEACON_IPC_NOTIFY_INTR           (CY_IPC_INTR_USER)
+#endif
+#ifndef BEACON_IPC_NOTIFY_IRQ
+#define BEACON_IPC_NOTIFY_IRQ            ((IRQn_Type)(cpuss_interrupts_ipc_0_IRQn + \
+                                                      BEACON_IPC_NOTIFY_INTR))
+#endif
+#endif
+
+/* Priority of the doorbell interrupt, low enough to call FreeRTOS */
+#define BEACON_IPC_NOTIFY_PRIORITY       (7)
+
+#if !defined(BEACON_IPC_DOORBELL_RING)
+#if defined(BEACON_IPC_NOTIFY_CHANNEL)
+#define BEACON_IPC_DOORBELL_RING() \
+    Cy_IPC_Drv_AcquireNotify(Cy_IPC_Drv_GetIpcBaseAddress(BEACON_IPC_NOTIFY_CHANNEL), \
+                             (1UL << BEACON_IPC_NOTIFY_INTR))
+#define BEACON_IPC_DOORBELL_CLEAR() \
+    Cy_IPC_Drv_ClearInterrupt(Cy_IPC_Drv_GetIntrBaseAddr(BEACON_IPC_NOTIFY_INTR), 0UL, \
+                              (1UL << BEACON_IPC_NOTIFY_CHANNEL))
+#define BEACON_IPC_DOORBELL_INIT(isr)  beacon_ipc_doorbell_init(isr)
+#else
+#define BEACON_IPC_DOORBELL_RING()      ((void)0)
+#define BEACON_IPC_DOORBELL_CLEAR()     ((void)0)
+#define BEACON_IPC_DOORBELL_INIT(isr)   ((void)(isr))
+#endif
+#endif
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Ready to submit advertisement data for one instance */
+typedef struct
+{
+    uint8_t instance;                           /* Multi-adv instance number */
+    uint8_t adv_len;                            /* Length of adv_data */
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];      /* Encoded advertisement data */
+    uint32_t seq;                               /* Producer sequence number */
+} __attribute__((aligned(BEACON_IPC_CACHE_LINE))) beacon_ipc_msg_t;
+
+/* Ring shared by the producer and the consumer core */
+typedef struct
+{
+    /* Written by the producer only */
+    volatile uint32_t head __attribute__((aligned(BEACON_IPC_CACHE_LINE)));
+    /* Written by the consumer only */
+    volatile uint32_t tail __attribute__((aligned(BEACON_IPC_CACHE_LINE)));
+    beacon_ipc_msg_t msg[BEACON_IPC_RING_SIZE];
+}beacon_ipc_ring_t;
+
+/* Called by beacon_ipc_drain for every received message */
+typedef void (beacon_ipc_handler_t)(const beacon_ipc_msg_t *p_msg);
+
+/* Payload submission counters */
+typedef struct
+{
+    uint32_t received;                          /* Messages taken from the ring */
+    uint32_t superseded;                        /* Messages replaced by a newer one for the
+                                                   same instance before submission */
+    uint32_t submitted;                         /* Payloads accepted by the slot */
+    uint32_t rejected;                          /* Submissions refused by the slot, retried
+                                                   after BEACON_IPC_RETRY_MS */
+}beacon_ipc_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+extern beacon_ipc_ring_t beacon_ipc_payload_ring;
+
+void         beacon_ipc_ring_init (beacon_ipc_ring_t *p_ring);
+
+wiced_bool_t beacon_ipc_push      (beacon_ipc_ring_t *p_ring, const beacon_ipc_msg_t *p_msg);
+
+wiced_bool_t beacon_ipc_pop       (beacon_ipc_ring_t *p_ring, beacon_ipc_msg_t *p_msg);
+
+uint32_t     beacon_ipc_drain     (beacon_ipc_ring_t *p_ring, beacon_ipc_handler_t *p_handler);
+
+void         beacon_ipc_start     (void);
+
+void         beacon_ipc_notify    (void);
+
+void         beacon_ipc_isr       (void);
+
+const beacon_ipc_stats_t *beacon_ipc_get_stats (void);
+
+#endif      /* __BEACON_IPC_H__ */
+
+
+/* [] END OF FILE */
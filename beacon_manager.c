@@ -0,0 +1,324 @@
+/******************************************************************************
+* File Name: beacon_manager.c
+*
+* Description: This is the source code for the beacon manager task. Events are
+* copied into a static queue by the stack callbacks; the manager task is woken
+* with a task notification, which also carries the deferred function bits.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include "beacon_manager.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Notification bits for queued scan reports and control events, the
+ * deferred functions use the bits above them */
+#define MANAGER_NOTIFY_EVENT             (0x01UL)
+#define MANAGER_NOTIFY_CONTROL           (0x02UL)
+#define MANAGER_NOTIFY_DEFERRED(index)   (0x04UL << (index))
+#define MANAGER_NOTIFY_ALL               (0xFFFFFFFFUL)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_manager_handler_t *manager_handlers[BEACON_MANAGER_EVT_MAX];
+static beacon_manager_fn_t      *manager_deferred[BEACON_MANAGER_MAX_DEFERRED];
+static uint8_t                   manager_num_deferred;
+static beacon_manager_stats_t    manager_stats;
+static uint32_t                  manager_reported_max;
+
+static QueueHandle_t             manager_queue;
+static StaticQueue_t             manager_queue_buffer;
+static uint8_t                   manager_queue_storage[BEACON_MANAGER_QUEUE_SIZE *
+                                                       sizeof(beacon_manager_evt_t)];
+
+/* Responses and BTM_ENABLED_EVT have their own queue: the slot matches each
+ * response to the oldest command in flight, so losing one to a burst of scan
+ * reports would shift every later response to the wrong command */
+static QueueHandle_t             manager_control_queue;
+static StaticQueue_t             manager_control_queue_buffer;
+static uint8_t                   manager_control_queue_storage[BEACON_MANAGER_CONTROL_QUEUE_SIZE *
+                                                               sizeof(beacon_manager_evt_t)];
+
+static TaskHandle_t              manager_task_handle;
+static StaticTask_t              manager_task_tcb;
+static StackType_t               manager_task_stack[BEACON_MANAGER_TASK_STACK_SIZE];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_manager_dispatch
+*********************************************************************************
+* Summary:
+*   Hands every event waiting in a queue to its handler
+*
+*********************************************************************************/
+static void beacon_manager_dispatch(QueueHandle_t queue)
+{
+    beacon_manager_evt_t evt;
+
+    while (pdTRUE == xQueueReceive(queue, &evt, 0))
+    {
+        if ((evt.type < BEACON_MANAGER_EVT_MAX) && (NULL != manager_handlers[evt.type]))
+        {
+            manager_handlers[evt.type](&evt);
+        }
+        manager_stats.handled++;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_manager_task
+*********************************************************************************
+* Summary:
+*   Dispatches the queued control events and scan reports, then runs the
+*   requested deferred functions
+*
+*********************************************************************************/
+static void beacon_manager_task(void *arg)
+{
+    uint32_t notified;
+
+    (void)arg;
+
+    for (;;)
+    {
+        xTaskNotifyWait(0, MANAGER_NOTIFY_ALL, &notified, portMAX_DELAY);
+
+        if (notified & MANAGER_NOTIFY_CONTROL)
+        {
+            beacon_manager_dispatch(manager_control_queue);
+        }
+
+        if (notified & MANAGER_NOTIFY_EVENT)
+        {
+            beacon_manager_dispatch(manager_queue);
+        }
+
+        for (uint8_t i = 0; i < manager_num_deferred; i++)
+        {
+            if (notified & MANAGER_NOTIFY_DEFERRED(i))
+            {
+                manager_deferred[i]();
+                manager_stats.deferred++;
+            }
+        }
+
+        /* Report every new worst case of the stack callbacks */
+        if (manager_stats.cback_cycles.max > manager_reported_max)
+        {
+            manager_reported_max = manager_stats.cback_cycles.max;
+            printf("Stack callback worst case: %lu us\n",
+                   (unsigned long)beacon_stats_cycles_to_us(manager_reported_max));
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_manager_init
+*********************************************************************************
+* Summary:
+*   Creates the event queues and the manager task. Must be called before the
+*   Bluetooth stack is initialized.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_manager_init(void)
+{
+    if (NULL == manager_task_handle)
+    {
+        manager_queue = xQueueCreateStatic(BEACON_MANAGER_QUEUE_SIZE, sizeof(beacon_manager_evt_t),
+                                           manager_queue_storage, &manager_queue_buffer);
+        manager_control_queue = xQueueCreateStatic(BEACON_MANAGER_CONTROL_QUEUE_SIZE,
+                                                   sizeof(beacon_manager_evt_t),
+                                                   manager_control_queue_storage,
+                                                   &manager_control_queue_buffer);
+        manager_task_handle = xTaskCreateStatic(beacon_manager_task, "Manager",
+                                                BEACON_MANAGER_TASK_STACK_SIZE, NULL,
+                                                BEACON_MANAGER_TASK_PRIORITY,
+                                                manager_task_stack, &manager_task_tcb);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_manager_register
+*********************************************************************************
+* Summary:
+*   Sets the handler of an event type
+*
+* Parameters:
+*   type:                   Event type
+*   p_handler:              Handler, NULL to discard the events
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_manager_register(beacon_manager_evt_type_t type, beacon_manager_handler_t *p_handler)
+{
+    if (type < BEACON_MANAGER_EVT_MAX)
+    {
+        manager_handlers[type] = p_handler;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_manager_post
+*********************************************************************************
+* Summary:
+*   Queues an event for the manager task. Never blocks, so it can be called
+*   from the Bluetooth stack callbacks. Scan reports are dropped when their
+*   queue is full; control events have a queue sized so that they never are.
+*
+* Parameters:
+*   p_evt:                  Event, copied into the queue
+*
+* Return:
+*   wiced_bool_t: WICED_FALSE if the queue is full and the event is dropped
+*
+*********************************************************************************/
+wiced_bool_t beacon_manager_post(const beacon_manager_evt_t *p_evt)
+{
+    wiced_bool_t control = (BEACON_MANAGER_EVT_SCAN_REPORT != p_evt->type) ?
+                           WICED_TRUE : WICED_FALSE;
+
+    if (pdTRUE != xQueueSend(control ? manager_control_queue : manager_queue, p_evt, 0))
+    {
+        if (control)
+        {
+            manager_stats.control_lost++;
+            configASSERT(0);
+        }
+        else
+        {
+            manager_stats.dropped++;
+        }
+        return WICED_FALSE;
+    }
+
+    manager_stats.posted++;
+    xTaskNotify(manager_task_handle, control ? MANAGER_NOTIFY_CONTROL : MANAGER_NOTIFY_EVENT,
+                eSetBits);
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_manager_cback_done
+*********************************************************************************
+* Summary:
+*   Records the time spent in a stack callback. Called on the way out of the
+*   callback with the cycle counter read on entry.
+*
+* Parameters:
+*   entry_cycles:           Cycle counter on entry, see beacon_stats_cycles
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_manager_cback_done(uint32_t entry_cycles)
+{
+    beacon_latency_add(&manager_stats.cback_cycles, beacon_stats_cycles() - entry_cycles);
+}
+
+/********************************************************************************
+* Function Name: beacon_manager_defer
+*********************************************************************************
+* Summary:
+*   Runs a function in the manager task. Requests for the same function are
+*   coalesced until it runs, and are never lost when the event queue is full.
+*
+* Parameters:
+*   p_fn:                   Function to run
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_manager_defer(beacon_manager_fn_t *p_fn)
+{
+    uint8_t index;
+
+    taskENTER_CRITICAL();
+    for (index = 0; index < manager_num_deferred; index++)
+    {
+        if (manager_deferred[index] == p_fn)
+        {
+            break;
+        }
+    }
+    if (index == manager_num_deferred)
+    {
+        configASSERT(manager_num_deferred < BEACON_MANAGER_MAX_DEFERRED);
+        manager_deferred[manager_num_deferred++] = p_fn;
+    }
+    taskEXIT_CRITICAL();
+
+    xTaskNotify(manager_task_handle, MANAGER_NOTIFY_DEFERRED(index), eSetBits);
+}
+
+/********************************************************************************
+* Function Name: beacon_manager_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the manager counters
+*
+* Parameters:
+*   None
+*
+* Return:
+*   const beacon_manager_stats_t *: Counters
+*
+*********************************************************************************/
+const beacon_manager_stats_t *beacon_manager_get_stats(void)
+{
+    return &manager_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,144 @@
+/******************************************************************************
+* File Name: beacon_manager.h
+*
+* Description: This file contains the definitions for the beacon manager task.
+* Bluetooth stack callbacks only post events to the manager, which does all
+* encoding, command issuing and response handling.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_MANAGER_H__
+#define __BEACON_MANAGER_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_slot.h"
+#include "beacon_stats.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Number of scan reports that can wait for the manager */
+#define BEACON_MANAGER_QUEUE_SIZE        (16)
+
+/* Number of stack control events that can wait for the manager. Every slot
+ * command in flight gets one response, plus BTM_ENABLED_EVT, so this queue
+ * never overflows. */
+#define BEACON_MANAGER_CONTROL_QUEUE_SIZE (BEACON_SLOT_CMD_QUEUE_SIZE + 1)
+
+/* Maximum number of distinct deferred functions */
+#define BEACON_MANAGER_MAX_DEFERRED      (12)
+
+/* Manager task configuration, below the Bluetooth stack task so that posting
+ * an event never switches context inside a stack callback */
+#define BEACON_MANAGER_TASK_STACK_SIZE   (1024)
+#define BEACON_MANAGER_TASK_PRIORITY     (3)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Event types */
+typedef enum
+{
+    BEACON_MANAGER_EVT_ENABLED,                 /* BTM_ENABLED_EVT */
+    BEACON_MANAGER_EVT_MULTI_ADV_RESP,          /* BTM_MULTI_ADVERT_RESP_EVENT */
+    BEACON_MANAGER_EVT_SCAN_REPORT,             /* Beacon received while scanning */
+    BEACON_MANAGER_EVT_MAX
+}beacon_manager_evt_type_t;
+
+/* Event copied out of a stack callback */
+typedef struct
+{
+    uint8_t type;                               /* beacon_manager_evt_type_t */
+    uint32_t rx_cycles;                         /* Cycle counter in the callback */
+    union
+    {
+        wiced_result_t enabled_status;          /* BEACON_MANAGER_EVT_ENABLED */
+        struct
+        {
+            wiced_bt_multi_adv_opcodes_t opcode;
+            uint8_t status;
+        }multi_adv;                             /* BEACON_MANAGER_EVT_MULTI_ADV_RESP */
+        struct
+        {
+            wiced_bt_device_address_t bd_addr;
+            int8_t rssi;
+            uint8_t adv_data[BEACON_ADV_DATA_MAX];
+        }scan;                                  /* BEACON_MANAGER_EVT_SCAN_REPORT */
+    }data;
+}beacon_manager_evt_t;
+
+/* Event handler, runs in the manager task */
+typedef void (beacon_manager_handler_t)(const beacon_manager_evt_t *p_evt);
+
+/* Deferred function, runs in the manager task */
+typedef void (beacon_manager_fn_t)(void);
+
+/* Manager counters */
+typedef struct
+{
+    uint32_t posted;                            /* Events queued */
+    uint32_t dropped;                           /* Scan reports lost on a full queue */
+    uint32_t control_lost;                      /* Control events lost, always 0 unless
+                                                   BEACON_MANAGER_CONTROL_QUEUE_SIZE is
+                                                   too small */
+    uint32_t handled;                           /* Events dispatched */
+    uint32_t deferred;                          /* Deferred function runs */
+    beacon_latency_t cback_cycles;              /* Time spent in stack callbacks */
+}beacon_manager_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                          beacon_manager_init       (void);
+
+void                          beacon_manager_register   (beacon_manager_evt_type_t type,
+                                                         beacon_manager_handler_t *p_handler);
+
+wiced_bool_t                  beacon_manager_post       (const beacon_manager_evt_t *p_evt);
+
+void                          beacon_manager_cback_done (uint32_t entry_cycles);
+
+void                          beacon_manager_defer      (beacon_manager_fn_t *p_fn);
+
+const beacon_manager_stats_t *beacon_manager_get_stats  (void);
+
+#endif      /* __BEACON_MANAGER_H__ */
+
+
+/* [] END OF FILE */
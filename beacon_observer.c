@@ -0,0 +1,229 @@
+/******************************************************************************
+* File Name: beacon_observer.c
+*
+* Description: This is the source code for the beacon observer. Advertising
+* reports are folded into the beacon cache in the beacon manager task and
+* delivered to the application by a background worker job once per period.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "wiced_bt_stack.h"
+#include "beacon_manager.h"
+#include "beacon_observer.h"
+#include "beacon_relay.h"
+#include "beacon_sim.h"
+#include "beacon_stats.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_cache_t           observer_cache;
+static beacon_cache_record_t    observer_records[BEACON_CACHE_SIZE];
+static beacon_observer_cback_t *observer_cback;
+static wiced_bool_t             observer_started;
+static uint32_t                 observer_next_report_ms;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_observer_scan_result_cback
+*********************************************************************************
+* Summary:
+*   Scan result callback, runs in the Bluetooth stack context. Beacon frames
+*   are copied to the beacon manager, everything else is dropped here.
+*
+* Parameters:
+*   p_scan_result:          Scan result, NULL when the scan completes
+*   p_adv_data:             Advertisement data of the report
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+static void beacon_observer_scan_result_cback(wiced_bt_ble_scan_results_t *p_scan_result,
+                                              uint8_t *p_adv_data)
+{
+    beacon_frame_info_t info;
+    beacon_manager_evt_t evt;
+
+    evt.rx_cycles = beacon_stats_cycles();
+
+    /* Only beacon frames are aggregated */
+    if ((NULL != p_scan_result) && (NULL != p_adv_data) &&
+        beacon_parse_adv_data(p_adv_data, BEACON_ADV_DATA_MAX, &info))
+    {
+        evt.type = BEACON_MANAGER_EVT_SCAN_REPORT;
+        memcpy(evt.data.scan.bd_addr, p_scan_result->remote_bd_addr, BD_ADDR_LEN);
+        evt.data.scan.rssi = p_scan_result->rssi;
+        memcpy(evt.data.scan.adv_data, p_adv_data, BEACON_ADV_DATA_MAX);
+        beacon_manager_post(&evt);
+    }
+
+    beacon_manager_cback_done(evt.rx_cycles);
+}
+
+/********************************************************************************
+* Function Name: beacon_observer_on_report
+*********************************************************************************
+* Summary:
+*   Aggregates a beacon report in the cache and hands it to the relay. Runs in
+*   the beacon manager task, the only task that touches the cache.
+*
+*********************************************************************************/
+static void beacon_observer_on_report(const beacon_manager_evt_t *p_evt)
+{
+    beacon_frame_info_t info;
+
+    if (!beacon_parse_adv_data(p_evt->data.scan.adv_data, BEACON_ADV_DATA_MAX, &info))
+    {
+        return;
+    }
+
+    beacon_cache_update(&observer_cache, p_evt->data.scan.bd_addr, &info,
+                        p_evt->data.scan.rssi, beacon_stats_now_ms());
+
+#if BEACON_RELAY_ENABLE
+    beacon_relay_on_report(p_evt->data.scan.adv_data, &info, p_evt->rx_cycles,
+                           beacon_stats_now_ms());
+#endif
+}
+
+/********************************************************************************
+* Function Name: beacon_observer_flush
+*********************************************************************************
+* Summary:
+*   Delivers the aggregated records of the period. Deferred to the beacon
+*   manager so that the cache needs no lock.
+*
+*********************************************************************************/
+static void beacon_observer_flush(void)
+{
+    uint16_t num_records = beacon_cache_flush(&observer_cache, beacon_stats_now_ms(),
+                                              observer_records, BEACON_CACHE_SIZE);
+
+    for (uint16_t i = 0; (i < num_records) && (NULL != observer_cback); i++)
+    {
+        observer_cback(&observer_records[i]);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_observer_job
+*********************************************************************************
+* Summary:
+*   Worker job timing the deliveries, once per period
+*
+*********************************************************************************/
+static uint32_t beacon_observer_job(uint32_t now_ms)
+{
+    int32_t wait_ms = (int32_t)(observer_next_report_ms - now_ms);
+
+    /* The job also runs when the worker is kicked */
+    if (wait_ms > 0)
+    {
+        return (uint32_t)wait_ms;
+    }
+
+    /* Keep the period of the deliveries independent of the slack */
+    observer_next_report_ms += BEACON_OBSERVER_REPORT_PERIOD_MS;
+    if ((int32_t)(observer_next_report_ms - now_ms) <= 0)
+    {
+        observer_next_report_ms = now_ms + BEACON_OBSERVER_REPORT_PERIOD_MS;
+    }
+
+    beacon_manager_defer(beacon_observer_flush);
+
+    return observer_next_report_ms - now_ms;
+}
+
+/********************************************************************************
+* Function Name: beacon_observer_start
+*********************************************************************************
+* Summary:
+*   Starts scanning for beacons. Must be called after BTM_ENABLED_EVT.
+*
+* Parameters:
+*   p_cback:                Callback receiving the aggregated records
+*
+* Return:
+*   wiced_result_t: Result of starting the scan
+*
+*********************************************************************************/
+wiced_result_t beacon_observer_start(beacon_observer_cback_t *p_cback)
+{
+    observer_cback = p_cback;
+
+    if (!observer_started)
+    {
+        observer_started        = WICED_TRUE;
+        observer_next_report_ms = beacon_stats_now_ms() + BEACON_OBSERVER_REPORT_PERIOD_MS;
+        beacon_cache_init(&observer_cache);
+#if BEACON_PROXIMITY_ENABLE
+        beacon_proximity_init();
+#endif
+        beacon_manager_register(BEACON_MANAGER_EVT_SCAN_REPORT, beacon_observer_on_report);
+        beacon_worker_register(beacon_observer_job, BEACON_OBSERVER_REPORT_SLACK_MS);
+    }
+
+    return wiced_bt_ble_observe(WICED_TRUE, 0, beacon_observer_scan_result_cback);
+}
+
+/********************************************************************************
+* Function Name: beacon_observer_stop
+*********************************************************************************
+* Summary:
+*   Stops scanning. Records of the current period are still delivered.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_observer_stop(void)
+{
+    wiced_bt_ble_observe(WICED_FALSE, 0, beacon_observer_scan_result_cback);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,83 @@
+/******************************************************************************
+* File Name: beacon_observer.h
+*
+* Description: This file contains the definitions for the beacon observer. The
+* observer scans for beacons and hands aggregated reports to the application.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_OBSERVER_H__
+#define __BEACON_OBSERVER_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_cache.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to scan for beacons while advertising */
+#ifndef BEACON_OBSERVER_ENABLE
+#define BEACON_OBSERVER_ENABLE           (0)
+#endif
+
+/* Period at which aggregated records are delivered */
+#ifndef BEACON_OBSERVER_REPORT_PERIOD_MS
+#define BEACON_OBSERVER_REPORT_PERIOD_MS (1000)
+#endif
+
+/* Delay a delivery may take to share a wakeup with other periodic work */
+#define BEACON_OBSERVER_REPORT_SLACK_MS  (250)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Called once per period for every beacon reported in that period, in the
+ * beacon manager task */
+typedef void (beacon_observer_cback_t)(const beacon_cache_record_t *p_record);
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+wiced_result_t beacon_observer_start (beacon_observer_cback_t *p_cback);
+
+void           beacon_observer_stop  (void);
+
+#endif      /* __BEACON_OBSERVER_H__ */
+
+
+/* [] END OF FILE */
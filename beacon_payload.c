@@ -0,0 +1,209 @@
+/******************************************************************************
+* File Name: beacon_payload.c
+*
+* Description: This is the source code for the payload triple buffer. The
+* writer fills its own buffer and swaps it with the published one, the
+* reader swaps its own buffer with the published one when that is fresh.
+* Each swap is a single exclusive exchange of the shared index, so neither
+* side locks, both always own a complete buffer, and payloads published
+* before the reader comes around collapse into the latest one.
+*
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "cy_pdl.h"
+#include "beacon_payload.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Layout of the shared word: index of the published buffer, and a flag set
+ * by the writer and cleared by the reader */
+#define PAYLOAD_INDEX_MASK               (0x03UL)
+#define PAYLOAD_FRESH                    (0x04UL)
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_payload_exchange
+*********************************************************************************
+* Summary:
+*   Atomically replaces the shared word and returns its previous value. The
+*   barriers order the buffer contents against the exchange on both sides.
+*
+*********************************************************************************/
+static uint32_t beacon_payload_exchange(volatile uint32_t *p_shared, uint32_t value)
+{
+    uint32_t old;
+
+    __DMB();
+    do
+    {
+        old = __LDREXW(p_shared);
+    } while (0 != __STREXW(value, p_shared));
+    __DMB();
+
+    return old;
+}
+
+/********************************************************************************
+* Function Name: beacon_payload_init
+*********************************************************************************
+* Summary:
+*   Empties a payload. Call before the writer and the reader use it.
+*
+* Parameters:
+*   p_payload:              Payload
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_payload_init(beacon_payload_t *p_payload)
+{
+    memset(p_payload, 0, sizeof(*p_payload));
+    p_payload->write_index = 0;
+    p_payload->shared      = 1;
+    p_payload->read_index  = 2;
+}
+
+/********************************************************************************
+* Function Name: beacon_payload_buffer
+*********************************************************************************
+* Summary:
+*   Writer side. Returns the buffer to fill before beacon_payload_publish.
+*   The buffer stays with the writer until it is published.
+*
+* Parameters:
+*   p_payload:              Payload
+*
+* Return:
+*   Buffer owned by the writer
+*
+*********************************************************************************/
+beacon_payload_buf_t *beacon_payload_buffer(beacon_payload_t *p_payload)
+{
+    return &p_payload->buf[p_payload->write_index];
+}
+
+/********************************************************************************
+* Function Name: beacon_payload_publish
+*********************************************************************************
+* Summary:
+*   Writer side. Publishes the filled buffer and takes back the previously
+*   published one. A payload the reader has not taken yet is superseded.
+*
+* Parameters:
+*   p_payload:              Payload
+*   len:                    Length of the data in the filled buffer
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_payload_publish(beacon_payload_t *p_payload, uint8_t len)
+{
+    beacon_payload_buf_t *p_buf = &p_payload->buf[p_payload->write_index];
+    uint32_t old;
+
+    p_buf->len = len;
+    p_buf->seq = ++p_payload->published;
+
+    old = beacon_payload_exchange(&p_payload->shared, p_payload->write_index | PAYLOAD_FRESH);
+    p_payload->write_index = (uint8_t)(old & PAYLOAD_INDEX_MASK);
+
+    if (0 != (old & PAYLOAD_FRESH))
+    {
+        p_payload->superseded++;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_payload_put
+*********************************************************************************
+* Summary:
+*   Writer side. Copies and publishes a payload.
+*
+* Parameters:
+*   p_payload:              Payload
+*   data:                   Advertisement data
+*   len:                    Length of data, at most BEACON_ADV_DATA_MAX
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_payload_put(beacon_payload_t *p_payload, const uint8_t *data, uint8_t len)
+{
+    memcpy(beacon_payload_buffer(p_payload)->data, data, len);
+    beacon_payload_publish(p_payload, len);
+}
+
+/********************************************************************************
+* Function Name: beacon_payload_take
+*********************************************************************************
+* Summary:
+*   Reader side. Takes the latest published payload. The returned buffer
+*   stays valid and unchanged until the next call.
+*
+* Parameters:
+*   p_payload:              Payload
+*
+* Return:
+*   Latest payload, or NULL if nothing was published since the last call
+*
+*********************************************************************************/
+const beacon_payload_buf_t *beacon_payload_take(beacon_payload_t *p_payload)
+{
+    uint32_t old;
+
+    if (0 == (p_payload->shared & PAYLOAD_FRESH))
+    {
+        return NULL;
+    }
+
+    old = beacon_payload_exchange(&p_payload->shared, p_payload->read_index);
+    p_payload->read_index = (uint8_t)(old & PAYLOAD_INDEX_MASK);
+    p_payload->taken++;
+
+    return &p_payload->buf[p_payload->read_index];
+}
+
+/* [] END OF FILE */
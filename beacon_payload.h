@@ -0,0 +1,100 @@
+/******************************************************************************
+* File Name: beacon_payload.h
+*
+* Description: This file contains the definitions for the payload triple
+* buffer. A writer task publishes complete advertisement payloads that a
+* reader, usually the beacon manager, takes without either side waiting.
+*
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_PAYLOAD_H__
+#define __BEACON_PAYLOAD_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* The writer, the reader and the published payload own one buffer each */
+#define BEACON_PAYLOAD_BUFFERS           (3)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* One payload */
+typedef struct
+{
+    uint32_t seq;                               /* Publish number, from 1 */
+    uint32_t tag;                               /* Writer defined, such as the
+                                                   configuration the data was built from */
+    uint8_t len;                                /* Length of data */
+    uint8_t data[BEACON_ADV_DATA_MAX];          /* Advertisement data */
+}beacon_payload_buf_t;
+
+/* Payload handed from one writer to one reader */
+typedef struct
+{
+    beacon_payload_buf_t buf[BEACON_PAYLOAD_BUFFERS];
+    volatile uint32_t shared;                   /* Published buffer and fresh flag */
+    uint8_t write_index;                        /* Buffer owned by the writer */
+    uint8_t read_index;                         /* Buffer owned by the reader */
+    uint32_t published;                         /* Writer: payloads published */
+    uint32_t superseded;                        /* Writer: replaced before taken */
+    uint32_t taken;                             /* Reader: payloads taken */
+}beacon_payload_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                        beacon_payload_init    (beacon_payload_t *p_payload);
+
+beacon_payload_buf_t       *beacon_payload_buffer  (beacon_payload_t *p_payload);
+
+void                        beacon_payload_publish (beacon_payload_t *p_payload, uint8_t len);
+
+void                        beacon_payload_put     (beacon_payload_t *p_payload,
+                                                    const uint8_t *data, uint8_t len);
+
+const beacon_payload_buf_t *beacon_payload_take    (beacon_payload_t *p_payload);
+
+#endif      /* __BEACON_PAYLOAD_H__ */
+
+
+/* [] END OF FILE */
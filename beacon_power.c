@@ -0,0 +1,329 @@
+/******************************************************************************
+* File Name: beacon_power.c
+*
+* Description: This is the source code for the Tx power control. The range
+* of an index follows from the log-distance path loss model: a scanner at
+* range d receives the RSSI at 1 m minus 10 n log10(d). The advertised
+* measured power (iBeacon 1 m, Eddystone 0 m) is taken from the same
+* calibration table, so distance estimates stay correct at every index.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "wiced_bt_stack.h"
+#include "beacon_power.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#if (BEACON_POWER_LEVELS != 5)
+#error "power_cal must hold one entry per Tx power index"
+#endif
+
+/* Ranges are compared in centimeters from 1 m */
+#define POWER_CM_PER_M                   (100)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Sample calibration. Measure the RSSI at 1 m of every index with the
+ * antenna and enclosure of the product and replace these values. */
+static const beacon_power_cal_t power_cal[BEACON_POWER_LEVELS] =
+{
+    { -20, -79 },
+    { -12, -71 },
+    {  -6, -65 },
+    {   0, -59 },
+    {   4, -55 },
+};
+
+/* 10 log10(m) in tenths of a dB for m = 0 to 10 */
+static const uint8_t power_log_db10[] = { 0, 0, 30, 48, 60, 70, 78, 85, 90, 95, 100 };
+
+/* Target range per instance in centimeters, 0 if the power is not managed */
+static uint32_t power_range_cm[BEACON_SLOT_MAX_INSTANCES];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_power_log_db10
+*********************************************************************************
+* Summary:
+*   Returns 10 log10 of a range in meters, in tenths of a dB. Decades are
+*   counted exactly and the rest is interpolated, within 0.3 dB.
+*
+*********************************************************************************/
+static uint32_t beacon_power_log_db10(uint32_t range_cm)
+{
+    uint32_t db10 = 0;
+    uint32_t m;
+    uint32_t frac;
+
+    if (range_cm < POWER_CM_PER_M)
+    {
+        return 0;
+    }
+
+    while (range_cm >= (10 * POWER_CM_PER_M))
+    {
+        range_cm /= 10;
+        db10     += 100;
+    }
+
+    m    = range_cm / POWER_CM_PER_M;
+    frac = range_cm % POWER_CM_PER_M;
+
+    return db10 + power_log_db10[m] +
+           ((power_log_db10[m + 1] - power_log_db10[m]) * frac) / POWER_CM_PER_M;
+}
+
+/********************************************************************************
+* Function Name: beacon_power_select
+*********************************************************************************
+* Summary:
+*   Selects the lowest Tx power index whose signal is still received with
+*   BEACON_POWER_EDGE_RSSI_DBM at the given range
+*
+* Parameters:
+*   range_cm:               Target range in centimeters
+*
+* Return:
+*   Tx power index, the highest one if no index reaches the range
+*
+*********************************************************************************/
+wiced_bt_ble_adv_tx_power_t beacon_power_select(uint32_t range_cm)
+{
+    /* RSSI at 1 m needed at the range, in tenths of a dB */
+    int32_t needed = (BEACON_POWER_EDGE_RSSI_DBM * 10) +
+                     (int32_t)((BEACON_POWER_PATH_LOSS_X10 * beacon_power_log_db10(range_cm)) / 10);
+
+    for (uint8_t i = 0; i < BEACON_POWER_LEVELS; i++)
+    {
+        if ((power_cal[i].rssi_1m_dbm * 10) >= needed)
+        {
+            return (wiced_bt_ble_adv_tx_power_t)(MULTI_ADV_TX_POWER_MIN_INDEX + i);
+        }
+    }
+    return MULTI_ADV_TX_POWER_MAX_INDEX;
+}
+
+/********************************************************************************
+* Function Name: beacon_power_get_cal
+*********************************************************************************
+* Summary:
+*   Returns the calibration of a Tx power index
+*
+* Parameters:
+*   index:                  Tx power index
+*
+* Return:
+*   Calibration entry, NULL if the index is out of range
+*
+*********************************************************************************/
+const beacon_power_cal_t *beacon_power_get_cal(wiced_bt_ble_adv_tx_power_t index)
+{
+    if ((index < MULTI_ADV_TX_POWER_MIN_INDEX) || (index > MULTI_ADV_TX_POWER_MAX_INDEX))
+    {
+        return NULL;
+    }
+    return &power_cal[index - MULTI_ADV_TX_POWER_MIN_INDEX];
+}
+
+/********************************************************************************
+* Function Name: beacon_power_measured
+*********************************************************************************
+* Summary:
+*   Returns the measured power a format advertises for a Tx power index
+*
+* Parameters:
+*   index:                  Tx power index
+*   format:                 BEACON_FORMAT_IBEACON for the power at 1 m, an
+*                           Eddystone format for the power at 0 m
+*
+* Return:
+*   Measured power in dBm
+*
+*********************************************************************************/
+int8_t beacon_power_measured(wiced_bt_ble_adv_tx_power_t index, beacon_format_t format)
+{
+    const beacon_power_cal_t *p_cal = beacon_power_get_cal(index);
+    int8_t rssi_1m = (NULL != p_cal) ? p_cal->rssi_1m_dbm : (int8_t)TX_POWER_LEVEL;
+
+    if (BEACON_FORMAT_IBEACON == format)
+    {
+        return rssi_1m;
+    }
+    return (int8_t)(rssi_1m + BEACON_POWER_EDDYSTONE_0M_DB);
+}
+
+/********************************************************************************
+* Function Name: beacon_power_patch
+*********************************************************************************
+* Summary:
+*   Writes the measured power of a Tx power index into an iBeacon or
+*   Eddystone advertisement. Other advertisements are left unchanged.
+*
+* Parameters:
+*   adv_data:               Advertisement data, modified
+*   adv_len:                Length of adv_data
+*   index:                  Tx power index
+*
+* Return:
+*   WICED_TRUE if the advertisement changed
+*
+*********************************************************************************/
+wiced_bool_t beacon_power_patch(uint8_t *adv_data, uint8_t adv_len,
+                                wiced_bt_ble_adv_tx_power_t index)
+{
+    beacon_frame_info_t info;
+    uint8_t measured;
+
+    if (!beacon_parse_adv_data(adv_data, adv_len, &info) || (0 == info.measured_power_offset))
+    {
+        return WICED_FALSE;
+    }
+
+    measured = (uint8_t)beacon_power_measured(index, info.format);
+    if (adv_data[info.measured_power_offset] == measured)
+    {
+        return WICED_FALSE;
+    }
+
+    adv_data[info.measured_power_offset] = measured;
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_power_fix_data
+*********************************************************************************
+* Summary:
+*   Makes the measured power of an advertisement match the Tx power of the
+*   slot, if the slot has a target range. Call before submitting data that
+*   was encoded without knowing the power, such as a format.
+*
+* Parameters:
+*   p_slot:                 Slot the data is submitted to
+*   adv_data:               Advertisement data, modified
+*   adv_len:                Length of adv_data
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_power_fix_data(const beacon_slot_t *p_slot, uint8_t *adv_data, uint8_t adv_len)
+{
+    if (0 != power_range_cm[p_slot->instance - 1])
+    {
+        beacon_power_patch(adv_data, adv_len, p_slot->params.adv_tx_power);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_power_set_range
+*********************************************************************************
+* Summary:
+*   Sets the target range of a slot. If another Tx power index is needed, a
+*   params update is issued; the data is only updated when the advertised
+*   measured power changes with it. The instance keeps advertising.
+*   Call in the beacon manager task.
+*
+* Parameters:
+*   p_slot:                 Slot
+*   range_cm:               Target range in centimeters, 0 to stop managing
+*                           the power of the slot
+*
+* Return:
+*   WICED_BT_PENDING if commands were issued, WICED_BT_SUCCESS if nothing
+*   had to change, otherwise the error of the slot call
+*
+*********************************************************************************/
+wiced_result_t beacon_power_set_range(beacon_slot_t *p_slot, uint32_t range_cm)
+{
+    wiced_bt_ble_multi_adv_params_t params;
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    wiced_bt_ble_adv_tx_power_t index = beacon_power_select(range_cm);
+    wiced_result_t result = WICED_BT_SUCCESS;
+
+    power_range_cm[p_slot->instance - 1] = range_cm;
+
+    /* Instances not configured yet pick the power up with their first params */
+    if ((0 == range_cm) || (0 == p_slot->params.adv_int_min))
+    {
+        return WICED_BT_SUCCESS;
+    }
+
+    if (index != p_slot->params.adv_tx_power)
+    {
+        params              = p_slot->params;
+        params.adv_tx_power = index;
+        result = beacon_slot_set_params(p_slot, &params);
+        if (WICED_BT_PENDING != result)
+        {
+            return result;
+        }
+    }
+
+    memcpy(adv_data, p_slot->adv_data, p_slot->adv_len);
+    if (beacon_power_patch(adv_data, p_slot->adv_len, index))
+    {
+        result = beacon_slot_set_data(p_slot, adv_data, p_slot->adv_len);
+    }
+
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_power_get_range
+*********************************************************************************
+* Summary:
+*   Returns the target range of a slot
+*
+* Parameters:
+*   p_slot:                 Slot
+*
+* Return:
+*   Target range in centimeters, 0 if the power is not managed
+*
+*********************************************************************************/
+uint32_t beacon_power_get_range(const beacon_slot_t *p_slot)
+{
+    return power_range_cm[p_slot->instance - 1];
+}
+
+/* [] END OF FILE */
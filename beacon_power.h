@@ -0,0 +1,106 @@
+/******************************************************************************
+* File Name: beacon_power.h
+*
+* Description: This file contains the definitions for the Tx power control.
+* Each advertising instance can be given a target range, and the lowest Tx
+* power index that reaches it is selected from a calibration table.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_POWER_H__
+#define __BEACON_POWER_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Number of Tx power indexes of the multi-advertising commands */
+#define BEACON_POWER_LEVELS              (MULTI_ADV_TX_POWER_MAX_INDEX - \
+                                          MULTI_ADV_TX_POWER_MIN_INDEX + 1)
+
+/* Path loss exponent in tenths, 20 in free space, 25 to 30 indoors */
+#ifndef BEACON_POWER_PATH_LOSS_X10
+#define BEACON_POWER_PATH_LOSS_X10       (25)
+#endif
+
+/* Weakest RSSI a scanner at the edge of the range must still receive,
+ * the scanner sensitivity plus a fading margin */
+#ifndef BEACON_POWER_EDGE_RSSI_DBM
+#define BEACON_POWER_EDGE_RSSI_DBM       (-90)
+#endif
+
+/* Eddystone advertises the power at 0 m, 41 dB above the power at 1 m */
+#define BEACON_POWER_EDDYSTONE_0M_DB     (41)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Calibration of one Tx power index */
+typedef struct
+{
+    int8_t tx_dbm;                              /* Conducted output power */
+    int8_t rssi_1m_dbm;                         /* RSSI measured at 1 m */
+}beacon_power_cal_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+wiced_bt_ble_adv_tx_power_t beacon_power_select       (uint32_t range_cm);
+
+int8_t                      beacon_power_measured     (wiced_bt_ble_adv_tx_power_t index,
+                                                       beacon_format_t format);
+
+const beacon_power_cal_t   *beacon_power_get_cal      (wiced_bt_ble_adv_tx_power_t index);
+
+wiced_bool_t                beacon_power_patch        (uint8_t *adv_data, uint8_t adv_len,
+                                                       wiced_bt_ble_adv_tx_power_t index);
+
+void                        beacon_power_fix_data     (const beacon_slot_t *p_slot,
+                                                       uint8_t *adv_data, uint8_t adv_len);
+
+wiced_result_t              beacon_power_set_range    (beacon_slot_t *p_slot, uint32_t range_cm);
+
+uint32_t                    beacon_power_get_range    (const beacon_slot_t *p_slot);
+
+#endif      /* __BEACON_POWER_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,443 @@
+/******************************************************************************
+* File Name: beacon_prov.c
+*
+* Description: This is the source code for bulk provisioning over the debug
+* UART. The receiver is go-back-N: frames are accepted in sequence only, one
+* cumulative ACK covers every frame accepted while input was waiting, and a
+* gap is answered with a single NAK carrying the sequence number to resend
+* from. Records are staged in RAM and written to flash once, on COMMIT.
+*
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "wiced_bt_stack.h"
+#include "beacon_manager.h"
+#include "beacon_prov.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Sequence numbers further ahead than this are behind, that is duplicates */
+#define PROV_SEQ_AHEAD_MAX               (0x7F)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Frame parser state */
+typedef enum
+{
+    PROV_RX_SOF,                                /* Hunting for the start byte */
+    PROV_RX_LEN,                                /* Expecting the payload length */
+    PROV_RX_BODY                                /* Collecting type to CRC */
+}prov_rx_state_t;
+
+/* Session state */
+typedef enum
+{
+    PROV_SESSION_WAIT,                          /* Waiting for BEGIN */
+    PROV_SESSION_OPEN,                          /* Records are staged */
+    PROV_SESSION_CLOSED                         /* Committed or aborted */
+}prov_session_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_prov_send_t   *prov_send;
+static prov_session_t        prov_session;
+static beacon_prov_status_t  prov_status;
+static beacon_prov_stats_t   prov_stats;
+
+static prov_rx_state_t       prov_rx_state;
+static uint8_t               prov_frame[BEACON_PROV_FRAME_MAX];
+static uint8_t               prov_frame_len;    /* Bytes received, SOF excluded */
+static uint8_t               prov_frame_total;  /* Bytes expected, SOF excluded */
+
+static uint8_t               prov_expected;     /* Next sequence number */
+static uint8_t               prov_ack_due;      /* Frames accepted since the last ACK */
+static wiced_bool_t          prov_nak_sent;     /* NAK sent for the current gap */
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_prov_reply
+*********************************************************************************
+* Summary:
+*   Sends an ACK or NAK with the next expected sequence number
+*
+*********************************************************************************/
+static void beacon_prov_reply(uint8_t type)
+{
+    uint8_t frame[BEACON_PROV_HEADER_LEN + 2 + BEACON_PROV_CRC_LEN];
+    uint16_t crc;
+
+    frame[0] = BEACON_PROV_SOF;
+    frame[1] = 2;
+    frame[2] = type;
+    frame[3] = 0;
+    frame[4] = prov_expected;
+    frame[5] = (uint8_t)prov_status;
+    crc      = beacon_crc16(&frame[1], 5, 0xFFFF);
+    frame[6] = (uint8_t)crc;
+    frame[7] = (uint8_t)(crc >> 8);
+
+    prov_send(frame, sizeof(frame));
+
+    if (BEACON_PROV_TYPE_ACK == type)
+    {
+        prov_ack_due = 0;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_prov_apply
+*********************************************************************************
+* Summary:
+*   Applies the committed store to the slots, deferred to the beacon manager
+*   task
+*
+*********************************************************************************/
+static void beacon_prov_apply(void)
+{
+    beacon_store_apply();
+}
+
+/********************************************************************************
+* Function Name: beacon_prov_record
+*********************************************************************************
+* Summary:
+*   Stages a SLOT or KEY record
+*
+*********************************************************************************/
+static beacon_prov_status_t beacon_prov_record(uint8_t type, const uint8_t *p, uint8_t len)
+{
+    beacon_store_slot_t slot;
+
+    if (BEACON_PROV_TYPE_KEY == type)
+    {
+        if ((1 + BEACON_STORE_KEY_LEN) != len)
+        {
+            return BEACON_PROV_STATUS_BAD_RECORD;
+        }
+        return beacon_store_stage_key(p[0], &p[1]) ? BEACON_PROV_STATUS_OK :
+                                                      BEACON_PROV_STATUS_FULL;
+    }
+
+    if ((len < BEACON_PROV_SLOT_HEADER_LEN) ||
+        ((len - BEACON_PROV_SLOT_HEADER_LEN) > BEACON_ADV_DATA_MAX))
+    {
+        return BEACON_PROV_STATUS_BAD_RECORD;
+    }
+
+    memset(&slot, 0, sizeof(slot));
+    slot.instance    = p[0];
+    slot.adv_int_min = (uint16_t)(p[1] | (p[2] << 8));
+    slot.adv_int_max = (uint16_t)(p[3] | (p[4] << 8));
+    slot.tx_power    = p[5];
+    slot.adv_len     = len - BEACON_PROV_SLOT_HEADER_LEN;
+    memcpy(slot.adv_data, &p[BEACON_PROV_SLOT_HEADER_LEN], slot.adv_len);
+
+    return beacon_store_stage_slot(&slot) ? BEACON_PROV_STATUS_OK :
+                                            BEACON_PROV_STATUS_BAD_RECORD;
+}
+
+/********************************************************************************
+* Function Name: beacon_prov_frame
+*********************************************************************************
+* Summary:
+*   Handles a frame that passed the CRC check
+*
+*********************************************************************************/
+static void beacon_prov_frame(uint8_t type, uint8_t seq, const uint8_t *p, uint8_t len)
+{
+    uint8_t ahead = (uint8_t)(seq - prov_expected);
+
+    if (BEACON_PROV_TYPE_BEGIN == type)
+    {
+        /* The sender waits for this ACK before streaming, so a repeated
+         * BEGIN never discards records */
+        beacon_store_stage();
+        prov_session  = PROV_SESSION_OPEN;
+        prov_status   = BEACON_PROV_STATUS_OK;
+        prov_expected = seq + 1;
+        prov_nak_sent = WICED_FALSE;
+        prov_stats.sessions++;
+        beacon_prov_reply(BEACON_PROV_TYPE_ACK);
+        return;
+    }
+
+    if (PROV_SESSION_WAIT == prov_session)
+    {
+        return;
+    }
+
+    if (0 != ahead)
+    {
+        if (ahead > PROV_SEQ_AHEAD_MAX)
+        {
+            /* Its ACK was lost, repeat it */
+            prov_stats.duplicates++;
+            beacon_prov_reply(BEACON_PROV_TYPE_ACK);
+        }
+        else
+        {
+            prov_stats.out_of_order++;
+            if (!prov_nak_sent)
+            {
+                prov_nak_sent = WICED_TRUE;
+                beacon_prov_reply(BEACON_PROV_TYPE_NAK);
+            }
+        }
+        return;
+    }
+
+    if (PROV_SESSION_CLOSED == prov_session)
+    {
+        return;
+    }
+
+    prov_expected++;
+    prov_nak_sent = WICED_FALSE;
+    prov_ack_due++;
+
+    switch (type)
+    {
+    case BEACON_PROV_TYPE_SLOT:
+    case BEACON_PROV_TYPE_KEY:
+        if (BEACON_PROV_STATUS_OK == prov_status)
+        {
+            prov_status = beacon_prov_record(type, p, len);
+        }
+        prov_stats.records++;
+        break;
+
+    case BEACON_PROV_TYPE_COMMIT:
+        if (BEACON_PROV_STATUS_OK == prov_status)
+        {
+            if (WICED_BT_SUCCESS == beacon_store_commit())
+            {
+                prov_stats.commits++;
+                beacon_manager_defer(beacon_prov_apply);
+            }
+            else
+            {
+                prov_status = BEACON_PROV_STATUS_STORE;
+            }
+        }
+        if (BEACON_PROV_STATUS_OK != prov_status)
+        {
+            prov_stats.discarded++;
+        }
+        prov_session = PROV_SESSION_CLOSED;
+        beacon_prov_reply(BEACON_PROV_TYPE_ACK);
+        break;
+
+    case BEACON_PROV_TYPE_ABORT:
+        prov_stats.discarded++;
+        prov_session = PROV_SESSION_CLOSED;
+        beacon_prov_reply(BEACON_PROV_TYPE_ACK);
+        break;
+
+    default:
+        prov_status = BEACON_PROV_STATUS_BAD_RECORD;
+        break;
+    }
+
+    if (prov_ack_due >= BEACON_PROV_ACK_EVERY)
+    {
+        beacon_prov_reply(BEACON_PROV_TYPE_ACK);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_prov_begin
+*********************************************************************************
+* Summary:
+*   Starts waiting for a session. Every received character is then passed to
+*   beacon_prov_input until beacon_prov_end is called.
+*
+* Parameters:
+*   p_send:                 Writes the ACK and NAK frames
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_prov_begin(beacon_prov_send_t *p_send)
+{
+    prov_send     = p_send;
+    prov_session  = PROV_SESSION_WAIT;
+    prov_status   = BEACON_PROV_STATUS_OK;
+    prov_rx_state = PROV_RX_SOF;
+    prov_ack_due  = 0;
+    prov_nak_sent = WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_prov_input
+*********************************************************************************
+* Summary:
+*   Feeds a received character to the frame parser. Characters outside of a
+*   frame are skipped, a bad frame is dropped and answered with a NAK.
+*
+* Parameters:
+*   c:                      Received character
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_prov_input(uint8_t c)
+{
+    uint16_t crc;
+
+    switch (prov_rx_state)
+    {
+    case PROV_RX_SOF:
+        if (BEACON_PROV_SOF == c)
+        {
+            prov_rx_state = PROV_RX_LEN;
+        }
+        break;
+
+    case PROV_RX_LEN:
+        if (c > BEACON_PROV_PAYLOAD_MAX)
+        {
+            prov_rx_state = (BEACON_PROV_SOF == c) ? PROV_RX_LEN : PROV_RX_SOF;
+            break;
+        }
+        prov_frame[0]    = c;
+        prov_frame_len   = 1;
+        prov_frame_total = c + BEACON_PROV_HEADER_LEN - 1 + BEACON_PROV_CRC_LEN;
+        prov_rx_state    = PROV_RX_BODY;
+        break;
+
+    default:
+        prov_frame[prov_frame_len++] = c;
+        if (prov_frame_len < prov_frame_total)
+        {
+            break;
+        }
+        prov_rx_state = PROV_RX_SOF;
+
+        crc = beacon_crc16(prov_frame, prov_frame_total - BEACON_PROV_CRC_LEN, 0xFFFF);
+        if ((prov_frame[prov_frame_total - 2] != (uint8_t)crc) ||
+            (prov_frame[prov_frame_total - 1] != (uint8_t)(crc >> 8)))
+        {
+            prov_stats.crc_errors++;
+            if ((PROV_SESSION_OPEN == prov_session) && !prov_nak_sent)
+            {
+                prov_nak_sent = WICED_TRUE;
+                beacon_prov_reply(BEACON_PROV_TYPE_NAK);
+            }
+            break;
+        }
+
+        beacon_prov_frame(prov_frame[1], prov_frame[2], &prov_frame[3], prov_frame[0]);
+        break;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_prov_idle
+*********************************************************************************
+* Summary:
+*   Call when no more input is waiting. Acknowledges the frames accepted since
+*   the last ACK.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Time to wait for input before calling beacon_prov_end, in milliseconds
+*
+*********************************************************************************/
+uint32_t beacon_prov_idle(void)
+{
+    if (0 != prov_ack_due)
+    {
+        beacon_prov_reply(BEACON_PROV_TYPE_ACK);
+    }
+    return (PROV_SESSION_CLOSED == prov_session) ? BEACON_PROV_LINGER_MS :
+                                                   BEACON_PROV_TIMEOUT_MS;
+}
+
+/********************************************************************************
+* Function Name: beacon_prov_end
+*********************************************************************************
+* Summary:
+*   Ends the session. Records of a session that was not committed are
+*   discarded.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_prov_end(void)
+{
+    if (PROV_SESSION_OPEN == prov_session)
+    {
+        prov_stats.discarded++;
+    }
+    prov_session  = PROV_SESSION_WAIT;
+    prov_rx_state = PROV_RX_SOF;
+}
+
+/********************************************************************************
+* Function Name: beacon_prov_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the provisioning counters
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Pointer to the counters
+*
+*********************************************************************************/
+const beacon_prov_stats_t *beacon_prov_get_stats(void)
+{
+    return &prov_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,140 @@
+/******************************************************************************
+* File Name: beacon_prov.h
+*
+* Description: This file contains the definitions for bulk provisioning over
+* the debug UART. Frames carry slot configurations and keys into the
+* persistent store and are acknowledged with a sliding window.
+*
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_PROV_H__
+#define __BEACON_PROV_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_store.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to add the prov console command, requires BEACON_CONSOLE_ENABLE */
+#ifndef BEACON_PROV_ENABLE
+#define BEACON_PROV_ENABLE               (0)
+#endif
+
+/* Frame layout: SOF, payload length, type, sequence number, payload and the
+ * CRC-16 of length to payload, least significant byte first */
+#define BEACON_PROV_SOF                  (0xA5)
+#define BEACON_PROV_HEADER_LEN           (4)
+#define BEACON_PROV_CRC_LEN              (2)
+#define BEACON_PROV_PAYLOAD_MAX          (48)
+#define BEACON_PROV_FRAME_MAX            (BEACON_PROV_HEADER_LEN + BEACON_PROV_PAYLOAD_MAX + \
+                                          BEACON_PROV_CRC_LEN)
+
+/* Frames the sender may have unacknowledged. The receive buffer of the
+ * console holds a full window, so the sender never waits on the device. */
+#define BEACON_PROV_WINDOW               (8)
+
+/* Accepted frames acknowledged together while more input is waiting */
+#define BEACON_PROV_ACK_EVERY            (BEACON_PROV_WINDOW / 2)
+
+/* Silence that ends an open session, and a closed session that is kept to
+ * answer retransmissions of its last frame */
+#define BEACON_PROV_TIMEOUT_MS           (5000)
+#define BEACON_PROV_LINGER_MS            (500)
+
+/* Frame types sent to the device */
+#define BEACON_PROV_TYPE_BEGIN           (0x01)   /* Opens the session, no payload */
+#define BEACON_PROV_TYPE_SLOT            (0x02)   /* Instance, interval min and max (LE),
+                                                     Tx power, adv data */
+#define BEACON_PROV_TYPE_KEY             (0x03)   /* Key number, key */
+#define BEACON_PROV_TYPE_COMMIT          (0x04)   /* Writes the store, no payload */
+#define BEACON_PROV_TYPE_ABORT           (0x05)   /* Discards the session, no payload */
+
+/* Frame types sent by the device, the payload is the next expected sequence
+ * number and the session status */
+#define BEACON_PROV_TYPE_ACK             (0x80)   /* Every frame before it was accepted */
+#define BEACON_PROV_TYPE_NAK             (0x81)   /* Resend from the sequence number */
+
+/* Length of the fixed part of a SLOT payload */
+#define BEACON_PROV_SLOT_HEADER_LEN      (6)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Session status, sticky until the next BEGIN */
+typedef enum
+{
+    BEACON_PROV_STATUS_OK,
+    BEACON_PROV_STATUS_BAD_RECORD,              /* Malformed or invalid record */
+    BEACON_PROV_STATUS_FULL,                    /* No key entry left */
+    BEACON_PROV_STATUS_STORE                    /* Flash write failed */
+}beacon_prov_status_t;
+
+/* Writes a frame to the UART */
+typedef void (beacon_prov_send_t)(const uint8_t *data, uint32_t len);
+
+/* Provisioning counters */
+typedef struct
+{
+    uint32_t sessions;                          /* BEGIN frames */
+    uint32_t commits;                           /* Sessions written to the store */
+    uint32_t discarded;                         /* Sessions aborted or timed out */
+    uint32_t records;                           /* SLOT and KEY frames accepted */
+    uint32_t crc_errors;                        /* Frames dropped by the CRC */
+    uint32_t out_of_order;                      /* Frames after a lost frame */
+    uint32_t duplicates;                        /* Retransmitted frames */
+}beacon_prov_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                       beacon_prov_begin     (beacon_prov_send_t *p_send);
+
+void                       beacon_prov_input     (uint8_t c);
+
+uint32_t                   beacon_prov_idle      (void);
+
+void                       beacon_prov_end       (void);
+
+const beacon_prov_stats_t *beacon_prov_get_stats (void);
+
+#endif      /* __BEACON_PROV_H__ */
+
+
+/* [] END OF FILE */
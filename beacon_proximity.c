@@ -0,0 +1,349 @@
+/******************************************************************************
+* File Name: beacon_proximity.c
+*
+* Description: This is the source code for the proximity estimator of the
+* observed beacons. The path loss of every beacon is smoothed by a scalar
+* Kalman filter in fixed point and mapped to a zone; the distance is only
+* computed from a lookup table when a record is read.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include "beacon_proximity.h"
+#include "beacon_power.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* RSSI reported when the controller has no measurement */
+#define PROX_RSSI_UNAVAILABLE            (127)
+
+/* Path loss is clamped so that its Q8 value fits an int16_t */
+#define PROX_LOSS_MAX_DB                 (120)
+
+/* Longer gaps add no more uncertainty, the estimate is then as good as new */
+#define PROX_MAX_GAP_MS                  (10000UL)
+
+/* Kalman gain in Q15, so that the correction fits an int32_t */
+#define PROX_GAIN_BITS                   (15)
+
+/* Distance exponent in Q12 decades, 1 cm to 1 km */
+#define PROX_DECADE_BITS                 (12)
+#define PROX_DECADE_MIN                  (-(2 << PROX_DECADE_BITS))
+#define PROX_DECADE_MAX                  (3 << PROX_DECADE_BITS)
+
+/* Measurement and process noise in Q8 dB^2 */
+#define PROX_RSSI_VAR_Q8                 ((BEACON_PROXIMITY_RSSI_NOISE_DB * \
+                                           BEACON_PROXIMITY_RSSI_NOISE_DB) << \
+                                          BEACON_PROXIMITY_FRAC_BITS)
+#define PROX_DRIFT_VAR_Q8                ((BEACON_PROXIMITY_DRIFT_DB * \
+                                           BEACON_PROXIMITY_DRIFT_DB) << \
+                                          BEACON_PROXIMITY_FRAC_BITS)
+
+#if ((PROX_RSSI_VAR_Q8 == 0) || (PROX_RSSI_VAR_Q8 > 0xFFFF))
+#error "BEACON_PROXIMITY_RSSI_NOISE_DB must be 1 to 15"
+#endif
+
+#if (BEACON_PROXIMITY_IMMEDIATE_CM >= BEACON_PROXIMITY_NEAR_CM)
+#error "The immediate zone must end before the near zone"
+#endif
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* 10^(k/16) in thousandths for k = 0 to 16 */
+static const uint16_t prox_exp_lut[] =
+{
+    1000, 1155, 1334, 1540, 1778, 2054, 2371, 2738, 3162,
+    3652, 4217, 4870, 5623, 6494, 7499, 8660, 10000,
+};
+
+/* 10^(i - 2) m in thousandths of a centimeter */
+static const uint32_t prox_decade_scale[] = { 1, 10, 100, 1000, 10000 };
+
+/* Path loss at the outer bound of the immediate and the near zone */
+static int32_t prox_bound_q8[2];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_proximity_loss_to_cm
+*********************************************************************************
+* Summary:
+*   Returns the distance at which the path loss beyond 1 m is reached,
+*   10^(loss / (10 n)) m. The decade is exact and the mantissa is interpolated
+*   in a table of 16 steps per decade, within 0.3% before the rounding to
+*   a centimeter.
+*
+*********************************************************************************/
+static uint32_t beacon_proximity_loss_to_cm(int32_t loss_q8)
+{
+    int32_t decades = (loss_q8 * (1 << (PROX_DECADE_BITS - BEACON_PROXIMITY_FRAC_BITS))) /
+                      BEACON_POWER_PATH_LOSS_X10;
+    uint32_t offset;
+    uint32_t step;
+    uint32_t frac;
+    uint32_t mant;
+
+    if (decades < PROX_DECADE_MIN)
+    {
+        decades = PROX_DECADE_MIN;
+    }
+    if (decades >= PROX_DECADE_MAX)
+    {
+        decades = PROX_DECADE_MAX - 1;
+    }
+
+    offset = (uint32_t)(decades - PROX_DECADE_MIN);
+    step   = (offset >> (PROX_DECADE_BITS - 4)) & 0x0F;
+    frac   = offset & ((1UL << (PROX_DECADE_BITS - 4)) - 1);
+    mant   = prox_exp_lut[step] +
+             (((prox_exp_lut[step + 1] - prox_exp_lut[step]) * frac) >> (PROX_DECADE_BITS - 4));
+
+    return (mant * prox_decade_scale[offset >> PROX_DECADE_BITS] + 500) / 1000;
+}
+
+/********************************************************************************
+* Function Name: beacon_proximity_cm_to_loss
+*********************************************************************************
+* Summary:
+*   Returns the smallest path loss whose distance reaches the given one, the
+*   inverse of beacon_proximity_loss_to_cm. Only used to place the zone bounds.
+*
+*********************************************************************************/
+static int32_t beacon_proximity_cm_to_loss(uint32_t range_cm)
+{
+    int32_t low  = -(PROX_LOSS_MAX_DB << BEACON_PROXIMITY_FRAC_BITS);
+    int32_t high = PROX_LOSS_MAX_DB << BEACON_PROXIMITY_FRAC_BITS;
+    int32_t mid;
+
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        if (beacon_proximity_loss_to_cm(mid) >= range_cm)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+/********************************************************************************
+* Function Name: beacon_proximity_zone
+*********************************************************************************
+* Summary:
+*   Moves the zone across a bound only when the path loss is more than
+*   BEACON_PROXIMITY_HYSTERESIS_DB past it, so that a beacon sitting on a
+*   bound does not toggle between two zones
+*
+*********************************************************************************/
+static uint8_t beacon_proximity_zone(uint8_t zone, int32_t loss_q8)
+{
+    int32_t margin = BEACON_PROXIMITY_HYSTERESIS_DB << BEACON_PROXIMITY_FRAC_BITS;
+
+    if (BEACON_PROXIMITY_UNKNOWN == zone)
+    {
+        zone   = BEACON_PROXIMITY_IMMEDIATE;
+        margin = 0;
+    }
+
+    while ((zone > BEACON_PROXIMITY_IMMEDIATE) &&
+           (loss_q8 < (prox_bound_q8[zone - BEACON_PROXIMITY_NEAR] - margin)))
+    {
+        zone--;
+    }
+    while ((zone < BEACON_PROXIMITY_FAR) &&
+           (loss_q8 >= (prox_bound_q8[zone - BEACON_PROXIMITY_IMMEDIATE] + margin)))
+    {
+        zone++;
+    }
+    return zone;
+}
+
+/********************************************************************************
+* Function Name: beacon_proximity_init
+*********************************************************************************
+* Summary:
+*   Places the zone bounds for the configured path loss exponent. Must be
+*   called before the first update.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_proximity_init(void)
+{
+    prox_bound_q8[0] = beacon_proximity_cm_to_loss(BEACON_PROXIMITY_IMMEDIATE_CM);
+    prox_bound_q8[1] = beacon_proximity_cm_to_loss(BEACON_PROXIMITY_NEAR_CM);
+}
+
+/********************************************************************************
+* Function Name: beacon_proximity_reset
+*********************************************************************************
+* Summary:
+*   Clears the filter state of a beacon, the next sample starts it again
+*
+* Parameters:
+*   p_prox:                 Filter state
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_proximity_reset(beacon_proximity_t *p_prox)
+{
+    p_prox->loss_q8   = 0;
+    p_prox->var_q8    = 0;
+    p_prox->update_ms = 0;
+    p_prox->zone      = BEACON_PROXIMITY_UNKNOWN;
+}
+
+/********************************************************************************
+* Function Name: beacon_proximity_update
+*********************************************************************************
+* Summary:
+*   Accounts one RSSI sample of a beacon. The path loss beyond 1 m is the
+*   measured power of the frame minus the RSSI; it is filtered rather than the
+*   distance because its noise does not depend on the distance. The variance
+*   of the estimate grows with the time since the previous sample, so a beacon
+*   seen again after a gap follows its new position quickly.
+*
+* Parameters:
+*   p_prox:                 Filter state
+*   info:                   Parsed frame information
+*   rssi:                   Received signal strength in dBm
+*   now_ms:                 Current time in milliseconds
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_proximity_update(beacon_proximity_t *p_prox, const beacon_frame_info_t *info,
+                             int8_t rssi, uint32_t now_ms)
+{
+    int32_t loss;
+    uint32_t elapsed_ms;
+    uint32_t var;
+    uint32_t gain;
+
+    /* Frames without measured power give no reference */
+    if ((0 == info->measured_power_offset) || (PROX_RSSI_UNAVAILABLE == rssi))
+    {
+        return;
+    }
+
+    loss = (int32_t)info->measured_power - rssi;
+    if (BEACON_FORMAT_IBEACON != info->format)
+    {
+        loss -= BEACON_POWER_EDDYSTONE_0M_DB;
+    }
+    if (loss > PROX_LOSS_MAX_DB)
+    {
+        loss = PROX_LOSS_MAX_DB;
+    }
+    else if (loss < -PROX_LOSS_MAX_DB)
+    {
+        loss = -PROX_LOSS_MAX_DB;
+    }
+    loss *= (1 << BEACON_PROXIMITY_FRAC_BITS);
+
+    if (0 == p_prox->var_q8)
+    {
+        p_prox->loss_q8 = (int16_t)loss;
+        var = PROX_RSSI_VAR_Q8;
+    }
+    else
+    {
+        elapsed_ms = now_ms - p_prox->update_ms;
+        if (elapsed_ms > PROX_MAX_GAP_MS)
+        {
+            elapsed_ms = PROX_MAX_GAP_MS;
+        }
+
+        /* Predict, then correct with the gain var / (var + R) */
+        var = p_prox->var_q8 + (PROX_DRIFT_VAR_Q8 * elapsed_ms) / 1000;
+        if (var > 0xFFFF)
+        {
+            var = 0xFFFF;
+        }
+        gain = (var << PROX_GAIN_BITS) / (var + PROX_RSSI_VAR_Q8);
+
+        p_prox->loss_q8 += (int16_t)(((int32_t)gain * (loss - p_prox->loss_q8)) /
+                                     (1 << PROX_GAIN_BITS));
+        var = (var * ((1UL << PROX_GAIN_BITS) - gain)) >> PROX_GAIN_BITS;
+        if (0 == var)
+        {
+            var = 1;
+        }
+    }
+
+    p_prox->var_q8    = (uint16_t)var;
+    p_prox->update_ms = now_ms;
+    p_prox->zone      = beacon_proximity_zone(p_prox->zone, p_prox->loss_q8);
+}
+
+/********************************************************************************
+* Function Name: beacon_proximity_distance_cm
+*********************************************************************************
+* Summary:
+*   Returns the estimated distance of a beacon
+*
+* Parameters:
+*   p_prox:                 Filter state
+*
+* Return:
+*   Distance in centimeters, 0 if the beacon carries no measured power
+*
+*********************************************************************************/
+uint32_t beacon_proximity_distance_cm(const beacon_proximity_t *p_prox)
+{
+    if (BEACON_PROXIMITY_UNKNOWN == p_prox->zone)
+    {
+        return 0;
+    }
+    return beacon_proximity_loss_to_cm(p_prox->loss_q8);
+}
+
+/* [] END OF FILE */
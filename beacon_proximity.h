@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name: beacon_proximity.h
+*
+* Description: This is the header file for the proximity estimator of the
+* observed beacons.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_PROXIMITY_H__
+#define __BEACON_PROXIMITY_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to estimate the distance and zone of every observed beacon */
+#ifndef BEACON_PROXIMITY_ENABLE
+#define BEACON_PROXIMITY_ENABLE          (0)
+#endif
+
+/* Outer bounds of the immediate and near zones in centimeters */
+#ifndef BEACON_PROXIMITY_IMMEDIATE_CM
+#define BEACON_PROXIMITY_IMMEDIATE_CM    (50)
+#endif
+
+#ifndef BEACON_PROXIMITY_NEAR_CM
+#define BEACON_PROXIMITY_NEAR_CM         (300)
+#endif
+
+/* The zone only changes once the path loss is this far past the bound */
+#ifndef BEACON_PROXIMITY_HYSTERESIS_DB
+#define BEACON_PROXIMITY_HYSTERESIS_DB   (3)
+#endif
+
+/* Standard deviation of a single RSSI sample, fading included */
+#ifndef BEACON_PROXIMITY_RSSI_NOISE_DB
+#define BEACON_PROXIMITY_RSSI_NOISE_DB   (4)
+#endif
+
+/* Standard deviation of the change of the path loss in one second,
+ * about 2 dB for a walking person a few meters away */
+#ifndef BEACON_PROXIMITY_DRIFT_DB
+#define BEACON_PROXIMITY_DRIFT_DB        (2)
+#endif
+
+/* Path loss values are kept in Q8 fixed point */
+#define BEACON_PROXIMITY_FRAC_BITS       (8)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Proximity zones, as reported by iBeacon receivers */
+typedef enum
+{
+    BEACON_PROXIMITY_UNKNOWN = 0,               /* The frame carries no measured power */
+    BEACON_PROXIMITY_IMMEDIATE,
+    BEACON_PROXIMITY_NEAR,
+    BEACON_PROXIMITY_FAR,
+}beacon_proximity_zone_t;
+
+/* Filter state of one beacon */
+typedef struct
+{
+    int16_t  loss_q8;                           /* Path loss beyond 1 m in dB */
+    uint16_t var_q8;                            /* Variance of loss_q8 in dB^2, 0 before
+                                                   the first sample */
+    uint32_t update_ms;                         /* Time of the last sample */
+    uint8_t  zone;                              /* beacon_proximity_zone_t */
+}beacon_proximity_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void     beacon_proximity_init        (void);
+
+void     beacon_proximity_reset       (beacon_proximity_t *p_prox);
+
+void     beacon_proximity_update      (beacon_proximity_t *p_prox,
+                                       const beacon_frame_info_t *info,
+                                       int8_t rssi, uint32_t now_ms);
+
+uint32_t beacon_proximity_distance_cm (const beacon_proximity_t *p_prox);
+
+#endif      /* __BEACON_PROXIMITY_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,373 @@
+/******************************************************************************
+* File Name: beacon_relay.c
+*
+* Description: This is the source code for the beacon relay. A matching scan
+* report is copied into the buffer of the relay rule and only set data is
+* issued while the instance is live. A rule keeps at most one set data
+* command in flight; newer reports replace the buffered payload meanwhile.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include "wiced_bt_stack.h"
+#include "beacon_relay.h"
+#include "beacon_slot.h"
+#include "beacon_timer.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Retry delay when the stack did not accept stopping an expired relay */
+#define RELAY_RETRY_MS                   (1000)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Runtime state of a relay rule */
+typedef struct
+{
+    const beacon_relay_rule_t *p_rule;          /* Configuration */
+    beacon_slot_t *p_slot;                      /* Instance relayed into */
+    wiced_bool_t active;                        /* Instance started by the relay */
+    wiced_bool_t data_in_flight;                /* Set data awaiting response */
+    wiced_bool_t pending;                       /* Payload waiting for issue */
+    uint8_t pending_len;                        /* Length of pending_data */
+    uint8_t pending_data[BEACON_ADV_DATA_MAX];  /* Slot buffer */
+    uint32_t pending_rx_cycles;                 /* Reception time of pending_data */
+    uint32_t in_flight_rx_cycles;               /* Reception time of issued data */
+    uint32_t last_update_ms;                    /* Time of the last accepted report */
+    beacon_timer_t ttl_timer;                   /* Restarted by every matching report */
+    beacon_relay_stats_t stats;                 /* Counters */
+}beacon_relay_state_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_relay_state_t            relay_state[BEACON_RELAY_MAX_RULES];
+static uint8_t                         relay_num_rules;
+static wiced_bt_ble_multi_adv_params_t relay_params;
+
+static SemaphoreHandle_t               relay_mutex;
+static StaticSemaphore_t               relay_mutex_buffer;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_relay_submit
+*********************************************************************************
+* Summary:
+*   Issues the pending payload. The instance is configured and started on the
+*   first payload only, later payloads are data only updates.
+*
+*********************************************************************************/
+static void beacon_relay_submit(beacon_relay_state_t *p_state)
+{
+    p_state->pending = WICED_FALSE;
+
+    if (WICED_BT_PENDING != beacon_slot_set_data(p_state->p_slot, p_state->pending_data,
+                                                 p_state->pending_len))
+    {
+        p_state->stats.drop_failed++;
+        return;
+    }
+    p_state->data_in_flight      = WICED_TRUE;
+    p_state->in_flight_rx_cycles = p_state->pending_rx_cycles;
+
+    if (!p_state->active)
+    {
+        if ((WICED_BT_PENDING == beacon_slot_set_params(p_state->p_slot, &relay_params)) &&
+            (WICED_BT_PENDING == beacon_slot_start(p_state->p_slot, WICED_TRUE)))
+        {
+            p_state->active = WICED_TRUE;
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_relay_slot_cback
+*********************************************************************************
+* Summary:
+*   Response callback of the relay instances. A successful set data response
+*   completes the scan to air path of the payload.
+*
+*********************************************************************************/
+static void beacon_relay_slot_cback(beacon_slot_t *p_slot,
+                                    wiced_bt_multi_adv_opcodes_t opcode,
+                                    uint8_t status)
+{
+    beacon_relay_state_t *p_state = NULL;
+    uint32_t elapsed = beacon_stats_cycles();
+
+    if (SET_ADVT_DATA_MULTI != opcode)
+    {
+        return;
+    }
+
+    xSemaphoreTake(relay_mutex, portMAX_DELAY);
+
+    for (uint8_t i = 0; i < relay_num_rules; i++)
+    {
+        if (relay_state[i].p_slot == p_slot)
+        {
+            p_state = &relay_state[i];
+            break;
+        }
+    }
+
+    if (NULL != p_state)
+    {
+        p_state->data_in_flight = WICED_FALSE;
+
+        if (WICED_SUCCESS == status)
+        {
+            elapsed -= p_state->in_flight_rx_cycles;
+            beacon_latency_add(&p_state->stats.latency_us, beacon_stats_cycles_to_us(elapsed));
+            p_state->stats.relayed++;
+        }
+        else
+        {
+            p_state->stats.drop_failed++;
+        }
+
+        if (p_state->pending)
+        {
+            beacon_relay_submit(p_state);
+        }
+    }
+
+    xSemaphoreGive(relay_mutex);
+}
+
+/********************************************************************************
+* Function Name: beacon_relay_expire
+*********************************************************************************
+* Summary:
+*   TTL timer callback. The source has been silent for the TTL of the rule,
+*   so the relay instance is stopped.
+*
+*********************************************************************************/
+static void beacon_relay_expire(beacon_timer_t *p_timer)
+{
+    beacon_relay_state_t *p_state = (beacon_relay_state_t *)p_timer->p_arg;
+
+    xSemaphoreTake(relay_mutex, portMAX_DELAY);
+
+    if (p_state->active)
+    {
+        if (WICED_BT_PENDING == beacon_slot_start(p_state->p_slot, WICED_FALSE))
+        {
+            p_state->active  = WICED_FALSE;
+            p_state->pending = WICED_FALSE;
+            p_state->stats.expired++;
+        }
+        else
+        {
+            beacon_timer_start(&p_state->ttl_timer, RELAY_RETRY_MS);
+        }
+    }
+
+    xSemaphoreGive(relay_mutex);
+}
+
+/********************************************************************************
+* Function Name: beacon_relay_match
+*********************************************************************************
+* Summary:
+*   Returns WICED_TRUE if the frame matches the rule
+*
+*********************************************************************************/
+static wiced_bool_t beacon_relay_match(const beacon_relay_rule_t *p_rule,
+                                       const beacon_frame_info_t *info)
+{
+    if ((BEACON_FORMAT_UNKNOWN != p_rule->format) && (p_rule->format != info->format))
+    {
+        return WICED_FALSE;
+    }
+
+    if (NULL != p_rule->id_prefix)
+    {
+        if ((NULL == info->id) || (info->id_len < p_rule->id_prefix_len) ||
+            (0 != memcmp(info->id, p_rule->id_prefix, p_rule->id_prefix_len)))
+        {
+            return WICED_FALSE;
+        }
+    }
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_relay_init
+*********************************************************************************
+* Summary:
+*   Configures the relay rules. Each rule must use its own spare instance.
+*
+* Parameters:
+*   p_rules:                Relay rules, must stay valid
+*   num_rules:              Number of rules
+*   p_params:               Advertising parameters of the relay instances
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_relay_init(const beacon_relay_rule_t *p_rules, uint8_t num_rules,
+                       const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    if (NULL == relay_mutex)
+    {
+        relay_mutex = xSemaphoreCreateMutexStatic(&relay_mutex_buffer);
+    }
+
+    for (uint8_t i = 0; i < relay_num_rules; i++)
+    {
+        beacon_timer_stop(&relay_state[i].ttl_timer);
+    }
+
+    memset(relay_state, 0, sizeof(relay_state));
+    relay_params    = *p_params;
+    relay_num_rules = 0;
+
+    for (uint8_t i = 0; (i < num_rules) && (i < BEACON_RELAY_MAX_RULES); i++)
+    {
+        beacon_slot_t *p_slot = beacon_slot_get(p_rules[i].instance);
+
+        if (NULL == p_slot)
+        {
+            continue;
+        }
+
+        relay_state[relay_num_rules].p_rule = &p_rules[i];
+        relay_state[relay_num_rules].p_slot = p_slot;
+        beacon_timer_setup(&relay_state[relay_num_rules].ttl_timer, beacon_relay_expire,
+                           &relay_state[relay_num_rules]);
+        beacon_slot_register(p_slot, beacon_relay_slot_cback);
+        relay_num_rules++;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_relay_on_report
+*********************************************************************************
+* Summary:
+*   Relays a received beacon if it matches a rule. The first matching rule
+*   takes the report.
+*
+* Parameters:
+*   adv_data:               Received advertisement data
+*   info:                   Parsed frame information
+*   rx_cycles:              Cycle counter at reception, see beacon_stats_cycles
+*   now_ms:                 Current time in milliseconds
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_relay_on_report(const uint8_t *adv_data, const beacon_frame_info_t *info,
+                            uint32_t rx_cycles, uint32_t now_ms)
+{
+    beacon_relay_state_t *p_state;
+
+    if (0 == relay_num_rules)
+    {
+        return;
+    }
+
+    xSemaphoreTake(relay_mutex, portMAX_DELAY);
+
+    for (uint8_t i = 0; i < relay_num_rules; i++)
+    {
+        p_state = &relay_state[i];
+
+        if (!beacon_relay_match(p_state->p_rule, info))
+        {
+            continue;
+        }
+
+        p_state->stats.matched++;
+        beacon_timer_start(&p_state->ttl_timer, p_state->p_rule->ttl_ms);
+
+        if (p_state->active &&
+            ((uint32_t)(now_ms - p_state->last_update_ms) < p_state->p_rule->min_interval_ms))
+        {
+            p_state->stats.drop_rate++;
+            break;
+        }
+
+        if (p_state->pending)
+        {
+            p_state->stats.drop_superseded++;
+        }
+
+        p_state->pending_len = beacon_adv_data_len(adv_data, BEACON_ADV_DATA_MAX);
+        memcpy(p_state->pending_data, adv_data, p_state->pending_len);
+        p_state->pending_rx_cycles = rx_cycles;
+        p_state->pending           = WICED_TRUE;
+        p_state->last_update_ms    = now_ms;
+
+        if (!p_state->data_in_flight)
+        {
+            beacon_relay_submit(p_state);
+        }
+        break;
+    }
+
+    xSemaphoreGive(relay_mutex);
+}
+
+/********************************************************************************
+* Function Name: beacon_relay_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the counters of a relay rule
+*
+* Parameters:
+*   rule:                   Index of the rule
+*
+* Return:
+*   Pointer to the counters or NULL if the rule does not exist
+*
+*********************************************************************************/
+const beacon_relay_stats_t *beacon_relay_get_stats(uint8_t rule)
+{
+    return (rule < relay_num_rules) ? &relay_state[rule].stats : NULL;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,105 @@
+/******************************************************************************
+* File Name: beacon_relay.h
+*
+* Description: This file contains the definitions for the beacon relay. The
+* relay re-advertises selected remote beacons on spare multi-advertising
+* instances.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_RELAY_H__
+#define __BEACON_RELAY_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_stats.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to relay observed beacons, requires BEACON_OBSERVER_ENABLE */
+#ifndef BEACON_RELAY_ENABLE
+#define BEACON_RELAY_ENABLE              (0)
+#endif
+
+/* Maximum number of relay rules */
+#define BEACON_RELAY_MAX_RULES           (4)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Selects remote beacons and the instance they are relayed into */
+typedef struct
+{
+    beacon_format_t format;                     /* Format to relay, UNKNOWN for any */
+    const uint8_t *id_prefix;                   /* Leading identity bytes, NULL for any */
+    uint8_t id_prefix_len;                      /* Length of id_prefix */
+    uint8_t instance;                           /* Spare multi-adv instance */
+    uint32_t min_interval_ms;                   /* Minimum time between updates */
+    uint32_t ttl_ms;                            /* Stop when the source is silent this long */
+}beacon_relay_rule_t;
+
+/* Per rule relay counters */
+typedef struct
+{
+    uint32_t matched;                           /* Reports matching the rule */
+    uint32_t relayed;                           /* Payloads confirmed by the controller */
+    uint32_t drop_rate;                         /* Reports dropped by the rate limit */
+    uint32_t drop_superseded;                   /* Payloads replaced before issue */
+    uint32_t drop_failed;                       /* Payloads rejected or failed */
+    uint32_t expired;                           /* Relays stopped by the TTL */
+    beacon_latency_t latency_us;                /* Scan report to set data response */
+}beacon_relay_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                        beacon_relay_init      (const beacon_relay_rule_t *p_rules,
+                                                    uint8_t num_rules,
+                                                    const wiced_bt_ble_multi_adv_params_t *p_params);
+
+void                        beacon_relay_on_report (const uint8_t *adv_data,
+                                                    const beacon_frame_info_t *info,
+                                                    uint32_t rx_cycles, uint32_t now_ms);
+
+const beacon_relay_stats_t *beacon_relay_get_stats (uint8_t rule);
+
+#endif      /* __BEACON_RELAY_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,503 @@
+/******************************************************************************
+* File Name: beacon_rolling.c
+*
+* Description: This is the source code for rolling iBeacon identities. The
+* worker precomputes the identities of the next epochs into a small ring, so
+* that a rotation only patches major and minor and issues a data update.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "wiced_bt_stack.h"
+#include "beacon_rolling.h"
+#include "beacon_stats.h"
+#include "beacon_timer.h"
+#include "beacon_utils.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Major and minor in the iBeacon advertisement: flags, AD header, then the
+ * manufacturer data */
+#define ROLLING_ID_OFFSET                (ADV_PKT_FLAG_LENGTH + 1 + 2 + IBEACON_DATA_INDEX20)
+
+/* First octet of the MAC input, separates it from other uses of the key */
+#define ROLLING_DOMAIN                   (0x52)
+
+/* Limit of epochs that need no reservation */
+#define ROLLING_NO_LIMIT                 (0xFFFFFFFFUL)
+
+/* Retry delay when the stack did not accept a rotation */
+#define ROLLING_RETRY_MS                 (1000)
+
+#define ROLLING_TABLE_MASK               (BEACON_ROLLING_TABLE_SIZE - 1)
+
+#if (BEACON_ROLLING_TABLE_SIZE & ROLLING_TABLE_MASK) || \
+    (BEACON_ROLLING_TABLE_SIZE < (2 * BEACON_ROLLING_MAX_DEVICES))
+#error "BEACON_ROLLING_TABLE_SIZE must be a power of two of at least twice the devices"
+#endif
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Precomputed identity */
+typedef struct
+{
+    wiced_bool_t valid;                         /* id is computed */
+    uint32_t epoch;                             /* Epoch of the identity */
+    uint8_t id[BEACON_ROLLING_ID_LEN];          /* Major and minor */
+}rolling_ahead_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_slot_t          *rolling_slot;
+static beacon_aes_ctx_t        rolling_key;
+static uint32_t                rolling_epoch;           /* Epoch on air */
+static uint32_t                rolling_limit;           /* First epoch not reserved */
+static beacon_rolling_reserve_t *rolling_reserve;
+static uint32_t                rolling_epoch_ms;
+static uint32_t                rolling_next_ms;         /* Next epoch boundary */
+static beacon_timer_t          rolling_timer;
+static rolling_ahead_t         rolling_ahead[BEACON_ROLLING_LOOKAHEAD];
+static beacon_rolling_stats_t  rolling_stats;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_rolling_id
+*********************************************************************************
+* Summary:
+*   Derives the identity of an epoch, the first four octets of AES-128 of
+*   the epoch counter under the device key
+*
+* Parameters:
+*   key:                    Expanded device key
+*   epoch:                  Epoch counter
+*   id:                     Major and minor, most significant octet first
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_rolling_id(const beacon_aes_ctx_t *key, uint32_t epoch,
+                       uint8_t id[BEACON_ROLLING_ID_LEN])
+{
+    uint8_t block[BEACON_AES_BLOCK_LEN] = { ROLLING_DOMAIN };
+
+    block[12] = (uint8_t)(epoch >> 24);
+    block[13] = (uint8_t)(epoch >> 16);
+    block[14] = (uint8_t)(epoch >> 8);
+    block[15] = (uint8_t)epoch;
+
+    beacon_aes_encrypt(key, block, block);
+    memcpy(id, block, BEACON_ROLLING_ID_LEN);
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_apply
+*********************************************************************************
+* Summary:
+*   Patches major and minor into the advertisement of the slot and issues a
+*   data only update
+*
+*********************************************************************************/
+static wiced_result_t beacon_rolling_apply(const uint8_t id[BEACON_ROLLING_ID_LEN])
+{
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+
+    memcpy(adv_data, rolling_slot->adv_data, rolling_slot->adv_len);
+    memcpy(&adv_data[ROLLING_ID_OFFSET], id, BEACON_ROLLING_ID_LEN);
+
+    return beacon_slot_set_data(rolling_slot, adv_data, rolling_slot->adv_len);
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_rotate
+*********************************************************************************
+* Summary:
+*   Epoch timer callback, runs in the beacon manager task. Puts the
+*   precomputed identity of the next epoch on air once it is reserved.
+*
+*********************************************************************************/
+static void beacon_rolling_rotate(beacon_timer_t *p_timer)
+{
+    uint32_t epoch = rolling_epoch + 1;
+    rolling_ahead_t *p_ahead = &rolling_ahead[epoch % BEACON_ROLLING_LOOKAHEAD];
+    uint8_t id[BEACON_ROLLING_ID_LEN];
+    wiced_bool_t reserved;
+    wiced_bool_t ready;
+    int32_t wait_ms;
+
+    (void)p_timer;
+
+    taskENTER_CRITICAL();
+    reserved = (epoch < rolling_limit);
+    taskEXIT_CRITICAL();
+
+    if (!reserved)
+    {
+        /* The worker reserves the next block, keep the epoch on air until then */
+        rolling_stats.unreserved++;
+        beacon_timer_start(&rolling_timer, ROLLING_RETRY_MS);
+        beacon_worker_kick();
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    ready = p_ahead->valid && (p_ahead->epoch == epoch);
+    if (ready)
+    {
+        memcpy(id, p_ahead->id, BEACON_ROLLING_ID_LEN);
+    }
+    taskEXIT_CRITICAL();
+
+    if (!ready)
+    {
+        rolling_stats.late++;
+        beacon_rolling_id(&rolling_key, epoch, id);
+    }
+
+    if (WICED_BT_PENDING != beacon_rolling_apply(id))
+    {
+        rolling_stats.rejected++;
+        beacon_timer_start(&rolling_timer, ROLLING_RETRY_MS);
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    rolling_epoch = epoch;
+    taskEXIT_CRITICAL();
+    rolling_stats.rotations++;
+
+    /* Keep the boundaries on the epoch grid after a late or retried rotation */
+    rolling_next_ms += rolling_epoch_ms;
+    wait_ms = (int32_t)(rolling_next_ms - beacon_stats_now_ms());
+    beacon_timer_start(&rolling_timer, (wait_ms > 0) ? (uint32_t)wait_ms : 0);
+
+    beacon_worker_kick();
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_job
+*********************************************************************************
+* Summary:
+*   Worker job. Reserves the next block of epochs before the lookahead
+*   reaches it, and fills the lookahead ring with the epochs after the one
+*   on air.
+*
+*********************************************************************************/
+static uint32_t beacon_rolling_job(uint32_t now_ms)
+{
+    rolling_ahead_t *p_ahead;
+    uint8_t id[BEACON_ROLLING_ID_LEN];
+    uint32_t current;
+    uint32_t limit;
+    uint32_t epoch;
+    wiced_bool_t have;
+
+    (void)now_ms;
+
+    taskENTER_CRITICAL();
+    current = rolling_epoch;
+    limit   = rolling_limit;
+    taskEXIT_CRITICAL();
+
+    /* The rotation holds the epoch on air and kicks again if this fails */
+    if ((NULL != rolling_reserve) && ((limit - current) <= BEACON_ROLLING_LOOKAHEAD) &&
+        rolling_reserve(limit + BEACON_ROLLING_EPOCH_BLOCK))
+    {
+        taskENTER_CRITICAL();
+        rolling_limit = limit + BEACON_ROLLING_EPOCH_BLOCK;
+        taskEXIT_CRITICAL();
+    }
+
+    for (uint32_t k = 1; k <= BEACON_ROLLING_LOOKAHEAD; k++)
+    {
+        epoch   = current + k;
+        p_ahead = &rolling_ahead[epoch % BEACON_ROLLING_LOOKAHEAD];
+
+        taskENTER_CRITICAL();
+        have = p_ahead->valid && (p_ahead->epoch == epoch);
+        taskEXIT_CRITICAL();
+
+        if (!have)
+        {
+            beacon_rolling_id(&rolling_key, epoch, id);
+
+            taskENTER_CRITICAL();
+            p_ahead->epoch = epoch;
+            memcpy(p_ahead->id, id, BEACON_ROLLING_ID_LEN);
+            p_ahead->valid = WICED_TRUE;
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    return BEACON_WORKER_IDLE;
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_start
+*********************************************************************************
+* Summary:
+*   Starts rolling the identity of an iBeacon slot. The identity of the
+*   given epoch is put on air right away. Call from the beacon manager task
+*   once the slot advertises its iBeacon. The reserve callback runs in this
+*   call and then in the worker task.
+*
+* Parameters:
+*   p_slot:                 Slot advertising an iBeacon
+*   key:                    Device key, shared with the resolvers
+*   epoch:                  Current epoch counter, from a clock or the limit
+*                           stored by p_reserve, never an epoch already used
+*   epoch_ms:               Epoch length
+*   p_reserve:              Stores the epoch limit, NULL if epoch comes from
+*                           a clock that does not go back after a reset
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the first identity was issued,
+*   WICED_BT_ERROR if the first epochs could not be reserved
+*
+*********************************************************************************/
+wiced_result_t beacon_rolling_start(beacon_slot_t *p_slot,
+                                    const uint8_t key[BEACON_ROLLING_KEY_LEN],
+                                    uint32_t epoch, uint32_t epoch_ms,
+                                    beacon_rolling_reserve_t *p_reserve)
+{
+    beacon_frame_info_t info;
+    uint8_t id[BEACON_ROLLING_ID_LEN];
+    wiced_result_t result;
+
+    if ((NULL == p_slot) || (NULL != rolling_slot) ||
+        !beacon_parse_adv_data(p_slot->adv_data, p_slot->adv_len, &info) ||
+        (BEACON_FORMAT_IBEACON != info.format))
+    {
+        return WICED_BT_BADARG;
+    }
+
+    if ((NULL != p_reserve) && !p_reserve(epoch + BEACON_ROLLING_EPOCH_BLOCK))
+    {
+        return WICED_BT_ERROR;
+    }
+
+    rolling_slot     = p_slot;
+    rolling_epoch    = epoch;
+    rolling_limit    = (NULL != p_reserve) ? (epoch + BEACON_ROLLING_EPOCH_BLOCK) : ROLLING_NO_LIMIT;
+    rolling_reserve  = p_reserve;
+    rolling_epoch_ms = epoch_ms;
+    beacon_aes_init(&rolling_key, key);
+    memset(rolling_ahead, 0, sizeof(rolling_ahead));
+
+    beacon_rolling_id(&rolling_key, epoch, id);
+    result = beacon_rolling_apply(id);
+
+    rolling_next_ms = beacon_stats_now_ms() + epoch_ms;
+    beacon_timer_setup(&rolling_timer, beacon_rolling_rotate, NULL);
+    beacon_timer_start(&rolling_timer, epoch_ms);
+    beacon_worker_register(beacon_rolling_job, 0);
+
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the rotation counters
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Pointer to the counters
+*
+*********************************************************************************/
+const beacon_rolling_stats_t *beacon_rolling_get_stats(void)
+{
+    return &rolling_stats;
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_build
+*********************************************************************************
+* Summary:
+*   Builds the lookup table of an epoch. The identities are uniformly
+*   distributed, so their low bits index the open addressed table directly.
+*
+*********************************************************************************/
+static void beacon_rolling_build(beacon_rolling_resolver_t *p_res, uint32_t epoch)
+{
+    uint8_t w = epoch % BEACON_ROLLING_WINDOW;
+    beacon_rolling_entry_t *p_table = p_res->table[w];
+    uint8_t id[BEACON_ROLLING_ID_LEN];
+    uint32_t value;
+    uint32_t index;
+
+    for (index = 0; index < BEACON_ROLLING_TABLE_SIZE; index++)
+    {
+        p_table[index].device = BEACON_ROLLING_NONE;
+    }
+
+    for (uint16_t device = 0; device < p_res->num_keys; device++)
+    {
+        beacon_rolling_id(&p_res->p_keys[device], epoch, id);
+        value = ((uint32_t)id[0] << 24) | ((uint32_t)id[1] << 16) |
+                ((uint32_t)id[2] << 8) | id[3];
+
+        index = value & ROLLING_TABLE_MASK;
+        while (BEACON_ROLLING_NONE != p_table[index].device)
+        {
+            index = (index + 1) & ROLLING_TABLE_MASK;
+        }
+        p_table[index].id     = value;
+        p_table[index].device = device;
+    }
+
+    p_res->epoch[w] = epoch;
+    p_res->valid[w] = WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_resolver_init
+*********************************************************************************
+* Summary:
+*   Initializes a resolver for a set of devices. Scanner side.
+*
+* Parameters:
+*   p_res:                  Resolver
+*   p_keys:                 Expanded device keys, must stay valid
+*   num_keys:               Number of devices, at most BEACON_ROLLING_MAX_DEVICES
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_rolling_resolver_init(beacon_rolling_resolver_t *p_res,
+                                  const beacon_aes_ctx_t *p_keys, uint16_t num_keys)
+{
+    memset(p_res->valid, 0, sizeof(p_res->valid));
+    p_res->p_keys   = p_keys;
+    p_res->num_keys = (num_keys > BEACON_ROLLING_MAX_DEVICES) ? BEACON_ROLLING_MAX_DEVICES :
+                                                                num_keys;
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_resolver_set_epoch
+*********************************************************************************
+* Summary:
+*   Moves the window of the resolver to the epochs around the current one.
+*   Tables still in the window are kept, so advancing by one epoch builds
+*   only one table.
+*
+* Parameters:
+*   p_res:                  Resolver
+*   epoch:                  Current epoch counter
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_rolling_resolver_set_epoch(beacon_rolling_resolver_t *p_res, uint32_t epoch)
+{
+    uint32_t first = epoch - (BEACON_ROLLING_WINDOW / 2);
+
+    for (uint32_t e = first; e != (first + BEACON_ROLLING_WINDOW); e++)
+    {
+        uint8_t w = e % BEACON_ROLLING_WINDOW;
+
+        if (!p_res->valid[w] || (p_res->epoch[w] != e))
+        {
+            beacon_rolling_build(p_res, e);
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_rolling_resolve
+*********************************************************************************
+* Summary:
+*   Looks up the device advertising a major and minor pair
+*
+* Parameters:
+*   p_res:                  Resolver
+*   major:                  Received major
+*   minor:                  Received minor
+*   p_epoch:                Epoch the identity belongs to
+*
+* Return:
+*   Index of the device key, BEACON_ROLLING_NONE if no device matches
+*
+*********************************************************************************/
+uint16_t beacon_rolling_resolve(const beacon_rolling_resolver_t *p_res,
+                                uint16_t major, uint16_t minor, uint32_t *p_epoch)
+{
+    uint32_t value = ((uint32_t)major << 16) | minor;
+    const beacon_rolling_entry_t *p_entry;
+    uint32_t index;
+
+    for (uint8_t w = 0; w < BEACON_ROLLING_WINDOW; w++)
+    {
+        if (!p_res->valid[w])
+        {
+            continue;
+        }
+
+        index = value & ROLLING_TABLE_MASK;
+        for (;;)
+        {
+            p_entry = &p_res->table[w][index];
+            if (BEACON_ROLLING_NONE == p_entry->device)
+            {
+                break;
+            }
+            if (p_entry->id == value)
+            {
+                *p_epoch = p_res->epoch[w];
+                return p_entry->device;
+            }
+            index = (index + 1) & ROLLING_TABLE_MASK;
+        }
+    }
+    return BEACON_ROLLING_NONE;
+}
+
+/* [] END OF FILE */
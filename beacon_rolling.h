@@ -0,0 +1,158 @@
+/******************************************************************************
+* File Name: beacon_rolling.h
+*
+* Description: This file contains the definitions for rolling iBeacon
+* identities. Major and minor are a truncated keyed MAC of the device key and
+* an epoch counter, so only holders of the key can tell which device it is.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_ROLLING_H__
+#define __BEACON_ROLLING_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_aes.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to roll the major and minor of the iBeacon instance */
+#ifndef BEACON_ROLLING_ENABLE
+#define BEACON_ROLLING_ENABLE            (0)
+#endif
+
+#if BEACON_ROLLING_ENABLE && !BEACON_IBEACON_ENABLE
+#error "BEACON_ROLLING_ENABLE requires BEACON_IBEACON_ENABLE"
+#endif
+
+/* Default epoch length */
+#ifndef BEACON_ROLLING_EPOCH_MS
+#define BEACON_ROLLING_EPOCH_MS          (10UL * 60UL * 1000UL)
+#endif
+
+/* Epochs precomputed ahead of the one on air */
+#define BEACON_ROLLING_LOOKAHEAD         (4)
+
+/* Epochs reserved at a time through the reserve callback, one flash write
+ * per block */
+#ifndef BEACON_ROLLING_EPOCH_BLOCK
+#define BEACON_ROLLING_EPOCH_BLOCK       (16)
+#endif
+
+#define BEACON_ROLLING_KEY_LEN           (BEACON_AES_KEY_LEN)
+
+/* Major and minor, most significant octet first as in the iBeacon frame */
+#define BEACON_ROLLING_ID_LEN            (4)
+
+/* Resolver sizes. The table holds every device for one epoch and is at
+ * least twice as large, a power of two. */
+#define BEACON_ROLLING_MAX_DEVICES       (64)
+#define BEACON_ROLLING_TABLE_SIZE        (128)
+
+/* Epochs the resolver accepts around the current one, for clock drift */
+#define BEACON_ROLLING_WINDOW            (3)
+
+/* No device */
+#define BEACON_ROLLING_NONE              (0xFFFF)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Rotation counters */
+typedef struct
+{
+    uint32_t rotations;                         /* Identities put on air */
+    uint32_t late;                              /* Identities not precomputed in time */
+    uint32_t rejected;                          /* Updates not accepted by the stack */
+    uint32_t unreserved;                        /* Rotations held, epoch not reserved */
+}beacon_rolling_stats_t;
+
+/* Resolver table entry */
+typedef struct
+{
+    uint32_t id;                                /* Major and minor */
+    uint16_t device;                            /* Index of the key, or NONE */
+}beacon_rolling_entry_t;
+
+/* Resolver, one lookup table per epoch of the window */
+typedef struct
+{
+    const beacon_aes_ctx_t *p_keys;             /* Expanded device keys */
+    uint16_t num_keys;                          /* Number of devices */
+    wiced_bool_t valid[BEACON_ROLLING_WINDOW];  /* Table built */
+    uint32_t epoch[BEACON_ROLLING_WINDOW];      /* Epoch of each table */
+    beacon_rolling_entry_t table[BEACON_ROLLING_WINDOW][BEACON_ROLLING_TABLE_SIZE];
+}beacon_rolling_resolver_t;
+
+/* Called before epochs below limit go on air. An identity must not come
+ * back after a reset, so store limit in non-volatile memory before
+ * returning and start from the stored limit after a reset. Returns
+ * WICED_FALSE if it could not be stored. */
+typedef wiced_bool_t (beacon_rolling_reserve_t)(uint32_t limit);
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                          beacon_rolling_id                 (const beacon_aes_ctx_t *key,
+                                                                 uint32_t epoch,
+                                                                 uint8_t id[BEACON_ROLLING_ID_LEN]);
+
+wiced_result_t                beacon_rolling_start              (beacon_slot_t *p_slot,
+                                                                 const uint8_t key[BEACON_ROLLING_KEY_LEN],
+                                                                 uint32_t epoch,
+                                                                 uint32_t epoch_ms,
+                                                                 beacon_rolling_reserve_t *p_reserve);
+
+const beacon_rolling_stats_t *beacon_rolling_get_stats          (void);
+
+void                          beacon_rolling_resolver_init      (beacon_rolling_resolver_t *p_res,
+                                                                 const beacon_aes_ctx_t *p_keys,
+                                                                 uint16_t num_keys);
+
+void                          beacon_rolling_resolver_set_epoch (beacon_rolling_resolver_t *p_res,
+                                                                 uint32_t epoch);
+
+uint16_t                      beacon_rolling_resolve            (const beacon_rolling_resolver_t *p_res,
+                                                                 uint16_t major, uint16_t minor,
+                                                                 uint32_t *p_epoch);
+
+#endif      /* __BEACON_ROLLING_H__ */
+
+
+/* [] END OF FILE */
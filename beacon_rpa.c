@@ -0,0 +1,453 @@
+/******************************************************************************
+* File Name: beacon_rpa.c
+*
+* Description: This is the source code for the resolvable private address
+* rotation. The next address of every slot is computed by the background
+* worker well before its deadline, so a rotation is a single parameters
+* update with the precomputed address, issued from a timer wheel callback in
+* the beacon manager task with no cryptography on that path.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "cyhal.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "wiced_bt_stack.h"
+#include "beacon_rpa.h"
+#include "beacon_stats.h"
+#include "beacon_timer.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* prand is 24 bits, the two most significant bits are 0b01 for an RPA */
+#define RPA_PRAND_RANDOM_MASK            (0x003FFFFFUL)
+#define RPA_PRAND_TYPE_BITS              (0x00400000UL)
+#define RPA_HASH_MASK                    (0x00FFFFFFUL)
+
+/* Retry delay when the stack did not accept a rotation */
+#define RPA_RETRY_MS                     (1000)
+
+/* Retry delay when the worker has not computed the next address yet */
+#define RPA_LATE_RETRY_MS                (50)
+
+#if defined(CYHAL_DRIVER_AVAILABLE_TRNG) && (CYHAL_DRIVER_AVAILABLE_TRNG)
+#define RPA_USE_TRNG                     (1)
+#else
+#define RPA_USE_TRNG                     (0)
+#endif
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Rotation state of a slot */
+typedef struct
+{
+    beacon_slot_t *p_slot;                      /* Slot advertising the address */
+    beacon_aes_ctx_t irk;                       /* Expanded identity resolving key */
+    uint32_t period_ms;                         /* Rotation period */
+    beacon_timer_t rotation_timer;              /* Deadline of the next rotation */
+    wiced_bt_device_address_t current_addr;     /* Address on air */
+    wiced_bt_device_address_t next_addr;        /* Precomputed next address */
+    wiced_bool_t next_ready;                    /* next_addr is valid */
+    beacon_rpa_stats_t stats;                   /* Counters */
+}beacon_rpa_slot_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_rpa_slot_t rpa_slots[BEACON_SLOT_MAX_INSTANCES];
+static uint8_t           rpa_num_slots;
+static uint32_t          rpa_counter;
+
+/* Serialises the random source: addresses are generated by the worker and by
+ * beacon_rpa_enable in the caller's task */
+static SemaphoreHandle_t rpa_mutex;
+static StaticSemaphore_t rpa_mutex_buffer;
+
+#if RPA_USE_TRNG
+static cyhal_trng_t      rpa_trng;
+static wiced_bool_t      rpa_trng_ready;
+#endif
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_rpa_random
+*********************************************************************************
+* Summary:
+*   Returns 32 random bits. The TRNG is used where the device has one; the
+*   fallback encrypts a counter and the cycle counter with the IRK.
+*
+*********************************************************************************/
+static uint32_t beacon_rpa_random(const beacon_aes_ctx_t *irk)
+{
+#if RPA_USE_TRNG
+    if (!rpa_trng_ready)
+    {
+        rpa_trng_ready = (CY_RSLT_SUCCESS == cyhal_trng_init(&rpa_trng)) ? WICED_TRUE : WICED_FALSE;
+    }
+    if (rpa_trng_ready)
+    {
+        return cyhal_trng_generate(&rpa_trng);
+    }
+#endif
+    {
+        uint8_t block[BEACON_AES_BLOCK_LEN] = { 0 };
+        uint32_t seed[2] = { ++rpa_counter, beacon_stats_cycles() };
+
+        memcpy(block, seed, sizeof(seed));
+        beacon_aes_encrypt(irk, block, block);
+        return ((uint32_t)block[0] << 24) | ((uint32_t)block[1] << 16) |
+               ((uint32_t)block[2] << 8) | block[3];
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_find
+*********************************************************************************
+* Summary:
+*   Returns the rotation state of a slot, NULL if the slot has no RPA
+*
+*********************************************************************************/
+static beacon_rpa_slot_t *beacon_rpa_find(const beacon_slot_t *p_slot)
+{
+    for (uint8_t i = 0; i < rpa_num_slots; i++)
+    {
+        if (rpa_slots[i].p_slot == p_slot)
+        {
+            return &rpa_slots[i];
+        }
+    }
+    return NULL;
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_new_address
+*********************************************************************************
+* Summary:
+*   Generates a fresh address. The random part of prand must not be all zeros
+*   or all ones.
+*
+*********************************************************************************/
+static void beacon_rpa_new_address(beacon_rpa_slot_t *p_rpa, wiced_bt_device_address_t rpa)
+{
+    uint32_t prand;
+
+    xSemaphoreTake(rpa_mutex, portMAX_DELAY);
+    do
+    {
+        prand = beacon_rpa_random(&p_rpa->irk) & RPA_PRAND_RANDOM_MASK;
+    } while ((0 == prand) || (RPA_PRAND_RANDOM_MASK == prand));
+    xSemaphoreGive(rpa_mutex);
+
+    beacon_rpa_generate(&p_rpa->irk, prand | RPA_PRAND_TYPE_BITS, rpa);
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_rotate
+*********************************************************************************
+* Summary:
+*   Rotation timer callback, runs in the beacon manager task. Puts the
+*   precomputed address on air and lets the worker compute the following one.
+*   Addresses are only generated by the worker, so a rotation that finds none
+*   ready keeps the current address and retries shortly.
+*
+*********************************************************************************/
+static void beacon_rpa_rotate(beacon_timer_t *p_timer)
+{
+    beacon_rpa_slot_t *p_rpa = (beacon_rpa_slot_t *)p_timer->p_arg;
+    wiced_bt_ble_multi_adv_params_t params;
+    const uint8_t *p_addr = p_rpa->next_addr;
+
+    if (!p_rpa->next_ready)
+    {
+        p_rpa->stats.late++;
+        beacon_timer_start(&p_rpa->rotation_timer, RPA_LATE_RETRY_MS);
+        beacon_worker_kick();
+        return;
+    }
+
+    params = p_rpa->p_slot->params;
+    params.own_addr_type = BEACON_RPA_ADDR_TYPE;
+    memcpy(params.own_bd_addr, p_addr, BD_ADDR_LEN);
+
+    /* Slots not configured yet pick the address up through
+     * beacon_rpa_fill, the others get a parameters only update */
+    if ((0 == p_rpa->p_slot->stats.params_updates) ||
+        (WICED_BT_PENDING == beacon_slot_set_params(p_rpa->p_slot, &params)))
+    {
+        taskENTER_CRITICAL();
+        memcpy(p_rpa->current_addr, p_addr, BD_ADDR_LEN);
+        taskEXIT_CRITICAL();
+
+        p_rpa->stats.rotations++;
+        p_rpa->next_ready = WICED_FALSE;
+        beacon_timer_start(&p_rpa->rotation_timer, p_rpa->period_ms);
+        beacon_worker_kick();
+    }
+    else
+    {
+        p_rpa->stats.rejected++;
+        beacon_timer_start(&p_rpa->rotation_timer, RPA_RETRY_MS);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_job
+*********************************************************************************
+* Summary:
+*   Worker job. Precomputes the next address of every slot after each
+*   rotation.
+*
+*********************************************************************************/
+static uint32_t beacon_rpa_job(uint32_t now_ms)
+{
+    beacon_rpa_slot_t *p_rpa;
+
+    (void)now_ms;
+
+    for (uint8_t i = 0; i < rpa_num_slots; i++)
+    {
+        p_rpa = &rpa_slots[i];
+
+        if (!p_rpa->next_ready)
+        {
+            beacon_rpa_new_address(p_rpa, p_rpa->next_addr);
+            p_rpa->next_ready = WICED_TRUE;
+        }
+    }
+
+    return BEACON_WORKER_IDLE;
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_ah
+*********************************************************************************
+* Summary:
+*   Random address hash function ah, Core specification Vol 3, Part H, 2.2.2
+*
+* Parameters:
+*   irk:                    Expanded identity resolving key
+*   prand:                  24-bit prand
+*
+* Return:
+*   24-bit hash
+*
+*********************************************************************************/
+uint32_t beacon_rpa_ah(const beacon_aes_ctx_t *irk, uint32_t prand)
+{
+    uint8_t block[BEACON_AES_BLOCK_LEN] = { 0 };
+
+    /* r' = padding || r, most significant octet first */
+    block[13] = (uint8_t)(prand >> 16);
+    block[14] = (uint8_t)(prand >> 8);
+    block[15] = (uint8_t)prand;
+
+    beacon_aes_encrypt(irk, block, block);
+
+    return (((uint32_t)block[13] << 16) | ((uint32_t)block[14] << 8) | block[15]) &
+           RPA_HASH_MASK;
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_generate
+*********************************************************************************
+* Summary:
+*   Builds a resolvable private address from prand and its hash
+*
+* Parameters:
+*   irk:                    Expanded identity resolving key
+*   prand:                  24-bit prand including the address type bits
+*   rpa:                    Resulting address
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_rpa_generate(const beacon_aes_ctx_t *irk, uint32_t prand,
+                         wiced_bt_device_address_t rpa)
+{
+    uint32_t hash = beacon_rpa_ah(irk, prand);
+
+    /* prand is the most significant half of the address */
+    rpa[0] = (uint8_t)(prand >> 16);
+    rpa[1] = (uint8_t)(prand >> 8);
+    rpa[2] = (uint8_t)prand;
+    rpa[3] = (uint8_t)(hash >> 16);
+    rpa[4] = (uint8_t)(hash >> 8);
+    rpa[5] = (uint8_t)hash;
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_resolve
+*********************************************************************************
+* Summary:
+*   Checks whether an address was generated from an IRK
+*
+* Parameters:
+*   irk:                    Expanded identity resolving key
+*   rpa:                    Address to resolve
+*
+* Return:
+*   WICED_TRUE if the address resolves with the IRK
+*
+*********************************************************************************/
+wiced_bool_t beacon_rpa_resolve(const beacon_aes_ctx_t *irk, const wiced_bt_device_address_t rpa)
+{
+    uint32_t prand = ((uint32_t)rpa[0] << 16) | ((uint32_t)rpa[1] << 8) | rpa[2];
+    uint32_t hash  = ((uint32_t)rpa[3] << 16) | ((uint32_t)rpa[4] << 8) | rpa[5];
+
+    return (beacon_rpa_ah(irk, prand) == hash) ? WICED_TRUE : WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_enable
+*********************************************************************************
+* Summary:
+*   Gives a slot its own rotating resolvable private address. The first
+*   address is generated here, so call this before the slot parameters are
+*   set and use beacon_rpa_fill when building them. Call before the scheduler
+*   is started or from the beacon manager task.
+*
+* Parameters:
+*   p_slot:                 Slot
+*   irk:                    Identity resolving key of the slot, most significant
+*                           octet first
+*   period_ms:              Rotation period
+*
+* Return:
+*   wiced_result_t: WICED_BT_SUCCESS or WICED_BT_NO_RESOURCES
+*
+*********************************************************************************/
+wiced_result_t beacon_rpa_enable(beacon_slot_t *p_slot, const uint8_t irk[BEACON_RPA_IRK_LEN],
+                                 uint32_t period_ms)
+{
+    beacon_rpa_slot_t *p_rpa = beacon_rpa_find(p_slot);
+
+    if (NULL == rpa_mutex)
+    {
+        rpa_mutex = xSemaphoreCreateMutexStatic(&rpa_mutex_buffer);
+    }
+
+    if (NULL == p_rpa)
+    {
+        if (BEACON_SLOT_MAX_INSTANCES == rpa_num_slots)
+        {
+            return WICED_BT_NO_RESOURCES;
+        }
+        p_rpa = &rpa_slots[rpa_num_slots++];
+    }
+    else
+    {
+        beacon_timer_stop(&p_rpa->rotation_timer);
+    }
+
+    memset(p_rpa, 0, sizeof(*p_rpa));
+    p_rpa->p_slot           = p_slot;
+    p_rpa->period_ms        = period_ms;
+    beacon_aes_init(&p_rpa->irk, irk);
+    beacon_rpa_new_address(p_rpa, p_rpa->current_addr);
+    beacon_timer_setup(&p_rpa->rotation_timer, beacon_rpa_rotate, p_rpa);
+    beacon_timer_start(&p_rpa->rotation_timer, period_ms);
+
+    if (1 == rpa_num_slots)
+    {
+        beacon_worker_register(beacon_rpa_job, 0);
+    }
+    else
+    {
+        beacon_worker_kick();
+    }
+
+    return WICED_BT_SUCCESS;
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_fill
+*********************************************************************************
+* Summary:
+*   Sets the current address of the slot in advertising parameters. Slots
+*   without RPA keep the parameters unchanged.
+*
+* Parameters:
+*   p_slot:                 Slot
+*   p_params:               Parameters to update
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_rpa_fill(const beacon_slot_t *p_slot, wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    beacon_rpa_slot_t *p_rpa = beacon_rpa_find(p_slot);
+
+    if (NULL != p_rpa)
+    {
+        taskENTER_CRITICAL();
+        p_params->own_addr_type = BEACON_RPA_ADDR_TYPE;
+        memcpy(p_params->own_bd_addr, p_rpa->current_addr, BD_ADDR_LEN);
+        taskEXIT_CRITICAL();
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_rpa_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the rotation counters of a slot
+*
+* Parameters:
+*   p_slot:                 Slot
+*
+* Return:
+*   Pointer to the counters or NULL if the slot has no RPA
+*
+*********************************************************************************/
+const beacon_rpa_stats_t *beacon_rpa_get_stats(const beacon_slot_t *p_slot)
+{
+    beacon_rpa_slot_t *p_rpa = beacon_rpa_find(p_slot);
+
+    return (NULL != p_rpa) ? &p_rpa->stats : NULL;
+}
+
+/* [] END OF FILE */
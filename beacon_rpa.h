@@ -0,0 +1,103 @@
+/******************************************************************************
+* File Name: beacon_rpa.h
+*
+* Description: This file contains the definitions for the resolvable private
+* address (RPA) rotation of the advertising slots.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_RPA_H__
+#define __BEACON_RPA_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_aes.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to advertise every slot with its own resolvable private address */
+#ifndef BEACON_RPA_ENABLE
+#define BEACON_RPA_ENABLE                (0)
+#endif
+
+/* Default rotation period, 15 minutes as recommended by the specification */
+#ifndef BEACON_RPA_PERIOD_MS
+#define BEACON_RPA_PERIOD_MS             (15UL * 60UL * 1000UL)
+#endif
+
+#define BEACON_RPA_IRK_LEN               (BEACON_AES_KEY_LEN)
+
+/* Random device address type used with a resolvable private address */
+#define BEACON_RPA_ADDR_TYPE             (0x01)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Rotation counters of a slot */
+typedef struct
+{
+    uint32_t rotations;                         /* Addresses put on air */
+    uint32_t late;                              /* Deadlines missed for lack of an address */
+    uint32_t rejected;                          /* Rotations not accepted by the stack */
+}beacon_rpa_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+uint32_t                  beacon_rpa_ah        (const beacon_aes_ctx_t *irk, uint32_t prand);
+
+void                      beacon_rpa_generate  (const beacon_aes_ctx_t *irk, uint32_t prand,
+                                                wiced_bt_device_address_t rpa);
+
+wiced_bool_t              beacon_rpa_resolve   (const beacon_aes_ctx_t *irk,
+                                                const wiced_bt_device_address_t rpa);
+
+wiced_result_t            beacon_rpa_enable    (beacon_slot_t *p_slot,
+                                                const uint8_t irk[BEACON_RPA_IRK_LEN],
+                                                uint32_t period_ms);
+
+void                      beacon_rpa_fill      (const beacon_slot_t *p_slot,
+                                                wiced_bt_ble_multi_adv_params_t *p_params);
+
+const beacon_rpa_stats_t *beacon_rpa_get_stats (const beacon_slot_t *p_slot);
+
+#endif      /* __BEACON_RPA_H__ */
+
+
+/* [] END OF FILE */
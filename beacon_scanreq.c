@@ -0,0 +1,378 @@
+/******************************************************************************
+* File Name: beacon_scanreq.c
+*
+* Description: This is the source code for the scan request analytics.
+* Recording a request hashes the requester address once, then increments
+* two counters and raises one sketch register. Buckets move on only when
+* a request or a snapshot finds the current one expired, and the distinct
+* estimate is computed from the sketch when a snapshot is taken.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "cy_pdl.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include "beacon_scanreq.h"
+#include "beacon_stats.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#if (BEACON_SCANREQ_HLL_BITS < 4) || (BEACON_SCANREQ_HLL_BITS > 8)
+#error "BEACON_SCANREQ_HLL_BITS must be 4 to 8"
+#endif
+
+/* Bias correction of the sketch estimate, in 1/65536 */
+#if (BEACON_SCANREQ_HLL_BITS == 4)
+#define SCANREQ_ALPHA_Q16                (44106UL)
+#elif (BEACON_SCANREQ_HLL_BITS == 5)
+#define SCANREQ_ALPHA_Q16                (45679UL)
+#elif (BEACON_SCANREQ_HLL_BITS == 6)
+#define SCANREQ_ALPHA_Q16                (46465UL)
+#else
+#define SCANREQ_ALPHA_Q16                ((47271UL * BEACON_SCANREQ_REGISTERS * 1000UL) / \
+                                          ((BEACON_SCANREQ_REGISTERS * 1000UL) + 1079UL))
+#endif
+
+/* Natural logarithm of 2, in 1/65536 */
+#define SCANREQ_LN2_Q16                  (45426UL)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Counters of an instance */
+typedef struct
+{
+    uint32_t total;                             /* Requests since the reset */
+    uint32_t buckets[BEACON_SCANREQ_BUCKETS];   /* Requests per bucket */
+    uint8_t registers[BEACON_SCANREQ_REGISTERS]; /* Largest rank seen per register */
+}scanreq_instance_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static scanreq_instance_t scanreq_instances[BEACON_SLOT_MAX_INSTANCES];
+static uint32_t           scanreq_bucket;               /* Current bucket */
+static uint32_t           scanreq_bucket_start_ms;      /* Start of the current bucket */
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_scanreq_hash
+*********************************************************************************
+* Summary:
+*   Mixes a device address into 32 well distributed bits
+*
+*********************************************************************************/
+static uint32_t beacon_scanreq_hash(const wiced_bt_device_address_t bd_addr)
+{
+    uint32_t hash = ((uint32_t)bd_addr[0] << 24) | ((uint32_t)bd_addr[1] << 16) |
+                    ((uint32_t)bd_addr[2] << 8) | bd_addr[3];
+
+    hash ^= (((uint32_t)bd_addr[4] << 8) | bd_addr[5]) * 0x9E3779B1UL;
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BUL;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35UL;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+/********************************************************************************
+* Function Name: beacon_scanreq_roll
+*********************************************************************************
+* Summary:
+*   Moves to the bucket of now_ms, clearing the buckets passed. Call with
+*   interrupts disabled.
+*
+*********************************************************************************/
+static void beacon_scanreq_roll(uint32_t now_ms)
+{
+    uint32_t passed = (now_ms - scanreq_bucket_start_ms) / BEACON_SCANREQ_BUCKET_MS;
+
+    scanreq_bucket_start_ms += passed * BEACON_SCANREQ_BUCKET_MS;
+    if (passed > BEACON_SCANREQ_BUCKETS)
+    {
+        passed = BEACON_SCANREQ_BUCKETS;
+    }
+
+    while (passed-- > 0)
+    {
+        scanreq_bucket = (scanreq_bucket + 1) % BEACON_SCANREQ_BUCKETS;
+        for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+        {
+            scanreq_instances[i].buckets[scanreq_bucket] = 0;
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_scanreq_log2_q16
+*********************************************************************************
+* Summary:
+*   Returns the base 2 logarithm of a positive integer in 1/65536, by
+*   repeated squaring of the mantissa
+*
+*********************************************************************************/
+static uint32_t beacon_scanreq_log2_q16(uint32_t x)
+{
+    uint32_t n = 31 - __CLZ(x);
+    uint64_t y = (uint64_t)x << (31 - n);       /* Mantissa in [1, 2), 31 fraction bits */
+    uint32_t result = n << 16;
+
+    for (uint32_t bit = 1UL << 15; 0 != bit; bit >>= 1)
+    {
+        y = (y * y) >> 31;
+        if (y >= (1ULL << 32))
+        {
+            y >>= 1;
+            result |= bit;
+        }
+    }
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_scanreq_init
+*********************************************************************************
+* Summary:
+*   Clears the counters and starts the first bucket
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_scanreq_init(void)
+{
+    memset(scanreq_instances, 0, sizeof(scanreq_instances));
+    scanreq_bucket          = 0;
+    scanreq_bucket_start_ms = beacon_stats_now_ms();
+}
+
+/********************************************************************************
+* Function Name: beacon_scanreq_set_scannable
+*********************************************************************************
+* Summary:
+*   Makes an instance scannable, so scanners may send it scan requests, or
+*   non-connectable again. Call from the beacon manager task.
+*
+* Parameters:
+*   p_slot:                 Slot
+*   scannable:              WICED_TRUE to accept scan requests
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the parameters were issued,
+*   WICED_BT_SUCCESS if the instance already is in that mode
+*
+*********************************************************************************/
+wiced_result_t beacon_scanreq_set_scannable(beacon_slot_t *p_slot, wiced_bool_t scannable)
+{
+    wiced_bt_ble_multi_adv_params_t params = p_slot->params;
+
+    params.adv_type = scannable ? MULTI_ADVERT_DISCOVERABLE_EVENT :
+                                  MULTI_ADVERT_NONCONNECTABLE_EVENT;
+    if (params.adv_type == p_slot->params.adv_type)
+    {
+        return WICED_BT_SUCCESS;
+    }
+    return beacon_slot_set_params(p_slot, &params);
+}
+
+/********************************************************************************
+* Function Name: beacon_scanreq_record
+*********************************************************************************
+* Summary:
+*   Counts a scan request received by an instance. Called on the event path,
+*   from a task.
+*
+* Parameters:
+*   instance:               Multi-adv instance that received the request
+*   bd_addr:                Address of the scanner
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_scanreq_record(uint8_t instance, const wiced_bt_device_address_t bd_addr)
+{
+    scanreq_instance_t *p_inst;
+    uint32_t hash;
+    uint32_t index;
+    uint8_t rank;
+    uint32_t now_ms;
+
+    if ((0 == instance) || (instance > BEACON_SLOT_MAX_INSTANCES))
+    {
+        return;
+    }
+    p_inst = &scanreq_instances[instance - 1];
+
+    /* The top bits select the register, the rank is the position of the
+     * first set bit of the others; the sentinel bounds it */
+    hash  = beacon_scanreq_hash(bd_addr);
+    index = hash >> (32 - BEACON_SCANREQ_HLL_BITS);
+    rank  = (uint8_t)(__CLZ((hash << BEACON_SCANREQ_HLL_BITS) |
+                            (1UL << (BEACON_SCANREQ_HLL_BITS - 1))) + 1);
+    now_ms = beacon_stats_now_ms();
+
+    taskENTER_CRITICAL();
+    if ((now_ms - scanreq_bucket_start_ms) >= BEACON_SCANREQ_BUCKET_MS)
+    {
+        beacon_scanreq_roll(now_ms);
+    }
+    p_inst->total++;
+    p_inst->buckets[scanreq_bucket]++;
+    if (rank > p_inst->registers[index])
+    {
+        p_inst->registers[index] = rank;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/********************************************************************************
+* Function Name: beacon_scanreq_estimate
+*********************************************************************************
+* Summary:
+*   Estimates the distinct requesters of a sketch, with linear counting
+*   while many registers are still empty. Sketches of several beacons are
+*   merged by taking the larger of each register.
+*
+* Parameters:
+*   registers:              Sketch
+*
+* Return:
+*   Estimated number of distinct requesters
+*
+*********************************************************************************/
+uint32_t beacon_scanreq_estimate(const uint8_t registers[BEACON_SCANREQ_REGISTERS])
+{
+    uint64_t sum = 0;
+    uint32_t empty = 0;
+    uint64_t estimate;
+
+    for (uint32_t i = 0; i < BEACON_SCANREQ_REGISTERS; i++)
+    {
+        sum   += 1ULL << (32 - registers[i]);
+        empty += (0 == registers[i]) ? 1 : 0;
+    }
+
+    estimate = (((uint64_t)SCANREQ_ALPHA_Q16 * BEACON_SCANREQ_REGISTERS *
+                 BEACON_SCANREQ_REGISTERS) << 16) / sum;
+
+    if ((estimate <= ((5 * BEACON_SCANREQ_REGISTERS) / 2)) && (0 != empty))
+    {
+        estimate = ((uint64_t)BEACON_SCANREQ_REGISTERS *
+                    (beacon_scanreq_log2_q16(BEACON_SCANREQ_REGISTERS) -
+                     beacon_scanreq_log2_q16(empty)) * SCANREQ_LN2_Q16) >> 32;
+    }
+    return (uint32_t)estimate;
+}
+
+/********************************************************************************
+* Function Name: beacon_scanreq_get
+*********************************************************************************
+* Summary:
+*   Takes a snapshot of the counters of an instance
+*
+* Parameters:
+*   instance:               Multi-adv instance
+*   p_snapshot:             Snapshot
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_scanreq_get(uint8_t instance, beacon_scanreq_snapshot_t *p_snapshot)
+{
+    const scanreq_instance_t *p_inst;
+
+    memset(p_snapshot, 0, sizeof(*p_snapshot));
+    p_snapshot->bucket_ms = BEACON_SCANREQ_BUCKET_MS;
+    if ((0 == instance) || (instance > BEACON_SLOT_MAX_INSTANCES))
+    {
+        return;
+    }
+    p_inst = &scanreq_instances[instance - 1];
+
+    taskENTER_CRITICAL();
+    beacon_scanreq_roll(beacon_stats_now_ms());
+    p_snapshot->total = p_inst->total;
+    for (uint32_t k = 0; k < BEACON_SCANREQ_BUCKETS; k++)
+    {
+        p_snapshot->buckets[k] =
+            p_inst->buckets[(scanreq_bucket + 1 + k) % BEACON_SCANREQ_BUCKETS];
+    }
+    memcpy(p_snapshot->registers, p_inst->registers, sizeof(p_snapshot->registers));
+    taskEXIT_CRITICAL();
+
+    p_snapshot->distinct = beacon_scanreq_estimate(p_snapshot->registers);
+}
+
+/********************************************************************************
+* Function Name: beacon_scanreq_reset
+*********************************************************************************
+* Summary:
+*   Clears the counters of an instance
+*
+* Parameters:
+*   instance:               Multi-adv instance, 0 for all
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_scanreq_reset(uint8_t instance)
+{
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        if ((0 == instance) || (instance == (i + 1)))
+        {
+            memset(&scanreq_instances[i], 0, sizeof(scanreq_instances[i]));
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,111 @@
+/******************************************************************************
+* File Name: beacon_scanreq.h
+*
+* Description: This file contains the definitions for the scan request
+* analytics. A scannable instance counts the scan requests it receives, in
+* total and per time bucket, and estimates the number of distinct
+* requesters with a HyperLogLog sketch that stores nothing per device.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_SCANREQ_H__
+#define __BEACON_SCANREQ_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to count scan requests, see the scan and stats commands */
+#ifndef BEACON_SCANREQ_ENABLE
+#define BEACON_SCANREQ_ENABLE            (0)
+#endif
+
+/* Time buckets kept, the last one is the current */
+#ifndef BEACON_SCANREQ_BUCKET_MS
+#define BEACON_SCANREQ_BUCKET_MS         (60UL * 60UL * 1000UL)
+#endif
+
+#ifndef BEACON_SCANREQ_BUCKETS
+#define BEACON_SCANREQ_BUCKETS           (24)
+#endif
+
+/* The sketch has 2^BITS one-byte registers per instance, with a standard
+ * error of 1.04 / sqrt(2^BITS): 13% with 6 bits, 6.5% with 8 bits */
+#ifndef BEACON_SCANREQ_HLL_BITS
+#define BEACON_SCANREQ_HLL_BITS          (6)
+#endif
+
+#define BEACON_SCANREQ_REGISTERS         (1UL << BEACON_SCANREQ_HLL_BITS)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Counters of an instance since the last reset */
+typedef struct
+{
+    uint32_t total;                             /* Scan requests received */
+    uint32_t distinct;                          /* Estimated distinct requesters */
+    uint32_t bucket_ms;                         /* Length of a bucket */
+    uint32_t buckets[BEACON_SCANREQ_BUCKETS];   /* Requests per bucket, oldest first */
+    uint8_t registers[BEACON_SCANREQ_REGISTERS]; /* Sketch, to merge with other beacons
+                                                   by taking the larger register */
+}beacon_scanreq_snapshot_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void           beacon_scanreq_init           (void);
+
+wiced_result_t beacon_scanreq_set_scannable  (beacon_slot_t *p_slot, wiced_bool_t scannable);
+
+void           beacon_scanreq_record         (uint8_t instance,
+                                              const wiced_bt_device_address_t bd_addr);
+
+uint32_t       beacon_scanreq_estimate       (const uint8_t registers[BEACON_SCANREQ_REGISTERS]);
+
+void           beacon_scanreq_get            (uint8_t instance,
+                                              beacon_scanreq_snapshot_t *p_snapshot);
+
+void           beacon_scanreq_reset          (uint8_t instance);
+
+#endif      /* __BEACON_SCANREQ_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,1086 @@
+/******************************************************************************
+* File Name: beacon_sim.c
+*
+* Description: This is the source code for the simulated controller. Commands
+* are answered in issue order by a task standing in for the stack task, so
+* responses reach app_bt_management_callback asynchronously as on hardware.
+* Every command is recorded in an HCI level trace.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include "beacon_chmap.h"
+#include "beacon_scanreq.h"
+#include "beacon_sim.h"
+#include "beacon_stats.h"
+#include "beacon_utils.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define SIM_TRACE_MASK                   (BEACON_SIM_TRACE_SIZE - 1)
+
+#if (BEACON_SIM_TRACE_SIZE & SIM_TRACE_MASK)
+#error "BEACON_SIM_TRACE_SIZE must be a power of two"
+#endif
+
+/* HCI command packet: indicator, opcode and parameter length, then the
+ * sub-opcode and its parameters */
+#define SIM_HCI_HEADER_LEN               (4)
+#define SIM_HCI_PARAM_LEN                (SIM_HCI_HEADER_LEN + 24)
+#define SIM_HCI_DATA_LEN                 (SIM_HCI_HEADER_LEN + 3 + BEACON_ADV_DATA_MAX)
+#define SIM_HCI_ENABLE_LEN               (SIM_HCI_HEADER_LEN + 3)
+
+/* Advertising event timing: interval unit and the random advDelay */
+#define SIM_US_PER_INTERVAL              (625)
+#define SIM_ADV_DELAY_MAX_US             (10000)
+
+/* Scan requests and the traffic of other advertisers are generated this
+ * often when there is an audience or a busy channel */
+#define SIM_AUDIENCE_TICK_MS             (100)
+
+/* Airtime of an advertising packet of another advertiser */
+#define SIM_AMBIENT_PACKET_US            (376)
+
+/* Queued to make the controller task schedule the scan reports again, it is
+ * not a command and never answered */
+#define SIM_EVT_WAKE                     (0xFF)
+
+/* No report or tick is due */
+#define SIM_WAIT_FOREVER                 (0xFFFFFFFFUL)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Command accepted by the simulated controller */
+typedef struct
+{
+    uint8_t event;                              /* wiced_bt_management_evt_t */
+    uint8_t opcode;                             /* wiced_bt_multi_adv_opcodes_t */
+    uint8_t instance;                           /* Multi-adv instance */
+    uint8_t arg;                                /* Start/stop for enable commands,
+                                                   advertising type for params */
+    uint8_t channel_map;                        /* Channel map of params commands */
+    uint16_t interval;                          /* Minimum interval of params commands */
+    uint8_t epoch;                              /* Boot the command was accepted in */
+    uint32_t trace_index;                       /* Trace record of the command */
+}sim_cmd_t;
+
+/* Advertising state of an instance, changed by successful responses */
+typedef struct
+{
+    wiced_bool_t advertising;                   /* Instance is started */
+    wiced_bool_t scannable;                     /* Instance answers scan requests */
+    uint8_t channel_map;                        /* Primary channels of the events */
+    uint16_t interval;                          /* Advertising interval, 0.625 ms units */
+    uint64_t next_event_us;                     /* Time of the next advertising event */
+    uint32_t events;                            /* Advertising events since the reset */
+}sim_adv_t;
+
+/* Advertiser around the device and the time of its next report */
+typedef struct
+{
+    beacon_sim_remote_t remote;                 /* Unused when period_ms is 0 */
+    uint32_t next_report_ms;                    /* Time of the next report */
+}sim_remote_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_sim_config_t           sim_config =
+{
+    .boot_ms       = BEACON_SIM_BOOT_MS,
+    .latency_ms    = BEACON_SIM_LATENCY_MS,
+    .fail_period   = 0,
+    .fail_opcodes  = 0,
+    .max_instances = BEACON_SIM_MAX_INSTANCES,
+    .audience      = BEACON_SIM_AUDIENCE,
+    .scan_percent  = BEACON_SIM_SCAN_PERCENT,
+    .channel_busy  = { BEACON_SIM_CHANNEL_BUSY_37, BEACON_SIM_CHANNEL_BUSY_38,
+                       BEACON_SIM_CHANNEL_BUSY_39 }
+};
+
+static wiced_bt_management_cback_t  *sim_cback;
+static uint32_t                      sim_fail_counter;
+static volatile uint32_t             sim_outstanding;
+
+/* Commands of an earlier boot are dropped, none are accepted while booting */
+static volatile uint8_t              sim_epoch;
+static volatile wiced_bool_t         sim_booting;
+
+static beacon_sim_stats_t            sim_stats;
+static beacon_sim_trace_t            sim_trace[BEACON_SIM_TRACE_SIZE];
+static uint32_t                      sim_trace_count;
+
+static sim_adv_t                     sim_adv[BEACON_SIM_MAX_INSTANCES];
+static uint32_t                      sim_adv_seed = 1;
+static uint32_t                      sim_tick_ms;
+
+static sim_remote_t                  sim_remote[BEACON_SIM_MAX_REMOTES];
+static wiced_bt_ble_scan_result_cback_t *sim_scan_cback;
+
+static const wiced_bt_device_address_t sim_local_addr = { 0x00, 0xA0, 0x50, 0x51, 0x4D, 0x01 };
+
+static QueueHandle_t                 sim_queue;
+static StaticQueue_t                 sim_queue_buffer;
+static uint8_t                       sim_queue_storage[BEACON_SIM_QUEUE_SIZE * sizeof(sim_cmd_t)];
+
+static TaskHandle_t                  sim_task_handle;
+static StaticTask_t                  sim_task_tcb;
+static StackType_t                   sim_task_stack[BEACON_SIM_TASK_STACK_SIZE];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_sim_status
+*********************************************************************************
+* Summary:
+*   Decides the response status of a command, with the instance limit and
+*   the injected failures
+*
+*********************************************************************************/
+static uint8_t beacon_sim_status(const sim_cmd_t *p_cmd)
+{
+    if ((0 == p_cmd->instance) || (p_cmd->instance > sim_config.max_instances))
+    {
+        return BEACON_SIM_STATUS_UNKNOWN_ADV;
+    }
+
+    if ((0 != sim_config.fail_period) && (0 != (sim_config.fail_opcodes & (1U << p_cmd->opcode))))
+    {
+        if (0 == (++sim_fail_counter % sim_config.fail_period))
+        {
+            return BEACON_SIM_STATUS_FAILED;
+        }
+    }
+    return WICED_SUCCESS;
+}
+
+#if BEACON_SCANREQ_ENABLE
+/********************************************************************************
+* Function Name: beacon_sim_scan_request
+*********************************************************************************
+* Summary:
+*   Decides whether an advertising event of a scannable instance is scanned
+*   and by which scanner of the audience, then reports the scan request
+*
+*********************************************************************************/
+static void beacon_sim_scan_request(uint8_t instance)
+{
+    wiced_bt_device_address_t bd_addr = { 0xC0, 0x5C, 0xA7, 0, 0, 0 };
+    uint32_t scanner;
+
+    sim_adv_seed = (sim_adv_seed * 1103515245UL) + 12345UL;
+    if (((sim_adv_seed >> 16) % 100) >= sim_config.scan_percent)
+    {
+        return;
+    }
+
+    sim_adv_seed = (sim_adv_seed * 1103515245UL) + 12345UL;
+    scanner = (sim_adv_seed >> 16) % sim_config.audience;
+    bd_addr[4] = (uint8_t)(scanner >> 8);
+    bd_addr[5] = (uint8_t)scanner;
+
+    beacon_scanreq_record(instance, bd_addr);
+}
+#endif
+
+#if BEACON_CHMAP_ENABLE
+/********************************************************************************
+* Function Name: beacon_sim_collide
+*********************************************************************************
+* Summary:
+*   Decides which packets of an advertising event collide with other
+*   advertisers, each with the busy percentage of its channel, and reports
+*   them as lost
+*
+*********************************************************************************/
+static void beacon_sim_collide(uint8_t channel_map)
+{
+    if (0 == (channel_map & BEACON_CHMAP_ALL))
+    {
+        channel_map = BEACON_CHMAP_ALL;
+    }
+
+    for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+    {
+        if (0 == (channel_map & (1U << ch)))
+        {
+            continue;
+        }
+        sim_adv_seed = (sim_adv_seed * 1103515245UL) + 12345UL;
+        if (((sim_adv_seed >> 16) % 100) < sim_config.channel_busy[ch])
+        {
+            beacon_chmap_observe(BEACON_CHMAP_FIRST_CHANNEL + ch, 0, 1);
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_ambient
+*********************************************************************************
+* Summary:
+*   Reports the packets of other advertisers heard on every channel during
+*   one audience tick
+*
+*********************************************************************************/
+static void beacon_sim_ambient(void)
+{
+    for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+    {
+        beacon_chmap_observe(BEACON_CHMAP_FIRST_CHANNEL + ch,
+                             ((uint32_t)sim_config.channel_busy[ch] * SIM_AUDIENCE_TICK_MS * 10) /
+                             SIM_AMBIENT_PACKET_US, 0);
+    }
+}
+#endif
+
+/********************************************************************************
+* Function Name: beacon_sim_adv_advance
+*********************************************************************************
+* Summary:
+*   Counts the advertising events of an instance up to now_us. Events are
+*   one interval apart plus a pseudo-random advDelay of 0-10 ms, as the
+*   link layer schedules them. Call with interrupts disabled.
+*
+*********************************************************************************/
+static void beacon_sim_adv_advance(sim_adv_t *p_adv, uint64_t now_us)
+{
+    if (!p_adv->advertising || (0 == p_adv->interval))
+    {
+        return;
+    }
+
+    while (p_adv->next_event_us <= now_us)
+    {
+        p_adv->events++;
+#if BEACON_SCANREQ_ENABLE
+        if (p_adv->scannable && (0 != sim_config.audience))
+        {
+            beacon_sim_scan_request((uint8_t)(p_adv - sim_adv) + 1);
+        }
+#endif
+#if BEACON_CHMAP_ENABLE
+        beacon_sim_collide(p_adv->channel_map);
+#endif
+        /* Scaled rather than taken modulo, which would favour the short
+         * delays and shift the mean below 5 ms */
+        sim_adv_seed = (sim_adv_seed * 1103515245UL) + 12345UL;
+        p_adv->next_event_us += ((uint32_t)p_adv->interval * SIM_US_PER_INTERVAL) +
+                                (((sim_adv_seed >> 16) * (SIM_ADV_DELAY_MAX_US + 1)) >> 16);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_adv_apply
+*********************************************************************************
+* Summary:
+*   Applies a successful params or enable command to the advertising state
+*
+*********************************************************************************/
+static void beacon_sim_adv_apply(const sim_cmd_t *p_cmd, uint32_t now_ms)
+{
+    sim_adv_t *p_adv;
+    uint64_t now_us = (uint64_t)now_ms * 1000;
+
+    if (p_cmd->instance > BEACON_SIM_MAX_INSTANCES)
+    {
+        return;
+    }
+    p_adv = &sim_adv[p_cmd->instance - 1];
+
+    taskENTER_CRITICAL();
+    beacon_sim_adv_advance(p_adv, now_us);
+
+    if (SET_ADVT_PARAM_MULTI == p_cmd->opcode)
+    {
+        p_adv->interval    = p_cmd->interval;
+        p_adv->channel_map = p_cmd->channel_map;
+        p_adv->scannable = ((MULTI_ADVERT_CONNECTABLE_UNDIRECT_EVENT == p_cmd->arg) ||
+                            (MULTI_ADVERT_DISCOVERABLE_EVENT == p_cmd->arg)) ? WICED_TRUE :
+                                                                               WICED_FALSE;
+    }
+    else if (SET_ADVT_ENABLE_MULTI == p_cmd->opcode)
+    {
+        if ((MULTI_ADVERT_START == p_cmd->arg) && !p_adv->advertising)
+        {
+            p_adv->next_event_us = now_us;
+        }
+        p_adv->advertising = (MULTI_ADVERT_START == p_cmd->arg) ? WICED_TRUE : WICED_FALSE;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_scan
+*********************************************************************************
+* Summary:
+*   Reports the advertisers that are due while scanning, through the scan
+*   result callback in the controller task as the stack does. Reports due
+*   while the controller was busy are not made up. Returns the time until
+*   the next report, SIM_WAIT_FOREVER if there is none.
+*
+*********************************************************************************/
+static uint32_t beacon_sim_scan(uint32_t now_ms)
+{
+    wiced_bt_ble_scan_result_cback_t *p_cback = sim_scan_cback;
+    wiced_bt_ble_scan_results_t result;
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint32_t wait_ms = SIM_WAIT_FOREVER;
+    sim_remote_t *p_remote;
+    wiced_bool_t due;
+
+    if (NULL == p_cback)
+    {
+        return SIM_WAIT_FOREVER;
+    }
+
+    for (uint8_t i = 0; i < BEACON_SIM_MAX_REMOTES; i++)
+    {
+        p_remote = &sim_remote[i];
+
+        taskENTER_CRITICAL();
+        due = ((0 != p_remote->remote.period_ms) &&
+               ((int32_t)(p_remote->next_report_ms - now_ms) <= 0)) ? WICED_TRUE : WICED_FALSE;
+        if (due)
+        {
+            memset(&result, 0, sizeof(result));
+            memcpy(result.remote_bd_addr, p_remote->remote.bd_addr, BD_ADDR_LEN);
+            result.rssi = p_remote->remote.rssi;
+            memcpy(adv_data, p_remote->remote.adv_data, BEACON_ADV_DATA_MAX);
+
+            p_remote->next_report_ms += p_remote->remote.period_ms;
+            if ((int32_t)(p_remote->next_report_ms - now_ms) <= 0)
+            {
+                p_remote->next_report_ms = now_ms + p_remote->remote.period_ms;
+            }
+        }
+        if ((0 != p_remote->remote.period_ms) &&
+            ((p_remote->next_report_ms - now_ms) < wait_ms))
+        {
+            wait_ms = p_remote->next_report_ms - now_ms;
+        }
+        taskEXIT_CRITICAL();
+
+        if (due)
+        {
+            sim_stats.scan_reports++;
+            p_cback(&result, adv_data);
+        }
+    }
+    return wait_ms;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_wake
+*********************************************************************************
+* Summary:
+*   Makes the controller task schedule the scan reports again. A full queue
+*   wakes it anyway.
+*
+*********************************************************************************/
+static void beacon_sim_wake(void)
+{
+    sim_cmd_t cmd = { .event = SIM_EVT_WAKE };
+
+    if (NULL != sim_queue)
+    {
+        (void)xQueueSend(sim_queue, &cmd, 0);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_delay
+*********************************************************************************
+* Summary:
+*   Spends the boot time or the latency of a command, scanning meanwhile as
+*   the controller does
+*
+*********************************************************************************/
+static void beacon_sim_delay(uint32_t delay_ms)
+{
+    uint32_t now_ms = beacon_stats_now_ms();
+    uint32_t end_ms = now_ms + delay_ms;
+    uint32_t wait_ms;
+
+    while ((int32_t)(end_ms - now_ms) > 0)
+    {
+        wait_ms = beacon_sim_scan(now_ms);
+        if (wait_ms > (end_ms - now_ms))
+        {
+            wait_ms = end_ms - now_ms;
+        }
+        vTaskDelay(pdMS_TO_TICKS(wait_ms));
+        now_ms = beacon_stats_now_ms();
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_ticking
+*********************************************************************************
+* Summary:
+*   Returns whether the controller task has to wake up between commands
+*
+*********************************************************************************/
+static wiced_bool_t beacon_sim_ticking(void)
+{
+    if (0 != sim_config.audience)
+    {
+        return WICED_TRUE;
+    }
+#if BEACON_CHMAP_ENABLE
+    for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+    {
+        if (0 != sim_config.channel_busy[ch])
+        {
+            return WICED_TRUE;
+        }
+    }
+#endif
+    return WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_task
+*********************************************************************************
+* Summary:
+*   Answers the accepted commands one at a time after the configured latency,
+*   and reports the advertisers heard while scanning between them
+*
+*********************************************************************************/
+static void beacon_sim_task(void *arg)
+{
+    sim_cmd_t cmd;
+    wiced_bt_management_evt_data_t evt_data;
+    beacon_sim_trace_t *p_trace;
+    uint32_t now_ms;
+    uint32_t wait_ms;
+    uint64_t now_us;
+    uint8_t status;
+
+    (void)arg;
+
+    for (;;)
+    {
+        now_ms  = beacon_stats_now_ms();
+        wait_ms = beacon_sim_scan(now_ms);
+
+        /* With an audience or busy channels, wake up to generate the scan
+         * requests and the traffic of others meanwhile */
+        if (beacon_sim_ticking())
+        {
+            if ((int32_t)(now_ms - sim_tick_ms) >= 0)
+            {
+                sim_tick_ms = now_ms + SIM_AUDIENCE_TICK_MS;
+                now_us      = (uint64_t)now_ms * 1000;
+
+                taskENTER_CRITICAL();
+                for (uint8_t i = 0; i < BEACON_SIM_MAX_INSTANCES; i++)
+                {
+                    beacon_sim_adv_advance(&sim_adv[i], now_us);
+                }
+                taskEXIT_CRITICAL();
+#if BEACON_CHMAP_ENABLE
+                beacon_sim_ambient();
+#endif
+            }
+            if ((sim_tick_ms - now_ms) < wait_ms)
+            {
+                wait_ms = sim_tick_ms - now_ms;
+            }
+        }
+
+        if (pdTRUE != xQueueReceive(sim_queue, &cmd, (SIM_WAIT_FOREVER == wait_ms) ?
+                                    portMAX_DELAY : pdMS_TO_TICKS(wait_ms)))
+        {
+            continue;
+        }
+
+        if (SIM_EVT_WAKE == cmd.event)
+        {
+            continue;
+        }
+
+        if (cmd.epoch != sim_epoch)
+        {
+            /* The controller was restarted, the command is lost */
+            sim_outstanding--;
+            continue;
+        }
+
+        if (BTM_ENABLED_EVT == cmd.event)
+        {
+            beacon_sim_delay(sim_config.boot_ms);
+            sim_stats.enabled_ms = beacon_stats_now_ms();
+            sim_booting = WICED_FALSE;
+            evt_data.enabled.status = WICED_BT_SUCCESS;
+            sim_cback(BTM_ENABLED_EVT, &evt_data);
+            sim_outstanding--;
+            continue;
+        }
+
+        beacon_sim_delay(sim_config.latency_ms);
+        status = beacon_sim_status(&cmd);
+        now_ms = beacon_stats_now_ms();
+
+        taskENTER_CRITICAL();
+        p_trace = &sim_trace[cmd.trace_index & SIM_TRACE_MASK];
+        p_trace->resp_ms = now_ms;
+        p_trace->status  = status;
+        taskEXIT_CRITICAL();
+
+        sim_stats.last_resp_ms = now_ms;
+        if (WICED_SUCCESS != status)
+        {
+            sim_stats.failed++;
+        }
+        else
+        {
+            beacon_sim_adv_apply(&cmd, now_ms);
+
+            if ((SET_ADVT_ENABLE_MULTI == cmd.opcode) && (MULTI_ADVERT_START == cmd.arg) &&
+                (0 == sim_stats.first_adv_ms))
+            {
+                sim_stats.first_adv_ms = now_ms;
+            }
+        }
+
+        evt_data.ble_multi_adv_response_event.opcode = cmd.opcode;
+        evt_data.ble_multi_adv_response_event.status = status;
+        sim_cback(BTM_MULTI_ADVERT_RESP_EVENT, &evt_data);
+        sim_outstanding--;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_issue
+*********************************************************************************
+* Summary:
+*   Records a command in the trace and queues it for its response. The
+*   record is written first because the controller task may answer before
+*   the queue call returns. Callers are serialized by the slot layer.
+*
+*********************************************************************************/
+static wiced_result_t beacon_sim_issue(uint8_t opcode, uint8_t instance, uint8_t arg,
+                                       uint8_t channel_map, uint16_t interval, uint8_t hci_len)
+{
+    sim_cmd_t cmd;
+    beacon_sim_trace_t *p_trace;
+
+    if ((NULL == sim_queue) || sim_booting)
+    {
+        return WICED_BT_ERROR;
+    }
+
+    cmd.event       = BTM_MULTI_ADVERT_RESP_EVENT;
+    cmd.epoch       = sim_epoch;
+    cmd.opcode      = opcode;
+    cmd.instance    = instance;
+    cmd.arg         = arg;
+    cmd.channel_map = channel_map;
+    cmd.interval    = interval;
+
+    taskENTER_CRITICAL();
+    cmd.trace_index      = sim_trace_count++;
+    p_trace              = &sim_trace[cmd.trace_index & SIM_TRACE_MASK];
+    p_trace->issue_ms    = beacon_stats_now_ms();
+    p_trace->resp_ms     = 0;
+    p_trace->hci_opcode  = BEACON_SIM_HCI_MULTI_ADV;
+    p_trace->sub_opcode  = opcode;
+    p_trace->instance    = instance;
+    p_trace->hci_len     = hci_len;
+    p_trace->status      = WICED_SUCCESS;
+    sim_outstanding++;
+    taskEXIT_CRITICAL();
+
+    if (pdTRUE != xQueueSend(sim_queue, &cmd, 0))
+    {
+        taskENTER_CRITICAL();
+        sim_trace_count--;
+        sim_outstanding--;
+        taskEXIT_CRITICAL();
+        sim_stats.rejected++;
+        return WICED_BT_NO_RESOURCES;
+    }
+
+    sim_stats.commands++;
+    sim_stats.hci_bytes += hci_len;
+    return WICED_BT_PENDING;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_configure
+*********************************************************************************
+* Summary:
+*   Sets the latency, failure injection and instance limit of the simulated
+*   controller. Takes effect with the next response.
+*
+* Parameters:
+*   p_config:               Controller behavior
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_sim_configure(const beacon_sim_config_t *p_config)
+{
+    taskENTER_CRITICAL();
+    sim_config       = *p_config;
+    sim_fail_counter = 0;
+    taskEXIT_CRITICAL();
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_get_config
+*********************************************************************************
+* Summary:
+*   Returns the current behavior of the simulated controller
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Pointer to the configuration
+*
+*********************************************************************************/
+const beacon_sim_config_t *beacon_sim_get_config(void)
+{
+    return &sim_config;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_stack_init
+*********************************************************************************
+* Summary:
+*   Stand-in for wiced_bt_stack_init. Starts the controller task, which
+*   reports BTM_ENABLED_EVT after the configured boot time.
+*
+* Parameters:
+*   p_cback:                Management callback of the application
+*   p_cfg:                  Stack configuration, unused
+*
+* Return:
+*   wiced_result_t: WICED_BT_SUCCESS
+*
+*********************************************************************************/
+wiced_result_t beacon_sim_stack_init(wiced_bt_management_cback_t *p_cback,
+                                     const wiced_bt_cfg_settings_t *p_cfg)
+{
+    sim_cmd_t cmd = { .event = BTM_ENABLED_EVT, .epoch = sim_epoch };
+
+    (void)p_cfg;
+
+    sim_cback = p_cback;
+    beacon_sim_reset_stats();
+    sim_stats.init_ms = beacon_stats_now_ms();
+
+    if (NULL == sim_queue)
+    {
+        sim_queue = xQueueCreateStatic(BEACON_SIM_QUEUE_SIZE, sizeof(sim_cmd_t),
+                                       sim_queue_storage, &sim_queue_buffer);
+        sim_task_handle = xTaskCreateStatic(beacon_sim_task, "Sim controller",
+                                            BEACON_SIM_TASK_STACK_SIZE, NULL,
+                                            BEACON_SIM_TASK_PRIORITY,
+                                            sim_task_stack, &sim_task_tcb);
+    }
+
+    sim_booting = WICED_TRUE;
+    sim_outstanding++;
+    xQueueSend(sim_queue, &cmd, 0);
+
+    return WICED_BT_SUCCESS;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_restart
+*********************************************************************************
+* Summary:
+*   Restarts the simulated controller as after a reset of the stack. The
+*   instances are lost, commands awaiting a response are never answered and
+*   new commands are refused until BTM_ENABLED_EVT is reported again.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_sim_restart(void)
+{
+    sim_cmd_t cmd = { .event = BTM_ENABLED_EVT };
+    uint64_t now_us = (uint64_t)beacon_stats_now_ms() * 1000;
+
+    if (NULL == sim_queue)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < BEACON_SIM_MAX_INSTANCES; i++)
+    {
+        beacon_sim_adv_advance(&sim_adv[i], now_us);
+        sim_adv[i].advertising = WICED_FALSE;
+        sim_adv[i].scannable   = WICED_FALSE;
+    }
+    sim_epoch++;
+    sim_booting = WICED_TRUE;
+    cmd.epoch   = sim_epoch;
+    sim_outstanding++;
+    taskEXIT_CRITICAL();
+
+    xQueueSend(sim_queue, &cmd, 0);
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_set_data
+*********************************************************************************
+* Summary:
+*   Stand-in for wiced_set_multi_advertisement_data
+*
+* Parameters:
+*   p_data:                 Advertisement data
+*   data_len:               Length of the advertisement data
+*   adv_instance:           Multi-adv instance
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the command was accepted
+*
+*********************************************************************************/
+wiced_result_t beacon_sim_set_data(uint8_t *p_data, uint8_t data_len, uint8_t adv_instance)
+{
+    if ((NULL == p_data) || (data_len > BEACON_ADV_DATA_MAX))
+    {
+        return WICED_BT_BADARG;
+    }
+    return beacon_sim_issue(SET_ADVT_DATA_MULTI, adv_instance, 0, 0, 0, SIM_HCI_DATA_LEN);
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_set_params
+*********************************************************************************
+* Summary:
+*   Stand-in for wiced_set_multi_advertisement_params
+*
+* Parameters:
+*   adv_instance:           Multi-adv instance
+*   p_param:                Advertising parameters
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the command was accepted
+*
+*********************************************************************************/
+wiced_result_t beacon_sim_set_params(uint8_t adv_instance, wiced_bt_ble_multi_adv_params_t *p_param)
+{
+    if (NULL == p_param)
+    {
+        return WICED_BT_BADARG;
+    }
+    return beacon_sim_issue(SET_ADVT_PARAM_MULTI, adv_instance, (uint8_t)p_param->adv_type,
+                            p_param->channel_map, p_param->adv_int_min, SIM_HCI_PARAM_LEN);
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_start
+*********************************************************************************
+* Summary:
+*   Stand-in for wiced_start_multi_advertisements
+*
+* Parameters:
+*   advertising_enable:     MULTI_ADVERT_START or MULTI_ADVERT_STOP
+*   adv_instance:           Multi-adv instance
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the command was accepted
+*
+*********************************************************************************/
+wiced_result_t beacon_sim_start(uint8_t advertising_enable, uint8_t adv_instance)
+{
+    return beacon_sim_issue(SET_ADVT_ENABLE_MULTI, adv_instance, advertising_enable, 0, 0,
+                            SIM_HCI_ENABLE_LEN);
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_observe
+*********************************************************************************
+* Summary:
+*   Stand-in for wiced_bt_ble_observe. While scanning, the advertisers set
+*   with beacon_sim_set_remote are reported through p_cback, each once per
+*   period. The scan continues over a restart of the controller.
+*
+* Parameters:
+*   start:                  WICED_TRUE to start scanning
+*   duration:               Scan duration, unused, the scan runs until stopped
+*   p_cback:                Scan result callback
+*
+* Return:
+*   wiced_result_t: WICED_BT_SUCCESS
+*
+*********************************************************************************/
+wiced_result_t beacon_sim_observe(wiced_bool_t start, uint8_t duration,
+                                  wiced_bt_ble_scan_result_cback_t *p_cback)
+{
+    (void)duration;
+
+    if (start && (NULL == p_cback))
+    {
+        return WICED_BT_BADARG;
+    }
+
+    taskENTER_CRITICAL();
+    sim_scan_cback = start ? p_cback : NULL;
+    taskEXIT_CRITICAL();
+
+    beacon_sim_wake();
+    return WICED_BT_SUCCESS;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_set_remote
+*********************************************************************************
+* Summary:
+*   Adds, changes or removes an advertiser around the device. A new one is
+*   first reported at a pseudo-random time within its period, a changed one
+*   keeps its schedule.
+*
+* Parameters:
+*   p_remote:               Advertiser, matched by address. A period of 0
+*                           removes it.
+*
+* Return:
+*   wiced_bool_t: WICED_FALSE if BEACON_SIM_MAX_REMOTES advertisers are set
+*
+*********************************************************************************/
+wiced_bool_t beacon_sim_set_remote(const beacon_sim_remote_t *p_remote)
+{
+    sim_remote_t *p_entry = NULL;
+    sim_remote_t *p_free  = NULL;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; (i < BEACON_SIM_MAX_REMOTES) && (NULL == p_entry); i++)
+    {
+        if (0 == sim_remote[i].remote.period_ms)
+        {
+            p_free = (NULL == p_free) ? &sim_remote[i] : p_free;
+        }
+        else if (0 == memcmp(sim_remote[i].remote.bd_addr, p_remote->bd_addr, BD_ADDR_LEN))
+        {
+            p_entry = &sim_remote[i];
+        }
+    }
+
+    if ((NULL == p_entry) && (0 != p_remote->period_ms) && (NULL != p_free))
+    {
+        p_entry = p_free;
+        sim_adv_seed = (sim_adv_seed * 1103515245UL) + 12345UL;
+        p_entry->next_report_ms = beacon_stats_now_ms() +
+                                  ((sim_adv_seed >> 16) % p_remote->period_ms);
+    }
+
+    if (NULL != p_entry)
+    {
+        p_entry->remote = *p_remote;
+    }
+    taskEXIT_CRITICAL();
+
+    beacon_sim_wake();
+    return ((NULL != p_entry) || (0 == p_remote->period_ms)) ? WICED_TRUE : WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_read_local_addr
+*********************************************************************************
+* Summary:
+*   Stand-in for wiced_bt_dev_read_local_addr
+*
+* Parameters:
+*   bd_addr:                Output address
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_sim_read_local_addr(wiced_bt_device_address_t bd_addr)
+{
+    memcpy(bd_addr, sim_local_addr, sizeof(wiced_bt_device_address_t));
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_idle
+*********************************************************************************
+* Summary:
+*   Returns WICED_TRUE when every accepted command has been answered
+*
+* Parameters:
+*   None
+*
+* Return:
+*   wiced_bool_t: WICED_TRUE if no response is outstanding
+*
+*********************************************************************************/
+wiced_bool_t beacon_sim_idle(void)
+{
+    return (0 == sim_outstanding) ? WICED_TRUE : WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_reset_stats
+*********************************************************************************
+* Summary:
+*   Clears the counters and the trace
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_sim_reset_stats(void)
+{
+    uint64_t now_us = (uint64_t)beacon_stats_now_ms() * 1000;
+
+    taskENTER_CRITICAL();
+    for (uint8_t i = 0; i < BEACON_SIM_MAX_INSTANCES; i++)
+    {
+        beacon_sim_adv_advance(&sim_adv[i], now_us);
+        sim_adv[i].events = 0;
+    }
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    sim_stats.init_ms = beacon_stats_now_ms();
+    sim_trace_count   = 0;
+    taskEXIT_CRITICAL();
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the counters of the simulated controller. init_ms is the time of
+*   the stack init or of the last reset.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Pointer to the counters
+*
+*********************************************************************************/
+const beacon_sim_stats_t *beacon_sim_get_stats(void)
+{
+    return &sim_stats;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_adv_events
+*********************************************************************************
+* Summary:
+*   Returns the advertising events of an instance since the last reset, the
+*   reference for the energy estimate
+*
+* Parameters:
+*   instance:               Multi-adv instance
+*
+* Return:
+*   Number of advertising events
+*
+*********************************************************************************/
+uint32_t beacon_sim_adv_events(uint8_t instance)
+{
+    uint64_t now_us = (uint64_t)beacon_stats_now_ms() * 1000;
+    uint32_t events;
+
+    if ((0 == instance) || (instance > BEACON_SIM_MAX_INSTANCES))
+    {
+        return 0;
+    }
+
+    taskENTER_CRITICAL();
+    beacon_sim_adv_advance(&sim_adv[instance - 1], now_us);
+    events = sim_adv[instance - 1].events;
+    taskEXIT_CRITICAL();
+
+    return events;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_trace_count
+*********************************************************************************
+* Summary:
+*   Returns the number of commands traced since the last reset. Only the
+*   last BEACON_SIM_TRACE_SIZE are kept.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Number of traced commands
+*
+*********************************************************************************/
+uint32_t beacon_sim_trace_count(void)
+{
+    return sim_trace_count;
+}
+
+/********************************************************************************
+* Function Name: beacon_sim_get_trace
+*********************************************************************************
+* Summary:
+*   Returns a traced command
+*
+* Parameters:
+*   index:                  Command number since the last reset
+*
+* Return:
+*   Pointer to the record or NULL if it is no longer kept
+*
+*********************************************************************************/
+const beacon_sim_trace_t *beacon_sim_get_trace(uint32_t index)
+{
+    if ((index >= sim_trace_count) || ((sim_trace_count - index) > BEACON_SIM_TRACE_SIZE))
+    {
+        return NULL;
+    }
+    return &sim_trace[index & SIM_TRACE_MASK];
+}
+
+/* [] END OF FILE */
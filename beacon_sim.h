@@ -0,0 +1,215 @@
+/******************************************************************************
+* File Name: beacon_sim.h
+*
+* Description: This file contains the definitions for the simulated
+* controller. With BEACON_SIM_CONTROLLER=1, the stack calls used by the
+* application are redirected to a local stand-in that answers the
+* multi-advertising commands with a configurable latency.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_SIM_H__
+#define __BEACON_SIM_H__
+
+#include "wiced_bt_stack.h"
+#include "wiced_bt_ble.h"
+#include "wiced_bt_dev.h"
+#include "beacon_utils.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to run the application against the simulated controller */
+#ifndef BEACON_SIM_CONTROLLER
+#define BEACON_SIM_CONTROLLER            (0)
+#endif
+
+/* Default behavior, see beacon_sim_config_t */
+#define BEACON_SIM_BOOT_MS               (50)
+#define BEACON_SIM_LATENCY_MS            (2)
+#define BEACON_SIM_MAX_INSTANCES         (4)
+
+/* Scanners around a scannable instance, and the percentage of its
+ * advertising events that one of them sends a scan request to */
+#ifndef BEACON_SIM_AUDIENCE
+#define BEACON_SIM_AUDIENCE              (0)
+#endif
+
+#ifndef BEACON_SIM_SCAN_PERCENT
+#define BEACON_SIM_SCAN_PERCENT          (10)
+#endif
+
+/* Airtime percentage of channels 37, 38 and 39 taken by other advertisers.
+ * Their reports are heard and our packets collide with them at that rate. */
+#ifndef BEACON_SIM_CHANNEL_BUSY_37
+#define BEACON_SIM_CHANNEL_BUSY_37       (0)
+#endif
+
+#ifndef BEACON_SIM_CHANNEL_BUSY_38
+#define BEACON_SIM_CHANNEL_BUSY_38       (0)
+#endif
+
+#ifndef BEACON_SIM_CHANNEL_BUSY_39
+#define BEACON_SIM_CHANNEL_BUSY_39       (0)
+#endif
+
+/* Advertisers around the device, reported while scanning */
+#define BEACON_SIM_MAX_REMOTES           (8)
+
+/* Commands accepted but not yet answered */
+#define BEACON_SIM_QUEUE_SIZE            (16)
+
+/* Commands kept in the trace, a power of two */
+#define BEACON_SIM_TRACE_SIZE            (64)
+
+/* Response status of injected failures and of unknown instances */
+#define BEACON_SIM_STATUS_FAILED         (0x1F)
+#define BEACON_SIM_STATUS_UNKNOWN_ADV    (0x42)
+
+/* Vendor specific multi-advertising HCI command and its sub-opcodes */
+#define BEACON_SIM_HCI_MULTI_ADV         (0xFD54)
+
+/* Controller task, above the beacon manager like the stack task */
+#define BEACON_SIM_TASK_STACK_SIZE       (512)
+#define BEACON_SIM_TASK_PRIORITY         (4)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Simulated controller behavior */
+typedef struct
+{
+    uint32_t boot_ms;                           /* Stack init to BTM_ENABLED_EVT */
+    uint32_t latency_ms;                        /* Command to response */
+    uint32_t fail_period;                       /* Fail every Nth command, 0 never */
+    uint8_t fail_opcodes;                       /* Opcodes that may fail, 1 << opcode */
+    uint8_t max_instances;                      /* Instances supported */
+    uint16_t audience;                          /* Scanners sending scan requests */
+    uint8_t scan_percent;                       /* Advertising events scanned */
+    uint8_t channel_busy[3];                    /* Airtime of others per channel, % */
+}beacon_sim_config_t;
+
+/* Advertiser around the device, reported every period while scanning */
+typedef struct
+{
+    wiced_bt_device_address_t bd_addr;          /* Address of the advertiser */
+    int8_t rssi;                                /* Signal strength of its reports */
+    uint32_t period_ms;                         /* Time between reports, 0 removes it */
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];      /* Advertisement data */
+}beacon_sim_remote_t;
+
+/* One traced HCI command */
+typedef struct
+{
+    uint32_t issue_ms;                          /* Time the command was issued */
+    uint32_t resp_ms;                           /* Time of the response, 0 if none */
+    uint16_t hci_opcode;                        /* HCI command opcode */
+    uint8_t sub_opcode;                         /* wiced_bt_multi_adv_opcodes_t */
+    uint8_t instance;                           /* Multi-adv instance */
+    uint8_t hci_len;                            /* HCI command packet length */
+    uint8_t status;                             /* Response status */
+}beacon_sim_trace_t;
+
+/* Simulated controller counters */
+typedef struct
+{
+    uint32_t commands;                          /* Commands accepted */
+    uint32_t rejected;                          /* Commands refused, queue full */
+    uint32_t failed;                            /* Responses with a failure status */
+    uint32_t hci_bytes;                         /* HCI command bytes sent */
+    uint32_t init_ms;                           /* Time of the stack init */
+    uint32_t enabled_ms;                        /* Time of BTM_ENABLED_EVT */
+    uint32_t first_adv_ms;                      /* First successful advertising start */
+    uint32_t last_resp_ms;                      /* Time of the last response */
+    uint32_t scan_reports;                      /* Advertising reports delivered */
+}beacon_sim_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                      beacon_sim_configure       (const beacon_sim_config_t *p_config);
+
+const beacon_sim_config_t *beacon_sim_get_config     (void);
+
+wiced_result_t            beacon_sim_stack_init      (wiced_bt_management_cback_t *p_cback,
+                                                      const wiced_bt_cfg_settings_t *p_cfg);
+
+wiced_result_t            beacon_sim_set_data        (uint8_t *p_data, uint8_t data_len,
+                                                      uint8_t adv_instance);
+
+wiced_result_t            beacon_sim_set_params      (uint8_t adv_instance,
+                                                      wiced_bt_ble_multi_adv_params_t *p_param);
+
+wiced_result_t            beacon_sim_start           (uint8_t advertising_enable,
+                                                      uint8_t adv_instance);
+
+wiced_result_t            beacon_sim_observe         (wiced_bool_t start, uint8_t duration,
+                                                      wiced_bt_ble_scan_result_cback_t *p_cback);
+
+wiced_bool_t              beacon_sim_set_remote      (const beacon_sim_remote_t *p_remote);
+
+void                      beacon_sim_read_local_addr (wiced_bt_device_address_t bd_addr);
+
+void                      beacon_sim_restart         (void);
+
+wiced_bool_t              beacon_sim_idle            (void);
+
+void                      beacon_sim_reset_stats     (void);
+
+const beacon_sim_stats_t *beacon_sim_get_stats       (void);
+
+uint32_t                  beacon_sim_adv_events      (uint8_t instance);
+
+uint32_t                  beacon_sim_trace_count     (void);
+
+const beacon_sim_trace_t *beacon_sim_get_trace       (uint32_t index);
+
+/* Redirect the stack calls of the application, include this header last */
+#if BEACON_SIM_CONTROLLER
+#define wiced_bt_stack_init                      beacon_sim_stack_init
+#define wiced_set_multi_advertisement_data       beacon_sim_set_data
+#define wiced_set_multi_advertisement_params     beacon_sim_set_params
+#define wiced_start_multi_advertisements         beacon_sim_start
+#define wiced_bt_ble_observe                     beacon_sim_observe
+#define wiced_bt_dev_read_local_addr             beacon_sim_read_local_addr
+#endif
+
+#endif      /* __BEACON_SIM_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,526 @@
+/******************************************************************************
+* File Name: beacon_slot.c
+*
+* Description: This is the source code for the advertising slots. All
+* multi-advertising commands are issued through this file. The response event
+* does not carry the instance number, so issued commands are queued in order
+* and every response is matched with the oldest outstanding command.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include "wiced_bt_stack.h"
+#include "beacon_slot.h"
+#include "beacon_energy.h"
+#include "beacon_health.h"
+#include "beacon_trace.h"
+#include "beacon_sim.h"
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Command awaiting its response */
+typedef struct
+{
+    uint8_t instance;                           /* Instance the command targets */
+    uint8_t opcode;                             /* wiced_bt_multi_adv_opcodes_t */
+    uint8_t arg;                                /* Start/stop for enable commands */
+    wiced_bool_t notify;                        /* Response reported to the owner */
+}beacon_slot_cmd_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_slot_t      slots[BEACON_SLOT_MAX_INSTANCES];
+
+static beacon_slot_cmd_t  cmd_queue[BEACON_SLOT_CMD_QUEUE_SIZE];
+static uint8_t            cmd_head;
+static uint8_t            cmd_count;
+
+/* Serializes command issue so the queue order matches the stack order */
+static SemaphoreHandle_t  cmd_mutex;
+static StaticSemaphore_t  cmd_mutex_buffer;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_slot_issue
+*********************************************************************************
+* Summary:
+*   Queues the command and passes it to the stack. The command is queued
+*   before the stack is called because the response may be delivered before
+*   the call returns. Commands of the slot layer itself are not reported to
+*   the owner of the slot.
+*
+*********************************************************************************/
+static wiced_result_t beacon_slot_issue(beacon_slot_t *p_slot,
+                                        wiced_bt_multi_adv_opcodes_t opcode,
+                                        const void *p_arg, uint8_t arg, wiced_bool_t notify)
+{
+    wiced_result_t result;
+    beacon_slot_cmd_t *p_cmd;
+
+    xSemaphoreTake(cmd_mutex, portMAX_DELAY);
+
+    taskENTER_CRITICAL();
+    if (BEACON_SLOT_CMD_QUEUE_SIZE == cmd_count)
+    {
+        taskEXIT_CRITICAL();
+        xSemaphoreGive(cmd_mutex);
+        p_slot->stats.cmd_rejected++;
+        return WICED_BT_NO_RESOURCES;
+    }
+    p_cmd = &cmd_queue[(cmd_head + cmd_count) % BEACON_SLOT_CMD_QUEUE_SIZE];
+    p_cmd->instance = p_slot->instance;
+    p_cmd->opcode   = (uint8_t)opcode;
+    p_cmd->arg      = arg;
+    p_cmd->notify   = notify;
+    cmd_count++;
+    p_slot->cmds_pending++;
+    taskEXIT_CRITICAL();
+
+    BEACON_TRACE(BEACON_TRACE_CMD_ISSUE, opcode, p_slot->instance);
+
+    switch (opcode)
+    {
+    case SET_ADVT_DATA_MULTI:
+        result = wiced_set_multi_advertisement_data((uint8_t *)p_arg, arg, p_slot->instance);
+        break;
+
+    case SET_ADVT_PARAM_MULTI:
+        result = wiced_set_multi_advertisement_params(p_slot->instance,
+                                                      (wiced_bt_ble_multi_adv_params_t *)p_arg);
+        break;
+
+    case SET_ADVT_ENABLE_MULTI:
+        result = wiced_start_multi_advertisements(arg, p_slot->instance);
+        break;
+
+    default:
+        result = WICED_BT_BADARG;
+        break;
+    }
+
+    if (WICED_BT_PENDING == result)
+    {
+        p_slot->stats.cmd_issued++;
+    }
+    else
+    {
+        /* No response will follow, drop the command queued last */
+        taskENTER_CRITICAL();
+        cmd_count--;
+        p_slot->cmds_pending--;
+        taskEXIT_CRITICAL();
+        p_slot->stats.cmd_rejected++;
+        BEACON_TRACE(BEACON_TRACE_CMD_REJECT, opcode, p_slot->instance);
+    }
+
+    xSemaphoreGive(cmd_mutex);
+
+#if BEACON_HEALTH_ENABLE
+    beacon_health_on_issue(p_slot, opcode, p_arg, arg, result);
+#endif
+
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_init
+*********************************************************************************
+* Summary:
+*   Initializes the slot table. Must be called before the stack is started.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_slot_init(void)
+{
+    memset(slots, 0, sizeof(slots));
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        slots[i].instance = i + 1;
+    }
+
+    cmd_head  = 0;
+    cmd_count = 0;
+    if (NULL == cmd_mutex)
+    {
+        cmd_mutex = xSemaphoreCreateMutexStatic(&cmd_mutex_buffer);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_get
+*********************************************************************************
+* Summary:
+*   Returns the slot of a multi-advertising instance
+*
+* Parameters:
+*   instance:               Multi-adv instance number
+*
+* Return:
+*   Pointer to the slot or NULL if the instance is not managed
+*
+*********************************************************************************/
+beacon_slot_t *beacon_slot_get(uint8_t instance)
+{
+    if ((0 == instance) || (instance > BEACON_SLOT_MAX_INSTANCES))
+    {
+        return NULL;
+    }
+    return &slots[instance - 1];
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_register
+*********************************************************************************
+* Summary:
+*   Registers the owner callback of a slot
+*
+* Parameters:
+*   p_slot:                 Slot
+*   p_cback:                Callback for the command responses of the slot
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_slot_register(beacon_slot_t *p_slot, beacon_slot_cback_t *p_cback)
+{
+    p_slot->p_cback = p_cback;
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_set_data
+*********************************************************************************
+* Summary:
+*   Sets the advertisement data of a slot
+*
+* Parameters:
+*   p_slot:                 Slot
+*   adv_data:               Advertisement data
+*   adv_len:                Length of the advertisement data
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the command was issued
+*
+*********************************************************************************/
+wiced_result_t beacon_slot_set_data(beacon_slot_t *p_slot, const uint8_t *adv_data,
+                                    uint8_t adv_len)
+{
+    wiced_result_t result;
+
+    if (adv_len > BEACON_ADV_DATA_MAX)
+    {
+        return WICED_BT_BADARG;
+    }
+
+    result = beacon_slot_issue(p_slot, SET_ADVT_DATA_MULTI, adv_data, adv_len, WICED_TRUE);
+    if (WICED_BT_PENDING == result)
+    {
+        if (adv_data != p_slot->adv_data)
+        {
+            memcpy(p_slot->adv_data, adv_data, adv_len);
+        }
+        p_slot->adv_len = adv_len;
+        p_slot->stats.data_updates++;
+    }
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_set_params
+*********************************************************************************
+* Summary:
+*   Sets the advertising parameters of a slot
+*
+* Parameters:
+*   p_slot:                 Slot
+*   p_params:               Advertising parameters
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the command was issued
+*
+*********************************************************************************/
+wiced_result_t beacon_slot_set_params(beacon_slot_t *p_slot,
+                                      const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    wiced_result_t result;
+
+    result = beacon_slot_issue(p_slot, SET_ADVT_PARAM_MULTI, p_params, 0, WICED_TRUE);
+    if (WICED_BT_PENDING == result)
+    {
+        if (p_params != &p_slot->params)
+        {
+            p_slot->params = *p_params;
+        }
+        p_slot->stats.params_updates++;
+    }
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_start
+*********************************************************************************
+* Summary:
+*   Starts or stops advertising on a slot
+*
+* Parameters:
+*   p_slot:                 Slot
+*   start:                  WICED_TRUE to start, WICED_FALSE to stop
+*
+* Return:
+*   wiced_result_t: WICED_BT_PENDING when the command was issued
+*
+*********************************************************************************/
+wiced_result_t beacon_slot_start(beacon_slot_t *p_slot, wiced_bool_t start)
+{
+    return beacon_slot_issue(p_slot, SET_ADVT_ENABLE_MULTI, NULL,
+                             start ? MULTI_ADVERT_START : MULTI_ADVERT_STOP, WICED_TRUE);
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_on_response
+*********************************************************************************
+* Summary:
+*   Matches a BTM_MULTI_ADVERT_RESP_EVENT with the oldest outstanding command
+*   and notifies the owner of the slot.
+*
+* Parameters:
+*   opcode:                 Opcode of the response
+*   status:                 Status of the response
+*
+* Return:
+*   Slot the response belongs to, NULL if no command was outstanding
+*
+*********************************************************************************/
+beacon_slot_t *beacon_slot_on_response(wiced_bt_multi_adv_opcodes_t opcode, uint8_t status)
+{
+    beacon_slot_cmd_t cmd;
+    beacon_slot_t *p_slot;
+
+    taskENTER_CRITICAL();
+    if (0 == cmd_count)
+    {
+        taskEXIT_CRITICAL();
+        return NULL;
+    }
+    cmd = cmd_queue[cmd_head];
+    cmd_head = (cmd_head + 1) % BEACON_SLOT_CMD_QUEUE_SIZE;
+    cmd_count--;
+    p_slot = beacon_slot_get(cmd.instance);
+    p_slot->cmds_pending--;
+    taskEXIT_CRITICAL();
+
+    BEACON_TRACE(BEACON_TRACE_CMD_RESP, cmd.opcode, cmd.instance | (status << 8));
+
+    if (WICED_SUCCESS != status)
+    {
+        p_slot->stats.cmd_failed++;
+    }
+    else if (SET_ADVT_ENABLE_MULTI == cmd.opcode)
+    {
+        p_slot->advertising = (MULTI_ADVERT_START == cmd.arg) ? WICED_TRUE : WICED_FALSE;
+    }
+
+#if BEACON_ENERGY_ENABLE
+    /* Events so far were sent with the previous state */
+    beacon_energy_on_slot(p_slot);
+#endif
+
+#if BEACON_HEALTH_ENABLE
+    beacon_health_on_response(p_slot, (wiced_bt_multi_adv_opcodes_t)cmd.opcode, status);
+#endif
+
+    if (opcode != (wiced_bt_multi_adv_opcodes_t)cmd.opcode)
+    {
+        printf("Multi ADV response opcode %d does not match command %d\n", opcode, cmd.opcode);
+    }
+
+    if ((NULL != p_slot->p_cback) && cmd.notify)
+    {
+        p_slot->p_cback(p_slot, (wiced_bt_multi_adv_opcodes_t)cmd.opcode, status);
+    }
+
+    return p_slot;
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_flush
+*********************************************************************************
+* Summary:
+*   Drops the commands awaiting a response, for when the stack was restarted
+*   and will not answer them. Every instance is left stopped.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_slot_flush(void)
+{
+    xSemaphoreTake(cmd_mutex, portMAX_DELAY);
+
+    taskENTER_CRITICAL();
+    cmd_head  = 0;
+    cmd_count = 0;
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        slots[i].cmds_pending = 0;
+        slots[i].advertising  = WICED_FALSE;
+    }
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(cmd_mutex);
+
+#if BEACON_ENERGY_ENABLE
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        beacon_energy_on_slot(&slots[i]);
+    }
+#endif
+}
+
+/********************************************************************************
+* Function Name: beacon_slot_restart
+*********************************************************************************
+* Summary:
+*   Call when the stack was restarted and the controller lost its instances.
+*   Commands still awaiting a response are dropped, then every instance that
+*   was advertising, or was being started, is configured and started again
+*   with the last data and parameters submitted, whichever module owns it.
+*   The owners are not told about these commands; they are told that their
+*   dropped commands were lost. Call in the beacon manager task.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Number of instances whose commands were all issued
+*
+*********************************************************************************/
+uint32_t beacon_slot_restart(void)
+{
+    beacon_slot_cmd_t dropped[BEACON_SLOT_CMD_QUEUE_SIZE];
+    uint8_t num_dropped;
+    uint32_t advertising = 0;
+    uint32_t restarted = 0;
+    beacon_slot_t *p_slot;
+
+    xSemaphoreTake(cmd_mutex, portMAX_DELAY);
+    taskENTER_CRITICAL();
+    num_dropped = cmd_count;
+    for (uint8_t n = 0; n < num_dropped; n++)
+    {
+        dropped[n] = cmd_queue[(cmd_head + n) % BEACON_SLOT_CMD_QUEUE_SIZE];
+    }
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(cmd_mutex);
+
+    /* The state the owners asked for: the last start or stop still awaiting
+     * a response overrides the state confirmed so far */
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        if (slots[i].advertising)
+        {
+            advertising |= 1UL << i;
+        }
+    }
+    for (uint8_t n = 0; n < num_dropped; n++)
+    {
+        if (SET_ADVT_ENABLE_MULTI != dropped[n].opcode)
+        {
+            continue;
+        }
+        if (MULTI_ADVERT_START == dropped[n].arg)
+        {
+            advertising |= 1UL << (dropped[n].instance - 1);
+        }
+        else
+        {
+            advertising &= ~(1UL << (dropped[n].instance - 1));
+        }
+    }
+
+    beacon_slot_flush();
+
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        if (0 == (advertising & (1UL << i)))
+        {
+            continue;
+        }
+
+        p_slot = &slots[i];
+        if ((WICED_BT_PENDING == beacon_slot_issue(p_slot, SET_ADVT_PARAM_MULTI, &p_slot->params,
+                                                   0, WICED_FALSE)) &&
+            (WICED_BT_PENDING == beacon_slot_issue(p_slot, SET_ADVT_DATA_MULTI, p_slot->adv_data,
+                                                   p_slot->adv_len, WICED_FALSE)) &&
+            (WICED_BT_PENDING == beacon_slot_issue(p_slot, SET_ADVT_ENABLE_MULTI, NULL,
+                                                   MULTI_ADVERT_START, WICED_FALSE)))
+        {
+            restarted++;
+        }
+    }
+
+    /* Last, so the commands an owner issues in return follow the ones above */
+    for (uint8_t n = 0; n < num_dropped; n++)
+    {
+        p_slot = &slots[dropped[n].instance - 1];
+        if ((NULL != p_slot->p_cback) && dropped[n].notify)
+        {
+            p_slot->p_cback(p_slot, (wiced_bt_multi_adv_opcodes_t)dropped[n].opcode,
+                            BEACON_SLOT_STATUS_LOST);
+        }
+    }
+    return restarted;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,125 @@
+/******************************************************************************
+* File Name: beacon_slot.h
+*
+* Description: This file contains the definitions for the advertising slots.
+* A slot is one multi-advertising instance together with its current
+* advertisement data, parameters and command bookkeeping.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_SLOT_H__
+#define __BEACON_SLOT_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Number of multi-advertising instances managed by the application. The
+ * instances are numbered from 1 to BEACON_SLOT_MAX_INSTANCES. */
+#ifndef BEACON_SLOT_MAX_INSTANCES
+#define BEACON_SLOT_MAX_INSTANCES        (4)
+#endif
+
+/* Number of multi-advertising commands that can await their response */
+#define BEACON_SLOT_CMD_QUEUE_SIZE       (16)
+
+/* Status reported to the owner for a command dropped by beacon_slot_restart */
+#define BEACON_SLOT_STATUS_LOST          (0xFF)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+struct beacon_slot;
+
+/* Called when the response to a command issued on the slot is received */
+typedef void (beacon_slot_cback_t)(struct beacon_slot *p_slot,
+                                   wiced_bt_multi_adv_opcodes_t opcode,
+                                   uint8_t status);
+
+/* Per slot command counters */
+typedef struct
+{
+    uint32_t cmd_issued;                        /* Commands accepted by the stack */
+    uint32_t cmd_rejected;                      /* Commands not accepted by the stack */
+    uint32_t cmd_failed;                        /* Commands with a failed response */
+    uint32_t data_updates;                      /* Set data commands */
+    uint32_t params_updates;                    /* Set params commands */
+}beacon_slot_stats_t;
+
+/* One multi-advertising instance */
+typedef struct beacon_slot
+{
+    uint8_t instance;                           /* Multi-adv instance number */
+    uint8_t adv_len;                            /* Length of adv_data */
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];      /* Last submitted adv data */
+    uint8_t cmds_pending;                       /* Commands awaiting response */
+    wiced_bool_t advertising;                   /* Instance is started */
+    wiced_bt_ble_multi_adv_params_t params;     /* Last submitted parameters */
+    beacon_slot_cback_t *p_cback;               /* Owner response callback */
+    beacon_slot_stats_t stats;                  /* Command counters */
+}beacon_slot_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void           beacon_slot_init        (void);
+
+beacon_slot_t *beacon_slot_get         (uint8_t instance);
+
+void           beacon_slot_register    (beacon_slot_t *p_slot, beacon_slot_cback_t *p_cback);
+
+wiced_result_t beacon_slot_set_data    (beacon_slot_t *p_slot, const uint8_t *adv_data,
+                                        uint8_t adv_len);
+
+wiced_result_t beacon_slot_set_params  (beacon_slot_t *p_slot,
+                                        const wiced_bt_ble_multi_adv_params_t *p_params);
+
+wiced_result_t beacon_slot_start       (beacon_slot_t *p_slot, wiced_bool_t start);
+
+beacon_slot_t *beacon_slot_on_response (wiced_bt_multi_adv_opcodes_t opcode, uint8_t status);
+
+void           beacon_slot_flush       (void);
+
+uint32_t       beacon_slot_restart     (void);
+
+#endif      /* __BEACON_SLOT_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,205 @@
+/******************************************************************************
+* File Name: beacon_stats.c
+*
+* Description: This is the source code for the timing and latency statistics
+* helpers. Short durations are measured with the DWT cycle counter.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include "cy_pdl.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include "beacon_stats.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define CYCLES_PER_US                    (SystemCoreClock / 1000000UL)
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_stats_init
+*********************************************************************************
+* Summary:
+*   Enables the DWT cycle counter used for latency measurements
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_stats_init(void)
+{
+#if defined(DWT)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/********************************************************************************
+* Function Name: beacon_stats_cycles
+*********************************************************************************
+* Summary:
+*   Returns the free running CPU cycle counter. Differences of two readings
+*   are valid across one counter wrap.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Current cycle count
+*
+*********************************************************************************/
+uint32_t beacon_stats_cycles(void)
+{
+#if defined(DWT)
+    return DWT->CYCCNT;
+#else
+    return (uint32_t)xTaskGetTickCount() * (configCPU_CLOCK_HZ / configTICK_RATE_HZ);
+#endif
+}
+
+/********************************************************************************
+* Function Name: beacon_stats_cycles_to_us
+*********************************************************************************
+* Summary:
+*   Converts a number of CPU cycles to microseconds
+*
+* Parameters:
+*   cycles:                 Number of cycles
+*
+* Return:
+*   Duration in microseconds
+*
+*********************************************************************************/
+uint32_t beacon_stats_cycles_to_us(uint32_t cycles)
+{
+    return cycles / CYCLES_PER_US;
+}
+
+/********************************************************************************
+* Function Name: beacon_stats_now_ms
+*********************************************************************************
+* Summary:
+*   Returns the RTOS time in milliseconds
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Time since the scheduler start in milliseconds
+*
+*********************************************************************************/
+uint32_t beacon_stats_now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+/********************************************************************************
+* Function Name: beacon_latency_add
+*********************************************************************************
+* Summary:
+*   Adds one sample to the latency statistics
+*
+* Parameters:
+*   latency:                Latency statistics
+*   sample:                 New sample
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_latency_add(beacon_latency_t *latency, uint32_t sample)
+{
+    if ((0 == latency->count) || (sample < latency->min))
+    {
+        latency->min = sample;
+    }
+    if (sample > latency->max)
+    {
+        latency->max = sample;
+    }
+    latency->sum += sample;
+    latency->count++;
+}
+
+/********************************************************************************
+* Function Name: beacon_latency_mean
+*********************************************************************************
+* Summary:
+*   Returns the mean of the latency samples
+*
+* Parameters:
+*   latency:                Latency statistics
+*
+* Return:
+*   Mean value, 0 when there are no samples
+*
+*********************************************************************************/
+uint32_t beacon_latency_mean(const beacon_latency_t *latency)
+{
+    return (0 == latency->count) ? 0 : (uint32_t)(latency->sum / latency->count);
+}
+
+/********************************************************************************
+* Function Name: beacon_latency_reset
+*********************************************************************************
+* Summary:
+*   Clears the latency statistics
+*
+* Parameters:
+*   latency:                Latency statistics
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_latency_reset(beacon_latency_t *latency)
+{
+    latency->count = 0;
+    latency->min   = 0;
+    latency->max   = 0;
+    latency->sum   = 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,81 @@
+/******************************************************************************
+* File Name: beacon_stats.h
+*
+* Description: This file contains the definitions for the timing and latency
+* statistics helpers shared by the beacon modules.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_STATS_H__
+#define __BEACON_STATS_H__
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Running latency statistics */
+typedef struct
+{
+    uint32_t count;                             /* Number of samples */
+    uint32_t min;                               /* Smallest sample */
+    uint32_t max;                               /* Largest sample */
+    uint64_t sum;                               /* Sum of all samples */
+}beacon_latency_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void     beacon_stats_init         (void);
+
+uint32_t beacon_stats_cycles       (void);
+
+uint32_t beacon_stats_cycles_to_us (uint32_t cycles);
+
+uint32_t beacon_stats_now_ms       (void);
+
+void     beacon_latency_add        (beacon_latency_t *latency, uint32_t sample);
+
+uint32_t beacon_latency_mean       (const beacon_latency_t *latency);
+
+void     beacon_latency_reset      (beacon_latency_t *latency);
+
+#endif      /* __BEACON_STATS_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,577 @@
+/******************************************************************************
+* File Name: beacon_store.c
+*
+* Description: This is the source code for the persistent beacon store. The
+* active contents are mirrored in RAM, a commit writes the staged contents to
+* the other flash bank with the next generation number, so the newest bank
+* with a valid CRC is always a complete image.
+*
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include "cyhal.h"
+#include "wiced_bt_stack.h"
+#include "beacon_format.h"
+#include "beacon_power.h"
+#include "beacon_store.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define STORE_MAGIC                      (0x31545342UL)   /* "BST1" */
+#define STORE_NUM_BANKS                  (2)
+
+/* Advertising interval of instances without parameters, 100 ms */
+#define STORE_DEFAULT_INTERVAL           (0x00A0)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Contents of a bank, must fit BEACON_STORE_BANK_SIZE */
+typedef struct
+{
+    uint32_t magic;                             /* STORE_MAGIC */
+    uint32_t generation;                        /* Incremented by every commit */
+    beacon_store_slot_t slots[BEACON_STORE_MAX_SLOTS];
+    beacon_store_key_t keys[BEACON_STORE_MAX_KEYS];
+    uint32_t counters[BEACON_STORE_MAX_COUNTERS];
+    uint16_t crc;                               /* CRC-16 of the fields above */
+}store_image_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* Flash banks, placed in the section the BSP linker scripts reserve for
+ * emulated EEPROM */
+CY_SECTION(".cy_em_eeprom") CY_ALIGN(BEACON_STORE_BANK_SIZE)
+static const uint8_t store_flash[STORE_NUM_BANKS][BEACON_STORE_BANK_SIZE] = { { 0 } };
+static const uint8_t *volatile store_flash_base = &store_flash[0][0];
+
+static cyhal_flash_t store_flash_obj;
+static wiced_bool_t  store_flash_ready;
+
+static store_image_t store_live;                /* Contents of the active bank */
+static store_image_t store_staged;              /* Contents of the next commit */
+static store_image_t store_counted;             /* store_live with a counter moved */
+static uint8_t       store_bank;                /* Bank holding store_live */
+
+/* Serializes the writes: provisioning commits from the console task,
+ * counters are set from the tasks that use them */
+static SemaphoreHandle_t store_mutex;
+static StaticSemaphore_t store_mutex_buffer;
+
+/* Page being programmed */
+static uint32_t      store_page[BEACON_STORE_BANK_SIZE / sizeof(uint32_t)];
+
+/* Defaults for instances not configured before the store is applied */
+static const wiced_bt_ble_multi_adv_params_t store_default_params =
+{
+    .adv_int_min       = STORE_DEFAULT_INTERVAL,
+    .adv_int_max       = STORE_DEFAULT_INTERVAL,
+    .adv_type          = MULTI_ADVERT_NONCONNECTABLE_EVENT,
+    .channel_map       = BTM_BLE_ADVERT_CHNL_37 | BTM_BLE_ADVERT_CHNL_38 | BTM_BLE_ADVERT_CHNL_39,
+    .adv_filter_policy = BTM_BLE_ADV_POLICY_ACCEPT_CONN_AND_SCAN,
+    .adv_tx_power      = MULTI_ADV_TX_POWER_MAX_INDEX
+};
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_store_bank
+*********************************************************************************
+* Summary:
+*   Returns the contents of a flash bank. The address is loaded from a
+*   volatile pointer: the compiler sees through an integer cast and would
+*   fold reads of the constant array to its initial zeros.
+*
+*********************************************************************************/
+static const store_image_t *beacon_store_bank(uint8_t bank)
+{
+    return (const store_image_t *)(store_flash_base + ((uint32_t)bank * BEACON_STORE_BANK_SIZE));
+}
+
+/********************************************************************************
+* Function Name: beacon_store_crc
+*********************************************************************************
+* Summary:
+*   Returns the CRC of an image, the crc field excluded
+*
+*********************************************************************************/
+static uint16_t beacon_store_crc(const store_image_t *p_image)
+{
+    return beacon_crc16((const uint8_t *)p_image, offsetof(store_image_t, crc), 0xFFFF);
+}
+
+/********************************************************************************
+* Function Name: beacon_store_valid
+*********************************************************************************
+* Summary:
+*   Returns WICED_TRUE if the bank holds a complete image
+*
+*********************************************************************************/
+static wiced_bool_t beacon_store_valid(const store_image_t *p_image)
+{
+    return ((STORE_MAGIC == p_image->magic) &&
+            (beacon_store_crc(p_image) == p_image->crc)) ? WICED_TRUE : WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_page_size
+*********************************************************************************
+* Summary:
+*   Returns the program page size of the flash block holding an address, or
+*   0 if the address is not in flash
+*
+*********************************************************************************/
+static uint32_t beacon_store_page_size(uint32_t address)
+{
+    cyhal_flash_info_t info;
+
+    cyhal_flash_get_info(&store_flash_obj, &info);
+
+    for (uint8_t i = 0; i < info.block_count; i++)
+    {
+        const cyhal_flash_block_info_t *p_block = &info.blocks[i];
+
+        if ((address >= p_block->start_address) &&
+            ((address - p_block->start_address) < p_block->size))
+        {
+            return p_block->page_size;
+        }
+    }
+    return 0;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_write
+*********************************************************************************
+* Summary:
+*   Writes an image to a bank page by page and reads it back
+*
+*********************************************************************************/
+static wiced_bool_t beacon_store_write(uint8_t bank, const store_image_t *p_image)
+{
+    uint32_t address = (uint32_t)(uintptr_t)&store_flash[bank][0];
+    uint32_t page_size = beacon_store_page_size(address);
+
+    if ((!store_flash_ready) || (0 == page_size) || (page_size > BEACON_STORE_BANK_SIZE) ||
+        (0 != (BEACON_STORE_BANK_SIZE % page_size)))
+    {
+        return WICED_FALSE;
+    }
+
+    for (uint32_t offset = 0; offset < sizeof(*p_image); offset += page_size)
+    {
+        uint32_t len = sizeof(*p_image) - offset;
+
+        if (len > page_size)
+        {
+            len = page_size;
+        }
+        memset(store_page, 0xFF, page_size);
+        memcpy(store_page, (const uint8_t *)p_image + offset, len);
+
+        if (CY_RSLT_SUCCESS != cyhal_flash_write(&store_flash_obj, address + offset, store_page))
+        {
+            return WICED_FALSE;
+        }
+    }
+
+    return (0 == memcmp(beacon_store_bank(bank), p_image, sizeof(*p_image))) ?
+           WICED_TRUE : WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_swap
+*********************************************************************************
+* Summary:
+*   Writes an image to the inactive bank and makes it active. The previous
+*   bank stays valid if the write does not complete. Call with store_mutex.
+*
+*********************************************************************************/
+static wiced_result_t beacon_store_swap(store_image_t *p_image)
+{
+    uint8_t bank = store_bank ^ 1;
+
+    p_image->magic      = STORE_MAGIC;
+    p_image->generation = store_live.generation + 1;
+    p_image->crc        = beacon_store_crc(p_image);
+
+    if (!beacon_store_write(bank, p_image))
+    {
+        return WICED_BT_ERROR;
+    }
+
+    store_live = *p_image;
+    store_bank = bank;
+    return WICED_BT_SUCCESS;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_init
+*********************************************************************************
+* Summary:
+*   Loads the newest valid bank. The store is empty if neither bank is valid.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_store_init(void)
+{
+    const store_image_t *p_bank0 = beacon_store_bank(0);
+    const store_image_t *p_bank1 = beacon_store_bank(1);
+    wiced_bool_t valid0 = beacon_store_valid(p_bank0);
+    wiced_bool_t valid1 = beacon_store_valid(p_bank1);
+
+    store_flash_ready = (CY_RSLT_SUCCESS == cyhal_flash_init(&store_flash_obj)) ?
+                        WICED_TRUE : WICED_FALSE;
+    if (NULL == store_mutex)
+    {
+        store_mutex = xSemaphoreCreateMutexStatic(&store_mutex_buffer);
+    }
+
+    memset(&store_live, 0, sizeof(store_live));
+    store_bank = 1;
+
+    if (valid0 && (!valid1 || ((int32_t)(p_bank0->generation - p_bank1->generation) > 0)))
+    {
+        store_live = *p_bank0;
+        store_bank = 0;
+    }
+    else if (valid1)
+    {
+        store_live = *p_bank1;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_store_stage
+*********************************************************************************
+* Summary:
+*   Starts staging a commit from the active contents. Entries not staged
+*   before the commit are kept.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_store_stage(void)
+{
+    store_staged = store_live;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_stage_slot
+*********************************************************************************
+* Summary:
+*   Stages the configuration of an instance. A configuration without
+*   advertisement data removes the instance from the store.
+*
+* Parameters:
+*   p_slot:                 Configuration
+*
+* Return:
+*   WICED_FALSE if the configuration is invalid
+*
+*********************************************************************************/
+wiced_bool_t beacon_store_stage_slot(const beacon_store_slot_t *p_slot)
+{
+    beacon_store_slot_t *p_entry;
+
+    if ((0 == p_slot->instance) || (p_slot->instance > BEACON_STORE_MAX_SLOTS) ||
+        (p_slot->adv_len > BEACON_ADV_DATA_MAX) || (p_slot->adv_int_min > p_slot->adv_int_max))
+    {
+        return WICED_FALSE;
+    }
+
+    p_entry = &store_staged.slots[p_slot->instance - 1];
+
+    if (0 == p_slot->adv_len)
+    {
+        memset(p_entry, 0, sizeof(*p_entry));
+    }
+    else
+    {
+        *p_entry = *p_slot;
+    }
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_stage_key
+*********************************************************************************
+* Summary:
+*   Stages a key, replacing a key with the same number
+*
+* Parameters:
+*   id:                     Key number
+*   key:                    BEACON_STORE_KEY_LEN byte key
+*
+* Return:
+*   WICED_FALSE if all key entries are used
+*
+*********************************************************************************/
+wiced_bool_t beacon_store_stage_key(uint8_t id, const uint8_t *key)
+{
+    beacon_store_key_t *p_free = NULL;
+
+    for (uint8_t i = 0; i < BEACON_STORE_MAX_KEYS; i++)
+    {
+        beacon_store_key_t *p_entry = &store_staged.keys[i];
+
+        if (p_entry->valid && (p_entry->id == id))
+        {
+            p_free = p_entry;
+            break;
+        }
+        if ((!p_entry->valid) && (NULL == p_free))
+        {
+            p_free = p_entry;
+        }
+    }
+
+    if (NULL == p_free)
+    {
+        return WICED_FALSE;
+    }
+    p_free->id    = id;
+    p_free->valid = 1;
+    memcpy(p_free->key, key, BEACON_STORE_KEY_LEN);
+    return WICED_TRUE;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_commit
+*********************************************************************************
+* Summary:
+*   Writes the staged contents to the inactive bank and makes them active.
+*   The previous bank stays valid if the write does not complete. The stored
+*   counters are kept. Blocks for the flash write, call from a task that may
+*   wait.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   WICED_BT_SUCCESS, or WICED_BT_ERROR if the flash write failed
+*
+*********************************************************************************/
+wiced_result_t beacon_store_commit(void)
+{
+    wiced_result_t result;
+
+    xSemaphoreTake(store_mutex, portMAX_DELAY);
+
+    /* Counters are not staged, a commit never takes one back */
+    memcpy(store_staged.counters, store_live.counters, sizeof(store_staged.counters));
+    result = beacon_store_swap(&store_staged);
+
+    xSemaphoreGive(store_mutex);
+    return result;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_get_slot
+*********************************************************************************
+* Summary:
+*   Returns the stored configuration of an instance
+*
+* Parameters:
+*   instance:               Multi-adv instance
+*
+* Return:
+*   Pointer to the configuration or NULL if the instance is not stored
+*
+*********************************************************************************/
+const beacon_store_slot_t *beacon_store_get_slot(uint8_t instance)
+{
+    if ((0 == instance) || (instance > BEACON_STORE_MAX_SLOTS) ||
+        (instance != store_live.slots[instance - 1].instance))
+    {
+        return NULL;
+    }
+    return &store_live.slots[instance - 1];
+}
+
+/********************************************************************************
+* Function Name: beacon_store_get_key
+*********************************************************************************
+* Summary:
+*   Returns a stored key
+*
+* Parameters:
+*   id:                     Key number
+*
+* Return:
+*   Pointer to the BEACON_STORE_KEY_LEN byte key or NULL if not stored
+*
+*********************************************************************************/
+const uint8_t *beacon_store_get_key(uint8_t id)
+{
+    for (uint8_t i = 0; i < BEACON_STORE_MAX_KEYS; i++)
+    {
+        if (store_live.keys[i].valid && (store_live.keys[i].id == id))
+        {
+            return store_live.keys[i].key;
+        }
+    }
+    return NULL;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_apply
+*********************************************************************************
+* Summary:
+*   Configures and starts every stored instance. Call from the beacon manager
+*   task. A stored instance replaces a bound format.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Number of instances whose commands were all issued
+*
+*********************************************************************************/
+uint32_t beacon_store_apply(void)
+{
+    wiced_bt_ble_multi_adv_params_t params;
+    uint32_t applied = 0;
+
+    for (uint8_t instance = 1; instance <= BEACON_STORE_MAX_SLOTS; instance++)
+    {
+        const beacon_store_slot_t *p_stored = beacon_store_get_slot(instance);
+        beacon_slot_t *p_slot = beacon_slot_get(instance);
+
+        if ((NULL == p_stored) || (NULL == p_slot))
+        {
+            continue;
+        }
+
+        /* Only the provisioned fields change, the others are kept */
+        params = (0 != p_slot->params.channel_map) ? p_slot->params : store_default_params;
+        params.adv_int_min  = p_stored->adv_int_min;
+        params.adv_int_max  = p_stored->adv_int_max;
+        params.adv_tx_power = p_stored->tx_power;
+
+        /* The provisioned power replaces a target range */
+        beacon_format_bind(p_slot, NULL, NULL);
+        beacon_power_set_range(p_slot, 0);
+
+        if ((WICED_BT_PENDING == beacon_slot_set_params(p_slot, &params)) &&
+            (WICED_BT_PENDING == beacon_slot_set_data(p_slot, p_stored->adv_data,
+                                                      p_stored->adv_len)) &&
+            (WICED_BT_PENDING == beacon_slot_start(p_slot, WICED_TRUE)))
+        {
+            applied++;
+        }
+    }
+    return applied;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_get_counter
+*********************************************************************************
+* Summary:
+*   Returns a stored counter
+*
+* Parameters:
+*   id:                     Counter number, below BEACON_STORE_MAX_COUNTERS
+*
+* Return:
+*   Stored value, 0 if never set
+*
+*********************************************************************************/
+uint32_t beacon_store_get_counter(uint8_t id)
+{
+    return (id < BEACON_STORE_MAX_COUNTERS) ? store_live.counters[id] : 0;
+}
+
+/********************************************************************************
+* Function Name: beacon_store_set_counter
+*********************************************************************************
+* Summary:
+*   Writes a counter to flash with the rest of the active contents. Counters
+*   only move forward, a value not above the stored one is not written. A
+*   staged commit in progress is not affected. Blocks for the flash write,
+*   call from a task that may wait.
+*
+* Parameters:
+*   id:                     Counter number, below BEACON_STORE_MAX_COUNTERS
+*   value:                  New value
+*
+* Return:
+*   WICED_BT_SUCCESS when the stored value is at least value,
+*   WICED_BT_ERROR if the flash write failed, WICED_BT_BADARG for an unknown
+*   counter
+*
+*********************************************************************************/
+wiced_result_t beacon_store_set_counter(uint8_t id, uint32_t value)
+{
+    wiced_result_t result = WICED_BT_SUCCESS;
+
+    if (id >= BEACON_STORE_MAX_COUNTERS)
+    {
+        return WICED_BT_BADARG;
+    }
+
+    xSemaphoreTake(store_mutex, portMAX_DELAY);
+
+    if (value > store_live.counters[id])
+    {
+        store_counted = store_live;
+        store_counted.counters[id] = value;
+        result = beacon_store_swap(&store_counted);
+    }
+
+    xSemaphoreGive(store_mutex);
+    return result;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,121 @@
+/******************************************************************************
+* File Name: beacon_store.h
+*
+* Description: This file contains the definitions for the persistent beacon
+* store. The store keeps provisioned slot configurations and keys in flash,
+* and counters that must not repeat after a reset.
+*
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_STORE_H__
+#define __BEACON_STORE_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Slot configurations kept, one per instance */
+#define BEACON_STORE_MAX_SLOTS           (BEACON_SLOT_MAX_INSTANCES)
+
+/* Keys kept and their length */
+#define BEACON_STORE_MAX_KEYS            (8)
+#define BEACON_STORE_KEY_LEN             (16)
+
+/* Counters kept, numbered from 0 */
+#define BEACON_STORE_MAX_COUNTERS        (4)
+
+/* Flash reserved per bank. The store alternates between two banks so that a
+ * reset during a commit leaves the previous contents valid. Must be a
+ * multiple of the flash page size. */
+#ifndef BEACON_STORE_BANK_SIZE
+#define BEACON_STORE_BANK_SIZE           (1024)
+#endif
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Provisioned configuration of an advertising instance */
+typedef struct
+{
+    uint8_t instance;                           /* Multi-adv instance, 0 if unused */
+    uint8_t tx_power;                           /* Multi-adv Tx power index */
+    uint16_t adv_int_min;                       /* In 0.625 ms units */
+    uint16_t adv_int_max;                       /* In 0.625 ms units */
+    uint8_t adv_len;                            /* Length of adv_data */
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];      /* Advertisement data */
+}beacon_store_slot_t;
+
+/* Provisioned key */
+typedef struct
+{
+    uint8_t id;                                 /* Application defined key number */
+    uint8_t valid;                              /* Non zero if set */
+    uint8_t key[BEACON_STORE_KEY_LEN];          /* Key value */
+}beacon_store_key_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                       beacon_store_init       (void);
+
+void                       beacon_store_stage      (void);
+
+wiced_bool_t               beacon_store_stage_slot (const beacon_store_slot_t *p_slot);
+
+wiced_bool_t               beacon_store_stage_key  (uint8_t id, const uint8_t *key);
+
+wiced_result_t             beacon_store_commit     (void);
+
+const beacon_store_slot_t *beacon_store_get_slot   (uint8_t instance);
+
+const uint8_t             *beacon_store_get_key    (uint8_t id);
+
+uint32_t                   beacon_store_apply      (void);
+
+uint32_t                   beacon_store_get_counter(uint8_t id);
+
+wiced_result_t             beacon_store_set_counter(uint8_t id, uint32_t value);
+
+#endif      /* __BEACON_STORE_H__ */
+
+
+/* [] END OF FILE */
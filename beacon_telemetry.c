@@ -0,0 +1,657 @@
+/******************************************************************************
+* File Name: beacon_telemetry.c
+*
+* Description: This is the source code for the sensor telemetry frames. The
+* encoder packs as many samples as fit in one advertisement, the decoder is
+* the scanner side counterpart. The service samples the sensors from the
+* worker and hands each full frame to the beacon manager.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "wiced_bt_stack.h"
+#include "beacon_telemetry.h"
+#include "beacon_manager.h"
+#include "beacon_payload.h"
+#include "beacon_stats.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Frame header, bit 7 keyframe, bits 6..5 channels - 1, bits 3..0 key epoch */
+#define TELEMETRY_HDR_KEYFRAME           (0x80)
+#define TELEMETRY_HDR_CHANNELS_SHIFT     (5)
+#define TELEMETRY_HDR_CHANNELS_MASK      (0x03)
+#define TELEMETRY_HDR_EPOCH_MASK         (0x0F)
+
+/* Header, first sample index and sample count */
+#define TELEMETRY_FIXED_LEN              (4)
+#define TELEMETRY_INDEX_OFFSET           (1)
+#define TELEMETRY_COUNT_OFFSET           (3)
+
+/* Deltas are zigzag coded with a width of at most 15 bits per channel */
+#define TELEMETRY_WIDTH_MAX              (15)
+
+/* Company identifier in front of the payload */
+#define TELEMETRY_COMPANY_ID_LEN         (2)
+#define TELEMETRY_NUM_ELEM               (2)
+
+#define TELEMETRY_HISTORY_MASK           (BEACON_TELEMETRY_HISTORY - 1)
+
+#if (BEACON_TELEMETRY_HISTORY & TELEMETRY_HISTORY_MASK)
+#error "BEACON_TELEMETRY_HISTORY must be a power of two"
+#endif
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_telemetry_enc_t                telemetry_enc;
+static beacon_slot_t                        *telemetry_slot;
+static beacon_telemetry_read_t              *telemetry_read;
+static wiced_bt_ble_multi_adv_params_t       telemetry_params;
+static wiced_bool_t                          telemetry_registered;
+static wiced_bool_t                          telemetry_advertising;
+
+/* Sample history, written by the worker */
+static int16_t  telemetry_history[BEACON_TELEMETRY_HISTORY][BEACON_TELEMETRY_MAX_CHANNELS];
+static uint16_t telemetry_next_index;           /* Index of the next sample */
+static uint16_t telemetry_sent_index;           /* First sample not yet framed */
+static uint32_t telemetry_next_sample_ms;
+
+/* Last full frame, handed from the worker to the manager */
+static beacon_payload_t telemetry_payload;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: telemetry_zigzag
+*********************************************************************************
+* Summary:
+*   Maps a signed delta to an unsigned value, small magnitudes to small values
+*
+*********************************************************************************/
+static uint32_t telemetry_zigzag(int32_t delta)
+{
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+/********************************************************************************
+* Function Name: telemetry_width
+*********************************************************************************
+* Summary:
+*   Returns the number of bits needed for a zigzag coded delta
+*
+*********************************************************************************/
+static uint8_t telemetry_width(uint32_t value)
+{
+    uint8_t width = 0;
+
+    while (0 != value)
+    {
+        value >>= 1;
+        width++;
+    }
+    return width;
+}
+
+/********************************************************************************
+* Function Name: telemetry_put_bits
+*********************************************************************************
+* Summary:
+*   Appends the low width bits of value to a zeroed buffer, LSB first
+*
+*********************************************************************************/
+static void telemetry_put_bits(uint8_t *p_buf, uint16_t *p_pos, uint32_t value, uint8_t width)
+{
+    for (uint8_t i = 0; i < width; i++)
+    {
+        if (0 != (value & (1UL << i)))
+        {
+            p_buf[*p_pos >> 3] |= (uint8_t)(1U << (*p_pos & 7));
+        }
+        (*p_pos)++;
+    }
+}
+
+/********************************************************************************
+* Function Name: telemetry_get_bits
+*********************************************************************************
+* Summary:
+*   Reads width bits from a buffer, LSB first
+*
+*********************************************************************************/
+static uint32_t telemetry_get_bits(const uint8_t *p_buf, uint16_t *p_pos, uint8_t width)
+{
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < width; i++)
+    {
+        if (0 != (p_buf[*p_pos >> 3] & (1U << (*p_pos & 7))))
+        {
+            value |= 1UL << i;
+        }
+        (*p_pos)++;
+    }
+    return value;
+}
+
+/********************************************************************************
+* Function Name: telemetry_fit
+*********************************************************************************
+* Summary:
+*   Finds how many samples fit in one frame and the per channel widths.
+*   Returns 0 if not even the first delta of a delta frame can be coded.
+*
+*********************************************************************************/
+static uint16_t telemetry_fit(const beacon_telemetry_enc_t *p_enc, const int16_t *samples,
+                              uint16_t num_samples, wiced_bool_t keyframe, uint8_t *widths)
+{
+    uint8_t channels = p_enc->channels;
+    uint16_t header = TELEMETRY_FIXED_LEN + ((channels + 1) / 2);
+    uint16_t count;
+    uint8_t trial[BEACON_TELEMETRY_MAX_CHANNELS];
+    uint32_t bits_per_sample;
+    const int16_t *p_prev;
+
+    if (keyframe)
+    {
+        header += 2 * channels;
+        count   = 1;
+        p_prev  = samples;
+    }
+    else
+    {
+        count   = 0;
+        p_prev  = p_enc->reference;
+    }
+
+    memset(widths, 0, channels);
+
+    for (uint16_t i = count; (i < num_samples) && (i < BEACON_TELEMETRY_MAX_SAMPLES); i++)
+    {
+        const int16_t *p_cur = &samples[i * channels];
+
+        bits_per_sample = 0;
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            uint8_t width = telemetry_width(telemetry_zigzag((int32_t)p_cur[c] - p_prev[c]));
+
+            trial[c] = (width > widths[c]) ? width : widths[c];
+            if (trial[c] > TELEMETRY_WIDTH_MAX)
+            {
+                return count;
+            }
+            bits_per_sample += trial[c];
+        }
+
+        /* Only the samples after a keyframe value are in the bit stream */
+        if ((header + (((uint32_t)(i + 1 - (keyframe ? 1 : 0)) * bits_per_sample + 7) / 8)) >
+            BEACON_TELEMETRY_PAYLOAD_MAX)
+        {
+            break;
+        }
+
+        memcpy(widths, trial, channels);
+        count  = i + 1;
+        p_prev = p_cur;
+    }
+    return count;
+}
+
+/********************************************************************************
+* Function Name: beacon_telemetry_enc_init
+*********************************************************************************
+* Summary:
+*   Initializes an encoder. The first frame is a keyframe.
+*
+* Parameters:
+*   p_enc:                  Encoder
+*   channels:               Values per sample, 1 to BEACON_TELEMETRY_MAX_CHANNELS
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_telemetry_enc_init(beacon_telemetry_enc_t *p_enc, uint8_t channels)
+{
+    memset(p_enc, 0, sizeof(*p_enc));
+    p_enc->channels         = channels;
+    p_enc->frames_since_key = BEACON_TELEMETRY_KEY_INTERVAL;
+}
+
+/********************************************************************************
+* Function Name: beacon_telemetry_encode
+*********************************************************************************
+* Summary:
+*   Builds a telemetry advertisement from the leading samples. Every
+*   BEACON_TELEMETRY_KEY_INTERVAL frames, or when a delta no longer fits its
+*   width, the frame is a keyframe carrying the first sample as absolute
+*   values. Delta frames code their first sample against the last keyframe,
+*   so a scanner that missed frames decodes again with the next frame.
+*
+* Parameters:
+*   p_enc:                  Encoder
+*   samples:                Samples, oldest first, channels values each
+*   num_samples:            Number of samples
+*   first_index:            Sequence number of the first sample
+*   adv_data:               Output data buffer
+*   adv_len:                Length of output data
+*
+* Return:
+*   Number of samples in the frame, 0 if num_samples is 0
+*
+*********************************************************************************/
+uint16_t beacon_telemetry_encode(beacon_telemetry_enc_t *p_enc, const int16_t *samples,
+                                 uint16_t num_samples, uint16_t first_index,
+                                 uint8_t adv_data[BEACON_ADV_DATA_MAX], uint8_t *adv_len)
+{
+    beacon_ble_advert_elem_t adv_elem[TELEMETRY_NUM_ELEM];
+    uint8_t *p_payload = &adv_elem[1].data[TELEMETRY_COMPANY_ID_LEN];
+    uint8_t channels = p_enc->channels;
+    uint8_t widths[BEACON_TELEMETRY_MAX_CHANNELS];
+    wiced_bool_t keyframe = (p_enc->frames_since_key >= BEACON_TELEMETRY_KEY_INTERVAL);
+    uint16_t count;
+    uint16_t pos;
+    const int16_t *p_prev;
+
+    if (0 == num_samples)
+    {
+        return 0;
+    }
+
+    count = telemetry_fit(p_enc, samples, num_samples, keyframe, widths);
+    if (0 == count)
+    {
+        keyframe = WICED_TRUE;
+        count    = telemetry_fit(p_enc, samples, num_samples, keyframe, widths);
+    }
+
+    if (keyframe)
+    {
+        memcpy(p_enc->reference, samples, channels * sizeof(int16_t));
+        p_enc->key_epoch        = (p_enc->key_epoch + 1) & TELEMETRY_HDR_EPOCH_MASK;
+        p_enc->frames_since_key = 0;
+    }
+    else
+    {
+        p_enc->frames_since_key++;
+    }
+
+    memset(p_payload, 0, BEACON_TELEMETRY_PAYLOAD_MAX);
+    p_payload[0] = (keyframe ? TELEMETRY_HDR_KEYFRAME : 0) |
+                   ((channels - 1) << TELEMETRY_HDR_CHANNELS_SHIFT) | p_enc->key_epoch;
+    p_payload[TELEMETRY_INDEX_OFFSET]     = first_index & 0xff;
+    p_payload[TELEMETRY_INDEX_OFFSET + 1] = (first_index >> 8) & 0xff;
+    p_payload[TELEMETRY_COUNT_OFFSET]     = (uint8_t)count;
+    pos = TELEMETRY_FIXED_LEN;
+
+    if (keyframe)
+    {
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            p_payload[pos++] = (uint16_t)samples[c] & 0xff;
+            p_payload[pos++] = ((uint16_t)samples[c] >> 8) & 0xff;
+        }
+        p_prev = samples;
+    }
+    else
+    {
+        p_prev = p_enc->reference;
+    }
+
+    for (uint8_t c = 0; c < channels; c++)
+    {
+        p_payload[pos + (c / 2)] |= widths[c] << ((c & 1) * 4);
+    }
+    pos = (pos + ((channels + 1) / 2)) * 8;
+
+    for (uint16_t i = (keyframe ? 1 : 0); i < count; i++)
+    {
+        const int16_t *p_cur = &samples[i * channels];
+
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            telemetry_put_bits(p_payload, &pos,
+                               telemetry_zigzag((int32_t)p_cur[c] - p_prev[c]), widths[c]);
+        }
+        p_prev = p_cur;
+    }
+
+    /* first adv element Byte 0: Length :  0x02 */
+    adv_elem[0].len         = ADV_PKT_FLAG_LENGTH;
+    adv_elem[0].advert_type = BTM_BLE_ADVERT_TYPE_FLAG;
+    adv_elem[0].data[0]     = BTM_BLE_GENERAL_DISCOVERABLE_FLAG | BTM_BLE_BREDR_NOT_SUPPORTED;
+
+    /* Second adv element, company identifier and the packed samples */
+    adv_elem[1].len         = 1 + TELEMETRY_COMPANY_ID_LEN + ((pos + 7) / 8);
+    adv_elem[1].advert_type = BTM_BLE_ADVERT_TYPE_MANUFACTURER;
+    adv_elem[1].data[0]     = BEACON_TELEMETRY_COMPANY_ID & 0xff;
+    adv_elem[1].data[1]     = (BEACON_TELEMETRY_COMPANY_ID >> 8) & 0xff;
+
+    beacon_set_adv_data(adv_elem, TELEMETRY_NUM_ELEM, adv_data, adv_len);
+
+    return count;
+}
+
+/********************************************************************************
+* Function Name: beacon_telemetry_dec_init
+*********************************************************************************
+* Summary:
+*   Initializes a decoder. Delta frames are ignored until a keyframe arrives.
+*
+* Parameters:
+*   p_dec:                  Decoder
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_telemetry_dec_init(beacon_telemetry_dec_t *p_dec)
+{
+    memset(p_dec, 0, sizeof(*p_dec));
+}
+
+/********************************************************************************
+* Function Name: beacon_telemetry_decode
+*********************************************************************************
+* Summary:
+*   Extracts the samples of a received telemetry advertisement. The decoder
+*   must be kept per sender, keyframes update its reference values.
+*
+* Parameters:
+*   p_dec:                  Decoder
+*   adv_data:               Received advertisement data
+*   adv_len:                Length of the advertisement data
+*   samples:                Output samples, channels values each
+*   max_samples:            Number of samples the output can hold
+*   p_first_index:          Sequence number of the first sample
+*
+* Return:
+*   Number of decoded samples, 0 if the advertisement is not a telemetry
+*   frame or the keyframe it refers to was not received
+*
+*********************************************************************************/
+uint16_t beacon_telemetry_decode(beacon_telemetry_dec_t *p_dec, const uint8_t *adv_data,
+                                 uint8_t adv_len, int16_t *samples, uint16_t max_samples,
+                                 uint16_t *p_first_index)
+{
+    const uint8_t *p_payload = NULL;
+    uint8_t payload_len = 0;
+    uint8_t index = 0;
+    uint8_t hdr, channels, epoch;
+    uint8_t widths[BEACON_TELEMETRY_MAX_CHANNELS];
+    uint16_t count, start, pos, bits;
+    const int16_t *p_prev;
+
+    /* Find the manufacturer element carrying our company identifier */
+    while ((index + 1) < adv_len)
+    {
+        uint8_t elem_len = adv_data[index];
+
+        if ((0 == elem_len) || ((index + 1 + elem_len) > adv_len))
+        {
+            break;
+        }
+        if ((BTM_BLE_ADVERT_TYPE_MANUFACTURER == adv_data[index + 1]) &&
+            (elem_len > (1 + TELEMETRY_COMPANY_ID_LEN + TELEMETRY_FIXED_LEN)) &&
+            ((BEACON_TELEMETRY_COMPANY_ID & 0xff) == adv_data[index + 2]) &&
+            (((BEACON_TELEMETRY_COMPANY_ID >> 8) & 0xff) == adv_data[index + 3]))
+        {
+            p_payload   = &adv_data[index + 2 + TELEMETRY_COMPANY_ID_LEN];
+            payload_len = elem_len - 1 - TELEMETRY_COMPANY_ID_LEN;
+            break;
+        }
+        index += elem_len + 1;
+    }
+
+    if (NULL == p_payload)
+    {
+        return 0;
+    }
+
+    hdr      = p_payload[0];
+    channels = ((hdr >> TELEMETRY_HDR_CHANNELS_SHIFT) & TELEMETRY_HDR_CHANNELS_MASK) + 1;
+    epoch    = hdr & TELEMETRY_HDR_EPOCH_MASK;
+    count    = p_payload[TELEMETRY_COUNT_OFFSET];
+    pos      = TELEMETRY_FIXED_LEN;
+
+    if ((0 == count) || (count > max_samples))
+    {
+        return 0;
+    }
+
+    if (0 != (hdr & TELEMETRY_HDR_KEYFRAME))
+    {
+        if (payload_len < (pos + 2 * channels))
+        {
+            return 0;
+        }
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            samples[c] = (int16_t)(p_payload[pos] | (p_payload[pos + 1] << 8));
+            pos += 2;
+        }
+        memcpy(p_dec->reference, samples, channels * sizeof(int16_t));
+        p_dec->key_valid = WICED_TRUE;
+        p_dec->channels  = channels;
+        p_dec->key_epoch = epoch;
+        p_prev = samples;
+        start  = 1;
+    }
+    else
+    {
+        if (!p_dec->key_valid || (p_dec->channels != channels) || (p_dec->key_epoch != epoch))
+        {
+            return 0;
+        }
+        p_prev = p_dec->reference;
+        start  = 0;
+    }
+
+    if (payload_len < (pos + ((channels + 1) / 2)))
+    {
+        return 0;
+    }
+    bits = 0;
+    for (uint8_t c = 0; c < channels; c++)
+    {
+        widths[c] = (p_payload[pos + (c / 2)] >> ((c & 1) * 4)) & 0x0f;
+        bits     += widths[c];
+    }
+    pos += (channels + 1) / 2;
+
+    if ((payload_len * 8) < (pos * 8 + (uint32_t)(count - start) * bits))
+    {
+        return 0;
+    }
+    pos *= 8;
+
+    for (uint16_t i = start; i < count; i++)
+    {
+        int16_t *p_cur = &samples[i * channels];
+
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            uint32_t zz = telemetry_get_bits(p_payload, &pos, widths[c]);
+
+            p_cur[c] = (int16_t)(p_prev[c] + (int32_t)((zz >> 1) ^ (0U - (zz & 1))));
+        }
+        p_prev = p_cur;
+    }
+
+    *p_first_index = (uint16_t)(p_payload[TELEMETRY_INDEX_OFFSET] |
+                                (p_payload[TELEMETRY_INDEX_OFFSET + 1] << 8));
+    return count;
+}
+
+/********************************************************************************
+* Function Name: beacon_telemetry_submit
+*********************************************************************************
+* Summary:
+*   Issues the last full frame, deferred to the beacon manager task. The
+*   instance is configured and started with the first frame.
+*
+*********************************************************************************/
+static void beacon_telemetry_submit(void)
+{
+    const beacon_payload_buf_t *p_frame = beacon_payload_take(&telemetry_payload);
+
+    if ((NULL == p_frame) ||
+        (WICED_BT_PENDING != beacon_slot_set_data(telemetry_slot, p_frame->data, p_frame->len)))
+    {
+        return;
+    }
+
+    if (!telemetry_advertising)
+    {
+        if ((WICED_BT_PENDING == beacon_slot_set_params(telemetry_slot, &telemetry_params)) &&
+            (WICED_BT_PENDING == beacon_slot_start(telemetry_slot, WICED_TRUE)))
+        {
+            telemetry_advertising = WICED_TRUE;
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_telemetry_job
+*********************************************************************************
+* Summary:
+*   Worker job taking one sample per period. A frame is issued once it is
+*   full or its oldest sample has waited BEACON_TELEMETRY_MAX_LATENCY
+*   periods, so each advertised payload carries as many samples as possible.
+*
+*********************************************************************************/
+static uint32_t beacon_telemetry_job(uint32_t now_ms)
+{
+    static int16_t samples[BEACON_TELEMETRY_HISTORY * BEACON_TELEMETRY_MAX_CHANNELS];
+    int32_t wait_ms = (int32_t)(telemetry_next_sample_ms - now_ms);
+    uint8_t channels = telemetry_enc.channels;
+    beacon_payload_buf_t *p_frame = beacon_payload_buffer(&telemetry_payload);
+    beacon_telemetry_enc_t trial;
+    uint8_t adv_len;
+    uint16_t pending;
+    uint16_t count;
+
+    if (wait_ms > 0)
+    {
+        return (uint32_t)wait_ms;
+    }
+    telemetry_next_sample_ms += BEACON_TELEMETRY_SAMPLE_MS;
+
+    telemetry_read(telemetry_history[telemetry_next_index & TELEMETRY_HISTORY_MASK]);
+    telemetry_next_index++;
+
+    pending = telemetry_next_index - telemetry_sent_index;
+    if (pending > BEACON_TELEMETRY_HISTORY)
+    {
+        telemetry_sent_index = telemetry_next_index - BEACON_TELEMETRY_HISTORY;
+        pending = BEACON_TELEMETRY_HISTORY;
+    }
+
+    for (uint16_t i = 0; i < pending; i++)
+    {
+        memcpy(&samples[i * channels],
+               telemetry_history[(telemetry_sent_index + i) & TELEMETRY_HISTORY_MASK],
+               channels * sizeof(int16_t));
+    }
+
+    /* Encode on a copy into the buffer owned by the worker, the encoder only
+     * advances when the frame is published */
+    trial = telemetry_enc;
+    count = beacon_telemetry_encode(&trial, samples, pending, telemetry_sent_index,
+                                    p_frame->data, &adv_len);
+
+    if ((count < pending) || (pending >= BEACON_TELEMETRY_MAX_LATENCY))
+    {
+        telemetry_enc         = trial;
+        telemetry_sent_index += count;
+
+        beacon_payload_publish(&telemetry_payload, adv_len);
+        beacon_manager_defer(beacon_telemetry_submit);
+    }
+
+    wait_ms = (int32_t)(telemetry_next_sample_ms - now_ms);
+    return (wait_ms > 0) ? (uint32_t)wait_ms : 0;
+}
+
+/********************************************************************************
+* Function Name: beacon_telemetry_start
+*********************************************************************************
+* Summary:
+*   Starts sampling the sensors and advertising the telemetry frames on a
+*   spare instance. Call from the beacon manager task.
+*
+* Parameters:
+*   p_slot:                 Spare instance
+*   channels:               Values per sample, 1 to BEACON_TELEMETRY_MAX_CHANNELS
+*   p_read:                 Reads one sample
+*   p_params:               Advertising parameters of the instance
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_telemetry_start(beacon_slot_t *p_slot, uint8_t channels,
+                            beacon_telemetry_read_t *p_read,
+                            const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    if ((NULL == p_slot) || (0 == channels) || (channels > BEACON_TELEMETRY_MAX_CHANNELS))
+    {
+        return;
+    }
+
+    beacon_telemetry_enc_init(&telemetry_enc, channels);
+    telemetry_slot           = p_slot;
+    telemetry_read           = p_read;
+    telemetry_params         = *p_params;
+    telemetry_advertising    = WICED_FALSE;
+    telemetry_next_index     = 0;
+    telemetry_sent_index     = 0;
+    telemetry_next_sample_ms = beacon_stats_now_ms();
+
+    if (!telemetry_registered)
+    {
+        telemetry_registered = WICED_TRUE;
+        beacon_payload_init(&telemetry_payload);
+        beacon_worker_register(beacon_telemetry_job, BEACON_TELEMETRY_SAMPLE_SLACK_MS);
+    }
+}
+
+/* [] END OF FILE */
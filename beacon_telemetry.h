@@ -0,0 +1,129 @@
+/******************************************************************************
+* File Name: beacon_telemetry.h
+*
+* Description: This file contains the definitions for the sensor telemetry
+* frames. A frame carries a run of sensor samples in manufacturer specific
+* data, coded as bit-packed deltas against a periodically sent keyframe.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_TELEMETRY_H__
+#define __BEACON_TELEMETRY_H__
+
+#include "wiced_bt_ble.h"
+#include "beacon_utils.h"
+#include "beacon_slot.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to advertise sensor telemetry on a spare instance */
+#ifndef BEACON_TELEMETRY_ENABLE
+#define BEACON_TELEMETRY_ENABLE          (0)
+#endif
+
+/* Company identifier placed in front of the telemetry frame */
+#define BEACON_TELEMETRY_COMPANY_ID      (0x0131)
+
+/* Maximum number of sensor channels per sample */
+#define BEACON_TELEMETRY_MAX_CHANNELS    (4)
+
+/* Telemetry payload after the flags, the AD header and the company ID */
+#define BEACON_TELEMETRY_PAYLOAD_MAX     (BEACON_ADV_DATA_MAX - (ADV_PKT_FLAG_LENGTH + 1) - 4)
+
+/* Most samples a frame can carry, all deltas zero */
+#define BEACON_TELEMETRY_MAX_SAMPLES     (255)
+
+/* Delta frames sent between two keyframes */
+#define BEACON_TELEMETRY_KEY_INTERVAL    (8)
+
+/* Sampling period and the longest a sample waits for a full frame */
+#define BEACON_TELEMETRY_SAMPLE_MS       (1000)
+#define BEACON_TELEMETRY_MAX_LATENCY     (16)
+#define BEACON_TELEMETRY_SAMPLE_SLACK_MS (100)
+
+/* Samples kept for framing, a power of two above the samples per frame */
+#define BEACON_TELEMETRY_HISTORY         (32)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Encoder state, one per advertised sensor stream */
+typedef struct
+{
+    uint8_t channels;                                   /* Values per sample */
+    uint8_t key_epoch;                                  /* Sequence of the last keyframe */
+    uint8_t frames_since_key;                           /* Delta frames since then */
+    int16_t reference[BEACON_TELEMETRY_MAX_CHANNELS];   /* Values of the last keyframe */
+}beacon_telemetry_enc_t;
+
+/* Decoder state, one per received sensor stream */
+typedef struct
+{
+    wiced_bool_t key_valid;                             /* A keyframe was received */
+    uint8_t channels;                                   /* Values per sample */
+    uint8_t key_epoch;                                  /* Sequence of the last keyframe */
+    int16_t reference[BEACON_TELEMETRY_MAX_CHANNELS];   /* Values of the last keyframe */
+}beacon_telemetry_dec_t;
+
+/* Reads one sample, BEACON_TELEMETRY_MAX_CHANNELS values at most */
+typedef void (beacon_telemetry_read_t)(int16_t *values);
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void     beacon_telemetry_enc_init (beacon_telemetry_enc_t *p_enc, uint8_t channels);
+
+uint16_t beacon_telemetry_encode   (beacon_telemetry_enc_t *p_enc, const int16_t *samples,
+                                    uint16_t num_samples, uint16_t first_index,
+                                    uint8_t adv_data[BEACON_ADV_DATA_MAX], uint8_t *adv_len);
+
+void     beacon_telemetry_dec_init (beacon_telemetry_dec_t *p_dec);
+
+uint16_t beacon_telemetry_decode   (beacon_telemetry_dec_t *p_dec, const uint8_t *adv_data,
+                                    uint8_t adv_len, int16_t *samples, uint16_t max_samples,
+                                    uint16_t *p_first_index);
+
+void     beacon_telemetry_start    (beacon_slot_t *p_slot, uint8_t channels,
+                                    beacon_telemetry_read_t *p_read,
+                                    const wiced_bt_ble_multi_adv_params_t *p_params);
+
+#endif      /* __BEACON_TELEMETRY_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,592 @@
+/******************************************************************************
+* File Name: beacon_timer.c
+*
+* Description: This is the source code for the beacon timer wheel. Timers are
+* kept in per-slot lists with an occupancy bitmap per level, so adding and
+* cancelling a timer is O(1) and the next expiry is found with a few bit
+* operations. Expiries run in the beacon manager task; the only FreeRTOS
+* timer is re-armed for the next non-empty slot, so idle periods need no
+* wakeups.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <string.h>
+#include "cy_pdl.h"
+#include <FreeRTOS.h>
+#include <timers.h>
+#include "beacon_timer.h"
+#include "beacon_manager.h"
+#include "beacon_stats.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TIMER_SLOT_MASK                  (BEACON_TIMER_LEVEL_SLOTS - 1)
+
+/* Largest delay the wheel holds without clamping */
+#define TIMER_MAX_DELTA                  ((1UL << (BEACON_TIMER_LEVEL_BITS * BEACON_TIMER_LEVELS)) - 1)
+
+/* Longest sleep of the FreeRTOS timer, keeps pdMS_TO_TICKS within 32 bits */
+#define TIMER_MAX_SLEEP_MS               (3600000UL)
+
+/* Index of the lowest set bit */
+#define TIMER_CTZ(bits)                  (__CLZ(__RBIT(bits)))
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_timer_wheel_t timer_wheel;
+static uint32_t             timer_last_ms;      /* Time of timer_ticks */
+static uint32_t             timer_ticks;        /* Wheel ticks elapsed at timer_last_ms */
+
+static TimerHandle_t        timer_handle;
+static StaticTimer_t        timer_buffer;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_link
+*********************************************************************************
+* Summary:
+*   Puts a timer in the slot of its expiry. Level n holds the timers expiring
+*   in less than 32^(n+1) ticks; the slot is selected by the expiry bits of
+*   that level.
+*
+*********************************************************************************/
+static void beacon_timer_wheel_link(beacon_timer_wheel_t *p_wheel, beacon_timer_t *p_timer)
+{
+    uint32_t delta = p_timer->expires - p_wheel->now;
+    uint32_t shift;
+    uint8_t level;
+    beacon_timer_t **pp_head;
+
+    if ((int32_t)delta < 0)
+    {
+        delta = 0;
+    }
+    else if (delta > TIMER_MAX_DELTA)
+    {
+        /* Re-inserted with the remaining delay when the end is reached */
+        delta = TIMER_MAX_DELTA;
+    }
+
+    for (level = 0; level < (BEACON_TIMER_LEVELS - 1); level++)
+    {
+        if (delta < (1UL << (BEACON_TIMER_LEVEL_BITS * (level + 1))))
+        {
+            break;
+        }
+    }
+
+    shift = BEACON_TIMER_LEVEL_BITS * level;
+    p_timer->level = level;
+    p_timer->slot  = (uint8_t)(((p_wheel->now + delta) >> shift) & TIMER_SLOT_MASK);
+
+    pp_head = &p_wheel->slots[level][p_timer->slot];
+    p_timer->p_next  = *pp_head;
+    p_timer->pp_prev = pp_head;
+    if (NULL != *pp_head)
+    {
+        (*pp_head)->pp_prev = &p_timer->p_next;
+    }
+    *pp_head = p_timer;
+
+    p_wheel->occupied[level] |= (1UL << p_timer->slot);
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_unlink
+*********************************************************************************
+* Summary:
+*   Removes a timer from its slot list
+*
+*********************************************************************************/
+static void beacon_timer_wheel_unlink(beacon_timer_wheel_t *p_wheel, beacon_timer_t *p_timer)
+{
+    *p_timer->pp_prev = p_timer->p_next;
+    if (NULL != p_timer->p_next)
+    {
+        p_timer->p_next->pp_prev = p_timer->pp_prev;
+    }
+    p_timer->pp_prev = NULL;
+
+    if (NULL == p_wheel->slots[p_timer->level][p_timer->slot])
+    {
+        p_wheel->occupied[p_timer->level] &= ~(1UL << p_timer->slot);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_detach
+*********************************************************************************
+* Summary:
+*   Moves the list of a slot to p_head and marks the slot empty
+*
+*********************************************************************************/
+static void beacon_timer_wheel_detach(beacon_timer_wheel_t *p_wheel, uint8_t level,
+                                      uint32_t slot, beacon_timer_t **p_head)
+{
+    *p_head = p_wheel->slots[level][slot];
+    if (NULL != *p_head)
+    {
+        (*p_head)->pp_prev = p_head;
+    }
+    p_wheel->slots[level][slot] = NULL;
+    p_wheel->occupied[level] &= ~(1UL << slot);
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_tick
+*********************************************************************************
+* Summary:
+*   Processes one tick. When the lower levels wrap, the slot of the next
+*   level is cascaded down; then the timers of the level 0 slot expire.
+*
+*********************************************************************************/
+static void beacon_timer_wheel_tick(beacon_timer_wheel_t *p_wheel)
+{
+    beacon_timer_t *p_head;
+    beacon_timer_t *p_timer;
+    uint32_t index = p_wheel->now & TIMER_SLOT_MASK;
+
+    for (uint8_t level = 1; (level < BEACON_TIMER_LEVELS) && (0 == index); level++)
+    {
+        index = (p_wheel->now >> (BEACON_TIMER_LEVEL_BITS * level)) & TIMER_SLOT_MASK;
+        beacon_timer_wheel_detach(p_wheel, level, index, &p_head);
+
+        while (NULL != (p_timer = p_head))
+        {
+            beacon_timer_wheel_unlink(p_wheel, p_timer);
+            beacon_timer_wheel_link(p_wheel, p_timer);
+        }
+    }
+
+    beacon_timer_wheel_detach(p_wheel, 0, p_wheel->now & TIMER_SLOT_MASK, &p_head);
+
+    /* Timers added by the callbacks belong to the following ticks */
+    p_wheel->now++;
+
+    while (NULL != (p_timer = p_head))
+    {
+        beacon_timer_wheel_unlink(p_wheel, p_timer);
+
+        if ((int32_t)(p_timer->expires - p_wheel->now) >= 0)
+        {
+            /* Clamped timer that has not reached its expiry yet */
+            beacon_timer_wheel_link(p_wheel, p_timer);
+            continue;
+        }
+
+        p_wheel->pending--;
+        p_timer->p_cback(p_timer);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_init
+*********************************************************************************
+* Summary:
+*   Initializes an empty wheel
+*
+* Parameters:
+*   p_wheel:                Wheel
+*   now:                    Current tick
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_timer_wheel_init(beacon_timer_wheel_t *p_wheel, uint32_t now)
+{
+    memset(p_wheel, 0, sizeof(*p_wheel));
+    p_wheel->now = now;
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_add
+*********************************************************************************
+* Summary:
+*   Adds a timer, or moves it if it is already pending. The callback runs when
+*   the wheel advances past the expiry tick.
+*
+* Parameters:
+*   p_wheel:                Wheel
+*   p_timer:                Timer, set up with its callback
+*   expires:                Expiry tick
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_timer_wheel_add(beacon_timer_wheel_t *p_wheel, beacon_timer_t *p_timer,
+                            uint32_t expires)
+{
+    if (NULL != p_timer->pp_prev)
+    {
+        beacon_timer_wheel_unlink(p_wheel, p_timer);
+    }
+    else
+    {
+        p_wheel->pending++;
+    }
+
+    p_timer->expires = expires;
+    beacon_timer_wheel_link(p_wheel, p_timer);
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_del
+*********************************************************************************
+* Summary:
+*   Cancels a timer. Cancelling a timer that is not pending has no effect.
+*
+* Parameters:
+*   p_wheel:                Wheel
+*   p_timer:                Timer
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_timer_wheel_del(beacon_timer_wheel_t *p_wheel, beacon_timer_t *p_timer)
+{
+    if (NULL != p_timer->pp_prev)
+    {
+        beacon_timer_wheel_unlink(p_wheel, p_timer);
+        p_wheel->pending--;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_next
+*********************************************************************************
+* Summary:
+*   Returns the number of ticks that can be skipped before a tick that expires
+*   timers or cascades a non-empty slot. For every level, the next occupied
+*   slot is found in the bitmap, from the current position onwards and then
+*   in the following rotation.
+*
+* Parameters:
+*   p_wheel:                Wheel
+*
+* Return:
+*   uint32_t: Ticks to skip, BEACON_TIMER_IDLE if no timer is pending
+*
+*********************************************************************************/
+uint32_t beacon_timer_wheel_next(const beacon_timer_wheel_t *p_wheel)
+{
+    uint32_t next = BEACON_TIMER_IDLE;
+    uint32_t shift;
+    uint32_t index;
+    uint32_t bits;
+    uint32_t rotation;
+    uint32_t tick;
+
+    if (0 == p_wheel->pending)
+    {
+        return BEACON_TIMER_IDLE;
+    }
+
+    for (uint8_t level = 0; level < BEACON_TIMER_LEVELS; level++)
+    {
+        if (0 == p_wheel->occupied[level])
+        {
+            continue;
+        }
+
+        shift    = BEACON_TIMER_LEVEL_BITS * level;
+        index    = (p_wheel->now >> shift) & TIMER_SLOT_MASK;
+        rotation = p_wheel->now & ~((1UL << (shift + BEACON_TIMER_LEVEL_BITS)) - 1);
+
+        /* The current slot of an upper level was cascaded already unless
+         * the levels below are at the start of their rotation */
+        if (0 != (p_wheel->now & ((1UL << shift) - 1)))
+        {
+            index++;
+        }
+
+        bits = (index < BEACON_TIMER_LEVEL_SLOTS) ? (p_wheel->occupied[level] >> index) : 0;
+        if (0 != bits)
+        {
+            tick = rotation + ((index + TIMER_CTZ(bits)) << shift);
+        }
+        else
+        {
+            tick = rotation + ((BEACON_TIMER_LEVEL_SLOTS + TIMER_CTZ(p_wheel->occupied[level])) << shift);
+        }
+
+        if ((tick - p_wheel->now) < next)
+        {
+            next = tick - p_wheel->now;
+        }
+    }
+    return next;
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_wheel_advance
+*********************************************************************************
+* Summary:
+*   Advances the wheel and runs the callbacks of the expired timers. Ticks
+*   without work are skipped, so the cost depends on the number of expiries
+*   and cascades, not on the number of pending timers or elapsed ticks.
+*
+* Parameters:
+*   p_wheel:                Wheel
+*   ticks:                  Elapsed ticks
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_timer_wheel_advance(beacon_timer_wheel_t *p_wheel, uint32_t ticks)
+{
+    uint32_t skip;
+
+    while (0 != ticks)
+    {
+        skip = beacon_timer_wheel_next(p_wheel);
+
+        if (skip >= ticks)
+        {
+            p_wheel->now += ticks;
+            return;
+        }
+
+        p_wheel->now += skip;
+        ticks        -= skip + 1;
+        beacon_timer_wheel_tick(p_wheel);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_rearm
+*********************************************************************************
+* Summary:
+*   Arms the FreeRTOS timer for the next tick with work
+*
+*********************************************************************************/
+static void beacon_timer_rearm(void)
+{
+    uint32_t next = beacon_timer_wheel_next(&timer_wheel);
+    uint32_t elapsed_ms = beacon_stats_now_ms() - timer_last_ms;
+    uint32_t delay_ms;
+
+    if (BEACON_TIMER_IDLE == next)
+    {
+        xTimerStop(timer_handle, 0);
+        return;
+    }
+
+    /* The tick is processed once it has fully elapsed */
+    next += timer_ticks - timer_wheel.now;
+    if (next >= (TIMER_MAX_SLEEP_MS / BEACON_TIMER_TICK_MS))
+    {
+        delay_ms = TIMER_MAX_SLEEP_MS;
+    }
+    else
+    {
+        delay_ms = (next + 1) * BEACON_TIMER_TICK_MS;
+        delay_ms = (delay_ms > elapsed_ms) ? (delay_ms - elapsed_ms) : 1;
+    }
+
+    xTimerChangePeriod(timer_handle, (pdMS_TO_TICKS(delay_ms) > 0) ? pdMS_TO_TICKS(delay_ms) : 1, 0);
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_sync
+*********************************************************************************
+* Summary:
+*   Accounts the whole ticks elapsed since the last update
+*
+*********************************************************************************/
+static void beacon_timer_sync(void)
+{
+    uint32_t ticks = (beacon_stats_now_ms() - timer_last_ms) / BEACON_TIMER_TICK_MS;
+
+    timer_last_ms += ticks * BEACON_TIMER_TICK_MS;
+    timer_ticks   += ticks;
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_process
+*********************************************************************************
+* Summary:
+*   Runs the expired timers, deferred to the beacon manager task
+*
+*********************************************************************************/
+static void beacon_timer_process(void)
+{
+    beacon_timer_sync();
+    beacon_timer_wheel_advance(&timer_wheel, timer_ticks - timer_wheel.now);
+    beacon_timer_rearm();
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_fired
+*********************************************************************************
+* Summary:
+*   FreeRTOS timer callback, runs in the timer service task
+*
+*********************************************************************************/
+static void beacon_timer_fired(TimerHandle_t handle)
+{
+    (void)handle;
+
+    beacon_manager_defer(beacon_timer_process);
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_init
+*********************************************************************************
+* Summary:
+*   Initializes the timer wheel of the application and its FreeRTOS timer.
+*   Call after beacon_manager_init.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_timer_init(void)
+{
+    if (NULL == timer_handle)
+    {
+        timer_last_ms = beacon_stats_now_ms();
+        timer_ticks   = 0;
+        beacon_timer_wheel_init(&timer_wheel, 0);
+        timer_handle = xTimerCreateStatic("Wheel", 1, pdFALSE, NULL, beacon_timer_fired,
+                                          &timer_buffer);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_setup
+*********************************************************************************
+* Summary:
+*   Prepares a timer node. Must be called once before the timer is started.
+*
+* Parameters:
+*   p_timer:                Timer
+*   p_cback:                Expiry callback, runs in the beacon manager task
+*   p_arg:                  Owner data, available as p_timer->p_arg
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_timer_setup(beacon_timer_t *p_timer, beacon_timer_cback_t *p_cback, void *p_arg)
+{
+    memset(p_timer, 0, sizeof(*p_timer));
+    p_timer->p_cback = p_cback;
+    p_timer->p_arg   = p_arg;
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_start
+*********************************************************************************
+* Summary:
+*   Starts or restarts a timer of the application wheel. Must be called from
+*   the beacon manager task. The callback runs at most one tick late.
+*
+* Parameters:
+*   p_timer:                Timer
+*   delay_ms:               Delay
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_timer_start(beacon_timer_t *p_timer, uint32_t delay_ms)
+{
+    uint32_t now_tick;
+
+    /* An idle wheel catches up without running anything */
+    if (0 == timer_wheel.pending)
+    {
+        beacon_timer_sync();
+        timer_wheel.now = timer_ticks;
+    }
+
+    now_tick = timer_ticks + (beacon_stats_now_ms() - timer_last_ms) / BEACON_TIMER_TICK_MS;
+    beacon_timer_wheel_add(&timer_wheel, p_timer,
+                           now_tick + (delay_ms + BEACON_TIMER_TICK_MS - 1) / BEACON_TIMER_TICK_MS);
+    beacon_timer_rearm();
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_stop
+*********************************************************************************
+* Summary:
+*   Cancels a timer of the application wheel. Must be called from the beacon
+*   manager task.
+*
+* Parameters:
+*   p_timer:                Timer
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_timer_stop(beacon_timer_t *p_timer)
+{
+    beacon_timer_wheel_del(&timer_wheel, p_timer);
+}
+
+/********************************************************************************
+* Function Name: beacon_timer_is_pending
+*********************************************************************************
+* Summary:
+*   Returns whether a timer is pending
+*
+* Parameters:
+*   p_timer:                Timer
+*
+* Return:
+*   wiced_bool_t: WICED_TRUE if the timer is pending
+*
+*********************************************************************************/
+wiced_bool_t beacon_timer_is_pending(const beacon_timer_t *p_timer)
+{
+    return (NULL != p_timer->pp_prev) ? WICED_TRUE : WICED_FALSE;
+}
+
+/* [] END OF FILE */
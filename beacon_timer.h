@@ -0,0 +1,127 @@
+/******************************************************************************
+* File Name: beacon_timer.h
+*
+* Description: This file contains the definitions for the beacon timer wheel.
+* A hierarchical timer wheel holds any number of statically allocated
+* deadlines and is driven by a single FreeRTOS software timer.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_TIMER_H__
+#define __BEACON_TIMER_H__
+
+#include <stdint.h>
+#include "wiced_bt_types.h"
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Resolution of the wheel */
+#ifndef BEACON_TIMER_TICK_MS
+#define BEACON_TIMER_TICK_MS             (10)
+#endif
+
+/* Each level has 32 slots, one bit of a 32-bit occupancy bitmap per slot.
+ * Five levels cover 2^25 ticks, more than 90 hours at 10 ms; longer delays
+ * are clamped and re-inserted when they reach the end of the wheel. */
+#define BEACON_TIMER_LEVEL_BITS          (5)
+#define BEACON_TIMER_LEVEL_SLOTS         (1UL << BEACON_TIMER_LEVEL_BITS)
+#define BEACON_TIMER_LEVELS              (5)
+
+/* Returned by beacon_timer_wheel_next when no timer is pending */
+#define BEACON_TIMER_IDLE                (0xFFFFFFFFUL)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+struct beacon_timer;
+
+/* Expiry callback */
+typedef void (beacon_timer_cback_t)(struct beacon_timer *p_timer);
+
+/* Timer node, embedded in the structure of its owner */
+typedef struct beacon_timer
+{
+    struct beacon_timer *p_next;                /* Next node in the slot */
+    struct beacon_timer **pp_prev;              /* Link pointing to this node, NULL if
+                                                 * the timer is not pending */
+    uint32_t expires;                           /* Expiry tick */
+    uint8_t level;                              /* Level of the slot holding the node */
+    uint8_t slot;                               /* Slot holding the node */
+    beacon_timer_cback_t *p_cback;              /* Expiry callback */
+    void *p_arg;                                /* Owner data */
+}beacon_timer_t;
+
+/* Timer wheel */
+typedef struct
+{
+    beacon_timer_t *slots[BEACON_TIMER_LEVELS][BEACON_TIMER_LEVEL_SLOTS];
+    uint32_t occupied[BEACON_TIMER_LEVELS];     /* Non-empty slots per level */
+    uint32_t now;                               /* Next tick to process */
+    uint32_t pending;                           /* Number of pending timers */
+}beacon_timer_wheel_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void         beacon_timer_wheel_init    (beacon_timer_wheel_t *p_wheel, uint32_t now);
+
+void         beacon_timer_wheel_add     (beacon_timer_wheel_t *p_wheel, beacon_timer_t *p_timer,
+                                         uint32_t expires);
+
+void         beacon_timer_wheel_del     (beacon_timer_wheel_t *p_wheel, beacon_timer_t *p_timer);
+
+uint32_t     beacon_timer_wheel_next    (const beacon_timer_wheel_t *p_wheel);
+
+void         beacon_timer_wheel_advance (beacon_timer_wheel_t *p_wheel, uint32_t ticks);
+
+void         beacon_timer_init          (void);
+
+void         beacon_timer_setup         (beacon_timer_t *p_timer, beacon_timer_cback_t *p_cback,
+                                         void *p_arg);
+
+void         beacon_timer_start         (beacon_timer_t *p_timer, uint32_t delay_ms);
+
+void         beacon_timer_stop          (beacon_timer_t *p_timer);
+
+wiced_bool_t beacon_timer_is_pending    (const beacon_timer_t *p_timer);
+
+#endif      /* __BEACON_TIMER_H__ */
+
+
+/* [] END OF FILE */
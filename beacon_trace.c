@@ -0,0 +1,218 @@
+/******************************************************************************
+* File Name: beacon_trace.c
+*
+* Description: This is the source code for the trace recorder. Records are
+* appended with interrupts masked, so the task switch hook, the stack
+* callbacks and the tasks can all record. The ring fills once and then
+* stops, so the start-up sequence is kept until the trace is cleared.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "cy_pdl.h"
+#include "beacon_trace.h"
+#include "beacon_stats.h"
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_trace_record_t trace_records[BEACON_TRACE_RECORDS];
+static uint32_t              trace_count;
+static uint32_t              trace_dropped;
+
+/* Recording is paused while the trace is printed */
+static volatile uint8_t      trace_paused;
+
+static TaskStatus_t          trace_tasks[BEACON_TRACE_MAX_TASKS];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_trace_record
+*********************************************************************************
+* Summary:
+*   Appends a record. Callable from tasks, stack callbacks and interrupts.
+*   The cycle counter is read with interrupts masked, so the records are in
+*   time order.
+*
+* Parameters:
+*   type:                   beacon_trace_type_t
+*   id:                     Depends on type
+*   arg:                    Depends on type
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_trace_record(uint8_t type, uint8_t id, uint16_t arg)
+{
+    beacon_trace_record_t *p_record;
+    UBaseType_t mask;
+
+    if (trace_paused)
+    {
+        return;
+    }
+
+    mask = taskENTER_CRITICAL_FROM_ISR();
+
+    if (BEACON_TRACE_RECORDS == trace_count)
+    {
+        trace_dropped++;
+    }
+    else
+    {
+        p_record = &trace_records[trace_count];
+        p_record->cycles = beacon_stats_cycles();
+        p_record->type   = type;
+        p_record->id     = id;
+        p_record->arg    = arg;
+        trace_count++;
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/********************************************************************************
+* Function Name: beacon_trace_task_switched_in
+*********************************************************************************
+* Summary:
+*   traceTASK_SWITCHED_IN hook, runs in the kernel with the scheduler
+*   locked
+*
+* Parameters:
+*   task_number:            FreeRTOS task number of the new task
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_trace_task_switched_in(uint32_t task_number)
+{
+    beacon_trace_record(BEACON_TRACE_TASK_IN, 0, (uint16_t)task_number);
+}
+
+/********************************************************************************
+* Function Name: beacon_trace_clear
+*********************************************************************************
+* Summary:
+*   Empties the trace and restarts recording
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_trace_clear(void)
+{
+    taskENTER_CRITICAL();
+    trace_count   = 0;
+    trace_dropped = 0;
+    trace_paused  = 0;
+    taskEXIT_CRITICAL();
+}
+
+/********************************************************************************
+* Function Name: beacon_trace_count
+*********************************************************************************
+* Summary:
+*   Returns the number of records in the trace
+*
+* Parameters:
+*   None
+*
+* Return:
+*   Number of records
+*
+*********************************************************************************/
+uint32_t beacon_trace_count(void)
+{
+    return trace_count;
+}
+
+/********************************************************************************
+* Function Name: beacon_trace_dump
+*********************************************************************************
+* Summary:
+*   Prints the names of the tasks and the records for the host converter,
+*   scripts/beacon_trace.py. Recording is paused meanwhile, so the dump does
+*   not trace itself.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_trace_dump(void)
+{
+    const beacon_trace_record_t *p_record;
+    UBaseType_t num_tasks;
+
+    trace_paused = 1;
+
+    num_tasks = uxTaskGetSystemState(trace_tasks, BEACON_TRACE_MAX_TASKS, NULL);
+
+    printf("trace %lu %lu %lu\n", (unsigned long)SystemCoreClock,
+           (unsigned long)trace_count, (unsigned long)trace_dropped);
+
+    for (UBaseType_t i = 0; i < num_tasks; i++)
+    {
+        printf("task %lu %s\n", (unsigned long)trace_tasks[i].xTaskNumber,
+               trace_tasks[i].pcTaskName);
+    }
+
+    for (uint32_t i = 0; i < trace_count; i++)
+    {
+        p_record = &trace_records[i];
+        printf("%08lx %u %u %u\n", (unsigned long)p_record->cycles, p_record->type,
+               p_record->id, p_record->arg);
+    }
+
+    printf("end\n");
+
+    trace_paused = 0;
+}
+
+/* [] END OF FILE */
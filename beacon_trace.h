@@ -0,0 +1,115 @@
+/******************************************************************************
+* File Name: beacon_trace.h
+*
+* Description: This file contains the definitions for the trace recorder. The
+* recorder keeps a timeline of task switches, stack callbacks and
+* multi-advertising commands in RAM for export to the Chrome trace format.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_TRACE_H__
+#define __BEACON_TRACE_H__
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Set to 1 to record the trace, the task switch hook is installed by
+ * FreeRTOSConfig.h when this is defined in the Makefile */
+#ifndef BEACON_TRACE_ENABLE
+#define BEACON_TRACE_ENABLE              (0)
+#endif
+
+/* Number of records kept, 8 bytes each */
+#ifndef BEACON_TRACE_RECORDS
+#define BEACON_TRACE_RECORDS             (1024)
+#endif
+
+/* Maximum number of tasks named in a dump */
+#define BEACON_TRACE_MAX_TASKS           (16)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Record types */
+typedef enum
+{
+    BEACON_TRACE_TASK_IN,                       /* arg: FreeRTOS task number */
+    BEACON_TRACE_CBACK_ENTER,                   /* id: stack event */
+    BEACON_TRACE_CBACK_EXIT,                    /* id: stack event, arg: beacon_manager_evt_type_t,
+                                                   BEACON_MANAGER_EVT_MAX if not handled */
+    BEACON_TRACE_CMD_ISSUE,                     /* id: opcode, arg: instance */
+    BEACON_TRACE_CMD_REJECT,                    /* id: opcode, arg: instance, the last issue
+                                                   gets no response */
+    BEACON_TRACE_CMD_RESP                       /* id: opcode, arg: instance | status << 8 */
+}beacon_trace_type_t;
+
+/* One record */
+typedef struct
+{
+    uint32_t cycles;                            /* Cycle counter, see beacon_stats_cycles */
+    uint8_t type;                               /* beacon_trace_type_t */
+    uint8_t id;                                 /* Depends on type */
+    uint16_t arg;                               /* Depends on type */
+}beacon_trace_record_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void     beacon_trace_record            (uint8_t type, uint8_t id, uint16_t arg);
+
+void     beacon_trace_task_switched_in  (uint32_t task_number);
+
+void     beacon_trace_clear             (void);
+
+uint32_t beacon_trace_count             (void);
+
+void     beacon_trace_dump              (void);
+
+/* Records an event, compiled out unless the trace is enabled */
+#if BEACON_TRACE_ENABLE
+#define BEACON_TRACE(type, id, arg)      beacon_trace_record((type), (uint8_t)(id), (uint16_t)(arg))
+#else
+#define BEACON_TRACE(type, id, arg)
+#endif
+
+#endif      /* __BEACON_TRACE_H__ */
+
+
+/* [] END OF FILE */
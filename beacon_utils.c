@@ -45,10 +45,10 @@
 #include "beacon_utils.h"
 
 /* local data used by methods */
-static beacon_ble_advert_elem_t ibeacon_adv_elem[IBEACON_ELEM_NUM];
 const uint8_t ibeacon_type[ LEN_UUID_16 ] = { IBEACON_PROXIMITY };
 const uint8_t ibeacon_company_id[ LEN_UUID_16 ] = { IBEACON_COMPANY_ID_APPLE };
 
+#if BEACON_IBEACON_ENABLE
 /******************************************************************************
 * Function Name:ibeacon_set_adv_data
 ***************************************************************************//**
@@ -78,6 +78,9 @@ void ibeacon_set_adv_data (uint8_t ibeacon_uuid[LEN_UUID_128],uint16_t ibeacon_m
     uint8_t flag = BTM_BLE_GENERAL_DISCOVERABLE_FLAG|BTM_BLE_BREDR_NOT_SUPPORTED;
     uint8_t ibeacon_data[IBEACON_DATA_LENGTH];
 
+    /* Staged on the stack, so tasks may encode concurrently */
+    beacon_ble_advert_elem_t ibeacon_adv_elem[IBEACON_ELEM_NUM];
+
     /* first adv element Byte 0: Length :  0x02 */
     ibeacon_adv_elem[IBEACON_ADV_INDEX0].len          = ADV_PKT_FLAG_LENGTH;
     ibeacon_adv_elem[IBEACON_ADV_INDEX0].advert_type  = BTM_BLE_ADVERT_TYPE_FLAG;
@@ -117,7 +120,9 @@ void ibeacon_set_adv_data (uint8_t ibeacon_uuid[LEN_UUID_128],uint16_t ibeacon_m
     /* Copy the adv data to output buffer */
     beacon_set_adv_data(ibeacon_adv_elem, IBEACON_ELEM_NUM, adv_data, adv_len);
 }
+#endif
 
+#if BEACON_EDDYSTONE_URL_ENABLE
 /********************************************************************************
 * Function Name: eddystone_set_data_for_url
 *********************************************************************************
@@ -195,6 +200,7 @@ void eddystone_set_data_common(beacon_ble_advert_elem_t *eddystone_adv_elem,
     eddystone_adv_elem[EDDYSTONE_ADV_INDEX2].data[EDDYSTONE_ADV_DATA_INDEX1] =
     eddystone_uuid[EDDYSTONE_UUID_INDEX1];
 }
+#endif
 
 /********************************************************************************
 * Function Name: beacon_set_adv_data
@@ -227,4 +233,181 @@ void beacon_set_adv_data(beacon_ble_advert_elem_t *beacon_adv_elem, uint8_t num_
     *adv_len = buffer_index;
 }
 
+/********************************************************************************
+* Function Name: beacon_parse_adv_data
+*********************************************************************************
+* Summary:
+*   This function walks the AD structures of a received advertisement and
+*   identifies iBeacon and Eddystone frames. The identity bytes point into
+*   adv_data, so the buffer must stay valid while info is used.
+*
+* Parameters:
+*   adv_data:               Received advertisement data
+*   adv_len:                Maximum length of the advertisement data
+*   info:                   Parsed frame information
+*
+* Return:
+*   WICED_TRUE if a known beacon format was found, WICED_FALSE otherwise
+*
+*********************************************************************************/
+wiced_bool_t beacon_parse_adv_data(const uint8_t *adv_data, uint8_t adv_len,
+                                   beacon_frame_info_t *info)
+{
+    uint8_t index = 0;
+    uint8_t elem_len;
+    const uint8_t *elem;
+
+    info->format                = BEACON_FORMAT_UNKNOWN;
+    info->measured_power        = 0;
+    info->measured_power_offset = 0;
+    info->id                    = NULL;
+    info->id_len                = 0;
+
+    while ((index + 1) < adv_len)
+    {
+        elem_len = adv_data[index];
+
+        /* A zero length element terminates the significant part */
+        if ((0 == elem_len) || ((index + 1 + elem_len) > adv_len))
+        {
+            break;
+        }
+        elem = &adv_data[index + 2];
+
+        if ((BTM_BLE_ADVERT_TYPE_MANUFACTURER == adv_data[index + 1]) &&
+            (IBEACON_ADV_PKT_LENGTH == elem_len) &&
+            (ibeacon_company_id[IBEACON_DATA_COMPANY_ID_INDEX0] == elem[IBEACON_DATA_INDEX0]) &&
+            (ibeacon_company_id[IBEACON_DATA_COMPANY_ID_INDEX1] == elem[IBEACON_DATA_INDEX1]) &&
+            (ibeacon_type[IBEACON_DATA_TYPE_INDEX0] == elem[IBEACON_DATA_INDEX2]) &&
+            (ibeacon_type[IBEACON_DATA_TYPE_INDEX1] == elem[IBEACON_DATA_INDEX3]))
+        {
+            info->format                = BEACON_FORMAT_IBEACON;
+            info->measured_power        = (int8_t)elem[IBEACON_TX_POWER_INDEX];
+            info->measured_power_offset = index + 2 + IBEACON_TX_POWER_INDEX;
+            info->id                    = &elem[IBEACON_DATA_INDEX4];
+            info->id_len                = IBEACON_UUID_MAJOR_MINOR_LEN;
+            return WICED_TRUE;
+        }
+
+        if ((BTM_BLE_ADVERT_TYPE_SERVICE_DATA == adv_data[index + 1]) &&
+            (elem_len > EDDYSTONE_SERVICE_DATA_LENGTH) &&
+            ((uint8_t)(EDDYSTONE_UUID16 & 0xff) == elem[EDDYSTONE_UUID_INDEX0]) &&
+            ((uint8_t)(EDDYSTONE_UUID16 >> 8) == elem[EDDYSTONE_UUID_INDEX1]))
+        {
+            /* elem_len covers the AD type, the UUID and the frame */
+            uint8_t frame_len = elem_len - EDDYSTONE_SERVICE_DATA_LENGTH;
+
+            if (frame_len > 1)
+            {
+                info->measured_power = (int8_t)elem[EDDYSTONE_TX_POWER_OFFSET];
+                info->measured_power_offset = index + 2 + EDDYSTONE_TX_POWER_OFFSET;
+            }
+
+            switch (elem[EDDYSTONE_FRAME_TYPE_OFFSET])
+            {
+            case EDDYSTONE_FRAME_TYPE_UID:
+                info->format = BEACON_FORMAT_EDDYSTONE_UID;
+                if (frame_len >= (2 + EDDYSTONE_UID_ID_LEN))
+                {
+                    info->id     = &elem[EDDYSTONE_TX_POWER_OFFSET + 1];
+                    info->id_len = EDDYSTONE_UID_ID_LEN;
+                }
+                break;
+
+            case EDDYSTONE_FRAME_TYPE_URL:
+                info->format = BEACON_FORMAT_EDDYSTONE_URL;
+                if (frame_len > 2)
+                {
+                    /* URL scheme and encoded URL identify the frame */
+                    info->id     = &elem[EDDYSTONE_TX_POWER_OFFSET + 1];
+                    info->id_len = frame_len - 2;
+                }
+                break;
+
+            case EDDYSTONE_FRAME_TYPE_TLM:
+                /* TLM content changes every frame, the address identifies it */
+                info->format                = BEACON_FORMAT_EDDYSTONE_TLM;
+                info->measured_power        = 0;
+                info->measured_power_offset = 0;
+                break;
+
+            case EDDYSTONE_FRAME_TYPE_EID:
+                info->format = BEACON_FORMAT_EDDYSTONE_EID;
+                if (frame_len >= (2 + EDDYSTONE_EID_LEN))
+                {
+                    info->id     = &elem[EDDYSTONE_TX_POWER_OFFSET + 1];
+                    info->id_len = EDDYSTONE_EID_LEN;
+                }
+                break;
+
+            default:
+                break;
+            }
+            return (BEACON_FORMAT_UNKNOWN != info->format) ? WICED_TRUE : WICED_FALSE;
+        }
+
+        index += elem_len + 1;
+    }
+
+    return WICED_FALSE;
+}
+
+/********************************************************************************
+* Function Name: beacon_adv_data_len
+*********************************************************************************
+* Summary:
+*   This function returns the length of the significant part of a received
+*   advertisement, that is the AD structures before the first zero length
+*   element or the end of the buffer.
+*
+* Parameters:
+*   adv_data:               Received advertisement data
+*   max_len:                Size of the advertisement data buffer
+*
+* Return:
+*   Length of the significant part
+*
+*********************************************************************************/
+uint8_t beacon_adv_data_len(const uint8_t *adv_data, uint8_t max_len)
+{
+    uint8_t index = 0;
+
+    while ((index < max_len) && (0 != adv_data[index]) &&
+           ((index + 1 + adv_data[index]) <= max_len))
+    {
+        index += adv_data[index] + 1;
+    }
+    return index;
+}
+
+/********************************************************************************
+* Function Name: beacon_crc16
+*********************************************************************************
+* Summary:
+*   This function computes the CRC-16/CCITT (polynomial 0x1021, MSB first) of
+*   a buffer. Start with 0xFFFF and pass the result back in to continue over
+*   several buffers.
+*
+* Parameters:
+*   data:                   Data to check
+*   len:                    Length of data
+*   crc:                    CRC of the preceding data, 0xFFFF to start
+*
+* Return:
+*   Updated CRC
+*
+*********************************************************************************/
+uint16_t beacon_crc16(const uint8_t *data, uint32_t len, uint16_t crc)
+{
+    while (0 != len--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (0 != (crc & 0x8000)) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
 /* [] END OF FILE */
@@ -49,6 +49,25 @@
 /******************************************************************************
  *                                Constants
  ******************************************************************************/
+/* Beacon formats linked into the image. Set a format to 0 to strip its
+ * encoder, its registry entry and the instance advertising it. Received
+ * frames of every format are still parsed. */
+#ifndef BEACON_IBEACON_ENABLE
+#define BEACON_IBEACON_ENABLE            (1)
+#endif
+
+#ifndef BEACON_EDDYSTONE_URL_ENABLE
+#define BEACON_EDDYSTONE_URL_ENABLE      (1)
+#endif
+
+#ifndef BEACON_ALTBEACON_ENABLE
+#define BEACON_ALTBEACON_ENABLE          (1)
+#endif
+
+#ifndef BEACON_STATUS_FRAME_ENABLE
+#define BEACON_STATUS_FRAME_ENABLE       (1)
+#endif
+
 /* Type of eddystone frame
    https://github.com/google/eddystone/blob/master/protocol-specification.md */
 #define EDDYSTONE_FRAME_TYPE_UID          (0x00)
@@ -139,9 +158,39 @@
 #define IBEACON_ADV_DATA0                (0)
 #define IBEACON_DATA_INDEX0              (0)
 #define IBEACON_DATA_INDEX1              (1)
+
+/* Offsets used when parsing received beacon frames */
+#define IBEACON_UUID_MAJOR_MINOR_LEN     (LEN_UUID_128 + 4)
+#define EDDYSTONE_FRAME_TYPE_OFFSET      (2)
+#define EDDYSTONE_TX_POWER_OFFSET        (3)
+#define EDDYSTONE_UID_ID_LEN             (EDDYSTONE_UID_NAMESPACE_LEN + \
+                                          EDDYSTONE_UID_INSTANCE_ID_LEN)
+#define EDDYSTONE_EID_LEN                (8)
 /******************************************************************************
  *                                Structures
  ******************************************************************************/
+/* Beacon formats recognized by the scanner side parser */
+typedef enum
+{
+    BEACON_FORMAT_UNKNOWN = 0,
+    BEACON_FORMAT_IBEACON,
+    BEACON_FORMAT_EDDYSTONE_UID,
+    BEACON_FORMAT_EDDYSTONE_URL,
+    BEACON_FORMAT_EDDYSTONE_TLM,
+    BEACON_FORMAT_EDDYSTONE_EID,
+}beacon_format_t;
+
+/* Result of parsing a received advertisement */
+typedef struct
+{
+    beacon_format_t format;                         /* Detected beacon format */
+    int8_t measured_power;                          /* iBeacon 1 m / Eddystone 0 m power */
+    uint8_t measured_power_offset;                  /* Offset of measured_power in the
+                                                       advertisement, 0 if none */
+    const uint8_t *id;                              /* Bytes identifying the frame */
+    uint8_t id_len;                                 /* Length of the identity bytes */
+}beacon_frame_info_t;
+
 /* Structure to hold advertisement element data */
 typedef struct
 {
@@ -170,29 +219,40 @@ typedef struct __attribute__((packed, aligned(1)))
  *                              FUNCTION DECLARATIONS
  ***************************************************************************/
 
+#if BEACON_EDDYSTONE_URL_ENABLE
 void eddystone_set_data_for_url  (eddystone_url_t url_data,
                                   uint8_t adv_data[BEACON_ADV_DATA_MAX],
                                   uint8_t *adv_len);
 
 void eddystone_set_data_common   (beacon_ble_advert_elem_t *eddystone_adv_elem,
                                   uint8_t frame_type, uint8_t frame_len);
+#endif
 
 void beacon_set_adv_data         (beacon_ble_advert_elem_t *beacon_adv_elem,
                                   uint8_t num_elem,
                                   uint8_t adv_data[BEACON_ADV_DATA_MAX],
                                   uint8_t *adv_len);
 
+#if BEACON_IBEACON_ENABLE
 void ibeacon_set_adv_data        (uint8_t ibeacon_uuid[LEN_UUID_128],
                                    uint16_t ibeacon_major_number,
                                    uint16_t ibeacon_minor_number,
                                    uint8_t tx_power_lcl,
                                    uint8_t adv_data[BEACON_ADV_DATA_MAX],
                                    uint8_t *adv_len);
+#endif
 void beacon_bt_set_adv_data     (beacon_ble_advert_elem_t *beacon_adv_elem,
                                  uint8_t num_elem,
                                  uint8_t adv_data[BEACON_ADV_DATA_MAX],
                                  uint8_t *adv_len);
 
+wiced_bool_t beacon_parse_adv_data (const uint8_t *adv_data, uint8_t adv_len,
+                                    beacon_frame_info_t *info);
+
+uint8_t      beacon_adv_data_len   (const uint8_t *adv_data, uint8_t max_len);
+
+uint16_t     beacon_crc16          (const uint8_t *data, uint32_t len, uint16_t crc);
+
 
 #endif      /* __BEACON_UTILS_H__ */
 
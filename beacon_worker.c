@@ -0,0 +1,318 @@
+/******************************************************************************
+* File Name: beacon_worker.c
+*
+* Description: This is the source code for the background worker. All jobs
+* run in one low priority task. Each job may run up to its slack after its
+* deadline, so the worker sleeps until the latest time that still serves every
+* job and runs all the jobs due by then in the same wakeup. With tickless idle
+* this keeps the device in deep sleep between wakeups.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+*        Header Files
+*******************************************************************************/
+#include <FreeRTOS.h>
+#include <task.h>
+#include "beacon_worker.h"
+#include "beacon_stats.h"
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Registered job */
+typedef struct
+{
+    beacon_worker_job_t *p_job;                 /* Job function */
+    uint32_t slack_ms;                          /* Allowed delay after the deadline */
+    uint32_t deadline_ms;                       /* Requested run time */
+    uint8_t scheduled;                          /* deadline_ms is valid */
+}beacon_worker_entry_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+static beacon_worker_entry_t worker_jobs[BEACON_WORKER_MAX_JOBS];
+static uint8_t               worker_num_jobs;
+static beacon_worker_stats_t worker_stats;
+
+static TaskHandle_t         worker_task_handle;
+static StaticTask_t         worker_task_tcb;
+static StackType_t          worker_task_stack[BEACON_WORKER_TASK_STACK_SIZE];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/********************************************************************************
+* Function Name: beacon_worker_run
+*********************************************************************************
+* Summary:
+*   Runs the jobs whose deadline is reached, or every job when kicked
+*
+*********************************************************************************/
+static void beacon_worker_run(uint32_t now_ms, uint8_t kicked)
+{
+    beacon_worker_entry_t *p_entry;
+    uint32_t job_wait_ms;
+    uint8_t due;
+
+    for (uint8_t i = 0; i < worker_num_jobs; i++)
+    {
+        p_entry = &worker_jobs[i];
+        due = p_entry->scheduled && ((int32_t)(p_entry->deadline_ms - now_ms) <= 0);
+
+        if (!due && !kicked)
+        {
+            continue;
+        }
+        if (due)
+        {
+            worker_stats.job_deadlines++;
+        }
+
+        job_wait_ms = p_entry->p_job(now_ms);
+        p_entry->scheduled   = (BEACON_WORKER_IDLE != job_wait_ms);
+        p_entry->deadline_ms = now_ms + job_wait_ms;
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_worker_next_wait
+*********************************************************************************
+* Summary:
+*   Returns the time until the earliest deadline plus slack of all jobs. Every
+*   job due by then runs in that wakeup.
+*
+*********************************************************************************/
+static uint32_t beacon_worker_next_wait(uint32_t now_ms)
+{
+    uint32_t wait_ms = BEACON_WORKER_IDLE;
+    int32_t latest_ms;
+
+    for (uint8_t i = 0; i < worker_num_jobs; i++)
+    {
+        if (!worker_jobs[i].scheduled)
+        {
+            continue;
+        }
+
+        latest_ms = (int32_t)(worker_jobs[i].deadline_ms + worker_jobs[i].slack_ms - now_ms);
+        if (latest_ms < 0)
+        {
+            latest_ms = 0;
+        }
+        if ((uint32_t)latest_ms < wait_ms)
+        {
+            wait_ms = (uint32_t)latest_ms;
+        }
+    }
+    return wait_ms;
+}
+
+/********************************************************************************
+* Function Name: beacon_worker_task
+*********************************************************************************
+* Summary:
+*   Runs the due jobs and sleeps until the next coalesced wakeup
+*
+*********************************************************************************/
+static void beacon_worker_task(void *arg)
+{
+    uint32_t wait_ms;
+    uint8_t kicked = 1;
+
+    (void)arg;
+
+    worker_stats.start_ms = beacon_stats_now_ms();
+
+    for (;;)
+    {
+        beacon_worker_run(beacon_stats_now_ms(), kicked);
+
+        wait_ms = beacon_worker_next_wait(beacon_stats_now_ms());
+
+        kicked = (0 != ulTaskNotifyTake(pdTRUE, (BEACON_WORKER_IDLE == wait_ms) ?
+                                                portMAX_DELAY : pdMS_TO_TICKS(wait_ms)));
+        if (kicked)
+        {
+            worker_stats.kicks++;
+        }
+        else
+        {
+            worker_stats.wakeups++;
+        }
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_worker_init
+*********************************************************************************
+* Summary:
+*   Creates the worker task. Jobs registered before the scheduler starts run
+*   as soon as it does.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_worker_init(void)
+{
+    if (NULL == worker_task_handle)
+    {
+        worker_task_handle = xTaskCreateStatic(beacon_worker_task, "Worker",
+                                               BEACON_WORKER_TASK_STACK_SIZE, NULL,
+                                               BEACON_WORKER_TASK_PRIORITY,
+                                               worker_task_stack, &worker_task_tcb);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_worker_register
+*********************************************************************************
+* Summary:
+*   Adds a job to the worker. The job runs right away.
+*
+* Parameters:
+*   p_job:                  Job function
+*   slack_ms:               Delay after each deadline the job tolerates
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_worker_register(beacon_worker_job_t *p_job, uint32_t slack_ms)
+{
+    configASSERT(worker_num_jobs < BEACON_WORKER_MAX_JOBS);
+
+    worker_jobs[worker_num_jobs].p_job     = p_job;
+    worker_jobs[worker_num_jobs].slack_ms  = slack_ms;
+    worker_jobs[worker_num_jobs].scheduled = 0;
+    worker_num_jobs++;
+    beacon_worker_kick();
+}
+
+/********************************************************************************
+* Function Name: beacon_worker_kick
+*********************************************************************************
+* Summary:
+*   Wakes the worker so that all jobs run again
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_worker_kick(void)
+{
+    if (NULL != worker_task_handle)
+    {
+        xTaskNotifyGive(worker_task_handle);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_worker_kick_from_isr
+*********************************************************************************
+* Summary:
+*   Interrupt safe variant of beacon_worker_kick
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*********************************************************************************/
+void beacon_worker_kick_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (NULL != worker_task_handle)
+    {
+        vTaskNotifyGiveFromISR(worker_task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+/********************************************************************************
+* Function Name: beacon_worker_get_stats
+*********************************************************************************
+* Summary:
+*   Returns the worker counters. The wakeups with independent timers per job
+*   would have been job_deadlines.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   const beacon_worker_stats_t *: Counters
+*
+*********************************************************************************/
+const beacon_worker_stats_t *beacon_worker_get_stats(void)
+{
+    return &worker_stats;
+}
+
+/********************************************************************************
+* Function Name: beacon_worker_per_hour
+*********************************************************************************
+* Summary:
+*   Converts a worker counter into a rate per hour since the worker started
+*
+* Parameters:
+*   count:                  Counter value, e.g. wakeups
+*   now_ms:                 Current time in milliseconds
+*
+* Return:
+*   uint32_t: Events per hour, 0 before the first millisecond
+*
+*********************************************************************************/
+uint32_t beacon_worker_per_hour(uint32_t count, uint32_t now_ms)
+{
+    uint32_t elapsed_ms = now_ms - worker_stats.start_ms;
+
+    if (0 == elapsed_ms)
+    {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)count * 3600000ULL) / elapsed_ms);
+}
+
+/* [] END OF FILE */
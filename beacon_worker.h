@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name: beacon_worker.h
+*
+* Description: This file contains the definitions for the background worker.
+* The worker runs precomputation and periodic jobs at low priority, and
+* coalesces their deadlines into as few wakeups as possible.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+
+#ifndef __BEACON_WORKER_H__
+#define __BEACON_WORKER_H__
+
+#include <stdint.h>
+
+/******************************************************************************
+ *                                Constants
+ ******************************************************************************/
+/* Maximum number of registered jobs */
+#define BEACON_WORKER_MAX_JOBS           (8)
+
+/* Returned by a job that has nothing to do until it is kicked again */
+#define BEACON_WORKER_IDLE               (0xFFFFFFFFUL)
+
+/* Worker task configuration, below every Bluetooth related task */
+#define BEACON_WORKER_TASK_STACK_SIZE    (512)
+#define BEACON_WORKER_TASK_PRIORITY      (1)
+
+/******************************************************************************
+ *                                Structures
+ ******************************************************************************/
+/* Job run by the worker. Returns the number of milliseconds after which the
+ * job wants to run again, or BEACON_WORKER_IDLE. The job may run up to its
+ * slack later, so that it shares a wakeup with other jobs. */
+typedef uint32_t (beacon_worker_job_t)(uint32_t now_ms);
+
+/* Worker counters */
+typedef struct
+{
+    uint32_t wakeups;                           /* Timed wakeups of the worker */
+    uint32_t kicks;                             /* Wakeups by beacon_worker_kick */
+    uint32_t job_deadlines;                     /* Job runs due to their deadline, the
+                                                 * wakeups of independent timers */
+    uint32_t start_ms;                          /* Time the counters started */
+}beacon_worker_stats_t;
+
+/****************************************************************************
+ *                              FUNCTION DECLARATIONS
+ ***************************************************************************/
+void                         beacon_worker_init      (void);
+
+void                         beacon_worker_register  (beacon_worker_job_t *p_job, uint32_t slack_ms);
+
+void                         beacon_worker_kick      (void);
+
+void                         beacon_worker_kick_from_isr (void);
+
+const beacon_worker_stats_t *beacon_worker_get_stats (void);
+
+uint32_t                     beacon_worker_per_hour  (uint32_t count, uint32_t now_ms);
+
+#endif      /* __BEACON_WORKER_H__ */
+
+
+/* [] END OF FILE */
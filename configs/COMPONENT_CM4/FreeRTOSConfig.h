@@ -235,4 +235,10 @@ extern void vApplicationSleep( uint32_t xExpectedIdleTime );
  */
 #define configUSE_NEWLIB_REENTRANT              1
 
+/* Task switch hook of the beacon trace recorder, see beacon_trace.h */
+#if defined(BEACON_TRACE_ENABLE) && (BEACON_TRACE_ENABLE)
+extern void beacon_trace_task_switched_in( uint32_t task_number );
+#define traceTASK_SWITCHED_IN()                 beacon_trace_task_switched_in( pxCurrentTCB->uxTCBNumber )
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
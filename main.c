@@ -56,6 +56,31 @@
 #include "stdio.h"
 #include "beacon_utils.h"
 #include "beacon_utils.h"
+#include "beacon_bench.h"
+#include "beacon_campaign.h"
+#include "beacon_ccm.h"
+#include "beacon_chmap.h"
+#include "beacon_console.h"
+#include "beacon_energy.h"
+#include "beacon_format.h"
+#include "beacon_health.h"
+#include "beacon_ipc.h"
+#include "beacon_manager.h"
+#include "beacon_observer.h"
+#include "beacon_power.h"
+#include "beacon_prov.h"
+#include "beacon_relay.h"
+#include "beacon_rolling.h"
+#include "beacon_rpa.h"
+#include "beacon_scanreq.h"
+#include "beacon_sim.h"
+#include "beacon_slot.h"
+#include "beacon_stats.h"
+#include "beacon_store.h"
+#include "beacon_telemetry.h"
+#include "beacon_timer.h"
+#include "beacon_trace.h"
+#include "beacon_worker.h"
 #include "wiced_bt_ble.h"
 
 
@@ -65,6 +90,21 @@
 /* Allocate the multi-advertising instance numbers */
 #define BEACON_EDDYSTONE_URL        (1)
 #define BEACON_IBEACON_URL          (2)
+/* Spare instance used to relay remote beacons */
+#define BEACON_RELAY_INSTANCE       (3)
+/* Spare instance used to advertise sensor telemetry */
+#define BEACON_TELEMETRY_INSTANCE   (4)
+/* Telemetry channels, temperature and humidity in hundredths */
+#define BEACON_TELEMETRY_CHANNELS   (2)
+
+#if BEACON_CCM_ENABLE && BEACON_TELEMETRY_ENABLE
+#error "Encrypted frames and telemetry share BEACON_TELEMETRY_INSTANCE, enable one of them"
+#endif
+
+/* Target ranges in centimeters, each instance advertises with the lowest
+ * Tx power that reaches its range */
+#define BEACON_EDDYSTONE_URL_RANGE_CM   (1000)
+#define BEACON_IBEACON_RANGE_CM         (500)
 
 /* This one byte will insert .com at the end of a URL in a URL frame. */
 #define DOT_COM (0x07)
@@ -76,6 +116,14 @@
 #define BTM_BLE_ADVERT_INTERVAL_MIN     0x0020
 #define BTM_BLE_ADVERT_INTERVAL_MAX     0x4000
 #define BLE_ADDR_PUBLIC                 0x00
+
+/* A refused command halts the application, unless the health monitor
+ * applies it again */
+#if BEACON_HEALTH_ENABLE
+#define BLE_APP_CMD_FAILED()
+#else
+#define BLE_APP_CMD_FAILED()            CY_ASSERT(0)
+#endif
 /*******************************************************************************
 *        Variable Definitions
 *******************************************************************************/
@@ -96,6 +144,73 @@ wiced_bt_ble_multi_adv_params_t adv_parameters =
 /* User defined UUID for iBeacon */
 #define UUID_IBEACON     0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
 
+#if BEACON_RELAY_ENABLE
+/* Relay remote Eddystone-URL beacons at most once per second, and stop
+ * relaying when the source has not been heard for 10 seconds */
+static const beacon_relay_rule_t relay_rules[] =
+{
+    {
+        .format          = BEACON_FORMAT_EDDYSTONE_URL,
+        .id_prefix       = NULL,
+        .id_prefix_len   = 0,
+        .instance        = BEACON_RELAY_INSTANCE,
+        .min_interval_ms = 1000,
+        .ttl_ms          = 10000
+    },
+};
+#endif
+
+#if BEACON_BENCH_ENABLE
+/* Instances configured by ble_app_set_advertisement_data */
+static const uint8_t bench_instances[] = { BEACON_EDDYSTONE_URL, BEACON_IBEACON_URL };
+#endif
+
+#if BEACON_RPA_ENABLE
+/* Identity resolving keys, one per advertising identity. Replace these
+ * sample keys with device specific keys shared with the resolving peers. */
+static const uint8_t url_irk[BEACON_RPA_IRK_LEN] =
+{
+    0x3e, 0x71, 0x0a, 0x5c, 0x92, 0x4d, 0xb8, 0x06, 0xe1, 0x27, 0x5f, 0xc4, 0x18, 0x9b, 0x60, 0xd3
+};
+static const uint8_t ibeacon_irk[BEACON_RPA_IRK_LEN] =
+{
+    0xa9, 0x14, 0x6c, 0xf2, 0x33, 0x8e, 0x57, 0xb0, 0x0d, 0xc6, 0x79, 0x21, 0xea, 0x45, 0x9f, 0x12
+};
+#endif
+
+#if BEACON_ROLLING_ENABLE
+/* Device key of the rolling iBeacon identity. Replace this sample key with a
+ * device specific key shared with the venue resolvers. */
+static const uint8_t rolling_key[BEACON_ROLLING_KEY_LEN] =
+{
+    0x5b, 0xe2, 0x17, 0x8c, 0x40, 0xd9, 0x6a, 0x33, 0xf1, 0x0e, 0x95, 0x7c, 0x28, 0xb4, 0x61, 0xcf
+};
+
+/* Number of the provisioned key that replaces rolling_key */
+#define ROLLING_KEY_ID   (1)
+/* Store counter holding the first epoch not yet reserved */
+#define ROLLING_EPOCH_COUNTER (0)
+#endif
+
+#if BEACON_CCM_ENABLE
+/* Key of the encrypted sensor frames. Replace this sample key with a device
+ * specific key shared with the receivers. */
+static const uint8_t ccm_key[BEACON_CCM_KEY_LEN] =
+{
+    0xc4, 0x27, 0x9e, 0x50, 0x1b, 0xf8, 0x63, 0xad, 0x36, 0x0f, 0xd2, 0x85, 0x7a, 0xe9, 0x14, 0x4b
+};
+
+/* Identifier of ccm_key in the frames */
+#define CCM_KEY_ID       (1)
+/* Store counter holding the first frame counter not yet reserved */
+#define CCM_FRAME_COUNTER (1)
+/* Plaintext of a frame, temperature and humidity, little endian */
+#define CCM_PLAIN_LEN    (2 * BEACON_TELEMETRY_CHANNELS)
+#endif
+
+/* Set by the first BTM_ENABLED_EVT, later ones follow a stack restart */
+static wiced_bool_t ble_app_started;
+
 /* This enables RTOS aware debugging. */
 volatile int uxTopUsedPriority;
 
@@ -103,7 +218,26 @@ volatile int uxTopUsedPriority;
 *        Function Prototypes
 *******************************************************************************/
 static void             ble_app_set_advertisement_data (void);
+static void             ble_app_enabled                (const beacon_manager_evt_t *p_evt);
+static void             ble_app_multi_adv_response     (const beacon_manager_evt_t *p_evt);
 static void             ble_address_print              (wiced_bt_device_address_t bdadr);
+#if BEACON_OBSERVER_ENABLE
+static void             ble_app_observer_report        (const beacon_cache_record_t *p_record);
+#endif
+#if BEACON_TELEMETRY_ENABLE || BEACON_CCM_ENABLE
+static void             ble_app_read_sensors           (int16_t *values);
+#endif
+#if BEACON_ROLLING_ENABLE
+static wiced_bool_t     ble_app_reserve_epochs         (uint32_t limit);
+#endif
+#if BEACON_CCM_ENABLE
+static void             ble_app_read_frame             (uint8_t *plain, uint8_t plain_len);
+static wiced_bool_t     ble_app_reserve_frames         (uint32_t limit);
+#endif
+#if BEACON_HEALTH_ENABLE
+static void             ble_app_health_report          (uint8_t instance,
+                                                        const beacon_health_stats_t *p_stats);
+#endif
 
 /* Callback function for Bluetooth stack management type events */
 static wiced_bt_dev_status_t  app_bt_management_callback (wiced_bt_management_evt_t event,
@@ -139,6 +273,64 @@ int main()
 
     cybt_platform_config_init(&cybsp_bt_platform_cfg);
 
+    /* Cycle counter for latency statistics and the advertising slot table */
+    beacon_stats_init();
+    beacon_slot_init();
+
+#if BEACON_SCANREQ_ENABLE
+    /* Scan request counters of scannable instances, see the scan command */
+    beacon_scanreq_init();
+#endif
+
+#if BEACON_PROV_ENABLE || BEACON_ROLLING_ENABLE || BEACON_CCM_ENABLE
+    /* Slot configurations and keys written by the prov command, and the
+     * counters that must not repeat after a reset */
+    beacon_store_init();
+#endif
+
+    /* Background task for precomputation such as the next private address */
+    beacon_worker_init();
+
+#if BEACON_ENERGY_ENABLE
+    /* Charge estimate from the slot states and worker wakeups, see energy */
+    beacon_energy_start();
+#endif
+
+    /* Stack events are handled in the manager task, not in the stack callback */
+    beacon_manager_init();
+    beacon_manager_register(BEACON_MANAGER_EVT_ENABLED, ble_app_enabled);
+    beacon_manager_register(BEACON_MANAGER_EVT_MULTI_ADV_RESP, ble_app_multi_adv_response);
+
+    /* Deadlines such as relay TTLs and address rotations, run by the manager */
+    beacon_timer_init();
+
+#if BEACON_HEALTH_ENABLE
+    /* Failed commands and stack restarts are retried, see the health command */
+    beacon_health_init(ble_app_health_report);
+#endif
+
+#if BEACON_CONSOLE_ENABLE
+    /* Commands typed on the debug UART, see help */
+    beacon_console_init();
+#endif
+
+#if BEACON_BENCH_ENABLE
+    /* Lifecycle scenarios on the simulated controller, see the bench command */
+    beacon_bench_init(ble_app_set_advertisement_data, bench_instances,
+                      sizeof(bench_instances) / sizeof(bench_instances[0]));
+#endif
+
+#if BEACON_IPC_ENABLE
+    /* Accept ready payloads from the other core, before it is started */
+    beacon_ipc_start();
+#endif
+
+#if BEACON_RPA_ENABLE
+    /* Give each advertising identity its own rotating private address */
+    beacon_rpa_enable(beacon_slot_get(BEACON_EDDYSTONE_URL), url_irk, BEACON_RPA_PERIOD_MS);
+    beacon_rpa_enable(beacon_slot_get(BEACON_IBEACON_URL), ibeacon_irk, BEACON_RPA_PERIOD_MS);
+#endif
+
     printf("***********AnyCloud Example***********\n");
     printf("****Multi Beacon Application Start****\n");
     printf("**************************************\n\n");
@@ -168,7 +360,8 @@ int main()
 *********************************************************************************
 * Summary:
 *   This is a Bluetooth stack event handler function to receive management events from
-*   the BLE stack and process as per the application.
+*   the BLE stack. The events used by the application are copied to the beacon
+*   manager, so the stack is never held up by encoding, commands or printing.
 *
 * Parameters:
 *   wiced_bt_management_evt_t event             : BLE event code of one byte length
@@ -182,72 +375,217 @@ wiced_result_t app_bt_management_callback(wiced_bt_management_evt_t event,
                                          wiced_bt_management_evt_data_t *p_event_data)
 {
     wiced_result_t status = WICED_BT_SUCCESS;
-    wiced_bt_device_address_t bda = { 0 };
-    wiced_bt_multi_adv_opcodes_t multi_adv_resp_opcode;
-    uint8_t multi_adv_resp_status = 0;
+    beacon_manager_evt_t evt;
+
+    evt.rx_cycles = beacon_stats_cycles();
+    evt.type      = BEACON_MANAGER_EVT_MAX;
+    BEACON_TRACE(BEACON_TRACE_CBACK_ENTER, event, 0);
 
     switch (event)
     {
     case BTM_ENABLED_EVT:
-        if( WICED_BT_SUCCESS == p_event_data->enabled.status )
-        {
-            printf("Bluetooth Enabled\r\n");
+        evt.type = BEACON_MANAGER_EVT_ENABLED;
+        evt.data.enabled_status = p_event_data->enabled.status;
+        /* Control events have their own queue and are never dropped */
+        (void)beacon_manager_post(&evt);
+        break;
 
-            wiced_bt_dev_read_local_addr(bda);
-                    printf("Local Bluetooth Address: ");
-                    ble_address_print(bda);
+    case BTM_MULTI_ADVERT_RESP_EVENT:
+        evt.type = BEACON_MANAGER_EVT_MULTI_ADV_RESP;
+        evt.data.multi_adv.opcode = p_event_data->ble_multi_adv_response_event.opcode;
+        evt.data.multi_adv.status = p_event_data->ble_multi_adv_response_event.status;
+        (void)beacon_manager_post(&evt);
+        break;
 
-            /* Create the packet and begin advertising */
-            ble_app_set_advertisement_data();
-        }
+    default:
         break;
+    }
 
-    case BTM_MULTI_ADVERT_RESP_EVENT:
+    beacon_manager_cback_done(evt.rx_cycles);
+    BEACON_TRACE(BEACON_TRACE_CBACK_EXIT, event, evt.type);
 
-        /* Multi ADV Response */
-        multi_adv_resp_opcode = p_event_data->ble_multi_adv_response_event.opcode;
-        multi_adv_resp_status = p_event_data->ble_multi_adv_response_event.status;
+    return status;
+}
 
-        if (SET_ADVT_PARAM_MULTI == multi_adv_resp_opcode)
+/********************************************************************************
+* Function Name: ble_app_enabled
+*********************************************************************************
+* Summary:
+*   Handles BTM_ENABLED_EVT in the beacon manager task
+*
+* Parameters:
+*   const beacon_manager_evt_t *p_evt           : Event copied by the stack callback
+*
+* Return:
+*  void
+*
+*********************************************************************************/
+static void ble_app_enabled(const beacon_manager_evt_t *p_evt)
+{
+    wiced_bt_device_address_t bda = { 0 };
+
+    if( WICED_BT_SUCCESS == p_evt->data.enabled_status )
+    {
+        if (ble_app_started)
         {
-            if(WICED_SUCCESS == multi_adv_resp_status)
-            {
-                printf("Multi ADV Set Param Event Status: SUCCESS\n");
-            }
-            else
-            {
-                printf("Multi ADV Set Param Event Status: FAILED\n");
-            }
+            /* The controller lost its instances, configure them again */
+            printf("Bluetooth Restarted\r\n");
+#if BEACON_HEALTH_ENABLE
+            beacon_health_restart();
+#else
+            /* Each instance comes back as its owner left it, so the stored,
+             * rolling, campaign, relay and sensor payloads stay on air */
+            printf("%lu instances restarted\r\n", (unsigned long)beacon_slot_restart());
+#endif
+            return;
         }
-        else if (SET_ADVT_DATA_MULTI == multi_adv_resp_opcode)
+        ble_app_started = WICED_TRUE;
+
+        printf("Bluetooth Enabled\r\n");
+
+        wiced_bt_dev_read_local_addr(bda);
+                printf("Local Bluetooth Address: ");
+                ble_address_print(bda);
+
+        /* Create the packet and begin advertising */
+        ble_app_set_advertisement_data();
+
+#if BEACON_PROV_ENABLE
+        /* Provisioned instances replace the built in configuration */
+        beacon_store_apply();
+#endif
+
+#if BEACON_ROLLING_ENABLE
         {
-            if(WICED_SUCCESS == multi_adv_resp_status)
+            const uint8_t *p_rolling_key = rolling_key;
+
+#if BEACON_PROV_ENABLE
+            if (NULL != beacon_store_get_key(ROLLING_KEY_ID))
             {
-                printf("Multi ADV Set Data Event Status: SUCCESS\n");
+                p_rolling_key = beacon_store_get_key(ROLLING_KEY_ID);
             }
-            else
+#endif
+            /* Derive major and minor per epoch. The device has no clock, so
+             * the epochs continue from the limit kept in flash and an
+             * identity never comes back after a reset. With a clock, pass
+             * its time divided by the epoch length and no reserve callback,
+             * the resolvers then follow the same clock. */
+            if (WICED_BT_PENDING != beacon_rolling_start(beacon_slot_get(BEACON_IBEACON_URL),
+                                                         p_rolling_key,
+                                                         beacon_store_get_counter(ROLLING_EPOCH_COUNTER),
+                                                         BEACON_ROLLING_EPOCH_MS,
+                                                         ble_app_reserve_epochs))
             {
-                printf("Multi ADV Set Data Event Status: FAILED\n");
+                printf("Rolling iBeacon identity start failed\n");
             }
         }
-        else if (SET_ADVT_ENABLE_MULTI == multi_adv_resp_opcode)
+#endif
+
+#if BEACON_CAMPAIGN_ENABLE && BEACON_CAMPAIGN_START_S
+        /* Scheduled payloads, otherwise they start with the campaign command */
+        if (WICED_BT_BADARG == beacon_campaign_set_time(&beacon_campaign_table,
+                                                        BEACON_CAMPAIGN_START_S))
         {
-            if(WICED_SUCCESS == multi_adv_resp_status)
-            {
-                printf("Multi ADV Start Event Status: SUCCESS\n");
-            }
-            else
-            {
-                printf("Multi ADV Start Event Status: FAILED\n");
-            }
+            printf("Campaign table not valid\n");
         }
-        break;
+#endif
 
-    default:
-        break;
+#if BEACON_CHMAP_ENABLE
+        /* Drop congested primary channels, keeping BEACON_CHMAP_MIN_CHANNELS */
+        beacon_chmap_start();
+#endif
+
+#if BEACON_RELAY_ENABLE
+        beacon_relay_init(relay_rules, sizeof(relay_rules) / sizeof(relay_rules[0]),
+                          &adv_parameters);
+#endif
+
+#if BEACON_OBSERVER_ENABLE
+        /* Scan for beacons around, reports are aggregated per period */
+        if (WICED_BT_SUCCESS != beacon_observer_start(ble_app_observer_report))
+        {
+            printf("Beacon observer start failed\n");
+        }
+#endif
+
+#if BEACON_TELEMETRY_ENABLE
+        /* Sensor history, several samples per advertisement */
+        beacon_telemetry_start(beacon_slot_get(BEACON_TELEMETRY_INSTANCE),
+                               BEACON_TELEMETRY_CHANNELS, ble_app_read_sensors,
+                               &adv_parameters);
+#endif
+
+#if BEACON_CCM_ENABLE
+        /* Encrypted sensor frames. The nonce holds the frame counter, which
+         * continues from the limit kept in flash so no nonce repeats under
+         * the key after a reset. */
+        if (WICED_BT_SUCCESS != beacon_ccm_start(beacon_slot_get(BEACON_TELEMETRY_INSTANCE),
+                                                 CCM_KEY_ID, ccm_key,
+                                                 beacon_store_get_counter(CCM_FRAME_COUNTER),
+                                                 CCM_PLAIN_LEN, ble_app_read_frame,
+                                                 ble_app_reserve_frames, &adv_parameters))
+        {
+            printf("Encrypted frames start failed\n");
+        }
+#endif
     }
+}
 
-    return status;
+/********************************************************************************
+* Function Name: ble_app_multi_adv_response
+*********************************************************************************
+* Summary:
+*   Handles BTM_MULTI_ADVERT_RESP_EVENT in the beacon manager task
+*
+* Parameters:
+*   const beacon_manager_evt_t *p_evt           : Event copied by the stack callback
+*
+* Return:
+*  void
+*
+*********************************************************************************/
+static void ble_app_multi_adv_response(const beacon_manager_evt_t *p_evt)
+{
+    /* Multi ADV Response */
+    wiced_bt_multi_adv_opcodes_t multi_adv_resp_opcode = p_evt->data.multi_adv.opcode;
+    uint8_t multi_adv_resp_status = p_evt->data.multi_adv.status;
+
+    /* Match the response with the instance the command was issued on */
+    beacon_slot_on_response(multi_adv_resp_opcode, multi_adv_resp_status);
+
+    if (SET_ADVT_PARAM_MULTI == multi_adv_resp_opcode)
+    {
+        if(WICED_SUCCESS == multi_adv_resp_status)
+        {
+            printf("Multi ADV Set Param Event Status: SUCCESS\n");
+        }
+        else
+        {
+            printf("Multi ADV Set Param Event Status: FAILED\n");
+        }
+    }
+    else if (SET_ADVT_DATA_MULTI == multi_adv_resp_opcode)
+    {
+        if(WICED_SUCCESS == multi_adv_resp_status)
+        {
+            printf("Multi ADV Set Data Event Status: SUCCESS\n");
+        }
+        else
+        {
+            printf("Multi ADV Set Data Event Status: FAILED\n");
+        }
+    }
+    else if (SET_ADVT_ENABLE_MULTI == multi_adv_resp_opcode)
+    {
+        if(WICED_SUCCESS == multi_adv_resp_status)
+        {
+            printf("Multi ADV Start Event Status: SUCCESS\n");
+        }
+        else
+        {
+            printf("Multi ADV Start Event Status: FAILED\n");
+        }
+    }
 }
 
 /********************************************************************************
@@ -265,71 +603,266 @@ wiced_result_t app_bt_management_callback(wiced_bt_management_evt_t event,
 *********************************************************************************/
 static void ble_app_set_advertisement_data(void)
 {
+#if BEACON_EDDYSTONE_URL_ENABLE
     uint8_t packet_len;
+    beacon_slot_t *url_slot = beacon_slot_get(BEACON_EDDYSTONE_URL);
+    wiced_bt_ble_multi_adv_params_t url_params = adv_parameters;
 
     /* Eddystone URL advertising packet */
     uint8_t url_packet[BEACON_ADV_DATA_MAX];
 
-    /* Set sample values for iBeacon */
-    uint8_t adv_data_ibeacon[BEACON_ADV_DATA_MAX];
-    uint8_t adv_len_ibeacon = 0;
-    uint8_t ibeacon_uuid[LEN_UUID_128] = { UUID_IBEACON };
-
     /* Eddystone URL data */
-    eddystone_url_t url_data = {adv_parameters.adv_tx_power, EDDYSTONE_URL_SCHEME_0,
+    eddystone_url_t url_data = {0, EDDYSTONE_URL_SCHEME_0,
                                {'i', 'n', 'f', 'i', 'n', 'e', 'o', 'n', DOT_COM, 0x00}};
+#endif
 
-    /* Set up a URL packet with max power, and implicit "http://www." prefix */
+#if BEACON_IBEACON_ENABLE
+    beacon_slot_t *ibeacon_slot = beacon_slot_get(BEACON_IBEACON_URL);
+    wiced_bt_ble_multi_adv_params_t ibeacon_params = adv_parameters;
+
+    /* Sample values for iBeacon, in the order of the fields of its format */
+    static const uint8_t ibeacon_uuid[LEN_UUID_128] = { UUID_IBEACON };
+    beacon_format_value_t ibeacon_values[] =
+    {
+        { .p_bytes = ibeacon_uuid },
+        { .num = IBEACON_MAJOR_NUMER },
+        { .num = IBEACON_MINOR_NUMER },
+        { .num = 0 },
+    };
+#endif
+
+#if BEACON_EDDYSTONE_URL_ENABLE
+    /* Own address of the instance, the private address if RPA is enabled */
+    beacon_rpa_fill(url_slot, &url_params);
+
+    /* Lowest Tx power reaching the target range, and its calibrated power at 0 m */
+    beacon_power_set_range(url_slot, BEACON_EDDYSTONE_URL_RANGE_CM);
+    url_params.adv_tx_power = beacon_power_select(BEACON_EDDYSTONE_URL_RANGE_CM);
+    url_data.tx_power = (uint8_t)beacon_power_measured(url_params.adv_tx_power,
+                                                       BEACON_FORMAT_EDDYSTONE_URL);
+
+    /* Set up a URL packet with implicit "http://www." prefix */
     eddystone_set_data_for_url(url_data, url_packet, &packet_len);
 
     /* The multi ADV APIs will return pending status now and will give the success/failure
      * status in the BTM_MULTI_ADVERT_RESP_EVENT callback event
      */
-    if(WICED_BT_PENDING != wiced_set_multi_advertisement_data(url_packet, packet_len, BEACON_EDDYSTONE_URL))
+    if(WICED_BT_PENDING != beacon_slot_set_data(url_slot, url_packet, packet_len))
     {
         printf("Set data for URL ADV failed\n");
-        CY_ASSERT(0);
+        BLE_APP_CMD_FAILED();
     }
 
-    if(WICED_BT_PENDING != wiced_set_multi_advertisement_params(BEACON_EDDYSTONE_URL, &adv_parameters))
+    if(WICED_BT_PENDING != beacon_slot_set_params(url_slot, &url_params))
     {
         printf("Set params for URL ADV failed\n");
-        CY_ASSERT(0);
+        BLE_APP_CMD_FAILED();
     }
 
-    if(WICED_BT_PENDING != wiced_start_multi_advertisements(MULTI_ADVERT_START, BEACON_EDDYSTONE_URL))
+    if(WICED_BT_PENDING != beacon_slot_start(url_slot, WICED_TRUE))
     {
         printf("Start ADV for URL ADV failed\n");
-        CY_ASSERT(0);
+        BLE_APP_CMD_FAILED();
     }
+#endif
 
-    /* Set up a IBEACON packet  */
+#if BEACON_IBEACON_ENABLE
+    beacon_rpa_fill(ibeacon_slot, &ibeacon_params);
 
-   ibeacon_set_adv_data(ibeacon_uuid, IBEACON_MAJOR_NUMER, IBEACON_MINOR_NUMER, TX_POWER_LEVEL,
-                adv_data_ibeacon, &adv_len_ibeacon);
+    /* Lowest Tx power reaching the target range */
+    beacon_power_set_range(ibeacon_slot, BEACON_IBEACON_RANGE_CM);
+    ibeacon_params.adv_tx_power = beacon_power_select(BEACON_IBEACON_RANGE_CM);
 
-    if(WICED_BT_PENDING != wiced_set_multi_advertisement_data(adv_data_ibeacon, adv_len_ibeacon, BEACON_IBEACON_URL))
+    /* Params first: the format layer takes the measured power from them */
+    if(WICED_BT_PENDING != beacon_slot_set_params(ibeacon_slot, &ibeacon_params))
     {
-        printf("Set data for iBeacon ADV failed\n");
-        CY_ASSERT(0);
+        printf("Set params for IBEACON ADV failed\n");
+        BLE_APP_CMD_FAILED();
     }
 
-    if(WICED_BT_PENDING != wiced_set_multi_advertisement_params(BEACON_IBEACON_URL, &adv_parameters))
+    /* Set up a IBEACON packet with the calibrated power at 1 m, through the
+     * format registry as the console and the store do */
+    ibeacon_values[3].num = beacon_power_measured(ibeacon_params.adv_tx_power,
+                                                  BEACON_FORMAT_IBEACON);
+    if(WICED_BT_PENDING != beacon_format_bind(ibeacon_slot, beacon_format_find("ibeacon"),
+                                              ibeacon_values))
     {
-        printf("Set params for IBEACON ADV failed\n");
-        CY_ASSERT(0);
+        printf("Set data for iBeacon ADV failed\n");
+        BLE_APP_CMD_FAILED();
     }
 
-    if(WICED_BT_PENDING != wiced_start_multi_advertisements(MULTI_ADVERT_START, BEACON_IBEACON_URL))
+    if(WICED_BT_PENDING != beacon_slot_start(ibeacon_slot, WICED_TRUE))
     {
         printf("Start ADV for IBEACON ADV failed\n");
-        CY_ASSERT(0);
+        BLE_APP_CMD_FAILED();
     }
+#endif
 
     printf("Multiple ADV started.\n"
             "Use a scanner to scan for ADV packets.\n");
 }
 
+#if BEACON_OBSERVER_ENABLE
+/********************************************************************************
+* Function Name: ble_app_observer_report
+*********************************************************************************
+* Summary:
+*   This function receives one aggregated record per observed beacon and period
+*
+* Parameters:
+*   const beacon_cache_record_t *p_record    : Aggregated record
+*
+* Return:
+*  void
+*
+*********************************************************************************/
+static void ble_app_observer_report(const beacon_cache_record_t *p_record)
+{
+#if BEACON_PROXIMITY_ENABLE
+    static const char *const zone_names[] = { "unknown", "immediate", "near", "far" };
+    uint32_t distance_cm = beacon_proximity_distance_cm(&p_record->proximity);
+
+    printf("Beacon format %u seen %lu times, RSSI %d dBm, %s at %lu.%02lu m: ",
+           p_record->format, (unsigned long)p_record->count, p_record->rssi,
+           zone_names[p_record->proximity.zone],
+           (unsigned long)(distance_cm / 100), (unsigned long)(distance_cm % 100));
+#else
+    printf("Beacon format %u seen %lu times, RSSI %d dBm: ",
+           p_record->format, (unsigned long)p_record->count, p_record->rssi);
+#endif
+    ble_address_print((uint8_t *)p_record->bd_addr);
+}
+#endif
+
+#if BEACON_TELEMETRY_ENABLE || BEACON_CCM_ENABLE
+/********************************************************************************
+* Function Name: ble_app_read_sensors
+*********************************************************************************
+* Summary:
+*   This function reads one telemetry sample. The kit has no environmental
+*   sensor, so slowly varying sample values are generated; replace this with
+*   the sensor driver of the board.
+*
+* Parameters:
+*   int16_t *values                          : Temperature and humidity
+*
+* Return:
+*  void
+*
+*********************************************************************************/
+static void ble_app_read_sensors(int16_t *values)
+{
+    uint32_t minute = beacon_stats_now_ms() / 60000;
+    int16_t ramp = (int16_t)(minute % 240);
+
+    /* 21.00 to 23.39 degree C and back, humidity following in reverse */
+    values[0] = 2100 + ((ramp < 120) ? ramp * 2 : (240 - ramp) * 2);
+    values[1] = 5500 - ((ramp < 120) ? ramp * 5 : (240 - ramp) * 5);
+}
+#endif
+
+#if BEACON_ROLLING_ENABLE
+/********************************************************************************
+* Function Name: ble_app_reserve_epochs
+*********************************************************************************
+* Summary:
+*   This function stores the first rolling identity epoch not yet used, so
+*   the identities continue from there after a reset
+*
+* Parameters:
+*   uint32_t limit                           : First epoch not reserved
+*
+* Return:
+*  wiced_bool_t                              : WICED_TRUE when stored
+*
+*********************************************************************************/
+static wiced_bool_t ble_app_reserve_epochs(uint32_t limit)
+{
+    return (WICED_BT_SUCCESS == beacon_store_set_counter(ROLLING_EPOCH_COUNTER, limit)) ?
+           WICED_TRUE : WICED_FALSE;
+}
+#endif
+
+#if BEACON_CCM_ENABLE
+/********************************************************************************
+* Function Name: ble_app_read_frame
+*********************************************************************************
+* Summary:
+*   This function fills the plaintext of an encrypted frame with a sensor
+*   sample
+*
+* Parameters:
+*   uint8_t *plain                           : Plaintext of the frame
+*   uint8_t plain_len                        : CCM_PLAIN_LEN
+*
+* Return:
+*  void
+*
+*********************************************************************************/
+static void ble_app_read_frame(uint8_t *plain, uint8_t plain_len)
+{
+    int16_t values[BEACON_TELEMETRY_CHANNELS];
+
+    ble_app_read_sensors(values);
+    for (uint8_t i = 0; (i < BEACON_TELEMETRY_CHANNELS) && ((2 * i + 1) < plain_len); i++)
+    {
+        plain[2 * i]     = (uint8_t)values[i];
+        plain[2 * i + 1] = (uint8_t)((uint16_t)values[i] >> 8);
+    }
+}
+
+/********************************************************************************
+* Function Name: ble_app_reserve_frames
+*********************************************************************************
+* Summary:
+*   This function stores the first encrypted frame counter not yet used, so
+*   the nonces continue from there after a reset
+*
+* Parameters:
+*   uint32_t limit                           : First counter not reserved
+*
+* Return:
+*  wiced_bool_t                              : WICED_TRUE when stored
+*
+*********************************************************************************/
+static wiced_bool_t ble_app_reserve_frames(uint32_t limit)
+{
+    return (WICED_BT_SUCCESS == beacon_store_set_counter(CCM_FRAME_COUNTER, limit)) ?
+           WICED_TRUE : WICED_FALSE;
+}
+#endif
+
+#if BEACON_HEALTH_ENABLE
+/********************************************************************************
+* Function Name: ble_app_health_report
+*********************************************************************************
+* Summary:
+*   This function is called when an instance keeps failing after
+*   BEACON_HEALTH_ESCALATE_ATTEMPTS and when it recovers after that. Retries
+*   go on meanwhile; replace the report with the recovery the product needs,
+*   such as a stack or device reset.
+*
+* Parameters:
+*   uint8_t instance                         : Multi-adv instance
+*   const beacon_health_stats_t *p_stats     : Counters of the instance
+*
+* Return:
+*  void
+*
+*********************************************************************************/
+static void ble_app_health_report(uint8_t instance, const beacon_health_stats_t *p_stats)
+{
+    if (BEACON_HEALTH_ESCALATED == p_stats->state)
+    {
+        printf("Instance %u still failing after %u attempts\n", instance, p_stats->attempts);
+    }
+    else
+    {
+        printf("Instance %u recovered\n", instance);
+    }
+}
+#endif
+
 /********************************************************************************
 * Function Name: ble_address_print
 *********************************************************************************
@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+"""Compiles a campaign calendar into beacon_campaign_table.c.
+
+The calendar names pre-encoded payloads and, per instance, a default
+payload and campaigns that replace it on some days and hours. Every day
+of the date range is expanded into the times at which an instance changes
+payload, so the firmware only searches a sorted table and copies the
+payload; identical payloads are stored once. For example:
+
+  {
+    "from": "2026-11-01", "to": "2026-12-31", "utc_offset": "+01:00",
+    "payloads": {
+      "store": {"ibeacon": {"uuid": "00112233445566778899aabbccddeeff",
+                            "major": 1, "minor": 2, "power": -59}},
+      "promo": {"ibeacon": {"uuid": "00112233445566778899aabbccddeeff",
+                            "major": 100, "minor": 2, "power": -59}},
+      "site": {"url": "https://www.infineon.com"},
+      "sale": {"url": "https://www.infineon.com/sale"},
+      "raw": {"hex": "020106..."}
+    },
+    "instances": {
+      "1": {"default": "site",
+            "campaigns": [{"payload": "sale", "dates": ["2026-11-27"]}]},
+      "2": {"default": "store",
+            "campaigns": [{"payload": "promo", "days": ["sat", "sun"],
+                           "hours": "09:00-18:00"}]}
+    }
+  }
+
+A campaign without days or dates runs every day, one without hours all
+day; hours such as 22:00-02:00 run past midnight. When campaigns
+overlap, the one listed last wins. After the range every instance goes
+back to its default. --list prints the transitions instead of writing.
+"""
+
+import argparse
+import datetime
+import json
+import os
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+
+ADV_DATA_MAX = 31
+FLAGS = [0x02, 0x01, 0x06]
+DAYS = ["mon", "tue", "wed", "thu", "fri", "sat", "sun"]
+
+# Eddystone URL encoding, see the Eddystone-URL specification
+URL_SCHEMES = ["http://www.", "https://www.", "http://", "https://"]
+URL_CODES = [".com/", ".org/", ".edu/", ".net/", ".info/", ".biz/", ".gov/",
+             ".com", ".org", ".edu", ".net", ".info", ".biz", ".gov"]
+
+
+def encode_url(url, tx_power):
+    for scheme in sorted(URL_SCHEMES, key=len, reverse=True):
+        if url.startswith(scheme):
+            url = url[len(scheme):]
+            encoded = [URL_SCHEMES.index(scheme)]
+            break
+    else:
+        raise SystemExit("unsupported URL scheme: %s" % url)
+    while url:
+        code = next((c for c in URL_CODES if url.startswith(c)), None)
+        if code:
+            encoded.append(URL_CODES.index(code))
+            url = url[len(code):]
+        else:
+            encoded.append(ord(url[0]))
+            url = url[1:]
+    frame = [0xAA, 0xFE, 0x10, tx_power & 0xFF] + encoded
+    return FLAGS + [0x03, 0x03, 0xAA, 0xFE, len(frame) + 1, 0x16] + frame
+
+
+def encode_ibeacon(p):
+    uuid = bytes.fromhex(p["uuid"].replace("-", ""))
+    if len(uuid) != 16:
+        raise SystemExit("iBeacon UUID must be 16 bytes")
+    body = ([0x4C, 0x00, 0x02, 0x15] + list(uuid) +
+            [p["major"] >> 8, p["major"] & 0xFF, p["minor"] >> 8, p["minor"] & 0xFF,
+             p.get("power", -59) & 0xFF])
+    return FLAGS + [len(body) + 1, 0xFF] + body
+
+
+def encode(name, p):
+    if "hex" in p:
+        data = list(bytes.fromhex(p["hex"]))
+    elif "ibeacon" in p:
+        data = encode_ibeacon(p["ibeacon"])
+    elif "url" in p:
+        data = encode_url(p["url"], p.get("power", -41))
+    else:
+        raise SystemExit("payload %s needs hex, ibeacon or url" % name)
+    if len(data) > ADV_DATA_MAX:
+        raise SystemExit("payload %s is %d bytes, at most %d" % (name, len(data), ADV_DATA_MAX))
+    return bytes(data)
+
+
+def parse_offset(text):
+    sign = -1 if text.startswith("-") else 1
+    hours, minutes = text.lstrip("+-").split(":")
+    return sign * (int(hours) * 60 + int(minutes)) * 60
+
+
+def parse_hours(text):
+    """Returns the start and end of a daily window in seconds after midnight."""
+    start, end = text.split("-")
+    to_s = lambda hm: int(hm.split(":")[0]) * 3600 + int(hm.split(":")[1]) * 60
+    return to_s(start), to_s(end)
+
+
+def runs_on(campaign, day):
+    if "dates" in campaign:
+        return day.isoformat() in campaign["dates"]
+    return DAYS[day.weekday()] in campaign.get("days", DAYS)
+
+
+def windows(campaign, first, last, offset):
+    """Yields the UTC start and end of every run of a campaign in the range."""
+    start, end = parse_hours(campaign.get("hours", "00:00-24:00"))
+    if end <= start:
+        end += 86400
+    day = first
+    while day <= last:
+        if runs_on(campaign, day):
+            midnight = int(datetime.datetime(day.year, day.month, day.day,
+                                             tzinfo=datetime.timezone.utc).timestamp()) - offset
+            yield midnight + start, midnight + end
+        day += datetime.timedelta(days=1)
+
+
+def compile_calendar(cal):
+    """Returns the sorted transitions (time, instance, payload name)."""
+    first = datetime.date.fromisoformat(cal["from"])
+    last = datetime.date.fromisoformat(cal["to"])
+    offset = parse_offset(cal.get("utc_offset", "+00:00"))
+    begin = int(datetime.datetime(first.year, first.month, first.day,
+                                  tzinfo=datetime.timezone.utc).timestamp()) - offset
+    end = begin + ((last - first).days + 1) * 86400
+
+    entries = []
+    for instance, inst in sorted(cal["instances"].items(), key=lambda kv: int(kv[0])):
+        runs = [list(windows(c, first, last, offset)) for c in inst.get("campaigns", [])]
+        edges = {begin, end}
+        for run in runs:
+            for start, stop in run:
+                edges.update(t for t in (start, stop) if begin <= t <= end)
+
+        current = None
+        for t in sorted(edges):
+            payload = inst["default"]
+            if t < end:
+                for campaign, run in zip(inst.get("campaigns", []), runs):
+                    if any(start <= t < stop for start, stop in run):
+                        payload = campaign["payload"]
+            if payload != current:
+                entries.append((t, int(instance), payload))
+                current = payload
+    entries.sort()
+    return entries
+
+
+def read_license(root):
+    """Returns the copyright block of beacon_campaign.c, for the generated file."""
+    with open(os.path.join(root, "beacon_campaign.c")) as f:
+        lines = f.read().splitlines()
+    first = next(i for i, line in enumerate(lines) if line.startswith("* Copyright"))
+    last = next(i for i in range(first, len(lines)) if lines[i].startswith("****"))
+    return lines[first - 1:last + 1]
+
+
+def pool(entries, definitions):
+    """Returns the encoded payloads in use, each once, and the index of every name."""
+    pool, index = [], {}
+    for _, _, name in entries:
+        if name in index:
+            continue
+        if name not in definitions:
+            raise SystemExit("unknown payload %s" % name)
+        data = encode(name, definitions[name])
+        for i, (names, other) in enumerate(pool):
+            if other == data:
+                names.append(name)
+                index[name] = i
+                break
+        else:
+            index[name] = len(pool)
+            pool.append(([name], data))
+    return pool, index
+
+
+def write_table(path, root, entries, payloads, index, source):
+    out = ["/" + "*" * 78,
+           "* File Name: beacon_campaign_table.c",
+           "*",
+           "* Description: Campaign table generated from %s by" % os.path.basename(source),
+           "* scripts/beacon_campaign.py, do not edit. %d transitions, %d payloads."
+           % (len(entries), len(payloads)),
+           "*"]
+    out += read_license(root)
+    out += ["",
+            "#include \"beacon_campaign.h\"",
+            "",
+            "#if BEACON_CAMPAIGN_ENABLE",
+            "",
+            "static const beacon_campaign_payload_t campaign_payloads[] =",
+            "{"]
+    for names, data in payloads:
+        out.append("    /* %s */" % ", ".join(names))
+        out.append("    { %d, { %s } }," % (len(data), ", ".join("0x%02X" % b for b in data)))
+    out += ["};",
+            "",
+            "static const beacon_campaign_entry_t campaign_entries[] =",
+            "{"]
+    for t, instance, name in entries:
+        stamp = datetime.datetime.fromtimestamp(t, datetime.timezone.utc)
+        out.append("    { %10du, %3d, %d, 0 },    /* %s UTC */"
+                   % (t, index[name], instance, stamp.strftime("%Y-%m-%d %H:%M")))
+    out += ["};",
+            "",
+            "const beacon_campaign_table_t beacon_campaign_table =",
+            "{",
+            "    .p_entries    = campaign_entries,",
+            "    .num_entries  = sizeof(campaign_entries) / sizeof(campaign_entries[0]),",
+            "    .p_payloads   = campaign_payloads,",
+            "    .num_payloads = sizeof(campaign_payloads) / sizeof(campaign_payloads[0]),",
+            "};",
+            "",
+            "#endif",
+            "",
+            "/* [] END OF FILE */",
+            ""]
+    with open(path, "w") as f:
+        f.write("\n".join(out))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("calendar", help="JSON calendar")
+    parser.add_argument("-o", "--output",
+                        default=os.path.join(ROOT, "beacon_campaign_table.c"))
+    parser.add_argument("--list", action="store_true", help="print the transitions")
+    args = parser.parse_args()
+
+    with open(args.calendar) as f:
+        cal = json.load(f)
+    entries = compile_calendar(cal)
+
+    payloads, index = pool(entries, cal["payloads"])
+
+    if args.list:
+        for t, instance, name in entries:
+            stamp = datetime.datetime.fromtimestamp(t, datetime.timezone.utc)
+            print("%s UTC  instance %d  %s" % (stamp.strftime("%Y-%m-%d %H:%M"), instance, name))
+        return 0
+
+    write_table(args.output, ROOT, entries, payloads, index, args.calendar)
+    flash = len(entries) * 8 + len(payloads) * 32
+    print("Wrote %s: %d transitions, %d payloads, %d bytes of flash"
+          % (args.output, len(entries), len(payloads), flash))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""Plans the average current and battery life of a multi beacon configuration.
+
+The model is the one of beacon_energy.c, and its parameters are read from
+beacon_energy.h and beacon_energy.c, so calibrating them there updates both.
+Each advertising slot costs a wakeup, one packet per channel of its map, the
+hops between the channels and, if it is scannable, a scan request window
+after each packet, once every interval plus the mean advDelay. Periodic
+jobs cost a CPU wakeup each, and the sleep current is drawn throughout.
+
+The plan is a JSON file, for example:
+
+  {
+    "battery_mah": 230,
+    "slots": [
+      {"name": "url", "format": "eddystone-url", "url": "https://www.infineon.com",
+       "interval": 160, "tx": 2},
+      {"name": "ibeacon", "format": "ibeacon", "interval": 1600, "tx": 1},
+      {"name": "status", "len": 19, "interval": 3200, "tx": 0, "scannable": true,
+       "channels": [37, 38]}
+    ],
+    "jobs": [{"name": "telemetry", "period_ms": 1000}]
+  }
+
+interval is in 0.625 ms units as in adv_int_min, tx is the Tx power index
+(0 to 4). --sweep prints the battery life with every slot interval scaled,
+--simulate counts the events one by one with random advDelay, as the
+simulated controller does, to check the closed form.
+"""
+
+import argparse
+import json
+import os
+import random
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+
+US_PER_INTERVAL = 625
+ADV_DELAY_MAX_US = 10000
+CHANNELS = (37, 38, 39)
+
+# Advertisement lengths of the registered formats, see beacon_format.c
+FORMAT_LEN = {"ibeacon": 30, "altbeacon": 31, "status": 19}
+
+# Eddystone URL encoding, see the Eddystone-URL specification
+URL_SCHEMES = ["http://www.", "https://www.", "http://", "https://"]
+URL_CODES = [".com/", ".org/", ".edu/", ".net/", ".info/", ".biz/", ".gov/",
+             ".com", ".org", ".edu", ".net", ".info", ".biz", ".gov"]
+
+# Flags, 16-bit service UUID list and service data header of a URL frame
+EDDYSTONE_URL_OVERHEAD = 3 + 4 + 7
+
+
+def read_model(root):
+    """Returns the BEACON_ENERGY_* constants and the Tx current table."""
+    with open(os.path.join(root, "beacon_energy.h")) as f:
+        header = f.read()
+    model = {name.lower(): int(value) for name, value in
+             re.findall(r"#define\s+BEACON_ENERGY_(\w+)\s+\((\d+)\)", header)}
+    with open(os.path.join(root, "beacon_energy.c")) as f:
+        source = f.read()
+    table = re.search(r"energy_tx_ua\[[^\]]*\]\s*=\s*\{([^}]*)\}", source)
+    if table is None:
+        raise SystemExit("energy_tx_ua not found in beacon_energy.c")
+    model["tx_ua"] = [int(value) for value in re.findall(r"\d+", table.group(1))]
+    return model
+
+
+def url_len(url):
+    for scheme in sorted(URL_SCHEMES, key=len, reverse=True):
+        if url.startswith(scheme):
+            url = url[len(scheme):]
+            break
+    else:
+        raise SystemExit("unsupported URL scheme: %s" % url)
+    encoded = 0
+    while url:
+        code = next((c for c in URL_CODES if url.startswith(c)), None)
+        url = url[len(code):] if code else url[1:]
+        encoded += 1
+    return EDDYSTONE_URL_OVERHEAD + encoded
+
+
+def slot_len(slot):
+    if "len" in slot:
+        return slot["len"]
+    fmt = slot.get("format")
+    if fmt == "eddystone-url":
+        return url_len(slot["url"])
+    if fmt in FORMAT_LEN:
+        return FORMAT_LEN[fmt]
+    raise SystemExit("slot %s needs len or a known format" % slot.get("name", "?"))
+
+
+def event_nc(model, slot):
+    """Charge of one advertising event, with the integer math of beacon_energy.c."""
+    channels = len(slot.get("channels", CHANNELS)) or len(CHANNELS)
+    air_us = (model["air_overhead"] + slot_len(slot)) * model["us_per_byte"]
+    tx_ua = model["tx_ua"][slot.get("tx", len(model["tx_ua"]) - 1)]
+    pc = (model["event_us"] * model["event_ua"] + channels * air_us * tx_ua +
+          (channels - 1) * model["channel_gap_us"] * model["event_ua"])
+    if slot.get("scannable", False):
+        pc += channels * model["listen_us"] * model["rx_ua"]
+    return pc // 1000
+
+
+def period_us(model, slot):
+    return slot["interval"] * US_PER_INTERVAL + model["adv_delay_us"]
+
+
+def plan(model, config, scale=1.0):
+    """Returns the rows (name, nA) and the total average current in nA."""
+    rows = []
+    for slot in config.get("slots", []):
+        scaled = dict(slot, interval=max(32, int(slot["interval"] * scale)))
+        rows.append((slot.get("name", "slot"),
+                     event_nc(model, scaled) * 1000000 / period_us(model, scaled)))
+    for job in config.get("jobs", []):
+        rows.append((job.get("name", "job"),
+                     model["wakeup_us"] * model["cpu_ua"] / job["period_ms"]))
+    rows.append(("sleep", model["sleep_na"]))
+    return rows, sum(na for _, na in rows)
+
+
+def life_hours(model, config, na):
+    return config.get("battery_mah", model["battery_mah"]) * 1e6 / na
+
+
+def simulate(model, config, seconds, seed):
+    """Counts the events of every slot with random advDelay."""
+    rng = random.Random(seed)
+    end_us = seconds * 1e6
+    out = []
+    for slot in config.get("slots", []):
+        events, t = 0, 0.0
+        while t <= end_us:
+            events += 1
+            t += slot["interval"] * US_PER_INTERVAL + rng.randint(0, ADV_DELAY_MAX_US)
+        expected = end_us / period_us(model, slot)
+        out.append((slot.get("name", "slot"), events, expected,
+                    events * event_nc(model, slot) / seconds))
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("plan", help="JSON plan")
+    parser.add_argument("--root", default=ROOT, help="directory of beacon_energy.h")
+    parser.add_argument("--sweep", action="store_true",
+                        help="battery life with the intervals scaled 0.25x to 4x")
+    parser.add_argument("--simulate", type=float, metavar="SECONDS",
+                        help="count events with random advDelay for SECONDS")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    model = read_model(args.root)
+    with open(args.plan) as f:
+        config = json.load(f)
+
+    rows, total = plan(model, config)
+    for name, na in rows:
+        print("%-16s %10.3f uA" % (name, na / 1000))
+    hours = life_hours(model, config, total)
+    print("%-16s %10.3f uA, %.0f days on %d mAh"
+          % ("total", total / 1000, hours / 24,
+             config.get("battery_mah", model["battery_mah"])))
+
+    if args.sweep:
+        print("\nInterval scale    average     life")
+        for scale in (0.25, 0.5, 1, 2, 4):
+            _, na = plan(model, config, scale)
+            print("%8.2fx      %8.3f uA %6.0f days"
+                  % (scale, na / 1000, life_hours(model, config, na) / 24))
+
+    if args.simulate:
+        print("\nSimulated %.0f s        events   closed form   error    current"
+              % args.simulate)
+        for name, events, expected, na in simulate(model, config, args.simulate, args.seed):
+            print("%-16s %12d %13.1f %6.2f%% %7.3f uA"
+                  % (name, events, expected, 100 * (events - expected) / expected, na / 1000))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Host side sender for the multi beacon provisioning protocol.
+
+Opens a session with the prov console command and streams the slot
+configurations and keys of a JSON file with a sliding window, see
+beacon_prov.h for the frame layout. Example configuration:
+
+    {
+        "slots": [
+            {"instance": 1, "interval": [160, 160], "tx": 4,
+             "data": "0201041106..."}
+        ],
+        "keys": [
+            {"id": 1, "key": "5be2178c40d96a33f10e957c28b461cf"}
+        ]
+    }
+
+Requires pyserial.
+"""
+
+import argparse
+import json
+import sys
+import time
+
+import serial
+
+SOF = 0xA5
+PAYLOAD_MAX = 48
+
+TYPE_BEGIN = 0x01
+TYPE_SLOT = 0x02
+TYPE_KEY = 0x03
+TYPE_COMMIT = 0x04
+TYPE_ABORT = 0x05
+TYPE_ACK = 0x80
+TYPE_NAK = 0x81
+
+STATUS = {0: "ok", 1: "bad record", 2: "key store full", 3: "flash write failed"}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT, polynomial 0x1021, MSB first."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def frame(frame_type, seq, payload=b""):
+    if len(payload) > PAYLOAD_MAX:
+        raise ValueError("payload too long")
+    body = bytes([len(payload), frame_type, seq & 0xFF]) + payload
+    crc = crc16(body)
+    return bytes([SOF]) + body + bytes([crc & 0xFF, crc >> 8])
+
+
+def records(config):
+    """Returns the SLOT and KEY payloads of a configuration."""
+    out = []
+    for slot in config.get("slots", []):
+        int_min, int_max = slot.get("interval", [160, 160])
+        data = bytes.fromhex(slot["data"])
+        out.append((TYPE_SLOT, bytes([slot["instance"], int_min & 0xFF, int_min >> 8,
+                                      int_max & 0xFF, int_max >> 8, slot.get("tx", 4)]) + data))
+    for key in config.get("keys", []):
+        value = bytes.fromhex(key["key"])
+        if len(value) != 16:
+            raise ValueError("keys are 16 bytes")
+        out.append((TYPE_KEY, bytes([key["id"]]) + value))
+    return out
+
+
+class Receiver:
+    """Extracts ACK and NAK frames, skipping console output around them."""
+
+    def __init__(self, port):
+        self.port = port
+        self.buf = bytearray()
+
+    def reply(self, timeout):
+        deadline = time.monotonic() + timeout
+        while True:
+            while len(self.buf) >= 8:
+                start = self.buf.find(SOF)
+                if start < 0:
+                    self.buf.clear()
+                    break
+                del self.buf[:start]
+                if len(self.buf) < 8:
+                    break
+                candidate = bytes(self.buf[:8])
+                if (candidate[1] == 2 and candidate[2] in (TYPE_ACK, TYPE_NAK) and
+                        crc16(candidate[1:6]) == candidate[6] | (candidate[7] << 8)):
+                    del self.buf[:8]
+                    return candidate[2], candidate[4], candidate[5]
+                del self.buf[:1]
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            self.port.timeout = remaining
+            self.buf += self.port.read(max(1, self.port.in_waiting))
+
+
+def session(port, rx, payloads, window, timeout):
+    """Runs one session, returns the status of the commit."""
+    for _ in range(3):
+        port.write(frame(TYPE_BEGIN, 0))
+        reply = rx.reply(timeout)
+        if reply is not None and reply[0] == TYPE_ACK and reply[1] == 1:
+            break
+    else:
+        raise IOError("no reply to BEGIN")
+
+    frames = [frame(t, i + 1, p) for i, (t, p) in enumerate(payloads)]
+    frames.append(frame(TYPE_COMMIT, len(frames) + 1))
+    base = 0
+    sent = 0
+    retries = 0
+
+    while base < len(frames):
+        while sent < len(frames) and sent < base + window:
+            port.write(frames[sent])
+            sent += 1
+
+        reply = rx.reply(timeout)
+        if reply is None:
+            retries += 1
+            if retries > 5:
+                raise IOError("device stopped answering")
+            sent = base
+            continue
+
+        reply_type, expected, status = reply
+        acked = (expected - 1 - base) & 0xFF
+        if acked <= sent - base:
+            base += acked
+            retries = 0
+        if reply_type == TYPE_NAK:
+            sent = base
+        if status != 0:
+            port.write(frame(TYPE_ABORT, base + 1))
+            return status
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", help="debug UART of the kit")
+    parser.add_argument("config", help="JSON file with slots and keys")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--window", type=int, default=8, help="at most 8")
+    parser.add_argument("--repeat", type=int, default=1,
+                        help="sessions to run, to measure throughput")
+    parser.add_argument("--timeout", type=float, default=0.5)
+    args = parser.parse_args()
+
+    with open(args.config) as config_file:
+        payloads = records(json.load(config_file))
+
+    with serial.Serial(args.port, args.baud) as port:
+        rx = Receiver(port)
+        port.write(b"prov\r")
+        time.sleep(0.2)
+        port.reset_input_buffer()
+
+        start = time.monotonic()
+        for _ in range(args.repeat):
+            status = session(port, rx, payloads, min(args.window, 8), args.timeout)
+            if status != 0:
+                print("Session failed: %s" % STATUS.get(status, status))
+                return 1
+        elapsed = time.monotonic() - start
+
+    print("%d sessions, %d records in %.2f s, %.1f configs/s" %
+          (args.repeat, args.repeat * len(payloads), elapsed,
+           args.repeat * len(payloads) / elapsed))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
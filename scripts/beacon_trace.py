@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""Converts a multi beacon trace dump to the Chrome trace event format.
+
+The dump is printed by the trace console command of a build with
+BEACON_TRACE_ENABLE=1. Either pass a terminal log that contains it, or
+the serial port of the kit with --port to request it. Open the JSON file
+in ui.perfetto.dev or chrome://tracing. A summary of the start-up from
+BTM_ENABLED_EVT until every instance advertises is printed as well.
+
+Requires pyserial with --port.
+"""
+
+import argparse
+import json
+import sys
+import time
+
+TASK_IN = 0
+CBACK_ENTER = 1
+CBACK_EXIT = 2
+CMD_ISSUE = 3
+CMD_REJECT = 4
+CMD_RESP = 5
+
+# beacon_manager_evt_type_t of the exit record
+CBACK_NAMES = {0: "BTM_ENABLED_EVT", 1: "BTM_MULTI_ADVERT_RESP_EVENT"}
+CBACK_ENABLED = 0
+
+# wiced_bt_multi_adv_opcodes_t
+OPCODE_NAMES = {1: "set params", 2: "set data", 3: "set scan response",
+                4: "set random address", 5: "enable"}
+OPCODE_ENABLE = 5
+
+PID_TASKS = 1
+PID_BT = 2
+TID_CBACK = 1
+TID_CMD = 2
+
+
+def read_dump(lines):
+    """Returns the clock, task names, records and dropped count of the last dump."""
+    dump = None
+    for line in lines:
+        words = line.split()
+        if len(words) == 4 and words[0] == "trace":
+            dump = {"hz": int(words[1]), "dropped": int(words[3]),
+                    "tasks": {}, "records": []}
+        elif dump is None:
+            continue
+        elif words and words[0] == "end":
+            break
+        elif len(words) >= 3 and words[0] == "task":
+            dump["tasks"][int(words[1])] = " ".join(words[2:])
+        elif len(words) == 4:
+            try:
+                dump["records"].append((int(words[0], 16), int(words[1]),
+                                        int(words[2]), int(words[3])))
+            except ValueError:
+                pass
+    if dump is None:
+        raise SystemExit("no trace dump found")
+    return dump
+
+
+def request_dump(port, baud, timeout):
+    import serial
+
+    with serial.Serial(port, baud, timeout=0.2) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"trace\r")
+        lines = []
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            line = ser.readline().decode("ascii", "replace").strip()
+            if line:
+                lines.append(line)
+                if line == "end":
+                    break
+        return lines
+
+
+def timestamps(records, hz):
+    """Unwraps the 32-bit cycle counter into microseconds from the first record."""
+    out = []
+    base = records[0][0] if records else 0
+    wraps = 0
+    last = base
+    for cycles, _, _, _ in records:
+        if cycles < last:
+            wraps += 1
+        last = cycles
+        out.append((cycles + (wraps << 32) - base) * 1e6 / hz)
+    return out
+
+
+def convert(dump):
+    records = dump["records"]
+    tasks = dump["tasks"]
+    times = timestamps(records, dump["hz"])
+    events = [
+        {"ph": "M", "name": "process_name", "pid": PID_TASKS, "args": {"name": "Tasks"}},
+        {"ph": "M", "name": "process_name", "pid": PID_BT, "args": {"name": "Bluetooth"}},
+        {"ph": "M", "name": "thread_name", "pid": PID_BT, "tid": TID_CBACK,
+         "args": {"name": "Stack callbacks"}},
+        {"ph": "M", "name": "thread_name", "pid": PID_BT, "tid": TID_CMD,
+         "args": {"name": "Multi-adv commands"}},
+    ]
+    for number, name in tasks.items():
+        events.append({"ph": "M", "name": "thread_name", "pid": PID_TASKS,
+                       "tid": number, "args": {"name": name}})
+
+    summary = {"running": [], "cbacks": [], "cmds": [], "started": {}}
+    running = None
+    cback = None
+    issued = []
+    seq = 0
+
+    for (cycles, rtype, rid, arg), ts in zip(records, times):
+        if rtype == TASK_IN:
+            if running is not None:
+                number, start = running
+                events.append({"ph": "X", "name": tasks.get(number, "task %d" % number),
+                               "pid": PID_TASKS, "tid": number, "ts": start,
+                               "dur": ts - start})
+                summary["running"].append((number, start, ts))
+            running = (arg, ts)
+        elif rtype == CBACK_ENTER:
+            cback = (rid, ts)
+        elif rtype == CBACK_EXIT and cback is not None:
+            name = CBACK_NAMES.get(arg, "event %d" % rid)
+            events.append({"ph": "X", "name": name, "pid": PID_BT, "tid": TID_CBACK,
+                           "ts": cback[1], "dur": ts - cback[1], "args": {"event": rid}})
+            summary["cbacks"].append((arg, cback[1], ts))
+            cback = None
+        elif rtype == CMD_ISSUE:
+            seq += 1
+            name = "%s %d" % (OPCODE_NAMES.get(rid, "opcode %d" % rid), arg)
+            issued.append((seq, name, ts))
+            events.append({"ph": "b", "cat": "hci", "name": name, "id": seq,
+                           "pid": PID_BT, "tid": TID_CMD, "ts": ts})
+        elif rtype == CMD_REJECT and issued:
+            cmd_seq, name, _ = issued.pop()
+            events.append({"ph": "e", "cat": "hci", "name": name, "id": cmd_seq,
+                           "pid": PID_BT, "tid": TID_CMD, "ts": ts,
+                           "args": {"status": "rejected"}})
+        elif rtype == CMD_RESP and issued:
+            # Responses arrive in issue order
+            cmd_seq, name, start = issued.pop(0)
+            instance, status = arg & 0xFF, arg >> 8
+            events.append({"ph": "e", "cat": "hci", "name": name, "id": cmd_seq,
+                           "pid": PID_BT, "tid": TID_CMD, "ts": ts,
+                           "args": {"status": status}})
+            summary["cmds"].append((start, ts))
+            if rid == OPCODE_ENABLE and status == 0:
+                summary["started"].setdefault(instance, ts)
+
+    return {"traceEvents": events, "displayTimeUnit": "ms"}, summary
+
+
+def print_summary(dump, summary, out):
+    tasks = dump["tasks"]
+    print("%d records, %d dropped" % (len(dump["records"]), dump["dropped"]), file=out)
+
+    enabled = [start for kind, start, _ in summary["cbacks"] if kind == CBACK_ENABLED]
+    started = summary["started"]
+    if not enabled or not started:
+        print("BTM_ENABLED_EVT or an instance start is not in the trace", file=out)
+        return
+    t0 = enabled[0]
+    t1 = max(started.values())
+    print("BTM_ENABLED_EVT to %d instances advertising: %.0f us" % (len(started), t1 - t0),
+          file=out)
+
+    busy = {}
+    for number, start, end in summary["running"]:
+        overlap = min(end, t1) - max(start, t0)
+        if overlap > 0:
+            busy[number] = busy.get(number, 0) + overlap
+    for number, us in sorted(busy.items(), key=lambda item: -item[1]):
+        print("  %-16s %8.0f us" % (tasks.get(number, "task %d" % number), us), file=out)
+
+    cbacks = [end - start for _, start, end in summary["cbacks"] if t0 <= start <= t1]
+    cmds = [end - start for start, end in summary["cmds"] if t0 <= start <= t1]
+    if cbacks:
+        print("  %d stack callbacks, %.0f us in total" % (len(cbacks), sum(cbacks)), file=out)
+    if cmds:
+        print("  %d commands, issue to response %.0f us mean, %.0f us max"
+              % (len(cmds), sum(cmds) / len(cmds), max(cmds)), file=out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", help="terminal log with a trace dump")
+    parser.add_argument("--port", help="request the dump from the kit instead")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=30.0)
+    parser.add_argument("-o", "--output", default="trace.json")
+    args = parser.parse_args()
+
+    if args.port:
+        lines = request_dump(args.port, args.baud, args.timeout)
+    elif args.log:
+        with open(args.log, encoding="ascii", errors="replace") as f:
+            lines = f.read().splitlines()
+    else:
+        parser.error("pass a log file or --port")
+
+    dump = read_dump(lines)
+    trace, summary = convert(dump)
+    with open(args.output, "w") as f:
+        json.dump(trace, f)
+    print("Wrote %s" % args.output)
+    print_summary(dump, summary, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Prints the flash and RAM used by each beacon format and source file.
+
+Reads the symbol table of the linked image with nm. Symbols of a beacon
+format are reported on their own row, even when they share a source file
+with other code. Every other symbol of the application is reported under
+its source file, taken from the debug information. The rest of the image
+(BSP, Bluetooth stack, FreeRTOS and libraries) is reported as one row.
+
+A format row holds the functions and data named after the format only. It
+does not hold the instance setup in main.c, code the compiler inlined into
+other functions, or the identifiers the receive parser shares with the
+encoder (ibeacon_type and ibeacon_company_id), which a format switch does
+not remove. For the full cost of a switch, build the image again with the
+switch set to 0 and pass it with --without: the change of the whole image
+is printed.
+
+Usage: footprint.py [--nm arm-none-eabi-nm] <image.elf>
+                    [--without "format iBeacon=no_ibeacon.elf" ...]
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+# Symbols of each format switch, see BEACON_*_ENABLE in beacon_utils.h
+FORMATS = [
+    ("format iBeacon", re.compile(r"^(ibeacon_set_adv_data|format_ibeacon)")),
+    ("format Eddystone URL", re.compile(r"^eddystone_")),
+    ("format AltBeacon", re.compile(r"^format_altbeacon")),
+    ("format status frame", re.compile(r"^(format_status|beacon_format_status_tick)")),
+]
+
+FLASH_TYPES = set("tTrRdD")
+RAM_TYPES = set("dDbB")
+
+
+def symbols(nm, elf):
+    """Yields (name, size, type, source file) of every sized symbol."""
+    out = subprocess.run([nm, "-S", "-l", "--size-sort", elf], check=True,
+                         stdout=subprocess.PIPE, universal_newlines=True).stdout
+    for line in out.splitlines():
+        fields = line.split("\t")
+        parts = fields[0].split()
+        if len(parts) != 4:
+            continue
+        source = os.path.basename(fields[1].rsplit(":", 1)[0]) if len(fields) > 1 else ""
+        yield parts[3], int(parts[1], 16), parts[2], source
+
+
+def image_size(nm, elf):
+    """Returns the flash and RAM of every sized symbol of an image."""
+    flash = ram = 0
+    for _, size, sym_type, _ in symbols(nm, elf):
+        flash += size if sym_type in FLASH_TYPES else 0
+        ram += size if sym_type in RAM_TYPES else 0
+    return flash, ram
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    parser.add_argument("--without", action="append", default=[], metavar="LABEL=ELF",
+                        help="image built with a switch off, its saving is printed")
+    parser.add_argument("elf")
+    args = parser.parse_args()
+
+    app_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    app_sources = set(f for f in os.listdir(app_dir) if f.endswith(".c"))
+    rows = {}
+
+    for name, size, sym_type, source in symbols(args.nm, args.elf):
+        label = next((label for label, pattern in FORMATS if pattern.match(name)), None)
+        if label is None:
+            label = source if source in app_sources else "BSP, stack and libraries"
+        flash, ram = rows.get(label, (0, 0))
+        rows[label] = (flash + (size if sym_type in FLASH_TYPES else 0),
+                       ram + (size if sym_type in RAM_TYPES else 0))
+
+    order = [label for label, _ in FORMATS if label in rows]
+    order += sorted(label for label in rows if label.endswith(".c"))
+    app = [rows[label] for label in order]
+    other = rows.get("BSP, stack and libraries", (0, 0))
+
+    print("%-28s %8s %8s" % ("Footprint (bytes)", "Flash", "RAM"))
+    for label in order:
+        print("%-28s %8d %8d" % (label, rows[label][0], rows[label][1]))
+    print("%-28s %8d %8d" % ("Application", sum(r[0] for r in app), sum(r[1] for r in app)))
+    print("%-28s %8d %8d" % ("BSP, stack and libraries", other[0], other[1]))
+
+    if args.without:
+        full = image_size(args.nm, args.elf)
+        print()
+        print("%-28s %8s %8s" % ("Saved when switched off", "Flash", "RAM"))
+        for entry in args.without:
+            label, sep, elf = entry.partition("=")
+            if not sep:
+                parser.error("--without takes LABEL=ELF: %s" % entry)
+            size = image_size(args.nm, elf)
+            print("%-28s %8d %8d" % (label, full[0] - size[0], full[1] - size[1]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,84 @@
+/******************************************************************************
+* File Name: FreeRTOS.h
+*
+* Description: Host stand-in for the FreeRTOS kernel header. Tasks are POSIX
+* threads that run one at a time, see freertos_host.c.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cy_pdl.h"
+
+typedef uint32_t      TickType_t;
+typedef long          BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t      StackType_t;
+
+#define pdTRUE                           (1)
+#define pdFALSE                          (0)
+#define pdPASS                           (1)
+#define pdFAIL                           (0)
+#define portMAX_DELAY                    (0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS               (1)
+#define pdMS_TO_TICKS(ms)                ((TickType_t)(ms))
+
+#define configTICK_RATE_HZ               (1000)
+#define configCPU_CLOCK_HZ               SystemCoreClock
+#define configMAX_PRIORITIES             (7)
+#define configMINIMAL_STACK_SIZE         (128)
+
+/* Static objects, the host keeps its state in the handles */
+typedef struct { void *p_host; } StaticTask_t;
+typedef struct { void *p_host; } StaticQueue_t;
+typedef struct { void *p_host; } StaticTimer_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+/* Only one task runs at a time, so the critical sections need no lock */
+#define taskENTER_CRITICAL()             do { } while (0)
+#define taskEXIT_CRITICAL()              do { } while (0)
+#define taskENTER_CRITICAL_FROM_ISR()    (0)
+#define taskEXIT_CRITICAL_FROM_ISR(x)    ((void)(x))
+#define portYIELD_FROM_ISR(x)            ((void)(x))
+
+void host_assert(const char *file, int line);
+#define configASSERT(x)                  do { if (!(x)) { host_assert(__FILE__, __LINE__); } } while (0)
+
+#endif      /* __HOST_FREERTOS_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,118 @@
+/******************************************************************************
+* File Name: cy_pdl.h
+*
+* Description: Host stand-in for the PDL and CMSIS core definitions used by
+* the application
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef __HOST_CY_PDL_H__
+#define __HOST_CY_PDL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_utils.h"
+
+extern uint32_t SystemCoreClock;
+
+/* Cycle counter, advanced from the host clock on every access */
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+}DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+}CoreDebug_Type;
+
+DWT_Type *host_dwt(void);
+extern CoreDebug_Type host_core_debug;
+
+#define DWT                              (host_dwt())
+#define CoreDebug                        (&host_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk           (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk       (1UL << 24)
+
+#define __STATIC_INLINE                  static inline
+
+__STATIC_INLINE void __DMB(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_INLINE void __enable_irq(void)
+{
+}
+
+__STATIC_INLINE uint32_t __CLZ(uint32_t value)
+{
+    return (0 == value) ? 32 : (uint32_t)__builtin_clz(value);
+}
+
+__STATIC_INLINE uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+
+    for (int i = 0; i < 32; i++)
+    {
+        result = (result << 1) | (value & 1);
+        value >>= 1;
+    }
+    return result;
+}
+
+/* Exclusive monitor: the store succeeds if the word still holds the value
+ * loaded by the same thread */
+extern __thread uint32_t host_exclusive_value;
+
+__STATIC_INLINE uint32_t __LDREXW(volatile uint32_t *p_addr)
+{
+    host_exclusive_value = __atomic_load_n(p_addr, __ATOMIC_SEQ_CST);
+    return host_exclusive_value;
+}
+
+__STATIC_INLINE uint32_t __STREXW(uint32_t value, volatile uint32_t *p_addr)
+{
+    uint32_t expected = host_exclusive_value;
+
+    return __atomic_compare_exchange_n(p_addr, &expected, value, false, __ATOMIC_SEQ_CST,
+                                       __ATOMIC_SEQ_CST) ? 0 : 1;
+}
+
+#endif      /* __HOST_CY_PDL_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,108 @@
+/******************************************************************************
+* File Name: cyhal.h
+*
+* Description: Host stand-in for the HAL drivers used by the application: the
+* debug UART on stdin and stdout, flash in RAM and a seeded TRNG
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef __HOST_CYHAL_H__
+#define __HOST_CYHAL_H__
+
+#include <stddef.h>
+#include "cy_pdl.h"
+
+#define CYHAL_ISR_PRIORITY_DEFAULT       (7)
+#define CYHAL_DRIVER_AVAILABLE_TRNG      (1)
+
+/* UART */
+typedef struct
+{
+    int unused;
+}cyhal_uart_t;
+
+typedef enum
+{
+    CYHAL_UART_IRQ_NONE         = 0,
+    CYHAL_UART_IRQ_RX_NOT_EMPTY = 1 << 8,
+}cyhal_uart_event_t;
+
+typedef void (*cyhal_uart_event_callback_t)(void *callback_arg, cyhal_uart_event_t event);
+
+void      cyhal_uart_register_callback (cyhal_uart_t *obj, cyhal_uart_event_callback_t callback,
+                                        void *callback_arg);
+void      cyhal_uart_enable_event      (cyhal_uart_t *obj, cyhal_uart_event_t event,
+                                        uint8_t intr_priority, bool enable);
+uint32_t  cyhal_uart_readable          (cyhal_uart_t *obj);
+cy_rslt_t cyhal_uart_getc              (cyhal_uart_t *obj, uint8_t *value, uint32_t timeout);
+cy_rslt_t cyhal_uart_write             (cyhal_uart_t *obj, void *tx, size_t *tx_length);
+
+/* Flash */
+typedef struct
+{
+    int unused;
+}cyhal_flash_t;
+
+typedef struct
+{
+    uint32_t start_address;
+    uint32_t size;
+    uint32_t sector_size;
+    uint32_t page_size;
+    uint8_t erase_value;
+}cyhal_flash_block_info_t;
+
+typedef struct
+{
+    uint8_t block_count;
+    const cyhal_flash_block_info_t *blocks;
+}cyhal_flash_info_t;
+
+cy_rslt_t cyhal_flash_init     (cyhal_flash_t *obj);
+void      cyhal_flash_get_info (const cyhal_flash_t *obj, cyhal_flash_info_t *info);
+cy_rslt_t cyhal_flash_write    (cyhal_flash_t *obj, uint32_t address, const uint32_t *data);
+
+/* TRNG */
+typedef struct
+{
+    int unused;
+}cyhal_trng_t;
+
+cy_rslt_t cyhal_trng_init     (cyhal_trng_t *obj);
+uint32_t  cyhal_trng_generate (const cyhal_trng_t *obj);
+
+#endif      /* __HOST_CYHAL_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,645 @@
+/******************************************************************************
+* File Name: freertos_host.c
+*
+* Description: Host implementation of the FreeRTOS API used by the application.
+* Every task is a pthread, but only the thread holding the host CPU lock runs, so
+* tasks switch only when one of them blocks. Ticks are host milliseconds.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "timers.h"
+#include "host.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define HOST_MAX_TASKS                   (16)
+#define HOST_MAX_QUEUES                  (64)
+#define HOST_MAX_TIMERS                  (16)
+
+/*******************************************************************************
+*        Data Structure Definitions
+*******************************************************************************/
+struct host_task
+{
+    pthread_t thread;
+    TaskFunction_t p_fn;
+    void *p_arg;
+    const char *p_name;
+    UBaseType_t number;
+    UBaseType_t priority;
+    uint32_t notify_value;
+    uint8_t notify_pending;
+    uint8_t notify_waiting;
+};
+
+typedef enum
+{
+    HOST_QUEUE,
+    HOST_MUTEX,
+    HOST_BINARY
+}host_queue_type_t;
+
+struct host_queue
+{
+    host_queue_type_t type;
+    uint8_t *p_storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+struct host_timer
+{
+    TimerCallbackFunction_t p_cback;
+    void *p_id;
+    TickType_t period;
+    TickType_t expiry;
+    UBaseType_t auto_reload;
+    uint8_t active;
+};
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+/* The host CPU: held by whichever task is running */
+static pthread_mutex_t host_cpu = PTHREAD_MUTEX_INITIALIZER;
+
+/* Broadcast on every change a blocked task may be waiting for */
+static pthread_cond_t host_cond;
+
+static struct timespec host_epoch;
+static int host_started;
+
+static struct host_task  host_tasks[HOST_MAX_TASKS];
+static UBaseType_t       host_task_count;
+static struct host_queue host_queues[HOST_MAX_QUEUES];
+static UBaseType_t       host_queue_count;
+static struct host_timer host_timers[HOST_MAX_TIMERS];
+static UBaseType_t       host_timer_count;
+static pthread_t         host_timer_thread;
+
+static __thread struct host_task *host_self;
+
+/* Task last notified from an interrupt */
+static struct host_task *host_isr_task;
+
+/* Counts the returns from blocking calls, unchanged while every task sleeps */
+static uint32_t host_activity;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Takes the CPU for the main thread, which runs until the scheduler starts */
+__attribute__((constructor)) static void host_rtos_init(void)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&host_cond, &attr);
+    clock_gettime(CLOCK_MONOTONIC, &host_epoch);
+    pthread_mutex_lock(&host_cpu);
+}
+
+void host_assert(const char *file, int line)
+{
+    fprintf(stderr, "assertion failed at %s:%d\n", file, line);
+    fflush(stdout);
+    abort();
+}
+
+void host_cpu_lock(void)
+{
+    pthread_mutex_lock(&host_cpu);
+}
+
+void host_cpu_unlock(void)
+{
+    pthread_cond_broadcast(&host_cond);
+    pthread_mutex_unlock(&host_cpu);
+}
+
+static void host_deadline(TickType_t ticks, struct timespec *p_ts)
+{
+    clock_gettime(CLOCK_MONOTONIC, p_ts);
+    p_ts->tv_sec  += ticks / 1000;
+    p_ts->tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (p_ts->tv_nsec >= 1000000000L)
+    {
+        p_ts->tv_sec++;
+        p_ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/* Gives up the CPU until woken or until the deadline passes. Returns 0 on timeout. */
+static int host_block(TickType_t ticks, const struct timespec *p_deadline)
+{
+    int woken = 1;
+
+    if (0 == ticks)
+    {
+        return 0;
+    }
+    if (portMAX_DELAY == ticks)
+    {
+        pthread_cond_wait(&host_cond, &host_cpu);
+    }
+    else
+    {
+        woken = (ETIMEDOUT == pthread_cond_timedwait(&host_cond, &host_cpu, p_deadline)) ? 0 : 1;
+    }
+    host_activity++;
+    return woken;
+}
+
+static void *host_task_entry(void *p_arg)
+{
+    struct host_task *p_task = p_arg;
+
+    pthread_mutex_lock(&host_cpu);
+    host_self = p_task;
+    while (!host_started)
+    {
+        pthread_cond_wait(&host_cond, &host_cpu);
+    }
+    p_task->p_fn(p_task->p_arg);
+    host_cpu_unlock();
+    return NULL;
+}
+
+void host_scheduler_start(void)
+{
+    host_started = 1;
+    pthread_cond_broadcast(&host_cond);
+}
+
+void host_run(uint32_t ms)
+{
+    host_scheduler_start();
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void host_wait_quiet(uint32_t ms)
+{
+    uint32_t activity;
+
+    do
+    {
+        struct timespec deadline;
+
+        activity = host_activity;
+        host_deadline(ms, &deadline);
+        while (ETIMEDOUT != pthread_cond_timedwait(&host_cond, &host_cpu, &deadline))
+        {
+        }
+    } while (activity != host_activity);
+}
+
+void host_isr_wait_idle(void)
+{
+    while ((NULL != host_isr_task) &&
+           !(host_isr_task->notify_waiting && (0 == host_isr_task->notify_value)))
+    {
+        pthread_cond_wait(&host_cond, &host_cpu);
+    }
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t p_fn, const char *p_name, uint32_t stack_depth,
+                               void *p_arg, UBaseType_t priority, StackType_t *p_stack,
+                               StaticTask_t *p_tcb)
+{
+    struct host_task *p_task;
+
+    (void)stack_depth;
+    (void)p_stack;
+    configASSERT(host_task_count < HOST_MAX_TASKS);
+    p_task = &host_tasks[host_task_count];
+    p_task->p_fn     = p_fn;
+    p_task->p_arg    = p_arg;
+    p_task->p_name   = p_name;
+    p_task->priority = priority;
+    p_task->number   = ++host_task_count;
+    p_tcb->p_host    = p_task;
+    pthread_create(&p_task->thread, NULL, host_task_entry, p_task);
+    return p_task;
+}
+
+void vTaskStartScheduler(void)
+{
+    host_scheduler_start();
+    for (;;)
+    {
+        pthread_cond_wait(&host_cond, &host_cpu);
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (TickType_t)((now.tv_sec - host_epoch.tv_sec) * 1000 +
+                        (now.tv_nsec - host_epoch.tv_nsec) / 1000000L);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec deadline;
+
+    host_deadline(ticks, &deadline);
+    while (host_block(ticks, &deadline))
+    {
+    }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return host_self;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    switch (action)
+    {
+    case eSetBits:
+        task->notify_value |= value;
+        break;
+    case eIncrement:
+        task->notify_value++;
+        break;
+    case eSetValueWithOverwrite:
+        task->notify_value = value;
+        break;
+    default:
+        break;
+    }
+    task->notify_pending = 1;
+    pthread_cond_broadcast(&host_cond);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t *p_woken)
+{
+    if (NULL != p_woken)
+    {
+        *p_woken = pdTRUE;
+    }
+    host_isr_task = task;
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *p_woken)
+{
+    (void)xTaskNotifyFromISR(task, 0, eIncrement, p_woken);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *p_value,
+                           TickType_t ticks)
+{
+    struct host_task *p_task = host_self;
+    struct timespec deadline;
+    BaseType_t result = pdTRUE;
+
+    if (!p_task->notify_pending)
+    {
+        p_task->notify_value &= ~clear_on_entry;
+    }
+    host_deadline(ticks, &deadline);
+    p_task->notify_waiting = 1;
+    while (!p_task->notify_pending)
+    {
+        if (!host_block(ticks, &deadline))
+        {
+            result = p_task->notify_pending ? pdTRUE : pdFALSE;
+            break;
+        }
+    }
+    p_task->notify_waiting = 0;
+    if (NULL != p_value)
+    {
+        *p_value = p_task->notify_value;
+    }
+    if (pdTRUE == result)
+    {
+        p_task->notify_value &= ~clear_on_exit;
+    }
+    p_task->notify_pending = 0;
+    return result;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    struct host_task *p_task = host_self;
+    struct timespec deadline;
+    uint32_t value;
+
+    host_deadline(ticks, &deadline);
+    p_task->notify_waiting = 1;
+    pthread_cond_broadcast(&host_cond);
+    while (0 == p_task->notify_value)
+    {
+        if (!host_block(ticks, &deadline))
+        {
+            break;
+        }
+    }
+    p_task->notify_waiting = 0;
+    value = p_task->notify_value;
+    if (0 != value)
+    {
+        p_task->notify_value = clear ? 0 : (value - 1);
+    }
+    p_task->notify_pending = 0;
+    return value;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *p_status, UBaseType_t size,
+                                 uint32_t *p_total_run_time)
+{
+    UBaseType_t i;
+
+    for (i = 0; (i < host_task_count) && (i < size); i++)
+    {
+        p_status[i].xHandle           = &host_tasks[i];
+        p_status[i].pcTaskName        = host_tasks[i].p_name;
+        p_status[i].xTaskNumber       = host_tasks[i].number;
+        p_status[i].uxCurrentPriority = host_tasks[i].priority;
+    }
+    if (NULL != p_total_run_time)
+    {
+        *p_total_run_time = 0;
+    }
+    return i;
+}
+
+static struct host_queue *host_queue_new(host_queue_type_t type, UBaseType_t length,
+                                         UBaseType_t item_size, uint8_t *p_storage,
+                                         StaticQueue_t *p_buffer)
+{
+    struct host_queue *p_queue;
+
+    configASSERT(host_queue_count < HOST_MAX_QUEUES);
+    p_queue = &host_queues[host_queue_count++];
+    p_queue->type      = type;
+    p_queue->p_storage = p_storage;
+    p_queue->length    = length;
+    p_queue->item_size = item_size;
+    p_buffer->p_host   = p_queue;
+    return p_queue;
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t *p_storage,
+                                 StaticQueue_t *p_queue)
+{
+    return host_queue_new(HOST_QUEUE, length, item_size, p_storage, p_queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *p_item, TickType_t ticks)
+{
+    struct timespec deadline;
+
+    host_deadline(ticks, &deadline);
+    while (queue->count == queue->length)
+    {
+        if (!host_block(ticks, &deadline))
+        {
+            return pdFAIL;
+        }
+    }
+    memcpy(&queue->p_storage[((queue->head + queue->count) % queue->length) * queue->item_size],
+           p_item, queue->item_size);
+    queue->count++;
+    pthread_cond_broadcast(&host_cond);
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *p_item, BaseType_t *p_woken)
+{
+    if (NULL != p_woken)
+    {
+        *p_woken = pdTRUE;
+    }
+    return xQueueSend(queue, p_item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *p_item, TickType_t ticks)
+{
+    struct timespec deadline;
+
+    host_deadline(ticks, &deadline);
+    while (0 == queue->count)
+    {
+        if (!host_block(ticks, &deadline))
+        {
+            return pdFAIL;
+        }
+    }
+    memcpy(p_item, &queue->p_storage[queue->head * queue->item_size], queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_broadcast(&host_cond);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *p_buffer)
+{
+    struct host_queue *p_sem = host_queue_new(HOST_MUTEX, 1, 0, NULL, p_buffer);
+
+    p_sem->count = 1;
+    return p_sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *p_buffer)
+{
+    return host_queue_new(HOST_BINARY, 1, 0, NULL, p_buffer);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    struct timespec deadline;
+
+    host_deadline(ticks, &deadline);
+    while (0 == sem->count)
+    {
+        if (!host_block(ticks, &deadline))
+        {
+            return pdFAIL;
+        }
+    }
+    sem->count = 0;
+    return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (0 != sem->count)
+    {
+        return pdFAIL;
+    }
+    sem->count = 1;
+    pthread_cond_broadcast(&host_cond);
+    return pdPASS;
+}
+
+/* Timer service: runs expired callbacks with the CPU held, like the daemon task */
+static void *host_timer_entry(void *p_arg)
+{
+    (void)p_arg;
+    pthread_mutex_lock(&host_cpu);
+    while (!host_started)
+    {
+        pthread_cond_wait(&host_cond, &host_cpu);
+    }
+    for (;;)
+    {
+        struct host_timer *p_next = NULL;
+        TickType_t now = xTaskGetTickCount();
+
+        for (UBaseType_t i = 0; i < host_timer_count; i++)
+        {
+            struct host_timer *p_timer = &host_timers[i];
+
+            if (p_timer->active &&
+                ((NULL == p_next) || ((int32_t)(p_timer->expiry - p_next->expiry) < 0)))
+            {
+                p_next = p_timer;
+            }
+        }
+        if ((NULL != p_next) && ((int32_t)(now - p_next->expiry) >= 0))
+        {
+            if (p_next->auto_reload)
+            {
+                p_next->expiry += p_next->period;
+            }
+            else
+            {
+                p_next->active = 0;
+            }
+            p_next->p_cback(p_next);
+        }
+        else if (NULL != p_next)
+        {
+            struct timespec deadline;
+
+            host_deadline(p_next->expiry - now, &deadline);
+            (void)host_block(p_next->expiry - now, &deadline);
+        }
+        else
+        {
+            (void)host_block(portMAX_DELAY, NULL);
+        }
+    }
+    return NULL;
+}
+
+TimerHandle_t xTimerCreateStatic(const char *p_name, TickType_t period, UBaseType_t auto_reload,
+                                 void *p_id, TimerCallbackFunction_t p_cback,
+                                 StaticTimer_t *p_buffer)
+{
+    struct host_timer *p_timer;
+
+    (void)p_name;
+    configASSERT(host_timer_count < HOST_MAX_TIMERS);
+    if (0 == host_timer_count)
+    {
+        pthread_create(&host_timer_thread, NULL, host_timer_entry, NULL);
+    }
+    p_timer = &host_timers[host_timer_count++];
+    p_timer->p_cback     = p_cback;
+    p_timer->p_id        = p_id;
+    p_timer->period      = period;
+    p_timer->auto_reload = auto_reload;
+    p_buffer->p_host     = p_timer;
+    return p_timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks)
+{
+    (void)ticks;
+    timer->expiry = xTaskGetTickCount() + timer->period;
+    timer->active = 1;
+    pthread_cond_broadcast(&host_cond);
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks)
+{
+    (void)ticks;
+    timer->active = 0;
+    pthread_cond_broadcast(&host_cond);
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks)
+{
+    timer->period = period;
+    return xTimerStart(timer, ticks);
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer)
+{
+    return timer->p_id;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,268 @@
+/******************************************************************************
+* File Name: hal_host.c
+*
+* Description: Host implementation of the BSP and HAL drivers used by the
+* application. The debug UART reads stdin line by line and writes stdout, flash is
+* the constant data of the program made writable, and the cycle counter follows
+* the host clock at the SystemCoreClock rate.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+#include "cybsp_bt_config.h"
+#include "cycfg_bt_settings.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define HOST_UART_RX_SIZE                (1024)
+#define HOST_FLASH_PAGE_SIZE             (512)
+
+/* Bytes handed to the receive interrupt at a time, like a hardware FIFO at
+ * the trigger level, so a long line doesn't overrun the console ring */
+#define HOST_UART_FIFO_SIZE              (16)
+
+/* Input is held back until the tasks have been quiet for this long, like a
+ * user waiting for the output to settle before typing */
+#define HOST_UART_QUIET_MS               (50)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+uint32_t SystemCoreClock = 100000000UL;
+
+CoreDebug_Type host_core_debug;
+__thread uint32_t host_exclusive_value;
+
+cyhal_uart_t cy_retarget_io_uart_obj;
+const cybt_platform_config_t cybsp_bt_platform_cfg;
+const wiced_bt_cfg_settings_t wiced_bt_cfg_settings;
+
+static DWT_Type host_dwt_regs;
+
+static cyhal_uart_event_callback_t host_uart_cback;
+static void *host_uart_cback_arg;
+static pthread_t host_uart_thread;
+static int host_uart_running;
+static uint8_t host_uart_rx[HOST_UART_RX_SIZE];
+static uint32_t host_uart_rx_head;
+static uint32_t host_uart_rx_tail;
+
+static uint32_t host_trng_state = 0x2545F491UL;
+
+/* Covers the whole address space the store can see on the host */
+static const cyhal_flash_block_info_t host_flash_block =
+{
+    .start_address = 0,
+    .size          = 0xFFFFFFFFUL,
+    .sector_size   = HOST_FLASH_PAGE_SIZE,
+    .page_size     = HOST_FLASH_PAGE_SIZE,
+    .erase_value   = 0x00
+};
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+DWT_Type *host_dwt(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    host_dwt_regs.CYCCNT = (uint32_t)((uint64_t)now.tv_sec * SystemCoreClock +
+                                      (uint64_t)now.tv_nsec * (SystemCoreClock / 1000000UL) /
+                                      1000UL);
+    return &host_dwt_regs;
+}
+
+cy_rslt_t cybsp_init(void)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cy_retarget_io_init(int32_t tx, int32_t rx, uint32_t baudrate)
+{
+    (void)tx;
+    (void)rx;
+    (void)baudrate;
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return CY_RSLT_SUCCESS;
+}
+
+void cybt_platform_config_init(const cybt_platform_config_t *p_bt_platform_cfg)
+{
+    (void)p_bt_platform_cfg;
+}
+
+/* Delivers stdin a line at a time, as if typed once the application is
+ * quiet, and waits for the console to take each FIFO load. The program exits at
+ * the end of the input. */
+static void *host_uart_entry(void *p_arg)
+{
+    char line[HOST_UART_RX_SIZE / 2];
+
+    (void)p_arg;
+    while (NULL != fgets(line, sizeof(line), stdin))
+    {
+        host_cpu_lock();
+        host_wait_quiet(HOST_UART_QUIET_MS);
+        for (size_t i = 0; '\0' != line[i]; i++)
+        {
+            host_uart_rx[host_uart_rx_head++ % HOST_UART_RX_SIZE] = (uint8_t)line[i];
+            if (('\0' == line[i + 1]) || (0 == ((i + 1) % HOST_UART_FIFO_SIZE)))
+            {
+                host_uart_cback(host_uart_cback_arg, CYHAL_UART_IRQ_RX_NOT_EMPTY);
+                host_isr_wait_idle();
+            }
+        }
+        host_cpu_unlock();
+    }
+
+    host_cpu_lock();
+    host_isr_wait_idle();
+    host_wait_quiet(HOST_UART_QUIET_MS);
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+    return NULL;
+}
+
+void cyhal_uart_register_callback(cyhal_uart_t *obj, cyhal_uart_event_callback_t callback,
+                                  void *callback_arg)
+{
+    (void)obj;
+    host_uart_cback     = callback;
+    host_uart_cback_arg = callback_arg;
+}
+
+void cyhal_uart_enable_event(cyhal_uart_t *obj, cyhal_uart_event_t event, uint8_t intr_priority,
+                             bool enable)
+{
+    (void)obj;
+    (void)intr_priority;
+    if (enable && (0 != (event & CYHAL_UART_IRQ_RX_NOT_EMPTY)) && !host_uart_running)
+    {
+        host_uart_running = 1;
+        pthread_create(&host_uart_thread, NULL, host_uart_entry, NULL);
+    }
+}
+
+uint32_t cyhal_uart_readable(cyhal_uart_t *obj)
+{
+    (void)obj;
+    return host_uart_rx_head - host_uart_rx_tail;
+}
+
+cy_rslt_t cyhal_uart_getc(cyhal_uart_t *obj, uint8_t *value, uint32_t timeout)
+{
+    (void)obj;
+    (void)timeout;
+    if (host_uart_rx_head == host_uart_rx_tail)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+    *value = host_uart_rx[host_uart_rx_tail++ % HOST_UART_RX_SIZE];
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_uart_write(cyhal_uart_t *obj, void *tx, size_t *tx_length)
+{
+    (void)obj;
+    *tx_length = fwrite(tx, 1, *tx_length, stdout);
+    fflush(stdout);
+    return CY_RSLT_SUCCESS;
+}
+
+cy_rslt_t cyhal_flash_init(cyhal_flash_t *obj)
+{
+    (void)obj;
+    return CY_RSLT_SUCCESS;
+}
+
+void cyhal_flash_get_info(const cyhal_flash_t *obj, cyhal_flash_info_t *info)
+{
+    (void)obj;
+    info->block_count = 1;
+    info->blocks      = &host_flash_block;
+}
+
+/* Programs one page. The page sits in read-only data, so it is made writable first. */
+cy_rslt_t cyhal_flash_write(cyhal_flash_t *obj, uint32_t address, const uint32_t *data)
+{
+    uintptr_t os_page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)address & ~(os_page - 1);
+    uintptr_t end = ((uintptr_t)address + HOST_FLASH_PAGE_SIZE + os_page - 1) & ~(os_page - 1);
+
+    (void)obj;
+    if (0 != mprotect((void *)start, end - start, PROT_READ | PROT_WRITE))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+    memcpy((void *)(uintptr_t)address, data, HOST_FLASH_PAGE_SIZE);
+    return CY_RSLT_SUCCESS;
+}
+
+void host_trng_seed(uint32_t seed)
+{
+    host_trng_state = (0 != seed) ? seed : 1;
+}
+
+cy_rslt_t cyhal_trng_init(cyhal_trng_t *obj)
+{
+    (void)obj;
+    return CY_RSLT_SUCCESS;
+}
+
+/* xorshift32 */
+uint32_t cyhal_trng_generate(const cyhal_trng_t *obj)
+{
+    (void)obj;
+    host_trng_state ^= host_trng_state << 13;
+    host_trng_state ^= host_trng_state >> 17;
+    host_trng_state ^= host_trng_state << 5;
+    return host_trng_state;
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,85 @@
+/******************************************************************************
+* File Name: task.h
+*
+* Description: Host stand-in for the FreeRTOS task API
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef __HOST_TASK_H__
+#define __HOST_TASK_H__
+
+#include "FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum
+{
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+}eNotifyAction;
+
+typedef struct
+{
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    UBaseType_t uxCurrentPriority;
+}TaskStatus_t;
+
+TaskHandle_t xTaskCreateStatic      (TaskFunction_t p_fn, const char *p_name, uint32_t stack_depth,
+                                     void *p_arg, UBaseType_t priority, StackType_t *p_stack,
+                                     StaticTask_t *p_tcb);
+void         vTaskStartScheduler    (void);
+TickType_t   xTaskGetTickCount      (void);
+TickType_t   xTaskGetTickCountFromISR (void);
+void         vTaskDelay             (TickType_t ticks);
+BaseType_t   xTaskNotify            (TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t   xTaskNotifyFromISR     (TaskHandle_t task, uint32_t value, eNotifyAction action,
+                                     BaseType_t *p_woken);
+BaseType_t   xTaskNotifyWait        (uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                     uint32_t *p_value, TickType_t ticks);
+BaseType_t   xTaskNotifyGive        (TaskHandle_t task);
+void         vTaskNotifyGiveFromISR (TaskHandle_t task, BaseType_t *p_woken);
+uint32_t     ulTaskNotifyTake       (BaseType_t clear, TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle (void);
+UBaseType_t  uxTaskGetSystemState   (TaskStatus_t *p_status, UBaseType_t size,
+                                     uint32_t *p_total_run_time);
+
+#endif      /* __HOST_TASK_H__ */
+
+
+/* [] END OF FILE */
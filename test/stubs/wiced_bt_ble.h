@@ -0,0 +1,128 @@
+/******************************************************************************
+* File Name: wiced_bt_ble.h
+*
+* Description: Host stand-in for the BTSTACK LE advertising and observer API
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef __HOST_WICED_BT_BLE_H__
+#define __HOST_WICED_BT_BLE_H__
+
+#include "wiced_bt_types.h"
+
+typedef enum
+{
+    SET_ADVT_PARAM_MULTI = 1,
+    SET_ADVT_DATA_MULTI,
+    SET_SCAN_RESP_DATA_MULTI,
+    SET_RANDOM_ADDR_MULTI,
+    SET_ADVT_ENABLE_MULTI
+}wiced_bt_multi_adv_opcodes_t;
+
+typedef enum
+{
+    MULTI_ADVERT_CONNECTABLE_UNDIRECT_EVENT = 0,
+    MULTI_ADVERT_CONNECTABLE_DIRECT_EVENT   = 1,
+    MULTI_ADVERT_DISCOVERABLE_EVENT         = 2,
+    MULTI_ADVERT_NONCONNECTABLE_EVENT       = 3,
+    MULTI_ADVERT_LOW_DUTY_CYCLE_DIRECT_EVENT = 4
+}wiced_bt_ble_multi_advert_type_t;
+
+typedef enum
+{
+    BTM_BLE_ADV_POLICY_ACCEPT_CONN_AND_SCAN = 0
+}wiced_bt_ble_advert_filter_policy_t;
+
+#define MULTI_ADV_TX_POWER_MIN_INDEX     (0)
+#define MULTI_ADV_TX_POWER_MAX_INDEX     (4)
+
+#define MULTI_ADVERT_STOP                (0)
+#define MULTI_ADVERT_START               (1)
+
+#define BTM_BLE_ADVERT_CHNL_37           (0x01)
+#define BTM_BLE_ADVERT_CHNL_38           (0x02)
+#define BTM_BLE_ADVERT_CHNL_39           (0x04)
+
+#define BTM_BLE_ADVERT_TYPE_FLAG                 (0x01)
+#define BTM_BLE_ADVERT_TYPE_16SRV_COMPLETE       (0x03)
+#define BTM_BLE_ADVERT_TYPE_SERVICE_DATA         (0x16)
+#define BTM_BLE_ADVERT_TYPE_MANUFACTURER         (0xFF)
+
+#define BTM_BLE_GENERAL_DISCOVERABLE_FLAG        (0x02)
+#define BTM_BLE_BREDR_NOT_SUPPORTED              (0x04)
+
+typedef int8_t  wiced_bt_ble_adv_tx_power_t;
+typedef uint8_t wiced_bt_ble_advert_type_t;
+typedef uint8_t wiced_bt_ble_advert_chnl_map_t;
+typedef uint8_t wiced_bt_ble_address_type_t;
+
+typedef struct
+{
+    uint16_t adv_int_min;
+    uint16_t adv_int_max;
+    wiced_bt_ble_multi_advert_type_t adv_type;
+    wiced_bt_ble_advert_chnl_map_t channel_map;
+    wiced_bt_ble_advert_filter_policy_t adv_filter_policy;
+    wiced_bt_ble_adv_tx_power_t adv_tx_power;
+    wiced_bt_device_address_t peer_bd_addr;
+    wiced_bt_ble_address_type_t peer_addr_type;
+    wiced_bt_device_address_t own_bd_addr;
+    wiced_bt_ble_address_type_t own_addr_type;
+}wiced_bt_ble_multi_adv_params_t;
+
+typedef struct
+{
+    wiced_bt_device_address_t remote_bd_addr;
+    uint8_t ble_addr_type;
+    uint8_t ble_evt_type;
+    int8_t rssi;
+    uint8_t flag;
+}wiced_bt_ble_scan_results_t;
+
+typedef void (wiced_bt_ble_scan_result_cback_t)(wiced_bt_ble_scan_results_t *p_scan_result,
+                                                uint8_t *p_adv_data);
+
+wiced_result_t wiced_set_multi_advertisement_data   (uint8_t *p_data, uint8_t data_len,
+                                                     uint8_t adv_instance);
+wiced_result_t wiced_set_multi_advertisement_params (uint8_t adv_instance,
+                                                     wiced_bt_ble_multi_adv_params_t *p_param);
+wiced_result_t wiced_start_multi_advertisements     (uint8_t advertising_enable,
+                                                     uint8_t adv_instance);
+wiced_result_t wiced_bt_ble_observe                 (wiced_bool_t start, uint8_t duration,
+                                                     wiced_bt_ble_scan_result_cback_t *p_cback);
+
+#endif      /* __HOST_WICED_BT_BLE_H__ */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,77 @@
+/******************************************************************************
+* File Name: wiced_bt_dev.h
+*
+* Description: Host stand-in for the BTSTACK device management API
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef __HOST_WICED_BT_DEV_H__
+#define __HOST_WICED_BT_DEV_H__
+
+#include "wiced_bt_ble.h"
+
+typedef uint8_t wiced_bt_management_evt_t;
+
+enum
+{
+    BTM_ENABLED_EVT             = 0,
+    BTM_MULTI_ADVERT_RESP_EVENT = 30
+};
+
+typedef struct
+{
+    wiced_result_t status;
+}wiced_bt_dev_enabled_t;
+
+typedef struct
+{
+    uint8_t status;
+    uint8_t opcode;
+}wiced_bt_ble_multi_adv_response_t;
+
+typedef union
+{
+    wiced_bt_dev_enabled_t enabled;
+    wiced_bt_ble_multi_adv_response_t ble_multi_adv_response_event;
+}wiced_bt_management_evt_data_t;
+
+typedef wiced_result_t (wiced_bt_management_cback_t)(wiced_bt_management_evt_t event,
+                                                     wiced_bt_management_evt_data_t *p_event_data);
+
+void wiced_bt_dev_read_local_addr(wiced_bt_device_address_t bd_addr);
+
+#endif      /* __HOST_WICED_BT_DEV_H__ */
+
+
+/* [] END OF FILE */
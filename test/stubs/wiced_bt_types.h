@@ -0,0 +1,78 @@
+/******************************************************************************
+* File Name: wiced_bt_types.h
+*
+* Description: Host stand-in for the BTSTACK base types
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef __HOST_WICED_BT_TYPES_H__
+#define __HOST_WICED_BT_TYPES_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef uint32_t wiced_result_t;
+typedef uint32_t wiced_bt_dev_status_t;
+typedef uint8_t  wiced_bool_t;
+
+#define WICED_TRUE                       (1)
+#define WICED_FALSE                      (0)
+
+#define WICED_SUCCESS                    (0)
+#define WICED_ERROR                      (4)
+#define WICED_BADARG                     (5)
+
+#define WICED_BT_SUCCESS                 (0)
+#define WICED_BT_PENDING                 (0x8005)
+#define WICED_BT_BADARG                  (0x8006)
+#define WICED_BT_NO_RESOURCES            (0x8007)
+#define WICED_BT_ERROR                   (0x8008)
+#define WICED_BT_UNSUPPORTED             (0x8009)
+#define WICED_BT_WRONG_MODE              (0x800A)
+#define WICED_BT_BUSY                    (0x800B)
+#define WICED_BT_TIMEOUT                 (0x800C)
+
+#define BD_ADDR_LEN                      (6)
+#define LEN_UUID_16                      (2)
+#define LEN_UUID_128                     (16)
+
+typedef uint8_t wiced_bt_device_address_t[BD_ADDR_LEN];
+
+#define BIT16_TO_8(val)                  (uint8_t)(val), (uint8_t)((val) >> 8)
+
+#endif      /* __HOST_WICED_BT_TYPES_H__ */
+
+
+/* [] END OF FILE */
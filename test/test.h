@@ -0,0 +1,91 @@
+/******************************************************************************
+* File Name: test.h
+*
+* Description: Checks and timing helpers shared by the host tests
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Counts failed checks, a test exits with a failure status if any failed */
+extern int test_failures;
+
+#define CHECK(cond)                                                             \
+    do                                                                          \
+    {                                                                           \
+        if (!(cond))                                                            \
+        {                                                                       \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+            test_failures++;                                                    \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                          \
+    do                                                                          \
+    {                                                                           \
+        long long check_a = (long long)(a);                                     \
+        long long check_b = (long long)(b);                                     \
+        if (check_a != check_b)                                                 \
+        {                                                                       \
+            printf("%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__,  \
+                   __LINE__, #a, #b, check_a, check_b);                         \
+            test_failures++;                                                    \
+        }                                                                       \
+    } while (0)
+
+/* Defines test_failures and reports the result from main */
+#define TEST_MAIN_DEFINE()              int test_failures
+#define TEST_RESULT()                                                           \
+    (printf("%s: %s\n", __FILE__, (0 == test_failures) ? "passed" : "FAILED"),  \
+     (0 == test_failures) ? EXIT_SUCCESS : EXIT_FAILURE)
+
+/* Monotonic host time in nanoseconds, for benchmarks */
+static inline uint64_t test_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+#endif      /* __TEST_H__ */
+
+
+/* [] END OF FILE */
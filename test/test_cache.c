@@ -0,0 +1,299 @@
+/******************************************************************************
+* File Name: test_cache.c
+*
+* Description: Host tests and benchmarks of the observed beacon cache:
+* aggregation, ageing, and insert, lookup and eviction at 10k distinct beacons
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "../beacon_cache.c"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_BEACONS                     (10000)
+#define TEST_LOOKUP_ROUNDS               (100)
+#define TEST_NEWCOMERS                   (5000)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static beacon_cache_t        cache;
+static beacon_cache_record_t records[BEACON_CACHE_SIZE];
+
+static const beacon_frame_info_t info =
+{
+    .format         = BEACON_FORMAT_IBEACON,
+    .measured_power = -59,
+};
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+static void test_addr(uint32_t n, wiced_bt_device_address_t bd_addr)
+{
+    bd_addr[0] = 0xC0;
+    bd_addr[1] = 0x01;
+    bd_addr[2] = (uint8_t)(n >> 24);
+    bd_addr[3] = (uint8_t)(n >> 16);
+    bd_addr[4] = (uint8_t)(n >> 8);
+    bd_addr[5] = (uint8_t)n;
+}
+
+/* Every occupied entry must be reachable and the use count must match */
+static void test_consistent(void)
+{
+    uint16_t used = 0;
+
+    for (uint32_t i = 0; i < BEACON_CACHE_SIZE; i++)
+    {
+        if (cache.entry[i].in_use)
+        {
+            used++;
+            CHECK(&cache.entry[i] ==
+                  beacon_cache_lookup(&cache, cache.entry[i].bd_addr, cache.entry[i].frame_id));
+        }
+    }
+    CHECK_EQ(used, cache.used);
+    CHECK(cache.used <= BEACON_CACHE_MAX_LOAD);
+}
+
+/* Repeated reports of a small population collapse into one record each */
+static void test_aggregation(void)
+{
+    wiced_bt_device_address_t bd_addr;
+    uint32_t frame_id = beacon_cache_frame_id(&info);
+    uint32_t now = 0;
+    uint16_t n;
+
+    beacon_cache_init(&cache);
+    for (uint32_t round = 0; round < 1000; round++)
+    {
+        for (uint32_t beacon = 0; beacon < 20; beacon++)
+        {
+            test_addr(beacon, bd_addr);
+            beacon_cache_update(&cache, bd_addr, &info, -70, now++);
+        }
+    }
+    test_consistent();
+    CHECK_EQ(cache.used, 20);
+    CHECK_EQ(cache.inserts, 20);
+    CHECK_EQ(cache.reports, 20000);
+
+    test_addr(7, bd_addr);
+    CHECK(NULL != beacon_cache_lookup(&cache, bd_addr, frame_id));
+
+    n = beacon_cache_flush(&cache, now, records, BEACON_CACHE_SIZE);
+    CHECK_EQ(n, 20);
+    for (uint16_t i = 0; i < n; i++)
+    {
+        CHECK_EQ(records[i].count, 1000);
+        CHECK_EQ(records[i].rssi, -70);
+    }
+
+    /* Counts restart with the period, the beacons stay cached */
+    CHECK_EQ(beacon_cache_flush(&cache, now, records, BEACON_CACHE_SIZE), 0);
+    CHECK_EQ(cache.used, 20);
+}
+
+/* The smoothed RSSI follows a step within a few time constants */
+static void test_ewma(void)
+{
+    wiced_bt_device_address_t bd_addr;
+    beacon_cache_entry_t *p_entry = NULL;
+
+    beacon_cache_init(&cache);
+    test_addr(1, bd_addr);
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        p_entry = beacon_cache_update(&cache, bd_addr, &info, -80, i);
+    }
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        p_entry = beacon_cache_update(&cache, bd_addr, &info, -50, 8 + i);
+    }
+    CHECK(NULL != p_entry);
+    CHECK((p_entry->rssi_q8 >> BEACON_CACHE_RSSI_FRAC_BITS) >= -51);
+}
+
+/* Only beacons not seen for BEACON_CACHE_AGE_MS leave on a flush */
+static void test_ageing(void)
+{
+    wiced_bt_device_address_t bd_addr;
+    uint32_t late = BEACON_CACHE_AGE_MS * 3;
+
+    beacon_cache_init(&cache);
+    for (uint32_t i = 0; i < 40; i++)
+    {
+        test_addr(i, bd_addr);
+        beacon_cache_update(&cache, bd_addr, &info, -70, (i < 20) ? 0 : late);
+    }
+    (void)beacon_cache_flush(&cache, late + 5, records, BEACON_CACHE_SIZE);
+    test_consistent();
+    CHECK_EQ(cache.used, 20);
+    CHECK_EQ(cache.evict_age, 20);
+}
+
+/* At the load limit a newcomer replaces the least recently seen beacon of
+ * the BEACON_CACHE_MAX_PROBE slots from its home, also past a free home */
+static void test_eviction(void)
+{
+    wiced_bt_device_address_t bd_addr;
+    wiced_bt_device_address_t oldest;
+    uint32_t frame_id = beacon_cache_frame_id(&info);
+    uint32_t free_home = 0;
+    uint32_t dropped;
+    uint32_t home;
+    beacon_cache_entry_t *p_entry;
+    beacon_cache_entry_t *p_oldest;
+
+    beacon_cache_init(&cache);
+    srand(1);
+    for (uint32_t i = 0; cache.used < BEACON_CACHE_MAX_LOAD; i++)
+    {
+        test_addr(i, bd_addr);
+        beacon_cache_update(&cache, bd_addr, &info, -70, (uint32_t)rand() % 100000);
+    }
+
+    for (uint32_t i = 0; i < TEST_NEWCOMERS; i++)
+    {
+        test_addr(1000000 + i, bd_addr);
+        home     = beacon_cache_home(bd_addr, frame_id);
+        p_oldest = NULL;
+        for (uint8_t probe = 0; probe < BEACON_CACHE_MAX_PROBE; probe++)
+        {
+            p_entry = &cache.entry[(home + probe) & BEACON_CACHE_INDEX_MASK];
+            if (p_entry->in_use &&
+                ((NULL == p_oldest) || (p_entry->last_seen_ms < p_oldest->last_seen_ms)))
+            {
+                p_oldest = p_entry;
+            }
+        }
+        free_home += cache.entry[home].in_use ? 0 : 1;
+        dropped    = cache.dropped;
+        if (NULL != p_oldest)
+        {
+            memcpy(oldest, p_oldest->bd_addr, BD_ADDR_LEN);
+        }
+
+        beacon_cache_update(&cache, bd_addr, &info, -70, 100000 + i);
+
+        if (NULL == p_oldest)
+        {
+            CHECK_EQ(cache.dropped, dropped + 1);
+            continue;
+        }
+        CHECK(NULL == beacon_cache_lookup(&cache, oldest, frame_id));
+        CHECK(NULL != beacon_cache_lookup(&cache, bd_addr, frame_id));
+        CHECK_EQ(cache.used, BEACON_CACHE_MAX_LOAD);
+    }
+    test_consistent();
+
+    printf("cache: %u newcomers at the load limit, %lu with a free home, %lu replaced, "
+           "%lu dropped\n", TEST_NEWCOMERS, (unsigned long)free_home,
+           (unsigned long)cache.evict_full, (unsigned long)cache.dropped);
+    CHECK(free_home > 0);
+    CHECK(cache.dropped * 1000 < TEST_NEWCOMERS);
+}
+
+/* Insert, lookup and eviction at 10k distinct beacons */
+static void test_bench(void)
+{
+    wiced_bt_device_address_t bd_addr;
+    uint32_t frame_id = beacon_cache_frame_id(&info);
+    uint32_t hits = 0;
+    uint64_t start;
+    uint64_t insert_ns;
+    uint64_t lookup_ns;
+
+    beacon_cache_init(&cache);
+    start = test_now_ns();
+    for (uint32_t i = 0; i < TEST_BEACONS; i++)
+    {
+        test_addr(i, bd_addr);
+        beacon_cache_update(&cache, bd_addr, &info, -70, i);
+    }
+    insert_ns = test_now_ns() - start;
+    test_consistent();
+
+    /* The table stays at its load limit and the newest beacons are resident */
+    CHECK_EQ(cache.used, BEACON_CACHE_MAX_LOAD);
+    CHECK_EQ(cache.inserts + cache.dropped, TEST_BEACONS);
+    CHECK_EQ(cache.inserts - cache.evict_full, BEACON_CACHE_MAX_LOAD);
+    CHECK(cache.dropped * 1000 < TEST_BEACONS);
+    test_addr(TEST_BEACONS - 1, bd_addr);
+    CHECK(NULL != beacon_cache_lookup(&cache, bd_addr, frame_id));
+
+    start = test_now_ns();
+    for (uint32_t round = 0; round < TEST_LOOKUP_ROUNDS; round++)
+    {
+        for (uint32_t i = 0; i < TEST_BEACONS; i++)
+        {
+            test_addr(i, bd_addr);
+            hits += (NULL != beacon_cache_lookup(&cache, bd_addr, frame_id)) ? 1 : 0;
+        }
+    }
+    lookup_ns = test_now_ns() - start;
+    CHECK_EQ(hits, TEST_LOOKUP_ROUNDS * BEACON_CACHE_MAX_LOAD);
+
+    printf("cache: %u beacons into %u entries: %.1f ns/insert, %.1f ns/lookup, "
+           "%lu replaced, %lu dropped\n", TEST_BEACONS, BEACON_CACHE_SIZE,
+           (double)insert_ns / TEST_BEACONS,
+           (double)lookup_ns / (TEST_BEACONS * TEST_LOOKUP_ROUNDS),
+           (unsigned long)cache.evict_full, (unsigned long)cache.dropped);
+
+    /* Everything ages out once the scan stops */
+    (void)beacon_cache_flush(&cache, TEST_BEACONS + BEACON_CACHE_AGE_MS + 1, records,
+                             BEACON_CACHE_SIZE);
+    CHECK_EQ(cache.used, 0);
+    CHECK_EQ(cache.evict_age, BEACON_CACHE_MAX_LOAD);
+}
+
+int main(void)
+{
+    test_aggregation();
+    test_ewma();
+    test_ageing();
+    test_eviction();
+    test_bench();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,286 @@
+/******************************************************************************
+* File Name: test_campaign.c
+*
+* Description: Host tests of the campaign scheduler in accelerated time: two
+* years of transitions compiled from campaign.json run from deadline to
+* deadline across a wrap of the millisecond counter, with late timers and
+* rejected updates, against a linear scan of the table
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "beacon_campaign.h"
+#include "beacon_format.h"
+#include "beacon_power.h"
+#include "beacon_timer.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* The millisecond counter wraps 5 hours into every run */
+#define TEST_START_MS                    (0xFFFFFFFFUL - (5UL * 3600UL * 1000UL))
+
+#define TEST_INSTANCES                   (3)
+#define TEST_FIND_TIMES                  (200000)
+
+/* One deadline in TEST_LATE_ONE_IN fires up to TEST_LATE_MAX_MS late in the
+ * late run, one update in TEST_REJECT_ONE_IN is rejected by the stack */
+#define TEST_LATE_ONE_IN                 (20)
+#define TEST_LATE_MAX_MS                 (7200000UL)
+#define TEST_REJECT_ONE_IN               (50)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static const beacon_campaign_table_t *test_table = &beacon_campaign_table;
+static beacon_slot_t   test_slots[BEACON_SLOT_MAX_INSTANCES];
+
+static uint32_t        test_now_ms;            /* What the application sees */
+static uint64_t        test_sim_ms;            /* Simulated time, not wrapping */
+static beacon_timer_t *test_armed;
+static uint64_t        test_armed_at;
+static wiced_bool_t    test_armed_on;
+static wiced_bool_t    test_reject_next;
+static wiced_bool_t    test_rejected;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+uint32_t beacon_stats_now_ms(void)
+{
+    return test_now_ms;
+}
+
+void beacon_timer_setup(beacon_timer_t *p_timer, beacon_timer_cback_t *p_cback, void *p_arg)
+{
+    p_timer->p_cback = p_cback;
+    p_timer->p_arg   = p_arg;
+}
+
+void beacon_timer_start(beacon_timer_t *p_timer, uint32_t delay_ms)
+{
+    test_armed    = p_timer;
+    test_armed_at = test_sim_ms + delay_ms;
+    test_armed_on = WICED_TRUE;
+}
+
+void beacon_timer_stop(beacon_timer_t *p_timer)
+{
+    test_armed_on = WICED_FALSE;
+}
+
+beacon_slot_t *beacon_slot_get(uint8_t instance)
+{
+    if ((0 == instance) || (instance > BEACON_SLOT_MAX_INSTANCES))
+    {
+        return NULL;
+    }
+    test_slots[instance - 1].instance = instance;
+    return &test_slots[instance - 1];
+}
+
+wiced_result_t beacon_slot_set_data(beacon_slot_t *p_slot, const uint8_t *p_data, uint8_t len)
+{
+    if (test_reject_next)
+    {
+        test_reject_next = WICED_FALSE;
+        test_rejected    = WICED_TRUE;
+        return WICED_BT_NO_RESOURCES;
+    }
+    memcpy(p_slot->adv_data, p_data, len);
+    p_slot->adv_len = len;
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_format_bind(beacon_slot_t *p_slot, const beacon_format_desc_t *p_desc,
+                                  const beacon_format_value_t *values)
+{
+    return WICED_BT_SUCCESS;
+}
+
+void beacon_power_fix_data(const beacon_slot_t *p_slot, uint8_t *p_data, uint8_t len)
+{
+}
+
+/* Payload of an instance at a time by a linear scan, -1 before its first */
+static int32_t test_reference(uint8_t instance, uint32_t time_s)
+{
+    int32_t payload = -1;
+
+    for (uint32_t i = 0; (i < test_table->num_entries) &&
+                         (test_table->p_entries[i].start_s <= time_s); i++)
+    {
+        if (instance == test_table->p_entries[i].instance)
+        {
+            payload = test_table->p_entries[i].payload;
+        }
+    }
+    return payload;
+}
+
+/* Number of instances not advertising their payload of the time */
+static uint32_t test_mismatches(uint32_t time_s)
+{
+    const beacon_campaign_payload_t *p_payload;
+    uint32_t mismatches = 0;
+    int32_t payload;
+
+    for (uint8_t instance = 1; instance <= TEST_INSTANCES; instance++)
+    {
+        payload = test_reference(instance, time_s);
+        if (payload < 0)
+        {
+            continue;
+        }
+        p_payload = &test_table->p_payloads[payload];
+        mismatches += ((test_slots[instance - 1].adv_len != p_payload->len) ||
+                       (0 != memcmp(test_slots[instance - 1].adv_data, p_payload->data,
+                                    p_payload->len))) ? 1 : 0;
+    }
+    return mismatches;
+}
+
+/* The binary search agrees with a linear search */
+static void test_find(void)
+{
+    const beacon_campaign_entry_t *p_last = &test_table->p_entries[test_table->num_entries - 1];
+    uint32_t first_s = test_table->p_entries[0].start_s - 3600;
+    uint32_t errors = 0;
+    uint32_t linear;
+    uint32_t time_s;
+
+    srand(1);
+    for (uint32_t k = 0; k < TEST_FIND_TIMES; k++)
+    {
+        time_s = first_s + (uint32_t)(((uint64_t)rand() * rand()) %
+                                      (p_last->start_s - first_s + 7200));
+        for (linear = 0; (linear < test_table->num_entries) &&
+                         (test_table->p_entries[linear].start_s <= time_s); linear++)
+        {
+        }
+        errors += (linear != beacon_campaign_find(test_table, time_s)) ? 1 : 0;
+    }
+    CHECK_EQ(errors, 0);
+}
+
+/* Runs the table from start_s to its end, deadline to deadline */
+static void test_run(uint32_t start_s, wiced_bool_t late)
+{
+    const beacon_campaign_stats_t *p_stats = beacon_campaign_get_stats();
+    uint32_t errors = 0;
+    uint32_t checks = 0;
+    uint64_t late_ms = 0;
+    uint64_t due_ms;
+    uint64_t at_ms;
+    uint32_t time_s;
+
+    memset(test_slots, 0, sizeof(test_slots));
+    test_sim_ms   = 0;
+    test_now_ms   = TEST_START_MS;
+    test_armed_on = WICED_FALSE;
+
+    CHECK(WICED_BT_BADARG != beacon_campaign_set_time(test_table, start_s));
+    CHECK_EQ(test_mismatches(start_s), 0);
+
+    while (test_armed_on)
+    {
+        at_ms = test_armed_at;
+        if (late && (0 == (rand() % TEST_LATE_ONE_IN)))
+        {
+            at_ms += (uint64_t)rand() % TEST_LATE_MAX_MS;
+        }
+        test_now_ms += (uint32_t)(at_ms - test_sim_ms);
+        test_sim_ms  = at_ms;
+
+        test_armed_on    = WICED_FALSE;
+        test_rejected    = WICED_FALSE;
+        test_reject_next = (0 == (rand() % TEST_REJECT_ONE_IN)) ? WICED_TRUE : WICED_FALSE;
+        test_armed->p_cback(test_armed);
+        test_reject_next = WICED_FALSE;
+
+        if (test_rejected)
+        {
+            /* Retried on the next deadline */
+            continue;
+        }
+        time_s = start_s + (uint32_t)(test_sim_ms / 1000);
+        checks++;
+        errors += test_mismatches(time_s);
+
+        /* The next deadline is never after its transition */
+        if (test_armed_on && (p_stats->next < test_table->num_entries))
+        {
+            due_ms = (uint64_t)(test_table->p_entries[p_stats->next].start_s - start_s) * 1000;
+            if (test_armed_at > due_ms + late_ms)
+            {
+                late_ms = test_armed_at - due_ms;
+            }
+        }
+    }
+
+    printf("campaign: from %lu, %lu deadlines checked over %.0f days; %lu transitions, "
+           "%lu superseded, %lu rejected so far\n", (unsigned long)start_s, (unsigned long)checks,
+           (double)test_sim_ms / 86400000.0, (unsigned long)p_stats->transitions,
+           (unsigned long)p_stats->superseded, (unsigned long)p_stats->rejected);
+
+    CHECK_EQ(errors, 0);
+    CHECK_EQ(late_ms, 0);
+    CHECK_EQ(p_stats->next, test_table->num_entries);
+    CHECK(checks > 0);
+    if (late)
+    {
+        CHECK(p_stats->superseded > 0);
+    }
+}
+
+int main(void)
+{
+    uint32_t first_s = test_table->p_entries[0].start_s;
+
+    CHECK(test_table->num_entries > 4000);
+    test_find();
+
+    srand(7);
+    test_run(first_s - 3600, WICED_FALSE);
+    test_run(first_s + (uint32_t)(rand() % (200 * 86400)), WICED_FALSE);
+    test_run(first_s + (uint32_t)(rand() % (200 * 86400)), WICED_TRUE);
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
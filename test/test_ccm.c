@@ -0,0 +1,508 @@
+/******************************************************************************
+* File Name: test_ccm.c
+*
+* Description: Host tests of the encrypted sensor frames: AES-CCM against
+* published vectors, frames opened by a receiver with replays and tampering
+* rejected, frame counters that never repeat across resets, and the cost of
+* sealing with and without the frames prepared ahead
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "../beacon_ccm.c"
+#include "beacon_format.h"
+#include "beacon_power.h"
+#include "beacon_store.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_COUNTER                     (1)
+#define TEST_KEY_ID                      (7)
+#define TEST_PLAIN_LEN                   (4)
+#define TEST_FRAMES                      (50)
+#define TEST_BOOTS                       (6)
+#define TEST_BENCH_FRAMES                (1000000)
+
+/* Offsets in the advertising data: flags, AD header, then the frame */
+#define TEST_KEY_ID_OFFSET               (ADV_PKT_FLAG_LENGTH + 1 + 2 + CCM_KEY_ID_OFFSET)
+#define TEST_COUNTER_OFFSET              (ADV_PKT_FLAG_LENGTH + 1 + 2 + CCM_COUNTER_OFFSET)
+#define TEST_CIPHER_OFFSET               (TEST_COUNTER_OFFSET + BEACON_CCM_COUNTER_LEN)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* RFC 3610 packet vector with an 8 octet header and an 8 octet tag */
+typedef struct
+{
+    uint8_t nonce[BEACON_CCM_NONCE_LEN];
+    uint8_t len;                                /* Plaintext after the header */
+    uint8_t result[BEACON_ADV_DATA_MAX + 8];    /* Ciphertext then tag */
+}test_vector_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static const test_vector_t test_rfc3610[] =
+{
+    {
+        { 0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 }, 23,
+        { 0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2, 0xF0, 0x66, 0xD0, 0xC2, 0xC0, 0xF9,
+          0x89, 0x80, 0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84, 0x17, 0xE8, 0xD1, 0x2C, 0xFD,
+          0xF9, 0x26, 0xE0 }
+    },
+    {
+        { 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 }, 24,
+        { 0x72, 0xC9, 0x1A, 0x36, 0xE1, 0x35, 0xF8, 0xCF, 0x29, 0x1C, 0xA8, 0x94, 0x08, 0x5C,
+          0x87, 0xE3, 0xCC, 0x15, 0xC4, 0x39, 0xC9, 0xE4, 0x3A, 0x3B, 0xA0, 0x91, 0xD5, 0x6E,
+          0x10, 0x40, 0x09, 0x16 }
+    },
+    {
+        { 0x00, 0x00, 0x00, 0x05, 0x04, 0x03, 0x02, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 }, 25,
+        { 0x51, 0xB1, 0xE5, 0xF4, 0x4A, 0x19, 0x7D, 0x1D, 0xA4, 0x6B, 0x0F, 0x8E, 0x2D, 0x28,
+          0x2A, 0xE8, 0x71, 0xE8, 0x38, 0xBB, 0x64, 0xDA, 0x85, 0x96, 0x57, 0x4A, 0xDA, 0xA7,
+          0x6F, 0xBD, 0x9F, 0xB0, 0xC5 }
+    },
+};
+
+static const uint8_t test_key[BEACON_CCM_KEY_LEN] =
+{
+    0xc4, 0x27, 0x9e, 0x50, 0x1b, 0xf8, 0x63, 0xad, 0x36, 0x0f, 0xd2, 0x85, 0x7a, 0xe9, 0x14, 0x4b
+};
+
+static beacon_slot_t                   test_slot;
+static wiced_bt_ble_multi_adv_params_t test_params;
+static uint32_t                        test_now_ms;
+static uint8_t                         test_air[BEACON_ADV_DATA_MAX];
+static uint8_t                         test_air_len;
+static uint8_t                         test_sample[TEST_PLAIN_LEN];
+static uint32_t                        test_sample_seq;
+static wiced_bool_t                    test_reserve_fails;
+static uint32_t                        test_reserves;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+wiced_result_t beacon_slot_set_data(beacon_slot_t *p_slot, const uint8_t *p_data, uint8_t len)
+{
+    memcpy(test_air, p_data, len);
+    test_air_len = len;
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_slot_set_params(beacon_slot_t *p_slot,
+                                      const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_slot_start(beacon_slot_t *p_slot, wiced_bool_t start)
+{
+    return WICED_BT_PENDING;
+}
+
+beacon_slot_t *beacon_slot_get(uint8_t instance)
+{
+    return NULL;
+}
+
+wiced_result_t beacon_format_bind(beacon_slot_t *p_slot, const beacon_format_desc_t *p_desc,
+                                  const beacon_format_value_t *values)
+{
+    return WICED_BT_SUCCESS;
+}
+
+wiced_result_t beacon_power_set_range(beacon_slot_t *p_slot, uint32_t range_cm)
+{
+    return WICED_BT_SUCCESS;
+}
+
+uint32_t beacon_stats_now_ms(void)
+{
+    return test_now_ms;
+}
+
+uint32_t beacon_stats_cycles(void)
+{
+    return (uint32_t)(test_now_ns() / 10);
+}
+
+uint32_t beacon_stats_cycles_to_us(uint32_t cycles)
+{
+    return cycles / 100;
+}
+
+void beacon_worker_register(beacon_worker_job_t *p_job, uint32_t slack_ms)
+{
+    (void)p_job;
+}
+
+/* The submit runs in the manager task right after the worker */
+void beacon_manager_defer(beacon_manager_fn_t *p_fn)
+{
+    p_fn();
+}
+
+static void test_read(uint8_t *plain, uint8_t plain_len)
+{
+    test_sample_seq++;
+    for (uint8_t i = 0; i < plain_len; i++)
+    {
+        test_sample[i] = (uint8_t)(test_sample_seq * 31 + i);
+    }
+    memcpy(plain, test_sample, plain_len);
+}
+
+/* The reserve callback of main.c */
+static wiced_bool_t test_reserve(uint32_t limit)
+{
+    test_reserves++;
+    if (test_reserve_fails)
+    {
+        return WICED_FALSE;
+    }
+    return (WICED_BT_SUCCESS == beacon_store_set_counter(TEST_COUNTER, limit)) ?
+           WICED_TRUE : WICED_FALSE;
+}
+
+/* A reset: RAM state is lost, the store is read back from flash */
+static wiced_result_t test_boot(void)
+{
+    beacon_store_init();
+    return beacon_ccm_start(&test_slot, TEST_KEY_ID, test_key,
+                            beacon_store_get_counter(TEST_COUNTER), TEST_PLAIN_LEN, test_read,
+                            test_reserve, &test_params);
+}
+
+/* One period of the worker; returns whether a frame was sent */
+static wiced_bool_t test_frame(void)
+{
+    uint32_t frames = ccm_stats.frames;
+
+    (void)beacon_ccm_job(test_now_ms);
+    test_now_ms += BEACON_CCM_PERIOD_MS;
+    return (frames != ccm_stats.frames) ? WICED_TRUE : WICED_FALSE;
+}
+
+static uint32_t test_frame_counter(void)
+{
+    uint32_t counter = 0;
+
+    for (uint8_t i = 0; i < BEACON_CCM_COUNTER_LEN; i++)
+    {
+        counter |= (uint32_t)test_air[TEST_COUNTER_OFFSET + i] << (8 * i);
+    }
+    return counter;
+}
+
+/* RFC 3610 packet vectors 1 to 3 */
+static void test_vectors(void)
+{
+    beacon_aes_ctx_t aes;
+    uint8_t key[BEACON_AES_KEY_LEN];
+    uint8_t packet[8 + BEACON_ADV_DATA_MAX];
+    uint8_t out[BEACON_ADV_DATA_MAX];
+    uint8_t back[BEACON_ADV_DATA_MAX];
+    uint8_t tag[8];
+    const test_vector_t *p_vec;
+
+    for (uint8_t i = 0; i < BEACON_AES_KEY_LEN; i++)
+    {
+        key[i] = (uint8_t)(0xC0 + i);
+    }
+    for (uint8_t i = 0; i < sizeof(packet); i++)
+    {
+        packet[i] = i;
+    }
+    beacon_aes_init(&aes, key);
+
+    for (uint32_t v = 0; v < sizeof(test_rfc3610) / sizeof(test_rfc3610[0]); v++)
+    {
+        p_vec = &test_rfc3610[v];
+        beacon_ccm_encrypt(&aes, p_vec->nonce, BEACON_CCM_NONCE_LEN, packet, 8, &packet[8],
+                           p_vec->len, out, tag, sizeof(tag));
+        CHECK(0 == memcmp(out, p_vec->result, p_vec->len));
+        CHECK(0 == memcmp(tag, &p_vec->result[p_vec->len], sizeof(tag)));
+
+        CHECK(beacon_ccm_decrypt(&aes, p_vec->nonce, BEACON_CCM_NONCE_LEN, packet, 8, out,
+                                 p_vec->len, back, tag, sizeof(tag)));
+        CHECK(0 == memcmp(back, &packet[8], p_vec->len));
+
+        tag[0] ^= 0x01;
+        CHECK(!beacon_ccm_decrypt(&aes, p_vec->nonce, BEACON_CCM_NONCE_LEN, packet, 8, out,
+                                  p_vec->len, back, tag, sizeof(tag)));
+    }
+}
+
+/* NIST SP 800-38C example 1: 7 octet nonce, 4 octet tag */
+static void test_sp800_38c(void)
+{
+    static const uint8_t nonce[7] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16 };
+    static const uint8_t aad[8]   = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+    static const uint8_t plain[4] = { 0x20, 0x21, 0x22, 0x23 };
+    static const uint8_t cipher[8] = { 0x71, 0x62, 0x01, 0x5b, 0x4d, 0xac, 0x25, 0x5d };
+    beacon_aes_ctx_t aes;
+    uint8_t key[BEACON_AES_KEY_LEN];
+    uint8_t out[4];
+    uint8_t tag[4];
+
+    for (uint8_t i = 0; i < BEACON_AES_KEY_LEN; i++)
+    {
+        key[i] = (uint8_t)(0x40 + i);
+    }
+    beacon_aes_init(&aes, key);
+
+    beacon_ccm_encrypt(&aes, nonce, sizeof(nonce), aad, sizeof(aad), plain, sizeof(plain), out,
+                       tag, sizeof(tag));
+    CHECK(0 == memcmp(out, cipher, 4));
+    CHECK(0 == memcmp(tag, &cipher[4], 4));
+}
+
+/* Frames of the sender open at a receiver once; replayed, tampered and
+ * foreign frames do not */
+static void test_round_trip(void)
+{
+    static const uint8_t other_key[BEACON_CCM_KEY_LEN] = { 0x09 };
+    beacon_ccm_rx_t rx;
+    beacon_ccm_rx_t other;
+    uint8_t plain[BEACON_CCM_PLAIN_MAX];
+    uint8_t old[BEACON_ADV_DATA_MAX];
+    uint8_t tampered[BEACON_ADV_DATA_MAX];
+    uint8_t cold[BEACON_ADV_DATA_MAX];
+    uint8_t old_len = 0;
+    uint8_t cold_len;
+    uint8_t plain_len;
+    uint32_t counter;
+    uint32_t forged;
+
+    beacon_ccm_rx_init(&rx, TEST_KEY_ID, test_key);
+    beacon_ccm_rx_init(&other, TEST_KEY_ID, other_key);
+    CHECK_EQ(test_boot(), WICED_BT_SUCCESS);
+
+    for (uint32_t f = 0; f < TEST_FRAMES; f++)
+    {
+        CHECK(test_frame());
+        CHECK(beacon_ccm_open(&rx, test_air, test_air_len, plain, &plain_len, &counter));
+        CHECK_EQ(plain_len, TEST_PLAIN_LEN);
+        CHECK(0 == memcmp(plain, test_sample, TEST_PLAIN_LEN));
+
+        /* The same frame on the next advertising event */
+        CHECK(!beacon_ccm_open(&rx, test_air, test_air_len, plain, &plain_len, &counter));
+        CHECK(!beacon_ccm_open(&other, test_air, test_air_len, plain, &plain_len, &counter));
+
+        /* A frame prepared ahead equals one sealed from scratch */
+        CHECK(beacon_ccm_seal(&ccm_key, counter, test_sample, TEST_PLAIN_LEN, cold, &cold_len));
+        CHECK((cold_len == test_air_len) && (0 == memcmp(cold, test_air, cold_len)));
+
+        if (10 == f)
+        {
+            memcpy(old, test_air, test_air_len);
+            old_len = test_air_len;
+        }
+    }
+    CHECK_EQ(ccm_stats.late, 1);
+
+    CHECK(!beacon_ccm_open(&rx, old, old_len, plain, &plain_len, &counter));
+    CHECK_EQ(rx.replayed, 1);
+
+    /* Every bit of the counter, ciphertext and tag is authenticated */
+    CHECK(test_frame());
+    for (uint8_t i = TEST_COUNTER_OFFSET; i < test_air_len; i++)
+    {
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            memcpy(tampered, test_air, test_air_len);
+            tampered[i] ^= (uint8_t)(1 << bit);
+            forged = rx.forged + rx.replayed;
+            CHECK(!beacon_ccm_open(&rx, tampered, test_air_len, plain, &plain_len, &counter));
+            CHECK_EQ(rx.forged + rx.replayed, forged + 1);
+        }
+    }
+    CHECK(beacon_ccm_open(&rx, test_air, test_air_len, plain, &plain_len, &counter));
+    CHECK_EQ(other.accepted, 0);
+
+    printf("ccm: %lu frames accepted, %lu replayed, %lu forged\n", (unsigned long)rx.accepted,
+           (unsigned long)rx.replayed, (unsigned long)rx.forged);
+}
+
+/* Resets at any point of a block: the counters, and so the nonces, keep
+ * going up across boots and a receiver never sees one again */
+static void test_resets(void)
+{
+    static const uint32_t frames[TEST_BOOTS] = { 3, 1017, 1020, 1, 2500, 700 };
+    beacon_ccm_rx_t rx;
+    uint8_t plain[BEACON_CCM_PLAIN_MAX];
+    uint8_t plain_len;
+    uint32_t counter;
+    uint32_t last = 0;
+    uint32_t sent = 0;
+    uint32_t skipped = 0;
+    uint32_t first;
+
+    beacon_ccm_rx_init(&rx, TEST_KEY_ID, test_key);
+
+    for (uint32_t b = 0; b < TEST_BOOTS; b++)
+    {
+        CHECK_EQ(test_boot(), WICED_BT_SUCCESS);
+        first = beacon_store_get_counter(TEST_COUNTER) - BEACON_CCM_COUNTER_BLOCK;
+        for (uint32_t f = 0; f < frames[b]; f++)
+        {
+            CHECK(test_frame());
+            CHECK(beacon_ccm_open(&rx, test_air, test_air_len, plain, &plain_len, &counter));
+            CHECK(counter < beacon_store_get_counter(TEST_COUNTER));
+            if (0 == f)
+            {
+                CHECK_EQ(counter, first);
+                skipped += (0 != sent) ? (counter - last - 1) : 0;
+            }
+            last = counter;
+            sent++;
+        }
+    }
+    CHECK_EQ(rx.accepted, sent);
+    CHECK_EQ(rx.replayed + rx.forged, 0);
+
+    printf("ccm: %lu frames over %u boots, no counter repeated, %lu counters skipped, "
+           "%lu reserves\n", (unsigned long)sent, TEST_BOOTS, (unsigned long)skipped,
+           (unsigned long)test_reserves);
+}
+
+/* Counters are not used beyond a limit that was not stored */
+static void test_reserve_failure(void)
+{
+    uint32_t limit;
+    uint32_t exhausted;
+
+    test_reserve_fails = WICED_TRUE;
+    CHECK_EQ(test_boot(), WICED_BT_ERROR);
+
+    test_reserve_fails = WICED_FALSE;
+    CHECK_EQ(test_boot(), WICED_BT_SUCCESS);
+    limit = beacon_store_get_counter(TEST_COUNTER);
+
+    test_reserve_fails = WICED_TRUE;
+    exhausted = ccm_stats.exhausted;
+    for (uint32_t f = 0; f < 2 * BEACON_CCM_COUNTER_BLOCK; f++)
+    {
+        if (test_frame())
+        {
+            CHECK(test_frame_counter() < limit);
+        }
+    }
+    CHECK_EQ(beacon_store_get_counter(TEST_COUNTER), limit);
+    CHECK_EQ(ccm_stats.exhausted - exhausted, BEACON_CCM_COUNTER_BLOCK);
+
+    /* Frames resume once the store takes the limit again */
+    test_reserve_fails = WICED_FALSE;
+    CHECK(test_frame());
+    CHECK_EQ(test_frame_counter(), limit);
+    CHECK_EQ(beacon_store_get_counter(TEST_COUNTER), limit + BEACON_CCM_COUNTER_BLOCK);
+}
+
+/* Cost of a frame sealed from scratch, sealed from a prepared frame, and
+ * opened */
+static void test_bench(void)
+{
+    static ccm_ahead_t ahead[BEACON_CCM_LOOKAHEAD];
+    beacon_ccm_rx_t rx;
+    uint8_t plain[TEST_PLAIN_LEN] = { 1, 2, 3, 4 };
+    uint8_t adv[BEACON_ADV_DATA_MAX];
+    uint8_t out[BEACON_CCM_PLAIN_MAX];
+    uint8_t adv_len;
+    uint8_t plain_len;
+    uint32_t counter;
+    uint32_t opened = 0;
+    uint64_t start;
+    uint64_t prepare_ns = 0;
+    uint64_t finish_ns = 0;
+    double seal_ns;
+    double open_ns;
+
+    start = test_now_ns();
+    for (uint32_t i = 0; i < TEST_BENCH_FRAMES; i++)
+    {
+        beacon_ccm_seal(&ccm_key, i, plain, TEST_PLAIN_LEN, adv, &adv_len);
+    }
+    seal_ns = (double)(test_now_ns() - start) / TEST_BENCH_FRAMES;
+
+    for (uint32_t i = 0; i < TEST_BENCH_FRAMES; i += BEACON_CCM_LOOKAHEAD)
+    {
+        start = test_now_ns();
+        for (uint32_t k = 0; k < BEACON_CCM_LOOKAHEAD; k++)
+        {
+            beacon_ccm_prepare(&ccm_key, i + k, TEST_PLAIN_LEN, &ahead[k]);
+        }
+        prepare_ns += test_now_ns() - start;
+
+        start = test_now_ns();
+        for (uint32_t k = 0; k < BEACON_CCM_LOOKAHEAD; k++)
+        {
+            beacon_ccm_finish(&ccm_key, &ahead[k], plain, TEST_PLAIN_LEN, adv, &adv_len);
+        }
+        finish_ns += test_now_ns() - start;
+    }
+
+    beacon_ccm_rx_init(&rx, TEST_KEY_ID, test_key);
+    start = test_now_ns();
+    for (uint32_t i = 0; i < TEST_BENCH_FRAMES; i++)
+    {
+        beacon_ccm_seal(&ccm_key, i, plain, TEST_PLAIN_LEN, adv, &adv_len);
+        opened += beacon_ccm_open(&rx, adv, adv_len, out, &plain_len, &counter) ? 1 : 0;
+    }
+    open_ns = (double)(test_now_ns() - start) / TEST_BENCH_FRAMES - seal_ns;
+    CHECK_EQ(opened, TEST_BENCH_FRAMES);
+
+    printf("ccm: %u octet frames, %.0f ns sealed from scratch, %.0f ns prepared ahead and "
+           "%.0f ns sealed from that, %.0f ns opened\n", TEST_PLAIN_LEN, seal_ns,
+           (double)prepare_ns / TEST_BENCH_FRAMES, (double)finish_ns / TEST_BENCH_FRAMES,
+           open_ns);
+}
+
+int main(void)
+{
+    test_vectors();
+    test_sp800_38c();
+    test_round_trip();
+    test_resets();
+    test_reserve_failure();
+    test_bench();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
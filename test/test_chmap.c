@@ -0,0 +1,431 @@
+/******************************************************************************
+* File Name: test_chmap.c
+*
+* Description: Host tests of the channel map decision and of its period, fed by
+* the collision model of the simulated controller on a simulated clock
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "beacon_slot.h"
+#include "beacon_stats.h"
+#include "beacon_timer.h"
+
+/* The decision and the period with their state, and the collision model of
+ * the simulated controller that feeds them */
+#include "../beacon_chmap.c"
+#include "../beacon_sim.c"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_INSTANCES                   (BEACON_SLOT_MAX_INSTANCES)
+
+/* Advertising interval of every instance, 100 ms */
+#define TEST_INTERVAL                    (160)
+
+/* Steps of the simulated clock, the audience tick of the simulator */
+#define TEST_TICK_MS                     (SIM_AUDIENCE_TICK_MS)
+
+#define TEST_HOUR_MS                     (60UL * 60UL * 1000UL)
+
+#define TEST_CH_37                       BTM_BLE_ADVERT_CHNL_37
+#define TEST_CH_38                       BTM_BLE_ADVERT_CHNL_38
+#define TEST_CH_39                       BTM_BLE_ADVERT_CHNL_39
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Channel conditions, as BEACON_SIM_CHANNEL_BUSY_37 to _39, and losses
+ * without reports such as Wi-Fi */
+typedef struct
+{
+    const char *name;
+    uint8_t busy[BEACON_CHMAP_CHANNELS];
+    uint8_t wifi[BEACON_CHMAP_CHANNELS];
+}test_scenario_t;
+
+/* Outcome of a run */
+typedef struct
+{
+    uint64_t packets;                           /* Packets sent */
+    uint64_t lost;                              /* Packets lost */
+    uint64_t events;                            /* Advertising events */
+    double   silent_events;                     /* Events with every packet lost */
+    uint32_t changes;                           /* Params updates */
+    uint32_t below_min;                         /* Maps with too few channels */
+}test_result_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static uint32_t      test_now_ms;
+static beacon_slot_t test_slots[TEST_INSTANCES];
+static uint32_t      test_seed = 7;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Collaborators: four advertising slots whose params go to the simulator */
+uint32_t beacon_stats_now_ms(void)
+{
+    return test_now_ms;
+}
+
+beacon_slot_t *beacon_slot_get(uint8_t instance)
+{
+    return ((0 == instance) || (instance > TEST_INSTANCES)) ? NULL : &test_slots[instance - 1];
+}
+
+wiced_result_t beacon_slot_set_params(beacon_slot_t *p_slot,
+                                      const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    sim_cmd_t cmd;
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.opcode      = SET_ADVT_PARAM_MULTI;
+    cmd.instance    = p_slot->instance;
+    cmd.arg         = (uint8_t)p_params->adv_type;
+    cmd.channel_map = p_params->channel_map;
+    cmd.interval    = p_params->adv_int_min;
+    beacon_sim_adv_apply(&cmd, test_now_ms);
+
+    p_slot->params = *p_params;
+    return WICED_BT_PENDING;
+}
+
+void beacon_timer_setup(beacon_timer_t *p_timer, beacon_timer_cback_t *p_cback, void *p_arg)
+{
+    (void)p_timer;
+    (void)p_cback;
+    (void)p_arg;
+}
+
+void beacon_timer_start(beacon_timer_t *p_timer, uint32_t timeout_ms)
+{
+    (void)p_timer;
+    (void)timeout_ms;
+}
+
+static uint32_t test_random(void)
+{
+    test_seed = (test_seed * 1103515245UL) + 12345UL;
+    return test_seed >> 16;
+}
+
+static uint8_t test_popcount(uint8_t map)
+{
+    return (uint8_t)(((map >> 0) & 1) + ((map >> 1) & 1) + ((map >> 2) & 1));
+}
+
+/* Minimum coverage: the least loaded channels are always kept */
+static void test_min_coverage(void)
+{
+    uint32_t load[BEACON_CHMAP_CHANNELS];
+
+    for (uint32_t n = 0; n < 20000; n++)
+    {
+        uint8_t current = (uint8_t)(1 + (test_random() % BEACON_CHMAP_ALL));
+
+        for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+        {
+            load[ch] = test_random() % ((n & 1) ? 100 : 100000);
+        }
+
+        for (uint8_t min = 1; min <= BEACON_CHMAP_CHANNELS; min++)
+        {
+            uint8_t map = beacon_chmap_decide(load, current, min);
+
+            CHECK(test_popcount(map) >= min);
+            CHECK(0 == (map & ~BEACON_CHMAP_ALL));
+
+            /* A dropped channel has no smaller load than a kept one among
+             * the first min */
+            for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+            {
+                uint8_t below = 0;
+
+                for (uint8_t other = 0; other < BEACON_CHMAP_CHANNELS; other++)
+                {
+                    below += ((load[other] < load[ch]) ||
+                              ((load[other] == load[ch]) && (other < ch))) ? 1 : 0;
+                }
+                if (below < min)
+                {
+                    CHECK(0 != (map & (1U << ch)));
+                }
+            }
+        }
+    }
+}
+
+/* Dropped above twice the margin, taken back within one margin */
+static void test_hysteresis(void)
+{
+    uint32_t base = 1000;
+    uint32_t keep = base + ((base * 2 * BEACON_CHMAP_MARGIN_PERCENT) / 100);
+    uint32_t admit = base + ((base * BEACON_CHMAP_MARGIN_PERCENT) / 100);
+    uint32_t load[BEACON_CHMAP_CHANNELS] = { base, base, 0 };
+
+    /* In the map */
+    load[2] = keep;
+    CHECK_EQ(beacon_chmap_decide(load, BEACON_CHMAP_ALL, 1), BEACON_CHMAP_ALL);
+    load[2] = keep + 1;
+    CHECK_EQ(beacon_chmap_decide(load, BEACON_CHMAP_ALL, 1), TEST_CH_37 | TEST_CH_38);
+
+    /* Out of the map */
+    load[2] = admit + 1;
+    CHECK_EQ(beacon_chmap_decide(load, TEST_CH_37 | TEST_CH_38, 1), TEST_CH_37 | TEST_CH_38);
+    load[2] = admit;
+    CHECK_EQ(beacon_chmap_decide(load, TEST_CH_37 | TEST_CH_38, 1), BEACON_CHMAP_ALL);
+
+    /* Between the two limits the map stays as it is */
+    load[2] = (keep + admit) / 2;
+    CHECK_EQ(beacon_chmap_decide(load, BEACON_CHMAP_ALL, 1), BEACON_CHMAP_ALL);
+    CHECK_EQ(beacon_chmap_decide(load, TEST_CH_37 | TEST_CH_38, 1), TEST_CH_37 | TEST_CH_38);
+}
+
+/* Loads under the floor never drop a channel, however far apart */
+static void test_floor(void)
+{
+    uint32_t load[BEACON_CHMAP_CHANNELS] = { 0, 1, BEACON_CHMAP_LOAD_FLOOR - 1 };
+
+    CHECK_EQ(beacon_chmap_decide(load, TEST_CH_37, 1), BEACON_CHMAP_ALL);
+    load[2] = BEACON_CHMAP_LOAD_FLOOR;
+    CHECK_EQ(beacon_chmap_decide(load, BEACON_CHMAP_ALL, 1), TEST_CH_37 | TEST_CH_38);
+}
+
+/* Of equal loads, the lower channel is kept first */
+static void test_ties(void)
+{
+    uint32_t load[BEACON_CHMAP_CHANNELS] = { 5000, 5000, 100 };
+
+    CHECK_EQ(beacon_chmap_decide(load, BEACON_CHMAP_ALL, 2), TEST_CH_37 | TEST_CH_39);
+    load[0] = 100;
+    load[2] = 5000;
+    CHECK_EQ(beacon_chmap_decide(load, BEACON_CHMAP_ALL, 2), TEST_CH_37 | TEST_CH_38);
+    load[1] = 100;
+    CHECK_EQ(beacon_chmap_decide(load, BEACON_CHMAP_ALL, 1), TEST_CH_37 | TEST_CH_38);
+
+    load[0] = load[1] = load[2] = 5000;
+    CHECK_EQ(beacon_chmap_decide(load, TEST_CH_39, 1), BEACON_CHMAP_ALL);
+}
+
+/* Clears the channel loads, the maps and the simulator between runs */
+static void test_reset(uint8_t min_channels)
+{
+    memset(chmap_reports, 0, sizeof(chmap_reports));
+    memset(chmap_failures, 0, sizeof(chmap_failures));
+    memset(chmap_reports_q4, 0, sizeof(chmap_reports_q4));
+    memset(chmap_failures_q4, 0, sizeof(chmap_failures_q4));
+    memset(chmap_hold, 0, sizeof(chmap_hold));
+    memset(&chmap_stats, 0, sizeof(chmap_stats));
+    memset(sim_adv, 0, sizeof(sim_adv));
+    sim_adv_seed = 1;
+    test_seed    = 7;
+
+    for (uint8_t i = 0; i < TEST_INSTANCES; i++)
+    {
+        sim_cmd_t cmd = { .opcode = SET_ADVT_ENABLE_MULTI, .instance = i + 1,
+                          .arg = MULTI_ADVERT_START };
+
+        memset(&test_slots[i], 0, sizeof(test_slots[i]));
+        test_slots[i].instance           = i + 1;
+        test_slots[i].advertising        = WICED_TRUE;
+        test_slots[i].params.adv_int_min = TEST_INTERVAL;
+        test_slots[i].params.adv_int_max = TEST_INTERVAL;
+        test_slots[i].params.adv_type    = MULTI_ADVERT_NONCONNECTABLE_EVENT;
+        test_slots[i].params.channel_map = BEACON_CHMAP_ALL;
+        (void)beacon_slot_set_params(&test_slots[i], &test_slots[i].params);
+        beacon_sim_adv_apply(&cmd, test_now_ms);
+
+        chmap_stats.min_channels[i] = min_channels;
+    }
+}
+
+/* Runs the simulator and the period for a while and counts what got
+ * through. Losses without reports are drawn here, per packet. */
+static void test_run(const test_scenario_t *p_scenario, uint32_t duration_ms,
+                     test_result_t *p_result)
+{
+    beacon_sim_config_t config = *beacon_sim_get_config();
+    uint32_t events[TEST_INSTANCES];
+    uint32_t changes = chmap_stats.changes;
+
+    memcpy(config.channel_busy, p_scenario->busy, sizeof(config.channel_busy));
+    beacon_sim_configure(&config);
+
+    for (uint8_t i = 0; i < TEST_INSTANCES; i++)
+    {
+        events[i] = sim_adv[i].events;
+    }
+
+    for (uint32_t t = 0; t < duration_ms; t += BEACON_CHMAP_PERIOD_MS)
+    {
+        for (uint32_t tick = 0; tick < BEACON_CHMAP_PERIOD_MS; tick += TEST_TICK_MS)
+        {
+            test_now_ms += TEST_TICK_MS;
+            for (uint8_t i = 0; i < TEST_INSTANCES; i++)
+            {
+                uint8_t map = beacon_chmap_current(&test_slots[i]);
+                uint32_t new_events;
+                double all_lost = 1.0;
+
+                beacon_sim_adv_advance(&sim_adv[i], (uint64_t)test_now_ms * 1000);
+                new_events = sim_adv[i].events - events[i];
+                events[i]  = sim_adv[i].events;
+
+                for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+                {
+                    if (0 == (map & (1U << ch)))
+                    {
+                        continue;
+                    }
+                    all_lost *= (p_scenario->busy[ch] / 100.0) +
+                                ((1.0 - (p_scenario->busy[ch] / 100.0)) *
+                                 (p_scenario->wifi[ch] / 100.0));
+                    for (uint32_t e = 0; e < new_events; e++)
+                    {
+                        if ((test_random() % 100) < p_scenario->wifi[ch])
+                        {
+                            beacon_chmap_observe(BEACON_CHMAP_FIRST_CHANNEL + ch, 0, 1);
+                        }
+                    }
+                }
+                p_result->events        += new_events;
+                p_result->packets       += (uint64_t)new_events * test_popcount(map);
+                p_result->silent_events += new_events * all_lost;
+            }
+            beacon_sim_ambient();
+        }
+
+        /* Collisions reported by the simulator and the Wi-Fi losses above
+         * are counted together as failures of the period */
+        beacon_chmap_period(&chmap_timer);
+        for (uint8_t ch = 0; ch < BEACON_CHMAP_CHANNELS; ch++)
+        {
+            p_result->lost += chmap_stats.failures[ch];
+        }
+
+        for (uint8_t i = 0; i < TEST_INSTANCES; i++)
+        {
+            if ((0 != chmap_stats.min_channels[i]) &&
+                (test_popcount(beacon_chmap_current(&test_slots[i])) <
+                 chmap_stats.min_channels[i]))
+            {
+                p_result->below_min++;
+            }
+        }
+    }
+    p_result->changes += chmap_stats.changes - changes;
+}
+
+static void test_print(const char *name, const test_result_t *p_result, uint32_t duration_ms)
+{
+    printf("%-26s loss %5.2f%%, %6.3f packets/event, no packet %6.3f%% of events, "
+           "%4.1f updates/instance/h\n", name,
+           (100.0 * (double)p_result->lost) / (double)p_result->packets,
+           (double)p_result->packets / (double)p_result->events,
+           (100.0 * p_result->silent_events) / (double)p_result->events,
+           ((double)p_result->changes * TEST_HOUR_MS) / ((double)duration_ms * TEST_INSTANCES));
+}
+
+/* Unmanaged maps against maps managed with BEACON_CHMAP_MIN_CHANNELS */
+static void test_scenario(const test_scenario_t *p_scenario, uint32_t duration_ms,
+                          test_result_t *p_fixed, test_result_t *p_managed)
+{
+    char name[48];
+
+    memset(p_fixed, 0, sizeof(*p_fixed));
+    memset(p_managed, 0, sizeof(*p_managed));
+
+    test_reset(0);
+    test_run(p_scenario, duration_ms, p_fixed);
+    test_reset(BEACON_CHMAP_MIN_CHANNELS);
+    test_run(p_scenario, duration_ms, p_managed);
+
+    snprintf(name, sizeof(name), "%s, fixed", p_scenario->name);
+    test_print(name, p_fixed, duration_ms);
+    snprintf(name, sizeof(name), "%s, managed", p_scenario->name);
+    test_print(name, p_managed, duration_ms);
+
+    CHECK_EQ(p_fixed->changes, 0);
+    CHECK_EQ(p_managed->below_min, 0);
+}
+
+/* Loss, packets and coverage over an hour with the collision model */
+static void test_periods(void)
+{
+    static const test_scenario_t busy_38 = { "38 35% busy",   { 3, 35, 3 },  { 0, 0, 0 } };
+    static const test_scenario_t close   = { "loads 50% apart", { 10, 15, 12 }, { 0, 0, 0 } };
+    static const test_scenario_t wifi_38 = { "38 30% Wi-Fi",  { 3, 3, 3 },  { 0, 30, 0 } };
+    test_result_t fixed;
+    test_result_t managed;
+
+    /* A busy channel is dropped: losses and packets fall, events with no
+     * packet through rise within what the minimum allows */
+    test_scenario(&busy_38, TEST_HOUR_MS, &fixed, &managed);
+    CHECK(managed.lost * fixed.packets * 3 < fixed.lost * managed.packets);
+    CHECK(managed.packets * 10 < fixed.packets * 7);
+    CHECK(managed.silent_events < fixed.silent_events * 4);
+    CHECK(managed.changes <= 2 * TEST_INSTANCES);
+
+    /* Loads within the hysteresis never move a map */
+    test_scenario(&close, TEST_HOUR_MS, &fixed, &managed);
+    CHECK_EQ(managed.changes, 0);
+
+    /* Losses without reports: the channel is retried every few minutes */
+    test_scenario(&wifi_38, TEST_HOUR_MS, &fixed, &managed);
+    CHECK(managed.lost * fixed.packets * 3 < fixed.lost * managed.packets * 2);
+    CHECK(managed.changes > 0);
+    CHECK(managed.changes < 60 * TEST_INSTANCES);
+}
+
+int main(void)
+{
+    test_min_coverage();
+    test_hysteresis();
+    test_floor();
+    test_ties();
+    test_periods();
+
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
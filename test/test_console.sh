@@ -0,0 +1,81 @@
+#!/bin/sh
+################################################################################
+# \file test_console.sh
+# \version 1.0
+#
+# \brief
+# Runs the host build of the application with a console session on stdin and
+# checks the replies: the controller trace of the boot, listing, statistics,
+# live payload and parameter updates through the simulated controller, and
+# rejected input.
+#
+# Usage: test_console.sh <beacon_host>
+#
+################################################################################
+# \copyright
+# Copyright 2018-2024, Cypress Semiconductor Corporation (an Infineon company)
+# SPDX-License-Identifier: Apache-2.0
+# 
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#     http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+################################################################################
+
+app=$1
+out=$(dirname "$app")/console.out
+failures=0
+
+printf '%s\n' \
+    'help' \
+    'sim' \
+    'slots' \
+    'data 1 0201060303aafe' \
+    'params 2 160 320 1' \
+    'stop 2' \
+    'start 2' \
+    'slots' \
+    'stats 1' \
+    'foo' \
+    'data 9 00' \
+    'data 1 0g' \
+    'params 1' \
+    "data 1 $(printf '%0100d' 0)" \
+    'stats' \
+    | timeout 60 "$app" > "$out" 2>&1
+
+expect()
+{
+    if ! grep -qF -- "$1" "$out"; then
+        echo "test_console.sh: missing: $1"
+        failures=$((failures + 1))
+    fi
+}
+
+expect 'Bluetooth Enabled'
+expect 'slots                                 List the advertising slots'
+expect 'Commands 6, rejected 0, failed 0, HCI bytes 146'
+expect 'Boot to advertising'
+expect 'Instance 1: advertising'
+expect 'Instance 1: advertising, interval 160-16384, tx power 2, range 1000 cm, 0 pending, 7 bytes: 02 01 06 03 03 AA FE'
+expect 'Instance 2: advertising, interval 160-320, tx power 1'
+expect 'Multi ADV Set Data Event Status: SUCCESS'
+expect 'Instance 1: issued 4, rejected 0, failed 0, data 2, params 1'
+expect 'Unknown command foo, try help'
+expect 'Invalid number: 9'
+expect 'Usage: params <instance> <min> <max> [tx]'
+expect 'Line too long'
+expect 'control lost 0'
+
+if [ 0 -ne "$failures" ]; then
+    echo "test_console.sh: FAILED, output in $out"
+    exit 1
+fi
+echo "test_console.sh: passed"
@@ -0,0 +1,293 @@
+/******************************************************************************
+* File Name: test_energy.c
+*
+* Description: Host tests of the energy estimate. The simulated controller
+* counts the advertising events it sends while instances start, stop, change
+* their interval and the controller restarts, over half an hour of simulated
+* time; the estimate of beacon_energy.c has to match it.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include "test.h"
+#include "host.h"
+#include "beacon_energy.h"
+#include "beacon_manager.h"
+#include "beacon_slot.h"
+#include "beacon_stats.h"
+#include "beacon_utils.h"
+#include "beacon_worker.h"
+#include "beacon_sim.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_INSTANCES                   (BEACON_SLOT_MAX_INSTANCES)
+
+/* Simulated time of a phase. The clock jumps while no command is in flight,
+ * the responses are answered in real time in between. */
+#define TEST_PHASE_MS                    (10UL * 60UL * 1000UL)
+
+/* Time for the commands of a phase to be answered */
+#define TEST_SETTLE_MS                   (50)
+
+/* The estimate advances by the mean advDelay, the controller by a random
+ * one, so the counts drift apart, by 23 in 72000 events at 20 ms. Each
+ * start also sends a first event at once that the estimate spreads over the
+ * first period, and after a restart the estimate runs on until the enabled
+ * event, the boot time of 50 ms. */
+#define TEST_TOLERANCE_PERMILLE          (2)
+#define TEST_TOLERANCE_PER_START         (3)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static const wiced_bt_ble_multi_adv_params_t test_params =
+{
+    .adv_type    = MULTI_ADVERT_NONCONNECTABLE_EVENT,
+    .channel_map = BTM_BLE_ADVERT_CHNL_37 | BTM_BLE_ADVERT_CHNL_38 | BTM_BLE_ADVERT_CHNL_39,
+};
+
+static uint8_t test_uuid[LEN_UUID_128];
+
+/* Simulated time added to the RTOS time */
+static uint32_t test_skip_ms;
+
+static uint32_t test_enabled;
+
+/* Starts and restarts of every instance, each worth a few events of
+ * tolerance, and the intervals it advertised at */
+static uint32_t test_starts[TEST_INSTANCES];
+static char     test_intervals[TEST_INSTANCES][32];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* The RTOS time plus the jumps of the test, for every module linked */
+uint32_t beacon_stats_now_ms(void)
+{
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS) + test_skip_ms;
+}
+
+uint32_t beacon_stats_cycles(void)
+{
+    return (uint32_t)xTaskGetTickCount() * (configCPU_CLOCK_HZ / configTICK_RATE_HZ);
+}
+
+uint32_t beacon_stats_cycles_to_us(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000000ULL) / configCPU_CLOCK_HZ);
+}
+
+void beacon_latency_add(beacon_latency_t *p_latency, uint32_t sample)
+{
+    (void)p_latency;
+    (void)sample;
+}
+
+/* Application side of the stack, as in main.c */
+static wiced_result_t test_management_cback(wiced_bt_management_evt_t event,
+                                            wiced_bt_management_evt_data_t *p_event_data)
+{
+    beacon_manager_evt_t evt;
+
+    evt.rx_cycles = beacon_stats_cycles();
+    if (BTM_ENABLED_EVT == event)
+    {
+        evt.type = BEACON_MANAGER_EVT_ENABLED;
+        evt.data.enabled_status = p_event_data->enabled.status;
+        (void)beacon_manager_post(&evt);
+    }
+    else if (BTM_MULTI_ADVERT_RESP_EVENT == event)
+    {
+        evt.type = BEACON_MANAGER_EVT_MULTI_ADV_RESP;
+        evt.data.multi_adv.opcode = p_event_data->ble_multi_adv_response_event.opcode;
+        evt.data.multi_adv.status = p_event_data->ble_multi_adv_response_event.status;
+        (void)beacon_manager_post(&evt);
+    }
+    beacon_manager_cback_done(evt.rx_cycles);
+    return WICED_BT_SUCCESS;
+}
+
+/* After a restart the controller has stopped every instance */
+static void test_on_enabled(const beacon_manager_evt_t *p_evt)
+{
+    CHECK_EQ(p_evt->data.enabled_status, WICED_BT_SUCCESS);
+    if (0 != test_enabled)
+    {
+        beacon_slot_flush();
+    }
+    test_enabled++;
+}
+
+static void test_on_response(const beacon_manager_evt_t *p_evt)
+{
+    CHECK_EQ(p_evt->data.multi_adv.status, WICED_SUCCESS);
+    beacon_slot_on_response(p_evt->data.multi_adv.opcode, p_evt->data.multi_adv.status);
+}
+
+/* Sets the interval of an instance, and its data the first time */
+static void test_configure(uint8_t instance, uint16_t interval)
+{
+    beacon_slot_t *p_slot = beacon_slot_get(instance);
+    wiced_bt_ble_multi_adv_params_t params = test_params;
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint8_t len;
+    char *p_intervals = test_intervals[instance - 1];
+    size_t used = strlen(p_intervals);
+
+    params.adv_int_min = interval;
+    params.adv_int_max = interval;
+    CHECK_EQ(beacon_slot_set_params(p_slot, &params), WICED_BT_PENDING);
+
+    if (0 == p_slot->adv_len)
+    {
+        ibeacon_set_adv_data(test_uuid, 1, instance, 0xC5, adv_data, &len);
+        CHECK_EQ(beacon_slot_set_data(p_slot, adv_data, len), WICED_BT_PENDING);
+    }
+
+    snprintf(p_intervals + used, sizeof(test_intervals[0]) - used, "%s%u",
+             (0 == used) ? "" : ",", interval);
+}
+
+static void test_start(uint8_t instance, wiced_bool_t start)
+{
+    CHECK_EQ(beacon_slot_start(beacon_slot_get(instance), start), WICED_BT_PENDING);
+    if (start)
+    {
+        test_starts[instance - 1]++;
+    }
+}
+
+/* Lets the responses arrive, then moves the clock on */
+static void test_phase(void)
+{
+    host_run(TEST_SETTLE_MS);
+    test_skip_ms += TEST_PHASE_MS;
+}
+
+int main(void)
+{
+    beacon_energy_report_t report;
+    uint32_t sim_events;
+    uint32_t tolerance;
+    uint32_t diff;
+
+    beacon_slot_init();
+    beacon_worker_init();
+    beacon_manager_init();
+    beacon_manager_register(BEACON_MANAGER_EVT_ENABLED, test_on_enabled);
+    beacon_manager_register(BEACON_MANAGER_EVT_MULTI_ADV_RESP, test_on_response);
+
+    wiced_bt_stack_init(test_management_cback, NULL);
+    host_run(2 * BEACON_SIM_BOOT_MS);
+    CHECK_EQ(test_enabled, 1);
+
+    /* Both counts start at the same time */
+    beacon_energy_start();
+    beacon_sim_reset_stats();
+
+    /* 20 ms to 1 s intervals */
+    test_configure(1, 32);
+    test_configure(2, 160);
+    test_configure(3, 400);
+    test_configure(4, 1600);
+    for (uint8_t instance = 1; instance <= TEST_INSTANCES; instance++)
+    {
+        test_start(instance, WICED_TRUE);
+    }
+    test_phase();
+
+    /* A stop, and an interval change while advertising */
+    test_start(3, WICED_FALSE);
+    test_configure(2, 800);
+    test_phase();
+
+    /* The controller restarts and stops everything, then some instances are
+     * configured and started again */
+    beacon_sim_restart();
+    host_run(2 * BEACON_SIM_BOOT_MS);
+    CHECK_EQ(test_enabled, 2);
+    for (uint8_t instance = 1; instance <= TEST_INSTANCES; instance++)
+    {
+        CHECK(!beacon_slot_get(instance)->advertising);
+        if (beacon_sim_adv_events(instance) > 0)
+        {
+            /* The estimate ran on until the enabled event */
+            test_starts[instance - 1]++;
+        }
+    }
+    test_configure(1, 32);
+    test_configure(3, 400);
+    test_configure(4, 244);
+    test_start(1, WICED_TRUE);
+    test_start(3, WICED_TRUE);
+    test_start(4, WICED_TRUE);
+    test_phase();
+
+    /* Compare once the last stop is answered */
+    test_start(4, WICED_FALSE);
+    host_run(TEST_SETTLE_MS);
+
+    beacon_energy_get(&report);
+    CHECK(report.elapsed_ms >= 3 * TEST_PHASE_MS);
+
+    printf("Instance  Intervals       Controller  Estimate  Tolerance (diff)\n");
+    for (uint8_t instance = 1; instance <= TEST_INSTANCES; instance++)
+    {
+        sim_events = beacon_sim_adv_events(instance);
+        tolerance  = ((sim_events * TEST_TOLERANCE_PERMILLE) / 1000) +
+                     (test_starts[instance - 1] * TEST_TOLERANCE_PER_START);
+        diff = (report.adv_events[instance - 1] > sim_events) ?
+               (report.adv_events[instance - 1] - sim_events) :
+               (sim_events - report.adv_events[instance - 1]);
+
+        printf("%8u  %-14s  %10lu  %8lu  %5lu (%lu)\n", instance, test_intervals[instance - 1],
+               (unsigned long)sim_events, (unsigned long)report.adv_events[instance - 1],
+               (unsigned long)tolerance, (unsigned long)diff);
+
+        CHECK(sim_events > 0);
+        CHECK(diff <= tolerance);
+    }
+
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
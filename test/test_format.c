@@ -0,0 +1,425 @@
+/******************************************************************************
+* File Name: test_format.c
+*
+* Description: Host tests of the format registry. The registry encodes the same
+* iBeacon as the hand-written encoder, rejects values out of bounds, packs big
+* and little endian fields, and runs the updater of the status frame. A
+* benchmark times the encoding of every format.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "beacon_format.h"
+#include "beacon_manager.h"
+#include "beacon_power.h"
+#include "beacon_slot.h"
+#include "beacon_stats.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_INSTANCE                    (3)
+
+/* Encodes per format in the benchmark */
+#define TEST_BENCH_ENCODES               (2000000UL)
+
+/* Offsets of the status fields, see format_status_fields */
+#define TEST_STATUS_DEVICE               (8)
+#define TEST_STATUS_TEMP                 (13)
+#define TEST_STATUS_UPTIME               (15)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static beacon_slot_t test_slots[BEACON_SLOT_MAX_INSTANCES];
+static uint32_t test_now;
+static uint32_t test_set_data;
+static beacon_worker_job_t *test_job;
+static uint32_t test_job_registered;
+static beacon_manager_fn_t *test_deferred;
+
+/* Keeps the benchmark loops from being optimized away */
+static volatile uint8_t test_sink;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Slot layer, manager, worker and power management of the format layer */
+beacon_slot_t *beacon_slot_get(uint8_t instance)
+{
+    return &test_slots[instance - 1];
+}
+
+wiced_result_t beacon_slot_set_data(beacon_slot_t *p_slot, const uint8_t *adv_data,
+                                    uint8_t adv_len)
+{
+    memcpy(p_slot->adv_data, adv_data, adv_len);
+    p_slot->adv_len = adv_len;
+    test_set_data++;
+    return WICED_BT_PENDING;
+}
+
+void beacon_power_fix_data(const beacon_slot_t *p_slot, uint8_t *adv_data, uint8_t adv_len)
+{
+    (void)p_slot;
+    (void)adv_data;
+    (void)adv_len;
+}
+
+void beacon_manager_defer(beacon_manager_fn_t *p_fn)
+{
+    test_deferred = p_fn;
+}
+
+void beacon_worker_register(beacon_worker_job_t *p_job, uint32_t slack_ms)
+{
+    (void)slack_ms;
+    test_job = p_job;
+    test_job_registered++;
+}
+
+uint32_t beacon_stats_now_ms(void)
+{
+    return test_now;
+}
+
+/* The fields of a format, by name */
+static uint8_t test_field(const beacon_format_desc_t *p_desc, const char *name)
+{
+    for (uint8_t i = 0; i < p_desc->num_fields; i++)
+    {
+        if (0 == strcmp(p_desc->p_fields[i].name, name))
+        {
+            return i;
+        }
+    }
+    CHECK(0);
+    return 0;
+}
+
+/* The registry encodes the same iBeacon as the hand-written encoder */
+static void test_ibeacon(void)
+{
+    static const struct
+    {
+        uint16_t major;
+        uint16_t minor;
+        int8_t power;
+    }cases[] =
+    {
+        { 0,      0,      -127 },
+        { 1,      2,      -59  },
+        { 0x1234, 0xABCD, 0    },
+        { 0xFFFF, 0xFFFF, 20   },
+    };
+    const beacon_format_desc_t *p_desc = beacon_format_find("ibeacon");
+    beacon_format_value_t values[BEACON_FORMAT_MAX_FIELDS];
+    uint8_t uuid[LEN_UUID_128];
+    uint8_t expected[BEACON_ADV_DATA_MAX];
+    uint8_t encoded[BEACON_ADV_DATA_MAX];
+    uint8_t expected_len;
+    uint8_t encoded_len;
+
+    CHECK(NULL != p_desc);
+    if (NULL == p_desc)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < LEN_UUID_128; i++)
+    {
+        uuid[i] = (uint8_t)(0xF0 - (i * 7));
+    }
+
+    for (uint8_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        values[test_field(p_desc, "uuid")].p_bytes = uuid;
+        values[test_field(p_desc, "major")].num    = cases[c].major;
+        values[test_field(p_desc, "minor")].num    = cases[c].minor;
+        values[test_field(p_desc, "power")].num    = cases[c].power;
+
+        memset(expected, 0, sizeof(expected));
+        memset(encoded, 0, sizeof(encoded));
+        ibeacon_set_adv_data(uuid, cases[c].major, cases[c].minor, (uint8_t)cases[c].power,
+                             expected, &expected_len);
+        CHECK_EQ(beacon_format_encode(p_desc, values, encoded, &encoded_len), WICED_BT_SUCCESS);
+        CHECK_EQ(encoded_len, expected_len);
+        CHECK(0 == memcmp(encoded, expected, expected_len));
+    }
+}
+
+/* Numbers are accepted at their bounds and rejected one past them, without
+ * touching the output */
+static void test_bounds(void)
+{
+    beacon_format_value_t values[BEACON_FORMAT_MAX_FIELDS];
+    const beacon_format_desc_t *p_desc;
+    const beacon_format_field_t *p_field;
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint8_t adv_len;
+    uint32_t checked = 0;
+
+    for (uint8_t f = 0; f < beacon_format_count(); f++)
+    {
+        p_desc = beacon_format_get(f);
+        CHECK(beacon_format_validate(p_desc, p_desc->p_defaults));
+
+        for (uint8_t i = 0; i < p_desc->num_fields; i++)
+        {
+            p_field = &p_desc->p_fields[i];
+            memcpy(values, p_desc->p_defaults, p_desc->num_fields * sizeof(values[0]));
+
+            if (BEACON_FIELD_BYTES == p_field->type)
+            {
+                values[i].p_bytes = NULL;
+                CHECK(!beacon_format_validate(p_desc, values));
+                continue;
+            }
+
+            values[i].num = p_field->min;
+            CHECK(beacon_format_validate(p_desc, values));
+            values[i].num = p_field->max;
+            CHECK(beacon_format_validate(p_desc, values));
+
+            if (p_field->min > INT32_MIN)
+            {
+                values[i].num = p_field->min - 1;
+                CHECK(!beacon_format_validate(p_desc, values));
+            }
+            if (p_field->max < INT32_MAX)
+            {
+                values[i].num = p_field->max + 1;
+                CHECK(!beacon_format_validate(p_desc, values));
+
+                memset(adv_data, 0xA5, sizeof(adv_data));
+                adv_len = 0xA5;
+                CHECK_EQ(beacon_format_encode(p_desc, values, adv_data, &adv_len),
+                         WICED_BT_BADARG);
+                CHECK_EQ(adv_len, 0xA5);
+                CHECK_EQ(adv_data[0], 0xA5);
+            }
+            checked++;
+        }
+    }
+    CHECK(checked >= 8);
+}
+
+/* Big endian fields are written backwards, negative numbers in two's
+ * complement */
+static void test_packing(void)
+{
+    const beacon_format_desc_t *p_desc = beacon_format_find("status");
+    beacon_format_value_t values[BEACON_FORMAT_MAX_FIELDS];
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint8_t adv_len;
+
+    CHECK(NULL != p_desc);
+    if (NULL == p_desc)
+    {
+        return;
+    }
+
+    memcpy(values, p_desc->p_defaults, p_desc->num_fields * sizeof(values[0]));
+    values[test_field(p_desc, "device")].num = 0x01020304;
+    values[test_field(p_desc, "temp")].num   = -4000;
+    values[test_field(p_desc, "uptime")].num = 0x01020304;
+
+    CHECK_EQ(beacon_format_encode(p_desc, values, adv_data, &adv_len), WICED_BT_SUCCESS);
+    CHECK_EQ(adv_len, p_desc->template_len);
+
+    CHECK_EQ(adv_data[TEST_STATUS_DEVICE + 0], 0x01);
+    CHECK_EQ(adv_data[TEST_STATUS_DEVICE + 1], 0x02);
+    CHECK_EQ(adv_data[TEST_STATUS_DEVICE + 2], 0x03);
+    CHECK_EQ(adv_data[TEST_STATUS_DEVICE + 3], 0x04);
+
+    CHECK_EQ(adv_data[TEST_STATUS_TEMP + 0], 0x60);
+    CHECK_EQ(adv_data[TEST_STATUS_TEMP + 1], 0xF0);
+
+    CHECK_EQ(adv_data[TEST_STATUS_UPTIME + 0], 0x04);
+    CHECK_EQ(adv_data[TEST_STATUS_UPTIME + 1], 0x03);
+    CHECK_EQ(adv_data[TEST_STATUS_UPTIME + 2], 0x02);
+    CHECK_EQ(adv_data[TEST_STATUS_UPTIME + 3], 0x01);
+
+    /* The template bytes around the fields are kept */
+    CHECK(0 == memcmp(adv_data, p_desc->p_template, TEST_STATUS_DEVICE));
+}
+
+/* The updater of the status frame refreshes the uptime once a second, and
+ * only a change is encoded and issued */
+static void test_status_updater(void)
+{
+    const beacon_format_desc_t *p_desc = beacon_format_find("status");
+    beacon_slot_t *p_slot = beacon_slot_get(TEST_INSTANCE);
+    beacon_format_value_t values[BEACON_FORMAT_MAX_FIELDS];
+    uint8_t uptime;
+    uint32_t set_data;
+
+    CHECK((NULL != p_desc) && (NULL != p_desc->p_tick));
+    if ((NULL == p_desc) || (NULL == p_desc->p_tick))
+    {
+        return;
+    }
+    uptime = test_field(p_desc, "uptime");
+
+    memcpy(values, p_desc->p_defaults, p_desc->num_fields * sizeof(values[0]));
+    CHECK(p_desc->p_tick(values, 12345));
+    CHECK_EQ(values[uptime].num, 12);
+    CHECK(!p_desc->p_tick(values, 12999));
+    CHECK(p_desc->p_tick(values, 13000));
+    CHECK_EQ(values[uptime].num, 13);
+
+    /* Bound at 5 s, the job registered once */
+    test_now = 5000;
+    set_data = test_set_data;
+    CHECK_EQ(beacon_format_bind(p_slot, p_desc, p_desc->p_defaults), WICED_BT_PENDING);
+    CHECK_EQ(test_set_data, set_data + 1);
+    CHECK_EQ(test_job_registered, 1);
+    CHECK(NULL != test_job);
+    CHECK_EQ(p_slot->adv_data[TEST_STATUS_UPTIME], 5);
+
+    /* Same second, nothing to issue */
+    test_deferred = NULL;
+    CHECK_EQ(test_job(5500), BEACON_FORMAT_TICK_MS);
+    CHECK(NULL == test_deferred);
+
+    /* Next second, issued by the manager */
+    CHECK_EQ(test_job(6000), BEACON_FORMAT_TICK_MS);
+    CHECK(NULL != test_deferred);
+    if (NULL != test_deferred)
+    {
+        test_deferred();
+    }
+    CHECK_EQ(test_set_data, set_data + 2);
+    CHECK_EQ(p_slot->adv_data[TEST_STATUS_UPTIME], 6);
+
+    /* An update encoded before a rebind is dropped */
+    test_deferred = NULL;
+    CHECK_EQ(test_job(7000), BEACON_FORMAT_TICK_MS);
+    test_now = 7000;
+    CHECK_EQ(beacon_format_bind(p_slot, p_desc, p_desc->p_defaults), WICED_BT_PENDING);
+    CHECK_EQ(test_set_data, set_data + 3);
+    if (NULL != test_deferred)
+    {
+        test_deferred();
+    }
+    CHECK_EQ(test_set_data, set_data + 3);
+    CHECK_EQ(test_job_registered, 1);
+
+    /* Unbound, the job leaves the slot alone */
+    CHECK_EQ(beacon_format_bind(p_slot, NULL, NULL), WICED_BT_SUCCESS);
+    test_deferred = NULL;
+    CHECK_EQ(test_job(9000), BEACON_FORMAT_TICK_MS);
+    CHECK(NULL == test_deferred);
+}
+
+/* Encoding time of every registered format, and of the hand-written
+ * iBeacon encoder it replaces */
+static void test_bench(void)
+{
+    beacon_format_value_t values[BEACON_FORMAT_MAX_FIELDS];
+    const beacon_format_desc_t *p_desc;
+    const beacon_format_field_t *p_field;
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint8_t uuid[LEN_UUID_128] = { 0 };
+    uint8_t adv_len;
+    uint8_t varied;
+    uint64_t start;
+    uint64_t ns;
+
+    for (uint8_t f = 0; f < beacon_format_count(); f++)
+    {
+        p_desc = beacon_format_get(f);
+        memcpy(values, p_desc->p_defaults, p_desc->num_fields * sizeof(values[0]));
+
+        /* The last number field changes with every encode */
+        varied = 0;
+        for (uint8_t i = 0; i < p_desc->num_fields; i++)
+        {
+            if (BEACON_FIELD_BYTES != p_desc->p_fields[i].type)
+            {
+                varied = i;
+            }
+        }
+        p_field = &p_desc->p_fields[varied];
+
+        start = test_now_ns();
+        for (uint32_t n = 0; n < TEST_BENCH_ENCODES; n++)
+        {
+            values[varied].num = p_field->min + (int32_t)(n & 0x0F);
+            (void)beacon_format_encode(p_desc, values, adv_data, &adv_len);
+            test_sink ^= adv_data[adv_len - 1];
+        }
+        ns = test_now_ns() - start;
+        printf("format %-10s %5.1f ns/encode, %u bytes\n", p_desc->name,
+               (double)ns / TEST_BENCH_ENCODES, adv_len);
+    }
+
+    start = test_now_ns();
+    for (uint32_t n = 0; n < TEST_BENCH_ENCODES; n++)
+    {
+        ibeacon_set_adv_data(uuid, 1, 2, (uint8_t)(n & 0x0F), adv_data, &adv_len);
+        test_sink ^= adv_data[adv_len - 1];
+    }
+    ns = test_now_ns() - start;
+    printf("hand-written ibeacon %5.1f ns/encode, %u bytes\n",
+           (double)ns / TEST_BENCH_ENCODES, adv_len);
+}
+
+int main(void)
+{
+    for (uint8_t i = 0; i < BEACON_SLOT_MAX_INSTANCES; i++)
+    {
+        test_slots[i].instance = i + 1;
+    }
+
+    CHECK_EQ(beacon_format_count(), 3);
+    CHECK(NULL == beacon_format_get(beacon_format_count()));
+    CHECK(NULL == beacon_format_find("eddystone-url"));
+
+    test_ibeacon();
+    test_bounds();
+    test_packing();
+    test_status_updater();
+    test_bench();
+
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
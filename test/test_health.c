@@ -0,0 +1,502 @@
+/******************************************************************************
+* File Name: test_health.c
+*
+* Description: Host tests of the instance health monitor with the real slot
+* layer against a controller stand-in that refuses and fails commands,
+* restarts and goes silent, on a simulated clock
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "beacon_health.h"
+#include "beacon_slot.h"
+#include "beacon_energy.h"
+#include "beacon_stats.h"
+#include "beacon_timer.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_INSTANCES                   (4)
+#define TEST_DATA_LEN                    (20)
+#define TEST_TIMERS                      (8)
+#define TEST_RESPONSES                   (64)
+#define TEST_LATENCY_MS                  (3)
+#define TEST_UPDATES                     (2000)
+#define TEST_UPDATE_MS                   (250)
+#define TEST_SETTLE_MS                   (60000)
+
+/* Status of a failed response */
+#define TEST_STATUS_FAILED               (0x1F)
+
+/* Data starting with this byte is always failed by the controller */
+#define TEST_POISON                      (0xEE)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* State of an instance in the controller */
+typedef struct
+{
+    uint8_t len;
+    uint8_t data[BEACON_ADV_DATA_MAX];
+    wiced_bt_ble_multi_adv_params_t params;
+    wiced_bool_t advertising;
+}test_instance_t;
+
+/* Command awaiting its response */
+typedef struct
+{
+    uint32_t due_ms;
+    uint8_t opcode;
+    uint8_t instance;
+    uint8_t arg;
+    uint8_t data[BEACON_ADV_DATA_MAX];
+    wiced_bt_ble_multi_adv_params_t params;
+}test_response_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static uint32_t test_now;
+
+static beacon_timer_t *test_timers[TEST_TIMERS];
+static uint32_t test_timer_due[TEST_TIMERS];
+static wiced_bool_t test_timer_armed[TEST_TIMERS];
+static uint32_t test_timer_count;
+
+static test_instance_t test_ctl[TEST_INSTANCES];
+static test_response_t test_queue[TEST_RESPONSES];
+static uint32_t test_queued;
+
+/* Faults to inject */
+static uint32_t test_seed;
+static uint32_t test_refuse_pct;
+static uint32_t test_fail_pct;
+static uint32_t test_silent_until;
+
+/* Latest configuration requested per instance */
+static uint8_t test_data[TEST_INSTANCES][TEST_DATA_LEN];
+static wiced_bt_ble_multi_adv_params_t test_params[TEST_INSTANCES];
+
+static uint32_t test_escalated;
+static uint32_t test_recovered;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Collaborators of the slot layer and the monitor */
+uint32_t beacon_stats_now_ms(void)
+{
+    return test_now;
+}
+
+void beacon_timer_setup(beacon_timer_t *p_timer, beacon_timer_cback_t *p_cback, void *p_arg)
+{
+    p_timer->p_cback = p_cback;
+    p_timer->p_arg   = p_arg;
+    test_timers[test_timer_count++] = p_timer;
+}
+
+static uint32_t test_timer_index(const beacon_timer_t *p_timer)
+{
+    uint32_t i = 0;
+
+    while (test_timers[i] != p_timer)
+    {
+        i++;
+    }
+    return i;
+}
+
+void beacon_timer_start(beacon_timer_t *p_timer, uint32_t delay_ms)
+{
+    uint32_t i = test_timer_index(p_timer);
+
+    test_timer_armed[i] = WICED_TRUE;
+    test_timer_due[i]   = test_now + delay_ms;
+}
+
+void beacon_timer_stop(beacon_timer_t *p_timer)
+{
+    test_timer_armed[test_timer_index(p_timer)] = WICED_FALSE;
+}
+
+void beacon_energy_on_slot(const beacon_slot_t *p_slot)
+{
+    (void)p_slot;
+}
+
+/* Controller */
+static uint32_t test_random(uint32_t range)
+{
+    test_seed = test_seed * 1103515245UL + 12345UL;
+    return (test_seed >> 16) % range;
+}
+
+static wiced_result_t test_issue(uint8_t opcode, uint8_t instance, uint8_t arg, const void *p_arg)
+{
+    test_response_t *p_rsp;
+
+    if ((test_random(100) < test_refuse_pct) || (TEST_RESPONSES == test_queued))
+    {
+        return WICED_BT_NO_RESOURCES;
+    }
+
+    p_rsp = &test_queue[test_queued++];
+    p_rsp->due_ms   = test_now + TEST_LATENCY_MS + test_random(3);
+    p_rsp->opcode   = opcode;
+    p_rsp->instance = instance;
+    p_rsp->arg      = arg;
+    if (SET_ADVT_DATA_MULTI == opcode)
+    {
+        memcpy(p_rsp->data, p_arg, arg);
+    }
+    else if (SET_ADVT_PARAM_MULTI == opcode)
+    {
+        p_rsp->params = *(const wiced_bt_ble_multi_adv_params_t *)p_arg;
+    }
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t wiced_set_multi_advertisement_data(uint8_t *p_data, uint8_t data_len,
+                                                  uint8_t adv_instance)
+{
+    return test_issue(SET_ADVT_DATA_MULTI, adv_instance, data_len, p_data);
+}
+
+wiced_result_t wiced_set_multi_advertisement_params(uint8_t adv_instance,
+                                                    wiced_bt_ble_multi_adv_params_t *p_param)
+{
+    return test_issue(SET_ADVT_PARAM_MULTI, adv_instance, 0, p_param);
+}
+
+wiced_result_t wiced_start_multi_advertisements(uint8_t advertising_enable, uint8_t adv_instance)
+{
+    return test_issue(SET_ADVT_ENABLE_MULTI, adv_instance, advertising_enable, NULL);
+}
+
+/* Delivers the responses due and runs the timers due, one ms at a time */
+static void test_run(uint32_t ms)
+{
+    uint32_t end = test_now + ms;
+    test_response_t rsp;
+    test_instance_t *p_ctl;
+    uint8_t status;
+
+    while (test_now != end)
+    {
+        test_now++;
+
+        while ((0 != test_queued) && (test_queue[0].due_ms <= test_now))
+        {
+            rsp = test_queue[0];
+            memmove(&test_queue[0], &test_queue[1], --test_queued * sizeof(test_response_t));
+
+            status = WICED_SUCCESS;
+            if ((test_now < test_silent_until) || (test_random(100) < test_fail_pct) ||
+                ((SET_ADVT_DATA_MULTI == rsp.opcode) && (TEST_POISON == rsp.data[0])))
+            {
+                status = TEST_STATUS_FAILED;
+            }
+            else
+            {
+                p_ctl = &test_ctl[rsp.instance - 1];
+                if (SET_ADVT_DATA_MULTI == rsp.opcode)
+                {
+                    p_ctl->len = rsp.arg;
+                    memcpy(p_ctl->data, rsp.data, rsp.arg);
+                }
+                else if (SET_ADVT_PARAM_MULTI == rsp.opcode)
+                {
+                    p_ctl->params = rsp.params;
+                }
+                else
+                {
+                    p_ctl->advertising = (MULTI_ADVERT_START == rsp.arg) ? WICED_TRUE : WICED_FALSE;
+                }
+            }
+            beacon_slot_on_response((wiced_bt_multi_adv_opcodes_t)rsp.opcode, status);
+        }
+
+        for (uint32_t i = 0; i < test_timer_count; i++)
+        {
+            if (test_timer_armed[i] && ((int32_t)(test_now - test_timer_due[i]) >= 0))
+            {
+                test_timer_armed[i] = WICED_FALSE;
+                test_timers[i]->p_cback(test_timers[i]);
+            }
+        }
+    }
+}
+
+/* The stack restarted: the controller lost its instances and its queue */
+static void test_restart(void)
+{
+    test_queued = 0;
+    memset(test_ctl, 0, sizeof(test_ctl));
+    beacon_health_restart();
+}
+
+static void test_on_health(uint8_t instance, const beacon_health_stats_t *p_stats)
+{
+    (void)instance;
+    if (BEACON_HEALTH_ESCALATED == p_stats->state)
+    {
+        test_escalated++;
+    }
+    else
+    {
+        test_recovered++;
+    }
+}
+
+static void test_configure(uint8_t index, uint8_t value)
+{
+    beacon_slot_t *p_slot = beacon_slot_get(index + 1);
+
+    memset(test_data[index], value, TEST_DATA_LEN);
+    test_params[index].adv_int_min = 160 + value;
+    test_params[index].adv_int_max = 160 + value;
+    test_params[index].channel_map = 7;
+
+    beacon_slot_set_data(p_slot, test_data[index], TEST_DATA_LEN);
+    beacon_slot_set_params(p_slot, &test_params[index]);
+    beacon_slot_start(p_slot, WICED_TRUE);
+}
+
+static void test_setup(uint32_t refuse_pct, uint32_t fail_pct)
+{
+    test_now          = 1000;
+    test_queued       = 0;
+    test_timer_count  = 0;
+    test_seed         = 7;
+    test_refuse_pct   = refuse_pct;
+    test_fail_pct     = fail_pct;
+    test_silent_until = 0;
+    test_escalated    = 0;
+    test_recovered    = 0;
+    memset(test_ctl, 0, sizeof(test_ctl));
+    memset(test_timer_armed, 0, sizeof(test_timer_armed));
+
+    beacon_slot_init();
+    beacon_health_init(test_on_health);
+    for (uint8_t i = 0; i < TEST_INSTANCES; i++)
+    {
+        test_configure(i, i + 1);
+    }
+}
+
+/* The controller holds the latest configuration of every instance */
+static wiced_bool_t test_consistent(void)
+{
+    for (uint32_t i = 0; i < TEST_INSTANCES; i++)
+    {
+        if ((TEST_DATA_LEN != test_ctl[i].len) ||
+            (0 != memcmp(test_ctl[i].data, test_data[i], TEST_DATA_LEN)) ||
+            (test_ctl[i].params.adv_int_min != test_params[i].adv_int_min) ||
+            !test_ctl[i].advertising)
+        {
+            return WICED_FALSE;
+        }
+    }
+    return WICED_TRUE;
+}
+
+/* Sums the counters of the instances, checks they all recovered and the
+ * controller matches, returns the longest recovery */
+static uint32_t test_check(const char *p_name, uint32_t *p_faults)
+{
+    beacon_health_stats_t stats;
+    beacon_health_stats_t sum;
+    uint32_t healthy = 0;
+
+    memset(&sum, 0, sizeof(sum));
+    for (uint8_t i = 1; i <= TEST_INSTANCES; i++)
+    {
+        beacon_health_get(i, &stats);
+        sum.faults           += stats.faults;
+        sum.recoveries       += stats.recoveries;
+        sum.retries          += stats.retries;
+        sum.fallbacks        += stats.fallbacks;
+        sum.escalations      += stats.escalations;
+        sum.recover_total_ms += stats.recover_total_ms;
+        sum.recover_max_ms    = (stats.recover_max_ms > sum.recover_max_ms) ?
+                                stats.recover_max_ms : sum.recover_max_ms;
+        healthy              += (BEACON_HEALTH_OK == stats.state) ? 1 : 0;
+    }
+
+    printf("health: %-30s faults %4lu, mean %4lu ms, max %5lu ms, retries %4lu, "
+           "fallbacks %lu, escalations %lu\n", p_name, (unsigned long)sum.faults,
+           (unsigned long)((0 != sum.recoveries) ? sum.recover_total_ms / sum.recoveries : 0),
+           (unsigned long)sum.recover_max_ms, (unsigned long)sum.retries,
+           (unsigned long)sum.fallbacks, (unsigned long)sum.escalations);
+
+    CHECK_EQ(healthy, TEST_INSTANCES);
+    CHECK_EQ(sum.recoveries, sum.faults);
+    CHECK(test_consistent());
+
+    *p_faults = sum.faults;
+    return sum.recover_max_ms;
+}
+
+static void test_no_faults(void)
+{
+    uint32_t faults;
+
+    test_setup(0, 0);
+    test_run(1000);
+    test_check("no faults", &faults);
+    CHECK_EQ(faults, 0);
+}
+
+/* Updates while the controller refuses and fails commands at random */
+static void test_random_faults(const char *p_name, uint32_t refuse_pct, uint32_t fail_pct)
+{
+    uint32_t faults;
+
+    test_setup(refuse_pct, fail_pct);
+    for (uint32_t k = 0; k < TEST_UPDATES; k++)
+    {
+        test_run(TEST_UPDATE_MS);
+        test_configure(k % TEST_INSTANCES, (uint8_t)(1 + k % 7));
+    }
+    test_refuse_pct = 0;
+    test_fail_pct   = 0;
+    test_run(TEST_SETTLE_MS);
+
+    CHECK(test_check(p_name, &faults) <= BEACON_HEALTH_BACKOFF_MAX_MS);
+    CHECK(0 != faults);
+}
+
+/* Every restart applies all instances again right away */
+static void test_restarts(void)
+{
+    uint32_t faults;
+
+    test_setup(0, 0);
+    test_run(500);
+    for (uint32_t k = 0; k < 100; k++)
+    {
+        test_restart();
+        test_run(2000);
+    }
+    CHECK(test_check("100 stack restarts", &faults) < 4 * TEST_LATENCY_MS);
+    CHECK_EQ(faults, 100 * TEST_INSTANCES);
+}
+
+/* Short outages are ridden out by the backoff */
+static void test_outages(void)
+{
+    uint32_t faults;
+
+    test_setup(0, 0);
+    test_run(500);
+    for (uint32_t k = 0; k < 20; k++)
+    {
+        test_silent_until = test_now + 1000;
+        test_configure(k % TEST_INSTANCES, (uint8_t)(1 + k % 7));
+        test_run(10000);
+    }
+    CHECK(test_check("20 controller outages of 1 s", &faults) <
+          1000 + 8 * BEACON_HEALTH_BACKOFF_MS);
+    CHECK_EQ(faults, 20);
+}
+
+/* A long outage is escalated once and recovers once the controller is back */
+static void test_escalation(void)
+{
+    uint32_t faults;
+    uint32_t max_ms;
+
+    test_setup(0, 0);
+    test_run(500);
+    test_silent_until = test_now + 60000;
+    test_configure(0, 1);
+    test_run(120000);
+
+    max_ms = test_check("one outage of 60 s", &faults);
+    CHECK(max_ms >= 60000);
+    CHECK(max_ms < 60000 + BEACON_HEALTH_BACKOFF_MAX_MS + 100);
+    CHECK_EQ(faults, 1);
+    CHECK_EQ(test_escalated, 1);
+    CHECK_EQ(test_recovered, 1);
+}
+
+/* Data the controller never takes: the last data it took is restored, the
+ * fault is escalated and ends with the next update of the owner */
+static void test_fallback(void)
+{
+    beacon_health_stats_t stats;
+    uint8_t bad[TEST_DATA_LEN];
+    uint32_t faults;
+
+    test_setup(0, 0);
+    test_run(500);
+
+    memset(bad, TEST_POISON, sizeof(bad));
+    beacon_slot_set_data(beacon_slot_get(1), bad, sizeof(bad));
+    test_run(TEST_SETTLE_MS);
+
+    beacon_health_get(1, &stats);
+    CHECK_EQ(stats.state, BEACON_HEALTH_ESCALATED);
+    CHECK_EQ(stats.fallbacks, 1);
+    CHECK_EQ(test_escalated, 1);
+    CHECK(test_consistent());
+
+    test_configure(0, 9);
+    test_run(1000);
+    test_check("data that always fails", &faults);
+    CHECK_EQ(faults, 1);
+    CHECK_EQ(test_recovered, 1);
+}
+
+int main(void)
+{
+    test_no_faults();
+    test_random_faults("5% refused, 5% failed", 5, 5);
+    test_random_faults("10% refused, 20% failed", 10, 20);
+    test_restarts();
+    test_outages();
+    test_escalation();
+    test_fallback();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,290 @@
+/******************************************************************************
+* File Name: test_ipc.c
+*
+* Description: Host tests of the inter-core payload ring: a two-thread stress
+* test with throughput, and coalescing and retry of the submitted payloads
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "test.h"
+
+/* Doorbell of the other core, recorded */
+static uint32_t test_rings;
+static uint32_t test_clears;
+#define BEACON_IPC_DOORBELL_RING()      (test_rings++)
+#define BEACON_IPC_DOORBELL_CLEAR()     (test_clears++)
+#define BEACON_IPC_DOORBELL_INIT(isr)   ((void)(isr))
+
+#include "../beacon_ipc.c"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_STRESS_MESSAGES             (2000000UL)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static beacon_ipc_ring_t test_ring;
+static beacon_slot_t     test_slots[BEACON_SLOT_MAX_INSTANCES];
+static wiced_result_t    test_set_data_result = WICED_BT_PENDING;
+static uint32_t          test_set_data_calls;
+static uint8_t           test_last_data[BEACON_SLOT_MAX_INSTANCES][BEACON_ADV_DATA_MAX];
+static uint32_t          test_defers;
+static uint32_t          test_kicks;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Collaborators of the module, recorded instead of run */
+beacon_slot_t *beacon_slot_get(uint8_t instance)
+{
+    return ((instance >= 1) && (instance <= BEACON_SLOT_MAX_INSTANCES)) ?
+           &test_slots[instance - 1] : NULL;
+}
+
+wiced_result_t beacon_slot_set_data(beacon_slot_t *p_slot, const uint8_t *p_data, uint8_t len)
+{
+    test_set_data_calls++;
+    if (WICED_BT_PENDING == test_set_data_result)
+    {
+        memcpy(test_last_data[p_slot - test_slots], p_data, len);
+    }
+    return test_set_data_result;
+}
+
+void beacon_manager_defer(beacon_manager_fn_t *p_fn)
+{
+    (void)p_fn;
+    test_defers++;
+}
+
+void beacon_worker_register(beacon_worker_job_t *p_job, uint32_t slack_ms)
+{
+    (void)p_job;
+    (void)slack_ms;
+}
+
+void beacon_worker_kick_from_isr(void)
+{
+    test_kicks++;
+}
+
+static void test_fill(beacon_ipc_msg_t *p_msg, uint32_t seq)
+{
+    p_msg->seq      = seq;
+    p_msg->instance = (uint8_t)(1 + (seq % BEACON_SLOT_MAX_INSTANCES));
+    p_msg->adv_len  = (uint8_t)(seq % (BEACON_ADV_DATA_MAX + 1));
+    for (uint32_t i = 0; i < BEACON_ADV_DATA_MAX; i++)
+    {
+        p_msg->adv_data[i] = (uint8_t)(seq * 31 + i);
+    }
+}
+
+static void *test_producer(void *p_arg)
+{
+    beacon_ipc_msg_t msg;
+    uint32_t *p_full = p_arg;
+
+    for (uint32_t seq = 0; seq < TEST_STRESS_MESSAGES; )
+    {
+        test_fill(&msg, seq);
+        if (beacon_ipc_push(&test_ring, &msg))
+        {
+            seq++;
+        }
+        else
+        {
+            /* Hand the CPU to the consumer on a single core host */
+            (*p_full)++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/* The consumer sees every message once, in order and intact */
+static void test_stress(void)
+{
+    pthread_t producer;
+    beacon_ipc_msg_t msg;
+    beacon_ipc_msg_t expected;
+    uint32_t full = 0;
+    uint32_t bad = 0;
+    uint64_t start;
+    uint64_t elapsed;
+
+    beacon_ipc_ring_init(&test_ring);
+    start = test_now_ns();
+    pthread_create(&producer, NULL, test_producer, &full);
+    for (uint32_t seq = 0; seq < TEST_STRESS_MESSAGES; )
+    {
+        if (beacon_ipc_pop(&test_ring, &msg))
+        {
+            test_fill(&expected, seq);
+            bad += (0 != memcmp(&msg, &expected, offsetof(beacon_ipc_msg_t, seq) +
+                                sizeof(expected.seq))) ? 1 : 0;
+            seq++;
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+    pthread_join(producer, NULL);
+    elapsed = test_now_ns() - start;
+
+    CHECK_EQ(bad, 0);
+    CHECK(!beacon_ipc_pop(&test_ring, &msg));
+    printf("ipc: %lu messages between two threads: %.1f M messages/s, %.1f ns/message, "
+           "producer found the ring full %lu times\n", (unsigned long)TEST_STRESS_MESSAGES,
+           (double)TEST_STRESS_MESSAGES * 1e3 / (double)elapsed,
+           (double)elapsed / TEST_STRESS_MESSAGES, (unsigned long)full);
+}
+
+/* Only the newest payload of each instance is submitted */
+static void test_coalescing(void)
+{
+    beacon_ipc_msg_t msg;
+
+    memset(&ipc_stats, 0, sizeof(ipc_stats));
+    beacon_ipc_ring_init(&beacon_ipc_payload_ring);
+    for (uint32_t seq = 0; seq < BEACON_IPC_RING_SIZE; seq++)
+    {
+        test_fill(&msg, seq);
+        msg.instance = (seq < 3) ? 1 : 2;
+        CHECK(beacon_ipc_push(&beacon_ipc_payload_ring, &msg));
+    }
+
+    test_set_data_calls = 0;
+    beacon_ipc_submit_all();
+    CHECK_EQ(test_set_data_calls, 2);
+    CHECK_EQ(ipc_stats.received, BEACON_IPC_RING_SIZE);
+    CHECK_EQ(ipc_stats.superseded, BEACON_IPC_RING_SIZE - 2);
+    CHECK_EQ(ipc_stats.submitted, 2);
+
+    test_fill(&msg, 2);
+    CHECK(0 == memcmp(test_last_data[0], msg.adv_data, msg.adv_len));
+    test_fill(&msg, BEACON_IPC_RING_SIZE - 1);
+    CHECK(0 == memcmp(test_last_data[1], msg.adv_data, msg.adv_len));
+}
+
+/* A refused payload is counted and submitted again on the next retry, unless
+ * a newer one replaces it first */
+static void test_retry(void)
+{
+    beacon_ipc_msg_t msg;
+
+    memset(&ipc_stats, 0, sizeof(ipc_stats));
+    beacon_ipc_ring_init(&beacon_ipc_payload_ring);
+    test_fill(&msg, 100);
+    msg.instance = 3;
+    CHECK(beacon_ipc_push(&beacon_ipc_payload_ring, &msg));
+
+    test_set_data_result = WICED_BT_NO_RESOURCES;
+    beacon_ipc_submit_all();
+    CHECK_EQ(ipc_stats.rejected, 1);
+    CHECK_EQ(ipc_stats.submitted, 0);
+
+    /* The ring is empty, the pending payload still wakes the manager and
+     * keeps the job running until it is accepted */
+    test_defers = 0;
+    CHECK_EQ(beacon_ipc_job(0), BEACON_IPC_RETRY_MS);
+    CHECK_EQ(test_defers, 1);
+
+    test_fill(&msg, 101);
+    msg.instance = 3;
+    CHECK(beacon_ipc_push(&beacon_ipc_payload_ring, &msg));
+    test_set_data_result = WICED_BT_PENDING;
+    beacon_ipc_submit_all();
+    CHECK_EQ(ipc_stats.superseded, 1);
+    CHECK_EQ(ipc_stats.submitted, 1);
+    CHECK(0 == memcmp(test_last_data[2], msg.adv_data, msg.adv_len));
+
+    test_defers = 0;
+    CHECK_EQ(beacon_ipc_job(0), BEACON_WORKER_IDLE);
+    CHECK_EQ(test_defers, 0);
+}
+
+/* Without a poll the Bluetooth core only wakes up for the doorbell, once for
+ * a batch of messages */
+static void test_doorbell(void)
+{
+    beacon_ipc_msg_t msg;
+
+    memset(&ipc_stats, 0, sizeof(ipc_stats));
+    beacon_ipc_ring_init(&beacon_ipc_payload_ring);
+    test_set_data_result = WICED_BT_PENDING;
+    test_defers = 0;
+    CHECK_EQ(beacon_ipc_job(0), BEACON_WORKER_IDLE);
+    CHECK_EQ(test_defers, 0);
+
+    test_rings = test_clears = test_kicks = 0;
+    for (uint32_t seq = 0; seq < 3; seq++)
+    {
+        test_fill(&msg, seq);
+        CHECK(beacon_ipc_push(&beacon_ipc_payload_ring, &msg));
+    }
+    beacon_ipc_notify();
+    CHECK_EQ(test_rings, 1);
+
+    beacon_ipc_isr();
+    CHECK_EQ(test_clears, 1);
+    CHECK_EQ(test_kicks, 1);
+    CHECK_EQ(beacon_ipc_job(0), BEACON_IPC_RETRY_MS);
+    CHECK_EQ(test_defers, 1);
+
+    beacon_ipc_submit_all();
+    CHECK_EQ(ipc_stats.submitted, 3);
+    CHECK_EQ(beacon_ipc_job(0), BEACON_WORKER_IDLE);
+    CHECK_EQ(test_defers, 1);
+}
+
+int main(void)
+{
+    test_stress();
+    test_coalescing();
+    test_retry();
+    test_doorbell();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
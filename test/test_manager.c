@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name: test_manager.c
+*
+* Description: Host tests of the beacon manager queues: control events are
+* never lost to a burst of scan reports
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "host.h"
+#include "beacon_manager.h"
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static uint32_t test_reports;
+static uint32_t test_responses;
+static uint32_t test_enabled;
+static uint32_t test_order_errors;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+static void test_on_report(const beacon_manager_evt_t *p_evt)
+{
+    (void)p_evt;
+    test_reports++;
+}
+
+static void test_on_enabled(const beacon_manager_evt_t *p_evt)
+{
+    (void)p_evt;
+    test_enabled++;
+}
+
+/* Responses must arrive in the order of the commands */
+static void test_on_response(const beacon_manager_evt_t *p_evt)
+{
+    test_order_errors += (p_evt->data.multi_adv.status != (uint8_t)test_responses) ? 1 : 0;
+    test_responses++;
+}
+
+static void test_post(beacon_manager_evt_type_t type, uint8_t status)
+{
+    beacon_manager_evt_t evt;
+
+    memset(&evt, 0, sizeof(evt));
+    evt.type = type;
+    evt.data.multi_adv.opcode = SET_ADVT_DATA_MULTI;
+    evt.data.multi_adv.status = status;
+    CHECK(beacon_manager_post(&evt) || (BEACON_MANAGER_EVT_SCAN_REPORT == type));
+}
+
+int main(void)
+{
+    const beacon_manager_stats_t *p_stats = beacon_manager_get_stats();
+
+    beacon_manager_init();
+    beacon_manager_register(BEACON_MANAGER_EVT_SCAN_REPORT, test_on_report);
+    beacon_manager_register(BEACON_MANAGER_EVT_ENABLED, test_on_enabled);
+    beacon_manager_register(BEACON_MANAGER_EVT_MULTI_ADV_RESP, test_on_response);
+
+    /* A scan burst fills its queue before the manager runs, then the stack
+     * answers every command the slot can have in flight */
+    for (uint32_t i = 0; i < 2 * BEACON_MANAGER_QUEUE_SIZE; i++)
+    {
+        test_post(BEACON_MANAGER_EVT_SCAN_REPORT, 0);
+    }
+    test_post(BEACON_MANAGER_EVT_ENABLED, 0);
+    for (uint32_t i = 0; i < BEACON_SLOT_CMD_QUEUE_SIZE; i++)
+    {
+        test_post(BEACON_MANAGER_EVT_MULTI_ADV_RESP, (uint8_t)i);
+    }
+
+    host_run(50);
+
+    CHECK_EQ(test_enabled, 1);
+    CHECK_EQ(test_responses, BEACON_SLOT_CMD_QUEUE_SIZE);
+    CHECK_EQ(test_order_errors, 0);
+    CHECK_EQ(test_reports, BEACON_MANAGER_QUEUE_SIZE);
+    CHECK_EQ(p_stats->dropped, BEACON_MANAGER_QUEUE_SIZE);
+    CHECK_EQ(p_stats->control_lost, 0);
+    CHECK_EQ(p_stats->handled, BEACON_MANAGER_QUEUE_SIZE + 1 + BEACON_SLOT_CMD_QUEUE_SIZE);
+
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,301 @@
+/******************************************************************************
+* File Name: test_payload.c
+*
+* Description: Host stress test of the payload triple buffer: a writer and a
+* reader thread check that every payload taken is complete and newer than the
+* last, and the cost of publish and poll is compared with a mutex and copy
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "test.h"
+#include "../beacon_payload.c"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_PUBLISHES                   (2000000UL)
+
+/* Publishes between two yields of the writer in the stress run, the reader
+ * yields when it finds nothing, so the threads interleave on a single core */
+#define TEST_YIELD_EVERY                 (16)
+
+/* Length and contents of payload s */
+#define TEST_LEN(s)                      ((uint8_t)(((s) % BEACON_ADV_DATA_MAX) + 1))
+#define TEST_BYTE(s, i)                  ((uint8_t)((s) + (i)))
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Result of one run */
+typedef struct
+{
+    uint64_t publish_ns;                        /* Writer time */
+    uint64_t poll_ns;                           /* Reader time */
+    uint32_t polls;                             /* Reader polls */
+    uint32_t taken;                             /* Payloads taken */
+    uint32_t errors;                            /* Torn, stale or reordered payloads */
+}test_result_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static beacon_payload_t   test_payload;
+static volatile int       test_done;
+static wiced_bool_t       test_yield;
+static test_result_t      test_result;
+
+/* The critical section and copy the triple buffer replaced */
+static pthread_mutex_t    test_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t            test_locked_data[BEACON_ADV_DATA_MAX];
+static uint8_t            test_locked_len;
+static uint32_t           test_locked_seq;
+static int                test_locked_dirty;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+static void *test_writer(void *p_arg)
+{
+    beacon_payload_buf_t *p_buf;
+    uint64_t start = test_now_ns();
+
+    for (uint32_t s = 1; s <= TEST_PUBLISHES; s++)
+    {
+        p_buf = beacon_payload_buffer(&test_payload);
+        for (uint8_t i = 0; i < TEST_LEN(s); i++)
+        {
+            p_buf->data[i] = TEST_BYTE(s, i);
+        }
+        p_buf->tag = s;
+        beacon_payload_publish(&test_payload, TEST_LEN(s));
+        if (test_yield && (0 == (s % TEST_YIELD_EVERY)))
+        {
+            sched_yield();
+        }
+    }
+    test_result.publish_ns = test_now_ns() - start;
+    test_done = 1;
+    return NULL;
+}
+
+static void *test_reader(void *p_arg)
+{
+    const beacon_payload_buf_t *p_buf;
+    uint64_t start = test_now_ns();
+    uint32_t last = 0;
+    uint32_t s;
+    int done;
+
+    for (;;)
+    {
+        done  = test_done;
+        p_buf = beacon_payload_take(&test_payload);
+        test_result.polls++;
+        if (NULL != p_buf)
+        {
+            s = p_buf->tag;
+            test_result.taken++;
+            test_result.errors += ((p_buf->seq != s) || (s <= last) ||
+                                   (p_buf->len != TEST_LEN(s))) ? 1 : 0;
+            for (uint8_t i = 0; i < p_buf->len; i++)
+            {
+                if (p_buf->data[i] != TEST_BYTE(s, i))
+                {
+                    test_result.errors++;
+                    break;
+                }
+            }
+            last = s;
+        }
+        else if (done)
+        {
+            break;
+        }
+        else if (test_yield)
+        {
+            sched_yield();
+        }
+    }
+    test_result.poll_ns = test_now_ns() - start;
+    return NULL;
+}
+
+static void *test_locked_writer(void *p_arg)
+{
+    uint8_t data[BEACON_ADV_DATA_MAX];
+    uint64_t start = test_now_ns();
+
+    for (uint32_t s = 1; s <= TEST_PUBLISHES; s++)
+    {
+        for (uint8_t i = 0; i < TEST_LEN(s); i++)
+        {
+            data[i] = TEST_BYTE(s, i);
+        }
+        pthread_mutex_lock(&test_mutex);
+        memcpy(test_locked_data, data, TEST_LEN(s));
+        test_locked_len   = TEST_LEN(s);
+        test_locked_seq   = s;
+        test_locked_dirty = 1;
+        pthread_mutex_unlock(&test_mutex);
+    }
+    test_result.publish_ns = test_now_ns() - start;
+    test_done = 1;
+    return NULL;
+}
+
+static void *test_locked_reader(void *p_arg)
+{
+    uint8_t data[BEACON_ADV_DATA_MAX];
+    uint64_t start = test_now_ns();
+    uint32_t last = 0;
+    uint32_t s;
+    uint8_t len;
+    int dirty;
+    int done;
+
+    for (;;)
+    {
+        done = test_done;
+        pthread_mutex_lock(&test_mutex);
+        dirty             = test_locked_dirty;
+        test_locked_dirty = 0;
+        len               = test_locked_len;
+        s                 = test_locked_seq;
+        memcpy(data, test_locked_data, len);
+        pthread_mutex_unlock(&test_mutex);
+
+        test_result.polls++;
+        if (dirty)
+        {
+            test_result.taken++;
+            test_result.errors += (s <= last) ? 1 : 0;
+            for (uint8_t i = 0; i < len; i++)
+            {
+                if (data[i] != TEST_BYTE(s, i))
+                {
+                    test_result.errors++;
+                    break;
+                }
+            }
+            last = s;
+        }
+        else if (done)
+        {
+            break;
+        }
+    }
+    test_result.poll_ns = test_now_ns() - start;
+    return NULL;
+}
+
+static void test_run(const char *name, void *(*p_writer)(void *), void *(*p_reader)(void *))
+{
+    pthread_t writer;
+    pthread_t reader;
+
+    memset(&test_result, 0, sizeof(test_result));
+    test_done = 0;
+    beacon_payload_init(&test_payload);
+
+    pthread_create(&reader, NULL, p_reader, NULL);
+    pthread_create(&writer, NULL, p_writer, NULL);
+    pthread_join(writer, NULL);
+    pthread_join(reader, NULL);
+
+    printf("payload: %-13s %5.1f ns/publish, %5.1f ns/poll, %lu of %lu taken\n", name,
+           (double)test_result.publish_ns / TEST_PUBLISHES,
+           (double)test_result.poll_ns / test_result.polls,
+           (unsigned long)test_result.taken, TEST_PUBLISHES);
+    CHECK_EQ(test_result.errors, 0);
+    CHECK(test_result.taken > 0);
+}
+
+/* Concurrent writer and reader: every payload taken is whole and newer */
+static void test_stress(void)
+{
+    test_yield = WICED_TRUE;
+    test_run("interleaved", test_writer, test_reader);
+    CHECK(test_result.taken > TEST_PUBLISHES / (4 * TEST_YIELD_EVERY));
+
+    /* Every publish was taken or replaced, none is left fresh at the end */
+    CHECK_EQ(test_payload.published, TEST_PUBLISHES);
+    CHECK_EQ(test_payload.published, test_payload.taken + test_payload.superseded +
+                                     ((0 != (test_payload.shared & PAYLOAD_FRESH)) ? 1 : 0));
+    CHECK_EQ(test_payload.taken, test_result.taken);
+}
+
+/* Publish and poll cost against the critical section it replaced */
+static void test_bench(void)
+{
+    test_yield = WICED_FALSE;
+    test_run("triple buffer", test_writer, test_reader);
+    test_run("mutex + copy", test_locked_writer, test_locked_reader);
+}
+
+/* Without a reader, only the latest payload is kept */
+static void test_supersede(void)
+{
+    const beacon_payload_buf_t *p_buf;
+    beacon_payload_buf_t *p_write;
+
+    beacon_payload_init(&test_payload);
+    CHECK(NULL == beacon_payload_take(&test_payload));
+    for (uint32_t s = 1; s <= 5; s++)
+    {
+        p_write = beacon_payload_buffer(&test_payload);
+        p_write->data[0] = (uint8_t)s;
+        beacon_payload_publish(&test_payload, 1);
+    }
+    p_buf = beacon_payload_take(&test_payload);
+    CHECK((NULL != p_buf) && (5 == p_buf->data[0]) && (5 == p_buf->seq));
+    CHECK(NULL == beacon_payload_take(&test_payload));
+    CHECK_EQ(test_payload.superseded, 4);
+}
+
+int main(void)
+{
+    test_supersede();
+    test_stress();
+    test_bench();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
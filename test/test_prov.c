@@ -0,0 +1,561 @@
+/******************************************************************************
+* File Name: test_prov.c
+*
+* Description: Loopback tests of the provisioning receiver and the store. A
+* sender running the session of scripts/beacon_prov.py talks to the receiver
+* over a modelled 115200 baud link on a simulated clock, with frames corrupted
+* and replies lost.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "beacon_prov.h"
+#include "beacon_store.h"
+#include "beacon_format.h"
+#include "beacon_manager.h"
+#include "beacon_power.h"
+#include "beacon_slot.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* UART at 115200 baud, 10 bits per character, and the turnaround of the
+ * USB serial bridge before a reply reaches the sender */
+#define TEST_BYTE_US                     (87)
+#define TEST_TURNAROUND_US               (1000)
+
+/* Reply timeout of the sender, the default of beacon_prov.py */
+#define TEST_TIMEOUT_US                  (500000)
+
+/* Records per session: one slot per instance and two keys */
+#define TEST_SLOTS                       (4)
+#define TEST_KEYS                        (2)
+#define TEST_RECORDS                     (TEST_SLOTS + TEST_KEYS)
+#define TEST_FRAMES                      (TEST_RECORDS + 1)
+#define TEST_SESSIONS                    (100)
+
+/* Characters in flight on one direction of the link */
+#define TEST_WIRE_SIZE                   (4096)
+
+/* Replies the sender still takes after a timeout */
+#define TEST_NO_REPLY                    (0xFFFFFFFFUL)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* One direction of the serial link, characters with their arrival time */
+typedef struct
+{
+    uint8_t data[TEST_WIRE_SIZE];
+    uint64_t at_us[TEST_WIRE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint64_t busy_us;                           /* Last character on the wire */
+}test_wire_t;
+
+/* Faults of a session, counted in frames written and replies sent */
+typedef struct
+{
+    uint32_t corrupt_frame;                     /* Frame with a flipped byte, 0 none */
+    uint32_t drop_reply;                        /* Reply lost on the way back, 0 none */
+    wiced_bool_t drop_commit_ack;               /* First ACK of COMMIT lost */
+    uint32_t loss_per_mille;                    /* Random character corruption */
+}test_faults_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static uint64_t test_now_us;
+static test_wire_t test_tx;                     /* Sender to device */
+static test_wire_t test_rx;                     /* Device to sender */
+
+static test_faults_t test_faults;
+static uint32_t test_frames_written;
+static uint32_t test_replies_sent;
+static uint32_t test_seed = 1;
+
+static uint32_t test_applied;
+static uint32_t test_retransmitted;
+
+static uint8_t test_payload[TEST_RECORDS][BEACON_PROV_PAYLOAD_MAX];
+static uint8_t test_payload_len[TEST_RECORDS];
+static uint8_t test_payload_type[TEST_RECORDS];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Collaborators of the store, which applies nothing here */
+beacon_slot_t *beacon_slot_get(uint8_t instance)
+{
+    return NULL;
+}
+
+wiced_result_t beacon_format_bind(beacon_slot_t *p_slot, const beacon_format_desc_t *p_desc,
+                                  const beacon_format_value_t *values)
+{
+    return WICED_BT_SUCCESS;
+}
+
+wiced_result_t beacon_power_set_range(beacon_slot_t *p_slot, uint32_t range_cm)
+{
+    return WICED_BT_SUCCESS;
+}
+
+wiced_result_t beacon_slot_set_data(beacon_slot_t *p_slot, const uint8_t *p_data, uint8_t len)
+{
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_slot_set_params(beacon_slot_t *p_slot,
+                                      const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_slot_start(beacon_slot_t *p_slot, wiced_bool_t start)
+{
+    return WICED_BT_PENDING;
+}
+
+/* The commit is applied by the manager, counted here */
+void beacon_manager_defer(beacon_manager_fn_t *p_fn)
+{
+    (void)p_fn;
+    test_applied++;
+}
+
+static uint32_t test_random(void)
+{
+    test_seed = (test_seed * 1103515245UL) + 12345UL;
+    return test_seed >> 16;
+}
+
+/* Puts characters on a wire, one character time each after the earlier ones */
+static void test_wire_write(test_wire_t *p_wire, const uint8_t *data, uint32_t len,
+                            uint64_t from_us)
+{
+    uint64_t at_us = (p_wire->busy_us > from_us) ? p_wire->busy_us : from_us;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        at_us += TEST_BYTE_US;
+        p_wire->data[p_wire->head % TEST_WIRE_SIZE]  = data[i];
+        p_wire->at_us[p_wire->head % TEST_WIRE_SIZE] = at_us;
+        p_wire->head++;
+    }
+    p_wire->busy_us = at_us;
+}
+
+static uint64_t test_wire_next(const test_wire_t *p_wire)
+{
+    return (p_wire->head == p_wire->tail) ? UINT64_MAX : p_wire->at_us[p_wire->tail % TEST_WIRE_SIZE];
+}
+
+/* Device side: replies leave after the bridge turnaround */
+static uint64_t test_device_us;
+
+static void test_device_send(const uint8_t *data, uint32_t len)
+{
+    test_replies_sent++;
+    if (test_replies_sent == test_faults.drop_reply)
+    {
+        return;
+    }
+    if (test_faults.drop_commit_ack && (BEACON_PROV_TYPE_ACK == data[2]) &&
+        ((TEST_FRAMES + 1) == data[4]))
+    {
+        test_faults.drop_commit_ack = WICED_FALSE;
+        return;
+    }
+    test_wire_write(&test_rx, data, len, test_device_us + TEST_TURNAROUND_US);
+}
+
+/* Sender side, the session of scripts/beacon_prov.py */
+static void test_write_frame(uint8_t type, uint8_t seq, const uint8_t *payload, uint8_t len)
+{
+    uint8_t frame[BEACON_PROV_FRAME_MAX];
+    uint16_t crc;
+
+    frame[0] = BEACON_PROV_SOF;
+    frame[1] = len;
+    frame[2] = type;
+    frame[3] = seq;
+    memcpy(&frame[4], payload, len);
+    crc = beacon_crc16(&frame[1], 3 + len, 0xFFFF);
+    frame[4 + len] = (uint8_t)crc;
+    frame[5 + len] = (uint8_t)(crc >> 8);
+
+    test_frames_written++;
+    if (test_frames_written == test_faults.corrupt_frame)
+    {
+        frame[4 + len] ^= 0x01;
+    }
+    for (uint32_t i = 0; i < (6U + len); i++)
+    {
+        if ((0 != test_faults.loss_per_mille) && ((test_random() % 1000) < test_faults.loss_per_mille))
+        {
+            frame[i] ^= 0x40;
+        }
+    }
+    test_wire_write(&test_tx, frame, 6U + len, test_now_us);
+}
+
+/* Runs the device until the next reply reaches the sender or the timeout
+ * passes. Returns the reply type, TEST_NO_REPLY on timeout. */
+static uint32_t test_reply(uint8_t *p_expected, uint8_t *p_status)
+{
+    uint64_t deadline_us = test_now_us + TEST_TIMEOUT_US;
+    uint8_t reply[8];
+
+    for (;;)
+    {
+        uint64_t byte_us  = test_wire_next(&test_tx);
+        uint64_t reply_us = test_wire_next(&test_rx);
+
+        if ((reply_us <= byte_us) && (reply_us <= deadline_us))
+        {
+            /* Replies are written whole, take the last character's time */
+            for (uint32_t i = 0; i < sizeof(reply); i++)
+            {
+                test_now_us = test_rx.at_us[test_rx.tail % TEST_WIRE_SIZE];
+                reply[i] = test_rx.data[test_rx.tail % TEST_WIRE_SIZE];
+                test_rx.tail++;
+            }
+            CHECK_EQ(reply[0], BEACON_PROV_SOF);
+            CHECK_EQ(beacon_crc16(&reply[1], 5, 0xFFFF), reply[6] | (reply[7] << 8));
+            *p_expected = reply[4];
+            *p_status   = reply[5];
+            return reply[2];
+        }
+
+        if (byte_us > deadline_us)
+        {
+            test_now_us = deadline_us;
+            return TEST_NO_REPLY;
+        }
+
+        /* The console task takes every character as it arrives and calls
+         * the idle function when the ring is empty again */
+        test_device_us = byte_us;
+        beacon_prov_input(test_tx.data[test_tx.tail % TEST_WIRE_SIZE]);
+        test_tx.tail++;
+        if (test_wire_next(&test_tx) > byte_us)
+        {
+            (void)beacon_prov_idle();
+        }
+    }
+}
+
+/* Go-back-N session as in beacon_prov.py, returns the commit status or -1 */
+static int test_session(uint32_t window)
+{
+    uint8_t expected = 0;
+    uint8_t status   = 0;
+    uint32_t type;
+    uint32_t base    = 0;
+    uint32_t sent    = 0;
+    uint32_t retries = 0;
+    uint32_t attempt;
+
+    for (attempt = 0; attempt < 3; attempt++)
+    {
+        test_write_frame(BEACON_PROV_TYPE_BEGIN, 0, NULL, 0);
+        type = test_reply(&expected, &status);
+        if ((BEACON_PROV_TYPE_ACK == type) && (1 == expected))
+        {
+            break;
+        }
+    }
+    if (3 == attempt)
+    {
+        return -1;
+    }
+
+    while (base < TEST_FRAMES)
+    {
+        while ((sent < TEST_FRAMES) && (sent < base + window))
+        {
+            if (sent < TEST_RECORDS)
+            {
+                test_write_frame(test_payload_type[sent], (uint8_t)(sent + 1),
+                                 test_payload[sent], test_payload_len[sent]);
+            }
+            else
+            {
+                test_write_frame(BEACON_PROV_TYPE_COMMIT, (uint8_t)(sent + 1), NULL, 0);
+            }
+            sent++;
+        }
+
+        type = test_reply(&expected, &status);
+        if (TEST_NO_REPLY == type)
+        {
+            if (++retries > 5)
+            {
+                return -1;
+            }
+            test_retransmitted += sent - base;
+            sent = base;
+            continue;
+        }
+
+        {
+            uint32_t acked = (uint8_t)(expected - 1 - base);
+
+            if (acked <= sent - base)
+            {
+                base   += acked;
+                retries = 0;
+            }
+        }
+        if (BEACON_PROV_TYPE_NAK == type)
+        {
+            test_retransmitted += sent - base;
+            sent = base;
+        }
+        if (0 != status)
+        {
+            test_write_frame(BEACON_PROV_TYPE_ABORT, (uint8_t)(base + 1), NULL, 0);
+            return status;
+        }
+    }
+    return 0;
+}
+
+/* Lets the device take what is still on the wire and drops its replies */
+static void test_drain(void)
+{
+    while (test_wire_next(&test_tx) != UINT64_MAX)
+    {
+        test_now_us = test_wire_next(&test_tx);
+        (void)test_reply(&(uint8_t){ 0 }, &(uint8_t){ 0 });
+    }
+    if (test_rx.busy_us > test_now_us)
+    {
+        test_now_us = test_rx.busy_us;
+    }
+    test_rx.tail = test_rx.head;
+}
+
+/* Runs a session, then lets the device answer what is still on the wire */
+static int test_run(uint32_t window, const test_faults_t *p_faults)
+{
+    int result;
+
+    test_faults         = *p_faults;
+    test_frames_written = 0;
+    test_replies_sent   = 0;
+
+    result = test_session(window);
+
+    test_drain();
+    return result;
+}
+
+/* Four slots with 30 octets of data and two keys */
+static void test_config(uint8_t variant)
+{
+    for (uint8_t i = 0; i < TEST_SLOTS; i++)
+    {
+        uint8_t *p = test_payload[i];
+
+        p[0] = i + 1;
+        p[1] = 0xA0;
+        p[2] = 0x00;
+        p[3] = 0xA0;
+        p[4] = 0x00;
+        p[5] = 4;
+        p[6] = 0x02;
+        p[7] = 0x01;
+        p[8] = 0x04;
+        p[9] = 26;
+        p[10] = 0xFF;
+        for (uint8_t j = 11; j < BEACON_PROV_SLOT_HEADER_LEN + 30; j++)
+        {
+            p[j] = (uint8_t)(variant + i + j);
+        }
+        test_payload_type[i] = BEACON_PROV_TYPE_SLOT;
+        test_payload_len[i]  = BEACON_PROV_SLOT_HEADER_LEN + 30;
+    }
+    for (uint8_t i = 0; i < TEST_KEYS; i++)
+    {
+        uint8_t *p = test_payload[TEST_SLOTS + i];
+
+        p[0] = i + 1;
+        for (uint8_t j = 0; j < BEACON_STORE_KEY_LEN; j++)
+        {
+            p[1 + j] = (uint8_t)(variant * 7 + i * 16 + j);
+        }
+        test_payload_type[TEST_SLOTS + i] = BEACON_PROV_TYPE_KEY;
+        test_payload_len[TEST_SLOTS + i]  = 1 + BEACON_STORE_KEY_LEN;
+    }
+}
+
+/* The store holds exactly the records of the configuration */
+static void test_check_store(void)
+{
+    for (uint8_t i = 0; i < TEST_SLOTS; i++)
+    {
+        const beacon_store_slot_t *p_slot = beacon_store_get_slot(i + 1);
+
+        CHECK(NULL != p_slot);
+        if (NULL != p_slot)
+        {
+            CHECK_EQ(p_slot->adv_len, 30);
+            CHECK(0 == memcmp(p_slot->adv_data, &test_payload[i][BEACON_PROV_SLOT_HEADER_LEN],
+                              30));
+        }
+    }
+    for (uint8_t i = 0; i < TEST_KEYS; i++)
+    {
+        const uint8_t *p_key = beacon_store_get_key(i + 1);
+
+        CHECK(NULL != p_key);
+        if (NULL != p_key)
+        {
+            CHECK(0 == memcmp(p_key, &test_payload[TEST_SLOTS + i][1], BEACON_STORE_KEY_LEN));
+        }
+    }
+}
+
+/* Each fault is recovered within the session and the commit is written once */
+static void test_recovery(void)
+{
+    static const struct
+    {
+        const char *name;
+        test_faults_t faults;
+    } cases[] =
+    {
+        { "no fault",               { 0, 0, WICED_FALSE, 0 } },
+        { "record CRC error",       { 3, 0, WICED_FALSE, 0 } },
+        { "COMMIT CRC error",       { 1 + TEST_FRAMES, 0, WICED_FALSE, 0 } },
+        { "BEGIN ACK lost",         { 0, 1, WICED_FALSE, 0 } },
+        { "record ACK lost",        { 0, 2, WICED_FALSE, 0 } },
+        { "COMMIT ACK lost",        { 0, 0, WICED_TRUE, 0 } },
+    };
+    const beacon_prov_stats_t *p_stats = beacon_prov_get_stats();
+
+    for (uint32_t window = 1; window <= BEACON_PROV_WINDOW; window += BEACON_PROV_WINDOW - 1)
+    {
+        for (uint8_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+        {
+            uint32_t commits = p_stats->commits;
+            uint32_t applied = test_applied;
+            uint32_t crc_errors = p_stats->crc_errors;
+            uint32_t sessions = p_stats->sessions;
+            uint64_t start_us = test_now_us;
+            int result;
+
+            test_config((uint8_t)(window * 16 + c));
+            beacon_prov_begin(test_device_send);
+            result = test_run(window, &cases[c].faults);
+            beacon_prov_end();
+
+            printf("window %lu, %-18s %s in %lu ms\n", (unsigned long)window, cases[c].name,
+                   (0 == result) ? "committed" : "FAILED",
+                   (unsigned long)((test_now_us - start_us) / 1000));
+
+            /* A repeated COMMIT is acknowledged as a duplicate, not written again */
+            CHECK_EQ(result, 0);
+            CHECK_EQ(p_stats->commits, commits + 1);
+            CHECK_EQ(test_applied, applied + 1);
+            CHECK_EQ(p_stats->crc_errors - crc_errors, (0 != cases[c].faults.corrupt_frame) ? 1 : 0);
+            CHECK_EQ(p_stats->sessions - sessions, (1 == cases[c].faults.drop_reply) ? 2 : 1);
+            test_check_store();
+        }
+    }
+}
+
+/* Throughput in configurations per second over TEST_SESSIONS sessions */
+static uint32_t test_throughput(uint32_t window, uint32_t loss_per_mille)
+{
+    test_faults_t faults = { 0, 0, WICED_FALSE, loss_per_mille };
+    const beacon_prov_stats_t *p_stats = beacon_prov_get_stats();
+    uint32_t commits = p_stats->commits;
+    uint64_t start_us;
+    uint32_t per_s;
+
+    test_config(0x55);
+    beacon_prov_begin(test_device_send);
+    start_us = test_now_us;
+    test_retransmitted = 0;
+
+    /* Back to back like beacon_prov.py --repeat, stale replies are skipped by
+     * the next BEGIN */
+    test_faults = faults;
+    for (uint32_t i = 0; i < TEST_SESSIONS; i++)
+    {
+        CHECK_EQ(test_session(window), 0);
+    }
+    test_drain();
+    beacon_prov_end();
+
+    CHECK_EQ(p_stats->commits, commits + TEST_SESSIONS);
+    test_check_store();
+
+    per_s = (uint32_t)(((uint64_t)TEST_SESSIONS * TEST_RECORDS * 1000000ULL) /
+                       (test_now_us - start_us));
+    printf("window %lu, %lu.%lu%% loss: %lu configs/s, %lu frames resent\n",
+           (unsigned long)window, (unsigned long)(loss_per_mille / 10),
+           (unsigned long)(loss_per_mille % 10), (unsigned long)per_s,
+           (unsigned long)test_retransmitted);
+    return per_s;
+}
+
+int main(void)
+{
+    uint32_t window_8;
+    uint32_t window_1;
+
+    beacon_store_init();
+
+    test_recovery();
+
+    window_8 = test_throughput(BEACON_PROV_WINDOW, 0);
+    window_1 = test_throughput(1, 0);
+    CHECK(window_8 > window_1);
+
+    /* Corrupted characters are recovered by NAKs and timeouts */
+    (void)test_throughput(BEACON_PROV_WINDOW, 3);
+
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
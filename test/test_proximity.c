@@ -0,0 +1,320 @@
+/******************************************************************************
+* File Name: test_proximity.c
+*
+* Description: Host tests and benchmarks of the proximity filter against a
+* double precision reference of the same Kalman filter: distance table,
+* tracking of moving beacons with RSSI noise, zone stability and the cost
+* of an update
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "test.h"
+#include "beacon_power.h"
+#include "beacon_proximity.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_BEACONS                     (200)
+#define TEST_REPORTS                     (3000)
+#define TEST_BENCH_REPORTS               (20000000UL)
+#define TEST_BENCH_RSSI                  (4096)
+
+/* The fixed point filter must follow the reference this closely */
+#define TEST_MEAN_ERROR_MAX              (0.005)
+#define TEST_MAX_ERROR_MAX               (0.03)
+#define TEST_ZONE_AGREEMENT_MIN          (0.995)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Reference filter, in double precision */
+typedef struct
+{
+    double loss;                                /* Path loss beyond 1 m in dB */
+    double var;                                 /* Its variance */
+    double time_s;                              /* Time of the last sample */
+    int zone;                                   /* beacon_proximity_zone_t */
+}test_ref_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+/* Path loss at the outer bounds of the immediate and near zones */
+static double test_bound[2];
+
+static int8_t test_rssi[TEST_BENCH_RSSI];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+static double test_uniform(void)
+{
+    return (rand() + 0.5) / ((double)RAND_MAX + 1);
+}
+
+static double test_gauss(void)
+{
+    return sqrt(-2 * log(test_uniform())) * cos(2 * M_PI * test_uniform());
+}
+
+static void test_ref_update(test_ref_t *p_ref, double loss, double time_s)
+{
+    double noise = (double)BEACON_PROXIMITY_RSSI_NOISE_DB * BEACON_PROXIMITY_RSSI_NOISE_DB;
+    double drift = (double)BEACON_PROXIMITY_DRIFT_DB * BEACON_PROXIMITY_DRIFT_DB;
+    double hysteresis = BEACON_PROXIMITY_HYSTERESIS_DB;
+    double dt;
+    double var;
+    double gain;
+    int zone = p_ref->zone;
+
+    if (BEACON_PROXIMITY_UNKNOWN == zone)
+    {
+        p_ref->loss = loss;
+        p_ref->var  = noise;
+        zone        = BEACON_PROXIMITY_NEAR;
+        hysteresis  = 0;
+    }
+    else
+    {
+        dt           = fmin(time_s - p_ref->time_s, 10);
+        var          = p_ref->var + drift * dt;
+        gain         = var / (var + noise);
+        p_ref->loss += gain * (loss - p_ref->loss);
+        p_ref->var   = (1 - gain) * var;
+    }
+    p_ref->time_s = time_s;
+
+    while ((zone > BEACON_PROXIMITY_IMMEDIATE) && (p_ref->loss < test_bound[zone - 2] - hysteresis))
+    {
+        zone--;
+    }
+    while ((zone < BEACON_PROXIMITY_FAR) && (p_ref->loss >= test_bound[zone - 1] + hysteresis))
+    {
+        zone++;
+    }
+    p_ref->zone = zone;
+}
+
+static double test_ref_distance_cm(const test_ref_t *p_ref)
+{
+    return 100 * pow(10, p_ref->loss / BEACON_POWER_PATH_LOSS_X10);
+}
+
+/* The distance table follows the path loss model from 1 m on */
+static void test_distance(void)
+{
+    beacon_proximity_t prox = { .zone = BEACON_PROXIMITY_FAR };
+    double max_error = 0;
+    double reference;
+
+    for (int32_t q = 0; q <= 60 * 256; q++)
+    {
+        prox.loss_q8 = (int16_t)q;
+        reference    = 100 * pow(10, q / 256.0 / BEACON_POWER_PATH_LOSS_X10);
+        if (reference > 99999)
+        {
+            break;
+        }
+        max_error = fmax(max_error, fabs(beacon_proximity_distance_cm(&prox) - reference) /
+                                    reference);
+    }
+    printf("proximity: distance table within %.2f%% of the model from 1 m\n", 100 * max_error);
+    CHECK(max_error < 0.01);
+}
+
+/* Beacons walking between 0.1 and 15 m with 4 dB of RSSI noise, iBeacon
+ * and Eddystone measured power */
+static void test_tracking(void)
+{
+    beacon_frame_info_t info = { .measured_power_offset = 1 };
+    beacon_proximity_t prox;
+    test_ref_t ref;
+    double sum_error = 0;
+    double max_error = 0;
+    double sum_true_fixed = 0;
+    double sum_true_float = 0;
+    double pos;
+    double vel;
+    double loss;
+    double fixed_cm;
+    double float_cm;
+    double error;
+    uint32_t reports = 0;
+    uint32_t zone_agree = 0;
+    uint32_t changes = 0;
+    uint32_t raw_changes = 0;
+    uint32_t time_ms;
+    int last_zone;
+    int last_raw;
+    int raw;
+    int rssi;
+
+    srand(1);
+    for (uint32_t b = 0; b < TEST_BEACONS; b++)
+    {
+        memset(&prox, 0, sizeof(prox));
+        memset(&ref, 0, sizeof(ref));
+        info.format         = (b & 1) ? BEACON_FORMAT_IBEACON : BEACON_FORMAT_EDDYSTONE_URL;
+        info.measured_power = (b & 1) ? -59 : (-59 + 41);
+        pos       = 0.2 + test_uniform() * 8;
+        vel       = 0;
+        time_ms   = 0;
+        last_zone = 0;
+        last_raw  = 0;
+
+        for (uint32_t i = 0; i < TEST_REPORTS; i++)
+        {
+            time_ms += 100 + (rand() % 10);
+            vel      = fmax(-1.2, fmin(1.2, vel + test_gauss() * 0.02));
+            pos     += vel * 0.1;
+            if ((pos < 0.1) || (pos > 15))
+            {
+                pos = fmax(0.1, fmin(15, pos));
+                vel = -vel;
+            }
+
+            rssi = (int)lround(-59 - BEACON_POWER_PATH_LOSS_X10 * log10(pos) + test_gauss() * 4);
+            rssi = (rssi < -127) ? -127 : ((rssi > 20) ? 20 : rssi);
+            beacon_proximity_update(&prox, &info, (int8_t)rssi, time_ms);
+
+            loss = -59 - rssi;
+            test_ref_update(&ref, loss, time_ms / 1000.0);
+
+            fixed_cm   = beacon_proximity_distance_cm(&prox);
+            float_cm   = test_ref_distance_cm(&ref);
+            error      = fabs(fixed_cm - float_cm) / float_cm;
+            sum_error += error;
+            if (float_cm >= 100)
+            {
+                max_error = fmax(max_error, error);
+            }
+            sum_true_fixed += fabs(fixed_cm / 100 - pos) / pos;
+            sum_true_float += fabs(float_cm / 100 - pos) / pos;
+            zone_agree     += (prox.zone == ref.zone) ? 1 : 0;
+            reports++;
+
+            changes  += ((0 != last_zone) && (last_zone != prox.zone)) ? 1 : 0;
+            last_zone = prox.zone;
+            raw       = (loss < test_bound[0]) ? BEACON_PROXIMITY_IMMEDIATE :
+                        ((loss < test_bound[1]) ? BEACON_PROXIMITY_NEAR : BEACON_PROXIMITY_FAR);
+            raw_changes += ((0 != last_raw) && (last_raw != raw)) ? 1 : 0;
+            last_raw     = raw;
+        }
+    }
+
+    printf("proximity: %lu reports, fixed point vs reference distance %.2f%% mean, %.2f%% max "
+           "from 1 m, zone agreement %.2f%%\n", (unsigned long)reports,
+           100 * sum_error / reports, 100 * max_error, 100.0 * zone_agree / reports);
+    printf("proximity: error to the true distance %.1f%% fixed point, %.1f%% reference, "
+           "%lu zone changes against %lu unfiltered\n", 100 * sum_true_fixed / reports,
+           100 * sum_true_float / reports, (unsigned long)changes, (unsigned long)raw_changes);
+
+    CHECK(sum_error / reports < TEST_MEAN_ERROR_MAX);
+    CHECK(max_error < TEST_MAX_ERROR_MAX);
+    CHECK((double)zone_agree / reports > TEST_ZONE_AGREEMENT_MIN);
+    CHECK(changes * 10 < raw_changes);
+}
+
+/* Cost of an update and a distance readout per report */
+static void test_bench(void)
+{
+    beacon_frame_info_t info =
+    {
+        .format                = BEACON_FORMAT_IBEACON,
+        .measured_power        = -59,
+        .measured_power_offset = 1
+    };
+    beacon_proximity_t prox;
+    test_ref_t ref;
+    volatile uint32_t sink = 0;
+    volatile double float_sink = 0;
+    uint64_t start;
+    double update_ns;
+    double distance_ns;
+    double float_ns;
+
+    for (uint32_t i = 0; i < TEST_BENCH_RSSI; i++)
+    {
+        test_rssi[i] = (int8_t)(-60 - (rand() % 30));
+    }
+
+    memset(&prox, 0, sizeof(prox));
+    start = test_now_ns();
+    for (uint32_t i = 0; i < TEST_BENCH_REPORTS; i++)
+    {
+        beacon_proximity_update(&prox, &info, test_rssi[i & (TEST_BENCH_RSSI - 1)], i * 100);
+    }
+    update_ns = (double)(test_now_ns() - start) / TEST_BENCH_REPORTS;
+
+    start = test_now_ns();
+    for (uint32_t i = 0; i < TEST_BENCH_REPORTS; i++)
+    {
+        prox.loss_q8 = (int16_t)(test_rssi[i & (TEST_BENCH_RSSI - 1)] * -256);
+        sink        += beacon_proximity_distance_cm(&prox);
+    }
+    distance_ns = (double)(test_now_ns() - start) / TEST_BENCH_REPORTS;
+
+    memset(&ref, 0, sizeof(ref));
+    start = test_now_ns();
+    for (uint32_t i = 0; i < TEST_BENCH_REPORTS; i++)
+    {
+        test_ref_update(&ref, -59 - test_rssi[i & (TEST_BENCH_RSSI - 1)], i * 0.1);
+        float_sink += test_ref_distance_cm(&ref);
+    }
+    float_ns = (double)(test_now_ns() - start) / TEST_BENCH_REPORTS;
+
+    printf("proximity: %.1f ns per update, %.1f ns per distance, reference %.1f ns for both\n",
+           update_ns, distance_ns, float_ns);
+}
+
+int main(void)
+{
+    beacon_proximity_init();
+    test_bound[0] = BEACON_POWER_PATH_LOSS_X10 * log10(BEACON_PROXIMITY_IMMEDIATE_CM / 100.0);
+    test_bound[1] = BEACON_POWER_PATH_LOSS_X10 * log10(BEACON_PROXIMITY_NEAR_CM / 100.0);
+
+    test_distance();
+    test_tracking();
+    test_bench();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
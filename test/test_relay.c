@@ -0,0 +1,420 @@
+/******************************************************************************
+* File Name: test_relay.c
+*
+* Description: Host tests of the beacon relay. The simulated controller reports
+* a remote iBeacon through the scan callback of the observer, the relay
+* advertises it on a spare instance.
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "host.h"
+#include "beacon_manager.h"
+#include "beacon_observer.h"
+#include "beacon_relay.h"
+#include "beacon_slot.h"
+#include "beacon_stats.h"
+#include "beacon_timer.h"
+#include "beacon_worker.h"
+#include "beacon_sim.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Spare instance the relay advertises on */
+#define TEST_INSTANCE                    (3)
+
+#define TEST_REPORT_MS                   (100)
+#define TEST_MIN_INTERVAL_MS             (500)
+#define TEST_TTL_MS                      (1000)
+
+/* Controller latency while reports keep coming, so payloads are replaced */
+#define TEST_SLOW_LATENCY_MS             (150)
+#define TEST_FAST_REPORT_MS              (40)
+
+/* Scan report to set data response, with the controller latency of 2 ms */
+#define TEST_LATENCY_MAX_US              (50000)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static uint8_t test_uuid[LEN_UUID_128] =
+{
+    0xA1, 0xB2, 0xC3, 0xD4, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70, 0x80, 0x90, 0xA0, 0xB0, 0xC0
+};
+
+static const wiced_bt_ble_multi_adv_params_t test_params =
+{
+    .adv_int_min = 160,
+    .adv_int_max = 160,
+    .adv_type    = MULTI_ADVERT_NONCONNECTABLE_EVENT,
+    .channel_map = BTM_BLE_ADVERT_CHNL_37 | BTM_BLE_ADVERT_CHNL_38 | BTM_BLE_ADVERT_CHNL_39,
+};
+
+/* Rate limited relay, then one updating on every report */
+static const beacon_relay_rule_t test_limited_rule =
+{
+    .format          = BEACON_FORMAT_IBEACON,
+    .id_prefix       = test_uuid,
+    .id_prefix_len   = 4,
+    .instance        = TEST_INSTANCE,
+    .min_interval_ms = TEST_MIN_INTERVAL_MS,
+    .ttl_ms          = TEST_TTL_MS,
+};
+
+static const beacon_relay_rule_t test_eager_rule =
+{
+    .format          = BEACON_FORMAT_IBEACON,
+    .id_prefix       = test_uuid,
+    .id_prefix_len   = 4,
+    .instance        = TEST_INSTANCE,
+    .min_interval_ms = 0,
+    .ttl_ms          = TEST_TTL_MS,
+};
+
+static beacon_sim_remote_t test_remote =
+{
+    .bd_addr = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 },
+    .rssi    = -60,
+};
+
+static wiced_bool_t test_enabled;
+static uint32_t test_restarted;
+static uint32_t test_records;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Application side of the stack, as in main.c */
+static wiced_result_t test_management_cback(wiced_bt_management_evt_t event,
+                                            wiced_bt_management_evt_data_t *p_event_data)
+{
+    beacon_manager_evt_t evt;
+
+    evt.rx_cycles = beacon_stats_cycles();
+    if (BTM_ENABLED_EVT == event)
+    {
+        evt.type = BEACON_MANAGER_EVT_ENABLED;
+        evt.data.enabled_status = p_event_data->enabled.status;
+        (void)beacon_manager_post(&evt);
+    }
+    else if (BTM_MULTI_ADVERT_RESP_EVENT == event)
+    {
+        evt.type = BEACON_MANAGER_EVT_MULTI_ADV_RESP;
+        evt.data.multi_adv.opcode = p_event_data->ble_multi_adv_response_event.opcode;
+        evt.data.multi_adv.status = p_event_data->ble_multi_adv_response_event.status;
+        (void)beacon_manager_post(&evt);
+    }
+    beacon_manager_cback_done(evt.rx_cycles);
+    return WICED_BT_SUCCESS;
+}
+
+/* A second enabled event is a restart of the controller, as in main.c
+ * without the health monitor */
+static void test_on_enabled(const beacon_manager_evt_t *p_evt)
+{
+    if (test_enabled)
+    {
+        test_restarted += beacon_slot_restart();
+    }
+    test_enabled = (WICED_BT_SUCCESS == p_evt->data.enabled_status) ? WICED_TRUE : WICED_FALSE;
+}
+
+static void test_on_response(const beacon_manager_evt_t *p_evt)
+{
+    beacon_slot_on_response(p_evt->data.multi_adv.opcode, p_evt->data.multi_adv.status);
+}
+
+static void test_on_record(const beacon_cache_record_t *p_record)
+{
+    (void)p_record;
+    test_records++;
+}
+
+/* The remote beacon advertises minor, 0 silences it */
+static void test_remote_set(uint16_t minor, uint32_t period_ms)
+{
+    uint8_t len;
+
+    memset(test_remote.adv_data, 0, sizeof(test_remote.adv_data));
+    ibeacon_set_adv_data(test_uuid, 1, minor, 0xC5, test_remote.adv_data, &len);
+    test_remote.period_ms = period_ms;
+    CHECK(beacon_sim_set_remote(&test_remote));
+}
+
+/* Commands of the relay instance since a trace index, counted by opcode and
+ * for enable commands by their direction */
+static uint32_t test_commands(uint32_t from, uint8_t opcode)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = from; i < beacon_sim_trace_count(); i++)
+    {
+        const beacon_sim_trace_t *p_trace = beacon_sim_get_trace(i);
+
+        CHECK(NULL != p_trace);
+        if ((NULL != p_trace) && (TEST_INSTANCE == p_trace->instance) &&
+            (opcode == p_trace->sub_opcode))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/* Every matched report ends in exactly one counter once nothing is pending */
+static void test_check_accounting(const beacon_relay_stats_t *p_stats)
+{
+    CHECK_EQ(p_stats->matched, p_stats->drop_rate + p_stats->drop_superseded +
+                               p_stats->drop_failed + p_stats->relayed);
+}
+
+/* First payload configures and starts the instance, later ones only set
+ * data and the rate limit drops the reports in between */
+static void test_rate_limit(void)
+{
+    const beacon_relay_stats_t *p_stats;
+    uint32_t trace_from = beacon_sim_trace_count();
+    uint32_t accepted;
+
+    beacon_relay_init(&test_limited_rule, 1, &test_params);
+    p_stats = beacon_relay_get_stats(0);
+    CHECK(NULL != p_stats);
+
+    for (uint16_t minor = 1; minor <= 5; minor++)
+    {
+        test_remote_set(minor, TEST_REPORT_MS);
+        host_run(250);
+    }
+    test_remote_set(5, 0);
+    host_run(100);
+
+    accepted = p_stats->matched - p_stats->drop_rate;
+
+    CHECK(p_stats->matched >= 10);
+    CHECK((accepted >= 2) && (accepted <= (1250 / TEST_MIN_INTERVAL_MS) + 1));
+    CHECK_EQ(p_stats->relayed, accepted);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_PARAM_MULTI), 1);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_ENABLE_MULTI), 1);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_DATA_MULTI), accepted);
+    test_check_accounting(p_stats);
+
+    /* Scan report to the response confirming the payload on air */
+    CHECK_EQ(p_stats->latency_us.count, p_stats->relayed);
+    CHECK(p_stats->latency_us.max < TEST_LATENCY_MAX_US);
+
+    printf("Rate limit: %lu reports, %lu relayed, %lu dropped\n",
+           (unsigned long)p_stats->matched, (unsigned long)p_stats->relayed,
+           (unsigned long)p_stats->drop_rate);
+    printf("Scan to air: mean %lu us, max %lu us\n",
+           (unsigned long)beacon_latency_mean(&p_stats->latency_us),
+           (unsigned long)p_stats->latency_us.max);
+}
+
+/* Reports arriving while a payload is in flight replace the one waiting */
+static void test_superseded(void)
+{
+    beacon_sim_config_t config = *beacon_sim_get_config();
+    const beacon_relay_stats_t *p_stats;
+
+    config.latency_ms = TEST_SLOW_LATENCY_MS;
+    beacon_sim_configure(&config);
+    beacon_relay_init(&test_eager_rule, 1, &test_params);
+    p_stats = beacon_relay_get_stats(0);
+
+    test_remote_set(6, TEST_FAST_REPORT_MS);
+    host_run(1000);
+    test_remote_set(6, 0);
+    host_run(5 * TEST_SLOW_LATENCY_MS);
+
+    CHECK(p_stats->drop_superseded > 0);
+    CHECK(p_stats->relayed >= 2);
+    CHECK_EQ(p_stats->drop_rate, 0);
+    test_check_accounting(p_stats);
+
+    printf("Superseded: %lu reports, %lu relayed, %lu replaced in the queue\n",
+           (unsigned long)p_stats->matched, (unsigned long)p_stats->relayed,
+           (unsigned long)p_stats->drop_superseded);
+
+    config.latency_ms = BEACON_SIM_LATENCY_MS;
+    beacon_sim_configure(&config);
+}
+
+/* Payloads the controller fails are counted and not relayed */
+static void test_failed(void)
+{
+    beacon_sim_config_t config = *beacon_sim_get_config();
+    const beacon_relay_stats_t *p_stats = beacon_relay_get_stats(0);
+    uint32_t relayed = p_stats->relayed;
+    uint32_t failed  = p_stats->drop_failed;
+
+    config.fail_period  = 1;
+    config.fail_opcodes = 1U << SET_ADVT_DATA_MULTI;
+    beacon_sim_configure(&config);
+
+    test_remote_set(7, TEST_REPORT_MS);
+    host_run(500);
+    test_remote_set(7, 0);
+    host_run(100);
+
+    CHECK(p_stats->drop_failed >= failed + 3);
+    CHECK_EQ(p_stats->relayed, relayed);
+    CHECK_EQ(p_stats->latency_us.count, relayed);
+    test_check_accounting(p_stats);
+
+    config.fail_period  = 0;
+    config.fail_opcodes = 0;
+    beacon_sim_configure(&config);
+}
+
+/* A silent source stops the instance after the TTL, the next report starts
+ * it again */
+static void test_ttl(void)
+{
+    const beacon_relay_stats_t *p_stats = beacon_relay_get_stats(0);
+    uint32_t trace_from = beacon_sim_trace_count();
+    uint32_t events;
+
+    /* The source went silent at the end of the previous test */
+    CHECK_EQ(p_stats->expired, 0);
+    host_run(TEST_TTL_MS);
+
+    CHECK_EQ(p_stats->expired, 1);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_ENABLE_MULTI), 1);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_DATA_MULTI), 0);
+
+    /* Off air */
+    events = beacon_sim_adv_events(TEST_INSTANCE);
+    host_run(500);
+    CHECK_EQ(beacon_sim_adv_events(TEST_INSTANCE), events);
+
+    trace_from = beacon_sim_trace_count();
+    test_remote_set(8, TEST_REPORT_MS);
+    host_run(500);
+
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_PARAM_MULTI), 1);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_ENABLE_MULTI), 1);
+    CHECK(beacon_sim_adv_events(TEST_INSTANCE) > events + 2);
+    CHECK_EQ(p_stats->expired, 1);
+}
+
+/* A controller restart puts the relayed payload back on air, the payload in
+ * flight is reported lost, and the relay keeps updating with data only */
+static void test_restart(void)
+{
+    beacon_sim_config_t config = *beacon_sim_get_config();
+    const beacon_relay_stats_t *p_stats = beacon_relay_get_stats(0);
+    beacon_slot_t *p_slot = beacon_slot_get(TEST_INSTANCE);
+    uint32_t trace_from;
+    uint32_t relayed;
+    uint32_t failed;
+    uint32_t events;
+
+    /* Relaying since the previous test, with a payload in flight */
+    config.latency_ms = TEST_SLOW_LATENCY_MS;
+    beacon_sim_configure(&config);
+    test_remote_set(9, TEST_FAST_REPORT_MS);
+    host_run(2 * TEST_SLOW_LATENCY_MS);
+    CHECK(p_slot->advertising);
+    CHECK(p_slot->cmds_pending > 0);
+
+    test_remote_set(9, 0);
+    config.latency_ms = BEACON_SIM_LATENCY_MS;
+    beacon_sim_configure(&config);
+    failed     = p_stats->drop_failed;
+    trace_from = beacon_sim_trace_count();
+    beacon_sim_restart();
+    host_run(2 * BEACON_SIM_BOOT_MS);
+
+    CHECK_EQ(test_restarted, 1);
+    CHECK(p_slot->advertising);
+    CHECK_EQ(p_stats->drop_failed, failed + 1);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_PARAM_MULTI), 1);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_ENABLE_MULTI), 1);
+    CHECK(!beacon_slot_get(TEST_INSTANCE + 1)->advertising);
+    test_check_accounting(p_stats);
+
+    events     = beacon_sim_adv_events(TEST_INSTANCE);
+    relayed    = p_stats->relayed;
+    trace_from = beacon_sim_trace_count();
+    test_remote_set(10, TEST_REPORT_MS);
+    host_run(500);
+    test_remote_set(10, 0);
+    host_run(100);
+
+    CHECK(p_stats->relayed > relayed);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_PARAM_MULTI), 0);
+    CHECK_EQ(test_commands(trace_from, SET_ADVT_ENABLE_MULTI), 0);
+    CHECK(beacon_sim_adv_events(TEST_INSTANCE) > events + 2);
+    test_check_accounting(p_stats);
+
+    printf("Restart: %lu instance restarted, payload in flight reported lost\n",
+           (unsigned long)test_restarted);
+}
+
+int main(void)
+{
+    beacon_stats_init();
+    beacon_slot_init();
+    beacon_worker_init();
+    beacon_manager_init();
+    beacon_manager_register(BEACON_MANAGER_EVT_ENABLED, test_on_enabled);
+    beacon_manager_register(BEACON_MANAGER_EVT_MULTI_ADV_RESP, test_on_response);
+    beacon_timer_init();
+
+    wiced_bt_stack_init(test_management_cback, NULL);
+    host_run(2 * BEACON_SIM_BOOT_MS);
+    CHECK(test_enabled);
+
+    /* Reports reach the relay through the scan callback and the observer */
+    CHECK_EQ(beacon_observer_start(test_on_record), WICED_BT_SUCCESS);
+
+    test_rate_limit();
+    test_superseded();
+    test_failed();
+    test_ttl();
+    test_restart();
+
+    CHECK(beacon_sim_get_stats()->scan_reports > 0);
+    CHECK(test_records > 0);
+
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
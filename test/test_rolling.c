@@ -0,0 +1,324 @@
+/******************************************************************************
+* File Name: test_rolling.c
+*
+* Description: Host tests of the rolling iBeacon identities: resolution of
+* every device in the epoch window, epochs continuing across a reset through
+* the store, rotations held while an epoch is not reserved, and the cost of
+* a resolver miss
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "../beacon_rolling.c"
+#include "beacon_format.h"
+#include "beacon_power.h"
+#include "beacon_store.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_DEVICES                     (BEACON_ROLLING_MAX_DEVICES)
+#define TEST_EPOCHS                      (200)
+#define TEST_MISS_LOOKUPS                (10000000)
+#define TEST_ROTATIONS                   (40)
+#define TEST_EPOCH_MS                    (1000)
+#define TEST_COUNTER                     (0)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static beacon_aes_ctx_t          test_keys[TEST_DEVICES];
+static beacon_rolling_resolver_t test_resolver;
+static beacon_slot_t             test_slot;
+static uint32_t                  test_now_ms;
+static wiced_bool_t              test_timer_armed;
+static wiced_bool_t              test_reserve_fails;
+static uint32_t                  test_reserves;
+
+/* Identities put on air, as major and minor */
+static uint32_t                  test_on_air[2 * TEST_ROTATIONS + 2];
+static uint32_t                  test_num_on_air;
+
+/* iBeacon of main.c */
+static const uint8_t test_ibeacon[] =
+{
+    0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x01, 0x00, 0x02, 0x00, 0xB9
+};
+
+static const uint8_t test_device_key[BEACON_ROLLING_KEY_LEN] =
+{
+    0x5b, 0xe2, 0x17, 0x8c, 0x40, 0xd9, 0x6a, 0x33, 0xf1, 0x0e, 0x95, 0x7c, 0x28, 0xb4, 0x61, 0xcf
+};
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+wiced_result_t beacon_slot_set_data(beacon_slot_t *p_slot, const uint8_t *p_data, uint8_t len)
+{
+    if (test_num_on_air < (sizeof(test_on_air) / sizeof(test_on_air[0])))
+    {
+        test_on_air[test_num_on_air++] = ((uint32_t)p_data[ROLLING_ID_OFFSET] << 24) |
+                                         ((uint32_t)p_data[ROLLING_ID_OFFSET + 1] << 16) |
+                                         ((uint32_t)p_data[ROLLING_ID_OFFSET + 2] << 8) |
+                                         p_data[ROLLING_ID_OFFSET + 3];
+    }
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_slot_set_params(beacon_slot_t *p_slot,
+                                      const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_slot_start(beacon_slot_t *p_slot, wiced_bool_t start)
+{
+    return WICED_BT_PENDING;
+}
+
+beacon_slot_t *beacon_slot_get(uint8_t instance)
+{
+    return NULL;
+}
+
+wiced_result_t beacon_format_bind(beacon_slot_t *p_slot, const beacon_format_desc_t *p_desc,
+                                  const beacon_format_value_t *values)
+{
+    return WICED_BT_SUCCESS;
+}
+
+wiced_result_t beacon_power_set_range(beacon_slot_t *p_slot, uint32_t range_cm)
+{
+    return WICED_BT_SUCCESS;
+}
+
+uint32_t beacon_stats_now_ms(void)
+{
+    return test_now_ms;
+}
+
+void beacon_timer_setup(beacon_timer_t *p_timer, beacon_timer_cback_t *p_cback, void *p_arg)
+{
+    test_timer_armed = WICED_FALSE;
+}
+
+void beacon_timer_start(beacon_timer_t *p_timer, uint32_t delay_ms)
+{
+    test_timer_armed = WICED_TRUE;
+}
+
+void beacon_worker_register(beacon_worker_job_t *p_job, uint32_t slack_ms)
+{
+    (void)p_job;
+}
+
+void beacon_worker_kick(void)
+{
+}
+
+/* The reserve callback of main.c */
+static wiced_bool_t test_reserve(uint32_t limit)
+{
+    test_reserves++;
+    if (test_reserve_fails)
+    {
+        return WICED_FALSE;
+    }
+    return (WICED_BT_SUCCESS == beacon_store_set_counter(TEST_COUNTER, limit)) ?
+           WICED_TRUE : WICED_FALSE;
+}
+
+/* A reset: RAM state is lost, the store is read back from flash */
+static void test_boot(void)
+{
+    rolling_slot = NULL;
+    beacon_store_init();
+    CHECK_EQ(beacon_rolling_start(&test_slot, test_device_key,
+                                  beacon_store_get_counter(TEST_COUNTER), TEST_EPOCH_MS,
+                                  test_reserve), WICED_BT_PENDING);
+}
+
+/* One epoch: the worker runs, then the rotation is due */
+static void test_rotate(void)
+{
+    (void)beacon_rolling_job(test_now_ms);
+    test_now_ms += TEST_EPOCH_MS;
+    beacon_rolling_rotate(&rolling_timer);
+}
+
+/* Every device resolves in the previous, current and next epoch, an
+ * identity outside the window does not */
+static void test_resolve(void)
+{
+    uint8_t key[BEACON_ROLLING_KEY_LEN];
+    uint8_t id[BEACON_ROLLING_ID_LEN];
+    uint32_t errors = 0;
+    uint32_t epoch;
+    uint16_t device;
+
+    srand(1);
+    for (uint16_t d = 0; d < TEST_DEVICES; d++)
+    {
+        for (uint8_t i = 0; i < BEACON_ROLLING_KEY_LEN; i++)
+        {
+            key[i] = (uint8_t)rand();
+        }
+        beacon_aes_init(&test_keys[d], key);
+    }
+    beacon_rolling_resolver_init(&test_resolver, test_keys, TEST_DEVICES);
+
+    for (uint32_t e = 0; e < TEST_EPOCHS; e++)
+    {
+        beacon_rolling_resolver_set_epoch(&test_resolver, e);
+        for (uint16_t d = 0; d < TEST_DEVICES; d++)
+        {
+            for (uint32_t at = (0 == e) ? e : (e - 1); at <= e + 1; at++)
+            {
+                beacon_rolling_id(&test_keys[d], at, id);
+                epoch  = 0xFFFFFFFFUL;
+                device = beacon_rolling_resolve(&test_resolver, (uint16_t)((id[0] << 8) | id[1]),
+                                                (uint16_t)((id[2] << 8) | id[3]), &epoch);
+                errors += ((device != d) || (epoch != at)) ? 1 : 0;
+            }
+        }
+
+        beacon_rolling_id(&test_keys[0], e + 5, id);
+        CHECK_EQ(beacon_rolling_resolve(&test_resolver, (uint16_t)((id[0] << 8) | id[1]),
+                                        (uint16_t)((id[2] << 8) | id[3]), &epoch),
+                 BEACON_ROLLING_NONE);
+    }
+    CHECK_EQ(errors, 0);
+}
+
+/* Identities continue after a reset instead of starting over */
+static void test_reset(void)
+{
+    uint32_t first_boot;
+
+    memcpy(test_slot.adv_data, test_ibeacon, sizeof(test_ibeacon));
+    test_slot.adv_len = sizeof(test_ibeacon);
+
+    test_boot();
+    CHECK_EQ(rolling_epoch, 0);
+    CHECK_EQ(beacon_store_get_counter(TEST_COUNTER), BEACON_ROLLING_EPOCH_BLOCK);
+    for (uint32_t i = 0; i < TEST_ROTATIONS; i++)
+    {
+        test_rotate();
+    }
+    first_boot = rolling_epoch;
+    CHECK_EQ(first_boot, TEST_ROTATIONS);
+    CHECK_EQ(rolling_stats.unreserved, 0);
+    CHECK(beacon_store_get_counter(TEST_COUNTER) > first_boot);
+    CHECK(test_reserves < 1 + (TEST_ROTATIONS / BEACON_ROLLING_EPOCH_BLOCK) + 2);
+
+    test_boot();
+    CHECK(rolling_epoch > first_boot);
+    for (uint32_t i = 0; i < TEST_ROTATIONS; i++)
+    {
+        test_rotate();
+    }
+
+    /* No identity went on air twice */
+    CHECK_EQ(test_num_on_air, 2 * (TEST_ROTATIONS + 1));
+    for (uint32_t i = 0; i < test_num_on_air; i++)
+    {
+        for (uint32_t j = i + 1; j < test_num_on_air; j++)
+        {
+            CHECK(test_on_air[i] != test_on_air[j]);
+        }
+    }
+}
+
+/* An epoch that could not be reserved is not put on air */
+static void test_unreserved(void)
+{
+    uint32_t epoch;
+    uint32_t on_air;
+
+    test_reserve_fails = WICED_TRUE;
+    while ((rolling_limit - rolling_epoch) > 1)
+    {
+        test_rotate();
+    }
+    epoch  = rolling_epoch;
+    on_air = test_num_on_air;
+
+    test_rotate();
+    CHECK_EQ(rolling_epoch, epoch);
+    CHECK_EQ(test_num_on_air, on_air);
+    CHECK_EQ(rolling_stats.unreserved, 1);
+    CHECK(test_timer_armed);
+
+    test_reserve_fails = WICED_FALSE;
+    test_rotate();
+    CHECK_EQ(rolling_epoch, epoch + 1);
+    CHECK(beacon_store_get_counter(TEST_COUNTER) > rolling_epoch);
+}
+
+/* Cost of an identity that is not in the window, the common case */
+static void test_bench(void)
+{
+    volatile uint32_t found = 0;
+    uint32_t epoch;
+    uint64_t start;
+
+    start = test_now_ns();
+    for (uint32_t i = 0; i < TEST_MISS_LOOKUPS; i++)
+    {
+        found += (BEACON_ROLLING_NONE != beacon_rolling_resolve(&test_resolver, (uint16_t)i,
+                                                                (uint16_t)(i * 7), &epoch)) ? 1 : 0;
+    }
+    printf("rolling: %u devices, %.1f ns per lookup, %u tables of %u bytes\n",
+           TEST_DEVICES, (double)(test_now_ns() - start) / TEST_MISS_LOOKUPS,
+           BEACON_ROLLING_WINDOW, (unsigned)sizeof(test_resolver.table[0]));
+}
+
+int main(void)
+{
+    test_resolve();
+    test_reset();
+    test_unreserved();
+    test_bench();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
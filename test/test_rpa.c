@@ -0,0 +1,208 @@
+/******************************************************************************
+* File Name: test_rpa.c
+*
+* Description: Host tests of the resolvable private address rotation: the
+* ah function against the Core specification sample data, resolution, and
+* rotations that find no precomputed address
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "host.h"
+#include "../beacon_rpa.c"
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+/* Core specification Vol 3, Part H, D.7: ah(IRK, 0x708194) = 0x0dfbaa */
+static const uint8_t test_irk[BEACON_RPA_IRK_LEN] =
+{
+    0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05,
+    0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b
+};
+
+static beacon_slot_t  test_slot;
+static wiced_result_t test_params_result = WICED_BT_PENDING;
+static uint32_t       test_params_calls;
+static uint32_t       test_timer_delay;
+static uint32_t       test_kicks;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+/* Collaborators of the module, recorded instead of run */
+wiced_result_t beacon_slot_set_params(beacon_slot_t *p_slot,
+                                      const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    p_slot->params = *p_params;
+    test_params_calls++;
+    return test_params_result;
+}
+
+void beacon_timer_setup(beacon_timer_t *p_timer, beacon_timer_cback_t *p_cback, void *p_arg)
+{
+    p_timer->p_cback = p_cback;
+    p_timer->p_arg   = p_arg;
+}
+
+void beacon_timer_start(beacon_timer_t *p_timer, uint32_t delay_ms)
+{
+    (void)p_timer;
+    test_timer_delay = delay_ms;
+}
+
+void beacon_timer_stop(beacon_timer_t *p_timer)
+{
+    (void)p_timer;
+}
+
+void beacon_worker_register(beacon_worker_job_t *p_job, uint32_t slack_ms)
+{
+    (void)p_job;
+    (void)slack_ms;
+}
+
+void beacon_worker_kick(void)
+{
+    test_kicks++;
+}
+
+uint32_t beacon_stats_cycles(void)
+{
+    return 0;
+}
+
+static void test_ah(void)
+{
+    beacon_aes_ctx_t irk;
+    wiced_bt_device_address_t rpa;
+
+    beacon_aes_init(&irk, test_irk);
+    CHECK_EQ(beacon_rpa_ah(&irk, 0x708194), 0x0dfbaa);
+
+    beacon_rpa_generate(&irk, 0x708194, rpa);
+    CHECK_EQ(rpa[0], 0x70);
+    CHECK_EQ(rpa[2], 0x94);
+    CHECK_EQ(rpa[3], 0x0d);
+    CHECK_EQ(rpa[5], 0xaa);
+    CHECK(beacon_rpa_resolve(&irk, rpa));
+
+    rpa[5] ^= 0x01;
+    CHECK(!beacon_rpa_resolve(&irk, rpa));
+}
+
+/* Every generated address is an RPA of the slot's IRK */
+static void test_addresses(void)
+{
+    beacon_rpa_slot_t rpa_slot;
+    wiced_bt_device_address_t rpa;
+
+    memset(&rpa_slot, 0, sizeof(rpa_slot));
+    beacon_aes_init(&rpa_slot.irk, test_irk);
+    rpa_mutex = xSemaphoreCreateMutexStatic(&rpa_mutex_buffer);
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        uint32_t prand;
+
+        beacon_rpa_new_address(&rpa_slot, rpa);
+        prand = ((uint32_t)rpa[0] << 16) | ((uint32_t)rpa[1] << 8) | rpa[2];
+        CHECK_EQ(rpa[0] & 0xC0, 0x40);
+        CHECK((prand & RPA_PRAND_RANDOM_MASK) != 0);
+        CHECK((prand & RPA_PRAND_RANDOM_MASK) != RPA_PRAND_RANDOM_MASK);
+        CHECK(beacon_rpa_resolve(&rpa_slot.irk, rpa));
+    }
+    rpa_mutex = NULL;
+}
+
+/* The manager never generates an address: a late rotation keeps the current
+ * one, kicks the worker and retries */
+static void test_rotation(void)
+{
+    beacon_rpa_slot_t *p_rpa;
+    wiced_bt_device_address_t first;
+    uint32_t kicks;
+
+    host_trng_seed(1234);
+    test_slot.stats.params_updates = 1;
+    CHECK_EQ(beacon_rpa_enable(&test_slot, test_irk, BEACON_RPA_PERIOD_MS), WICED_BT_SUCCESS);
+    p_rpa = beacon_rpa_find(&test_slot);
+    CHECK(NULL != p_rpa);
+    CHECK(!p_rpa->next_ready);
+    memcpy(first, p_rpa->current_addr, BD_ADDR_LEN);
+    CHECK(beacon_rpa_resolve(&p_rpa->irk, first));
+
+    kicks = test_kicks;
+    beacon_rpa_rotate(&p_rpa->rotation_timer);
+    CHECK_EQ(p_rpa->stats.late, 1);
+    CHECK_EQ(p_rpa->stats.rotations, 0);
+    CHECK_EQ(test_params_calls, 0);
+    CHECK_EQ(test_timer_delay, RPA_LATE_RETRY_MS);
+    CHECK_EQ(test_kicks, kicks + 1);
+    CHECK(0 == memcmp(first, p_rpa->current_addr, BD_ADDR_LEN));
+
+    /* The worker catches up and the retry puts the new address on air */
+    (void)beacon_rpa_job(0);
+    CHECK(p_rpa->next_ready);
+    beacon_rpa_rotate(&p_rpa->rotation_timer);
+    CHECK_EQ(p_rpa->stats.rotations, 1);
+    CHECK_EQ(test_params_calls, 1);
+    CHECK_EQ(test_timer_delay, BEACON_RPA_PERIOD_MS);
+    CHECK(!p_rpa->next_ready);
+    CHECK(0 != memcmp(first, p_rpa->current_addr, BD_ADDR_LEN));
+    CHECK(0 == memcmp(test_slot.params.own_bd_addr, p_rpa->current_addr, BD_ADDR_LEN));
+    CHECK_EQ(test_slot.params.own_addr_type, BEACON_RPA_ADDR_TYPE);
+
+    /* A rejected update keeps the precomputed address for the retry */
+    (void)beacon_rpa_job(0);
+    test_params_result = WICED_BT_NO_RESOURCES;
+    beacon_rpa_rotate(&p_rpa->rotation_timer);
+    CHECK_EQ(p_rpa->stats.rejected, 1);
+    CHECK_EQ(test_timer_delay, RPA_RETRY_MS);
+    CHECK(p_rpa->next_ready);
+}
+
+int main(void)
+{
+    test_ah();
+    test_addresses();
+    test_rotation();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,252 @@
+/******************************************************************************
+* File Name: test_scanreq.c
+*
+* Description: Host tests and benchmarks of the scan request counters:
+* distinct requester estimates from 10 to 1M addresses, hourly buckets, and
+* the cost of recording a request against copying an event to the manager
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "test.h"
+#include "beacon_scanreq.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+/* Standard error of the sketch */
+#define TEST_STD_ERROR                   (1.04 / sqrt((double)BEACON_SCANREQ_REGISTERS))
+
+#define TEST_BENCH_REQUESTS              (1UL << 22)
+#define TEST_BENCH_ADDRESSES             (4096)
+#define TEST_BENCH_ROUNDS                (7)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* A scan request event as the stack callback would copy it to the manager */
+typedef struct
+{
+    uint8_t type;
+    uint8_t data[40];
+}test_evt_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static uint32_t   test_now_ms;
+static uint64_t   test_rng = 88172645463325252ULL;
+static test_evt_t test_queue[64];
+static uint32_t   test_queue_head;
+
+static wiced_bt_device_address_t test_addresses[TEST_BENCH_ADDRESSES];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+uint32_t beacon_stats_now_ms(void)
+{
+    return test_now_ms;
+}
+
+wiced_result_t beacon_slot_set_params(beacon_slot_t *p_slot,
+                                      const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    return WICED_BT_PENDING;
+}
+
+static uint64_t test_random(void)
+{
+    test_rng ^= test_rng << 13;
+    test_rng ^= test_rng >> 7;
+    test_rng ^= test_rng << 17;
+    return test_rng;
+}
+
+static void test_random_address(wiced_bt_device_address_t bd_addr)
+{
+    uint64_t value = test_random();
+
+    memcpy(bd_addr, &value, BD_ADDR_LEN);
+}
+
+static void __attribute__((noinline)) test_post(const test_evt_t *p_evt)
+{
+    test_queue[test_queue_head++ & 63] = *p_evt;
+}
+
+/* Estimates of random populations stay within the standard error */
+static void test_accuracy(void)
+{
+    static const uint32_t populations[] = { 10, 100, 1000, 10000, 100000, 1000000 };
+    wiced_bt_device_address_t bd_addr;
+    beacon_scanreq_snapshot_t snapshot;
+    double error;
+    double sum;
+    double sum_sq;
+    uint32_t trials;
+
+    beacon_scanreq_init();
+    for (uint32_t k = 0; k < sizeof(populations) / sizeof(populations[0]); k++)
+    {
+        trials = (populations[k] >= 100000) ? 10 : 100;
+        sum    = 0;
+        sum_sq = 0;
+        for (uint32_t t = 0; t < trials; t++)
+        {
+            beacon_scanreq_reset(0);
+            for (uint32_t d = 0; d < populations[k]; d++)
+            {
+                test_random_address(bd_addr);
+
+                /* Repeated requests of a scanner count once */
+                for (uint32_t r = (uint32_t)(test_random() % 3); r < 3; r++)
+                {
+                    beacon_scanreq_record(1, bd_addr);
+                }
+            }
+            beacon_scanreq_get(1, &snapshot);
+            error   = ((double)snapshot.distinct - populations[k]) / populations[k];
+            sum    += error;
+            sum_sq += error * error;
+        }
+
+        printf("scanreq: %7lu distinct, %3lu trials: mean error %+5.1f%%, rms %4.1f%%\n",
+               (unsigned long)populations[k], (unsigned long)trials, 100 * sum / trials,
+               100 * sqrt(sum_sq / trials));
+        CHECK(fabs(sum / trials) < TEST_STD_ERROR);
+        CHECK(sqrt(sum_sq / trials) < 2 * TEST_STD_ERROR);
+    }
+
+    /* Addresses from one vendor differ only in their last octets */
+    beacon_scanreq_reset(0);
+    for (uint32_t d = 0; d < 5000; d++)
+    {
+        wiced_bt_device_address_t vendor = { 0x00, 0xA0, 0x50, (uint8_t)(d >> 16),
+                                             (uint8_t)(d >> 8), (uint8_t)d };
+
+        beacon_scanreq_record(2, vendor);
+    }
+    beacon_scanreq_get(2, &snapshot);
+    CHECK(fabs(((double)snapshot.distinct - 5000) / 5000) < 3 * TEST_STD_ERROR);
+}
+
+/* One bucket per hour, the oldest drop out, an idle day clears them */
+static void test_buckets(void)
+{
+    wiced_bt_device_address_t bd_addr = { 1, 2, 3, 4, 5, 0 };
+    beacon_scanreq_snapshot_t snapshot;
+    uint32_t sum = 0;
+
+    beacon_scanreq_init();
+    test_now_ms = 0;
+    for (uint32_t hour = 0; hour < 30; hour++)
+    {
+        for (uint32_t i = 0; i <= hour; i++)
+        {
+            bd_addr[5] = (uint8_t)i;
+            beacon_scanreq_record(3, bd_addr);
+        }
+        test_now_ms += BEACON_SCANREQ_BUCKET_MS;
+    }
+    test_now_ms -= 1;
+
+    beacon_scanreq_get(3, &snapshot);
+    for (uint32_t i = 0; i < BEACON_SCANREQ_BUCKETS; i++)
+    {
+        CHECK_EQ(snapshot.buckets[i], 30 - BEACON_SCANREQ_BUCKETS + 1 + i);
+    }
+    CHECK_EQ(snapshot.total, 30 * 31 / 2);
+    CHECK(fabs(((double)snapshot.distinct - 30) / 30) < 2 * TEST_STD_ERROR);
+
+    test_now_ms += (BEACON_SCANREQ_BUCKETS + 5) * BEACON_SCANREQ_BUCKET_MS;
+    beacon_scanreq_get(3, &snapshot);
+    for (uint32_t i = 0; i < BEACON_SCANREQ_BUCKETS; i++)
+    {
+        sum += snapshot.buckets[i];
+    }
+    CHECK_EQ(sum, 0);
+}
+
+/* Recording a request against copying one event into a queue slot */
+static void test_bench(void)
+{
+    test_evt_t evt;
+    double record_ns = 1e9;
+    double post_ns = 1e9;
+    uint64_t start;
+    uint64_t mid;
+
+    memset(&evt, 0, sizeof(evt));
+    for (uint32_t i = 0; i < TEST_BENCH_ADDRESSES; i++)
+    {
+        test_random_address(test_addresses[i]);
+    }
+
+    for (uint32_t round = 0; round < TEST_BENCH_ROUNDS; round++)
+    {
+        start = test_now_ns();
+        for (uint32_t i = 0; i < TEST_BENCH_REQUESTS; i++)
+        {
+            beacon_scanreq_record((uint8_t)(1 + (i & 3)),
+                                  test_addresses[i & (TEST_BENCH_ADDRESSES - 1)]);
+        }
+        mid = test_now_ns();
+        for (uint32_t i = 0; i < TEST_BENCH_REQUESTS; i++)
+        {
+            evt.data[0] = (uint8_t)i;
+            test_post(&evt);
+        }
+        record_ns = fmin(record_ns, (double)(mid - start) / TEST_BENCH_REQUESTS);
+        post_ns   = fmin(post_ns, (double)(test_now_ns() - mid) / TEST_BENCH_REQUESTS);
+    }
+
+    printf("scanreq: %.1f ns per recorded request, %.1f ns per event copied to a queue\n",
+           record_ns, post_ns);
+}
+
+int main(void)
+{
+    test_accuracy();
+    test_buckets();
+    test_bench();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,285 @@
+/******************************************************************************
+* File Name: test_telemetry.c
+*
+* Description: Host tests and benchmarks of the delta-coded sensor telemetry
+* frames: round trips of smooth, noisy, stepped and random traces, frame loss,
+* samples per frame, bytes saved and encode/decode throughput
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "test.h"
+#include "beacon_manager.h"
+#include "beacon_telemetry.h"
+#include "beacon_worker.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_SAMPLES                     (20000)
+
+/* One sample per advertisement: flags, AD header, company ID, a 16-bit
+ * index and the raw values */
+#define TEST_RAW_ADV_LEN(channels)       ((ADV_PKT_FLAG_LENGTH + 1) + 4 + 2 + (2 * (channels)))
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Result of one trace */
+typedef struct
+{
+    uint32_t frames;                            /* Frames encoded */
+    uint32_t bytes;                             /* Advertising data bytes */
+    uint32_t decoded;                           /* Samples decoded */
+    uint32_t errors;                            /* Samples decoded wrong */
+    uint64_t ns;                                /* Encode and decode time */
+}test_result_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static int16_t test_trace[TEST_SAMPLES][BEACON_TELEMETRY_MAX_CHANNELS];
+static int16_t test_decoded[BEACON_TELEMETRY_MAX_SAMPLES * BEACON_TELEMETRY_MAX_CHANNELS];
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+wiced_result_t beacon_slot_set_data(beacon_slot_t *p_slot, const uint8_t *p_data, uint8_t len)
+{
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_slot_set_params(beacon_slot_t *p_slot,
+                                      const wiced_bt_ble_multi_adv_params_t *p_params)
+{
+    return WICED_BT_PENDING;
+}
+
+wiced_result_t beacon_slot_start(beacon_slot_t *p_slot, wiced_bool_t start)
+{
+    return WICED_BT_PENDING;
+}
+
+void beacon_manager_defer(beacon_manager_fn_t *p_fn)
+{
+    (void)p_fn;
+}
+
+void beacon_worker_register(beacon_worker_job_t *p_job, uint32_t slack_ms)
+{
+    (void)p_job;
+}
+
+/* Encodes the trace frame by frame and decodes every frame not lost. Every
+ * 1 in lose_one_in frames is dropped, none if 0. */
+static test_result_t test_run(const char *name, uint8_t channels, uint32_t lose_one_in)
+{
+    beacon_telemetry_enc_t enc;
+    beacon_telemetry_dec_t dec;
+    test_result_t result = { 0 };
+    int16_t samples[BEACON_TELEMETRY_MAX_SAMPLES * BEACON_TELEMETRY_MAX_CHANNELS];
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint8_t adv_len;
+    uint16_t first_index;
+    uint16_t num;
+    uint16_t encoded;
+    uint16_t decoded;
+    uint64_t start;
+
+    beacon_telemetry_enc_init(&enc, channels);
+    beacon_telemetry_dec_init(&dec);
+    srand(1);
+
+    start = test_now_ns();
+    for (uint32_t pos = 0; pos < TEST_SAMPLES; pos += encoded)
+    {
+        num = (TEST_SAMPLES - pos < BEACON_TELEMETRY_MAX_SAMPLES) ?
+              (uint16_t)(TEST_SAMPLES - pos) : BEACON_TELEMETRY_MAX_SAMPLES;
+        for (uint16_t i = 0; i < num; i++)
+        {
+            memcpy(&samples[i * channels], test_trace[pos + i], channels * sizeof(int16_t));
+        }
+
+        encoded = beacon_telemetry_encode(&enc, samples, num, (uint16_t)pos, adv_data, &adv_len);
+        CHECK((0 != encoded) && (adv_len <= BEACON_ADV_DATA_MAX));
+        if (0 == encoded)
+        {
+            break;
+        }
+        result.frames++;
+        result.bytes += adv_len;
+
+        if ((0 != lose_one_in) && (0 == (rand() % lose_one_in)))
+        {
+            continue;
+        }
+        decoded = beacon_telemetry_decode(&dec, adv_data, adv_len, test_decoded,
+                                          BEACON_TELEMETRY_MAX_SAMPLES, &first_index);
+        if (0 == decoded)
+        {
+            continue;
+        }
+        result.errors += ((decoded != encoded) || (first_index != (uint16_t)pos)) ? 1 : 0;
+        for (uint16_t i = 0; i < decoded; i++)
+        {
+            result.errors += (0 != memcmp(&test_decoded[i * channels], test_trace[pos + i],
+                                          channels * sizeof(int16_t))) ? 1 : 0;
+        }
+        result.decoded += decoded;
+    }
+    result.ns = test_now_ns() - start;
+
+    printf("telemetry: %-14s %u ch: %5.1f samples/frame, %4.1fx fewer bytes, "
+           "%5lu/%u decoded, %.0f ns/sample\n", name, channels,
+           (double)TEST_SAMPLES / result.frames,
+           (double)TEST_SAMPLES * TEST_RAW_ADV_LEN(channels) / result.bytes,
+           (unsigned long)result.decoded, TEST_SAMPLES, (double)result.ns / TEST_SAMPLES);
+
+    CHECK_EQ(result.errors, 0);
+    return result;
+}
+
+/* Slowly varying temperature, humidity and pressure with sensor noise */
+static void test_smooth(void)
+{
+    test_result_t result;
+
+    srand(1);
+    for (uint32_t i = 0; i < TEST_SAMPLES; i++)
+    {
+        test_trace[i][0] = (int16_t)(2150 + (int)(300 * sin(i / 600.0)) + (rand() % 3) - 1);
+        test_trace[i][1] = (int16_t)(4500 + (int)(800 * sin(i / 900.0)) + (rand() % 5) - 2);
+        test_trace[i][2] = (int16_t)(10132 + (int)(20 * sin(i / 2000.0)));
+        test_trace[i][3] = (int16_t)(330 - (i / 2000));
+    }
+
+    result = test_run("smooth", 3, 0);
+    CHECK_EQ(result.decoded, TEST_SAMPLES);
+    CHECK(result.frames * 8 < TEST_SAMPLES);
+
+    result = test_run("smooth", 4, 0);
+    CHECK_EQ(result.decoded, TEST_SAMPLES);
+
+    /* A lost frame costs its own samples and at most the deltas of its key */
+    result = test_run("smooth, lossy", 3, 5);
+    CHECK(result.decoded < TEST_SAMPLES);
+    CHECK(result.decoded > TEST_SAMPLES / 2);
+}
+
+/* Level changes with little noise, like an occupancy or door sensor */
+static void test_steps(void)
+{
+    test_result_t result;
+    int16_t value = 2000;
+
+    srand(2);
+    for (uint32_t i = 0; i < TEST_SAMPLES; i++)
+    {
+        if (0 == (rand() % 500))
+        {
+            value = (int16_t)(value + (rand() % 2000) - 1000);
+        }
+        test_trace[i][0] = (int16_t)(value + (rand() % 2));
+        test_trace[i][1] = (int16_t)(value / 2);
+    }
+
+    result = test_run("steps", 2, 0);
+    CHECK_EQ(result.decoded, TEST_SAMPLES);
+    CHECK(result.frames * 20 < TEST_SAMPLES);
+}
+
+/* Full-range noise: nothing compresses, nearly every frame is a keyframe */
+static void test_random(void)
+{
+    test_result_t result;
+
+    srand(3);
+    for (uint32_t i = 0; i < TEST_SAMPLES; i++)
+    {
+        for (uint8_t j = 0; j < BEACON_TELEMETRY_MAX_CHANNELS; j++)
+        {
+            test_trace[i][j] = (int16_t)(rand() & 0xFFFF);
+        }
+    }
+
+    result = test_run("random", 4, 0);
+    CHECK_EQ(result.decoded, TEST_SAMPLES);
+    CHECK(result.frames > (TEST_SAMPLES * 9) / 10);
+
+    result = test_run("random", 1, 0);
+    CHECK_EQ(result.decoded, TEST_SAMPLES);
+}
+
+/* Frames from another company or truncated frames are not decoded */
+static void test_reject(void)
+{
+    beacon_telemetry_enc_t enc;
+    beacon_telemetry_dec_t dec;
+    int16_t samples[2] = { 100, -100 };
+    uint8_t adv_data[BEACON_ADV_DATA_MAX];
+    uint8_t adv_len;
+    uint16_t first_index;
+
+    beacon_telemetry_enc_init(&enc, 2);
+    beacon_telemetry_dec_init(&dec);
+    CHECK_EQ(beacon_telemetry_encode(&enc, samples, 1, 7, adv_data, &adv_len), 1);
+
+    CHECK_EQ(beacon_telemetry_decode(&dec, adv_data, adv_len - 1, test_decoded,
+                                     BEACON_TELEMETRY_MAX_SAMPLES, &first_index), 0);
+    adv_data[ADV_PKT_FLAG_LENGTH + 2] ^= 0xFF;
+    CHECK_EQ(beacon_telemetry_decode(&dec, adv_data, adv_len, test_decoded,
+                                     BEACON_TELEMETRY_MAX_SAMPLES, &first_index), 0);
+    adv_data[ADV_PKT_FLAG_LENGTH + 2] ^= 0xFF;
+    CHECK_EQ(beacon_telemetry_decode(&dec, adv_data, adv_len, test_decoded,
+                                     BEACON_TELEMETRY_MAX_SAMPLES, &first_index), 1);
+    CHECK_EQ(first_index, 7);
+    CHECK_EQ(test_decoded[0], 100);
+    CHECK_EQ(test_decoded[1], -100);
+}
+
+int main(void)
+{
+    test_smooth();
+    test_steps();
+    test_random();
+    test_reject();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
@@ -0,0 +1,233 @@
+/******************************************************************************
+* File Name: test_timer.c
+*
+* Description: Host tests and benchmark of the hierarchical timer wheel:
+* expiry on the exact tick across wrap-around and long jumps, cancellation,
+* and per-tick cost from 100 to 10k pending timers
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "beacon_manager.h"
+#include "beacon_timer.h"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_TIMERS                      (10000)
+#define TEST_BENCH_TICKS                 (200000)
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+static beacon_timer_wheel_t test_wheel;
+static beacon_timer_t       test_timers[TEST_TIMERS];
+static uint32_t             test_fired[TEST_TIMERS];
+static uint32_t             test_wrong_tick;
+static uint32_t             test_last_now;
+static uint32_t             test_out_of_order;
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+void beacon_manager_defer(beacon_manager_fn_t *p_fn)
+{
+    (void)p_fn;
+}
+
+/* The wheel has processed tick `expires` when the callback runs */
+static void test_expired(beacon_timer_t *p_timer)
+{
+    uintptr_t index = (uintptr_t)p_timer->p_arg;
+
+    test_wrong_tick   += (test_wheel.now != p_timer->expires + 1) ? 1 : 0;
+    test_out_of_order += ((int32_t)(test_wheel.now - test_last_now) < 0) ? 1 : 0;
+    test_last_now      = test_wheel.now;
+    test_fired[index]++;
+}
+
+/* Rotation: the callback re-arms the timer, as the identity rotations do */
+static void test_rearm(beacon_timer_t *p_timer)
+{
+    uintptr_t index = (uintptr_t)p_timer->p_arg;
+
+    test_expired(p_timer);
+    beacon_timer_wheel_add(&test_wheel, p_timer, p_timer->expires + 1 + (uint32_t)(index % 9000));
+}
+
+/* Every timer fires once on its tick, cancelled ones never, while the tick
+ * counter wraps */
+static void test_expiry(void)
+{
+    uint32_t start = 0xFFFF0000UL;
+    uint32_t errors = 0;
+
+    srand(1);
+    memset(test_fired, 0, sizeof(test_fired));
+    beacon_timer_wheel_init(&test_wheel, start);
+    test_last_now = start;
+    for (uintptr_t i = 0; i < TEST_TIMERS; i++)
+    {
+        uint32_t delay = (i % 3) ? ((uint32_t)rand() % 100000) : ((uint32_t)rand() % 40000000);
+
+        beacon_timer_setup(&test_timers[i], test_expired, (void *)i);
+        beacon_timer_wheel_add(&test_wheel, &test_timers[i], start + delay);
+    }
+    for (uint32_t i = 0; i < TEST_TIMERS; i += 7)
+    {
+        beacon_timer_wheel_del(&test_wheel, &test_timers[i]);
+    }
+
+    /* Advance in uneven steps, the next deadline is never overshot */
+    while (0 != test_wheel.pending)
+    {
+        uint32_t next = beacon_timer_wheel_next(&test_wheel);
+        uint32_t step = 1 + (uint32_t)rand() % 50;
+
+        beacon_timer_wheel_advance(&test_wheel, (step < next + 1) ? step : next + 1);
+    }
+
+    for (uint32_t i = 0; i < TEST_TIMERS; i++)
+    {
+        errors += (test_fired[i] != ((0 == (i % 7)) ? 0U : 1U)) ? 1 : 0;
+    }
+    CHECK_EQ(errors, 0);
+    CHECK_EQ(test_wrong_tick, 0);
+    CHECK_EQ(test_out_of_order, 0);
+}
+
+/* Large jumps over re-arming timers expire everything in order */
+static void test_jumps(void)
+{
+    uint32_t total = 0;
+
+    srand(2);
+    memset(test_fired, 0, sizeof(test_fired));
+    beacon_timer_wheel_init(&test_wheel, 0xFFFFF000UL);
+    test_last_now = test_wheel.now;
+    for (uintptr_t i = 0; i < TEST_TIMERS; i++)
+    {
+        beacon_timer_setup(&test_timers[i], test_rearm, (void *)i);
+        beacon_timer_wheel_add(&test_wheel, &test_timers[i],
+                               test_wheel.now + (uint32_t)rand() % 90000);
+    }
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        beacon_timer_wheel_advance(&test_wheel, (uint32_t)rand() % 3000);
+    }
+    for (uint32_t i = 0; i < TEST_TIMERS; i++)
+    {
+        total += test_fired[i];
+    }
+    CHECK(total > TEST_TIMERS);
+    CHECK_EQ(test_wrong_tick, 0);
+    CHECK_EQ(test_out_of_order, 0);
+    CHECK_EQ(test_wheel.pending, TEST_TIMERS);
+}
+
+/* Best of three runs of advancing the wheel one tick at a time. The timers
+ * lie beyond the measured ticks, so the cost is that of the wheel itself,
+ * cascades included. */
+static double test_tick_ns(uint32_t pending)
+{
+    double best = 0;
+
+    for (uint32_t run = 0; run < 3; run++)
+    {
+        uint64_t start;
+        double ns;
+
+        srand(3);
+        beacon_timer_wheel_init(&test_wheel, 0);
+        for (uintptr_t i = 0; i < pending; i++)
+        {
+            beacon_timer_setup(&test_timers[i], test_expired, (void *)i);
+            beacon_timer_wheel_add(&test_wheel, &test_timers[i],
+                                   TEST_BENCH_TICKS + 1 + (uint32_t)rand() % (1UL << 24));
+        }
+        start = test_now_ns();
+        for (uint32_t tick = 0; tick < TEST_BENCH_TICKS; tick++)
+        {
+            beacon_timer_wheel_advance(&test_wheel, 1);
+        }
+        ns = (double)(test_now_ns() - start) / TEST_BENCH_TICKS;
+        best = ((0 == run) || (ns < best)) ? ns : best;
+        CHECK_EQ(test_wheel.pending, pending);
+    }
+    return best;
+}
+
+/* The cost of a tick does not grow with the number of pending timers */
+static void test_bench(void)
+{
+    double tick_100;
+    double tick_10k;
+    double add_ns;
+    uint64_t start;
+
+    tick_100 = test_tick_ns(100);
+    printf("timer: %5u pending: %.1f ns/tick\n", 100, tick_100);
+    printf("timer: %5u pending: %.1f ns/tick\n", 1000, test_tick_ns(1000));
+    tick_10k = test_tick_ns(TEST_TIMERS);
+
+    start = test_now_ns();
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        beacon_timer_t *p_timer = &test_timers[(uint32_t)rand() % TEST_TIMERS];
+
+        beacon_timer_wheel_add(&test_wheel, p_timer,
+                               test_wheel.now + 1000 + (uint32_t)rand() % 1000000);
+    }
+    add_ns = (double)(test_now_ns() - start) / 100000;
+    printf("timer: %5u pending: %.1f ns/tick, %.1f ns/re-add\n", TEST_TIMERS, tick_10k, add_ns);
+
+    /* Generous bound for a noisy host: a wheel scanning its timers would be
+     * about 100 times slower at 10k than at 100 */
+    CHECK(tick_10k < 4 * tick_100);
+}
+
+int main(void)
+{
+    test_expiry();
+    test_jumps();
+    test_bench();
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */
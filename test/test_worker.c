@@ -0,0 +1,181 @@
+/******************************************************************************
+* File Name: test_worker.c
+*
+* Description: Host simulation of the coalescing worker: an hour of the
+* periodic jobs of the application on a simulated clock, with the wakeups
+* compared to one independent timer per job
+*
+*******************************************************************************
+* Copyright 2020-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include <string.h>
+#include "test.h"
+#include "../beacon_worker.c"
+
+/*******************************************************************************
+*        Macro Definitions
+*******************************************************************************/
+#define TEST_HOUR_MS                     (3600UL * 1000UL)
+
+/*******************************************************************************
+*        Structures
+*******************************************************************************/
+/* Periodic job keeping its period independent of the slack it is run with */
+typedef struct
+{
+    const char *p_name;
+    uint32_t period_ms;
+    uint32_t slack_ms;
+    uint32_t next_ms;
+    uint32_t runs;
+    uint32_t max_late_ms;
+}test_job_t;
+
+/*******************************************************************************
+*        Variable Definitions
+*******************************************************************************/
+TEST_MAIN_DEFINE();
+
+/* Periods and slack of the jobs registered by the application modules */
+static test_job_t test_jobs[] =
+{
+    { "ipc poll",          100,     50, 0, 0, 0 },
+    { "telemetry sample",  1000,    100, 0, 0, 0 },
+    { "observer report",   1000,    250, 0, 0, 0 },
+    { "format tick",       1000,    500, 0, 0, 0 },
+    { "encrypted frame",   1000,    100, 0, 0, 0 },
+    { "rolling identity",  600000,  0, 0, 0, 0 },
+};
+
+#define TEST_NUM_JOBS                    (sizeof(test_jobs) / sizeof(test_jobs[0]))
+
+/*******************************************************************************
+*        Function Definitions
+*******************************************************************************/
+
+uint32_t beacon_stats_now_ms(void)
+{
+    return 0;
+}
+
+static uint32_t test_job_run(test_job_t *p_job, uint32_t now_ms)
+{
+    int32_t wait_ms = (int32_t)(p_job->next_ms - now_ms);
+    uint32_t late_ms;
+
+    if (wait_ms > 0)
+    {
+        return (uint32_t)wait_ms;
+    }
+    late_ms = (uint32_t)-wait_ms;
+    if (late_ms > p_job->max_late_ms)
+    {
+        p_job->max_late_ms = late_ms;
+    }
+    p_job->runs++;
+    p_job->next_ms += p_job->period_ms;
+    return p_job->next_ms - now_ms;
+}
+
+#define TEST_JOB(n)                                                             \
+    static uint32_t test_job_##n(uint32_t now_ms)                               \
+    {                                                                           \
+        return test_job_run(&test_jobs[n], now_ms);                             \
+    }
+TEST_JOB(0)
+TEST_JOB(1)
+TEST_JOB(2)
+TEST_JOB(3)
+TEST_JOB(4)
+TEST_JOB(5)
+
+static beacon_worker_job_t *const test_job_fns[] =
+{
+    test_job_0, test_job_1, test_job_2, test_job_3, test_job_4, test_job_5
+};
+
+/* Runs the worker loop for an hour on a simulated clock. The jobs start at
+ * unrelated phases, as they do when their features are enabled one by one. */
+static void test_hour(uint32_t first_job, const char *p_scenario)
+{
+    uint32_t now_ms = 0;
+    uint32_t wakeups = 0;
+    uint8_t kicked = 1;
+
+    memset(worker_jobs, 0, sizeof(worker_jobs));
+    memset(&worker_stats, 0, sizeof(worker_stats));
+    worker_num_jobs = 0;
+    srand(7);
+
+    for (uint32_t i = first_job; i < TEST_NUM_JOBS; i++)
+    {
+        test_jobs[i].next_ms     = (uint32_t)rand() % test_jobs[i].period_ms;
+        test_jobs[i].runs        = 0;
+        test_jobs[i].max_late_ms = 0;
+        beacon_worker_register(test_job_fns[i], test_jobs[i].slack_ms);
+    }
+
+    while (now_ms < TEST_HOUR_MS)
+    {
+        uint32_t wait_ms;
+
+        beacon_worker_run(now_ms, kicked);
+        kicked = 0;
+        wait_ms = beacon_worker_next_wait(now_ms);
+        CHECK(BEACON_WORKER_IDLE != wait_ms);
+        now_ms += wait_ms;
+        wakeups++;
+    }
+
+    for (uint32_t i = first_job; i < TEST_NUM_JOBS; i++)
+    {
+        /* Every run happens within the slack of the job, and none is lost */
+        CHECK(test_jobs[i].max_late_ms <= test_jobs[i].slack_ms);
+        CHECK(test_jobs[i].runs + 1 >= TEST_HOUR_MS / test_jobs[i].period_ms);
+    }
+
+    printf("worker, %s: %lu wakeups/h coalesced, %lu with independent timers (%.0f%% fewer)\n",
+           p_scenario, (unsigned long)wakeups, (unsigned long)worker_stats.job_deadlines,
+           100.0 * (1.0 - (double)wakeups / (double)worker_stats.job_deadlines));
+    CHECK(wakeups < worker_stats.job_deadlines);
+}
+
+int main(void)
+{
+    test_hour(0, "all jobs");
+    test_hour(1, "without IPC polling");
+    return TEST_RESULT();
+}
+
+
+/* [] END OF FILE */